@@ -3,10 +3,13 @@
 #include <assert.h>
 #include <inttypes.h>
 #include <string.h>
+#include <sys/mman.h>
 #include <time.h>
 #include <unistd.h>
 
 #include "jsd/jsd_ati_fts.h"
+#include "jsd/jsd_capture.h"
+#include "jsd/jsd_diag.h"
 #include "jsd/jsd_egd.h"
 #include "jsd/jsd_el2124.h"
 #include "jsd/jsd_el3104.h"
@@ -18,52 +21,128 @@
 #include "jsd/jsd_el3602.h"
 #include "jsd/jsd_el4102.h"
 #include "jsd/jsd_epd.h"
+#include "jsd/jsd_flight.h"
+#include "jsd/jsd_hotplug.h"
 #include "jsd/jsd_ild1900.h"
 #include "jsd/jsd_jed0101.h"
 #include "jsd/jsd_jed0200.h"
+#include "jsd/jsd_metrics.h"
 #include "jsd/jsd_print.h"
+#include "jsd/jsd_reconfig.h"
+#include "jsd/jsd_recorder.h"
 #include "jsd/jsd_sdo.h"
+#include "jsd/jsd_shm.h"
+#include "jsd/jsd_startup.h"
+#include "jsd/jsd_vbus.h"
+#include "jsd/jsd_watchdog.h"
 
 /****************************************************
  * Public functions
  ****************************************************/
 
-jsd_t* jsd_alloc() {
-  jsd_t* self;
-  self = (jsd_t*)calloc(1, sizeof(jsd_t));
+// Bytes carved from the arena by jsd_alloc_rt(...), one entry per allocation
+// in jsd_alloc_context(...)
+static size_t jsd_arena_bytes() {
+  return jsd_memory_arena_align(sizeof(jsd_t)) +
+         jsd_memory_arena_align(sizeof(ecx_portt)) +
+         jsd_memory_arena_align(EC_MAXSLAVE * sizeof(ec_slavet)) +
+         jsd_memory_arena_align(sizeof(int)) +
+         jsd_memory_arena_align(EC_MAXGROUP * sizeof(ec_groupt)) +
+         jsd_memory_arena_align(EC_MAXEEPBUF * sizeof(uint8)) +
+         jsd_memory_arena_align(EC_MAXEEPBITMAP * sizeof(uint32)) +
+         jsd_memory_arena_align(sizeof(ec_eringt)) +
+         jsd_memory_arena_align(sizeof(ec_idxstackT)) +
+         jsd_memory_arena_align(sizeof(boolean)) +
+         jsd_memory_arena_align(sizeof(int64)) +
+         jsd_memory_arena_align(EC_MAX_MAPT * sizeof(ec_SMcommtypet)) +
+         jsd_memory_arena_align(EC_MAX_MAPT * sizeof(ec_PDOassignt)) +
+         jsd_memory_arena_align(EC_MAX_MAPT * sizeof(ec_PDOdesct)) +
+         jsd_memory_arena_align(sizeof(ec_eepromSMt)) +
+         jsd_memory_arena_align(sizeof(ec_eepromFMMUt));
+}
 
-  self->ecx_context.port = (ecx_portt*)calloc(1, sizeof(ecx_portt));
+static void* jsd_zalloc(jsd_t* self, size_t bytes) {
+  if (self->arena.base) {
+    return jsd_memory_arena_alloc(&self->arena, bytes);
+  }
+  return calloc(1, bytes);
+}
+
+static void jsd_alloc_context(jsd_t* self) {
+  self->ecx_context.port = (ecx_portt*)jsd_zalloc(self, sizeof(ecx_portt));
   self->ecx_context.slavelist =
-      (ec_slavet*)malloc(EC_MAXSLAVE * sizeof(ec_slavet));
-  self->ecx_context.slavecount = (int*)calloc(1, sizeof(int));
+      (ec_slavet*)jsd_zalloc(self, EC_MAXSLAVE * sizeof(ec_slavet));
+  self->ecx_context.slavecount = (int*)jsd_zalloc(self, sizeof(int));
   self->ecx_context.maxslave   = EC_MAXSLAVE;
   self->ecx_context.grouplist =
-      (ec_groupt*)calloc(1, EC_MAXGROUP * sizeof(ec_groupt));
+      (ec_groupt*)jsd_zalloc(self, EC_MAXGROUP * sizeof(ec_groupt));
   self->ecx_context.maxgroup = EC_MAXGROUP;
-  self->ecx_context.esibuf   = (uint8*)calloc(1, EC_MAXEEPBUF * sizeof(uint8));
+  self->ecx_context.esibuf =
+      (uint8*)jsd_zalloc(self, EC_MAXEEPBUF * sizeof(uint8));
   self->ecx_context.esimap =
-      (uint32*)calloc(1, EC_MAXEEPBITMAP * sizeof(uint32));
-  self->ecx_context.esislave  = 0;
-  self->ecx_context.elist     = (ec_eringt*)calloc(1, sizeof(ec_eringt));
-  self->ecx_context.idxstack  = (ec_idxstackT*)calloc(1, sizeof(ec_idxstackT));
-  self->ecx_context.ecaterror = (boolean*)calloc(1, sizeof(boolean));
-  self->ecx_context.DCtime    = (int64*)calloc(1, sizeof(int64));
-  self->ecx_context.SMcommtype =
-      (ec_SMcommtypet*)calloc(1, EC_MAX_MAPT * sizeof(ec_SMcommtypet));
+      (uint32*)jsd_zalloc(self, EC_MAXEEPBITMAP * sizeof(uint32));
+  self->ecx_context.esislave = 0;
+  self->ecx_context.elist = (ec_eringt*)jsd_zalloc(self, sizeof(ec_eringt));
+  self->ecx_context.idxstack =
+      (ec_idxstackT*)jsd_zalloc(self, sizeof(ec_idxstackT));
+  self->ecx_context.ecaterror = (boolean*)jsd_zalloc(self, sizeof(boolean));
+  self->ecx_context.DCtime    = (int64*)jsd_zalloc(self, sizeof(int64));
+  self->ecx_context.SMcommtype = (ec_SMcommtypet*)jsd_zalloc(
+      self, EC_MAX_MAPT * sizeof(ec_SMcommtypet));
   self->ecx_context.PDOassign =
-      (ec_PDOassignt*)calloc(1, EC_MAX_MAPT * sizeof(ec_PDOassignt));
+      (ec_PDOassignt*)jsd_zalloc(self, EC_MAX_MAPT * sizeof(ec_PDOassignt));
   self->ecx_context.PDOdesc =
-      (ec_PDOdesct*)calloc(1, EC_MAX_MAPT * sizeof(ec_PDOdesct));
-  self->ecx_context.eepSM = (ec_eepromSMt*)calloc(1, sizeof(ec_eepromSMt));
+      (ec_PDOdesct*)jsd_zalloc(self, EC_MAX_MAPT * sizeof(ec_PDOdesct));
+  self->ecx_context.eepSM =
+      (ec_eepromSMt*)jsd_zalloc(self, sizeof(ec_eepromSMt));
   self->ecx_context.eepFMMU =
-      (ec_eepromFMMUt*)calloc(1, sizeof(ec_eepromFMMUt));
+      (ec_eepromFMMUt*)jsd_zalloc(self, sizeof(ec_eepromFMMUt));
   self->ecx_context.FOEhook           = NULL;
   self->ecx_context.EOEhook           = NULL;
   self->ecx_context.manualstatechange = 0;
   // Needed to avoid global variables to pass slave config into the PO2SO
   // callbacks
   self->ecx_context.userdata = (void*)&self->slave_configs;
+  self->last_transmitted     = 1;
+
+  self->watchdog.frame_mutex   = (pthread_mutex_t)PTHREAD_MUTEX_INITIALIZER;
+  self->watchdog.stats_mutex   = (pthread_mutex_t)PTHREAD_MUTEX_INITIALIZER;
+  self->capture.stats_mutex    = (pthread_mutex_t)PTHREAD_MUTEX_INITIALIZER;
+  self->diag.report_mutex      = (pthread_mutex_t)PTHREAD_MUTEX_INITIALIZER;
+  self->hotplug.report_mutex   = (pthread_mutex_t)PTHREAD_MUTEX_INITIALIZER;
+  self->hotplug.config_mutex   = (pthread_mutex_t)PTHREAD_MUTEX_INITIALIZER;
+  self->reconfig.stats_mutex   = (pthread_mutex_t)PTHREAD_MUTEX_INITIALIZER;
+}
+
+jsd_t* jsd_alloc() {
+  jsd_t* self;
+  self = (jsd_t*)calloc(1, sizeof(jsd_t));
+
+  jsd_alloc_context(self);
+
+  return self;
+}
+
+jsd_t* jsd_alloc_rt(jsd_memory_config_t config) {
+  jsd_memory_arena_t arena;
+  if (!jsd_memory_arena_create(&arena, jsd_arena_bytes(),
+                               config.use_huge_pages)) {
+    return NULL;
+  }
+
+  jsd_t* self = (jsd_t*)jsd_memory_arena_alloc(&arena, sizeof(jsd_t));
+  self->arena         = arena;
+  self->memory_config = config;
+
+  jsd_alloc_context(self);
+  assert(self->arena.used == jsd_arena_bytes());
+
+  if (config.lock_memory && mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+    WARNING("mlockall failed, memory may be paged out");
+  }
 
+  MSG("Allocated JSD context from a %zu byte arena%s", self->arena.size,
+      self->arena.huge_pages ? " on huge pages" : "");
   return self;
 }
 
@@ -80,11 +159,21 @@ void jsd_set_slave_config(jsd_t* self, uint16_t slave_id,
   self->slave_configs[slave_id] = slave_config;
 }
 
-bool jsd_init(jsd_t* self, const char* ifname, uint8_t enable_autorecovery) {
-  assert(self);
+// The phases of jsd_init(...), timed by jsd_startup
+static bool jsd_init_bus(jsd_t* self, const char* ifname,
+                         uint8_t enable_autorecovery) {
   self->enable_autorecovery = enable_autorecovery;
 
-  if (ecx_init(&self->ecx_context, ifname) <= 0) {
+  // Drivers may consume the cycle time before the first jsd_read(...)
+  jsd_time_get_cycle_time(&self->cycle_time);
+  jsd_time_dc_correlation_reset(&self->dc_correlation);
+
+  if (self->vbus) {
+    if (!jsd_vbus_open(self->vbus, self->ecx_context.port)) {
+      ERROR("Unable to open the virtual bus in place of %s", ifname);
+      return false;
+    }
+  } else if (ecx_init(&self->ecx_context, ifname) <= 0) {
     ERROR("Unable to establish socket connection on %s", ifname);
     if(geteuid() == 0) {
       ERROR("Is the device on and connected?");
@@ -93,6 +182,7 @@ bool jsd_init(jsd_t* self, const char* ifname, uint8_t enable_autorecovery) {
     }
     return false;
   }
+  jsd_startup_end_phase(self, JSD_INIT_PHASE_OPEN);
 
   MSG("ecx_init on %s succeeded", ifname);
 
@@ -101,6 +191,7 @@ bool jsd_init(jsd_t* self, const char* ifname, uint8_t enable_autorecovery) {
     WARNING("No slaves found on %s", ifname);
     return false;
   }
+  jsd_startup_end_phase(self, JSD_INIT_PHASE_CONFIG_INIT);
   MSG("%d slaves found on bus", *self->ecx_context.slavecount + 1);
 
   // We need to register the SO2PO callbacks before mapping the PDOs
@@ -108,14 +199,28 @@ bool jsd_init(jsd_t* self, const char* ifname, uint8_t enable_autorecovery) {
     ERROR("Could not init all devices");
     return false;
   }
+  jsd_startup_end_phase(self, JSD_INIT_PHASE_DEVICES);
+  jsd_startup_wrap_hooks(self);
+
+  // Remembers the writes of the PO2SO hooks for the fast reconfiguration
+  jsd_reconfig_begin(self);
 
   // configure IOMap
   int iomap_size =
       ecx_config_overlap_map_group(&self->ecx_context, &self->IOmap, 0);
   if (iomap_size > (int)sizeof(self->IOmap)) {
     ERROR("IO Map is not large enough for this application");
+    jsd_startup_unwrap_hooks(self);
+    jsd_reconfig_end(self);
     return false;
   }
+  // Before any handle caches a pointer into the image
+  if (!jsd_hotplug_reserve_image(self)) {
+    jsd_startup_unwrap_hooks(self);
+    jsd_reconfig_end(self);
+    return false;
+  }
+  jsd_startup_end_phase(self, JSD_INIT_PHASE_MAP);
   // Print the IOMap input and output pointers for debugging
   int sid;
   for (sid = 1; sid <= *self->ecx_context.slavecount; sid++) {
@@ -132,6 +237,9 @@ bool jsd_init(jsd_t* self, const char* ifname, uint8_t enable_autorecovery) {
 
   // Triggering the PO2SO transition that configures each device
   ecx_statecheck(&self->ecx_context, 0, EC_STATE_SAFE_OP, EC_TIMEOUTSTATE);
+  jsd_startup_unwrap_hooks(self);
+  jsd_reconfig_end(self);
+  jsd_startup_end_phase(self, JSD_INIT_PHASE_SAFE_OP);
 
   // verify the PO2SO callback executed completely
   for (sid = 1; sid <= *self->ecx_context.slavecount; sid++) {
@@ -144,6 +252,7 @@ bool jsd_init(jsd_t* self, const char* ifname, uint8_t enable_autorecovery) {
   }
   // Auto-configure Distributed Clock capable slaves
   ecx_configdc(&self->ecx_context);
+  jsd_startup_end_phase(self, JSD_INIT_PHASE_CONFIG_DC);
 
   // Read individual slave state and store in self->ecx_context.slavelist[]
   ecx_readstate(&self->ecx_context);
@@ -174,6 +283,8 @@ bool jsd_init(jsd_t* self, const char* ifname, uint8_t enable_autorecovery) {
         &self->ecx_context, 0, EC_STATE_OPERATIONAL, EC_TIMEOUTSTATE);
 
     attempt++;
+    jsd_startup_record_op_attempt(self, attempt,
+                                  actual_state == EC_STATE_OPERATIONAL);
 
     MSG_DEBUG("sent: %d", sent);
     MSG_DEBUG("Actual WKC: %d, Expected WKC: %d", wkc, self->expected_wkc);
@@ -200,6 +311,11 @@ bool jsd_init(jsd_t* self, const char* ifname, uint8_t enable_autorecovery) {
     }
   }
 
+  // Reference AL states of the state transition metrics
+  ecx_readstate(&self->ecx_context);
+  jsd_metrics_update_states(self, false);
+  jsd_startup_end_phase(self, JSD_INIT_PHASE_OPERATIONAL);
+
   // Initialize the error queues used between threads
   for (sid = 1; sid <= *self->ecx_context.slavecount; sid++) {
     char qname[JSD_NAME_LEN];
@@ -212,22 +328,72 @@ bool jsd_init(jsd_t* self, const char* ifname, uint8_t enable_autorecovery) {
   jsd_sdo_req_cirq_init(&self->jsd_sdo_res_cirq, "Response Queue");
 
   // Make sure to only start this after the PO2OP hooks have completed
-  if (0 != pthread_create(&self->sdo_thread, NULL, sdo_thread_loop, (void*)self)) {
+  if (0 != jsd_memory_thread_create(&self->sdo_thread, self->arena.base != NULL,
+                                    sdo_thread_loop, (void*)self)) {
     ERROR("Failed to create SDO thread");
     return false;
   }
+  jsd_startup_end_phase(self, JSD_INIT_PHASE_THREADS);
   self->init_complete = true;
 
+  if (self->arena.base) {
+    jsd_memory_prefault_stack(JSD_MEMORY_CALLER_STACK_PREFAULT_BYTES);
+    jsd_memory_forbid_malloc(true);
+  }
+
   SUCCESS("JSD is Operational");
 
   return true;
 }
 
+bool jsd_init(jsd_t* self, const char* ifname, uint8_t enable_autorecovery) {
+  assert(self);
+  jsd_startup_begin(self);
+  bool success = jsd_init_bus(self, ifname, enable_autorecovery);
+  jsd_startup_end(self, success);
+  return success;
+}
+
 void jsd_read(jsd_t* self, int timeout_us) {
   assert(self);
 
   // Wait for EtherCat frame to return from slaves, with logic for smart prints
-  self->wkc = ecx_receive_processdata(&self->ecx_context, timeout_us);
+  bool watchdog_running =
+      __atomic_load_n(&self->watchdog.running, __ATOMIC_ACQUIRE);
+  if (watchdog_running) {
+    pthread_mutex_lock(&self->watchdog.frame_mutex);
+  }
+  // The watchdog receives the frame of a stalled cycle before sending its own
+  bool frame_received = self->watchdog.frame_received;
+  if (frame_received) {
+    self->wkc                     = self->watchdog.frame_wkc;
+    self->watchdog.frame_received = false;
+  } else {
+    self->wkc = ecx_receive_processdata(&self->ecx_context, timeout_us);
+  }
+  __atomic_store_n(&self->watchdog.frame_pending, false, __ATOMIC_RELEASE);
+  if (watchdog_running) {
+    pthread_mutex_unlock(&self->watchdog.frame_mutex);
+  }
+  jsd_time_get_cycle_time(&self->cycle_time);
+
+  // DCtime is only refreshed by a returned frame on a bus with DC, and is
+  // overwritten by the safe outputs frames of the watchdog
+  self->cycle_time.dc_valid = self->ecx_context.grouplist[0].hasdc &&
+                              self->wkc > 0 && !frame_received;
+  if (self->cycle_time.dc_valid) {
+    self->cycle_time.dc_nsec = *self->ecx_context.DCtime;
+    jsd_time_dc_correlation_update(&self->dc_correlation, &self->cycle_time);
+  }
+
+  jsd_metrics_increment(&self->metrics.bus.cycles);
+  if (self->wkc != self->expected_wkc) {
+    jsd_metrics_increment(&self->metrics.bus.bad_wkc_cycles);
+    if (self->wkc == EC_NOFRAME) {
+      jsd_metrics_increment(&self->metrics.bus.lost_frames);
+    }
+  }
+
   if (self->wkc != self->expected_wkc && self->last_wkc != self->wkc) {
     WARNING("ecx_receive_processdata returning bad wkc: %d (expected: %d)",
             self->wkc, self->expected_wkc);
@@ -239,6 +405,10 @@ void jsd_read(jsd_t* self, int timeout_us) {
   }
   self->last_wkc = self->wkc;
 
+  if (self->diag.running) {
+    jsd_diag_check_wkc(self);
+  }
+
   if (self->enable_autorecovery || self->attempt_manual_recovery) {
     jsd_ecatcheck(self);
     self->attempt_manual_recovery = 0;
@@ -249,22 +419,53 @@ void jsd_read(jsd_t* self, int timeout_us) {
     self->raise_sdo_thread_cond = false;
   }
 
+  // A hot-plugged slave joins the image between two cycles
+  if (self->hotplug.running &&
+      __atomic_load_n(&self->hotplug.pending, __ATOMIC_ACQUIRE)) {
+    jsd_hotplug_apply(self);
+  }
 }
 
 void jsd_write(jsd_t* self) {
   assert(self);
 
   // Write EtherCat frame to slaves, with logic for smart prints
-  int transmitted = ecx_send_overlap_processdata(&self->ecx_context);
+  int transmitted;
+  if (__atomic_load_n(&self->watchdog.running, __ATOMIC_ACQUIRE)) {
+    pthread_mutex_lock(&self->watchdog.frame_mutex);
+    transmitted = ecx_send_overlap_processdata(&self->ecx_context);
+    __atomic_store_n(&self->watchdog.frame_pending, true, __ATOMIC_RELEASE);
+    jsd_watchdog_heartbeat(self);
+    pthread_mutex_unlock(&self->watchdog.frame_mutex);
+  } else {
+    // The watchdog may be started by another thread during this cycle
+    transmitted = ecx_send_overlap_processdata(&self->ecx_context);
+    __atomic_store_n(&self->watchdog.frame_pending, true, __ATOMIC_RELEASE);
+  }
 
-  static int last_transmitted = 1;
-  if (transmitted <= 0 && last_transmitted != transmitted) {
+  if (transmitted <= 0) {
+    jsd_metrics_increment(&self->metrics.bus.transmit_failures);
+  }
+  if (transmitted <= 0 && self->last_transmitted != transmitted) {
     WARNING("ecx_send_overlap_processdata is not transmitting");
   }
-  if (last_transmitted <= 0 && transmitted > 0) {
+  if (self->last_transmitted <= 0 && transmitted > 0) {
     MSG("ecx_send_overlap_processdata has resumed transmission");
   }
-  last_transmitted = transmitted;
+  self->last_transmitted = transmitted;
+
+  if (self->capture.running) {
+    jsd_capture_mark_cycle(self);
+  }
+  if (self->recorder.map && !self->recorder.replaying) {
+    jsd_recorder_record(self);
+  }
+  if (self->shm.segment) {
+    jsd_shm_publish(self);
+  }
+  if (self->flight.running) {
+    jsd_flight_record(self);
+  }
 }
 
 void jsd_free(jsd_t* self) {
@@ -272,6 +473,16 @@ void jsd_free(jsd_t* self) {
     return;
   }
 
+  jsd_memory_forbid_malloc(false);
+  jsd_watchdog_stop(self);
+  jsd_capture_stop(self);
+  jsd_recorder_stop(self);
+  jsd_shm_stop(self);
+  jsd_flight_stop(self);
+  jsd_hotplug_stop(self);
+  jsd_diag_stop(self);
+  jsd_metrics_export_stop(self);
+
   if(self->init_complete){
     struct timespec ts;
 
@@ -296,6 +507,12 @@ void jsd_free(jsd_t* self) {
   MSG_DEBUG("Closing SOEM socket connection...");
   ecx_close(&self->ecx_context);
 
+  if (self->arena.base) {
+    jsd_memory_arena_destroy(&self->arena);
+    MSG_DEBUG("Freed JSD context arena");
+    return;
+  }
+
   free(self->ecx_context.port);
   free(self->ecx_context.slavelist);
   free(self->ecx_context.slavecount);
@@ -320,6 +537,58 @@ ec_state jsd_get_device_state(jsd_t* self, uint16_t slave_id) {
   return self->ecx_context.slavelist[slave_id].state;
 }
 
+bool jsd_get_device(jsd_t* self, uint16_t slave_id, uint32_t product_code,
+                    jsd_device_t* device) {
+  assert(self);
+  assert(device);
+
+  if (!self->init_complete) {
+    ERROR("Device handles must be resolved after jsd_init()");
+    return false;
+  }
+  if (slave_id == 0 || slave_id > *self->ecx_context.slavecount) {
+    ERROR("Bad slave_id: %u", slave_id);
+    return false;
+  }
+  if (!self->slave_configs[slave_id].configuration_active) {
+    ERROR("slave[%u] is not configured", slave_id);
+    return false;
+  }
+
+  ec_slavet* slave = &self->ecx_context.slavelist[slave_id];
+  if (slave->eep_id != product_code) {
+    ERROR("slave[%u] product code (%u) does not match requested (%u)",
+          slave_id, slave->eep_id, product_code);
+    return false;
+  }
+
+  device->jsd      = self;
+  device->slave_id = slave_id;
+  device->inputs   = slave->inputs;
+  device->outputs  = slave->outputs;
+  device->config   = &self->slave_configs[slave_id];
+  device->state    = &self->slave_states[slave_id];
+
+  return true;
+}
+
+jsd_cycle_time_t jsd_get_cycle_time(jsd_t* self) {
+  assert(self);
+  return self->cycle_time;
+}
+
+bool jsd_dc_time_to_mono_time_nsec(jsd_t* self, int64_t dc_nsec,
+                                   int64_t* mono_nsec) {
+  assert(self);
+  return jsd_time_dc_to_mono_nsec(&self->dc_correlation, dc_nsec, mono_nsec);
+}
+
+bool jsd_dc_time_to_real_time_nsec(jsd_t* self, int64_t dc_nsec,
+                                   int64_t* real_nsec) {
+  assert(self);
+  return jsd_time_dc_to_real_nsec(&self->dc_correlation, dc_nsec, real_nsec);
+}
+
 void jsd_set_manual_recovery(jsd_t* self) {
   assert(self);
   self->attempt_manual_recovery = 1;
@@ -346,9 +615,10 @@ char* jsd_ec_state_to_string(ec_state state) {
       return "EC_STATE_ACK/ERROR";
       break;
     default: {
-      char str[JSD_NAME_LEN];
+      // Not heap allocated so it is safe to call from the real-time thread
+      static __thread char str[JSD_NAME_LEN];
       snprintf(str, JSD_NAME_LEN, "Bad EC_STATE: 0x%x", state);
-      return strdup(str);
+      return str;
       break;
     }
   }
@@ -489,9 +759,15 @@ void jsd_ecatcheck(jsd_t* self) {
 
   if ((bus_state == EC_STATE_OPERATIONAL && self->wkc < self->expected_wkc) ||
       self->ecx_context.grouplist[currentgroup].docheckstate) {
+    // The hot-plug thread may be configuring a slave with the same mailbox and
+    // SII state, the slaves are checked on a later cycle then
+    if (pthread_mutex_trylock(&self->hotplug.config_mutex) != 0) {
+      return;
+    }
     /* one ore more slaves are not responding */
     self->ecx_context.grouplist[currentgroup].docheckstate = FALSE;
     ecx_readstate(&self->ecx_context);
+    jsd_metrics_update_states(self, true);
     for (slave = 1; slave <= *self->ecx_context.slavecount; slave++) {
       if ((self->ecx_context.slavelist[slave].group == currentgroup) &&
           (self->ecx_context.slavelist[slave].state != EC_STATE_OPERATIONAL)) {
@@ -499,18 +775,27 @@ void jsd_ecatcheck(jsd_t* self) {
         if (self->ecx_context.slavelist[slave].state ==
             (EC_STATE_SAFE_OP + EC_STATE_ERROR)) {
           MSG_DEBUG("slave[%d] is in SAFE_OP + ERROR, attempting ack.", slave);
+          jsd_metrics_record_recovery(self, slave,
+                                      JSD_RECOVERY_EVENT_ACK_ERROR);
           self->ecx_context.slavelist[slave].state =
               (EC_STATE_SAFE_OP + EC_STATE_ACK);
           ecx_writestate(&self->ecx_context, slave);
         } else if (self->ecx_context.slavelist[slave].state ==
                    EC_STATE_SAFE_OP) {
           MSG_DEBUG("slave[%d] is in SAFE_OP, changing to OPERATIONAL.", slave);
+          jsd_metrics_record_recovery(self, slave,
+                                      JSD_RECOVERY_EVENT_REQUEST_OP);
           self->ecx_context.slavelist[slave].state = EC_STATE_OPERATIONAL;
           ecx_writestate(&self->ecx_context, slave);
         } else if (self->ecx_context.slavelist[slave].state > EC_STATE_NONE) {
-          if (ecx_reconfig_slave(&self->ecx_context, slave, EC_TIMEOUTRET3)) {
+          if (jsd_reconfig_slave(self, slave, EC_TIMEOUTRET3)) {
+            jsd_reconfig_stats_t stats = jsd_reconfig_get_stats(self, slave);
             self->ecx_context.slavelist[slave].islost = FALSE;
-            MSG("slave[%d] was reconfigured", slave);
+            MSG("slave[%d] was reconfigured (%s) in %.1f ms", slave,
+                jsd_reconfig_path_to_string(stats.last_path),
+                (double)stats.last_duration_nsec / 1e6);
+            jsd_metrics_record_recovery(self, slave,
+                                        JSD_RECOVERY_EVENT_RECONFIG);
           }
         } else if (!self->ecx_context.slavelist[slave].islost) {
           /* re-check state */
@@ -519,6 +804,7 @@ void jsd_ecatcheck(jsd_t* self) {
           if (self->ecx_context.slavelist[slave].state == EC_STATE_NONE) {
             self->ecx_context.slavelist[slave].islost = TRUE;
             ERROR("slave[%d] is lost", slave);
+            jsd_metrics_record_recovery(self, slave, JSD_RECOVERY_EVENT_LOST);
           }
         }
       }
@@ -527,14 +813,18 @@ void jsd_ecatcheck(jsd_t* self) {
           if (ecx_recover_slave(&self->ecx_context, slave, EC_TIMEOUTRET3)) {
             self->ecx_context.slavelist[slave].islost = FALSE;
             MSG("slave[%d] recovered", slave);
+            jsd_metrics_record_recovery(self, slave,
+                                        JSD_RECOVERY_EVENT_RECOVERED);
           }
         } else {
           self->ecx_context.slavelist[slave].islost = FALSE;
           MSG("slave %d found", slave);
+          jsd_metrics_record_recovery(self, slave, JSD_RECOVERY_EVENT_FOUND);
         }
       }
     }
     if (!self->ecx_context.grouplist[currentgroup].docheckstate)
       SUCCESS("all slaves resumed OPERATIONAL.");
+    pthread_mutex_unlock(&self->hotplug.config_mutex);
   }
 }
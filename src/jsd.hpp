@@ -0,0 +1,359 @@
+#ifndef JSD_HPP
+#define JSD_HPP
+
+/**
+ * @file jsd.hpp
+ * @brief Header-only C++ layer over the JSD C API
+ *
+ * jsd::Bus owns a JSD context. jsd::Device<PRODUCT_CODE> is a typed device
+ * handle whose product code is fixed at compile time and verified against the
+ * bus once, at bind time. State reads return references into JSD's own state,
+ * no copies are made, and every call inlines to the C function it wraps.
+ *
+ * Errors are reported through bool return values, like the C API.
+ */
+
+#include <cstdint>
+#include <type_traits>
+
+#include "jsd/jsd_ati_fts_pub.h"
+#include "jsd/jsd_egd_pub.h"
+#include "jsd/jsd_el2124_pub.h"
+#include "jsd/jsd_el3104_pub.h"
+#include "jsd/jsd_el3162_pub.h"
+#include "jsd/jsd_el3202_pub.h"
+#include "jsd/jsd_el3208_pub.h"
+#include "jsd/jsd_el3318_pub.h"
+#include "jsd/jsd_el3356_pub.h"
+#include "jsd/jsd_el3602_pub.h"
+#include "jsd/jsd_el4102_pub.h"
+#include "jsd/jsd_epd_pub.h"
+#include "jsd/jsd_ild1900_pub.h"
+#include "jsd/jsd_jed0101_pub.h"
+#include "jsd/jsd_jed0200_pub.h"
+#include "jsd/jsd_pub.h"
+
+namespace jsd {
+
+/**
+ * @brief RAII owner of a JSD context
+ */
+class Bus {
+ public:
+  Bus() : self_(jsd_alloc()) {}
+
+  /// Allocates the context in real-time memory mode, see jsd_alloc_rt(...)
+  explicit Bus(jsd_memory_config_t config) : self_(jsd_alloc_rt(config)) {}
+
+  ~Bus() { jsd_free(self_); }
+
+  Bus(const Bus&) = delete;
+  Bus& operator=(const Bus&) = delete;
+
+  Bus(Bus&& other) noexcept : self_(other.self_) { other.self_ = nullptr; }
+  Bus& operator=(Bus&& other) noexcept {
+    if (this != &other) {
+      jsd_free(self_);
+      self_       = other.self_;
+      other.self_ = nullptr;
+    }
+    return *this;
+  }
+
+  /// false if the context could not be allocated
+  explicit operator bool() const { return self_ != nullptr; }
+
+  jsd_t*       get() { return self_; }
+  const jsd_t* get() const { return self_; }
+
+  void set_slave_config(uint16_t slave_id, const jsd_slave_config_t& config) {
+    jsd_set_slave_config(self_, slave_id, config);
+  }
+
+  bool init(const char* ifname, bool enable_autorecovery) {
+    return jsd_init(self_, ifname, enable_autorecovery ? 1 : 0);
+  }
+
+  void read(int timeout_us) { jsd_read(self_, timeout_us); }
+  void write() { jsd_write(self_); }
+
+  const jsd_cycle_time_t& cycle_time() const { return self_->cycle_time; }
+
+ private:
+  jsd_t* self_;
+};
+
+namespace detail {
+
+template <uint32_t ProductCode>
+bool get_device(jsd_t* self, uint16_t slave_id, jsd_device_t* device) {
+  return jsd_get_device(self, slave_id, ProductCode, device);
+}
+
+inline const jsd_device_t& device(const jsd_device_t& device) { return device; }
+
+/// Typed handles of the C API wrap a jsd_device_t
+template <typename Handle>
+const jsd_device_t& device(const Handle& handle) {
+  return handle.dev;
+}
+
+}  // namespace detail
+
+/**
+ * @brief Compile-time description of a supported device
+ *
+ * Specialized below for every JSD driver. rx_bytes and tx_bytes are the sizes
+ * of the driver's PDO structs, 0 when the layout depends on configuration.
+ * Drivers keep those structs in private headers, so their sizes are spelled
+ * out here and checked against the structs by jsd_hpp_test.
+ * Handle is the driver's typed handle when it has one, so read() and process()
+ * use its functions without per-call validation, jsd_device_t otherwise.
+ */
+template <uint32_t ProductCode>
+struct DeviceTraits {
+  static constexpr bool supported = false;
+};
+
+// READ and PROCESS are statements on the resolved handle h
+#define JSD_HPP_DEVICE_TRAITS(CODE, NAME, STATE_T, MEMBER, RX_BYTES, TX_BYTES, \
+                              HANDLE_T, GET_HANDLE, READ, PROCESS)             \
+  template <>                                                                  \
+  struct DeviceTraits<CODE> {                                                  \
+    static constexpr bool        supported = true;                            \
+    static constexpr const char* name      = NAME;                            \
+    static constexpr uint32_t    rx_bytes  = RX_BYTES;                        \
+    static constexpr uint32_t    tx_bytes  = TX_BYTES;                        \
+    using State                            = STATE_T;                         \
+    using Handle                           = HANDLE_T;                        \
+    static bool get_handle(jsd_t* self, uint16_t slave_id, Handle* handle) {  \
+      return GET_HANDLE(self, slave_id, handle);                              \
+    }                                                                          \
+    static const State* state(const jsd_slave_state_t* s) {                   \
+      return &s->MEMBER;                                                       \
+    }                                                                          \
+    static void read(const Handle& h) {                                       \
+      (void)h;                                                                 \
+      READ;                                                                    \
+    }                                                                          \
+    static void process(const Handle& h) {                                    \
+      (void)h;                                                                 \
+      PROCESS;                                                                 \
+    }                                                                          \
+  };
+
+// Devices without a typed handle go through the (jsd_t*, slave_id) API
+#define JSD_HPP_SLAVE_ID_CALL(FUNCTION) FUNCTION(h.jsd, h.slave_id)
+
+JSD_HPP_DEVICE_TRAITS(JSD_EL3602_PRODUCT_CODE, "EL3602", jsd_el3602_state_t,
+                      el3602, 0, 12, jsd_el3602_handle_t, jsd_el3602_get_handle,
+                      jsd_el3602_handle_read(&h), )
+JSD_HPP_DEVICE_TRAITS(JSD_EL3208_PRODUCT_CODE, "EL3208", jsd_el3208_state_t,
+                      el3208, 0, 32, jsd_device_t,
+                      detail::get_device<JSD_EL3208_PRODUCT_CODE>,
+                      JSD_HPP_SLAVE_ID_CALL(jsd_el3208_read), )
+JSD_HPP_DEVICE_TRAITS(JSD_EL2124_PRODUCT_CODE, "EL2124", jsd_el2124_state_t,
+                      el2124, 0, 0, jsd_el2124_handle_t, jsd_el2124_get_handle,
+                      , jsd_el2124_handle_process(&h))
+JSD_HPP_DEVICE_TRAITS(JSD_EGD_PRODUCT_CODE, "EGD", jsd_egd_state_t, egd.pub, 0,
+                      sizeof(jsd_egd_txpdo_data_t), jsd_device_t,
+                      detail::get_device<JSD_EGD_PRODUCT_CODE>,
+                      JSD_HPP_SLAVE_ID_CALL(jsd_egd_read),
+                      JSD_HPP_SLAVE_ID_CALL(jsd_egd_process))
+JSD_HPP_DEVICE_TRAITS(JSD_EL3356_PRODUCT_CODE, "EL3356", jsd_el3356_state_t,
+                      el3356, 2, 6, jsd_device_t,
+                      detail::get_device<JSD_EL3356_PRODUCT_CODE>,
+                      JSD_HPP_SLAVE_ID_CALL(jsd_el3356_read),
+                      JSD_HPP_SLAVE_ID_CALL(jsd_el3356_process))
+JSD_HPP_DEVICE_TRAITS(JSD_JED0101_PRODUCT_CODE, "JED0101", jsd_jed0101_state_t,
+                      jed0101, 2, 18, jsd_device_t,
+                      detail::get_device<JSD_JED0101_PRODUCT_CODE>,
+                      JSD_HPP_SLAVE_ID_CALL(jsd_jed0101_read),
+                      JSD_HPP_SLAVE_ID_CALL(jsd_jed0101_process))
+JSD_HPP_DEVICE_TRAITS(JSD_JED0200_PRODUCT_CODE, "JED0200", jsd_jed0200_state_t,
+                      jed0200, 2, 38, jsd_device_t,
+                      detail::get_device<JSD_JED0200_PRODUCT_CODE>,
+                      JSD_HPP_SLAVE_ID_CALL(jsd_jed0200_read),
+                      JSD_HPP_SLAVE_ID_CALL(jsd_jed0200_process))
+JSD_HPP_DEVICE_TRAITS(JSD_ATI_FTS_PRODUCT_CODE, "ATI_FTS", jsd_ati_fts_state_t,
+                      ati_fts, 8, 32, jsd_device_t,
+                      detail::get_device<JSD_ATI_FTS_PRODUCT_CODE>,
+                      JSD_HPP_SLAVE_ID_CALL(jsd_ati_fts_read),
+                      JSD_HPP_SLAVE_ID_CALL(jsd_ati_fts_process))
+JSD_HPP_DEVICE_TRAITS(JSD_EL3104_PRODUCT_CODE, "EL3104", jsd_el3104_state_t,
+                      el3104, 0, 16, jsd_device_t,
+                      detail::get_device<JSD_EL3104_PRODUCT_CODE>,
+                      JSD_HPP_SLAVE_ID_CALL(jsd_el3104_read), )
+JSD_HPP_DEVICE_TRAITS(JSD_EL3202_PRODUCT_CODE, "EL3202", jsd_el3202_state_t,
+                      el3202, 0, 8, jsd_device_t,
+                      detail::get_device<JSD_EL3202_PRODUCT_CODE>,
+                      JSD_HPP_SLAVE_ID_CALL(jsd_el3202_read), )
+JSD_HPP_DEVICE_TRAITS(JSD_EL3318_PRODUCT_CODE, "EL3318", jsd_el3318_state_t,
+                      el3318, 0, 32, jsd_device_t,
+                      detail::get_device<JSD_EL3318_PRODUCT_CODE>,
+                      JSD_HPP_SLAVE_ID_CALL(jsd_el3318_read), )
+JSD_HPP_DEVICE_TRAITS(JSD_EL3162_PRODUCT_CODE, "EL3162", jsd_el3162_state_t,
+                      el3162, 0, 6, jsd_device_t,
+                      detail::get_device<JSD_EL3162_PRODUCT_CODE>,
+                      JSD_HPP_SLAVE_ID_CALL(jsd_el3162_read), )
+JSD_HPP_DEVICE_TRAITS(JSD_EL4102_PRODUCT_CODE, "EL4102", jsd_el4102_state_t,
+                      el4102, 4, 0, jsd_device_t,
+                      detail::get_device<JSD_EL4102_PRODUCT_CODE>, ,
+                      JSD_HPP_SLAVE_ID_CALL(jsd_el4102_process))
+JSD_HPP_DEVICE_TRAITS(JSD_ILD1900_PRODUCT_CODE, "ILD1900", jsd_ild1900_state_t,
+                      ild1900, 0, 28, jsd_device_t,
+                      detail::get_device<JSD_ILD1900_PRODUCT_CODE>,
+                      JSD_HPP_SLAVE_ID_CALL(jsd_ild1900_read), )
+JSD_HPP_DEVICE_TRAITS(JSD_EPD_PRODUCT_CODE, "EPD", jsd_epd_state_t, epd.pub,
+                      sizeof(jsd_epd_rxpdo_data_t),
+                      sizeof(jsd_epd_txpdo_data_t), jsd_epd_handle_t,
+                      jsd_epd_get_handle,
+                      jsd_epd_read(h.dev.jsd, h.dev.slave_id),
+                      jsd_epd_process(h.dev.jsd, h.dev.slave_id))
+
+#undef JSD_HPP_SLAVE_ID_CALL
+#undef JSD_HPP_DEVICE_TRAITS
+
+/**
+ * @brief Typed device handle
+ *
+ * Usage:
+ * @code
+ *   jsd::Device<JSD_EL3602_PRODUCT_CODE> adc;
+ *   if (!adc.bind(bus, 3)) { ... }
+ *   adc.read();
+ *   double v = adc.state().voltage[0];
+ * @endcode
+ */
+template <uint32_t ProductCode>
+class Device {
+  static_assert(DeviceTraits<ProductCode>::supported,
+                "jsd::Device: no JSD driver for this product code");
+
+ public:
+  using Traits = DeviceTraits<ProductCode>;
+  using State  = typename Traits::State;
+
+  static constexpr uint32_t product_code = ProductCode;
+
+  /**
+   * @brief Resolves the handle, call once after Bus::init(...)
+   *
+   * Verifies the product code and that the slave's mapped PDO images hold the
+   * driver's PDO structs.
+   *
+   * @return true if the slave can be driven through this handle
+   */
+  bool bind(Bus& bus, uint16_t slave_id) {
+    bound_ = false;
+    if (!Traits::get_handle(bus.get(), slave_id, &handle_)) {
+      return false;
+    }
+    const ec_slavet* slave = &bus.get()->ecx_context.slavelist[slave_id];
+    if (slave->Obytes < Traits::rx_bytes || slave->Ibytes < Traits::tx_bytes) {
+      ERROR("%s[%u] PDO images (%u/%u bytes) are smaller than expected (%u/%u)",
+            Traits::name, slave_id, slave->Obytes, slave->Ibytes,
+            Traits::rx_bytes, Traits::tx_bytes);
+      return false;
+    }
+    bound_ = true;
+    return true;
+  }
+
+  bool     bound() const { return bound_; }
+  uint16_t slave_id() const { return raw().slave_id; }
+
+  /// Zero-copy view of the device state
+  const State& state() const { return *Traits::state(raw().state); }
+
+  /// Converts the received PDO data to state, no-op for output-only devices
+  void read() { Traits::read(handle_); }
+
+  /// Packs commands into the outgoing PDO data, no-op for input-only devices
+  void process() { Traits::process(handle_); }
+
+  const jsd_device_t& raw() const { return detail::device(handle_); }
+
+ protected:
+  typename Traits::Handle handle_ = {};
+  bool                    bound_  = false;
+};
+
+using El3602 = Device<JSD_EL3602_PRODUCT_CODE>;
+using El3208 = Device<JSD_EL3208_PRODUCT_CODE>;
+using El2124 = Device<JSD_EL2124_PRODUCT_CODE>;
+using Egd    = Device<JSD_EGD_PRODUCT_CODE>;
+using El3356 = Device<JSD_EL3356_PRODUCT_CODE>;
+using Jed0101 = Device<JSD_JED0101_PRODUCT_CODE>;
+using Jed0200 = Device<JSD_JED0200_PRODUCT_CODE>;
+using AtiFts  = Device<JSD_ATI_FTS_PRODUCT_CODE>;
+using El3104  = Device<JSD_EL3104_PRODUCT_CODE>;
+using El3202  = Device<JSD_EL3202_PRODUCT_CODE>;
+using El3318  = Device<JSD_EL3318_PRODUCT_CODE>;
+using El3162  = Device<JSD_EL3162_PRODUCT_CODE>;
+using El4102  = Device<JSD_EL4102_PRODUCT_CODE>;
+using Ild1900 = Device<JSD_ILD1900_PRODUCT_CODE>;
+using Epd     = Device<JSD_EPD_PRODUCT_CODE>;
+
+/**
+ * @brief Commands for Elmo drives, usable in constant expressions
+ */
+namespace elmo {
+
+constexpr jsd_elmo_motion_command_csp_t csp(int32_t target_position,
+                                            int32_t position_offset    = 0,
+                                            int32_t velocity_offset    = 0,
+                                            double  torque_offset_amps = 0.0) {
+  return jsd_elmo_motion_command_csp_t{target_position, position_offset,
+                                       velocity_offset, torque_offset_amps};
+}
+
+constexpr jsd_elmo_motion_command_csv_t csv(int32_t target_velocity,
+                                            int32_t velocity_offset    = 0,
+                                            double  torque_offset_amps = 0.0) {
+  return jsd_elmo_motion_command_csv_t{target_velocity, velocity_offset,
+                                       torque_offset_amps};
+}
+
+constexpr jsd_elmo_motion_command_cst_t cst(double target_torque_amps,
+                                            double torque_offset_amps = 0.0) {
+  return jsd_elmo_motion_command_cst_t{target_torque_amps, torque_offset_amps};
+}
+
+}  // namespace elmo
+
+/**
+ * @brief EPD handle with the hot-path commands of the C handle API
+ */
+class EpdDrive : public Epd {
+ public:
+  void halt() { jsd_epd_handle_halt(&handle_); }
+  void reset() { jsd_epd_reset(handle_.dev.jsd, handle_.dev.slave_id); }
+
+  void set_digital_output(uint8_t index, uint8_t output) {
+    jsd_epd_handle_set_digital_output(&handle_, index, output);
+  }
+  void set(const jsd_elmo_motion_command_csp_t& cmd) {
+    jsd_epd_handle_set_motion_command_csp(&handle_, cmd);
+  }
+  void set(const jsd_elmo_motion_command_csv_t& cmd) {
+    jsd_epd_handle_set_motion_command_csv(&handle_, cmd);
+  }
+  void set(const jsd_elmo_motion_command_cst_t& cmd) {
+    jsd_epd_handle_set_motion_command_cst(&handle_, cmd);
+  }
+};
+
+/**
+ * @brief EL2124 handle with per-channel output commands
+ */
+class El2124Outputs : public El2124 {
+ public:
+  void write(uint8_t channel, bool output) {
+    jsd_el2124_handle_write_single_channel(&handle_, channel, output ? 1 : 0);
+  }
+};
+
+}  // namespace jsd
+
+#endif
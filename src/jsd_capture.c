@@ -0,0 +1,625 @@
+#include "jsd/jsd_capture.h"
+
+#include <arpa/inet.h>
+#include <assert.h>
+#include <linux/if_packet.h>
+#include <linux/net_tstamp.h>
+#include <linux/sockios.h>
+#include <net/if.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "jsd/jsd_memory.h"
+#include "jsd/jsd_print.h"
+#include "jsd/jsd_time.h"
+
+// Kernel ring: blocks are handed to the writer when full or after a timeout
+#define JSD_CAPTURE_BLOCK_BYTES (1 << 20)
+#define JSD_CAPTURE_FRAME_BYTES (2048)
+#define JSD_CAPTURE_DEFAULT_RING_BYTES (8 << 20)
+#define JSD_CAPTURE_BLOCK_TIMEOUT_MS (10)
+#define JSD_CAPTURE_POLL_TIMEOUT_MS (100)
+
+// A cycle publishes its marks right after the send returns
+#define JSD_CAPTURE_MARK_WAIT_NSEC (200000LL)
+
+#define JSD_CAPTURE_DATAGRAM_HEADER_BYTES (10)
+
+#define JSD_PCAPNG_SHB (0x0A0D0D0A)
+#define JSD_PCAPNG_IDB (0x00000001)
+#define JSD_PCAPNG_EPB (0x00000006)
+#define JSD_PCAPNG_BYTE_ORDER_MAGIC (0x1A2B3C4D)
+#define JSD_PCAPNG_LINKTYPE_ETHERNET (1)
+#define JSD_PCAPNG_OPT_END (0)
+#define JSD_PCAPNG_OPT_COMMENT (1)
+#define JSD_PCAPNG_SHB_USERAPPL (4)
+#define JSD_PCAPNG_IF_NAME (2)
+#define JSD_PCAPNG_IF_TSRESOL (9)
+#define JSD_PCAPNG_EPB_FLAGS (2)
+#define JSD_PCAPNG_EPB_INBOUND (1)
+#define JSD_PCAPNG_EPB_OUTBOUND (2)
+
+// Room for the block header, a captured frame and its options
+#define JSD_PCAPNG_MAX_BLOCK_BYTES (JSD_CAPTURE_FRAME_BYTES + 128)
+
+typedef struct {
+  bool    cyclic;    ///< carries process data
+  bool    mailbox;   ///< carries mailbox data or mailbox status polls
+  bool    selected;  ///< reaches a slave of the subset
+  uint8_t first_idx;
+} jsd_capture_frame_info_t;
+
+/****************************************************
+ * Frame classification
+ ****************************************************/
+
+static uint16_t jsd_capture_read_u16(const uint8_t* data) {
+  return data[0] | (data[1] << 8);
+}
+
+static uint16_t jsd_capture_find_station(jsd_t* self, uint16_t configadr) {
+  uint16_t num_slaves = *self->ecx_context.slavecount;
+  uint16_t slave_id;
+  for (slave_id = 1; slave_id <= num_slaves; ++slave_id) {
+    if (self->ecx_context.slavelist[slave_id].configadr == configadr) {
+      return slave_id;
+    }
+  }
+  return 0;
+}
+
+static bool jsd_capture_is_mailbox(jsd_t* self, uint16_t slave_id,
+                                   uint16_t ado) {
+  ec_slavet* slave = &self->ecx_context.slavelist[slave_id];
+  if (slave->mbx_l == 0) {
+    return false;
+  }
+  return (ado >= slave->mbx_wo && ado < slave->mbx_wo + slave->mbx_l) ||
+         (ado >= slave->mbx_ro && ado < slave->mbx_ro + slave->mbx_rl) ||
+         ado == ECT_REG_SM0STAT || ado == ECT_REG_SM1STAT;
+}
+
+static bool jsd_capture_parse(jsd_t* self, const uint8_t* data, size_t bytes,
+                              jsd_capture_frame_info_t* info) {
+  memset(info, 0, sizeof(*info));
+  if (bytes < ETH_HEADERSIZE + EC_ELENGTHSIZE ||
+      ((data[12] << 8) | data[13]) != ETH_P_ECAT) {
+    return false;
+  }
+
+  const uint8_t* datagram   = data + ETH_HEADERSIZE + EC_ELENGTHSIZE;
+  const uint8_t* end        = data + bytes;
+  uint16_t       num_slaves = *self->ecx_context.slavecount;
+  bool           more       = true;
+  bool           first      = true;
+
+  while (more && datagram + JSD_CAPTURE_DATAGRAM_HEADER_BYTES <= end) {
+    uint8_t  cmd      = datagram[0];
+    uint16_t adp      = jsd_capture_read_u16(&datagram[2]);
+    uint16_t ado      = jsd_capture_read_u16(&datagram[4]);
+    uint16_t length   = jsd_capture_read_u16(&datagram[6]);
+    uint16_t slave_id = 0;
+
+    if (first) {
+      info->first_idx = datagram[1];
+      first           = false;
+    }
+
+    switch (cmd) {
+      case EC_CMD_LRD:
+      case EC_CMD_LWR:
+      case EC_CMD_LRW:
+        info->cyclic   = true;
+        info->selected = true;
+        break;
+      case EC_CMD_BRD:
+      case EC_CMD_BWR:
+      case EC_CMD_BRW:
+      case EC_CMD_ARMW:
+        info->selected = true;
+        break;
+      case EC_CMD_APRD:
+      case EC_CMD_APWR:
+      case EC_CMD_APRW:
+        // Auto-increment addresses count down from 0 at the first slave
+        slave_id = (uint16_t)(1 - (int16_t)adp);
+        break;
+      case EC_CMD_FPRD:
+      case EC_CMD_FPWR:
+      case EC_CMD_FPRW:
+      case EC_CMD_FRMW:
+        slave_id = jsd_capture_find_station(self, adp);
+        break;
+      default:
+        break;
+    }
+
+    if (slave_id >= 1 && slave_id <= num_slaves) {
+      info->mailbox |= jsd_capture_is_mailbox(self, slave_id, ado);
+      info->selected |= self->capture.slave_selected[slave_id];
+    }
+
+    more = length & 0x8000;
+    datagram += JSD_CAPTURE_DATAGRAM_HEADER_BYTES + (length & 0x07FF) +
+                EC_WKCSIZE;
+  }
+  return true;
+}
+
+static bool jsd_capture_select(jsd_t* self,
+                               const jsd_capture_frame_info_t* info) {
+  jsd_capture_t* cap = &self->capture;
+  if (cap->filter == JSD_CAPTURE_FILTER_CYCLIC && !info->cyclic) {
+    return false;
+  }
+  if (cap->filter == JSD_CAPTURE_FILTER_MAILBOX && !info->mailbox) {
+    return false;
+  }
+  return !cap->slave_filter || info->selected;
+}
+
+bool jsd_capture_select_frame(jsd_t* self, const uint8_t* data, size_t bytes) {
+  assert(self);
+  jsd_capture_frame_info_t info;
+  return jsd_capture_parse(self, data, bytes, &info) &&
+         jsd_capture_select(self, &info);
+}
+
+/****************************************************
+ * Cycle numbering
+ ****************************************************/
+
+void jsd_capture_mark_cycle(jsd_t* self) {
+  assert(self);
+  jsd_capture_t* cap   = &self->capture;
+  ec_idxstackT*  stack = self->ecx_context.idxstack;
+
+  uint32_t head = cap->marks_head;
+  uint32_t tail = __atomic_load_n(&cap->marks_tail, __ATOMIC_ACQUIRE);
+  if (head - tail + stack->pushed > JSD_CAPTURE_CYCLE_MARKS) {
+    __atomic_fetch_add(&cap->unmarked_cycles, 1, __ATOMIC_RELAXED);
+  } else {
+    uint8_t i;
+    for (i = 0; i < stack->pushed; ++i) {
+      jsd_capture_mark_t* mark =
+          &cap->marks[(head + i) % JSD_CAPTURE_CYCLE_MARKS];
+      mark->cycle = cap->cycle;
+      mark->idx   = stack->idx[i];
+    }
+    __atomic_store_n(&cap->marks_head, head + stack->pushed,
+                     __ATOMIC_RELEASE);
+  }
+  ++cap->cycle;
+}
+
+static bool jsd_capture_match_mark(jsd_capture_t* cap, uint8_t idx) {
+  uint32_t head = __atomic_load_n(&cap->marks_head, __ATOMIC_ACQUIRE);
+  uint32_t i;
+
+  // Marks of frames the kernel dropped are skipped over
+  for (i = cap->marks_tail; i != head; ++i) {
+    jsd_capture_mark_t* mark = &cap->marks[i % JSD_CAPTURE_CYCLE_MARKS];
+    if (mark->idx == idx) {
+      cap->current_cycle = mark->cycle;
+      cap->cycle_known   = true;
+      __atomic_store_n(&cap->marks_tail, i + 1, __ATOMIC_RELEASE);
+      return true;
+    }
+  }
+  return false;
+}
+
+static void jsd_capture_update_cycle(jsd_capture_t* cap, uint8_t idx) {
+  int64_t deadline =
+      jsd_time_get_mono_time_nsec() + JSD_CAPTURE_MARK_WAIT_NSEC;
+
+  // Frames not sent by jsd_write(...), e.g. by the watchdog, have no mark
+  while (!jsd_capture_match_mark(cap, idx) &&
+         jsd_time_get_mono_time_nsec() < deadline) {
+    usleep(10);
+  }
+}
+
+/****************************************************
+ * pcapng
+ ****************************************************/
+
+static size_t jsd_capture_pad(size_t bytes) { return (bytes + 3) & ~3UL; }
+
+static size_t jsd_capture_put(uint8_t* block, size_t offset, const void* value,
+                              size_t bytes) {
+  if (bytes > 0) {
+    memcpy(&block[offset], value, bytes);
+  }
+  memset(&block[offset + bytes], 0, jsd_capture_pad(bytes) - bytes);
+  return offset + jsd_capture_pad(bytes);
+}
+
+static size_t jsd_capture_put_option(uint8_t* block, size_t offset,
+                                     uint16_t code, const void* value,
+                                     uint16_t bytes) {
+  memcpy(&block[offset], &code, sizeof(code));
+  memcpy(&block[offset + 2], &bytes, sizeof(bytes));
+  return jsd_capture_put(block, offset + 4, value, bytes);
+}
+
+// The body starts at offset 8 of block, room for 4 more bytes is needed
+static bool jsd_capture_write_block(FILE* file, uint32_t type, uint8_t* block,
+                                    size_t offset) {
+  uint32_t total = offset + 4;
+  memcpy(&block[0], &type, 4);
+  memcpy(&block[4], &total, 4);
+  memcpy(&block[offset], &total, 4);
+  return fwrite(block, total, 1, file) == 1;
+}
+
+bool jsd_capture_write_header(FILE* file, const char* ifname) {
+  assert(file);
+  assert(ifname);
+  uint8_t block[256];
+  size_t  offset;
+
+  uint32_t magic          = JSD_PCAPNG_BYTE_ORDER_MAGIC;
+  uint16_t version[2]     = {1, 0};
+  int64_t  section_length = -1;
+  offset = jsd_capture_put(block, 8, &magic, sizeof(magic));
+  offset = jsd_capture_put(block, offset, version, sizeof(version));
+  offset = jsd_capture_put(block, offset, &section_length,
+                           sizeof(section_length));
+  offset = jsd_capture_put_option(block, offset, JSD_PCAPNG_SHB_USERAPPL,
+                                  "jsd", 3);
+  offset = jsd_capture_put_option(block, offset, JSD_PCAPNG_OPT_END, NULL, 0);
+  if (!jsd_capture_write_block(file, JSD_PCAPNG_SHB, block, offset)) {
+    return false;
+  }
+
+  uint16_t link[2]  = {JSD_PCAPNG_LINKTYPE_ETHERNET, 0};
+  uint32_t snaplen  = JSD_CAPTURE_FRAME_BYTES;
+  uint8_t  tsresol  = 9;  // nanoseconds
+  size_t   name_len = strnlen(ifname, IFNAMSIZ);
+  offset = jsd_capture_put(block, 8, link, sizeof(link));
+  offset = jsd_capture_put(block, offset, &snaplen, sizeof(snaplen));
+  offset = jsd_capture_put_option(block, offset, JSD_PCAPNG_IF_NAME, ifname,
+                                  name_len);
+  offset = jsd_capture_put_option(block, offset, JSD_PCAPNG_IF_TSRESOL,
+                                  &tsresol, sizeof(tsresol));
+  offset = jsd_capture_put_option(block, offset, JSD_PCAPNG_OPT_END, NULL, 0);
+  return jsd_capture_write_block(file, JSD_PCAPNG_IDB, block, offset);
+}
+
+static bool jsd_capture_write_frame(FILE*                      file,
+                                    const jsd_capture_frame_t* frame,
+                                    const char*                comment) {
+  uint8_t  block[JSD_PCAPNG_MAX_BLOCK_BYTES];
+  uint32_t bytes = frame->bytes < JSD_CAPTURE_FRAME_BYTES
+                       ? frame->bytes
+                       : JSD_CAPTURE_FRAME_BYTES;
+  uint32_t header[5] = {0, (uint32_t)((uint64_t)frame->stamp_nsec >> 32),
+                        (uint32_t)frame->stamp_nsec, bytes,
+                        frame->wire_bytes};
+  uint32_t flags =
+      frame->outbound ? JSD_PCAPNG_EPB_OUTBOUND : JSD_PCAPNG_EPB_INBOUND;
+  size_t offset;
+
+  offset = jsd_capture_put(block, 8, header, sizeof(header));
+  offset = jsd_capture_put(block, offset, frame->data, bytes);
+  if (comment) {
+    offset = jsd_capture_put_option(block, offset, JSD_PCAPNG_OPT_COMMENT,
+                                    comment, strlen(comment));
+  }
+  offset = jsd_capture_put_option(block, offset, JSD_PCAPNG_EPB_FLAGS, &flags,
+                                  sizeof(flags));
+  offset = jsd_capture_put_option(block, offset, JSD_PCAPNG_OPT_END, NULL, 0);
+  return jsd_capture_write_block(file, JSD_PCAPNG_EPB, block, offset);
+}
+
+void jsd_capture_process_frame(jsd_t* self, const jsd_capture_frame_t* frame) {
+  assert(self);
+  assert(frame);
+  jsd_capture_t*           cap = &self->capture;
+  jsd_capture_frame_info_t info;
+
+  bool ecat = jsd_capture_parse(self, frame->data, frame->bytes, &info);
+  if (ecat && frame->outbound && info.cyclic) {
+    jsd_capture_update_cycle(cap, info.first_idx);
+  }
+
+  if (!ecat || !jsd_capture_select(self, &info)) {
+    pthread_mutex_lock(&cap->stats_mutex);
+    ++cap->stats.frames_filtered;
+    pthread_mutex_unlock(&cap->stats_mutex);
+    return;
+  }
+
+  char comment[64];
+  snprintf(comment, sizeof(comment), "cycle %lu%s",
+           (unsigned long)cap->current_cycle,
+           frame->hardware_stamp ? ", NIC timestamp" : "");
+  bool written = jsd_capture_write_frame(
+      cap->file, frame,
+      cap->cycle_known ? comment
+                       : (frame->hardware_stamp ? "NIC timestamp" : NULL));
+
+  pthread_mutex_lock(&cap->stats_mutex);
+  if (written) {
+    ++cap->stats.frames_written;
+    cap->stats.hardware_stamped += frame->hardware_stamp;
+  } else {
+    ++cap->stats.frames_dropped;
+  }
+  pthread_mutex_unlock(&cap->stats_mutex);
+}
+
+/****************************************************
+ * Writer thread
+ ****************************************************/
+
+static void jsd_capture_process_block(jsd_t* self,
+                                      struct tpacket_block_desc* block) {
+  uint8_t* packet = (uint8_t*)block + block->hdr.bh1.offset_to_first_pkt;
+  uint32_t i;
+
+  for (i = 0; i < block->hdr.bh1.num_pkts; ++i) {
+    struct tpacket3_hdr*      hdr = (struct tpacket3_hdr*)packet;
+    const struct sockaddr_ll* sll =
+        (const struct sockaddr_ll*)(packet +
+                                    TPACKET_ALIGN(sizeof(struct tpacket3_hdr)));
+
+    jsd_capture_frame_t frame;
+    frame.data       = packet + hdr->tp_mac;
+    frame.bytes      = hdr->tp_snaplen;
+    frame.wire_bytes = hdr->tp_len;
+    frame.stamp_nsec =
+        (int64_t)hdr->tp_sec * JSD_TIME_NSEC_PER_SEC + hdr->tp_nsec;
+    frame.hardware_stamp = hdr->tp_status & TP_STATUS_TS_RAW_HARDWARE;
+    frame.outbound       = sll->sll_pkttype == PACKET_OUTGOING;
+    jsd_capture_process_frame(self, &frame);
+
+    packet += hdr->tp_next_offset;
+  }
+}
+
+static void* jsd_capture_thread_loop(void* void_data) {
+  jsd_t*         self     = (jsd_t*)void_data;
+  jsd_capture_t* cap      = &self->capture;
+  uint32_t       block_id = 0;
+  bool           draining = false;
+
+  while (true) {
+    struct tpacket_block_desc* block =
+        (struct tpacket_block_desc*)(cap->ring +
+                                     (size_t)block_id * cap->block_bytes);
+
+    if (!(__atomic_load_n(&block->hdr.bh1.block_status, __ATOMIC_ACQUIRE) &
+          TP_STATUS_USER)) {
+      if (draining) {
+        break;
+      }
+      // Once stopped, wait for the kernel to retire the last partial block
+      draining = __atomic_load_n(&cap->join_flag, __ATOMIC_ACQUIRE);
+      struct pollfd pfd = {cap->fd, POLLIN | POLLERR, 0};
+      poll(&pfd, 1,
+           draining ? 2 * JSD_CAPTURE_BLOCK_TIMEOUT_MS
+                    : JSD_CAPTURE_POLL_TIMEOUT_MS);
+      continue;
+    }
+
+    jsd_capture_process_block(self, block);
+    __atomic_store_n(&block->hdr.bh1.block_status, TP_STATUS_KERNEL,
+                     __ATOMIC_RELEASE);
+    block_id = (block_id + 1) % cap->num_blocks;
+  }
+
+  fflush(cap->file);
+  return NULL;
+}
+
+/****************************************************
+ * Public functions
+ ****************************************************/
+
+static bool jsd_capture_enable_hardware_timestamps(int fd,
+                                                   const char* ifname) {
+  struct hwtstamp_config hwconfig;
+  struct ifreq           ifr;
+  memset(&hwconfig, 0, sizeof(hwconfig));
+  memset(&ifr, 0, sizeof(ifr));
+  hwconfig.tx_type   = HWTSTAMP_TX_OFF;
+  hwconfig.rx_filter = HWTSTAMP_FILTER_ALL;
+  strncpy(ifr.ifr_name, ifname, IFNAMSIZ - 1);
+  ifr.ifr_data = (void*)&hwconfig;
+  if (ioctl(fd, SIOCSHWTSTAMP, &ifr) < 0) {
+    return false;
+  }
+
+  int request = SOF_TIMESTAMPING_RAW_HARDWARE;
+  return setsockopt(fd, SOL_PACKET, PACKET_TIMESTAMP, &request,
+                    sizeof(request)) == 0;
+}
+
+static void jsd_capture_close(jsd_capture_t* cap) {
+  if (cap->file) {
+    fclose(cap->file);
+    cap->file = NULL;
+  }
+  if (cap->ring) {
+    munmap(cap->ring, cap->ring_bytes);
+    cap->ring = NULL;
+  }
+  if (cap->fd >= 0) {
+    close(cap->fd);
+    cap->fd = -1;
+  }
+}
+
+bool jsd_capture_start(jsd_t* self, const char* ifname, const char* path,
+                       jsd_capture_config_t config) {
+  assert(self);
+  assert(ifname);
+  assert(path);
+  jsd_capture_t* cap = &self->capture;
+
+  if (cap->running) {
+    WARNING("Capture is already running");
+    return false;
+  }
+  if (self->vbus) {
+    ERROR("The virtual bus has no network interface to capture");
+    return false;
+  }
+  unsigned int ifindex = if_nametoindex(ifname);
+  if (ifindex == 0) {
+    ERROR("Unknown network interface %s", ifname);
+    return false;
+  }
+
+  cap->filter       = config.filter;
+  cap->slave_filter = config.slave_ids != NULL && config.num_slave_ids > 0;
+  memset(cap->slave_selected, 0, sizeof(cap->slave_selected));
+  uint16_t i;
+  for (i = 0; cap->slave_filter && i < config.num_slave_ids; ++i) {
+    if (config.slave_ids[i] == 0 || config.slave_ids[i] >= EC_MAXSLAVE) {
+      ERROR("Invalid slave %u in the capture subset", config.slave_ids[i]);
+      return false;
+    }
+    cap->slave_selected[config.slave_ids[i]] = true;
+  }
+
+  uint32_t ring_bytes =
+      config.ring_bytes ? config.ring_bytes : JSD_CAPTURE_DEFAULT_RING_BYTES;
+  cap->block_bytes = JSD_CAPTURE_BLOCK_BYTES;
+  cap->num_blocks  = ring_bytes / JSD_CAPTURE_BLOCK_BYTES;
+  if (cap->num_blocks < 2) {
+    cap->num_blocks = 2;
+  }
+  cap->ring_bytes = (size_t)cap->num_blocks * cap->block_bytes;
+  cap->ring       = NULL;
+  cap->file       = NULL;
+
+  cap->fd = socket(AF_PACKET, SOCK_RAW, htons(ETH_P_ECAT));
+  if (cap->fd < 0) {
+    ERROR("Could not open a packet socket, is CAP_NET_RAW missing?");
+    return false;
+  }
+
+  int version = TPACKET_V3;
+  if (setsockopt(cap->fd, SOL_PACKET, PACKET_VERSION, &version,
+                 sizeof(version)) != 0) {
+    ERROR("TPACKET_V3 capture ring is not supported");
+    jsd_capture_close(cap);
+    return false;
+  }
+  if (config.hardware_timestamps &&
+      !jsd_capture_enable_hardware_timestamps(cap->fd, ifname)) {
+    WARNING("%s has no hardware timestamps, using kernel timestamps", ifname);
+  }
+
+  struct tpacket_req3 req;
+  memset(&req, 0, sizeof(req));
+  req.tp_block_size     = cap->block_bytes;
+  req.tp_block_nr       = cap->num_blocks;
+  req.tp_frame_size     = JSD_CAPTURE_FRAME_BYTES;
+  req.tp_frame_nr       = cap->ring_bytes / JSD_CAPTURE_FRAME_BYTES;
+  req.tp_retire_blk_tov = JSD_CAPTURE_BLOCK_TIMEOUT_MS;
+  if (setsockopt(cap->fd, SOL_PACKET, PACKET_RX_RING, &req, sizeof(req)) !=
+      0) {
+    ERROR("Could not set up a %zu byte capture ring", cap->ring_bytes);
+    jsd_capture_close(cap);
+    return false;
+  }
+  cap->ring = mmap(NULL, cap->ring_bytes, PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_POPULATE, cap->fd, 0);
+  if (cap->ring == MAP_FAILED) {
+    cap->ring = NULL;
+    ERROR("Could not map the capture ring");
+    jsd_capture_close(cap);
+    return false;
+  }
+
+  struct sockaddr_ll addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sll_family   = AF_PACKET;
+  addr.sll_protocol = htons(ETH_P_ECAT);
+  addr.sll_ifindex  = ifindex;
+  if (bind(cap->fd, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+    ERROR("Could not bind the capture socket to %s", ifname);
+    jsd_capture_close(cap);
+    return false;
+  }
+
+  // stdio allocates the FILE and its buffer, this may follow jsd_init(...)
+  bool forbidden = jsd_memory_allow_malloc();
+  cap->file      = fopen(path, "wb");
+  bool written   = cap->file && jsd_capture_write_header(cap->file, ifname);
+  jsd_memory_forbid_malloc(forbidden);
+  if (!written) {
+    ERROR("Could not write capture file %s", path);
+    jsd_capture_close(cap);
+    return false;
+  }
+
+  cap->cycle           = 0;
+  cap->marks_head      = 0;
+  cap->marks_tail      = 0;
+  cap->unmarked_cycles = 0;
+  cap->cycle_known     = false;
+  cap->current_cycle   = 0;
+  cap->join_flag       = false;
+  memset(&cap->stats, 0, sizeof(cap->stats));
+
+  __atomic_store_n(&cap->running, true, __ATOMIC_SEQ_CST);
+  if (0 != jsd_memory_thread_create(&cap->thread, self->arena.base != NULL,
+                                    jsd_capture_thread_loop, (void*)self)) {
+    ERROR("Failed to create capture writer thread");
+    cap->running = false;
+    jsd_capture_close(cap);
+    return false;
+  }
+
+  MSG("Capturing %s to %s", ifname, path);
+  return true;
+}
+
+void jsd_capture_stop(jsd_t* self) {
+  assert(self);
+  jsd_capture_t* cap = &self->capture;
+
+  if (!cap->running) {
+    return;
+  }
+
+  __atomic_store_n(&cap->join_flag, true, __ATOMIC_RELEASE);
+  pthread_join(cap->thread, NULL);
+  cap->running = false;
+
+  struct tpacket_stats_v3 kernel_stats;
+  socklen_t               len = sizeof(kernel_stats);
+  pthread_mutex_lock(&cap->stats_mutex);
+  if (getsockopt(cap->fd, SOL_PACKET, PACKET_STATISTICS, &kernel_stats,
+                 &len) == 0) {
+    cap->stats.frames_dropped += kernel_stats.tp_drops;
+  }
+  jsd_capture_stats_t stats = cap->stats;
+  pthread_mutex_unlock(&cap->stats_mutex);
+
+  jsd_capture_close(cap);
+  MSG("Capture stopped, %lu frames written, %lu dropped",
+      (unsigned long)stats.frames_written, (unsigned long)stats.frames_dropped);
+}
+
+jsd_capture_stats_t jsd_capture_get_stats(jsd_t* self) {
+  assert(self);
+  jsd_capture_stats_t stats;
+
+  pthread_mutex_lock(&self->capture.stats_mutex);
+  stats = self->capture.stats;
+  pthread_mutex_unlock(&self->capture.stats_mutex);
+
+  stats.unmarked_cycles =
+      __atomic_load_n(&self->capture.unmarked_cycles, __ATOMIC_RELAXED);
+  return stats;
+}
@@ -0,0 +1,60 @@
+#ifndef JSD_CAPTURE_H
+#define JSD_CAPTURE_H
+
+#include "jsd/jsd_capture_pub.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief A frame received from the capture ring
+ */
+typedef struct {
+  const uint8_t* data;       ///< Ethernet frame
+  uint32_t       bytes;      ///< captured bytes
+  uint32_t       wire_bytes;  ///< bytes on the wire
+  int64_t        stamp_nsec;
+  bool           hardware_stamp;
+  bool           outbound;  ///< sent by this host
+} jsd_capture_frame_t;
+
+/**
+ * @brief Publishes the frames sent by the cycle, called by jsd_write(...)
+ *
+ * @param self pointer to JSD context with an active capture
+ */
+void jsd_capture_mark_cycle(jsd_t* self);
+
+/**
+ * @brief Applies the filter and slave subset of the capture to a frame
+ *
+ * @param self pointer to JSD context
+ * @param data Ethernet frame
+ * @param bytes length of the frame
+ * @return true if the frame is kept
+ */
+bool jsd_capture_select_frame(jsd_t* self, const uint8_t* data, size_t bytes);
+
+/**
+ * @brief Numbers a captured frame with its cycle and writes it if selected
+ *
+ * @param self pointer to JSD context with an open capture file
+ * @param frame captured frame
+ */
+void jsd_capture_process_frame(jsd_t* self, const jsd_capture_frame_t* frame);
+
+/**
+ * @brief Writes the pcapng section header and Ethernet interface description
+ *
+ * @param file pcapng file
+ * @param ifname interface name recorded in the file
+ * @return true on success
+ */
+bool jsd_capture_write_header(FILE* file, const char* ifname);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
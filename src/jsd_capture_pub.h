@@ -0,0 +1,56 @@
+#ifndef JSD_CAPTURE_PUB_H
+#define JSD_CAPTURE_PUB_H
+
+#include "jsd/jsd_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Starts capturing the EtherCAT frames of an interface to a pcapng file
+ *
+ * A packet socket on the interface receives both the frames sent by SOEM and
+ * the frames returned by the slaves, cyclic and mailbox alike, through a ring
+ * shared with the kernel. A background thread writes them to the file, so the
+ * cyclic loop only publishes the datagram indices it sends. Every frame is
+ * annotated with the number of the cycle it belongs to, counted from this
+ * call, and the frames sent by the cycle carry the outbound direction flag.
+ *
+ * config.filter keeps process data or mailbox frames only, config.slave_ids
+ * drops the frames that exclusively address other slaves. With
+ * config.hardware_timestamps, received frames are stamped by the NIC if it
+ * supports it (the stamp is in the NIC clock); sent frames are always stamped
+ * by the kernel. Needs CAP_NET_RAW and a network interface, the virtual bus
+ * cannot be captured. Stopped by jsd_capture_stop(...) or jsd_free(...).
+ *
+ * @param self pointer to JSD context
+ * @param ifname network interface of the bus
+ * @param path pcapng file, created or truncated
+ * @param config capture configuration
+ * @return true if the capture started
+ */
+bool jsd_capture_start(jsd_t* self, const char* ifname, const char* path,
+                       jsd_capture_config_t config);
+
+/**
+ * @brief Stops capturing, writes the pending frames and closes the file
+ *
+ * @param self pointer to JSD context
+ */
+void jsd_capture_stop(jsd_t* self);
+
+/**
+ * @brief Gets the capture statistics
+ *
+ * @param self pointer to JSD context
+ * @return statistics since jsd_capture_start(...), frames_dropped is updated
+ *         by jsd_capture_stop(...)
+ */
+jsd_capture_stats_t jsd_capture_get_stats(jsd_t* self);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
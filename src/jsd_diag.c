@@ -0,0 +1,659 @@
+#include "jsd/jsd_diag.h"
+
+#include <assert.h>
+#include <math.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "jsd/jsd_memory.h"
+#include "jsd/jsd_metrics.h"
+#include "jsd/jsd_print.h"
+#include "jsd/jsd_time.h"
+
+// A working counter that stays bad is attributed again at this period
+#define JSD_DIAG_WKC_RESCAN_NSEC (JSD_TIME_NSEC_PER_SEC / 10)
+
+#define JSD_DIAG_SM_TYPE_OUTPUTS (3)
+#define JSD_DIAG_SM_TYPE_INPUTS (4)
+#define JSD_DIAG_FMMU_TYPE_INPUTS (1)
+#define JSD_DIAG_FMMU_TYPE_OUTPUTS (2)
+
+// Counters are cleared before they saturate at 255
+#define JSD_DIAG_ESC_CLEAR_THRESHOLD (0xC0)
+
+// Offsets in the register image of the ESC error counters from 0x0300
+#define JSD_DIAG_ESC_INVALID_FRAMES(port) (2 * (port))
+#define JSD_DIAG_ESC_RX_ERRORS(port) (2 * (port) + 1)
+#define JSD_DIAG_ESC_FORWARDED_RX_ERRORS(port) (0x08 + (port))
+#define JSD_DIAG_ESC_PROCESSING_UNIT_ERRORS (0x0C)
+#define JSD_DIAG_ESC_LOST_LINKS(port) (0x10 + (port))
+
+// Sign bit of the System Time Difference, set if the local copy is smaller
+#define JSD_DIAG_DC_DIFF_NEGATIVE (0x80000000)
+
+// LRW counts a write with 2 and a read with 1
+#define JSD_DIAG_OUTPUTS_WKC (2)
+#define JSD_DIAG_INPUTS_WKC (1)
+
+static const char* jsd_wkc_cause_names[JSD_NUM_WKC_CAUSES] = {
+    "none", "no response", "AL state", "SyncManager", "FMMU"};
+
+/****************************************************
+ * Working counter attribution
+ ****************************************************/
+
+void jsd_diag_check_wkc(jsd_t* self) {
+  assert(self);
+  if (self->wkc == self->expected_wkc) {
+    return;
+  }
+  // The cycle is published last, a scan may see the values of a later cycle
+  jsd_diag_t* diag = &self->diag;
+  __atomic_store_n(&diag->bad_wkc, self->wkc, __ATOMIC_RELAXED);
+  __atomic_store_n(&diag->bad_wkc_mono_nsec, self->cycle_time.mono_nsec,
+                   __ATOMIC_RELAXED);
+  __atomic_store_n(&diag->bad_wkc_cycle,
+                   __atomic_load_n(&self->metrics.bus.cycles, __ATOMIC_RELAXED),
+                   __ATOMIC_RELEASE);
+}
+
+uint8_t jsd_diag_expected_wkc(const ec_slavet* slave) {
+  assert(slave);
+  uint8_t wkc = 0;
+  if (slave->Obytes > 0 || slave->Obits > 0) {
+    wkc += JSD_DIAG_OUTPUTS_WKC;
+  }
+  if (slave->Ibytes > 0 || slave->Ibits > 0) {
+    wkc += JSD_DIAG_INPUTS_WKC;
+  }
+  return wkc;
+}
+
+jsd_wkc_cause_t jsd_diag_wkc_cause(const ec_slavet*          slave,
+                                   const jsd_diag_pd_regs_t* regs,
+                                   uint8_t*                  missing_wkc) {
+  assert(slave);
+  assert(regs);
+  assert(missing_wkc);
+  uint8_t expected = jsd_diag_expected_wkc(slave);
+  bool    outputs  = expected & JSD_DIAG_OUTPUTS_WKC;
+  bool    inputs   = expected & JSD_DIAG_INPUTS_WKC;
+  int     i;
+
+  *missing_wkc = expected;
+  if (!regs->al_answered) {
+    return JSD_WKC_CAUSE_NO_RESPONSE;
+  }
+
+  // Inputs are exchanged from SAFE-OP, outputs only in OP
+  uint16_t state = regs->al_status & 0x0F;
+  if (state != EC_STATE_OPERATIONAL) {
+    uint8_t al_missing = expected;
+    if (state == EC_STATE_SAFE_OP && inputs) {
+      al_missing -= JSD_DIAG_INPUTS_WKC;
+    }
+    if (al_missing > 0) {
+      *missing_wkc = al_missing;
+      return JSD_WKC_CAUSE_AL_STATE;
+    }
+  }
+
+  if (!regs->sm_answered || !regs->fmmu_answered) {
+    return JSD_WKC_CAUSE_NO_RESPONSE;
+  }
+
+  // Enabled by the master (activate bit 0), not disabled by the PDI (bit 0)
+  bool lost_outputs = false;
+  bool lost_inputs  = false;
+  for (i = 0; i < EC_MAXSM; ++i) {
+    const uint8_t* reg = &regs->sm[8 * i];
+    if (slave->SM[i].SMlength == 0 || ((reg[6] & 0x01) && !(reg[7] & 0x01))) {
+      continue;
+    }
+    if (slave->SMtype[i] == JSD_DIAG_SM_TYPE_OUTPUTS) {
+      lost_outputs = outputs;
+    } else if (slave->SMtype[i] == JSD_DIAG_SM_TYPE_INPUTS) {
+      lost_inputs = inputs;
+    }
+  }
+  if (lost_outputs || lost_inputs) {
+    *missing_wkc = (lost_outputs ? JSD_DIAG_OUTPUTS_WKC : 0) +
+                   (lost_inputs ? JSD_DIAG_INPUTS_WKC : 0);
+    return JSD_WKC_CAUSE_SM;
+  }
+
+  for (i = 0; i < EC_MAXFMMU; ++i) {
+    const ec_fmmut* fmmu = &slave->FMMU[i];
+    if (fmmu->LogLength == 0 || (regs->fmmu[16 * i + 12] & 0x01)) {
+      continue;
+    }
+    if (fmmu->FMMUtype == JSD_DIAG_FMMU_TYPE_OUTPUTS) {
+      lost_outputs = outputs;
+    } else if (fmmu->FMMUtype == JSD_DIAG_FMMU_TYPE_INPUTS) {
+      lost_inputs = inputs;
+    }
+  }
+  if (lost_outputs || lost_inputs) {
+    *missing_wkc = (lost_outputs ? JSD_DIAG_OUTPUTS_WKC : 0) +
+                   (lost_inputs ? JSD_DIAG_INPUTS_WKC : 0);
+    return JSD_WKC_CAUSE_FMMU;
+  }
+
+  *missing_wkc = 0;
+  return JSD_WKC_CAUSE_NONE;
+}
+
+static void jsd_diag_read_pd_regs(jsd_t* self, const ec_slavet* slave,
+                                  jsd_diag_pd_regs_t* regs) {
+  ecx_portt* port = self->ecx_context.port;
+  uint8_t    al[6];
+
+  // The SyncManagers and FMMUs only matter while the AL state explains nothing
+  memset(regs, 0, sizeof(*regs));
+  regs->al_answered = ecx_FPRD(port, slave->configadr, ECT_REG_ALSTAT,
+                               sizeof(al), al, EC_TIMEOUTRET) == 1;
+  if (!regs->al_answered) {
+    return;
+  }
+  regs->al_status      = al[0] | (al[1] << 8);
+  regs->al_status_code = al[4] | (al[5] << 8);
+  if ((regs->al_status & 0x0F) != EC_STATE_OPERATIONAL) {
+    return;
+  }
+  regs->sm_answered = ecx_FPRD(port, slave->configadr, ECT_REG_SM0,
+                               sizeof(regs->sm), regs->sm, EC_TIMEOUTRET) == 1;
+  regs->fmmu_answered =
+      ecx_FPRD(port, slave->configadr, ECT_REG_FMMU0, sizeof(regs->fmmu),
+               regs->fmmu, EC_TIMEOUTRET) == 1;
+}
+
+static void jsd_diag_attribute_wkc(jsd_t* self, uint64_t cycle, int32_t wkc,
+                                   int64_t mono_nsec) {
+  jsd_diag_t*        diag       = &self->diag;
+  jsd_wkc_report_t*  report     = &diag->wkc_report;
+  uint16_t           num_slaves = *self->ecx_context.slavecount;
+  uint16_t           slave_id;
+  jsd_wkc_slave_t    slaves[EC_MAXSLAVE];
+  jsd_diag_pd_regs_t regs;
+
+  if (num_slaves >= EC_MAXSLAVE) {
+    num_slaves = EC_MAXSLAVE - 1;
+  }
+  memset(slaves, 0, sizeof(slaves));
+  int32_t  attributed_wkc = 0;
+  uint16_t num_suspects   = 0;
+  for (slave_id = 1; slave_id <= num_slaves; ++slave_id) {
+    const ec_slavet* slave = &self->ecx_context.slavelist[slave_id];
+    jsd_wkc_slave_t* ws    = &slaves[slave_id];
+    ws->expected_wkc       = jsd_diag_expected_wkc(slave);
+    if (ws->expected_wkc == 0) {
+      continue;
+    }
+    jsd_diag_read_pd_regs(self, slave, &regs);
+    ws->cause          = jsd_diag_wkc_cause(slave, &regs, &ws->missing_wkc);
+    ws->al_status      = regs.al_status;
+    ws->al_status_code = regs.al_status_code;
+    if (ws->cause == JSD_WKC_CAUSE_NONE) {
+      continue;
+    }
+    attributed_wkc += ws->missing_wkc;
+    ++num_suspects;
+    jsd_metrics_increment(&self->metrics.slaves[slave_id].wkc_misses);
+  }
+  jsd_metrics_increment(&self->metrics.bus.wkc_scans);
+  int64_t latency_nsec = jsd_time_get_mono_time_nsec() - mono_nsec;
+
+  pthread_mutex_lock(&diag->report_mutex);
+  report->cycle          = cycle;
+  report->wkc            = wkc;
+  report->expected_wkc   = self->expected_wkc;
+  report->attributed_wkc = attributed_wkc;
+  report->latency_nsec   = latency_nsec;
+  report->num_slaves     = num_slaves;
+  report->num_suspects   = num_suspects;
+  memcpy(report->slaves, slaves, sizeof(slaves));
+  diag->has_wkc_report = true;
+  pthread_mutex_unlock(&diag->report_mutex);
+
+  WARNING("Bad wkc %d (expected %d) at cycle %lu, %d attributed in %.3f ms",
+          wkc, self->expected_wkc, (unsigned long)cycle, attributed_wkc,
+          latency_nsec / 1e6);
+  for (slave_id = 1; slave_id <= num_slaves; ++slave_id) {
+    const jsd_wkc_slave_t* ws = &slaves[slave_id];
+    if (ws->cause != JSD_WKC_CAUSE_NONE) {
+      WARNING("  slave[%u] missing %u of %u: %s, AL status 0x%02x (0x%04x)",
+              slave_id, ws->missing_wkc, ws->expected_wkc,
+              jsd_wkc_cause_to_string(ws->cause), ws->al_status,
+              ws->al_status_code);
+    }
+  }
+}
+
+static void jsd_diag_poll_wkc(jsd_t* self) {
+  jsd_diag_t* diag  = &self->diag;
+  uint64_t    cycle = __atomic_load_n(&diag->bad_wkc_cycle, __ATOMIC_ACQUIRE);
+  if (cycle == diag->scanned_cycle) {
+    return;
+  }
+  int32_t wkc = __atomic_load_n(&diag->bad_wkc, __ATOMIC_RELAXED);
+  int64_t mono_nsec =
+      __atomic_load_n(&diag->bad_wkc_mono_nsec, __ATOMIC_RELAXED);
+
+  // A persistent loss is not rescanned every cycle
+  if (diag->scanned_cycle != 0 && wkc == diag->scanned_wkc &&
+      mono_nsec - diag->scanned_mono_nsec < JSD_DIAG_WKC_RESCAN_NSEC) {
+    return;
+  }
+  diag->scanned_cycle     = cycle;
+  diag->scanned_wkc       = wkc;
+  diag->scanned_mono_nsec = mono_nsec;
+  jsd_diag_attribute_wkc(self, cycle, wkc, mono_nsec);
+}
+
+/****************************************************
+ * ESC error counters
+ ****************************************************/
+
+// A counter below its last value was cleared by another tool
+static uint64_t jsd_diag_counter_delta(uint8_t last, uint8_t current) {
+  return current >= last ? current - last : current;
+}
+
+void jsd_diag_accumulate_esc_errors(jsd_esc_errors_t* errors,
+                                    const uint8_t* last, const uint8_t* regs,
+                                    double period_sec) {
+  assert(errors);
+  assert(last);
+  assert(regs);
+  int port;
+  for (port = 0; port < JSD_ESC_NUM_PORTS; ++port) {
+    uint64_t invalid =
+        jsd_diag_counter_delta(last[JSD_DIAG_ESC_INVALID_FRAMES(port)],
+                               regs[JSD_DIAG_ESC_INVALID_FRAMES(port)]);
+    uint64_t rx = jsd_diag_counter_delta(last[JSD_DIAG_ESC_RX_ERRORS(port)],
+                                         regs[JSD_DIAG_ESC_RX_ERRORS(port)]);
+    uint64_t forwarded =
+        jsd_diag_counter_delta(last[JSD_DIAG_ESC_FORWARDED_RX_ERRORS(port)],
+                               regs[JSD_DIAG_ESC_FORWARDED_RX_ERRORS(port)]);
+    uint64_t lost = jsd_diag_counter_delta(last[JSD_DIAG_ESC_LOST_LINKS(port)],
+                                           regs[JSD_DIAG_ESC_LOST_LINKS(port)]);
+    errors->invalid_frames[port] += invalid;
+    errors->rx_errors[port] += rx;
+    errors->forwarded_rx_errors[port] += forwarded;
+    errors->lost_links[port] += lost;
+
+    // Invalid frames include the ones marked by a slave before
+    uint64_t local = (invalid > forwarded ? invalid - forwarded : 0) + rx;
+    errors->local_error_rate[port] = period_sec > 0 ? local / period_sec : 0;
+    errors->lost_link_rate[port]   = period_sec > 0 ? lost / period_sec : 0;
+  }
+  errors->processing_unit_errors +=
+      jsd_diag_counter_delta(last[JSD_DIAG_ESC_PROCESSING_UNIT_ERRORS],
+                             regs[JSD_DIAG_ESC_PROCESSING_UNIT_ERRORS]);
+}
+
+uint16_t jsd_diag_port_neighbor(jsd_t* self, uint16_t slave_id, uint8_t port) {
+  assert(self);
+  const ec_slavet* slaves = self->ecx_context.slavelist;
+  int              other;
+
+  // Parents and ports are known from the topology scan of SOEM
+  if (port == slaves[slave_id].entryport) {
+    return slaves[slave_id].parent;
+  }
+  for (other = slave_id + 1;
+       other <= *self->ecx_context.slavecount && other < EC_MAXSLAVE; ++other) {
+    if (slaves[other].parent == slave_id && slaves[other].parentport == port) {
+      return other;
+    }
+  }
+  return JSD_LINK_NO_NEIGHBOR;
+}
+
+static bool jsd_diag_mailbox_idle(jsd_t* self) {
+  if (__atomic_load_n(&self->sdo_busy, __ATOMIC_RELAXED)) {
+    return false;
+  }
+  pthread_mutex_lock(&self->jsd_sdo_req_cirq.mutex);
+  bool empty = self->jsd_sdo_req_cirq.r == self->jsd_sdo_req_cirq.w;
+  pthread_mutex_unlock(&self->jsd_sdo_req_cirq.mutex);
+  return empty;
+}
+
+static void jsd_diag_clear_esc_errors(jsd_t* self, uint16_t slave_id) {
+  ecx_portt*       port  = self->ecx_context.port;
+  const ec_slavet* slave = &self->ecx_context.slavelist[slave_id];
+  uint8_t          zeros[JSD_DIAG_ESC_PROCESSING_UNIT_ERRORS + 1];
+
+  // Writing one RX error or lost link counter clears all of its kind
+  memset(zeros, 0, sizeof(zeros));
+  if (ecx_FPWR(port, slave->configadr, ECT_REG_RXERR, sizeof(zeros), zeros,
+               EC_TIMEOUTRET) == 1 &&
+      ecx_FPWR(port, slave->configadr, ECT_REG_LLCNT, JSD_ESC_NUM_PORTS, zeros,
+               EC_TIMEOUTRET) == 1) {
+    memset(self->diag.esc_regs[slave_id], 0, JSD_ESC_ERROR_REGS_BYTES);
+  }
+}
+
+static void jsd_diag_scan_esc(jsd_t* self, uint16_t slave_id,
+                              int64_t mono_nsec) {
+  jsd_diag_t*      diag  = &self->diag;
+  const ec_slavet* slave = &self->ecx_context.slavelist[slave_id];
+  uint8_t          regs[JSD_ESC_ERROR_REGS_BYTES];
+  int              port, i;
+
+  bool answered = ecx_FPRD(self->ecx_context.port, slave->configadr,
+                           ECT_REG_RXERR, sizeof(regs), regs,
+                           EC_TIMEOUTRET) == 1;
+  pthread_mutex_lock(&diag->report_mutex);
+  jsd_esc_errors_t* errors = &diag->esc_errors[slave_id];
+  if (!answered) {
+    ++errors->failed_scans;
+    pthread_mutex_unlock(&diag->report_mutex);
+    return;
+  }
+  ++errors->scans;
+  bool first = diag->esc_scan_mono_nsec[slave_id] == 0;
+  if (!first) {
+    jsd_diag_accumulate_esc_errors(
+        errors, diag->esc_regs[slave_id], regs,
+        (double)(mono_nsec - diag->esc_scan_mono_nsec[slave_id]) /
+            JSD_TIME_NSEC_PER_SEC);
+  }
+  pthread_mutex_unlock(&diag->report_mutex);
+  memcpy(diag->esc_regs[slave_id], regs, sizeof(regs));
+  diag->esc_scan_mono_nsec[slave_id] = mono_nsec;
+
+  for (port = 0; port < JSD_ESC_NUM_PORTS && !first; ++port) {
+    double rate = errors->local_error_rate[port] + errors->lost_link_rate[port];
+    if (rate <= 0) {
+      continue;
+    }
+    uint16_t neighbor = jsd_diag_port_neighbor(self, slave_id, port);
+    WARNING("Link errors at slave[%u] port %d (neighbor %d): %.1f/s", slave_id,
+            port, neighbor == JSD_LINK_NO_NEIGHBOR ? -1 : neighbor, rate);
+    if (rate > diag->esc_pass_worst.error_rate) {
+      diag->esc_pass_worst.slave_id    = slave_id;
+      diag->esc_pass_worst.port        = port;
+      diag->esc_pass_worst.neighbor_id = neighbor;
+      diag->esc_pass_worst.error_rate  = rate;
+    }
+  }
+
+  for (i = 0; i < JSD_ESC_ERROR_REGS_BYTES; ++i) {
+    if (regs[i] >= JSD_DIAG_ESC_CLEAR_THRESHOLD) {
+      jsd_diag_clear_esc_errors(self, slave_id);
+      break;
+    }
+  }
+}
+
+// Scans one slave per poll while the mailbox is idle, passes start every
+// config.esc_scan_period_ms
+static void jsd_diag_poll_esc(jsd_t* self) {
+  jsd_diag_t* diag       = &self->diag;
+  int64_t     mono_nsec  = jsd_time_get_mono_time_nsec();
+  uint16_t    num_slaves = *self->ecx_context.slavecount;
+  if (num_slaves >= EC_MAXSLAVE) {
+    num_slaves = EC_MAXSLAVE - 1;
+  }
+
+  if (diag->esc_next_slave == 0) {
+    if (diag->esc_pass_mono_nsec != 0 &&
+        mono_nsec - diag->esc_pass_mono_nsec <
+            (int64_t)diag->config.esc_scan_period_ms * 1000000) {
+      return;
+    }
+    diag->esc_pass_mono_nsec = mono_nsec;
+    diag->esc_next_slave     = 1;
+    memset(&diag->esc_pass_worst, 0, sizeof(diag->esc_pass_worst));
+  }
+
+  if (diag->esc_next_slave <= num_slaves) {
+    if (!jsd_diag_mailbox_idle(self)) {
+      return;
+    }
+    jsd_diag_scan_esc(self, diag->esc_next_slave++, mono_nsec);
+  }
+  if (diag->esc_next_slave > num_slaves) {
+    pthread_mutex_lock(&diag->report_mutex);
+    diag->has_degraded_link = diag->esc_pass_worst.error_rate > 0;
+    diag->degraded_link     = diag->esc_pass_worst;
+    pthread_mutex_unlock(&diag->report_mutex);
+    diag->esc_next_slave = 0;
+  }
+}
+
+/****************************************************
+ * Distributed clocks
+ ****************************************************/
+
+int32_t jsd_diag_dc_sync_error(uint32_t sys_time_diff) {
+  int32_t magnitude = (int32_t)(sys_time_diff & ~JSD_DIAG_DC_DIFF_NEGATIVE);
+  return (sys_time_diff & JSD_DIAG_DC_DIFF_NEGATIVE) ? -magnitude : magnitude;
+}
+
+bool jsd_diag_update_dc_quality(jsd_dc_quality_t* quality, double* m2,
+                                int32_t  sync_error_nsec,
+                                uint32_t propagation_delay_nsec,
+                                uint32_t threshold_nsec) {
+  assert(quality);
+  assert(m2);
+  uint32_t magnitude =
+      sync_error_nsec < 0 ? -(int64_t)sync_error_nsec : sync_error_nsec;
+
+  // Welford's running variance
+  ++quality->samples;
+  double delta = sync_error_nsec - quality->mean_sync_error_nsec;
+  quality->mean_sync_error_nsec += delta / quality->samples;
+  *m2 += delta * (sync_error_nsec - quality->mean_sync_error_nsec);
+  quality->stddev_sync_error_nsec =
+      quality->samples > 1 ? sqrt(*m2 / (quality->samples - 1)) : 0;
+
+  quality->sync_error_nsec        = sync_error_nsec;
+  quality->propagation_delay_nsec = propagation_delay_nsec;
+  if (magnitude > quality->max_sync_error_nsec) {
+    quality->max_sync_error_nsec = magnitude;
+  }
+  quality->out_of_sync = magnitude > threshold_nsec;
+  if (quality->out_of_sync) {
+    ++quality->violations;
+  }
+  return quality->out_of_sync;
+}
+
+static void jsd_diag_sample_dc(jsd_t* self, uint16_t slave_id) {
+  jsd_diag_t*      diag  = &self->diag;
+  const ec_slavet* slave = &self->ecx_context.slavelist[slave_id];
+  uint32_t         regs[2];  // System Time Delay and Difference
+
+  bool answered = ecx_FPRD(self->ecx_context.port, slave->configadr,
+                           ECT_REG_DCSYSDELAY, sizeof(regs), regs,
+                           EC_TIMEOUTRET) == 1;
+  pthread_mutex_lock(&diag->report_mutex);
+  jsd_dc_quality_t* quality = &diag->dc_quality[slave_id];
+  if (!answered) {
+    ++quality->failed_samples;
+    pthread_mutex_unlock(&diag->report_mutex);
+    return;
+  }
+  bool was_out_of_sync = quality->out_of_sync;
+  bool out_of_sync     = jsd_diag_update_dc_quality(
+      quality, &diag->dc_m2[slave_id],
+      jsd_diag_dc_sync_error(etohl(regs[1])), etohl(regs[0]),
+      diag->config.dc_sync_threshold_nsec);
+  int32_t sync_error_nsec = quality->sync_error_nsec;
+  pthread_mutex_unlock(&diag->report_mutex);
+
+  if (out_of_sync) {
+    jsd_metrics_increment(&self->metrics.slaves[slave_id].dc_sync_violations);
+  }
+  if (out_of_sync && !was_out_of_sync) {
+    WARNING("Slave[%u] DC sync error %d ns exceeds %u ns", slave_id,
+            sync_error_nsec, diag->config.dc_sync_threshold_nsec);
+  } else if (!out_of_sync && was_out_of_sync) {
+    MSG("Slave[%u] DC sync error back to %d ns", slave_id, sync_error_nsec);
+  }
+}
+
+// Samples all DC slaves together every config.dc_sample_period_ms
+static void jsd_diag_poll_dc(jsd_t* self) {
+  jsd_diag_t* diag      = &self->diag;
+  int64_t     mono_nsec = jsd_time_get_mono_time_nsec();
+  uint16_t    slave_id;
+
+  if (diag->dc_sample_mono_nsec != 0 &&
+      mono_nsec - diag->dc_sample_mono_nsec <
+          (int64_t)diag->config.dc_sample_period_ms * 1000000) {
+    return;
+  }
+  diag->dc_sample_mono_nsec = mono_nsec;
+  for (slave_id = 1;
+       slave_id <= *self->ecx_context.slavecount && slave_id < EC_MAXSLAVE;
+       ++slave_id) {
+    if (self->ecx_context.slavelist[slave_id].hasdc) {
+      jsd_diag_sample_dc(self, slave_id);
+    }
+  }
+  jsd_metrics_increment(&self->metrics.bus.dc_samples);
+}
+
+/****************************************************
+ * Thread
+ ****************************************************/
+
+static void* jsd_diag_thread_loop(void* void_data) {
+  jsd_t*      self = (jsd_t*)void_data;
+  jsd_diag_t* diag = &self->diag;
+
+  if (self->arena.base) {
+    jsd_memory_prefault_stack(JSD_MEMORY_THREAD_STACK_PREFAULT_BYTES);
+  }
+  while (!__atomic_load_n(&diag->join_flag, __ATOMIC_ACQUIRE)) {
+    // Not while the hot-plug thread configures a slave
+    pthread_mutex_lock(&self->hotplug.config_mutex);
+    jsd_diag_poll_wkc(self);
+    jsd_diag_poll_esc(self);
+    jsd_diag_poll_dc(self);
+    pthread_mutex_unlock(&self->hotplug.config_mutex);
+    usleep(diag->config.poll_usec);
+  }
+  return NULL;
+}
+
+/****************************************************
+ * Public functions
+ ****************************************************/
+
+bool jsd_diag_start(jsd_t* self, jsd_diag_config_t config) {
+  assert(self);
+  jsd_diag_t* diag = &self->diag;
+
+  if (diag->running) {
+    WARNING("Diagnostic thread is already running");
+    return false;
+  }
+  if (config.poll_usec == 0) {
+    config.poll_usec = JSD_DIAG_DEFAULT_POLL_USEC;
+  }
+  if (config.esc_scan_period_ms == 0) {
+    config.esc_scan_period_ms = JSD_DIAG_DEFAULT_ESC_SCAN_PERIOD_MS;
+  }
+  if (config.dc_sample_period_ms == 0) {
+    config.dc_sample_period_ms = JSD_DIAG_DEFAULT_DC_SAMPLE_PERIOD_MS;
+  }
+  if (config.dc_sync_threshold_nsec == 0) {
+    config.dc_sync_threshold_nsec = JSD_DIAG_DEFAULT_DC_SYNC_THRESHOLD_NSEC;
+  }
+  diag->config            = config;
+  diag->join_flag         = false;
+  diag->bad_wkc_cycle     = 0;
+  diag->scanned_cycle     = 0;
+  diag->scanned_wkc       = 0;
+  diag->scanned_mono_nsec = 0;
+  diag->has_wkc_report    = false;
+
+  diag->esc_pass_mono_nsec = 0;
+  diag->esc_next_slave     = 0;
+  diag->has_degraded_link  = false;
+  memset(diag->esc_regs, 0, sizeof(diag->esc_regs));
+  memset(diag->esc_scan_mono_nsec, 0, sizeof(diag->esc_scan_mono_nsec));
+  memset(diag->esc_errors, 0, sizeof(diag->esc_errors));
+
+  diag->dc_sample_mono_nsec = 0;
+  memset(diag->dc_m2, 0, sizeof(diag->dc_m2));
+  memset(diag->dc_quality, 0, sizeof(diag->dc_quality));
+
+  if (0 != jsd_memory_thread_create(&diag->thread, self->arena.base != NULL,
+                                    jsd_diag_thread_loop, (void*)self)) {
+    ERROR("Failed to create diagnostic thread");
+    return false;
+  }
+  diag->running = true;
+  MSG("Diagnostic thread polling every %u us, ESC error counters every %u ms, "
+      "DC sync every %u ms",
+      config.poll_usec, config.esc_scan_period_ms, config.dc_sample_period_ms);
+  return true;
+}
+
+void jsd_diag_stop(jsd_t* self) {
+  assert(self);
+  jsd_diag_t* diag = &self->diag;
+  if (!diag->running) {
+    return;
+  }
+  diag->running = false;
+  __atomic_store_n(&diag->join_flag, true, __ATOMIC_RELEASE);
+  pthread_join(diag->thread, NULL);
+}
+
+bool jsd_diag_get_wkc_report(jsd_t* self, jsd_wkc_report_t* report) {
+  assert(self);
+  assert(report);
+  jsd_diag_t* diag = &self->diag;
+
+  pthread_mutex_lock(&diag->report_mutex);
+  bool has_report = diag->has_wkc_report;
+  if (has_report) {
+    *report = diag->wkc_report;
+  }
+  pthread_mutex_unlock(&diag->report_mutex);
+  return has_report;
+}
+
+jsd_esc_errors_t jsd_diag_get_esc_errors(jsd_t* self, uint16_t slave_id) {
+  assert(self);
+  assert(slave_id < EC_MAXSLAVE);
+  pthread_mutex_lock(&self->diag.report_mutex);
+  jsd_esc_errors_t errors = self->diag.esc_errors[slave_id];
+  pthread_mutex_unlock(&self->diag.report_mutex);
+  return errors;
+}
+
+bool jsd_diag_get_degraded_link(jsd_t* self, jsd_link_segment_t* segment) {
+  assert(self);
+  assert(segment);
+  pthread_mutex_lock(&self->diag.report_mutex);
+  bool degraded = self->diag.has_degraded_link;
+  if (degraded) {
+    *segment = self->diag.degraded_link;
+  }
+  pthread_mutex_unlock(&self->diag.report_mutex);
+  return degraded;
+}
+
+jsd_dc_quality_t jsd_diag_get_dc_quality(jsd_t* self, uint16_t slave_id) {
+  assert(self);
+  assert(slave_id < EC_MAXSLAVE);
+  pthread_mutex_lock(&self->diag.report_mutex);
+  jsd_dc_quality_t quality = self->diag.dc_quality[slave_id];
+  pthread_mutex_unlock(&self->diag.report_mutex);
+  return quality;
+}
+
+const char* jsd_wkc_cause_to_string(jsd_wkc_cause_t cause) {
+  if (cause >= JSD_NUM_WKC_CAUSES) {
+    return "unknown";
+  }
+  return jsd_wkc_cause_names[cause];
+}
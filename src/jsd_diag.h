@@ -0,0 +1,99 @@
+#ifndef JSD_DIAG_H
+#define JSD_DIAG_H
+
+#include "jsd/jsd_diag_pub.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// Process data registers of a slave read by the diagnostic thread
+typedef struct {
+  bool     al_answered;
+  uint16_t al_status;
+  uint16_t al_status_code;
+  bool     sm_answered;
+  uint8_t  sm[8 * EC_MAXSM];  ///< 8 bytes per SyncManager from 0x0800
+  bool     fmmu_answered;
+  uint8_t  fmmu[16 * EC_MAXFMMU];  ///< 16 bytes per FMMU from 0x0600
+} jsd_diag_pd_regs_t;
+
+/**
+ * @brief Notes a bad working counter for the diagnostic thread, called by
+ * jsd_read(...)
+ *
+ * @param self pointer to JSD context with a running diagnostic thread
+ */
+void jsd_diag_check_wkc(jsd_t* self);
+
+/**
+ * @brief Working counter contribution of a slave exchanging all its process
+ * data
+ *
+ * @param slave SOEM slave
+ * @return 2 with outputs plus 1 with inputs
+ */
+uint8_t jsd_diag_expected_wkc(const ec_slavet* slave);
+
+/**
+ * @brief Attributes a loss of working counter from the registers of a slave
+ *
+ * @param slave SOEM slave, its SyncManager and FMMU configuration
+ * @param regs registers read from the slave
+ * @param missing_wkc set to the estimated contribution lost
+ * @return cause of the loss, JSD_WKC_CAUSE_NONE for a healthy slave
+ */
+jsd_wkc_cause_t jsd_diag_wkc_cause(const ec_slavet*          slave,
+                                   const jsd_diag_pd_regs_t* regs,
+                                   uint8_t*                  missing_wkc);
+
+/**
+ * @brief Adds the change of the ESC error counters of a slave to its totals
+ *
+ * @param errors totals and rates of the slave
+ * @param last register image of the previous scan
+ * @param regs register image of this scan
+ * @param period_sec time between the scans
+ */
+void jsd_diag_accumulate_esc_errors(jsd_esc_errors_t* errors,
+                                    const uint8_t* last, const uint8_t* regs,
+                                    double period_sec);
+
+/**
+ * @brief Finds the slave connected to a port
+ *
+ * @param self pointer to JSD context
+ * @param slave_id index of the slave
+ * @param port port of the slave, 0 to 3
+ * @return neighbor slave_id, 0 for the master or JSD_LINK_NO_NEIGHBOR
+ */
+uint16_t jsd_diag_port_neighbor(jsd_t* self, uint16_t slave_id, uint8_t port);
+
+/**
+ * @brief Converts the System Time Difference register to a sync error
+ *
+ * @param sys_time_diff register 0x092C in host byte order
+ * @return local copy of the system time minus the reference clock in ns
+ */
+int32_t jsd_diag_dc_sync_error(uint32_t sys_time_diff);
+
+/**
+ * @brief Adds a DC sample to the sync statistics of a slave
+ *
+ * @param quality statistics of the slave
+ * @param m2 running sum of squared deviations of the slave
+ * @param sync_error_nsec sync error of the sample
+ * @param propagation_delay_nsec System Time Delay register 0x0928
+ * @param threshold_nsec sync error magnitude above which the slave is flagged
+ * @return true if the sample exceeds the threshold
+ */
+bool jsd_diag_update_dc_quality(jsd_dc_quality_t* quality, double* m2,
+                                int32_t  sync_error_nsec,
+                                uint32_t propagation_delay_nsec,
+                                uint32_t threshold_nsec);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,98 @@
+#ifndef JSD_DIAG_PUB_H
+#define JSD_DIAG_PUB_H
+
+#include "jsd/jsd_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Starts the bus diagnostic thread
+ *
+ * When jsd_read(...) sees a bad working counter, the diagnostic thread reads
+ * the AL status, SyncManager and FMMU registers of every slave exchanging
+ * process data with separate datagrams, outside the cyclic frame, and
+ * attributes the missing working counter to the slaves that cannot
+ * contribute. The attribution is logged, counted in the slave metrics and
+ * returned by jsd_diag_get_wkc_report(...). A working counter that stays bad
+ * is rescanned when it changes or every 100 ms.
+ *
+ * While the SDO mailbox is idle, the thread also reads the ESC error counters
+ * of one slave per poll, every slave once per config.esc_scan_period_ms. The
+ * counters are accumulated per port, cleared before they saturate, and the
+ * link with the highest local error rate is reported by
+ * jsd_diag_get_degraded_link(...).
+ *
+ * Every config.dc_sample_period_ms, the thread samples the System Time
+ * Difference and Delay registers of every DC slave. Slaves whose sync error
+ * exceeds config.dc_sync_threshold_nsec are flagged and counted in the slave
+ * metrics, the statistics are returned by jsd_diag_get_dc_quality(...).
+ *
+ * Call after jsd_init(...), jsd_free(...) stops the thread.
+ *
+ * @param self pointer to JSD context
+ * @param config diagnostic settings, zeroed for the defaults
+ * @return true on success
+ */
+bool jsd_diag_start(jsd_t* self, jsd_diag_config_t config);
+
+/**
+ * @brief Stops the bus diagnostic thread
+ *
+ * @param self pointer to JSD context
+ */
+void jsd_diag_stop(jsd_t* self);
+
+/**
+ * @brief Gets the latest working counter attribution
+ *
+ * @param self pointer to JSD context
+ * @param report filled with the latest attribution
+ * @return false if no bad working counter was attributed yet
+ */
+bool jsd_diag_get_wkc_report(jsd_t* self, jsd_wkc_report_t* report);
+
+/**
+ * @brief Gets the ESC error counters of a slave
+ *
+ * @param self pointer to JSD context
+ * @param slave_id index of the slave
+ * @return totals since jsd_diag_start(...) and rates of the last scan
+ */
+jsd_esc_errors_t jsd_diag_get_esc_errors(jsd_t* self, uint16_t slave_id);
+
+/**
+ * @brief Gets the link with the most errors in the last scan of all slaves
+ *
+ * Errors marked by a slave before are not counted, so the link is the one
+ * between the reported port and its neighbor.
+ *
+ * @param self pointer to JSD context
+ * @param segment filled with the degraded link
+ * @return false if no link had errors in the last scan
+ */
+bool jsd_diag_get_degraded_link(jsd_t* self, jsd_link_segment_t* segment);
+
+/**
+ * @brief Gets the distributed clock sync statistics of a slave
+ *
+ * @param self pointer to JSD context
+ * @param slave_id index of the slave
+ * @return statistics since jsd_diag_start(...), zeroed for slaves without DC
+ */
+jsd_dc_quality_t jsd_diag_get_dc_quality(jsd_t* self, uint16_t slave_id);
+
+/**
+ * @brief Converts a working counter cause to a string
+ *
+ * @param cause working counter cause
+ * @return name of the cause
+ */
+const char* jsd_wkc_cause_to_string(jsd_wkc_cause_t cause);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
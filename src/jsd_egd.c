@@ -2,6 +2,7 @@
 
 #include <assert.h>
 #include <float.h>
+#include <stddef.h>
 #include <string.h>
 
 #include "ethercat.h"
@@ -90,9 +91,9 @@ void jsd_egd_fault(jsd_t* self, uint16_t slave_id) {
 void jsd_egd_reset(jsd_t* self, uint16_t slave_id) {
   assert(self);
   assert(self->ecx_context.slavelist[slave_id].eep_id == JSD_EGD_PRODUCT_CODE);
-  double now = jsd_time_get_mono_time_sec();
+  int64_t now = self->cycle_time.mono_nsec;
   if ((now - self->slave_states[slave_id].egd.last_reset_time) >
-      JSD_EGD_RESET_DERATE_SEC) {
+      (int64_t)(JSD_EGD_RESET_DERATE_SEC * JSD_TIME_NSEC_PER_SEC)) {
     self->slave_states[slave_id].egd.new_reset       = true;
     self->slave_states[slave_id].egd.last_reset_time = now;
 
@@ -1143,8 +1144,8 @@ void jsd_egd_update_state_from_PDO_data(jsd_t* self, uint16_t slave_id) {
         JSD_ELMO_STATE_MACHINE_STATE_FAULT) {
       jsd_sdo_signal_emcy_check(self);
       state->new_reset = false; // clear any potentially ongoing reset request
-      state->fault_real_time = jsd_time_get_time_sec();
-      state->fault_mono_time = jsd_time_get_mono_time_sec();
+      state->fault_real_time = self->cycle_time.real_nsec;
+      state->fault_mono_time = self->cycle_time.mono_nsec;
     }
   }
 
@@ -1280,7 +1281,7 @@ void jsd_egd_process_state_machine(jsd_t* self, uint16_t slave_id) {
       if(jsd_error_cirq_pop(error_cirq, &error)) {
 
         // if newer than the state-machine issued fault
-        if (ectime_to_sec(error.Time) > state->fault_real_time) {
+        if (ectime_to_nsec(error.Time) > state->fault_real_time) {
           // TODO consider handling the other error types too
           if(error.Etype == EC_ERR_TYPE_EMERGENCY){
             state->pub.emcy_error_code = error.ErrorCode;
@@ -1303,8 +1304,8 @@ void jsd_egd_process_state_machine(jsd_t* self, uint16_t slave_id) {
 
           }
         }
-      } else if (jsd_time_get_mono_time_sec() >
-                     (1.0 + state->fault_mono_time) &&
+      } else if (self->cycle_time.mono_nsec >
+                     state->fault_mono_time + JSD_TIME_NSEC_PER_SEC &&
                  state->pub.fault_code != JSD_EGD_FAULT_UNKNOWN) {
         // If we've been waiting for a long duration, the EMCY is not going to come
         //   go ahead an advance the state machine to prevent infinite wait. May
@@ -1714,3 +1715,23 @@ jsd_egd_fault_code_t jsd_egd_get_fault_code_from_ec_error(ec_errort error) {
   }
   return JSD_EGD_FAULT_UNKNOWN;
 }
+
+void jsd_egd_write_safe_outputs(jsd_t* self, uint16_t slave_id,
+                               uint8_t* outputs) {
+  assert(self);
+  assert(self->ecx_context.slavelist[slave_id].eep_id == JSD_EGD_PRODUCT_CODE);
+
+  size_t   offset      = 0;
+  uint16_t controlword = JSD_EGD_STATE_MACHINE_CONTROLWORD_QUICK_STOP;
+
+  if (self->slave_configs[slave_id].egd.drive_cmd_mode ==
+      JSD_EGD_DRIVE_CMD_MODE_CS) {
+    offset = offsetof(jsd_egd_rxpdo_data_cs_mode_t, controlword);
+  } else if (self->slave_configs[slave_id].egd.drive_cmd_mode ==
+             JSD_EGD_DRIVE_CMD_MODE_PROFILED) {
+    offset = offsetof(jsd_egd_rxpdo_data_profiled_mode_t, controlword);
+  } else {
+    return;
+  }
+  memcpy(outputs + offset, &controlword, sizeof(controlword));
+}
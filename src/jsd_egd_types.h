@@ -299,7 +299,7 @@ typedef struct {
   bool                        new_motion_command;
   jsd_egd_motion_command_t    motion_command;  ///< Last command from user
   jsd_egd_mode_of_operation_t requested_mode_of_operation;
-  double                      last_reset_time;
+  int64_t                     last_reset_time;  ///< monotonic, ns
 
   // Fields parsed data from txpdo data
   uint8_t interlock;  ///< from DINs !(STO status) (firmware >= V1.1.10.7 B00)!
@@ -316,8 +316,8 @@ typedef struct {
   bool                          last_async_sdo_in_prog;
 
   // Time of statusword fault state change
-  double fault_real_time;  // Used to compare against SOEM error's timestamp
-  double fault_mono_time;  // Used to compute elapsed time.
+  int64_t fault_real_time;  // ns, compared against SOEM error's timestamp
+  int64_t fault_mono_time;  // ns, used to compute elapsed time.
 
 } jsd_egd_private_state_t;
 
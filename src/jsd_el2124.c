@@ -23,17 +23,11 @@ const jsd_el2124_state_t* jsd_el2124_get_state(jsd_t* self, uint16_t slave_id) {
   return &self->slave_states[slave_id].el2124;
 }
 
-void jsd_el2124_process(jsd_t* self, uint16_t slave_id) {
-  assert(self);
-  assert(self->ecx_context.slavelist[slave_id].eep_id ==
-         JSD_EL2124_PRODUCT_CODE);
-
-  jsd_el2124_rxpdo_t* rxpdo =
-      (jsd_el2124_rxpdo_t*)self->ecx_context.slavelist[slave_id].outputs;
-
+static void jsd_el2124_pack_rxpdo(const jsd_el2124_state_t* state,
+                                  jsd_el2124_rxpdo_t*       rxpdo) {
   int ch;
   for (ch = 0; ch < JSD_EL2124_NUM_CHANNELS; ch++) {
-    uint8_t output = self->slave_states[slave_id].el2124.output[ch];
+    uint8_t output = state->output[ch];
 
     if (output > 0) {
       rxpdo->flags |= 0x01 << ch;
@@ -43,6 +37,16 @@ void jsd_el2124_process(jsd_t* self, uint16_t slave_id) {
   }
 }
 
+void jsd_el2124_process(jsd_t* self, uint16_t slave_id) {
+  assert(self);
+  assert(self->ecx_context.slavelist[slave_id].eep_id ==
+         JSD_EL2124_PRODUCT_CODE);
+
+  jsd_el2124_pack_rxpdo(
+      &self->slave_states[slave_id].el2124,
+      (jsd_el2124_rxpdo_t*)self->ecx_context.slavelist[slave_id].outputs);
+}
+
 void jsd_el2124_write_single_channel(jsd_t* self, uint16_t slave_id,
                                      uint8_t channel, uint8_t output) {
   assert(self);
@@ -60,6 +64,17 @@ void jsd_el2124_write_all_channels(jsd_t* self, uint16_t slave_id,
   }
 }
 
+bool jsd_el2124_get_handle(jsd_t* self, uint16_t slave_id,
+                           jsd_el2124_handle_t* handle) {
+  assert(handle);
+  return jsd_get_device(self, slave_id, JSD_EL2124_PRODUCT_CODE, &handle->dev);
+}
+
+void jsd_el2124_handle_process(const jsd_el2124_handle_t* handle) {
+  jsd_el2124_pack_rxpdo(&handle->dev.state->el2124,
+                        (jsd_el2124_rxpdo_t*)handle->dev.outputs);
+}
+
 /****************************************************
  * Private functions
  ****************************************************/
@@ -8,6 +8,13 @@ extern "C" {
 #include "jsd/jsd_el2124_types.h"
 #include "jsd/jsd_pub.h"
 
+/**
+ * @brief Pre-resolved EL2124 handle, see jsd_el2124_get_handle(...)
+ */
+typedef struct {
+  jsd_device_t dev;
+} jsd_el2124_handle_t;
+
 /**
  * @brief Read the EL2124 State
  *
@@ -49,6 +56,48 @@ void jsd_el2124_write_single_channel(jsd_t* self, uint16_t slave_id,
 void jsd_el2124_write_all_channels(jsd_t* self, uint16_t slave_id,
                                    uint8_t output[JSD_EL2124_NUM_CHANNELS]);
 
+/**
+ * @brief Resolves an EL2124 handle, call once after jsd_init(...)
+ *
+ * @param self pointer to JSD context
+ * @param slave_id id of EL2124 device
+ * @param handle output handle
+ * @return true if the slave is a configured EL2124
+ */
+bool jsd_el2124_get_handle(jsd_t* self, uint16_t slave_id,
+                           jsd_el2124_handle_t* handle);
+
+/**
+ * @brief Read the EL2124 State, without per-call validation
+ *
+ * @param handle resolved EL2124 handle
+ * @return Pointer to EL2124 device state
+ */
+static inline const jsd_el2124_state_t* jsd_el2124_handle_get_state(
+    const jsd_el2124_handle_t* handle) {
+  return &handle->dev.state->el2124;
+}
+
+/**
+ * @brief process loop required for proper device function, without per-call
+ * validation
+ *
+ * @param handle resolved EL2124 handle
+ */
+void jsd_el2124_handle_process(const jsd_el2124_handle_t* handle);
+
+/**
+ * @brief Sets a specified channel level, without per-call validation
+ *
+ * @param handle resolved EL2124 handle
+ * @param channel specified device channel to command
+ * @param output command level (0 or 1)
+ */
+static inline void jsd_el2124_handle_write_single_channel(
+    const jsd_el2124_handle_t* handle, uint8_t channel, uint8_t output) {
+  handle->dev.state->el2124.output[channel] = output;
+}
+
 #ifdef __cplusplus
 }
 #endif
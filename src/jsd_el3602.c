@@ -27,23 +27,15 @@ const jsd_el3602_state_t* jsd_el3602_get_state(jsd_t* self, uint16_t slave_id) {
   return state;
 }
 
-void jsd_el3602_read(jsd_t* self, uint16_t slave_id) {
-  assert(self);
-  assert(self->ecx_context.slavelist[slave_id].eep_id ==
-         JSD_EL3602_PRODUCT_CODE);
-
-  jsd_slave_config_t* config = &self->slave_configs[slave_id];
-  jsd_el3602_state_t* state  = &self->slave_states[slave_id].el3602;
-
-  jsd_el3602_txpdo_t* txpdo =
-      (jsd_el3602_txpdo_t*)self->ecx_context.slavelist[slave_id].inputs;
-
+static void jsd_el3602_parse_txpdo(const jsd_el3602_config_t* config,
+                                   jsd_el3602_state_t*        state,
+                                   const jsd_el3602_txpdo_t*  txpdo) {
   int ch;
   for (ch = 0; ch < JSD_EL3602_NUM_CHANNELS; ch++) {
     state->adc_value[ch] = txpdo->channel[ch].value;
 
     state->voltage[ch] = (double)state->adc_value[ch] *
-                         jsd_el3602_range_factor[config->el3602.range[ch]] /
+                         jsd_el3602_range_factor[config->range[ch]] /
                          JSD_EL3602_DAQ_RESOLUTION;
 
     state->underrange[ch]   = (txpdo->channel[ch].flags >> 0) & 0x01;
@@ -56,6 +48,29 @@ void jsd_el3602_read(jsd_t* self, uint16_t slave_id) {
   }
 }
 
+void jsd_el3602_read(jsd_t* self, uint16_t slave_id) {
+  assert(self);
+  assert(self->ecx_context.slavelist[slave_id].eep_id ==
+         JSD_EL3602_PRODUCT_CODE);
+
+  jsd_el3602_parse_txpdo(
+      &self->slave_configs[slave_id].el3602,
+      &self->slave_states[slave_id].el3602,
+      (jsd_el3602_txpdo_t*)self->ecx_context.slavelist[slave_id].inputs);
+}
+
+bool jsd_el3602_get_handle(jsd_t* self, uint16_t slave_id,
+                           jsd_el3602_handle_t* handle) {
+  assert(handle);
+  return jsd_get_device(self, slave_id, JSD_EL3602_PRODUCT_CODE, &handle->dev);
+}
+
+void jsd_el3602_handle_read(const jsd_el3602_handle_t* handle) {
+  jsd_el3602_parse_txpdo(&handle->dev.config->el3602,
+                         &handle->dev.state->el3602,
+                         (const jsd_el3602_txpdo_t*)handle->dev.inputs);
+}
+
 /****************************************************
  * Private functions
  ****************************************************/
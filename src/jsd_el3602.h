@@ -6,6 +6,7 @@ extern "C" {
 #endif
 
 #include "jsd/jsd.h"
+#include "jsd/jsd_el3602_pub.h"
 
 /**
  * @brief Single channel of TxPDO data struct
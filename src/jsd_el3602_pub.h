@@ -7,6 +7,13 @@ extern "C" {
 
 #include "jsd/jsd_pub.h"
 
+/**
+ * @brief Pre-resolved EL3602 handle, see jsd_el3602_get_handle(...)
+ */
+typedef struct {
+  jsd_device_t dev;
+} jsd_el3602_handle_t;
+
 /**
  * @brief Read the EL3602 device state
  *
@@ -24,6 +31,35 @@ const jsd_el3602_state_t* jsd_el3602_get_state(jsd_t* self, uint16_t slave_id);
  */
 void jsd_el3602_read(jsd_t* self, uint16_t slave_id);
 
+/**
+ * @brief Resolves an EL3602 handle, call once after jsd_init(...)
+ *
+ * @param self pointer to JSD context
+ * @param slave_id id of EL3602 device
+ * @param handle output handle
+ * @return true if the slave is a configured EL3602
+ */
+bool jsd_el3602_get_handle(jsd_t* self, uint16_t slave_id,
+                           jsd_el3602_handle_t* handle);
+
+/**
+ * @brief Read the EL3602 device state, without per-call validation
+ *
+ * @param handle resolved EL3602 handle
+ * @return Pointer to EL3602 device state
+ */
+static inline const jsd_el3602_state_t* jsd_el3602_handle_get_state(
+    const jsd_el3602_handle_t* handle) {
+  return &handle->dev.state->el3602;
+}
+
+/**
+ * @brief Converts raw PDO data to state data, without per-call validation
+ *
+ * @param handle resolved EL3602 handle
+ */
+void jsd_el3602_handle_read(const jsd_el3602_handle_t* handle);
+
 #ifdef __cplusplus
 }
 #endif
@@ -1,6 +1,7 @@
 #include "jsd/jsd_epd.h"
 
 #include <assert.h>
+#include <stddef.h>
 #include <string.h>
 
 #include "ethercat.h"
@@ -48,6 +49,21 @@ static int jsd_epd_compare_lc_keys(const void* lhs, const void* rhs) {
   return strcmp(l->lc_chars, r->lc_chars);
 }
 
+static void jsd_epd_write_digital_output(jsd_epd_private_state_t* state,
+                                         uint8_t index, uint8_t output) {
+  if (output > 0) {
+    state->rxpdo.digital_outputs |= (0x01 << (16 + index));
+  } else {
+    state->rxpdo.digital_outputs &= ~(0x01 << (16 + index));
+  }
+}
+
+static void jsd_epd_request_motion(jsd_epd_private_state_t*    state,
+                                   jsd_epd_mode_of_operation_t mode) {
+  state->new_motion_command          = true;
+  state->requested_mode_of_operation = mode;
+}
+
 /****************************************************
  * Public functions
  ****************************************************/
@@ -99,10 +115,10 @@ void jsd_epd_reset(jsd_t* self, uint16_t slave_id) {
   assert(self);
   assert(self->ecx_context.slavelist[slave_id].eep_id == JSD_EPD_PRODUCT_CODE);
 
-  double now = jsd_time_get_mono_time_sec();
+  int64_t now = self->cycle_time.mono_nsec;
 
   if ((now - self->slave_states[slave_id].epd.last_reset_time) >
-      JSD_EPD_RESET_DERATE_SEC) {
+      (int64_t)(JSD_EPD_RESET_DERATE_SEC * JSD_TIME_NSEC_PER_SEC)) {
     self->slave_states[slave_id].epd.new_reset       = true;
     self->slave_states[slave_id].epd.last_reset_time = now;
 
@@ -157,12 +173,8 @@ void jsd_epd_set_digital_output(jsd_t* self, uint16_t slave_id, uint8_t index,
   assert(self->ecx_context.slavelist[slave_id].eep_id == JSD_EPD_PRODUCT_CODE);
   assert(index < JSD_EPD_NUM_DIGITAL_OUTPUTS);
 
-  jsd_epd_private_state_t* state = &self->slave_states[slave_id].epd;
-  if (output > 0) {
-    state->rxpdo.digital_outputs |= (0x01 << (16 + index));
-  } else {
-    state->rxpdo.digital_outputs &= ~(0x01 << (16 + index));
-  }
+  jsd_epd_write_digital_output(&self->slave_states[slave_id].epd, index,
+                               output);
 }
 
 void jsd_epd_set_peak_current(jsd_t* self, uint16_t slave_id,
@@ -181,10 +193,9 @@ void jsd_epd_set_motion_command_csp(
   assert(self);
   assert(self->ecx_context.slavelist[slave_id].eep_id == JSD_EPD_PRODUCT_CODE);
 
-  jsd_epd_private_state_t* state     = &self->slave_states[slave_id].epd;
-  state->new_motion_command          = true;
-  state->requested_mode_of_operation = JSD_EPD_MODE_OF_OPERATION_CSP;
-  state->motion_command.csp          = motion_command;
+  jsd_epd_private_state_t* state = &self->slave_states[slave_id].epd;
+  jsd_epd_request_motion(state, JSD_EPD_MODE_OF_OPERATION_CSP);
+  state->motion_command.csp = motion_command;
 }
 
 void jsd_epd_set_motion_command_csv(
@@ -193,10 +204,9 @@ void jsd_epd_set_motion_command_csv(
   assert(self);
   assert(self->ecx_context.slavelist[slave_id].eep_id == JSD_EPD_PRODUCT_CODE);
 
-  jsd_epd_private_state_t* state     = &self->slave_states[slave_id].epd;
-  state->new_motion_command          = true;
-  state->requested_mode_of_operation = JSD_EPD_MODE_OF_OPERATION_CSV;
-  state->motion_command.csv          = motion_command;
+  jsd_epd_private_state_t* state = &self->slave_states[slave_id].epd;
+  jsd_epd_request_motion(state, JSD_EPD_MODE_OF_OPERATION_CSV);
+  state->motion_command.csv = motion_command;
 }
 
 void jsd_epd_set_motion_command_cst(
@@ -205,10 +215,9 @@ void jsd_epd_set_motion_command_cst(
   assert(self);
   assert(self->ecx_context.slavelist[slave_id].eep_id == JSD_EPD_PRODUCT_CODE);
 
-  jsd_epd_private_state_t* state     = &self->slave_states[slave_id].epd;
-  state->new_motion_command          = true;
-  state->requested_mode_of_operation = JSD_EPD_MODE_OF_OPERATION_CST;
-  state->motion_command.cst          = motion_command;
+  jsd_epd_private_state_t* state = &self->slave_states[slave_id].epd;
+  jsd_epd_request_motion(state, JSD_EPD_MODE_OF_OPERATION_CST);
+  state->motion_command.cst = motion_command;
 }
 
 void jsd_epd_set_motion_command_prof_pos(
@@ -217,10 +226,9 @@ void jsd_epd_set_motion_command_prof_pos(
   assert(self);
   assert(self->ecx_context.slavelist[slave_id].eep_id == JSD_EPD_PRODUCT_CODE);
 
-  jsd_epd_private_state_t* state     = &self->slave_states[slave_id].epd;
-  state->new_motion_command          = true;
-  state->requested_mode_of_operation = JSD_EPD_MODE_OF_OPERATION_PROF_POS;
-  state->motion_command.prof_pos     = motion_command;
+  jsd_epd_private_state_t* state = &self->slave_states[slave_id].epd;
+  jsd_epd_request_motion(state, JSD_EPD_MODE_OF_OPERATION_PROF_POS);
+  state->motion_command.prof_pos = motion_command;
 }
 
 void jsd_epd_set_motion_command_prof_vel(
@@ -229,10 +237,9 @@ void jsd_epd_set_motion_command_prof_vel(
   assert(self);
   assert(self->ecx_context.slavelist[slave_id].eep_id == JSD_EPD_PRODUCT_CODE);
 
-  jsd_epd_private_state_t* state     = &self->slave_states[slave_id].epd;
-  state->new_motion_command          = true;
-  state->requested_mode_of_operation = JSD_EPD_MODE_OF_OPERATION_PROF_VEL;
-  state->motion_command.prof_vel     = motion_command;
+  jsd_epd_private_state_t* state = &self->slave_states[slave_id].epd;
+  jsd_epd_request_motion(state, JSD_EPD_MODE_OF_OPERATION_PROF_VEL);
+  state->motion_command.prof_vel = motion_command;
 }
 
 void jsd_epd_set_motion_command_prof_torque(
@@ -241,10 +248,9 @@ void jsd_epd_set_motion_command_prof_torque(
   assert(self);
   assert(self->ecx_context.slavelist[slave_id].eep_id == JSD_EPD_PRODUCT_CODE);
 
-  jsd_epd_private_state_t* state     = &self->slave_states[slave_id].epd;
-  state->new_motion_command          = true;
-  state->requested_mode_of_operation = JSD_EPD_MODE_OF_OPERATION_PROF_TORQUE;
-  state->motion_command.prof_torque  = motion_command;
+  jsd_epd_private_state_t* state = &self->slave_states[slave_id].epd;
+  jsd_epd_request_motion(state, JSD_EPD_MODE_OF_OPERATION_PROF_TORQUE);
+  state->motion_command.prof_torque = motion_command;
 }
 
 void jsd_epd_async_sdo_set_drive_position(jsd_t* self, uint16_t slave_id,
@@ -350,6 +356,46 @@ const char* jsd_epd_fault_code_to_string(jsd_epd_fault_code_t fault_code) {
   }
 }
 
+bool jsd_epd_get_handle(jsd_t* self, uint16_t slave_id,
+                        jsd_epd_handle_t* handle) {
+  assert(handle);
+  return jsd_get_device(self, slave_id, JSD_EPD_PRODUCT_CODE, &handle->dev);
+}
+
+void jsd_epd_handle_halt(const jsd_epd_handle_t* handle) {
+  handle->dev.state->epd.new_halt_command = true;
+}
+
+void jsd_epd_handle_set_digital_output(const jsd_epd_handle_t* handle,
+                                       uint8_t index, uint8_t output) {
+  assert(index < JSD_EPD_NUM_DIGITAL_OUTPUTS);
+  jsd_epd_write_digital_output(&handle->dev.state->epd, index, output);
+}
+
+void jsd_epd_handle_set_motion_command_csp(
+    const jsd_epd_handle_t*       handle,
+    jsd_elmo_motion_command_csp_t motion_command) {
+  jsd_epd_private_state_t* state = &handle->dev.state->epd;
+  jsd_epd_request_motion(state, JSD_EPD_MODE_OF_OPERATION_CSP);
+  state->motion_command.csp = motion_command;
+}
+
+void jsd_epd_handle_set_motion_command_csv(
+    const jsd_epd_handle_t*       handle,
+    jsd_elmo_motion_command_csv_t motion_command) {
+  jsd_epd_private_state_t* state = &handle->dev.state->epd;
+  jsd_epd_request_motion(state, JSD_EPD_MODE_OF_OPERATION_CSV);
+  state->motion_command.csv = motion_command;
+}
+
+void jsd_epd_handle_set_motion_command_cst(
+    const jsd_epd_handle_t*       handle,
+    jsd_elmo_motion_command_cst_t motion_command) {
+  jsd_epd_private_state_t* state = &handle->dev.state->epd;
+  jsd_epd_request_motion(state, JSD_EPD_MODE_OF_OPERATION_CST);
+  state->motion_command.cst = motion_command;
+}
+
 /****************************************************
  * Private functions
  ****************************************************/
@@ -825,8 +871,8 @@ void jsd_epd_update_state_from_PDO_data(jsd_t* self, uint16_t slave_id) {
         JSD_ELMO_STATE_MACHINE_STATE_FAULT) {
       // TODO(dloret): Check if setting state->new_reset to false like in EGD
       // code is actually needed. Commands are handled after reading functions.
-      state->fault_real_time = jsd_time_get_time_sec();
-      state->fault_mono_time = jsd_time_get_mono_time_sec();
+      state->fault_real_time = self->cycle_time.real_nsec;
+      state->fault_mono_time = self->cycle_time.mono_nsec;
 
       jsd_sdo_signal_emcy_check(self);
     }
@@ -953,7 +999,7 @@ void jsd_epd_process_state_machine(jsd_t* self, uint16_t slave_id) {
       // queue here and in the error handling (e.g. pushing errors).
       while (num_error_pops < JSD_EPD_MAX_ERROR_POPS_PER_CYCLE &&
              jsd_error_cirq_pop(error_cirq, &error)) {
-        if (ectime_to_sec(error.Time) > state->fault_real_time) {
+        if (ectime_to_nsec(error.Time) > state->fault_real_time) {
           // Might want to handle other types of errors too in the future.
           if (error.Etype == EC_ERR_TYPE_EMERGENCY) {
             state->pub.emcy_error_code = error.ErrorCode;
@@ -977,7 +1023,8 @@ void jsd_epd_process_state_machine(jsd_t* self, uint16_t slave_id) {
       // If the error has not arrived within 1 second, transition out of FAULT
       // because it might never arrive (e.g. error at startup).
       if (!error_found &&
-          jsd_time_get_mono_time_sec() > (1.0 + state->fault_mono_time)) {
+          self->cycle_time.mono_nsec >
+              state->fault_mono_time + JSD_TIME_NSEC_PER_SEC) {
         // TODO(dloret): Remove printing to not affect real-time guarantees.
         WARNING("EPD[%d] in FAULT state but new EMCY code has not arrived",
                 slave_id);
@@ -1294,3 +1341,13 @@ jsd_epd_fault_code_t jsd_epd_get_fault_code_from_ec_error(ec_errort error) {
   }
   return fault_code;
 }
+
+void jsd_epd_write_safe_outputs(jsd_t* self, uint16_t slave_id,
+                               uint8_t* outputs) {
+  assert(self);
+  assert(self->ecx_context.slavelist[slave_id].eep_id == JSD_EPD_PRODUCT_CODE);
+
+  uint16_t controlword = JSD_EPD_STATE_MACHINE_CONTROLWORD_QUICK_STOP;
+  memcpy(outputs + offsetof(jsd_epd_rxpdo_data_t, controlword), &controlword,
+         sizeof(controlword));
+}
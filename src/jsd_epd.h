@@ -98,6 +98,19 @@ void jsd_epd_mode_of_op_handle_prof_torque(jsd_t* self, uint16_t slave_id);
 
 jsd_epd_fault_code_t jsd_epd_get_fault_code_from_ec_error(ec_errort error);
 
+/**
+ * @brief Writes a Quick Stop command into a raw RxPDO image of the drive
+ *
+ * Used by the cycle watchdog to halt the drive while the application is
+ * stalled. Other fields of the image are left untouched.
+ *
+ * @param self pointer JSD context
+ * @param slave_id index of device on EtherCAT bus
+ * @param outputs RxPDO image, usually the slave's IOmap outputs
+ */
+void jsd_epd_write_safe_outputs(jsd_t* self, uint16_t slave_id,
+                               uint8_t* outputs);
+
 #ifdef __cplusplus
 }
 #endif
@@ -7,6 +7,13 @@ extern "C" {
 
 #include "jsd/jsd_pub.h"
 
+/**
+ * @brief Pre-resolved EPD handle, see jsd_epd_get_handle(...)
+ */
+typedef struct {
+  jsd_device_t dev;
+} jsd_epd_handle_t;
+
 /**
  * @brief Reads the EPD device state
  *
@@ -193,6 +200,80 @@ void jsd_epd_set_motion_command_prof_torque(
     jsd_t* self, uint16_t slave_id,
     jsd_elmo_motion_command_prof_torque_t motion_command);
 
+/**
+ * @brief Resolves an EPD handle, call once after jsd_init(...)
+ *
+ * @param self Pointer to JSD context
+ * @param slave_id Slave ID of EPD device
+ * @param handle output handle
+ * @return true if the slave is a configured EPD
+ */
+bool jsd_epd_get_handle(jsd_t* self, uint16_t slave_id,
+                        jsd_epd_handle_t* handle);
+
+/**
+ * @brief Reads the EPD device state, without per-call validation
+ *
+ * Real-time safe
+ *
+ * @param handle resolved EPD handle
+ * @return Pointer to EPD device state
+ */
+static inline const jsd_epd_state_t* jsd_epd_handle_get_state(
+    const jsd_epd_handle_t* handle) {
+  return &handle->dev.state->epd.pub;
+}
+
+/**
+ * @brief Same as jsd_epd_halt(...), without per-call validation
+ *
+ * @param handle resolved EPD handle
+ */
+void jsd_epd_handle_halt(const jsd_epd_handle_t* handle);
+
+/**
+ * @brief Same as jsd_epd_set_digital_output(...), without per-call validation
+ *
+ * @param handle resolved EPD handle
+ * @param index Index of the digital output (0-5)
+ * @param output Level of the digital output (0 or 1)
+ */
+void jsd_epd_handle_set_digital_output(const jsd_epd_handle_t* handle,
+                                       uint8_t index, uint8_t output);
+
+/**
+ * @brief Same as jsd_epd_set_motion_command_csp(...), without per-call
+ * validation
+ *
+ * @param handle resolved EPD handle
+ * @param motion_command Set of parameters of the CSP command
+ */
+void jsd_epd_handle_set_motion_command_csp(
+    const jsd_epd_handle_t*       handle,
+    jsd_elmo_motion_command_csp_t motion_command);
+
+/**
+ * @brief Same as jsd_epd_set_motion_command_csv(...), without per-call
+ * validation
+ *
+ * @param handle resolved EPD handle
+ * @param motion_command Set of parameters of the CSV command
+ */
+void jsd_epd_handle_set_motion_command_csv(
+    const jsd_epd_handle_t*       handle,
+    jsd_elmo_motion_command_csv_t motion_command);
+
+/**
+ * @brief Same as jsd_epd_set_motion_command_cst(...), without per-call
+ * validation
+ *
+ * @param handle resolved EPD handle
+ * @param motion_command Set of parameters of the CST command
+ */
+void jsd_epd_handle_set_motion_command_cst(
+    const jsd_epd_handle_t*       handle,
+    jsd_elmo_motion_command_cst_t motion_command);
+
 // TODO(dloret): think about how to handle informational printing (e.g.
 // jsd_*_mode_of_operation_to_string, jsd_*_state_machine_to_string,
 // jsd_*_fault_code_to_string).
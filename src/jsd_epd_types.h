@@ -277,7 +277,7 @@ typedef struct {
   jsd_epd_motion_command_t    motion_command;  ///< Last command from user
   jsd_epd_mode_of_operation_t requested_mode_of_operation;
   jsd_epd_mode_of_operation_t last_requested_mode_of_operation;
-  double                      last_reset_time;
+  int64_t                     last_reset_time;  ///< monotonic, ns
 
   uint8_t interlock;  ///< 1 when one or both of STO inputs are disabled.
   uint8_t fault_occured_when_enabled;  ///< From Status Register
@@ -287,14 +287,14 @@ typedef struct {
   // TODO(dloret): Figure out debugging messages related to state changes
   // without affecting real-time guarantees.
 
-  double
+  int64_t
       fault_real_time;  /// Timestamp of the last transition into fault of the
-                        /// drive's state machine. This is system time and is
-                        /// needed to compare against the timestamp of the EMCY
-                        /// error code because SOEM uses system time for it.
-  double fault_mono_time;  /// Timestamp from monotonic clock of the last
-                           /// transition into fault. This is used to measure a
-                           /// timeout to receive the EMCY error code.
+                        /// drive's state machine, ns. This is system time and
+                        /// is needed to compare against the timestamp of the
+                        /// EMCY error code because SOEM uses system time for it.
+  int64_t fault_mono_time;  /// Timestamp from monotonic clock of the last
+                            /// transition into fault, ns. This is used to
+                            /// measure a timeout to receive the EMCY error code.
 
   uint8_t setpoint_ack;  ///< Setpoint ackowledge (Profiled Position mode),
                          ///< statustword, bit 12
@@ -0,0 +1,82 @@
+#include "jsd/jsd_fields.h"
+
+#include <assert.h>
+#include <string.h>
+
+static const size_t jsd_field_bytes[JSD_FIELD_NUM_TYPES] = {
+    [JSD_FIELD_U8] = 1,  [JSD_FIELD_U16] = 2, [JSD_FIELD_U32] = 4,
+    [JSD_FIELD_U64] = 8, [JSD_FIELD_I8] = 1,  [JSD_FIELD_I16] = 2,
+    [JSD_FIELD_I32] = 4, [JSD_FIELD_I64] = 8, [JSD_FIELD_F32] = 4,
+    [JSD_FIELD_F64] = 8, [JSD_FIELD_BOOL] = sizeof(bool),
+};
+
+static const jsd_struct_desc_t* jsd_fields_find(const jsd_struct_desc_t* descs,
+                                                size_t   num_descs,
+                                                uint32_t product_code) {
+  size_t i;
+  for (i = 0; i < num_descs; ++i) {
+    if (descs[i].product_code == product_code) {
+      return &descs[i];
+    }
+  }
+  return NULL;
+}
+
+const jsd_struct_desc_t* jsd_fields_get_state_desc(uint32_t product_code) {
+  return jsd_fields_find(jsd_fields_state_descs, jsd_fields_num_state_descs,
+                         product_code);
+}
+
+const jsd_struct_desc_t* jsd_fields_get_config_desc(uint32_t product_code) {
+  return jsd_fields_find(jsd_fields_config_descs, jsd_fields_num_config_descs,
+                         product_code);
+}
+
+size_t jsd_field_type_bytes(jsd_field_type_t type) {
+  assert(type < JSD_FIELD_NUM_TYPES);
+  return jsd_field_bytes[type];
+}
+
+double jsd_field_get_value(const jsd_field_t* field, const void* base,
+                           uint32_t index) {
+  assert(field);
+  assert(base);
+  assert(index < field->count);
+  const uint8_t* value = (const uint8_t*)base + field->offset +
+                         index * jsd_field_bytes[field->type];
+
+  // Fields of packed or reused buffers may be unaligned
+  switch (field->type) {
+#define JSD_FIELD_READ(c_type)   \
+  {                              \
+    c_type v;                    \
+    memcpy(&v, value, sizeof(v)); \
+    return (double)v;            \
+  }
+    case JSD_FIELD_U8:
+      JSD_FIELD_READ(uint8_t);
+    case JSD_FIELD_U16:
+      JSD_FIELD_READ(uint16_t);
+    case JSD_FIELD_U32:
+      JSD_FIELD_READ(uint32_t);
+    case JSD_FIELD_U64:
+      JSD_FIELD_READ(uint64_t);
+    case JSD_FIELD_I8:
+      JSD_FIELD_READ(int8_t);
+    case JSD_FIELD_I16:
+      JSD_FIELD_READ(int16_t);
+    case JSD_FIELD_I32:
+      JSD_FIELD_READ(int32_t);
+    case JSD_FIELD_I64:
+      JSD_FIELD_READ(int64_t);
+    case JSD_FIELD_F32:
+      JSD_FIELD_READ(float);
+    case JSD_FIELD_F64:
+      JSD_FIELD_READ(double);
+    case JSD_FIELD_BOOL:
+      JSD_FIELD_READ(bool);
+#undef JSD_FIELD_READ
+    default:
+      return 0.0;
+  }
+}
@@ -0,0 +1,20 @@
+#ifndef JSD_FIELDS_H
+#define JSD_FIELDS_H
+
+#include "jsd/jsd_fields_pub.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Generated in jsd_fields_gen.c by tools/jsd_fields_gen.py
+extern const jsd_struct_desc_t jsd_fields_state_descs[];
+extern const size_t            jsd_fields_num_state_descs;
+extern const jsd_struct_desc_t jsd_fields_config_descs[];
+extern const size_t            jsd_fields_num_config_descs;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,1053 @@
+// Generated by tools/jsd_fields_gen.py from the device type headers,
+// do not edit. The build fails when it is out of date, regenerate it
+// with: python3 tools/jsd_fields_gen.py src/jsd_fields_gen.c
+
+#include "jsd/jsd_fields.h"
+
+#include <stddef.h>
+
+#define JSD_FIELD_CHECK(type, member, c_type, count)          \
+  _Static_assert(                                             \
+      sizeof(((type*)0)->member) == sizeof(c_type) * (count), \
+      #type "." #member " changed, regenerate the registry")
+
+/****************************************************
+ * jsd_el3602_state_t
+ ****************************************************/
+
+JSD_FIELD_CHECK(jsd_el3602_state_t, voltage, double, JSD_EL3602_NUM_CHANNELS);
+JSD_FIELD_CHECK(jsd_el3602_state_t, adc_value, int32_t,
+                JSD_EL3602_NUM_CHANNELS);
+JSD_FIELD_CHECK(jsd_el3602_state_t, limit1, uint8_t, JSD_EL3602_NUM_CHANNELS);
+JSD_FIELD_CHECK(jsd_el3602_state_t, limit2, uint8_t, JSD_EL3602_NUM_CHANNELS);
+JSD_FIELD_CHECK(jsd_el3602_state_t, txPDO_state, uint8_t,
+                JSD_EL3602_NUM_CHANNELS);
+JSD_FIELD_CHECK(jsd_el3602_state_t, txPDO_toggle, uint8_t,
+                JSD_EL3602_NUM_CHANNELS);
+JSD_FIELD_CHECK(jsd_el3602_state_t, error, uint8_t, JSD_EL3602_NUM_CHANNELS);
+JSD_FIELD_CHECK(jsd_el3602_state_t, underrange, uint8_t,
+                JSD_EL3602_NUM_CHANNELS);
+JSD_FIELD_CHECK(jsd_el3602_state_t, overrange, uint8_t,
+                JSD_EL3602_NUM_CHANNELS);
+
+static const jsd_field_t jsd_fields_el3602_state[] = {
+    {"voltage", JSD_FIELD_F64, offsetof(jsd_el3602_state_t, voltage),
+     JSD_EL3602_NUM_CHANNELS, ""},
+    {"adc_value", JSD_FIELD_I32, offsetof(jsd_el3602_state_t, adc_value),
+     JSD_EL3602_NUM_CHANNELS, ""},
+    {"limit1", JSD_FIELD_U8, offsetof(jsd_el3602_state_t, limit1),
+     JSD_EL3602_NUM_CHANNELS, ""},
+    {"limit2", JSD_FIELD_U8, offsetof(jsd_el3602_state_t, limit2),
+     JSD_EL3602_NUM_CHANNELS, ""},
+    {"txPDO_state", JSD_FIELD_U8, offsetof(jsd_el3602_state_t, txPDO_state),
+     JSD_EL3602_NUM_CHANNELS, ""},
+    {"txPDO_toggle", JSD_FIELD_U8, offsetof(jsd_el3602_state_t, txPDO_toggle),
+     JSD_EL3602_NUM_CHANNELS, ""},
+    {"error", JSD_FIELD_U8, offsetof(jsd_el3602_state_t, error),
+     JSD_EL3602_NUM_CHANNELS, ""},
+    {"underrange", JSD_FIELD_U8, offsetof(jsd_el3602_state_t, underrange),
+     JSD_EL3602_NUM_CHANNELS, ""},
+    {"overrange", JSD_FIELD_U8, offsetof(jsd_el3602_state_t, overrange),
+     JSD_EL3602_NUM_CHANNELS, ""},
+};
+
+/****************************************************
+ * jsd_el3208_state_t
+ ****************************************************/
+
+JSD_FIELD_CHECK(jsd_el3208_state_t, output_eu, double, JSD_EL3208_NUM_CHANNELS);
+JSD_FIELD_CHECK(jsd_el3208_state_t, adc_value, int16_t,
+                JSD_EL3208_NUM_CHANNELS);
+JSD_FIELD_CHECK(jsd_el3208_state_t, txPDO_state, uint8_t,
+                JSD_EL3208_NUM_CHANNELS);
+JSD_FIELD_CHECK(jsd_el3208_state_t, txPDO_toggle, uint8_t,
+                JSD_EL3208_NUM_CHANNELS);
+JSD_FIELD_CHECK(jsd_el3208_state_t, error, uint8_t, JSD_EL3208_NUM_CHANNELS);
+JSD_FIELD_CHECK(jsd_el3208_state_t, underrange, uint8_t,
+                JSD_EL3208_NUM_CHANNELS);
+JSD_FIELD_CHECK(jsd_el3208_state_t, overrange, uint8_t,
+                JSD_EL3208_NUM_CHANNELS);
+
+static const jsd_field_t jsd_fields_el3208_state[] = {
+    {"output_eu", JSD_FIELD_F64, offsetof(jsd_el3208_state_t, output_eu),
+     JSD_EL3208_NUM_CHANNELS, "Ohm"},
+    {"adc_value", JSD_FIELD_I16, offsetof(jsd_el3208_state_t, adc_value),
+     JSD_EL3208_NUM_CHANNELS, ""},
+    {"txPDO_state", JSD_FIELD_U8, offsetof(jsd_el3208_state_t, txPDO_state),
+     JSD_EL3208_NUM_CHANNELS, ""},
+    {"txPDO_toggle", JSD_FIELD_U8, offsetof(jsd_el3208_state_t, txPDO_toggle),
+     JSD_EL3208_NUM_CHANNELS, ""},
+    {"error", JSD_FIELD_U8, offsetof(jsd_el3208_state_t, error),
+     JSD_EL3208_NUM_CHANNELS, ""},
+    {"underrange", JSD_FIELD_U8, offsetof(jsd_el3208_state_t, underrange),
+     JSD_EL3208_NUM_CHANNELS, ""},
+    {"overrange", JSD_FIELD_U8, offsetof(jsd_el3208_state_t, overrange),
+     JSD_EL3208_NUM_CHANNELS, ""},
+};
+
+/****************************************************
+ * jsd_el2124_state_t
+ ****************************************************/
+
+JSD_FIELD_CHECK(jsd_el2124_state_t, output, uint8_t, JSD_EL2124_NUM_CHANNELS);
+
+static const jsd_field_t jsd_fields_el2124_state[] = {
+    {"output", JSD_FIELD_U8, offsetof(jsd_el2124_state_t, output),
+     JSD_EL2124_NUM_CHANNELS, ""},
+};
+
+/****************************************************
+ * jsd_egd_state_t
+ ****************************************************/
+
+JSD_FIELD_CHECK(jsd_egd_state_t, actual_position, int32_t, 1);
+JSD_FIELD_CHECK(jsd_egd_state_t, actual_velocity, int32_t, 1);
+JSD_FIELD_CHECK(jsd_egd_state_t, actual_current, double, 1);
+JSD_FIELD_CHECK(jsd_egd_state_t, cmd_position, int32_t, 1);
+JSD_FIELD_CHECK(jsd_egd_state_t, cmd_velocity, int32_t, 1);
+JSD_FIELD_CHECK(jsd_egd_state_t, cmd_current, double, 1);
+JSD_FIELD_CHECK(jsd_egd_state_t, cmd_max_current, double, 1);
+JSD_FIELD_CHECK(jsd_egd_state_t, cmd_ff_position, int32_t, 1);
+JSD_FIELD_CHECK(jsd_egd_state_t, cmd_ff_velocity, int32_t, 1);
+JSD_FIELD_CHECK(jsd_egd_state_t, cmd_ff_current, double, 1);
+JSD_FIELD_CHECK(jsd_egd_state_t, actual_state_machine_state, int32_t, 1);
+JSD_FIELD_CHECK(jsd_egd_state_t, actual_mode_of_operation, int32_t, 1);
+JSD_FIELD_CHECK(jsd_egd_state_t, sto_engaged, uint8_t, 1);
+JSD_FIELD_CHECK(jsd_egd_state_t, hall_state, uint8_t, 1);
+JSD_FIELD_CHECK(jsd_egd_state_t, in_motion, uint8_t, 1);
+JSD_FIELD_CHECK(jsd_egd_state_t, servo_enabled, uint8_t, 1);
+JSD_FIELD_CHECK(jsd_egd_state_t, warning, uint8_t, 1);
+JSD_FIELD_CHECK(jsd_egd_state_t, target_reached, uint8_t, 1);
+JSD_FIELD_CHECK(jsd_egd_state_t, motor_on, uint8_t, 1);
+JSD_FIELD_CHECK(jsd_egd_state_t, fault_code, int32_t, 1);
+JSD_FIELD_CHECK(jsd_egd_state_t, emcy_error_code, uint16_t, 1);
+JSD_FIELD_CHECK(jsd_egd_state_t, bus_voltage, double, 1);
+JSD_FIELD_CHECK(jsd_egd_state_t, analog_input_voltage, double, 1);
+JSD_FIELD_CHECK(jsd_egd_state_t, digital_inputs, uint8_t,
+                JSD_EGD_NUM_DIGITAL_INPUTS);
+JSD_FIELD_CHECK(jsd_egd_state_t, digital_output_cmd, uint8_t,
+                JSD_EGD_NUM_DIGITAL_OUTPUTS);
+JSD_FIELD_CHECK(jsd_egd_state_t, drive_temperature, uint32_t, 1);
+
+static const jsd_field_t jsd_fields_egd_state[] = {
+    {"actual_position", JSD_FIELD_I32,
+     offsetof(jsd_egd_state_t, actual_position), 1, "cnt"},
+    {"actual_velocity", JSD_FIELD_I32,
+     offsetof(jsd_egd_state_t, actual_velocity), 1, "cnt/s"},
+    {"actual_current", JSD_FIELD_F64, offsetof(jsd_egd_state_t, actual_current),
+     1, "A"},
+    {"cmd_position", JSD_FIELD_I32, offsetof(jsd_egd_state_t, cmd_position), 1,
+     "cnt"},
+    {"cmd_velocity", JSD_FIELD_I32, offsetof(jsd_egd_state_t, cmd_velocity), 1,
+     "cnt/s"},
+    {"cmd_current", JSD_FIELD_F64, offsetof(jsd_egd_state_t, cmd_current), 1,
+     "A"},
+    {"cmd_max_current", JSD_FIELD_F64,
+     offsetof(jsd_egd_state_t, cmd_max_current), 1, ""},
+    {"cmd_ff_position", JSD_FIELD_I32,
+     offsetof(jsd_egd_state_t, cmd_ff_position), 1, "cnt"},
+    {"cmd_ff_velocity", JSD_FIELD_I32,
+     offsetof(jsd_egd_state_t, cmd_ff_velocity), 1, "cnt/s"},
+    {"cmd_ff_current", JSD_FIELD_F64, offsetof(jsd_egd_state_t, cmd_ff_current),
+     1, "A"},
+    {"actual_state_machine_state", JSD_FIELD_I32,
+     offsetof(jsd_egd_state_t, actual_state_machine_state), 1, ""},
+    {"actual_mode_of_operation", JSD_FIELD_I32,
+     offsetof(jsd_egd_state_t, actual_mode_of_operation), 1, ""},
+    {"sto_engaged", JSD_FIELD_U8, offsetof(jsd_egd_state_t, sto_engaged), 1,
+     ""},
+    {"hall_state", JSD_FIELD_U8, offsetof(jsd_egd_state_t, hall_state), 1, ""},
+    {"in_motion", JSD_FIELD_U8, offsetof(jsd_egd_state_t, in_motion), 1, ""},
+    {"servo_enabled", JSD_FIELD_U8, offsetof(jsd_egd_state_t, servo_enabled), 1,
+     ""},
+    {"warning", JSD_FIELD_U8, offsetof(jsd_egd_state_t, warning), 1, ""},
+    {"target_reached", JSD_FIELD_U8, offsetof(jsd_egd_state_t, target_reached),
+     1, ""},
+    {"motor_on", JSD_FIELD_U8, offsetof(jsd_egd_state_t, motor_on), 1, ""},
+    {"fault_code", JSD_FIELD_I32, offsetof(jsd_egd_state_t, fault_code), 1, ""},
+    {"emcy_error_code", JSD_FIELD_U16,
+     offsetof(jsd_egd_state_t, emcy_error_code), 1, ""},
+    {"bus_voltage", JSD_FIELD_F64, offsetof(jsd_egd_state_t, bus_voltage), 1,
+     "V"},
+    {"analog_input_voltage", JSD_FIELD_F64,
+     offsetof(jsd_egd_state_t, analog_input_voltage), 1, "V"},
+    {"digital_inputs", JSD_FIELD_U8, offsetof(jsd_egd_state_t, digital_inputs),
+     JSD_EGD_NUM_DIGITAL_INPUTS, ""},
+    {"digital_output_cmd", JSD_FIELD_U8,
+     offsetof(jsd_egd_state_t, digital_output_cmd), JSD_EGD_NUM_DIGITAL_OUTPUTS,
+     ""},
+    {"drive_temperature", JSD_FIELD_U32,
+     offsetof(jsd_egd_state_t, drive_temperature), 1, "degC"},
+};
+
+/****************************************************
+ * jsd_el3356_state_t
+ ****************************************************/
+
+JSD_FIELD_CHECK(jsd_el3356_state_t, overrange, uint8_t, 1);
+JSD_FIELD_CHECK(jsd_el3356_state_t, data_invalid, uint8_t, 1);
+JSD_FIELD_CHECK(jsd_el3356_state_t, error, uint8_t, 1);
+JSD_FIELD_CHECK(jsd_el3356_state_t, cal_in_prog, uint8_t, 1);
+JSD_FIELD_CHECK(jsd_el3356_state_t, steady_state, uint8_t, 1);
+JSD_FIELD_CHECK(jsd_el3356_state_t, sync_error, uint8_t, 1);
+JSD_FIELD_CHECK(jsd_el3356_state_t, txpdo_toggle, uint8_t, 1);
+JSD_FIELD_CHECK(jsd_el3356_state_t, value, int32_t, 1);
+JSD_FIELD_CHECK(jsd_el3356_state_t, scaled_value, double, 1);
+JSD_FIELD_CHECK(jsd_el3356_state_t, pending_tare, uint8_t, 1);
+
+static const jsd_field_t jsd_fields_el3356_state[] = {
+    {"overrange", JSD_FIELD_U8, offsetof(jsd_el3356_state_t, overrange), 1, ""},
+    {"data_invalid", JSD_FIELD_U8, offsetof(jsd_el3356_state_t, data_invalid),
+     1, ""},
+    {"error", JSD_FIELD_U8, offsetof(jsd_el3356_state_t, error), 1, ""},
+    {"cal_in_prog", JSD_FIELD_U8, offsetof(jsd_el3356_state_t, cal_in_prog), 1,
+     ""},
+    {"steady_state", JSD_FIELD_U8, offsetof(jsd_el3356_state_t, steady_state),
+     1, ""},
+    {"sync_error", JSD_FIELD_U8, offsetof(jsd_el3356_state_t, sync_error), 1,
+     ""},
+    {"txpdo_toggle", JSD_FIELD_U8, offsetof(jsd_el3356_state_t, txpdo_toggle),
+     1, ""},
+    {"value", JSD_FIELD_I32, offsetof(jsd_el3356_state_t, value), 1, ""},
+    {"scaled_value", JSD_FIELD_F64, offsetof(jsd_el3356_state_t, scaled_value),
+     1, ""},
+    {"pending_tare", JSD_FIELD_U8, offsetof(jsd_el3356_state_t, pending_tare),
+     1, ""},
+};
+
+/****************************************************
+ * jsd_jed0101_state_t
+ ****************************************************/
+
+JSD_FIELD_CHECK(jsd_jed0101_state_t, status, uint16_t, 1);
+JSD_FIELD_CHECK(jsd_jed0101_state_t, w_raw, uint32_t, 1);
+JSD_FIELD_CHECK(jsd_jed0101_state_t, x_raw, uint32_t, 1);
+JSD_FIELD_CHECK(jsd_jed0101_state_t, y_raw, uint32_t, 1);
+JSD_FIELD_CHECK(jsd_jed0101_state_t, z_raw, uint32_t, 1);
+JSD_FIELD_CHECK(jsd_jed0101_state_t, w, double, 1);
+JSD_FIELD_CHECK(jsd_jed0101_state_t, x, double, 1);
+JSD_FIELD_CHECK(jsd_jed0101_state_t, y, double, 1);
+JSD_FIELD_CHECK(jsd_jed0101_state_t, z, double, 1);
+JSD_FIELD_CHECK(jsd_jed0101_state_t, cmd, uint16_t, 1);
+
+static const jsd_field_t jsd_fields_jed0101_state[] = {
+    {"status", JSD_FIELD_U16, offsetof(jsd_jed0101_state_t, status), 1, ""},
+    {"w_raw", JSD_FIELD_U32, offsetof(jsd_jed0101_state_t, w_raw), 1, ""},
+    {"x_raw", JSD_FIELD_U32, offsetof(jsd_jed0101_state_t, x_raw), 1, ""},
+    {"y_raw", JSD_FIELD_U32, offsetof(jsd_jed0101_state_t, y_raw), 1, ""},
+    {"z_raw", JSD_FIELD_U32, offsetof(jsd_jed0101_state_t, z_raw), 1, ""},
+    {"w", JSD_FIELD_F64, offsetof(jsd_jed0101_state_t, w), 1, ""},
+    {"x", JSD_FIELD_F64, offsetof(jsd_jed0101_state_t, x), 1, ""},
+    {"y", JSD_FIELD_F64, offsetof(jsd_jed0101_state_t, y), 1, ""},
+    {"z", JSD_FIELD_F64, offsetof(jsd_jed0101_state_t, z), 1, ""},
+    {"cmd", JSD_FIELD_U16, offsetof(jsd_jed0101_state_t, cmd), 1, ""},
+};
+
+/****************************************************
+ * jsd_jed0200_state_t
+ ****************************************************/
+
+JSD_FIELD_CHECK(jsd_jed0200_state_t, status, uint16_t, 1);
+JSD_FIELD_CHECK(jsd_jed0200_state_t, ticks, uint32_t, 1);
+JSD_FIELD_CHECK(jsd_jed0200_state_t, voltage_hv, float, 1);
+JSD_FIELD_CHECK(jsd_jed0200_state_t, voltage_lv, float, 1);
+JSD_FIELD_CHECK(jsd_jed0200_state_t, voltage_12v, float, 1);
+JSD_FIELD_CHECK(jsd_jed0200_state_t, temp_ambient, float, 1);
+JSD_FIELD_CHECK(jsd_jed0200_state_t, temp_actuator, float, 1);
+JSD_FIELD_CHECK(jsd_jed0200_state_t, humidity, float, 1);
+JSD_FIELD_CHECK(jsd_jed0200_state_t, pressure, float, 1);
+JSD_FIELD_CHECK(jsd_jed0200_state_t, brake_current, uint16_t, 1);
+JSD_FIELD_CHECK(jsd_jed0200_state_t, brake_cc_val, uint16_t, 1);
+JSD_FIELD_CHECK(jsd_jed0200_state_t, cmd, uint16_t, 1);
+
+static const jsd_field_t jsd_fields_jed0200_state[] = {
+    {"status", JSD_FIELD_U16, offsetof(jsd_jed0200_state_t, status), 1, ""},
+    {"ticks", JSD_FIELD_U32, offsetof(jsd_jed0200_state_t, ticks), 1, ""},
+    {"voltage_hv", JSD_FIELD_F32, offsetof(jsd_jed0200_state_t, voltage_hv), 1,
+     ""},
+    {"voltage_lv", JSD_FIELD_F32, offsetof(jsd_jed0200_state_t, voltage_lv), 1,
+     ""},
+    {"voltage_12v", JSD_FIELD_F32, offsetof(jsd_jed0200_state_t, voltage_12v),
+     1, ""},
+    {"temp_ambient", JSD_FIELD_F32, offsetof(jsd_jed0200_state_t, temp_ambient),
+     1, ""},
+    {"temp_actuator", JSD_FIELD_F32,
+     offsetof(jsd_jed0200_state_t, temp_actuator), 1, ""},
+    {"humidity", JSD_FIELD_F32, offsetof(jsd_jed0200_state_t, humidity), 1, ""},
+    {"pressure", JSD_FIELD_F32, offsetof(jsd_jed0200_state_t, pressure), 1, ""},
+    {"brake_current", JSD_FIELD_U16,
+     offsetof(jsd_jed0200_state_t, brake_current), 1, ""},
+    {"brake_cc_val", JSD_FIELD_U16, offsetof(jsd_jed0200_state_t, brake_cc_val),
+     1, ""},
+    {"cmd", JSD_FIELD_U16, offsetof(jsd_jed0200_state_t, cmd), 1, ""},
+};
+
+/****************************************************
+ * jsd_ati_fts_state_t
+ ****************************************************/
+
+JSD_FIELD_CHECK(jsd_ati_fts_state_t, fx, double, 1);
+JSD_FIELD_CHECK(jsd_ati_fts_state_t, fy, double, 1);
+JSD_FIELD_CHECK(jsd_ati_fts_state_t, fz, double, 1);
+JSD_FIELD_CHECK(jsd_ati_fts_state_t, tx, double, 1);
+JSD_FIELD_CHECK(jsd_ati_fts_state_t, ty, double, 1);
+JSD_FIELD_CHECK(jsd_ati_fts_state_t, tz, double, 1);
+JSD_FIELD_CHECK(jsd_ati_fts_state_t, active_error, bool, 1);
+JSD_FIELD_CHECK(jsd_ati_fts_state_t, status_code, uint32_t, 1);
+JSD_FIELD_CHECK(jsd_ati_fts_state_t, sample_counter, uint32_t, 1);
+
+static const jsd_field_t jsd_fields_ati_fts_state[] = {
+    {"fx", JSD_FIELD_F64, offsetof(jsd_ati_fts_state_t, fx), 1, ""},
+    {"fy", JSD_FIELD_F64, offsetof(jsd_ati_fts_state_t, fy), 1, ""},
+    {"fz", JSD_FIELD_F64, offsetof(jsd_ati_fts_state_t, fz), 1, ""},
+    {"tx", JSD_FIELD_F64, offsetof(jsd_ati_fts_state_t, tx), 1, ""},
+    {"ty", JSD_FIELD_F64, offsetof(jsd_ati_fts_state_t, ty), 1, ""},
+    {"tz", JSD_FIELD_F64, offsetof(jsd_ati_fts_state_t, tz), 1, ""},
+    {"active_error", JSD_FIELD_BOOL,
+     offsetof(jsd_ati_fts_state_t, active_error), 1, ""},
+    {"status_code", JSD_FIELD_U32, offsetof(jsd_ati_fts_state_t, status_code),
+     1, ""},
+    {"sample_counter", JSD_FIELD_U32,
+     offsetof(jsd_ati_fts_state_t, sample_counter), 1, ""},
+};
+
+/****************************************************
+ * jsd_el3104_state_t
+ ****************************************************/
+
+JSD_FIELD_CHECK(jsd_el3104_state_t, voltage, double, JSD_EL3104_NUM_CHANNELS);
+JSD_FIELD_CHECK(jsd_el3104_state_t, adc_value, int16_t,
+                JSD_EL3104_NUM_CHANNELS);
+JSD_FIELD_CHECK(jsd_el3104_state_t, txPDO_state, uint8_t,
+                JSD_EL3104_NUM_CHANNELS);
+JSD_FIELD_CHECK(jsd_el3104_state_t, txPDO_toggle, uint8_t,
+                JSD_EL3104_NUM_CHANNELS);
+JSD_FIELD_CHECK(jsd_el3104_state_t, error, uint8_t, JSD_EL3104_NUM_CHANNELS);
+JSD_FIELD_CHECK(jsd_el3104_state_t, sync_error, uint8_t,
+                JSD_EL3104_NUM_CHANNELS);
+JSD_FIELD_CHECK(jsd_el3104_state_t, underrange, uint8_t,
+                JSD_EL3104_NUM_CHANNELS);
+JSD_FIELD_CHECK(jsd_el3104_state_t, overrange, uint8_t,
+                JSD_EL3104_NUM_CHANNELS);
+
+static const jsd_field_t jsd_fields_el3104_state[] = {
+    {"voltage", JSD_FIELD_F64, offsetof(jsd_el3104_state_t, voltage),
+     JSD_EL3104_NUM_CHANNELS, ""},
+    {"adc_value", JSD_FIELD_I16, offsetof(jsd_el3104_state_t, adc_value),
+     JSD_EL3104_NUM_CHANNELS, ""},
+    {"txPDO_state", JSD_FIELD_U8, offsetof(jsd_el3104_state_t, txPDO_state),
+     JSD_EL3104_NUM_CHANNELS, ""},
+    {"txPDO_toggle", JSD_FIELD_U8, offsetof(jsd_el3104_state_t, txPDO_toggle),
+     JSD_EL3104_NUM_CHANNELS, ""},
+    {"error", JSD_FIELD_U8, offsetof(jsd_el3104_state_t, error),
+     JSD_EL3104_NUM_CHANNELS, ""},
+    {"sync_error", JSD_FIELD_U8, offsetof(jsd_el3104_state_t, sync_error),
+     JSD_EL3104_NUM_CHANNELS, ""},
+    {"underrange", JSD_FIELD_U8, offsetof(jsd_el3104_state_t, underrange),
+     JSD_EL3104_NUM_CHANNELS, ""},
+    {"overrange", JSD_FIELD_U8, offsetof(jsd_el3104_state_t, overrange),
+     JSD_EL3104_NUM_CHANNELS, ""},
+};
+
+/****************************************************
+ * jsd_el3202_state_t
+ ****************************************************/
+
+JSD_FIELD_CHECK(jsd_el3202_state_t, output_eu, double, JSD_EL3202_NUM_CHANNELS);
+JSD_FIELD_CHECK(jsd_el3202_state_t, underrange, uint8_t,
+                JSD_EL3202_NUM_CHANNELS);
+JSD_FIELD_CHECK(jsd_el3202_state_t, overrange, uint8_t,
+                JSD_EL3202_NUM_CHANNELS);
+JSD_FIELD_CHECK(jsd_el3202_state_t, limit1, uint8_t, JSD_EL3202_NUM_CHANNELS);
+JSD_FIELD_CHECK(jsd_el3202_state_t, limit2, uint8_t, JSD_EL3202_NUM_CHANNELS);
+JSD_FIELD_CHECK(jsd_el3202_state_t, error, uint8_t, JSD_EL3202_NUM_CHANNELS);
+JSD_FIELD_CHECK(jsd_el3202_state_t, txPDO_state, uint8_t,
+                JSD_EL3202_NUM_CHANNELS);
+JSD_FIELD_CHECK(jsd_el3202_state_t, txPDO_toggle, uint8_t,
+                JSD_EL3202_NUM_CHANNELS);
+JSD_FIELD_CHECK(jsd_el3202_state_t, adc_value, int16_t,
+                JSD_EL3202_NUM_CHANNELS);
+
+static const jsd_field_t jsd_fields_el3202_state[] = {
+    {"output_eu", JSD_FIELD_F64, offsetof(jsd_el3202_state_t, output_eu),
+     JSD_EL3202_NUM_CHANNELS, "Ohm"},
+    {"underrange", JSD_FIELD_U8, offsetof(jsd_el3202_state_t, underrange),
+     JSD_EL3202_NUM_CHANNELS, ""},
+    {"overrange", JSD_FIELD_U8, offsetof(jsd_el3202_state_t, overrange),
+     JSD_EL3202_NUM_CHANNELS, ""},
+    {"limit1", JSD_FIELD_U8, offsetof(jsd_el3202_state_t, limit1),
+     JSD_EL3202_NUM_CHANNELS, ""},
+    {"limit2", JSD_FIELD_U8, offsetof(jsd_el3202_state_t, limit2),
+     JSD_EL3202_NUM_CHANNELS, ""},
+    {"error", JSD_FIELD_U8, offsetof(jsd_el3202_state_t, error),
+     JSD_EL3202_NUM_CHANNELS, ""},
+    {"txPDO_state", JSD_FIELD_U8, offsetof(jsd_el3202_state_t, txPDO_state),
+     JSD_EL3202_NUM_CHANNELS, ""},
+    {"txPDO_toggle", JSD_FIELD_U8, offsetof(jsd_el3202_state_t, txPDO_toggle),
+     JSD_EL3202_NUM_CHANNELS, ""},
+    {"adc_value", JSD_FIELD_I16, offsetof(jsd_el3202_state_t, adc_value),
+     JSD_EL3202_NUM_CHANNELS, ""},
+};
+
+/****************************************************
+ * jsd_el3318_state_t
+ ****************************************************/
+
+JSD_FIELD_CHECK(jsd_el3318_state_t, output_eu, double, JSD_EL3318_NUM_CHANNELS);
+JSD_FIELD_CHECK(jsd_el3318_state_t, underrange, uint8_t,
+                JSD_EL3318_NUM_CHANNELS);
+JSD_FIELD_CHECK(jsd_el3318_state_t, overrange, uint8_t,
+                JSD_EL3318_NUM_CHANNELS);
+JSD_FIELD_CHECK(jsd_el3318_state_t, error, uint8_t, JSD_EL3318_NUM_CHANNELS);
+JSD_FIELD_CHECK(jsd_el3318_state_t, txPDO_state, uint8_t,
+                JSD_EL3318_NUM_CHANNELS);
+JSD_FIELD_CHECK(jsd_el3318_state_t, txPDO_toggle, uint8_t,
+                JSD_EL3318_NUM_CHANNELS);
+JSD_FIELD_CHECK(jsd_el3318_state_t, adc_value, int16_t,
+                JSD_EL3318_NUM_CHANNELS);
+
+static const jsd_field_t jsd_fields_el3318_state[] = {
+    {"output_eu", JSD_FIELD_F64, offsetof(jsd_el3318_state_t, output_eu),
+     JSD_EL3318_NUM_CHANNELS, "Ohm"},
+    {"underrange", JSD_FIELD_U8, offsetof(jsd_el3318_state_t, underrange),
+     JSD_EL3318_NUM_CHANNELS, ""},
+    {"overrange", JSD_FIELD_U8, offsetof(jsd_el3318_state_t, overrange),
+     JSD_EL3318_NUM_CHANNELS, ""},
+    {"error", JSD_FIELD_U8, offsetof(jsd_el3318_state_t, error),
+     JSD_EL3318_NUM_CHANNELS, ""},
+    {"txPDO_state", JSD_FIELD_U8, offsetof(jsd_el3318_state_t, txPDO_state),
+     JSD_EL3318_NUM_CHANNELS, ""},
+    {"txPDO_toggle", JSD_FIELD_U8, offsetof(jsd_el3318_state_t, txPDO_toggle),
+     JSD_EL3318_NUM_CHANNELS, ""},
+    {"adc_value", JSD_FIELD_I16, offsetof(jsd_el3318_state_t, adc_value),
+     JSD_EL3318_NUM_CHANNELS, ""},
+};
+
+/****************************************************
+ * jsd_el3162_state_t
+ ****************************************************/
+
+JSD_FIELD_CHECK(jsd_el3162_state_t, voltage, double, JSD_EL3162_NUM_CHANNELS);
+JSD_FIELD_CHECK(jsd_el3162_state_t, adc_value, int16_t,
+                JSD_EL3162_NUM_CHANNELS);
+JSD_FIELD_CHECK(jsd_el3162_state_t, underrange, uint8_t,
+                JSD_EL3162_NUM_CHANNELS);
+JSD_FIELD_CHECK(jsd_el3162_state_t, overrange, uint8_t,
+                JSD_EL3162_NUM_CHANNELS);
+JSD_FIELD_CHECK(jsd_el3162_state_t, error, uint8_t, JSD_EL3162_NUM_CHANNELS);
+
+static const jsd_field_t jsd_fields_el3162_state[] = {
+    {"voltage", JSD_FIELD_F64, offsetof(jsd_el3162_state_t, voltage),
+     JSD_EL3162_NUM_CHANNELS, ""},
+    {"adc_value", JSD_FIELD_I16, offsetof(jsd_el3162_state_t, adc_value),
+     JSD_EL3162_NUM_CHANNELS, ""},
+    {"underrange", JSD_FIELD_U8, offsetof(jsd_el3162_state_t, underrange),
+     JSD_EL3162_NUM_CHANNELS, ""},
+    {"overrange", JSD_FIELD_U8, offsetof(jsd_el3162_state_t, overrange),
+     JSD_EL3162_NUM_CHANNELS, ""},
+    {"error", JSD_FIELD_U8, offsetof(jsd_el3162_state_t, error),
+     JSD_EL3162_NUM_CHANNELS, ""},
+};
+
+/****************************************************
+ * jsd_el4102_state_t
+ ****************************************************/
+
+JSD_FIELD_CHECK(jsd_el4102_state_t, dac_output, int16_t,
+                JSD_EL4102_NUM_CHANNELS);
+JSD_FIELD_CHECK(jsd_el4102_state_t, voltage_output, double,
+                JSD_EL4102_NUM_CHANNELS);
+
+static const jsd_field_t jsd_fields_el4102_state[] = {
+    {"dac_output", JSD_FIELD_I16, offsetof(jsd_el4102_state_t, dac_output),
+     JSD_EL4102_NUM_CHANNELS, "V"},
+    {"voltage_output", JSD_FIELD_F64,
+     offsetof(jsd_el4102_state_t, voltage_output), JSD_EL4102_NUM_CHANNELS, ""},
+};
+
+/****************************************************
+ * jsd_ild1900_state_t
+ ****************************************************/
+
+JSD_FIELD_CHECK(jsd_ild1900_state_t, distance_m, double, 1);
+JSD_FIELD_CHECK(jsd_ild1900_state_t, intensity, double, 1);
+JSD_FIELD_CHECK(jsd_ild1900_state_t, timestamp_us, uint32_t, 1);
+JSD_FIELD_CHECK(jsd_ild1900_state_t, counter, uint32_t, 1);
+JSD_FIELD_CHECK(jsd_ild1900_state_t, sensor_status, uint32_t, 1);
+JSD_FIELD_CHECK(jsd_ild1900_state_t, distance_raw, uint32_t, 1);
+JSD_FIELD_CHECK(jsd_ild1900_state_t, error, int32_t, 1);
+
+static const jsd_field_t jsd_fields_ild1900_state[] = {
+    {"distance_m", JSD_FIELD_F64, offsetof(jsd_ild1900_state_t, distance_m), 1,
+     "m"},
+    {"intensity", JSD_FIELD_F64, offsetof(jsd_ild1900_state_t, intensity), 1,
+     "%"},
+    {"timestamp_us", JSD_FIELD_U32, offsetof(jsd_ild1900_state_t, timestamp_us),
+     1, "us"},
+    {"counter", JSD_FIELD_U32, offsetof(jsd_ild1900_state_t, counter), 1, ""},
+    {"sensor_status", JSD_FIELD_U32,
+     offsetof(jsd_ild1900_state_t, sensor_status), 1, "s"},
+    {"distance_raw", JSD_FIELD_U32, offsetof(jsd_ild1900_state_t, distance_raw),
+     1, ""},
+    {"error", JSD_FIELD_I32, offsetof(jsd_ild1900_state_t, error), 1, ""},
+};
+
+/****************************************************
+ * jsd_epd_state_t
+ ****************************************************/
+
+JSD_FIELD_CHECK(jsd_epd_state_t, actual_position, int32_t, 1);
+JSD_FIELD_CHECK(jsd_epd_state_t, actual_velocity, int32_t, 1);
+JSD_FIELD_CHECK(jsd_epd_state_t, actual_current, double, 1);
+JSD_FIELD_CHECK(jsd_epd_state_t, cmd_position, int32_t, 1);
+JSD_FIELD_CHECK(jsd_epd_state_t, cmd_velocity, int32_t, 1);
+JSD_FIELD_CHECK(jsd_epd_state_t, cmd_current, double, 1);
+JSD_FIELD_CHECK(jsd_epd_state_t, cmd_max_current, double, 1);
+JSD_FIELD_CHECK(jsd_epd_state_t, cmd_ff_position, int32_t, 1);
+JSD_FIELD_CHECK(jsd_epd_state_t, cmd_ff_velocity, int32_t, 1);
+JSD_FIELD_CHECK(jsd_epd_state_t, cmd_ff_current, double, 1);
+JSD_FIELD_CHECK(jsd_epd_state_t, cmd_prof_velocity, uint32_t, 1);
+JSD_FIELD_CHECK(jsd_epd_state_t, cmd_prof_end_velocity, uint32_t, 1);
+JSD_FIELD_CHECK(jsd_epd_state_t, cmd_prof_accel, uint32_t, 1);
+JSD_FIELD_CHECK(jsd_epd_state_t, cmd_prof_decel, uint32_t, 1);
+JSD_FIELD_CHECK(jsd_epd_state_t, actual_state_machine_state, int32_t, 1);
+JSD_FIELD_CHECK(jsd_epd_state_t, actual_mode_of_operation, int32_t, 1);
+JSD_FIELD_CHECK(jsd_epd_state_t, sto_engaged, uint8_t, 1);
+JSD_FIELD_CHECK(jsd_epd_state_t, hall_state, uint8_t, 1);
+JSD_FIELD_CHECK(jsd_epd_state_t, motor_on, uint8_t, 1);
+JSD_FIELD_CHECK(jsd_epd_state_t, in_motion, uint8_t, 1);
+JSD_FIELD_CHECK(jsd_epd_state_t, servo_enabled, uint8_t, 1);
+JSD_FIELD_CHECK(jsd_epd_state_t, warning, uint8_t, 1);
+JSD_FIELD_CHECK(jsd_epd_state_t, target_reached, uint8_t, 1);
+JSD_FIELD_CHECK(jsd_epd_state_t, setpoint_ack_rise, bool, 1);
+JSD_FIELD_CHECK(jsd_epd_state_t, fault_code, int32_t, 1);
+JSD_FIELD_CHECK(jsd_epd_state_t, emcy_error_code, uint16_t, 1);
+JSD_FIELD_CHECK(jsd_epd_state_t, bus_voltage, double, 1);
+JSD_FIELD_CHECK(jsd_epd_state_t, analog_input_voltage, double, 1);
+JSD_FIELD_CHECK(jsd_epd_state_t, analog_input_adc, uint16_t, 1);
+JSD_FIELD_CHECK(jsd_epd_state_t, digital_inputs, uint8_t,
+                JSD_EPD_NUM_DIGITAL_INPUTS);
+JSD_FIELD_CHECK(jsd_epd_state_t, digital_output_cmd, uint8_t,
+                JSD_EPD_NUM_DIGITAL_OUTPUTS);
+JSD_FIELD_CHECK(jsd_epd_state_t, drive_temperature, float, 1);
+
+static const jsd_field_t jsd_fields_epd_state[] = {
+    {"actual_position", JSD_FIELD_I32,
+     offsetof(jsd_epd_state_t, actual_position), 1, "cnt"},
+    {"actual_velocity", JSD_FIELD_I32,
+     offsetof(jsd_epd_state_t, actual_velocity), 1, "cnt/s"},
+    {"actual_current", JSD_FIELD_F64, offsetof(jsd_epd_state_t, actual_current),
+     1, "A"},
+    {"cmd_position", JSD_FIELD_I32, offsetof(jsd_epd_state_t, cmd_position), 1,
+     "cnt"},
+    {"cmd_velocity", JSD_FIELD_I32, offsetof(jsd_epd_state_t, cmd_velocity), 1,
+     "cnt/s"},
+    {"cmd_current", JSD_FIELD_F64, offsetof(jsd_epd_state_t, cmd_current), 1,
+     "A"},
+    {"cmd_max_current", JSD_FIELD_F64,
+     offsetof(jsd_epd_state_t, cmd_max_current), 1, "A"},
+    {"cmd_ff_position", JSD_FIELD_I32,
+     offsetof(jsd_epd_state_t, cmd_ff_position), 1, "cnt"},
+    {"cmd_ff_velocity", JSD_FIELD_I32,
+     offsetof(jsd_epd_state_t, cmd_ff_velocity), 1, "cnt/s"},
+    {"cmd_ff_current", JSD_FIELD_F64, offsetof(jsd_epd_state_t, cmd_ff_current),
+     1, "A"},
+    {"cmd_prof_velocity", JSD_FIELD_U32,
+     offsetof(jsd_epd_state_t, cmd_prof_velocity), 1, "cnt/s"},
+    {"cmd_prof_end_velocity", JSD_FIELD_U32,
+     offsetof(jsd_epd_state_t, cmd_prof_end_velocity), 1, "cnt/s"},
+    {"cmd_prof_accel", JSD_FIELD_U32, offsetof(jsd_epd_state_t, cmd_prof_accel),
+     1, "cnt/s^2"},
+    {"cmd_prof_decel", JSD_FIELD_U32, offsetof(jsd_epd_state_t, cmd_prof_decel),
+     1, "cnt/s^2"},
+    {"actual_state_machine_state", JSD_FIELD_I32,
+     offsetof(jsd_epd_state_t, actual_state_machine_state), 1, ""},
+    {"actual_mode_of_operation", JSD_FIELD_I32,
+     offsetof(jsd_epd_state_t, actual_mode_of_operation), 1, ""},
+    {"sto_engaged", JSD_FIELD_U8, offsetof(jsd_epd_state_t, sto_engaged), 1,
+     ""},
+    {"hall_state", JSD_FIELD_U8, offsetof(jsd_epd_state_t, hall_state), 1, ""},
+    {"motor_on", JSD_FIELD_U8, offsetof(jsd_epd_state_t, motor_on), 1, ""},
+    {"in_motion", JSD_FIELD_U8, offsetof(jsd_epd_state_t, in_motion), 1, ""},
+    {"servo_enabled", JSD_FIELD_U8, offsetof(jsd_epd_state_t, servo_enabled), 1,
+     ""},
+    {"warning", JSD_FIELD_U8, offsetof(jsd_epd_state_t, warning), 1, ""},
+    {"target_reached", JSD_FIELD_U8, offsetof(jsd_epd_state_t, target_reached),
+     1, ""},
+    {"setpoint_ack_rise", JSD_FIELD_BOOL,
+     offsetof(jsd_epd_state_t, setpoint_ack_rise), 1, ""},
+    {"fault_code", JSD_FIELD_I32, offsetof(jsd_epd_state_t, fault_code), 1, ""},
+    {"emcy_error_code", JSD_FIELD_U16,
+     offsetof(jsd_epd_state_t, emcy_error_code), 1, ""},
+    {"bus_voltage", JSD_FIELD_F64, offsetof(jsd_epd_state_t, bus_voltage), 1,
+     "V"},
+    {"analog_input_voltage", JSD_FIELD_F64,
+     offsetof(jsd_epd_state_t, analog_input_voltage), 1, "V"},
+    {"analog_input_adc", JSD_FIELD_U16,
+     offsetof(jsd_epd_state_t, analog_input_adc), 1, ""},
+    {"digital_inputs", JSD_FIELD_U8, offsetof(jsd_epd_state_t, digital_inputs),
+     JSD_EPD_NUM_DIGITAL_INPUTS, ""},
+    {"digital_output_cmd", JSD_FIELD_U8,
+     offsetof(jsd_epd_state_t, digital_output_cmd), JSD_EPD_NUM_DIGITAL_OUTPUTS,
+     ""},
+    {"drive_temperature", JSD_FIELD_F32,
+     offsetof(jsd_epd_state_t, drive_temperature), 1, "degC"},
+};
+
+/****************************************************
+ * jsd_el3602_config_t
+ ****************************************************/
+
+JSD_FIELD_CHECK(jsd_el3602_config_t, range, int32_t, JSD_EL3602_NUM_CHANNELS);
+JSD_FIELD_CHECK(jsd_el3602_config_t, filter, int32_t, JSD_EL3602_NUM_CHANNELS);
+JSD_FIELD_CHECK(jsd_el3602_config_t, limit1_enable, bool,
+                JSD_EL3602_NUM_CHANNELS);
+JSD_FIELD_CHECK(jsd_el3602_config_t, limit1_voltage, double,
+                JSD_EL3602_NUM_CHANNELS);
+JSD_FIELD_CHECK(jsd_el3602_config_t, limit2_enable, bool,
+                JSD_EL3602_NUM_CHANNELS);
+JSD_FIELD_CHECK(jsd_el3602_config_t, limit2_voltage, double,
+                JSD_EL3602_NUM_CHANNELS);
+
+static const jsd_field_t jsd_fields_el3602_config[] = {
+    {"range", JSD_FIELD_I32, offsetof(jsd_el3602_config_t, range),
+     JSD_EL3602_NUM_CHANNELS, ""},
+    {"filter", JSD_FIELD_I32, offsetof(jsd_el3602_config_t, filter),
+     JSD_EL3602_NUM_CHANNELS, ""},
+    {"limit1_enable", JSD_FIELD_BOOL,
+     offsetof(jsd_el3602_config_t, limit1_enable), JSD_EL3602_NUM_CHANNELS, ""},
+    {"limit1_voltage", JSD_FIELD_F64,
+     offsetof(jsd_el3602_config_t, limit1_voltage), JSD_EL3602_NUM_CHANNELS,
+     "V"},
+    {"limit2_enable", JSD_FIELD_BOOL,
+     offsetof(jsd_el3602_config_t, limit2_enable), JSD_EL3602_NUM_CHANNELS, ""},
+    {"limit2_voltage", JSD_FIELD_F64,
+     offsetof(jsd_el3602_config_t, limit2_voltage), JSD_EL3602_NUM_CHANNELS,
+     "V"},
+};
+
+/****************************************************
+ * jsd_el3208_config_t
+ ****************************************************/
+
+JSD_FIELD_CHECK(jsd_el3208_config_t, element, int32_t, JSD_EL3208_NUM_CHANNELS);
+JSD_FIELD_CHECK(jsd_el3208_config_t, filter, int32_t, JSD_EL3208_NUM_CHANNELS);
+JSD_FIELD_CHECK(jsd_el3208_config_t, connection, int32_t,
+                JSD_EL3208_NUM_CHANNELS);
+JSD_FIELD_CHECK(jsd_el3208_config_t, wire_resistance, double,
+                JSD_EL3208_NUM_CHANNELS);
+JSD_FIELD_CHECK(jsd_el3208_config_t, presentation, int32_t,
+                JSD_EL3208_NUM_CHANNELS);
+
+static const jsd_field_t jsd_fields_el3208_config[] = {
+    {"element", JSD_FIELD_I32, offsetof(jsd_el3208_config_t, element),
+     JSD_EL3208_NUM_CHANNELS, ""},
+    {"filter", JSD_FIELD_I32, offsetof(jsd_el3208_config_t, filter),
+     JSD_EL3208_NUM_CHANNELS, ""},
+    {"connection", JSD_FIELD_I32, offsetof(jsd_el3208_config_t, connection),
+     JSD_EL3208_NUM_CHANNELS, ""},
+    {"wire_resistance", JSD_FIELD_F64,
+     offsetof(jsd_el3208_config_t, wire_resistance), JSD_EL3208_NUM_CHANNELS,
+     "Ohm"},
+    {"presentation", JSD_FIELD_I32, offsetof(jsd_el3208_config_t, presentation),
+     JSD_EL3208_NUM_CHANNELS, ""},
+};
+
+/****************************************************
+ * jsd_el2124_config_t
+ ****************************************************/
+
+
+/****************************************************
+ * jsd_egd_config_t
+ ****************************************************/
+
+JSD_FIELD_CHECK(jsd_egd_config_t, drive_cmd_mode, int32_t, 1);
+JSD_FIELD_CHECK(jsd_egd_config_t, max_motor_speed, double, 1);
+JSD_FIELD_CHECK(jsd_egd_config_t, loop_period_ms, int8_t, 1);
+JSD_FIELD_CHECK(jsd_egd_config_t, torque_slope, double, 1);
+JSD_FIELD_CHECK(jsd_egd_config_t, max_profile_accel, uint32_t, 1);
+JSD_FIELD_CHECK(jsd_egd_config_t, max_profile_decel, uint32_t, 1);
+JSD_FIELD_CHECK(jsd_egd_config_t, velocity_tracking_error, int32_t, 1);
+JSD_FIELD_CHECK(jsd_egd_config_t, position_tracking_error, int32_t, 1);
+JSD_FIELD_CHECK(jsd_egd_config_t, peak_current_limit, float, 1);
+JSD_FIELD_CHECK(jsd_egd_config_t, peak_current_time, float, 1);
+JSD_FIELD_CHECK(jsd_egd_config_t, continuous_current_limit, float, 1);
+JSD_FIELD_CHECK(jsd_egd_config_t, motor_stuck_current_level_pct, float, 1);
+JSD_FIELD_CHECK(jsd_egd_config_t, motor_stuck_velocity_threshold, float, 1);
+JSD_FIELD_CHECK(jsd_egd_config_t, motor_stuck_timeout, float, 1);
+JSD_FIELD_CHECK(jsd_egd_config_t, over_speed_threshold, int32_t, 1);
+JSD_FIELD_CHECK(jsd_egd_config_t, low_position_limit, int32_t, 1);
+JSD_FIELD_CHECK(jsd_egd_config_t, high_position_limit, int32_t, 1);
+JSD_FIELD_CHECK(jsd_egd_config_t, brake_engage_msec, int32_t, 1);
+JSD_FIELD_CHECK(jsd_egd_config_t, brake_disengage_msec, int32_t, 1);
+JSD_FIELD_CHECK(jsd_egd_config_t, crc, int32_t, 1);
+JSD_FIELD_CHECK(jsd_egd_config_t, drive_max_current_limit, float, 1);
+JSD_FIELD_CHECK(jsd_egd_config_t, smooth_factor, int32_t, 1);
+JSD_FIELD_CHECK(jsd_egd_config_t, ctrl_gain_scheduling_mode, int32_t, 1);
+
+static const jsd_field_t jsd_fields_egd_config[] = {
+    {"drive_cmd_mode", JSD_FIELD_I32,
+     offsetof(jsd_egd_config_t, drive_cmd_mode), 1, ""},
+    {"max_motor_speed", JSD_FIELD_F64,
+     offsetof(jsd_egd_config_t, max_motor_speed), 1, "cnt/s"},
+    {"loop_period_ms", JSD_FIELD_I8, offsetof(jsd_egd_config_t, loop_period_ms),
+     1, "ms"},
+    {"torque_slope", JSD_FIELD_F64, offsetof(jsd_egd_config_t, torque_slope), 1,
+     "A/s"},
+    {"max_profile_accel", JSD_FIELD_U32,
+     offsetof(jsd_egd_config_t, max_profile_accel), 1, ""},
+    {"max_profile_decel", JSD_FIELD_U32,
+     offsetof(jsd_egd_config_t, max_profile_decel), 1, ""},
+    {"velocity_tracking_error", JSD_FIELD_I32,
+     offsetof(jsd_egd_config_t, velocity_tracking_error), 1, "cnt/s"},
+    {"position_tracking_error", JSD_FIELD_I32,
+     offsetof(jsd_egd_config_t, position_tracking_error), 1, "cnt"},
+    {"peak_current_limit", JSD_FIELD_F32,
+     offsetof(jsd_egd_config_t, peak_current_limit), 1, "A"},
+    {"peak_current_time", JSD_FIELD_F32,
+     offsetof(jsd_egd_config_t, peak_current_time), 1, "s"},
+    {"continuous_current_limit", JSD_FIELD_F32,
+     offsetof(jsd_egd_config_t, continuous_current_limit), 1, "A"},
+    {"motor_stuck_current_level_pct", JSD_FIELD_F32,
+     offsetof(jsd_egd_config_t, motor_stuck_current_level_pct), 1, "%"},
+    {"motor_stuck_velocity_threshold", JSD_FIELD_F32,
+     offsetof(jsd_egd_config_t, motor_stuck_velocity_threshold), 1, "cnt/s"},
+    {"motor_stuck_timeout", JSD_FIELD_F32,
+     offsetof(jsd_egd_config_t, motor_stuck_timeout), 1, "ms"},
+    {"over_speed_threshold", JSD_FIELD_I32,
+     offsetof(jsd_egd_config_t, over_speed_threshold), 1, "cnt"},
+    {"low_position_limit", JSD_FIELD_I32,
+     offsetof(jsd_egd_config_t, low_position_limit), 1, "cnt"},
+    {"high_position_limit", JSD_FIELD_I32,
+     offsetof(jsd_egd_config_t, high_position_limit), 1, "cnt"},
+    {"brake_engage_msec", JSD_FIELD_I32,
+     offsetof(jsd_egd_config_t, brake_engage_msec), 1, "ms"},
+    {"brake_disengage_msec", JSD_FIELD_I32,
+     offsetof(jsd_egd_config_t, brake_disengage_msec), 1, "ms"},
+    {"crc", JSD_FIELD_I32, offsetof(jsd_egd_config_t, crc), 1, ""},
+    {"drive_max_current_limit", JSD_FIELD_F32,
+     offsetof(jsd_egd_config_t, drive_max_current_limit), 1, ""},
+    {"smooth_factor", JSD_FIELD_I32, offsetof(jsd_egd_config_t, smooth_factor),
+     1, "ms"},
+    {"ctrl_gain_scheduling_mode", JSD_FIELD_I32,
+     offsetof(jsd_egd_config_t, ctrl_gain_scheduling_mode), 1, "s"},
+};
+
+/****************************************************
+ * jsd_el3356_config_t
+ ****************************************************/
+
+JSD_FIELD_CHECK(jsd_el3356_config_t, scale_factor, double, 1);
+
+static const jsd_field_t jsd_fields_el3356_config[] = {
+    {"scale_factor", JSD_FIELD_F64, offsetof(jsd_el3356_config_t, scale_factor),
+     1, ""},
+};
+
+/****************************************************
+ * jsd_jed0101_config_t
+ ****************************************************/
+
+JSD_FIELD_CHECK(jsd_jed0101_config_t, initial_cmd, uint16_t, 1);
+
+static const jsd_field_t jsd_fields_jed0101_config[] = {
+    {"initial_cmd", JSD_FIELD_U16, offsetof(jsd_jed0101_config_t, initial_cmd),
+     1, ""},
+};
+
+/****************************************************
+ * jsd_jed0200_config_t
+ ****************************************************/
+
+JSD_FIELD_CHECK(jsd_jed0200_config_t, initial_cmd, uint16_t, 1);
+
+static const jsd_field_t jsd_fields_jed0200_config[] = {
+    {"initial_cmd", JSD_FIELD_U16, offsetof(jsd_jed0200_config_t, initial_cmd),
+     1, ""},
+};
+
+/****************************************************
+ * jsd_ati_fts_config_t
+ ****************************************************/
+
+JSD_FIELD_CHECK(jsd_ati_fts_config_t, calibration, uint32_t, 1);
+JSD_FIELD_CHECK(jsd_ati_fts_config_t, counts_per_force, int32_t, 1);
+JSD_FIELD_CHECK(jsd_ati_fts_config_t, counts_per_torque, int32_t, 1);
+
+static const jsd_field_t jsd_fields_ati_fts_config[] = {
+    {"calibration", JSD_FIELD_U32, offsetof(jsd_ati_fts_config_t, calibration),
+     1, ""},
+    {"counts_per_force", JSD_FIELD_I32,
+     offsetof(jsd_ati_fts_config_t, counts_per_force), 1, ""},
+    {"counts_per_torque", JSD_FIELD_I32,
+     offsetof(jsd_ati_fts_config_t, counts_per_torque), 1, ""},
+};
+
+/****************************************************
+ * jsd_el3104_config_t
+ ****************************************************/
+
+
+/****************************************************
+ * jsd_el3202_config_t
+ ****************************************************/
+
+JSD_FIELD_CHECK(jsd_el3202_config_t, element, int32_t, JSD_EL3202_NUM_CHANNELS);
+JSD_FIELD_CHECK(jsd_el3202_config_t, filter, int32_t, JSD_EL3202_NUM_CHANNELS);
+JSD_FIELD_CHECK(jsd_el3202_config_t, connection, int32_t,
+                JSD_EL3202_NUM_CHANNELS);
+JSD_FIELD_CHECK(jsd_el3202_config_t, wire_resistance, double,
+                JSD_EL3202_NUM_CHANNELS);
+JSD_FIELD_CHECK(jsd_el3202_config_t, presentation, int32_t,
+                JSD_EL3202_NUM_CHANNELS);
+
+static const jsd_field_t jsd_fields_el3202_config[] = {
+    {"element", JSD_FIELD_I32, offsetof(jsd_el3202_config_t, element),
+     JSD_EL3202_NUM_CHANNELS, ""},
+    {"filter", JSD_FIELD_I32, offsetof(jsd_el3202_config_t, filter),
+     JSD_EL3202_NUM_CHANNELS, ""},
+    {"connection", JSD_FIELD_I32, offsetof(jsd_el3202_config_t, connection),
+     JSD_EL3202_NUM_CHANNELS, ""},
+    {"wire_resistance", JSD_FIELD_F64,
+     offsetof(jsd_el3202_config_t, wire_resistance), JSD_EL3202_NUM_CHANNELS,
+     "Ohm"},
+    {"presentation", JSD_FIELD_I32, offsetof(jsd_el3202_config_t, presentation),
+     JSD_EL3202_NUM_CHANNELS, ""},
+};
+
+/****************************************************
+ * jsd_el3318_config_t
+ ****************************************************/
+
+JSD_FIELD_CHECK(jsd_el3318_config_t, element, int32_t, JSD_EL3318_NUM_CHANNELS);
+JSD_FIELD_CHECK(jsd_el3318_config_t, filter, int32_t, JSD_EL3208_NUM_CHANNELS);
+JSD_FIELD_CHECK(jsd_el3318_config_t, presentation, int32_t,
+                JSD_EL3318_NUM_CHANNELS);
+
+static const jsd_field_t jsd_fields_el3318_config[] = {
+    {"element", JSD_FIELD_I32, offsetof(jsd_el3318_config_t, element),
+     JSD_EL3318_NUM_CHANNELS, ""},
+    {"filter", JSD_FIELD_I32, offsetof(jsd_el3318_config_t, filter),
+     JSD_EL3208_NUM_CHANNELS, ""},
+    {"presentation", JSD_FIELD_I32, offsetof(jsd_el3318_config_t, presentation),
+     JSD_EL3318_NUM_CHANNELS, ""},
+};
+
+/****************************************************
+ * jsd_el3162_config_t
+ ****************************************************/
+
+
+/****************************************************
+ * jsd_el4102_config_t
+ ****************************************************/
+
+
+/****************************************************
+ * jsd_ild1900_config_t
+ ****************************************************/
+
+JSD_FIELD_CHECK(jsd_ild1900_config_t, measuring_rate, double, 1);
+JSD_FIELD_CHECK(jsd_ild1900_config_t, averaging_number, uint32_t, 1);
+JSD_FIELD_CHECK(jsd_ild1900_config_t, averaging_type, int32_t, 1);
+JSD_FIELD_CHECK(jsd_ild1900_config_t, model, int32_t, 1);
+JSD_FIELD_CHECK(jsd_ild1900_config_t, exposure_mode, int32_t, 1);
+JSD_FIELD_CHECK(jsd_ild1900_config_t, peak_selection, int32_t, 1);
+
+static const jsd_field_t jsd_fields_ild1900_config[] = {
+    {"measuring_rate", JSD_FIELD_F64,
+     offsetof(jsd_ild1900_config_t, measuring_rate), 1, "Hz"},
+    {"averaging_number", JSD_FIELD_U32,
+     offsetof(jsd_ild1900_config_t, averaging_number), 1, ""},
+    {"averaging_type", JSD_FIELD_I32,
+     offsetof(jsd_ild1900_config_t, averaging_type), 1, ""},
+    {"model", JSD_FIELD_I32, offsetof(jsd_ild1900_config_t, model), 1, ""},
+    {"exposure_mode", JSD_FIELD_I32,
+     offsetof(jsd_ild1900_config_t, exposure_mode), 1, ""},
+    {"peak_selection", JSD_FIELD_I32,
+     offsetof(jsd_ild1900_config_t, peak_selection), 1, ""},
+};
+
+/****************************************************
+ * jsd_epd_config_t
+ ****************************************************/
+
+JSD_FIELD_CHECK(jsd_epd_config_t, max_motor_speed, double, 1);
+JSD_FIELD_CHECK(jsd_epd_config_t, loop_period_ms, uint8_t, 1);
+JSD_FIELD_CHECK(jsd_epd_config_t, torque_slope, double, 1);
+JSD_FIELD_CHECK(jsd_epd_config_t, max_profile_accel, double, 1);
+JSD_FIELD_CHECK(jsd_epd_config_t, max_profile_decel, double, 1);
+JSD_FIELD_CHECK(jsd_epd_config_t, velocity_tracking_error, double, 1);
+JSD_FIELD_CHECK(jsd_epd_config_t, position_tracking_error, double, 1);
+JSD_FIELD_CHECK(jsd_epd_config_t, peak_current_limit, float, 1);
+JSD_FIELD_CHECK(jsd_epd_config_t, peak_current_time, float, 1);
+JSD_FIELD_CHECK(jsd_epd_config_t, continuous_current_limit, float, 1);
+JSD_FIELD_CHECK(jsd_epd_config_t, motor_stuck_current_level_pct, float, 1);
+JSD_FIELD_CHECK(jsd_epd_config_t, motor_stuck_velocity_threshold, float, 1);
+JSD_FIELD_CHECK(jsd_epd_config_t, motor_stuck_timeout, float, 1);
+JSD_FIELD_CHECK(jsd_epd_config_t, over_speed_threshold, double, 1);
+JSD_FIELD_CHECK(jsd_epd_config_t, low_position_limit, double, 1);
+JSD_FIELD_CHECK(jsd_epd_config_t, high_position_limit, double, 1);
+JSD_FIELD_CHECK(jsd_epd_config_t, brake_engage_msec, int16_t, 1);
+JSD_FIELD_CHECK(jsd_epd_config_t, brake_disengage_msec, int16_t, 1);
+JSD_FIELD_CHECK(jsd_epd_config_t, crc, uint32_t, 1);
+JSD_FIELD_CHECK(jsd_epd_config_t, smooth_factor, int32_t, 1);
+JSD_FIELD_CHECK(jsd_epd_config_t, ctrl_gain_scheduling_mode, int32_t, 1);
+
+static const jsd_field_t jsd_fields_epd_config[] = {
+    {"max_motor_speed", JSD_FIELD_F64,
+     offsetof(jsd_epd_config_t, max_motor_speed), 1, "cnt/s"},
+    {"loop_period_ms", JSD_FIELD_U8, offsetof(jsd_epd_config_t, loop_period_ms),
+     1, "ms"},
+    {"torque_slope", JSD_FIELD_F64, offsetof(jsd_epd_config_t, torque_slope), 1,
+     "A/s"},
+    {"max_profile_accel", JSD_FIELD_F64,
+     offsetof(jsd_epd_config_t, max_profile_accel), 1, ""},
+    {"max_profile_decel", JSD_FIELD_F64,
+     offsetof(jsd_epd_config_t, max_profile_decel), 1, ""},
+    {"velocity_tracking_error", JSD_FIELD_F64,
+     offsetof(jsd_epd_config_t, velocity_tracking_error), 1, "cnt/s"},
+    {"position_tracking_error", JSD_FIELD_F64,
+     offsetof(jsd_epd_config_t, position_tracking_error), 1, "cnt"},
+    {"peak_current_limit", JSD_FIELD_F32,
+     offsetof(jsd_epd_config_t, peak_current_limit), 1, "A"},
+    {"peak_current_time", JSD_FIELD_F32,
+     offsetof(jsd_epd_config_t, peak_current_time), 1, "s"},
+    {"continuous_current_limit", JSD_FIELD_F32,
+     offsetof(jsd_epd_config_t, continuous_current_limit), 1, "A"},
+    {"motor_stuck_current_level_pct", JSD_FIELD_F32,
+     offsetof(jsd_epd_config_t, motor_stuck_current_level_pct), 1, "%"},
+    {"motor_stuck_velocity_threshold", JSD_FIELD_F32,
+     offsetof(jsd_epd_config_t, motor_stuck_velocity_threshold), 1, "cnt/s"},
+    {"motor_stuck_timeout", JSD_FIELD_F32,
+     offsetof(jsd_epd_config_t, motor_stuck_timeout), 1, "ms"},
+    {"over_speed_threshold", JSD_FIELD_F64,
+     offsetof(jsd_epd_config_t, over_speed_threshold), 1, "cnt/s"},
+    {"low_position_limit", JSD_FIELD_F64,
+     offsetof(jsd_epd_config_t, low_position_limit), 1, "cnt"},
+    {"high_position_limit", JSD_FIELD_F64,
+     offsetof(jsd_epd_config_t, high_position_limit), 1, "cnt"},
+    {"brake_engage_msec", JSD_FIELD_I16,
+     offsetof(jsd_epd_config_t, brake_engage_msec), 1, "ms"},
+    {"brake_disengage_msec", JSD_FIELD_I16,
+     offsetof(jsd_epd_config_t, brake_disengage_msec), 1, "ms"},
+    {"crc", JSD_FIELD_U32, offsetof(jsd_epd_config_t, crc), 1, ""},
+    {"smooth_factor", JSD_FIELD_I32, offsetof(jsd_epd_config_t, smooth_factor),
+     1, "ms"},
+    {"ctrl_gain_scheduling_mode", JSD_FIELD_I32,
+     offsetof(jsd_epd_config_t, ctrl_gain_scheduling_mode), 1, ""},
+};
+
+const jsd_struct_desc_t jsd_fields_state_descs[] = {
+    {"jsd_el3602_state_t", JSD_EL3602_PRODUCT_CODE, sizeof(jsd_el3602_state_t),
+     offsetof(jsd_slave_state_t, el3602), jsd_fields_el3602_state,
+     sizeof(jsd_fields_el3602_state) / sizeof(jsd_field_t)},
+    {"jsd_el3208_state_t", JSD_EL3208_PRODUCT_CODE, sizeof(jsd_el3208_state_t),
+     offsetof(jsd_slave_state_t, el3208), jsd_fields_el3208_state,
+     sizeof(jsd_fields_el3208_state) / sizeof(jsd_field_t)},
+    {"jsd_el2124_state_t", JSD_EL2124_PRODUCT_CODE, sizeof(jsd_el2124_state_t),
+     offsetof(jsd_slave_state_t, el2124), jsd_fields_el2124_state,
+     sizeof(jsd_fields_el2124_state) / sizeof(jsd_field_t)},
+    {"jsd_egd_state_t", JSD_EGD_PRODUCT_CODE, sizeof(jsd_egd_state_t),
+     offsetof(jsd_slave_state_t, egd.pub), jsd_fields_egd_state,
+     sizeof(jsd_fields_egd_state) / sizeof(jsd_field_t)},
+    {"jsd_el3356_state_t", JSD_EL3356_PRODUCT_CODE, sizeof(jsd_el3356_state_t),
+     offsetof(jsd_slave_state_t, el3356), jsd_fields_el3356_state,
+     sizeof(jsd_fields_el3356_state) / sizeof(jsd_field_t)},
+    {"jsd_jed0101_state_t", JSD_JED0101_PRODUCT_CODE,
+     sizeof(jsd_jed0101_state_t), offsetof(jsd_slave_state_t, jed0101),
+     jsd_fields_jed0101_state,
+     sizeof(jsd_fields_jed0101_state) / sizeof(jsd_field_t)},
+    {"jsd_jed0200_state_t", JSD_JED0200_PRODUCT_CODE,
+     sizeof(jsd_jed0200_state_t), offsetof(jsd_slave_state_t, jed0200),
+     jsd_fields_jed0200_state,
+     sizeof(jsd_fields_jed0200_state) / sizeof(jsd_field_t)},
+    {"jsd_ati_fts_state_t", JSD_ATI_FTS_PRODUCT_CODE,
+     sizeof(jsd_ati_fts_state_t), offsetof(jsd_slave_state_t, ati_fts),
+     jsd_fields_ati_fts_state,
+     sizeof(jsd_fields_ati_fts_state) / sizeof(jsd_field_t)},
+    {"jsd_el3104_state_t", JSD_EL3104_PRODUCT_CODE, sizeof(jsd_el3104_state_t),
+     offsetof(jsd_slave_state_t, el3104), jsd_fields_el3104_state,
+     sizeof(jsd_fields_el3104_state) / sizeof(jsd_field_t)},
+    {"jsd_el3202_state_t", JSD_EL3202_PRODUCT_CODE, sizeof(jsd_el3202_state_t),
+     offsetof(jsd_slave_state_t, el3202), jsd_fields_el3202_state,
+     sizeof(jsd_fields_el3202_state) / sizeof(jsd_field_t)},
+    {"jsd_el3318_state_t", JSD_EL3318_PRODUCT_CODE, sizeof(jsd_el3318_state_t),
+     offsetof(jsd_slave_state_t, el3318), jsd_fields_el3318_state,
+     sizeof(jsd_fields_el3318_state) / sizeof(jsd_field_t)},
+    {"jsd_el3162_state_t", JSD_EL3162_PRODUCT_CODE, sizeof(jsd_el3162_state_t),
+     offsetof(jsd_slave_state_t, el3162), jsd_fields_el3162_state,
+     sizeof(jsd_fields_el3162_state) / sizeof(jsd_field_t)},
+    {"jsd_el4102_state_t", JSD_EL4102_PRODUCT_CODE, sizeof(jsd_el4102_state_t),
+     offsetof(jsd_slave_state_t, el4102), jsd_fields_el4102_state,
+     sizeof(jsd_fields_el4102_state) / sizeof(jsd_field_t)},
+    {"jsd_ild1900_state_t", JSD_ILD1900_PRODUCT_CODE,
+     sizeof(jsd_ild1900_state_t), offsetof(jsd_slave_state_t, ild1900),
+     jsd_fields_ild1900_state,
+     sizeof(jsd_fields_ild1900_state) / sizeof(jsd_field_t)},
+    {"jsd_epd_state_t", JSD_EPD_PRODUCT_CODE, sizeof(jsd_epd_state_t),
+     offsetof(jsd_slave_state_t, epd.pub), jsd_fields_epd_state,
+     sizeof(jsd_fields_epd_state) / sizeof(jsd_field_t)},
+};
+const size_t jsd_fields_num_state_descs =
+    sizeof(jsd_fields_state_descs) / sizeof(jsd_struct_desc_t);
+
+const jsd_struct_desc_t jsd_fields_config_descs[] = {
+    {"jsd_el3602_config_t", JSD_EL3602_PRODUCT_CODE,
+     sizeof(jsd_el3602_config_t), offsetof(jsd_slave_config_t, el3602),
+     jsd_fields_el3602_config,
+     sizeof(jsd_fields_el3602_config) / sizeof(jsd_field_t)},
+    {"jsd_el3208_config_t", JSD_EL3208_PRODUCT_CODE,
+     sizeof(jsd_el3208_config_t), offsetof(jsd_slave_config_t, el3208),
+     jsd_fields_el3208_config,
+     sizeof(jsd_fields_el3208_config) / sizeof(jsd_field_t)},
+    {"jsd_el2124_config_t", JSD_EL2124_PRODUCT_CODE,
+     sizeof(jsd_el2124_config_t), offsetof(jsd_slave_config_t, el2124), NULL,
+     0},
+    {"jsd_egd_config_t", JSD_EGD_PRODUCT_CODE, sizeof(jsd_egd_config_t),
+     offsetof(jsd_slave_config_t, egd), jsd_fields_egd_config,
+     sizeof(jsd_fields_egd_config) / sizeof(jsd_field_t)},
+    {"jsd_el3356_config_t", JSD_EL3356_PRODUCT_CODE,
+     sizeof(jsd_el3356_config_t), offsetof(jsd_slave_config_t, el3356),
+     jsd_fields_el3356_config,
+     sizeof(jsd_fields_el3356_config) / sizeof(jsd_field_t)},
+    {"jsd_jed0101_config_t", JSD_JED0101_PRODUCT_CODE,
+     sizeof(jsd_jed0101_config_t), offsetof(jsd_slave_config_t, jed0101),
+     jsd_fields_jed0101_config,
+     sizeof(jsd_fields_jed0101_config) / sizeof(jsd_field_t)},
+    {"jsd_jed0200_config_t", JSD_JED0200_PRODUCT_CODE,
+     sizeof(jsd_jed0200_config_t), offsetof(jsd_slave_config_t, jed0200),
+     jsd_fields_jed0200_config,
+     sizeof(jsd_fields_jed0200_config) / sizeof(jsd_field_t)},
+    {"jsd_ati_fts_config_t", JSD_ATI_FTS_PRODUCT_CODE,
+     sizeof(jsd_ati_fts_config_t), offsetof(jsd_slave_config_t, ati_fts),
+     jsd_fields_ati_fts_config,
+     sizeof(jsd_fields_ati_fts_config) / sizeof(jsd_field_t)},
+    {"jsd_el3104_config_t", JSD_EL3104_PRODUCT_CODE,
+     sizeof(jsd_el3104_config_t), offsetof(jsd_slave_config_t, el3104), NULL,
+     0},
+    {"jsd_el3202_config_t", JSD_EL3202_PRODUCT_CODE,
+     sizeof(jsd_el3202_config_t), offsetof(jsd_slave_config_t, el3202),
+     jsd_fields_el3202_config,
+     sizeof(jsd_fields_el3202_config) / sizeof(jsd_field_t)},
+    {"jsd_el3318_config_t", JSD_EL3318_PRODUCT_CODE,
+     sizeof(jsd_el3318_config_t), offsetof(jsd_slave_config_t, el3318),
+     jsd_fields_el3318_config,
+     sizeof(jsd_fields_el3318_config) / sizeof(jsd_field_t)},
+    {"jsd_el3162_config_t", JSD_EL3162_PRODUCT_CODE,
+     sizeof(jsd_el3162_config_t), offsetof(jsd_slave_config_t, el3162), NULL,
+     0},
+    {"jsd_el4102_config_t", JSD_EL4102_PRODUCT_CODE,
+     sizeof(jsd_el4102_config_t), offsetof(jsd_slave_config_t, el4102), NULL,
+     0},
+    {"jsd_ild1900_config_t", JSD_ILD1900_PRODUCT_CODE,
+     sizeof(jsd_ild1900_config_t), offsetof(jsd_slave_config_t, ild1900),
+     jsd_fields_ild1900_config,
+     sizeof(jsd_fields_ild1900_config) / sizeof(jsd_field_t)},
+    {"jsd_epd_config_t", JSD_EPD_PRODUCT_CODE, sizeof(jsd_epd_config_t),
+     offsetof(jsd_slave_config_t, epd), jsd_fields_epd_config,
+     sizeof(jsd_fields_epd_config) / sizeof(jsd_field_t)},
+};
+const size_t jsd_fields_num_config_descs =
+    sizeof(jsd_fields_config_descs) / sizeof(jsd_struct_desc_t);
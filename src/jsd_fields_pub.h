@@ -0,0 +1,59 @@
+#ifndef JSD_FIELDS_PUB_H
+#define JSD_FIELDS_PUB_H
+
+#include "jsd/jsd_fields_types.h"
+#include "jsd/jsd_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Gets the descriptor of the public state struct of a device
+ *
+ * The registry is generated from the device headers by
+ * tools/jsd_fields_gen.py and the build fails when it is out of date, so
+ * logging and publishing code can serialize any device state without
+ * hand-written field lists. The state of a slave starts at
+ * desc->container_offset bytes into its jsd_slave_state_t.
+ *
+ * @param product_code product code of the device
+ * @return descriptor, NULL for unsupported devices
+ */
+const jsd_struct_desc_t* jsd_fields_get_state_desc(uint32_t product_code);
+
+/**
+ * @brief Gets the descriptor of the config struct of a device
+ *
+ * The config of a slave starts at desc->container_offset bytes into its
+ * jsd_slave_config_t.
+ *
+ * @param product_code product code of the device
+ * @return descriptor, NULL for unsupported devices
+ */
+const jsd_struct_desc_t* jsd_fields_get_config_desc(uint32_t product_code);
+
+/**
+ * @brief Gets the size of a value type
+ *
+ * @param type value type
+ * @return bytes of one element
+ */
+size_t jsd_field_type_bytes(jsd_field_type_t type);
+
+/**
+ * @brief Reads an element of a field as a double
+ *
+ * @param field field descriptor
+ * @param base start of the described struct
+ * @param index array index, 0 for scalars
+ * @return value of the element
+ */
+double jsd_field_get_value(const jsd_field_t* field, const void* base,
+                           uint32_t index);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
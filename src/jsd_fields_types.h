@@ -0,0 +1,61 @@
+#ifndef JSD_FIELDS_TYPES_H
+#define JSD_FIELDS_TYPES_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Value types of the fields of device structs
+ *
+ * Enumerations are described as JSD_FIELD_I32.
+ */
+typedef enum {
+  JSD_FIELD_U8 = 0,
+  JSD_FIELD_U16,
+  JSD_FIELD_U32,
+  JSD_FIELD_U64,
+  JSD_FIELD_I8,
+  JSD_FIELD_I16,
+  JSD_FIELD_I32,
+  JSD_FIELD_I64,
+  JSD_FIELD_F32,
+  JSD_FIELD_F64,
+  JSD_FIELD_BOOL,
+  JSD_FIELD_NUM_TYPES,
+} jsd_field_type_t;
+
+/**
+ * @brief Describes a field of a device struct
+ */
+typedef struct {
+  const char*      name;
+  jsd_field_type_t type;
+  size_t           offset;  ///< from the start of the struct
+  uint32_t         count;   ///< array length, 1 for scalars
+  const char*      units;   ///< from the doc comment, "" if none
+} jsd_field_t;
+
+/**
+ * @brief Describes the public state or the config struct of a device
+ *
+ * Fields are in declaration order.
+ */
+typedef struct {
+  const char*        name;  ///< C type name, e.g. "jsd_epd_state_t"
+  uint32_t           product_code;
+  size_t             size;
+  size_t             container_offset;  ///< in jsd_slave_state_t or
+                                        ///< jsd_slave_config_t
+  const jsd_field_t* fields;
+  size_t             num_fields;
+} jsd_struct_desc_t;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
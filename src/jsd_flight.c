@@ -0,0 +1,520 @@
+#include "jsd/jsd_flight.h"
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "jsd/jsd_egd_types.h"
+#include "jsd/jsd_epd_types.h"
+#include "jsd/jsd_print.h"
+
+// The writer polls the slaves for frozen windows
+#define JSD_FLIGHT_POLL_USEC (10000)
+
+/****************************************************
+ * Recording
+ ****************************************************/
+
+static uint16_t jsd_flight_image_bytes(uint32_t bytes, uint16_t bits) {
+  // SOEM leaves the byte count of slaves with less than 8 bits at 0
+  if (bytes == 0 && bits > 0) {
+    return 1;
+  }
+  return (uint16_t)bytes;
+}
+
+static uint16_t jsd_flight_detect(jsd_t* self, uint16_t slave_id,
+                                  jsd_flight_slave_t* fs) {
+  uint16_t triggers     = 0;
+  uint8_t  machine      = fs->last_state_machine_state;
+  uint8_t  sto_engaged  = fs->last_sto_engaged;
+  uint32_t product_code = self->slave_configs[slave_id].product_code;
+
+  if (product_code == JSD_EPD_PRODUCT_CODE) {
+    const jsd_epd_state_t* state = &self->slave_states[slave_id].epd.pub;
+    machine                      = state->actual_state_machine_state;
+    sto_engaged                  = state->sto_engaged;
+  } else if (product_code == JSD_EGD_PRODUCT_CODE) {
+    const jsd_egd_state_t* state = &self->slave_states[slave_id].egd.pub;
+    machine                      = state->actual_state_machine_state;
+    sto_engaged                  = state->sto_engaged;
+  }
+
+  bool faulted = machine == JSD_ELMO_STATE_MACHINE_STATE_FAULT ||
+                 machine == JSD_ELMO_STATE_MACHINE_STATE_FAULT_REACTION_ACTIVE;
+  bool was_faulted = fs->last_state_machine_state ==
+                         JSD_ELMO_STATE_MACHINE_STATE_FAULT ||
+                     fs->last_state_machine_state ==
+                         JSD_ELMO_STATE_MACHINE_STATE_FAULT_REACTION_ACTIVE;
+  if (faulted && !was_faulted) {
+    triggers |= JSD_FLIGHT_TRIGGER_FAULT;
+  }
+  if (sto_engaged && !fs->last_sto_engaged) {
+    triggers |= JSD_FLIGHT_TRIGGER_STO;
+  }
+  fs->last_state_machine_state = machine;
+  fs->last_sto_engaged         = sto_engaged;
+
+  // Emergencies are counted by the SDO thread for every device
+  uint64_t emcy_count = __atomic_load_n(
+      &self->metrics.slaves[slave_id].emcy_count, __ATOMIC_RELAXED);
+  if (emcy_count != fs->last_emcy_count) {
+    triggers |= JSD_FLIGHT_TRIGGER_EMCY;
+    fs->last_emcy_count = emcy_count;
+  }
+
+  triggers |= __atomic_exchange_n(&fs->manual_triggers, 0, __ATOMIC_RELAXED);
+  return triggers;
+}
+
+static void jsd_flight_freeze(jsd_flight_t* flight, uint16_t slave_id,
+                              jsd_flight_slave_t* fs) {
+  if (__atomic_load_n(&fs->pending, __ATOMIC_ACQUIRE)) {
+    __atomic_fetch_add(&flight->stats.dumps_dropped, 1, __ATOMIC_RELAXED);
+    return;
+  }
+
+  uint64_t num_records =
+      fs->count < flight->capacity ? fs->count : flight->capacity;
+  uint64_t first = fs->count - num_records;
+
+  jsd_flight_header_t* dump = &fs->dump;
+  dump->slave_id            = slave_id;
+  dump->input_bytes         = fs->input_bytes;
+  dump->output_bytes        = fs->output_bytes;
+  dump->triggers            = fs->triggers;
+  dump->num_records         = (uint32_t)num_records;
+  dump->trigger_record      = (uint32_t)(fs->trigger_count - first);
+  fs->dump_first            = (uint32_t)(first % flight->capacity);
+
+  // The next window starts with an empty history
+  fs->active ^= 1;
+  fs->count = 0;
+  __atomic_store_n(&fs->pending, true, __ATOMIC_RELEASE);
+}
+
+void jsd_flight_record(jsd_t* self) {
+  assert(self);
+  jsd_flight_t* flight = &self->flight;
+  ec_slavet*    slaves = self->ecx_context.slavelist;
+
+  bool wkc_good = self->wkc == self->expected_wkc;
+  bool wkc_fell = !wkc_good && flight->last_wkc_good;
+  flight->last_wkc_good = wkc_good;
+
+  int slave_id;
+  for (slave_id = 1; slave_id <= *self->ecx_context.slavecount &&
+                     slave_id < EC_MAXSLAVE;
+       ++slave_id) {
+    jsd_flight_slave_t* fs = &flight->slaves[slave_id];
+    if (!fs->rings[0]) {
+      continue;
+    }
+
+    uint16_t triggers = jsd_flight_detect(self, slave_id, fs);
+    if (wkc_fell) {
+      triggers |= JSD_FLIGHT_TRIGGER_BAD_WKC;
+    }
+    triggers &= flight->triggers;
+
+    uint8_t* entry = fs->rings[fs->active] +
+                     (size_t)(fs->count % flight->capacity) *
+                         flight->record_bytes;
+    jsd_flight_record_t* record = (jsd_flight_record_t*)entry;
+    record->cycle               = flight->cycle;
+    record->mono_nsec           = self->cycle_time.mono_nsec;
+    record->wkc                 = self->wkc;
+    record->al_state            = slaves[slave_id].state;
+    record->triggers            = triggers;
+    memcpy(&record->state, &self->slave_states[slave_id],
+           sizeof(jsd_slave_state_t));
+    entry += sizeof(jsd_flight_record_t);
+    if (fs->input_bytes > 0) {
+      memcpy(entry, slaves[slave_id].inputs, fs->input_bytes);
+    }
+    if (fs->output_bytes > 0) {
+      memcpy(entry + fs->input_bytes, slaves[slave_id].outputs,
+             fs->output_bytes);
+    }
+    ++fs->count;
+
+    if (!fs->window_open) {
+      if (!triggers) {
+        continue;
+      }
+      fs->window_open    = true;
+      fs->post_remaining = flight->post_cycles;
+      fs->trigger_count  = fs->count - 1;
+      fs->triggers       = 0;
+      __atomic_fetch_add(&flight->stats.triggers, 1, __ATOMIC_RELAXED);
+    } else {
+      --fs->post_remaining;
+    }
+    fs->triggers |= triggers;
+
+    if (fs->post_remaining == 0) {
+      jsd_flight_freeze(flight, slave_id, fs);
+      fs->window_open = false;
+    }
+  }
+  ++flight->cycle;
+}
+
+/****************************************************
+ * Writer
+ ****************************************************/
+
+static bool jsd_flight_write_dump(jsd_flight_t* flight, jsd_flight_slave_t* fs,
+                                  const char* path) {
+  FILE* file = fopen(path, "wb");
+  if (!file) {
+    return false;
+  }
+
+  const uint8_t* ring = fs->rings[fs->active ^ 1];
+  bool ok = fwrite(&fs->dump, sizeof(fs->dump), 1, file) == 1;
+
+  // The window may wrap around the end of the ring
+  uint32_t first = fs->dump_first;
+  uint32_t head  = flight->capacity - first;
+  if (head > fs->dump.num_records) {
+    head = fs->dump.num_records;
+  }
+  uint32_t tail = fs->dump.num_records - head;
+  ok = ok && fwrite(ring + (size_t)first * flight->record_bytes,
+                    flight->record_bytes, head, file) == head;
+  ok = ok && fwrite(ring, flight->record_bytes, tail, file) == tail;
+
+  ok = fclose(file) == 0 && ok;
+  return ok;
+}
+
+static void jsd_flight_write_pending(jsd_t* self) {
+  jsd_flight_t* flight = &self->flight;
+  char          path[JSD_FLIGHT_PATH_LEN + 64];
+  int           slave_id;
+
+  for (slave_id = 1; slave_id < EC_MAXSLAVE; ++slave_id) {
+    jsd_flight_slave_t* fs = &flight->slaves[slave_id];
+    if (!__atomic_load_n(&fs->pending, __ATOMIC_ACQUIRE)) {
+      continue;
+    }
+
+    snprintf(path, sizeof(path), "%s/jsd_flight_%d_%u.bin", flight->directory,
+             slave_id, flight->dump_sequence++);
+    if (jsd_flight_write_dump(flight, fs, path)) {
+      __atomic_fetch_add(&flight->stats.dumps_written, 1, __ATOMIC_RELAXED);
+      MSG("Slave %d flight recorder dumped %u cycles to %s", slave_id,
+          fs->dump.num_records, path);
+    } else {
+      __atomic_fetch_add(&flight->stats.write_failures, 1, __ATOMIC_RELAXED);
+      ERROR("Failed to write flight recorder dump %s", path);
+    }
+    __atomic_store_n(&fs->pending, false, __ATOMIC_RELEASE);
+  }
+}
+
+static void* jsd_flight_thread_loop(void* void_data) {
+  jsd_t*        self   = (jsd_t*)void_data;
+  jsd_flight_t* flight = &self->flight;
+
+  while (!__atomic_load_n(&flight->join_flag, __ATOMIC_ACQUIRE)) {
+    jsd_flight_write_pending(self);
+    usleep(JSD_FLIGHT_POLL_USEC);
+  }
+  jsd_flight_write_pending(self);
+  return NULL;
+}
+
+/****************************************************
+ * Public functions
+ ****************************************************/
+
+static void jsd_flight_free_rings(jsd_flight_t* flight) {
+  if (flight->ring_arena.base) {
+    jsd_memory_arena_destroy(&flight->ring_arena);
+    memset(&flight->ring_arena, 0, sizeof(flight->ring_arena));
+  } else {
+    int slave_id;
+    for (slave_id = 0; slave_id < EC_MAXSLAVE; ++slave_id) {
+      free(flight->slaves[slave_id].rings[0]);
+      free(flight->slaves[slave_id].rings[1]);
+    }
+  }
+  memset(flight->slaves, 0, sizeof(flight->slaves));
+}
+
+static size_t jsd_flight_ring_bytes(const jsd_flight_t* flight) {
+  return (size_t)flight->capacity * flight->record_bytes;
+}
+
+static uint8_t* jsd_flight_alloc_ring(jsd_flight_t* flight) {
+  size_t ring_bytes = jsd_flight_ring_bytes(flight);
+  if (flight->ring_arena.base) {
+    return jsd_memory_arena_alloc(&flight->ring_arena, ring_bytes);
+  }
+  uint8_t* ring = malloc(ring_bytes);
+  if (ring) {
+    // Touch every page now rather than in the cyclic loop
+    memset(ring, 0, ring_bytes);
+  }
+  return ring;
+}
+
+static bool jsd_flight_setup_slave(jsd_t* self, uint16_t slave_id) {
+  jsd_flight_t*       flight = &self->flight;
+  jsd_flight_slave_t* fs     = &flight->slaves[slave_id];
+  ec_slavet*          slave  = &self->ecx_context.slavelist[slave_id];
+
+  fs->input_bytes  = jsd_flight_image_bytes(slave->Ibytes, slave->Ibits);
+  fs->output_bytes = jsd_flight_image_bytes(slave->Obytes, slave->Obits);
+  if (fs->input_bytes > 0 && !slave->inputs) {
+    fs->input_bytes = 0;
+  }
+  if (fs->output_bytes > 0 && !slave->outputs) {
+    fs->output_bytes = 0;
+  }
+
+  int i;
+  for (i = 0; i < 2; ++i) {
+    fs->rings[i] = jsd_flight_alloc_ring(flight);
+    if (!fs->rings[i]) {
+      return false;
+    }
+  }
+
+  jsd_flight_header_t* dump = &fs->dump;
+  dump->magic               = JSD_FLIGHT_MAGIC;
+  dump->version             = JSD_FLIGHT_VERSION;
+  dump->record_bytes        = flight->record_bytes;
+  dump->state_bytes         = sizeof(jsd_slave_state_t);
+  dump->product_code        = self->slave_configs[slave_id].product_code;
+
+  // Conditions already present at start do not trigger
+  jsd_flight_detect(self, slave_id, fs);
+  return true;
+}
+
+bool jsd_flight_start(jsd_t* self, const char* directory,
+                      jsd_flight_config_t config) {
+  assert(self);
+  assert(directory);
+  jsd_flight_t* flight = &self->flight;
+
+  if (flight->running) {
+    WARNING("Flight recorder is already running");
+    return false;
+  }
+  if (strlen(directory) >= sizeof(flight->directory)) {
+    ERROR("Flight recorder directory is too long: %s", directory);
+    return false;
+  }
+  if (access(directory, W_OK) != 0) {
+    ERROR("Flight recorder directory %s is not writable", directory);
+    return false;
+  }
+
+  // The largest image of any slave sets the stride, aligned for the header
+  uint32_t max_image_bytes = 0;
+  int      slave_id;
+  for (slave_id = 1; slave_id <= *self->ecx_context.slavecount &&
+                     slave_id < EC_MAXSLAVE;
+       ++slave_id) {
+    ec_slavet* slave = &self->ecx_context.slavelist[slave_id];
+    uint32_t   bytes = jsd_flight_image_bytes(slave->Ibytes, slave->Ibits) +
+                     jsd_flight_image_bytes(slave->Obytes, slave->Obits);
+    if (bytes > max_image_bytes) {
+      max_image_bytes = bytes;
+    }
+  }
+
+  memset(flight->slaves, 0, sizeof(flight->slaves));
+  snprintf(flight->directory, sizeof(flight->directory), "%s", directory);
+  flight->capacity     = config.pre_cycles + config.post_cycles + 1;
+  flight->record_bytes = (sizeof(jsd_flight_record_t) + max_image_bytes + 7) &
+                         ~(uint32_t)7;
+  flight->post_cycles = config.post_cycles;
+  flight->triggers =
+      config.triggers ? config.triggers & JSD_FLIGHT_TRIGGER_ALL
+                      : JSD_FLIGHT_TRIGGER_ALL;
+  flight->cycle         = 0;
+  flight->last_wkc_good = true;
+  flight->dump_sequence = 0;
+  flight->join_flag     = false;
+  memset(&flight->stats, 0, sizeof(flight->stats));
+
+  // The caller of a real-time context may not use the heap after jsd_init,
+  // the rings of every slave that may be recorded come from a locked mapping
+  if (self->arena.base) {
+    uint16_t max_slaves = 0;
+    if (config.slave_ids && config.num_slave_ids > 0) {
+      max_slaves = config.num_slave_ids;
+    } else {
+      for (slave_id = 1; slave_id <= *self->ecx_context.slavecount &&
+                         slave_id < EC_MAXSLAVE;
+           ++slave_id) {
+        max_slaves += self->slave_configs[slave_id].configuration_active;
+      }
+    }
+    size_t arena_bytes = (size_t)2 * max_slaves *
+                         jsd_memory_arena_align(jsd_flight_ring_bytes(flight));
+    if (arena_bytes > 0 &&
+        !jsd_memory_arena_create(&flight->ring_arena, arena_bytes, false)) {
+      ERROR("Failed to map the flight recorder rings");
+      return false;
+    }
+  }
+
+  uint16_t num_slaves = 0;
+  uint16_t i;
+  if (config.slave_ids && config.num_slave_ids > 0) {
+    for (i = 0; i < config.num_slave_ids; ++i) {
+      if (config.slave_ids[i] == 0 ||
+          config.slave_ids[i] > *self->ecx_context.slavecount ||
+          config.slave_ids[i] >= EC_MAXSLAVE) {
+        ERROR("Invalid slave %u for the flight recorder", config.slave_ids[i]);
+        jsd_flight_free_rings(flight);
+        return false;
+      }
+      if (flight->slaves[config.slave_ids[i]].rings[0]) {
+        continue;
+      }
+      if (!jsd_flight_setup_slave(self, config.slave_ids[i])) {
+        ERROR("Failed to allocate the flight recorder rings");
+        jsd_flight_free_rings(flight);
+        return false;
+      }
+      ++num_slaves;
+    }
+  } else {
+    for (slave_id = 1; slave_id <= *self->ecx_context.slavecount &&
+                       slave_id < EC_MAXSLAVE;
+         ++slave_id) {
+      if (!self->slave_configs[slave_id].configuration_active) {
+        continue;
+      }
+      if (!jsd_flight_setup_slave(self, slave_id)) {
+        ERROR("Failed to allocate the flight recorder rings");
+        jsd_flight_free_rings(flight);
+        return false;
+      }
+      ++num_slaves;
+    }
+  }
+
+  if (0 != jsd_memory_thread_create(&flight->thread, self->arena.base != NULL,
+                                    jsd_flight_thread_loop, (void*)self)) {
+    ERROR("Failed to create flight recorder writer thread");
+    jsd_flight_free_rings(flight);
+    return false;
+  }
+  flight->running = true;
+
+  MSG("Flight recorder keeping %u cycles of %u slaves, %zu bytes",
+      flight->capacity, num_slaves,
+      (size_t)2 * num_slaves * flight->capacity * flight->record_bytes);
+  return true;
+}
+
+void jsd_flight_stop(jsd_t* self) {
+  assert(self);
+  jsd_flight_t* flight = &self->flight;
+  if (!flight->running) {
+    return;
+  }
+
+  // Stops the cyclic recording before the writer drains the pending dumps
+  flight->running = false;
+  __atomic_store_n(&flight->join_flag, true, __ATOMIC_RELEASE);
+  pthread_join(flight->thread, NULL);
+  jsd_flight_free_rings(flight);
+}
+
+void jsd_flight_trigger(jsd_t* self, uint16_t slave_id) {
+  assert(self);
+  assert(slave_id < EC_MAXSLAVE);
+  __atomic_fetch_or(&self->flight.slaves[slave_id].manual_triggers,
+                    JSD_FLIGHT_TRIGGER_MANUAL, __ATOMIC_RELAXED);
+}
+
+jsd_flight_stats_t jsd_flight_get_stats(jsd_t* self) {
+  assert(self);
+  const jsd_flight_stats_t* source = &self->flight.stats;
+  jsd_flight_stats_t        stats;
+
+  stats.triggers = __atomic_load_n(&source->triggers, __ATOMIC_RELAXED);
+  stats.dumps_written =
+      __atomic_load_n(&source->dumps_written, __ATOMIC_RELAXED);
+  stats.dumps_dropped =
+      __atomic_load_n(&source->dumps_dropped, __ATOMIC_RELAXED);
+  stats.write_failures =
+      __atomic_load_n(&source->write_failures, __ATOMIC_RELAXED);
+  return stats;
+}
+
+/****************************************************
+ * Dump files
+ ****************************************************/
+
+bool jsd_flight_load_dump(const char* path, jsd_flight_dump_t* dump) {
+  assert(path);
+  assert(dump);
+  memset(dump, 0, sizeof(*dump));
+
+  FILE* file = fopen(path, "rb");
+  if (!file) {
+    ERROR("Failed to open flight recorder dump %s", path);
+    return false;
+  }
+
+  jsd_flight_header_t* header = &dump->header;
+  if (fread(header, sizeof(*header), 1, file) != 1 ||
+      header->magic != JSD_FLIGHT_MAGIC ||
+      header->version != JSD_FLIGHT_VERSION ||
+      header->state_bytes != sizeof(jsd_slave_state_t) ||
+      header->record_bytes < sizeof(jsd_flight_record_t) +
+                                 header->input_bytes + header->output_bytes ||
+      header->trigger_record >= header->num_records) {
+    ERROR("%s is not a flight recorder dump of this JSD build", path);
+    fclose(file);
+    return false;
+  }
+
+  size_t bytes  = (size_t)header->num_records * header->record_bytes;
+  dump->records = malloc(bytes);
+  if (!dump->records || fread(dump->records, 1, bytes, file) != bytes) {
+    ERROR("Flight recorder dump %s is truncated", path);
+    fclose(file);
+    jsd_flight_free_dump(dump);
+    return false;
+  }
+  fclose(file);
+  return true;
+}
+
+void jsd_flight_free_dump(jsd_flight_dump_t* dump) {
+  assert(dump);
+  free(dump->records);
+  dump->records = NULL;
+}
+
+const jsd_flight_record_t* jsd_flight_dump_get_record(
+    const jsd_flight_dump_t* dump, uint32_t index) {
+  assert(dump);
+  assert(index < dump->header.num_records);
+  return (const jsd_flight_record_t*)(dump->records +
+                                      (size_t)index *
+                                          dump->header.record_bytes);
+}
+
+const uint8_t* jsd_flight_dump_get_inputs(const jsd_flight_dump_t* dump,
+                                          uint32_t                 index) {
+  return (const uint8_t*)jsd_flight_dump_get_record(dump, index) +
+         sizeof(jsd_flight_record_t);
+}
+
+const uint8_t* jsd_flight_dump_get_outputs(const jsd_flight_dump_t* dump,
+                                           uint32_t                 index) {
+  return jsd_flight_dump_get_inputs(dump, index) + dump->header.input_bytes;
+}
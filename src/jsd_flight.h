@@ -0,0 +1,22 @@
+#ifndef JSD_FLIGHT_H
+#define JSD_FLIGHT_H
+
+#include "jsd/jsd_flight_pub.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Appends the current cycle to the slave histories and evaluates the
+ * triggers, called by jsd_write(...)
+ *
+ * @param self pointer to JSD context with a running flight recorder
+ */
+void jsd_flight_record(jsd_t* self);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
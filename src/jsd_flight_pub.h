@@ -0,0 +1,113 @@
+#ifndef JSD_FLIGHT_PUB_H
+#define JSD_FLIGHT_PUB_H
+
+#include "jsd/jsd_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Starts keeping a history of the last cycles of each slave
+ *
+ * Every jsd_write(...) appends the TxPDO and RxPDO images, the working
+ * counter, the AL state and the decoded device state of each recorded slave
+ * to a preallocated ring. When a trigger fires for a slave, e.g. its drive
+ * enters FAULT, config.post_cycles more cycles are recorded and the window,
+ * up to config.pre_cycles before the triggering cycle, is handed to a
+ * background thread that writes it to
+ * <directory>/jsd_flight_<slave_id>_<sequence>.bin. The cyclic loop never
+ * allocates nor touches a file; a trigger firing while the previous dump of
+ * the slave is still being written is counted as dropped.
+ *
+ * Must be called after jsd_init(...), stopped by jsd_flight_stop(...) or
+ * jsd_free(...).
+ *
+ * @param self pointer to JSD context
+ * @param directory existing directory receiving the dumps
+ * @param config window sizes, triggers and slaves
+ * @return true if recording started
+ */
+bool jsd_flight_start(jsd_t* self, const char* directory,
+                      jsd_flight_config_t config);
+
+/**
+ * @brief Writes the pending dumps, stops recording and frees the rings
+ *
+ * Windows still recording their post cycles are discarded.
+ *
+ * @param self pointer to JSD context
+ */
+void jsd_flight_stop(jsd_t* self);
+
+/**
+ * @brief Raises JSD_FLIGHT_TRIGGER_MANUAL for a slave, from any thread
+ *
+ * The trigger applies to the next jsd_write(...).
+ *
+ * @param self pointer to JSD context
+ * @param slave_id index of a recorded slave
+ */
+void jsd_flight_trigger(jsd_t* self, uint16_t slave_id);
+
+/**
+ * @brief Gets the flight recorder statistics
+ *
+ * @param self pointer to JSD context
+ * @return statistics since jsd_flight_start(...)
+ */
+jsd_flight_stats_t jsd_flight_get_stats(jsd_t* self);
+
+/**
+ * @brief Loads a dump file
+ *
+ * @param path dump file of the same JSD build
+ * @param dump filled with the header and records, freed by
+ *        jsd_flight_free_dump(...)
+ * @return true if the whole file was loaded
+ */
+bool jsd_flight_load_dump(const char* path, jsd_flight_dump_t* dump);
+
+/**
+ * @brief Frees the records of a loaded dump
+ *
+ * @param dump dump loaded by jsd_flight_load_dump(...)
+ */
+void jsd_flight_free_dump(jsd_flight_dump_t* dump);
+
+/**
+ * @brief Gets a record of a loaded dump
+ *
+ * @param dump loaded dump
+ * @param index record index, header.trigger_record is the triggering cycle
+ * @return record, its images follow at jsd_flight_dump_get_inputs(...) and
+ *         jsd_flight_dump_get_outputs(...)
+ */
+const jsd_flight_record_t* jsd_flight_dump_get_record(
+    const jsd_flight_dump_t* dump, uint32_t index);
+
+/**
+ * @brief Gets the TxPDO image of a record
+ *
+ * @param dump loaded dump
+ * @param index record index
+ * @return header.input_bytes bytes
+ */
+const uint8_t* jsd_flight_dump_get_inputs(const jsd_flight_dump_t* dump,
+                                          uint32_t                 index);
+
+/**
+ * @brief Gets the RxPDO image of a record
+ *
+ * @param dump loaded dump
+ * @param index record index
+ * @return header.output_bytes bytes
+ */
+const uint8_t* jsd_flight_dump_get_outputs(const jsd_flight_dump_t* dump,
+                                           uint32_t                 index);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,697 @@
+#include "jsd/jsd_hotplug.h"
+
+#include <assert.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "jsd/jsd.h"
+#include "jsd/jsd_error_cirq.h"
+#include "jsd/jsd_memory.h"
+#include "jsd/jsd_print.h"
+#include "jsd/jsd_time.h"
+
+// The thread checks its join flag at this period while waiting
+#define JSD_HOTPLUG_SLEEP_USEC (10000)
+
+// SyncManager control byte, operation mode and direction
+#define JSD_HOTPLUG_SM_MODE_MAILBOX (0x02)
+#define JSD_HOTPLUG_SM_DIR_WRITE (0x01)
+#define JSD_HOTPLUG_SM_ENABLE (0x00010000)
+
+// SyncManager types of SOEM, mailbox out, mailbox in, outputs, inputs
+#define JSD_HOTPLUG_SM_TYPE_MBX_OUT (1)
+#define JSD_HOTPLUG_SM_TYPE_MBX_IN (2)
+#define JSD_HOTPLUG_SM_TYPE_OUTPUTS (3)
+#define JSD_HOTPLUG_SM_TYPE_INPUTS (4)
+
+#define JSD_HOTPLUG_FMMU_TYPE_INPUTS (1)
+#define JSD_HOTPLUG_FMMU_TYPE_OUTPUTS (2)
+
+// SII word offsets in the general category
+#define JSD_HOTPLUG_SII_GENERAL_NAME (0x03)
+#define JSD_HOTPLUG_SII_GENERAL_COE (0x07)
+
+static const char* jsd_hotplug_event_names[JSD_NUM_HOTPLUG_EVENTS] = {
+    "added",   "operational", "not configured", "failed",
+    "removed", "mismatch",    "inserted",
+};
+
+/****************************************************
+ * Process image
+ ****************************************************/
+
+bool jsd_hotplug_reserve_image(jsd_t* self) {
+  assert(self);
+  ec_slavet* slaves  = self->ecx_context.slavelist;
+  ec_groupt* group   = &self->ecx_context.grouplist[0];
+  uint8_t*   iomap   = (uint8_t*)self->IOmap;
+  uint32_t   reserve = self->hotplug.reserved_obytes;
+  uint32_t   mapped  = group->Obytes > group->Ibytes ? group->Obytes
+                                                     : group->Ibytes;
+  uint32_t   new_o   = mapped + reserve;
+  uint32_t   shift   = new_o - group->Obytes;
+  uint16_t   id;
+
+  self->hotplug.mapped_bytes = mapped;
+  if (reserve == 0) {
+    return true;
+  }
+  // The headroom goes into the first and only frame, like later slaves
+  if (group->nsegments > 1 || new_o > EC_MAXLRWDATA) {
+    ERROR("Reserving %u output bytes exceeds one frame", reserve);
+    return false;
+  }
+  // The received frame is copied to the inputs, outputs included
+  if (2 * new_o > sizeof(self->IOmap)) {
+    ERROR("IO Map is not large enough to reserve %u output bytes", reserve);
+    return false;
+  }
+
+  memmove(iomap + new_o, group->inputs, group->Ibytes);
+  memset(iomap + group->Obytes, 0, shift);
+  for (id = 1; id <= *self->ecx_context.slavecount; ++id) {
+    if (slaves[id].Ibits > 0) {
+      slaves[id].inputs += shift;
+    }
+  }
+  group->outputs      = iomap;
+  group->Obytes       = new_o;
+  group->inputs       = iomap + new_o;
+  group->IOsegment[0] = new_o;
+  slaves[0].outputs   = group->outputs;
+  slaves[0].Obytes    = new_o;
+  slaves[0].inputs    = group->inputs;
+  return true;
+}
+
+bool jsd_hotplug_extend_image(jsd_t* self, uint16_t slave_id, uint32_t obytes,
+                              uint32_t ibytes) {
+  assert(self);
+  assert(slave_id < EC_MAXSLAVE);
+  jsd_hotplug_t* hotplug = &self->hotplug;
+  ec_slavet*     slaves  = self->ecx_context.slavelist;
+  ec_groupt*     group   = &self->ecx_context.grouplist[0];
+  uint8_t*       iomap   = (uint8_t*)self->IOmap;
+  uint32_t       start   = hotplug->mapped_bytes;
+  uint32_t       new_i   = start + ibytes > group->Ibytes ? start + ibytes
+                                                          : group->Ibytes;
+  uint32_t       length  = group->Obytes > new_i ? group->Obytes : new_i;
+
+  // Existing slaves keep their offsets, the outputs must fit the headroom
+  if (obytes > 0 && start + obytes > group->Obytes) {
+    ERROR("Outputs of slave[%u] need %u bytes, %u are reserved", slave_id,
+          obytes, group->Obytes > start ? group->Obytes - start : 0);
+    return false;
+  }
+  // Splitting the image into more frames would move every slave
+  if (group->nsegments > 1 || length > EC_MAXLRWDATA) {
+    ERROR("Process image of %u bytes does not fit one frame", length);
+    return false;
+  }
+  // The received frame is copied to the inputs, outputs included
+  if (group->Obytes + length > sizeof(self->IOmap)) {
+    ERROR("IO Map is not large enough for slave[%u]", slave_id);
+    return false;
+  }
+
+  memset(iomap + start, 0, obytes);
+  memset(group->inputs + start, 0, ibytes);
+  slaves[slave_id].Obytes  = obytes;
+  slaves[slave_id].Ibytes  = ibytes;
+  slaves[slave_id].outputs = obytes > 0 ? iomap + start : NULL;
+  slaves[slave_id].inputs  = ibytes > 0 ? group->inputs + start : NULL;
+
+  hotplug->mapped_bytes = start + (obytes > ibytes ? obytes : ibytes);
+  group->Ibytes         = new_i;
+  group->nsegments      = 1;
+  group->IOsegment[0]   = length;
+  slaves[0].Ibytes      = new_i;
+
+  if (obytes > 0) {
+    ++group->outputsWKC;
+  }
+  if (ibytes > 0) {
+    ++group->inputsWKC;
+  }
+  self->expected_wkc = group->outputsWKC * 2 + group->inputsWKC;
+  __atomic_store_n(self->ecx_context.slavecount, slave_id, __ATOMIC_RELEASE);
+  return true;
+}
+
+void jsd_hotplug_apply(jsd_t* self) {
+  assert(self);
+  jsd_hotplug_t* hotplug = &self->hotplug;
+
+  // The watchdog may send the image while the loop stalls
+  bool watchdog_running = self->watchdog.running;
+  if (watchdog_running) {
+    pthread_mutex_lock(&self->watchdog.frame_mutex);
+  }
+  hotplug->pending_applied = jsd_hotplug_extend_image(
+      self, hotplug->pending_slave_id, hotplug->pending_obytes,
+      hotplug->pending_ibytes);
+  if (watchdog_running) {
+    pthread_mutex_unlock(&self->watchdog.frame_mutex);
+  }
+  __atomic_store_n(&hotplug->pending, false, __ATOMIC_RELEASE);
+}
+
+/****************************************************
+ * Events
+ ****************************************************/
+
+static void jsd_hotplug_report(jsd_t* self, jsd_hotplug_event_t event) {
+  jsd_hotplug_t* hotplug = &self->hotplug;
+  const char*    name    = jsd_hotplug_event_type_to_string(event.type);
+
+  event.mono_nsec = jsd_time_get_mono_time_nsec();
+  pthread_mutex_lock(&hotplug->report_mutex);
+  ++hotplug->stats.events[event.type];
+  hotplug->has_event  = true;
+  hotplug->last_event = event;
+  pthread_mutex_unlock(&hotplug->report_mutex);
+
+  switch (event.type) {
+    case JSD_HOTPLUG_EVENT_ADDED:
+      MSG("Hot-plug: slave[%u] %s, vendor 0x%08X product 0x%08X",
+          event.slave_id, name, event.eep_man, event.eep_id);
+      break;
+    case JSD_HOTPLUG_EVENT_OPERATIONAL:
+      SUCCESS("Hot-plug: slave[%u] %s after %.1f ms", event.slave_id, name,
+              (double)event.duration_nsec / 1e6);
+      break;
+    case JSD_HOTPLUG_EVENT_REMOVED:
+      WARNING("Hot-plug: %u slaves answer, %d configured", event.num_slaves,
+              *self->ecx_context.slavecount);
+      break;
+    default:
+      WARNING("Hot-plug: slave[%u] %s, vendor 0x%08X product 0x%08X",
+              event.slave_id, name, event.eep_man, event.eep_id);
+      break;
+  }
+}
+
+/****************************************************
+ * Configuration of a new slave
+ ****************************************************/
+
+// ecx_statecheck(...) ignores slaves past slavecount, the new one included
+static bool jsd_hotplug_request_state(jsd_t* self, uint16_t slave_id,
+                                      uint16_t state) {
+  ecx_contextt* context = &self->ecx_context;
+  ec_slavet*    slave   = &context->slavelist[slave_id];
+  int64_t       timeout = jsd_time_get_mono_time_nsec() +
+                    (int64_t)EC_TIMEOUTSTATE * JSD_TIME_NSEC_PER_USEC;
+
+  slave->state = state;
+  ecx_writestate(context, slave_id);
+  do {
+    slave->state = etohs(ecx_FPRDw(context->port, slave->configadr,
+                                   ECT_REG_ALSTAT, EC_TIMEOUTRET));
+    if ((slave->state & 0x0F) == state) {
+      return true;
+    }
+    usleep(1000);
+  } while (jsd_time_get_mono_time_nsec() < timeout);
+  slave->ALstatuscode = etohs(ecx_FPRDw(context->port, slave->configadr,
+                                        ECT_REG_ALSTATCODE, EC_TIMEOUTRET));
+  return false;
+}
+
+static void jsd_hotplug_set_sm(ec_slavet* slave, uint8_t sm,
+                               const ec_eepromSMt* eep_sm) {
+  uint8_t mode      = eep_sm->Creg & 0x03;
+  uint8_t direction = (eep_sm->Creg >> 2) & 0x03;
+
+  slave->SM[sm].StartAddr = htoes(eep_sm->PhStart);
+  slave->SM[sm].SMlength  = htoes(eep_sm->Plength);
+  slave->SM[sm].SMflags   = htoel(eep_sm->Creg + (eep_sm->Activate << 16));
+  if (mode == JSD_HOTPLUG_SM_MODE_MAILBOX) {
+    slave->SMtype[sm] = direction == JSD_HOTPLUG_SM_DIR_WRITE
+                            ? JSD_HOTPLUG_SM_TYPE_MBX_OUT
+                            : JSD_HOTPLUG_SM_TYPE_MBX_IN;
+  } else {
+    slave->SMtype[sm] = direction == JSD_HOTPLUG_SM_DIR_WRITE
+                            ? JSD_HOTPLUG_SM_TYPE_OUTPUTS
+                            : JSD_HOTPLUG_SM_TYPE_INPUTS;
+  }
+}
+
+// Identity, mailbox and SyncManagers from the SII, like ecx_config_init(...)
+static void jsd_hotplug_read_sii(jsd_t* self, uint16_t slave_id) {
+  ecx_contextt* context = &self->ecx_context;
+  ec_slavet*    slave   = &context->slavelist[slave_id];
+  uint16_t      adr     = slave->configadr;
+  uint8_t       sm;
+
+  ecx_eeprom2master(context, slave_id);
+  slave->eep_man =
+      (uint32)ecx_readeepromFP(context, adr, ECT_SII_MANUF, EC_TIMEOUTEEP);
+  slave->eep_id =
+      (uint32)ecx_readeepromFP(context, adr, ECT_SII_ID, EC_TIMEOUTEEP);
+  slave->eep_rev =
+      (uint32)ecx_readeepromFP(context, adr, ECT_SII_REV, EC_TIMEOUTEEP);
+  uint32 rx_mbx =
+      (uint32)ecx_readeepromFP(context, adr, ECT_SII_RXMBXADR, EC_TIMEOUTEEP);
+  uint32 tx_mbx =
+      (uint32)ecx_readeepromFP(context, adr, ECT_SII_TXMBXADR, EC_TIMEOUTEEP);
+  slave->mbx_wo = LO_WORD(etohl(rx_mbx));
+  slave->mbx_l  = HI_WORD(etohl(rx_mbx));
+  slave->mbx_ro = LO_WORD(etohl(tx_mbx));
+  slave->mbx_rl = HI_WORD(etohl(tx_mbx));
+  if (slave->mbx_l > 0) {
+    slave->mbx_proto = LO_WORD(etohl((uint32)ecx_readeepromFP(
+        context, adr, ECT_SII_MBXPROTO, EC_TIMEOUTEEP)));
+  }
+
+  int16 general = ecx_siifind(context, slave_id, ECT_SII_GENERAL);
+  if (general > 0) {
+    slave->CoEdetails = ecx_siigetbyte(context, slave_id,
+                                       general + JSD_HOTPLUG_SII_GENERAL_COE);
+    ecx_siistring(context, slave->name, slave_id,
+                  ecx_siigetbyte(context, slave_id,
+                                 general + JSD_HOTPLUG_SII_GENERAL_NAME));
+  }
+
+  if (ecx_siiSM(context, slave_id, context->eepSM)) {
+    jsd_hotplug_set_sm(slave, 0, context->eepSM);
+    for (sm = 1; sm < EC_MAXSM &&
+                 ecx_siiSMnext(context, slave_id, context->eepSM, sm);
+         ++sm) {
+      jsd_hotplug_set_sm(slave, sm, context->eepSM);
+    }
+  }
+  // The mailbox words take precedence over the SyncManager category
+  if (slave->mbx_l > 0) {
+    slave->SM[0].StartAddr = htoes(slave->mbx_wo);
+    slave->SM[0].SMlength  = htoes(slave->mbx_l);
+    slave->SM[0].SMflags   = htoel(0x00010026);
+    slave->SMtype[0]       = JSD_HOTPLUG_SM_TYPE_MBX_OUT;
+    slave->SM[1].StartAddr = htoes(slave->mbx_ro);
+    slave->SM[1].SMlength  = htoes(slave->mbx_rl);
+    slave->SM[1].SMflags   = htoel(0x00010022);
+    slave->SMtype[1]       = JSD_HOTPLUG_SM_TYPE_MBX_IN;
+  }
+}
+
+// Process data sizes in bits from the CoE PDO assignment or the SII
+static void jsd_hotplug_read_pdo_bits(jsd_t* self, uint16_t slave_id,
+                                      uint32* obits, uint32* ibits) {
+  ecx_contextt* context = &self->ecx_context;
+  ec_slavet*    slave   = &context->slavelist[slave_id];
+  ec_eepromPDOt eep_pdo;
+
+  *obits = 0;
+  *ibits = 0;
+  if (slave->mbx_proto & ECT_MBXPROT_COE) {
+    ecx_readPDOmap(context, slave_id, obits, ibits);
+  }
+  if (*obits == 0 && *ibits == 0) {
+    *obits = ecx_siiPDO(context, slave_id, &eep_pdo, 1);
+    *ibits = ecx_siiPDO(context, slave_id, &eep_pdo, 0);
+  }
+}
+
+// Maps the process data after the current image, byte aligned, the outputs
+// and inputs of the slave overlap like in ecx_config_overlap_map_group(...)
+static bool jsd_hotplug_map(jsd_t* self, uint16_t slave_id, uint32_t obytes,
+                            uint32_t ibytes) {
+  ecx_contextt*    context = &self->ecx_context;
+  ec_slavet*       slave   = &context->slavelist[slave_id];
+  const ec_groupt* group   = &context->grouplist[0];
+  uint32_t         mapped  = self->hotplug.mapped_bytes;
+  uint8_t          fmmu    = 0;
+  uint8_t          sm;
+
+  // Slaves without mailbox exchange process data through SM0 and SM1
+  for (sm = 0; sm < EC_MAXSM; ++sm) {
+    uint32_t bytes = 0;
+    if (slave->SMtype[sm] == JSD_HOTPLUG_SM_TYPE_OUTPUTS) {
+      bytes = obytes;
+    } else if (slave->SMtype[sm] == JSD_HOTPLUG_SM_TYPE_INPUTS) {
+      bytes = ibytes;
+    } else {
+      continue;
+    }
+    slave->SM[sm].SMlength = htoes(bytes);
+    if (bytes == 0) {
+      slave->SM[sm].SMflags &= htoel(~JSD_HOTPLUG_SM_ENABLE);
+    }
+    if (ecx_FPWR(context->port, slave->configadr, ECT_REG_SM0 + 8 * sm,
+                 sizeof(ec_smt), &slave->SM[sm], EC_TIMEOUTRET3) <= 0) {
+      return false;
+    }
+    if (bytes == 0) {
+      continue;
+    }
+
+    bool outputs = slave->SMtype[sm] == JSD_HOTPLUG_SM_TYPE_OUTPUTS;
+    ec_fmmut* entry    = &slave->FMMU[fmmu];
+    entry->LogStart    = htoel(group->logstartaddr + mapped);
+    entry->LogLength   = htoes(bytes);
+    entry->LogStartbit = 0;
+    entry->LogEndbit   = 7;
+    entry->PhysStart   = slave->SM[sm].StartAddr;
+    entry->PhysStartBit = 0;
+    entry->FMMUtype     = outputs ? JSD_HOTPLUG_FMMU_TYPE_OUTPUTS
+                                  : JSD_HOTPLUG_FMMU_TYPE_INPUTS;
+    entry->FMMUactive = 1;
+    if (ecx_FPWR(context->port, slave->configadr, ECT_REG_FMMU0 + 16 * fmmu,
+                 sizeof(ec_fmmut), entry, EC_TIMEOUTRET3) <= 0) {
+      return false;
+    }
+    if (++fmmu == EC_MAXFMMU) {
+      break;
+    }
+  }
+  slave->FMMUunused = fmmu;
+  return true;
+}
+
+static bool jsd_hotplug_wait_apply(jsd_t* self) {
+  jsd_hotplug_t* hotplug = &self->hotplug;
+  while (__atomic_load_n(&hotplug->pending, __ATOMIC_ACQUIRE)) {
+    if (__atomic_load_n(&hotplug->join_flag, __ATOMIC_ACQUIRE)) {
+      return false;
+    }
+    usleep(1000);
+  }
+  return hotplug->pending_applied;
+}
+
+static jsd_hotplug_event_type_t jsd_hotplug_configure(jsd_t*   self,
+                                                      uint16_t slave_id) {
+  ecx_contextt*       context = &self->ecx_context;
+  ec_slavet*          slave   = &context->slavelist[slave_id];
+  jsd_slave_config_t* config  = &self->slave_configs[slave_id];
+  jsd_hotplug_t*      hotplug = &self->hotplug;
+  uint32              obits, ibits;
+
+  if (!jsd_hotplug_request_state(self, slave_id, EC_STATE_INIT)) {
+    return JSD_HOTPLUG_EVENT_FAILED;
+  }
+  if (slave->mbx_l > 0 &&
+      ecx_FPWR(context->port, slave->configadr, ECT_REG_SM0,
+               2 * sizeof(ec_smt), &slave->SM[0], EC_TIMEOUTRET3) <= 0) {
+    return JSD_HOTPLUG_EVENT_FAILED;
+  }
+  if (!jsd_hotplug_request_state(self, slave_id, EC_STATE_PRE_OP)) {
+    return JSD_HOTPLUG_EVENT_FAILED;
+  }
+
+  if (!config->configuration_active || config->product_code != slave->eep_id) {
+    return JSD_HOTPLUG_EVENT_NOT_CONFIGURED;
+  }
+  if (!jsd_init_single_device(self, slave_id)) {
+    return JSD_HOTPLUG_EVENT_FAILED;
+  }
+  if (slave->PO2SOconfigx) {
+    slave->PO2SOconfigx(context, slave_id);
+  } else if (slave->PO2SOconfig) {
+    slave->PO2SOconfig(slave_id);
+  }
+  if (!config->PO2SO_success) {
+    return JSD_HOTPLUG_EVENT_FAILED;
+  }
+
+  jsd_hotplug_read_pdo_bits(self, slave_id, &obits, &ibits);
+  slave->Obits = obits;
+  slave->Ibits = ibits;
+  if (!jsd_hotplug_map(self, slave_id, (obits + 7) / 8, (ibits + 7) / 8) ||
+      !jsd_hotplug_request_state(self, slave_id, EC_STATE_SAFE_OP)) {
+    return JSD_HOTPLUG_EVENT_FAILED;
+  }
+
+  // SAFE-OP already returns inputs, the loop expects them from now on
+  char qname[JSD_NAME_LEN];
+  snprintf(qname, JSD_NAME_LEN, "Slave %d error cirq", slave_id);
+  jsd_error_cirq_init(&self->slave_errors[slave_id], qname);
+  hotplug->pending_slave_id = slave_id;
+  hotplug->pending_obytes   = (obits + 7) / 8;
+  hotplug->pending_ibytes   = (ibits + 7) / 8;
+  hotplug->pending_applied  = false;
+  __atomic_store_n(&hotplug->pending, true, __ATOMIC_RELEASE);
+  if (!jsd_hotplug_wait_apply(self)) {
+    return JSD_HOTPLUG_EVENT_FAILED;
+  }
+
+  // OP needs the outputs of the cyclic frame
+  if (!jsd_hotplug_request_state(self, slave_id, EC_STATE_OPERATIONAL)) {
+    return JSD_HOTPLUG_EVENT_FAILED;
+  }
+  return JSD_HOTPLUG_EVENT_OPERATIONAL;
+}
+
+static void jsd_hotplug_add(jsd_t* self, uint16_t slave_id,
+                            uint16_t num_slaves) {
+  ecx_contextt*       context   = &self->ecx_context;
+  ec_slavet*          slave     = &context->slavelist[slave_id];
+  uint16_t            configadr = EC_NODEOFFSET + slave_id;
+  int64_t             start     = jsd_time_get_mono_time_nsec();
+  jsd_hotplug_event_t event;
+
+  memset(slave, 0, sizeof(*slave));
+  memset(&event, 0, sizeof(event));
+  event.slave_id   = slave_id;
+  event.num_slaves = num_slaves;
+
+  // The SII buffer, SM and PDO assignment scratch and mailbox counters of the
+  // context are shared with the cyclic, SDO and diagnostic threads
+  pthread_mutex_lock(&self->hotplug.config_mutex);
+
+  // The new slave is last, so its position is its slave_id
+  if (ecx_APWRw(context->port, (uint16)(1 - slave_id), ECT_REG_STADR,
+                htoes(configadr), EC_TIMEOUTRET3) <= 0) {
+    pthread_mutex_unlock(&self->hotplug.config_mutex);
+    event.type = JSD_HOTPLUG_EVENT_FAILED;
+    jsd_hotplug_report(self, event);
+    return;
+  }
+  slave->configadr = configadr;
+  jsd_hotplug_read_sii(self, slave_id);
+  event.eep_man = slave->eep_man;
+  event.eep_id  = slave->eep_id;
+  event.type    = JSD_HOTPLUG_EVENT_ADDED;
+  jsd_hotplug_report(self, event);
+
+  event.type = jsd_hotplug_configure(self, slave_id);
+  pthread_mutex_unlock(&self->hotplug.config_mutex);
+  event.duration_nsec = jsd_time_get_mono_time_nsec() - start;
+  jsd_hotplug_report(self, event);
+}
+
+/****************************************************
+ * Topology checks
+ ****************************************************/
+
+// A lost slave whose station address was reset may be another device
+static void jsd_hotplug_check_identity(jsd_t* self, uint16_t slave_id) {
+  ecx_contextt* context = &self->ecx_context;
+  ec_slavet*    slave   = &context->slavelist[slave_id];
+  uint16        adp     = (uint16)(1 - slave_id);
+  uint32        eep_man = 0;
+  uint32        eep_id  = 0;
+
+  // jsd_ecatcheck(...) skips its recovery while the SII is read here
+  pthread_mutex_lock(&self->hotplug.config_mutex);
+  if (__atomic_load_n(&slave->islost, __ATOMIC_ACQUIRE) &&
+      ecx_APRDw(context->port, adp, ECT_REG_STADR, EC_TIMEOUTRET) == 0) {
+    ecx_APWRw(context->port, adp, ECT_REG_EEPCFG, htoes(0), EC_TIMEOUTRET);
+    eep_man =
+        (uint32)ecx_readeepromAP(context, adp, ECT_SII_MANUF, EC_TIMEOUTEEP);
+    eep_id = (uint32)ecx_readeepromAP(context, adp, ECT_SII_ID, EC_TIMEOUTEEP);
+  }
+  pthread_mutex_unlock(&self->hotplug.config_mutex);
+  if (eep_man == 0 || (eep_man == slave->eep_man && eep_id == slave->eep_id)) {
+    return;
+  }
+
+  jsd_hotplug_event_t event;
+  memset(&event, 0, sizeof(event));
+  event.type       = JSD_HOTPLUG_EVENT_MISMATCH;
+  event.slave_id   = slave_id;
+  event.num_slaves = self->hotplug.seen_slaves;
+  event.eep_man    = eep_man;
+  event.eep_id     = eep_id;
+  self->hotplug.reported[slave_id] = true;
+  jsd_hotplug_report(self, event);
+}
+
+// Configured slaves keep their positions if the new ones were appended
+static uint16_t jsd_hotplug_find_inserted(jsd_t* self) {
+  ecx_contextt* context = &self->ecx_context;
+  uint16_t      slave_id;
+
+  for (slave_id = 1; slave_id <= *context->slavecount; ++slave_id) {
+    uint16 configadr = ecx_APRDw(context->port, (uint16)(1 - slave_id),
+                                 ECT_REG_STADR, EC_TIMEOUTRET);
+    if (configadr != context->slavelist[slave_id].configadr) {
+      return slave_id;
+    }
+  }
+  return 0;
+}
+
+static void jsd_hotplug_check(jsd_t* self) {
+  jsd_hotplug_t* hotplug = &self->hotplug;
+  ecx_contextt*  context = &self->ecx_context;
+  uint16         type;
+  uint16_t       slave_id;
+
+  int answered = ecx_BRD(context->port, 0x0000, ECT_REG_TYPE, sizeof(type),
+                         &type, EC_TIMEOUTSAFE);
+  pthread_mutex_lock(&hotplug->report_mutex);
+  ++hotplug->stats.checks;
+  if (answered < 0) {
+    ++hotplug->stats.failed_checks;
+  }
+  pthread_mutex_unlock(&hotplug->report_mutex);
+  if (answered < 0) {
+    return;
+  }
+
+  uint16_t num_slaves = answered;
+  uint16_t configured = *context->slavecount;
+  if (num_slaves != hotplug->seen_slaves) {
+    hotplug->seen_slaves = num_slaves;
+    memset(hotplug->reported, 0, sizeof(hotplug->reported));
+    if (num_slaves < configured) {
+      jsd_hotplug_event_t event;
+      memset(&event, 0, sizeof(event));
+      event.type       = JSD_HOTPLUG_EVENT_REMOVED;
+      event.num_slaves = num_slaves;
+      jsd_hotplug_report(self, event);
+    }
+  }
+
+  for (slave_id = 1; slave_id <= configured; ++slave_id) {
+    if (context->slavelist[slave_id].islost && !hotplug->reported[slave_id]) {
+      jsd_hotplug_check_identity(self, slave_id);
+    }
+  }
+
+  // One new slave per check, a slave left out blocks the ones after it
+  slave_id = configured + 1;
+  if (num_slaves < slave_id || slave_id >= EC_MAXSLAVE ||
+      hotplug->reported[slave_id]) {
+    return;
+  }
+  hotplug->reported[slave_id] = true;
+  uint16_t inserted           = jsd_hotplug_find_inserted(self);
+  if (inserted > 0) {
+    jsd_hotplug_event_t event;
+    memset(&event, 0, sizeof(event));
+    event.type       = JSD_HOTPLUG_EVENT_INSERTED;
+    event.slave_id   = inserted;
+    event.num_slaves = num_slaves;
+    jsd_hotplug_report(self, event);
+    return;
+  }
+  jsd_hotplug_add(self, slave_id, num_slaves);
+  if (*context->slavecount == slave_id) {
+    hotplug->reported[slave_id] = false;
+  }
+}
+
+/****************************************************
+ * Thread
+ ****************************************************/
+
+static void* jsd_hotplug_thread_loop(void* void_data) {
+  jsd_t*         self    = (jsd_t*)void_data;
+  jsd_hotplug_t* hotplug = &self->hotplug;
+
+  if (self->arena.base) {
+    jsd_memory_prefault_stack(JSD_MEMORY_THREAD_STACK_PREFAULT_BYTES);
+  }
+  while (!__atomic_load_n(&hotplug->join_flag, __ATOMIC_ACQUIRE)) {
+    int64_t next_nsec = jsd_time_get_mono_time_nsec() +
+                        (int64_t)hotplug->config.check_period_ms * 1000000;
+    jsd_hotplug_check(self);
+    while (!__atomic_load_n(&hotplug->join_flag, __ATOMIC_ACQUIRE) &&
+           jsd_time_get_mono_time_nsec() < next_nsec) {
+      usleep(JSD_HOTPLUG_SLEEP_USEC);
+    }
+  }
+  return NULL;
+}
+
+/****************************************************
+ * Public functions
+ ****************************************************/
+
+void jsd_hotplug_reserve_outputs(jsd_t* self, uint32_t bytes) {
+  assert(self);
+  self->hotplug.reserved_obytes = bytes;
+}
+
+bool jsd_hotplug_start(jsd_t* self, jsd_hotplug_config_t config) {
+  assert(self);
+  jsd_hotplug_t* hotplug = &self->hotplug;
+
+  if (hotplug->running) {
+    WARNING("Hot-plug thread is already running");
+    return false;
+  }
+  if (config.check_period_ms == 0) {
+    config.check_period_ms = JSD_HOTPLUG_DEFAULT_CHECK_PERIOD_MS;
+  }
+  hotplug->config      = config;
+  hotplug->join_flag   = false;
+  hotplug->pending     = false;
+  hotplug->seen_slaves = *self->ecx_context.slavecount;
+  hotplug->has_event   = false;
+  memset(hotplug->reported, 0, sizeof(hotplug->reported));
+  memset(&hotplug->stats, 0, sizeof(hotplug->stats));
+
+  if (0 != jsd_memory_thread_create(&hotplug->thread, self->arena.base != NULL,
+                                    jsd_hotplug_thread_loop, (void*)self)) {
+    ERROR("Failed to create hot-plug thread");
+    return false;
+  }
+  hotplug->running = true;
+  MSG("Hot-plug thread checking %d slaves every %u ms",
+      *self->ecx_context.slavecount, config.check_period_ms);
+  return true;
+}
+
+void jsd_hotplug_stop(jsd_t* self) {
+  assert(self);
+  jsd_hotplug_t* hotplug = &self->hotplug;
+  if (!hotplug->running) {
+    return;
+  }
+  hotplug->running = false;
+  __atomic_store_n(&hotplug->join_flag, true, __ATOMIC_RELEASE);
+  pthread_join(hotplug->thread, NULL);
+
+  // An extension the loop did not pick up is dropped with its slave
+  __atomic_store_n(&hotplug->pending, false, __ATOMIC_RELEASE);
+}
+
+jsd_hotplug_stats_t jsd_hotplug_get_stats(jsd_t* self) {
+  assert(self);
+  pthread_mutex_lock(&self->hotplug.report_mutex);
+  jsd_hotplug_stats_t stats = self->hotplug.stats;
+  pthread_mutex_unlock(&self->hotplug.report_mutex);
+  return stats;
+}
+
+bool jsd_hotplug_get_last_event(jsd_t* self, jsd_hotplug_event_t* event) {
+  assert(self);
+  assert(event);
+  pthread_mutex_lock(&self->hotplug.report_mutex);
+  bool has_event = self->hotplug.has_event;
+  if (has_event) {
+    *event = self->hotplug.last_event;
+  }
+  pthread_mutex_unlock(&self->hotplug.report_mutex);
+  return has_event;
+}
+
+const char* jsd_hotplug_event_type_to_string(jsd_hotplug_event_type_t type) {
+  if (type >= JSD_NUM_HOTPLUG_EVENTS) {
+    return "unknown";
+  }
+  return jsd_hotplug_event_names[type];
+}
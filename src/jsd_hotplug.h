@@ -0,0 +1,50 @@
+#ifndef JSD_HOTPLUG_H
+#define JSD_HOTPLUG_H
+
+#include "jsd/jsd_hotplug_pub.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Appends the process data of a configured new slave to the image,
+ * called by jsd_read(...) between two cycles
+ *
+ * @param self pointer to JSD context with a pending image extension
+ */
+void jsd_hotplug_apply(jsd_t* self);
+
+/**
+ * @brief Extends the outputs by the reserved bytes past the last slave,
+ * called by jsd_init(...) after mapping the image
+ *
+ * The inputs of every slave move up once, before any handle is resolved.
+ *
+ * @param self pointer to JSD context
+ * @return false if the reserve does not fit the IOmap or one frame
+ */
+bool jsd_hotplug_reserve_image(jsd_t* self);
+
+/**
+ * @brief Appends the process data of a slave to the overlapping image
+ *
+ * The slave takes the logical addresses after the last slave, its outputs
+ * from the reserve, so no other slave moves. The slave becomes the last one
+ * of slavecount and its working counter is expected.
+ *
+ * @param self pointer to JSD context
+ * @param slave_id slave_id of the new slave, slavecount + 1
+ * @param obytes output bytes of the slave
+ * @param ibytes input bytes of the slave
+ * @return false if the outputs exceed the reserve or the image does not fit
+ * the IOmap or one frame
+ */
+bool jsd_hotplug_extend_image(jsd_t* self, uint16_t slave_id, uint32_t obytes,
+                              uint32_t ibytes);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
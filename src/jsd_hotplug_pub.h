@@ -0,0 +1,87 @@
+#ifndef JSD_HOTPLUG_PUB_H
+#define JSD_HOTPLUG_PUB_H
+
+#include "jsd/jsd_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Reserves output bytes in the image for slaves added at runtime
+ *
+ * jsd_init(...) extends the outputs of the process image by this many bytes
+ * past the last slave, so that the outputs of a new slave fit without moving
+ * the inputs of the others. The cyclic frame grows by the reserve. Without a
+ * reserve, only new slaves without outputs reach OP.
+ *
+ * Call before jsd_init(...).
+ *
+ * @param self pointer to JSD context
+ * @param bytes output bytes kept free, 0 by default
+ */
+void jsd_hotplug_reserve_outputs(jsd_t* self, uint32_t bytes);
+
+/**
+ * @brief Starts the hot-plug thread
+ *
+ * Every config.check_period_ms, the thread counts the slaves answering a
+ * broadcast read. A slave added to the end of the line gets the next slave_id
+ * and is configured without stopping the bus: station address, mailbox, the
+ * PO2SO hook of its device, process data SyncManagers and FMMUs, then
+ * SAFE-OP. jsd_read(...) adds its process data to the image between two
+ * cycles and the thread requests OP. The slave is mapped after the last one,
+ * its outputs take the reserve of jsd_hotplug_reserve_outputs(...), and
+ * existing slaves and their handles keep their offsets.
+ *
+ * The configuration of a new slave must be set with jsd_set_slave_config(...)
+ * before jsd_init(...), slaves without an active configuration matching their
+ * product code are left in PRE-OP. Lost slaves answering with another
+ * identity and new slaves shifting the positions of others are only reported,
+ * they need a new jsd_init(...).
+ *
+ * Call after jsd_init(...), jsd_free(...) stops the thread.
+ *
+ * @param self pointer to JSD context
+ * @param config hot-plug settings, zeroed for the defaults
+ * @return true on success
+ */
+bool jsd_hotplug_start(jsd_t* self, jsd_hotplug_config_t config);
+
+/**
+ * @brief Stops the hot-plug thread
+ *
+ * @param self pointer to JSD context
+ */
+void jsd_hotplug_stop(jsd_t* self);
+
+/**
+ * @brief Gets the hot-plug counters
+ *
+ * @param self pointer to JSD context
+ * @return counters since jsd_hotplug_start(...)
+ */
+jsd_hotplug_stats_t jsd_hotplug_get_stats(jsd_t* self);
+
+/**
+ * @brief Gets the last topology change
+ *
+ * @param self pointer to JSD context
+ * @param event filled with the last event
+ * @return false if there was no event since jsd_hotplug_start(...)
+ */
+bool jsd_hotplug_get_last_event(jsd_t* self, jsd_hotplug_event_t* event);
+
+/**
+ * @brief Converts a hot-plug event type to a string
+ *
+ * @param type event type
+ * @return name of the event type
+ */
+const char* jsd_hotplug_event_type_to_string(jsd_hotplug_event_type_t type);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,162 @@
+#include "jsd/jsd_memory.h"
+
+#include <alloca.h>
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "jsd/jsd_print.h"
+
+#define JSD_MEMORY_HUGE_PAGE_BYTES (2 * 1024 * 1024)
+
+static size_t jsd_memory_round_up(size_t bytes, size_t page) {
+  return (bytes + page - 1) / page * page;
+}
+
+bool jsd_memory_arena_create(jsd_memory_arena_t* self, size_t bytes,
+                             bool use_huge_pages) {
+  assert(self);
+
+  void*  base = MAP_FAILED;
+  size_t size = 0;
+
+  if (use_huge_pages) {
+    size = jsd_memory_round_up(bytes, JSD_MEMORY_HUGE_PAGE_BYTES);
+    base = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | MAP_POPULATE, -1,
+                0);
+    if (base == MAP_FAILED) {
+      WARNING("Huge pages unavailable, arena falls back to regular pages");
+    }
+  }
+
+  bool huge_pages = base != MAP_FAILED;
+  if (!huge_pages) {
+    size = jsd_memory_round_up(bytes, (size_t)sysconf(_SC_PAGESIZE));
+    base = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+    if (base == MAP_FAILED) {
+      ERROR("Failed to map %zu byte arena", size);
+      return false;
+    }
+  }
+
+  // MAP_POPULATE is best effort, write every page to be sure it is resident
+  memset(base, 0, size);
+  if (mlock(base, size) != 0) {
+    WARNING("Could not lock the %zu byte arena in RAM", size);
+  }
+
+  self->base       = (uint8_t*)base;
+  self->size       = size;
+  self->used       = 0;
+  self->huge_pages = huge_pages;
+
+  return true;
+}
+
+void* jsd_memory_arena_alloc(jsd_memory_arena_t* self, size_t bytes) {
+  assert(self);
+  assert(self->base);
+
+  size_t aligned = jsd_memory_arena_align(bytes);
+  assert(self->used + aligned <= self->size);
+
+  void* ptr = self->base + self->used;
+  self->used += aligned;
+
+  return ptr;
+}
+
+void jsd_memory_arena_destroy(jsd_memory_arena_t* self) {
+  assert(self);
+
+  // self may be inside the mapping
+  jsd_memory_arena_t arena = *self;
+  if (arena.base) {
+    munmap(arena.base, arena.size);
+  }
+}
+
+void jsd_memory_prefault_stack(size_t bytes) {
+  volatile uint8_t* stack = (volatile uint8_t*)alloca(bytes);
+  size_t            page  = (size_t)sysconf(_SC_PAGESIZE);
+  size_t            i;
+
+  for (i = 0; i < bytes; i += page) {
+    stack[i] = 0;
+  }
+}
+
+int jsd_memory_thread_create(pthread_t* thread, bool rt_memory,
+                             void* (*start)(void*), void* arg) {
+  // glibc allocates the thread's TLS from the heap. Starting a thread is a
+  // setup call, so it may do so even once the caller forbade heap allocations
+  bool forbidden = jsd_memory_allow_malloc();
+
+  int err;
+  if (rt_memory) {
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setstacksize(&attr, JSD_MEMORY_THREAD_STACK_BYTES);
+    err = pthread_create(thread, &attr, start, arg);
+    pthread_attr_destroy(&attr);
+  } else {
+    err = pthread_create(thread, NULL, start, arg);
+  }
+
+  jsd_memory_forbid_malloc(forbidden);
+  return err;
+}
+
+#ifdef JSD_RT_MALLOC_CHECK
+
+extern void* __libc_malloc(size_t size);
+extern void* __libc_calloc(size_t nmemb, size_t size);
+extern void* __libc_realloc(void* ptr, size_t size);
+
+static __thread bool jsd_memory_malloc_forbidden = false;
+
+static void jsd_memory_check_malloc(const char* func) {
+  if (jsd_memory_malloc_forbidden) {
+    // Allow whatever abort(...) and the print may allocate
+    jsd_memory_malloc_forbidden = false;
+    ERROR("%s(...) called on a thread with heap allocations forbidden", func);
+    abort();
+  }
+}
+
+void* malloc(size_t size) {
+  jsd_memory_check_malloc("malloc");
+  return __libc_malloc(size);
+}
+
+void* calloc(size_t nmemb, size_t size) {
+  jsd_memory_check_malloc("calloc");
+  return __libc_calloc(nmemb, size);
+}
+
+void* realloc(void* ptr, size_t size) {
+  jsd_memory_check_malloc("realloc");
+  return __libc_realloc(ptr, size);
+}
+
+void jsd_memory_forbid_malloc(bool forbid) {
+  jsd_memory_malloc_forbidden = forbid;
+}
+
+bool jsd_memory_allow_malloc() {
+  bool forbidden              = jsd_memory_malloc_forbidden;
+  jsd_memory_malloc_forbidden = false;
+  return forbidden;
+}
+
+#else
+
+void jsd_memory_forbid_malloc(bool forbid) { (void)forbid; }
+
+bool jsd_memory_allow_malloc() { return false; }
+
+#endif
@@ -0,0 +1,133 @@
+#ifndef JSD_MEMORY_H_
+#define JSD_MEMORY_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/// Alignment of every arena allocation, one cache line
+#define JSD_MEMORY_ARENA_ALIGN (64)
+
+/// Stack reserved for JSD threads in real-time memory mode
+#define JSD_MEMORY_THREAD_STACK_BYTES (256 * 1024)
+
+/// Stack prefaulted by JSD threads in real-time memory mode
+#define JSD_MEMORY_THREAD_STACK_PREFAULT_BYTES (128 * 1024)
+
+/// Stack prefaulted on the thread calling jsd_init(...) in real-time memory
+/// mode
+#define JSD_MEMORY_CALLER_STACK_PREFAULT_BYTES (64 * 1024)
+
+typedef struct {
+  bool use_huge_pages;  ///< back the arena with huge pages when available
+  bool lock_memory;     ///< mlockall(MCL_CURRENT | MCL_FUTURE), needs root or
+                        ///< CAP_IPC_LOCK
+} jsd_memory_config_t;
+
+/**
+ * @brief Bump allocator over a single anonymous mapping
+ *
+ * Allocations are zeroed, cache line aligned and never individually freed.
+ */
+typedef struct {
+  uint8_t* base;        ///< NULL when the arena is not in use
+  size_t   size;        ///< mapped bytes
+  size_t   used;        ///< carved bytes
+  bool     huge_pages;  ///< true if backed by huge pages
+} jsd_memory_arena_t;
+
+/**
+ * @brief Rounds up to the arena allocation alignment
+ */
+static inline size_t jsd_memory_arena_align(size_t bytes) {
+  return (bytes + JSD_MEMORY_ARENA_ALIGN - 1) &
+         ~((size_t)JSD_MEMORY_ARENA_ALIGN - 1);
+}
+
+/**
+ * @brief Maps and prefaults an arena
+ *
+ * Falls back to regular pages if huge pages are requested but unavailable.
+ *
+ * @param self arena
+ * @param bytes minimum size of the arena
+ * @param use_huge_pages try MAP_HUGETLB first
+ * @return true on success
+ */
+bool jsd_memory_arena_create(jsd_memory_arena_t* self, size_t bytes,
+                             bool use_huge_pages);
+
+/**
+ * @brief Carves zeroed memory out of the arena
+ *
+ * @param self arena
+ * @param bytes size of the allocation
+ * @return pointer to the allocation, asserts on exhaustion
+ */
+void* jsd_memory_arena_alloc(jsd_memory_arena_t* self, size_t bytes);
+
+/**
+ * @brief Unmaps the arena, all carved memory becomes invalid
+ *
+ * The arena descriptor may live inside the arena itself.
+ *
+ * @param self arena
+ */
+void jsd_memory_arena_destroy(jsd_memory_arena_t* self);
+
+/**
+ * @brief Touches the calling thread's stack so later use does not page fault
+ *
+ * @param bytes amount of stack below the caller to prefault
+ */
+void jsd_memory_prefault_stack(size_t bytes);
+
+/**
+ * @brief Creates a JSD background thread
+ *
+ * In real-time memory mode the thread gets a fixed stack of
+ * JSD_MEMORY_THREAD_STACK_BYTES instead of the default, so prefaulting it is
+ * affordable.
+ *
+ * @param thread output thread handle
+ * @param rt_memory true in real-time memory mode
+ * @param start thread entry point
+ * @param arg argument passed to start
+ * @return 0 on success, an error number otherwise
+ */
+int jsd_memory_thread_create(pthread_t* thread, bool rt_memory,
+                             void* (*start)(void*), void* arg);
+
+/**
+ * @brief Forbids or allows heap allocations on the calling thread
+ *
+ * Only enforced when built with ENABLE_RT_MALLOC_CHECK, which interposes
+ * malloc(...), calloc(...) and realloc(...) and aborts on an allocation from a
+ * forbidden thread. No-op otherwise.
+ *
+ * @param forbid true to forbid heap allocations
+ */
+void jsd_memory_forbid_malloc(bool forbid);
+
+/**
+ * @brief Allows heap allocations on the calling thread for a setup call
+ *
+ * Setup calls that may follow jsd_init(...) of a real-time context allow the
+ * heap while they open files, then restore the previous state with
+ * jsd_memory_forbid_malloc(...). No-op unless built with
+ * ENABLE_RT_MALLOC_CHECK.
+ *
+ * @return true if heap allocations were forbidden
+ */
+bool jsd_memory_allow_malloc();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
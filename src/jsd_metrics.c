@@ -0,0 +1,572 @@
+#include "jsd/jsd_metrics.h"
+
+#include <assert.h>
+#include <poll.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "jsd/jsd_diag_pub.h"
+#include "jsd/jsd_print.h"
+
+#define JSD_METRICS_POLL_TIMEOUT_MS (100)
+
+// A client that sends nothing within this delay gets plain text
+#define JSD_METRICS_REQUEST_TIMEOUT_MS (50)
+
+static const uint32_t
+    jsd_metrics_latency_bounds_usec[JSD_METRICS_LATENCY_BUCKETS - 1] = {
+        250, 500, 1000, 2500, 5000, 10000, 25000, 50000, 100000, 250000, 500000,
+};
+
+static const char* jsd_metrics_recovery_event_names[JSD_NUM_RECOVERY_EVENTS] =
+    {"ack_error", "request_op", "reconfig", "lost", "recovered", "found"};
+
+/****************************************************
+ * Recording
+ ****************************************************/
+
+jsd_t* jsd_metrics_get_context(ecx_contextt* ecx_context) {
+  assert(ecx_context);
+  // jsd_alloc(...) points userdata to the slave configs of the JSD context
+  if (ecx_context->userdata == NULL) {
+    return NULL;
+  }
+  jsd_t* self = (jsd_t*)((uint8_t*)ecx_context->userdata -
+                         offsetof(jsd_t, slave_configs));
+  return &self->ecx_context == ecx_context ? self : NULL;
+}
+
+static void jsd_metrics_record_latency(jsd_latency_histogram_t* histogram,
+                                       int64_t                  latency_nsec) {
+  uint64_t latency_usec = latency_nsec > 0 ? latency_nsec / 1000 : 0;
+  int      bucket       = 0;
+  while (bucket < JSD_METRICS_LATENCY_BUCKETS - 1 &&
+         latency_usec > jsd_metrics_latency_bounds_usec[bucket]) {
+    ++bucket;
+  }
+  jsd_metrics_increment(&histogram->buckets[bucket]);
+  __atomic_fetch_add(&histogram->sum_usec, latency_usec, __ATOMIC_RELAXED);
+  jsd_metrics_increment(&histogram->count);
+}
+
+void jsd_metrics_record_sdo(jsd_t* self, uint16_t slave_id, bool success,
+                            int64_t latency_nsec) {
+  assert(self);
+  assert(slave_id < EC_MAXSLAVE);
+  jsd_bus_metrics_t*   bus   = &self->metrics.bus;
+  jsd_slave_metrics_t* slave = &self->metrics.slaves[slave_id];
+
+  jsd_metrics_increment(&bus->sdo_requests);
+  jsd_metrics_increment(&slave->sdo_requests);
+  if (!success) {
+    jsd_metrics_increment(&bus->sdo_failures);
+    jsd_metrics_increment(&slave->sdo_failures);
+  }
+  jsd_metrics_record_latency(&bus->sdo_latency, latency_nsec);
+  jsd_metrics_record_latency(&slave->sdo_latency, latency_nsec);
+}
+
+void jsd_metrics_record_recovery(jsd_t* self, uint16_t slave_id,
+                                 jsd_recovery_event_t event) {
+  assert(self);
+  assert(slave_id < EC_MAXSLAVE);
+  assert(event < JSD_NUM_RECOVERY_EVENTS);
+  jsd_metrics_increment(&self->metrics.bus.recovery_events[event]);
+  jsd_metrics_increment(&self->metrics.slaves[slave_id].recovery_events[event]);
+}
+
+void jsd_metrics_record_reconfig(jsd_t* self, int64_t duration_nsec) {
+  assert(self);
+  jsd_metrics_record_latency(&self->metrics.bus.reconfig_latency,
+                             duration_nsec);
+}
+
+void jsd_metrics_record_emcy(jsd_t* self, uint16_t slave_id) {
+  assert(self);
+  if (slave_id >= EC_MAXSLAVE) {
+    return;
+  }
+  jsd_metrics_increment(&self->metrics.bus.emcy_count);
+  jsd_metrics_increment(&self->metrics.slaves[slave_id].emcy_count);
+}
+
+void jsd_metrics_update_states(jsd_t* self, bool count_changes) {
+  assert(self);
+  int slave_id;
+  for (slave_id = 1; slave_id <= *self->ecx_context.slavecount; ++slave_id) {
+    jsd_slave_metrics_t* slave = &self->metrics.slaves[slave_id];
+    uint16_t state = self->ecx_context.slavelist[slave_id].state;
+    if (__atomic_load_n(&slave->al_state, __ATOMIC_RELAXED) != state) {
+      if (count_changes) {
+        jsd_metrics_increment(&self->metrics.bus.state_transitions);
+        jsd_metrics_increment(&slave->state_transitions);
+      }
+      __atomic_store_n(&slave->al_state, state, __ATOMIC_RELAXED);
+    }
+  }
+}
+
+/****************************************************
+ * Public functions
+ ****************************************************/
+
+static uint64_t jsd_metrics_load(const uint64_t* counter) {
+  return __atomic_load_n(counter, __ATOMIC_RELAXED);
+}
+
+static void jsd_metrics_load_histogram(const jsd_latency_histogram_t* source,
+                                       jsd_latency_histogram_t*       dest) {
+  int bucket;
+  dest->count    = jsd_metrics_load(&source->count);
+  dest->sum_usec = jsd_metrics_load(&source->sum_usec);
+  for (bucket = 0; bucket < JSD_METRICS_LATENCY_BUCKETS; ++bucket) {
+    dest->buckets[bucket] = jsd_metrics_load(&source->buckets[bucket]);
+  }
+}
+
+jsd_bus_metrics_t jsd_get_bus_metrics(jsd_t* self) {
+  assert(self);
+  const jsd_bus_metrics_t* bus = &self->metrics.bus;
+  jsd_bus_metrics_t        metrics;
+  int                      event;
+
+  metrics.cycles            = jsd_metrics_load(&bus->cycles);
+  metrics.bad_wkc_cycles    = jsd_metrics_load(&bus->bad_wkc_cycles);
+  metrics.lost_frames       = jsd_metrics_load(&bus->lost_frames);
+  metrics.transmit_failures = jsd_metrics_load(&bus->transmit_failures);
+  for (event = 0; event < JSD_NUM_RECOVERY_EVENTS; ++event) {
+    metrics.recovery_events[event] =
+        jsd_metrics_load(&bus->recovery_events[event]);
+  }
+  metrics.state_transitions = jsd_metrics_load(&bus->state_transitions);
+  metrics.emcy_count        = jsd_metrics_load(&bus->emcy_count);
+  metrics.sdo_requests      = jsd_metrics_load(&bus->sdo_requests);
+  metrics.sdo_failures      = jsd_metrics_load(&bus->sdo_failures);
+  metrics.wkc_scans         = jsd_metrics_load(&bus->wkc_scans);
+  metrics.dc_samples        = jsd_metrics_load(&bus->dc_samples);
+  jsd_metrics_load_histogram(&bus->sdo_latency, &metrics.sdo_latency);
+  jsd_metrics_load_histogram(&bus->reconfig_latency,
+                             &metrics.reconfig_latency);
+
+  metrics.sdo_request_queue_high_water =
+      __atomic_load_n(&bus->sdo_request_queue_high_water, __ATOMIC_RELAXED);
+  metrics.sdo_response_queue_high_water =
+      __atomic_load_n(&bus->sdo_response_queue_high_water, __ATOMIC_RELAXED);
+  metrics.error_queue_high_water =
+      __atomic_load_n(&bus->error_queue_high_water, __ATOMIC_RELAXED);
+  return metrics;
+}
+
+jsd_slave_metrics_t jsd_get_slave_metrics(jsd_t* self, uint16_t slave_id) {
+  assert(self);
+  assert(slave_id < EC_MAXSLAVE);
+  const jsd_slave_metrics_t* slave = &self->metrics.slaves[slave_id];
+  jsd_slave_metrics_t        metrics;
+  int                        event;
+
+  for (event = 0; event < JSD_NUM_RECOVERY_EVENTS; ++event) {
+    metrics.recovery_events[event] =
+        jsd_metrics_load(&slave->recovery_events[event]);
+  }
+  metrics.state_transitions = jsd_metrics_load(&slave->state_transitions);
+  metrics.emcy_count        = jsd_metrics_load(&slave->emcy_count);
+  metrics.sdo_requests      = jsd_metrics_load(&slave->sdo_requests);
+  metrics.sdo_failures      = jsd_metrics_load(&slave->sdo_failures);
+  metrics.wkc_misses        = jsd_metrics_load(&slave->wkc_misses);
+  metrics.dc_sync_violations = jsd_metrics_load(&slave->dc_sync_violations);
+  metrics.al_state = __atomic_load_n(&slave->al_state, __ATOMIC_RELAXED);
+  jsd_metrics_load_histogram(&slave->sdo_latency, &metrics.sdo_latency);
+  return metrics;
+}
+
+/****************************************************
+ * Prometheus text format
+ ****************************************************/
+
+static void jsd_metrics_write_family(FILE* file, const char* name,
+                                     const char* type, const char* help) {
+  fprintf(file, "# HELP %s %s\n# TYPE %s %s\n", name, help, name, type);
+}
+
+static void jsd_metrics_write_histogram(FILE* file, const char* name,
+                                        const char*                    labels,
+                                        const jsd_latency_histogram_t* h) {
+  const char* separator  = labels[0] ? "," : "";
+  uint64_t    cumulative = 0;
+  int         bucket;
+
+  for (bucket = 0; bucket < JSD_METRICS_LATENCY_BUCKETS - 1; ++bucket) {
+    cumulative += h->buckets[bucket];
+    fprintf(file, "%s_bucket{%s%sle=\"%g\"} %lu\n", name, labels, separator,
+            jsd_metrics_latency_bounds_usec[bucket] * 1e-6,
+            (unsigned long)cumulative);
+  }
+  cumulative += h->buckets[JSD_METRICS_LATENCY_BUCKETS - 1];
+  fprintf(file, "%s_bucket{%s%sle=\"+Inf\"} %lu\n", name, labels, separator,
+          (unsigned long)cumulative);
+  if (labels[0]) {
+    fprintf(file, "%s_sum{%s} %g\n", name, labels, h->sum_usec * 1e-6);
+    fprintf(file, "%s_count{%s} %lu\n", name, labels, (unsigned long)h->count);
+  } else {
+    fprintf(file, "%s_sum %g\n", name, h->sum_usec * 1e-6);
+    fprintf(file, "%s_count %lu\n", name, (unsigned long)h->count);
+  }
+}
+
+void jsd_metrics_write_prometheus(jsd_t* self, FILE* file) {
+  assert(self);
+  assert(file);
+  jsd_bus_metrics_t bus        = jsd_get_bus_metrics(self);
+  int               num_slaves = *self->ecx_context.slavecount;
+  int               slave_id, event;
+  char              labels[32];
+
+  if (num_slaves > EC_MAXSLAVE - 1) {
+    num_slaves = EC_MAXSLAVE - 1;
+  }
+
+  jsd_metrics_write_family(file, "jsd_cycles_total", "counter",
+                           "Process data cycles received by jsd_read");
+  fprintf(file, "jsd_cycles_total %lu\n", (unsigned long)bus.cycles);
+  jsd_metrics_write_family(file, "jsd_bad_wkc_cycles_total", "counter",
+                           "Cycles with an unexpected working counter");
+  fprintf(file, "jsd_bad_wkc_cycles_total %lu\n",
+          (unsigned long)bus.bad_wkc_cycles);
+  jsd_metrics_write_family(file, "jsd_lost_frames_total", "counter",
+                           "Process data frames that did not return");
+  fprintf(file, "jsd_lost_frames_total %lu\n", (unsigned long)bus.lost_frames);
+  jsd_metrics_write_family(file, "jsd_transmit_failures_total", "counter",
+                           "Process data frames that could not be sent");
+  fprintf(file, "jsd_transmit_failures_total %lu\n",
+          (unsigned long)bus.transmit_failures);
+
+  jsd_metrics_write_family(file, "jsd_wkc", "gauge",
+                           "Working counter of the last cycle");
+  fprintf(file, "jsd_wkc %d\n", self->wkc);
+  jsd_metrics_write_family(file, "jsd_expected_wkc", "gauge",
+                           "Expected working counter");
+  fprintf(file, "jsd_expected_wkc %d\n", self->expected_wkc);
+  jsd_metrics_write_family(file, "jsd_wkc_scans_total", "counter",
+                           "Bad working counters attributed to slaves");
+  fprintf(file, "jsd_wkc_scans_total %lu\n", (unsigned long)bus.wkc_scans);
+  jsd_metrics_write_family(file, "jsd_dc_samples_total", "counter",
+                           "DC register samples of all DC slaves");
+  fprintf(file, "jsd_dc_samples_total %lu\n", (unsigned long)bus.dc_samples);
+
+  jsd_metrics_write_family(file, "jsd_recovery_events_total", "counter",
+                           "Recovery actions by type");
+  for (event = 0; event < JSD_NUM_RECOVERY_EVENTS; ++event) {
+    fprintf(file, "jsd_recovery_events_total{event=\"%s\"} %lu\n",
+            jsd_metrics_recovery_event_names[event],
+            (unsigned long)bus.recovery_events[event]);
+  }
+  jsd_metrics_write_family(file, "jsd_state_transitions_total", "counter",
+                           "AL state changes of all slaves");
+  fprintf(file, "jsd_state_transitions_total %lu\n",
+          (unsigned long)bus.state_transitions);
+  jsd_metrics_write_family(file, "jsd_emcy_total", "counter",
+                           "Emergency messages of all slaves");
+  fprintf(file, "jsd_emcy_total %lu\n", (unsigned long)bus.emcy_count);
+
+  jsd_metrics_write_family(file, "jsd_sdo_requests_total", "counter",
+                           "SDO transfers");
+  fprintf(file, "jsd_sdo_requests_total %lu\n",
+          (unsigned long)bus.sdo_requests);
+  jsd_metrics_write_family(file, "jsd_sdo_failures_total", "counter",
+                           "SDO transfers without an answer");
+  fprintf(file, "jsd_sdo_failures_total %lu\n",
+          (unsigned long)bus.sdo_failures);
+  jsd_metrics_write_family(file, "jsd_sdo_latency_seconds", "histogram",
+                           "Duration of SDO transfers");
+  jsd_metrics_write_histogram(file, "jsd_sdo_latency_seconds", "",
+                              &bus.sdo_latency);
+  jsd_metrics_write_family(file, "jsd_reconfig_duration_seconds", "histogram",
+                           "Duration of slave reconfigurations by recovery");
+  jsd_metrics_write_histogram(file, "jsd_reconfig_duration_seconds", "",
+                              &bus.reconfig_latency);
+
+  jsd_metrics_write_family(file, "jsd_queue_high_water", "gauge",
+                           "Deepest level reached by the queues");
+  fprintf(file, "jsd_queue_high_water{queue=\"sdo_request\"} %u\n",
+          bus.sdo_request_queue_high_water);
+  fprintf(file, "jsd_queue_high_water{queue=\"sdo_response\"} %u\n",
+          bus.sdo_response_queue_high_water);
+  fprintf(file, "jsd_queue_high_water{queue=\"error\"} %u\n",
+          bus.error_queue_high_water);
+
+  // Per-slave families, one sample per slave on the bus
+  jsd_metrics_write_family(file, "jsd_slave_al_state", "gauge",
+                           "Last AL state seen by the master");
+  for (slave_id = 1; slave_id <= num_slaves; ++slave_id) {
+    fprintf(file, "jsd_slave_al_state{slave=\"%d\"} %u\n", slave_id,
+            jsd_get_slave_metrics(self, slave_id).al_state);
+  }
+  jsd_metrics_write_family(file, "jsd_slave_recovery_events_total", "counter",
+                           "Recovery actions by slave and type");
+  for (slave_id = 1; slave_id <= num_slaves; ++slave_id) {
+    jsd_slave_metrics_t slave = jsd_get_slave_metrics(self, slave_id);
+    for (event = 0; event < JSD_NUM_RECOVERY_EVENTS; ++event) {
+      fprintf(file,
+              "jsd_slave_recovery_events_total{slave=\"%d\",event=\"%s\"} "
+              "%lu\n",
+              slave_id, jsd_metrics_recovery_event_names[event],
+              (unsigned long)slave.recovery_events[event]);
+    }
+  }
+  jsd_metrics_write_family(file, "jsd_slave_state_transitions_total",
+                           "counter", "AL state changes by slave");
+  for (slave_id = 1; slave_id <= num_slaves; ++slave_id) {
+    fprintf(
+        file, "jsd_slave_state_transitions_total{slave=\"%d\"} %lu\n", slave_id,
+        (unsigned long)jsd_get_slave_metrics(self, slave_id).state_transitions);
+  }
+  jsd_metrics_write_family(file, "jsd_slave_emcy_total", "counter",
+                           "Emergency messages by slave");
+  for (slave_id = 1; slave_id <= num_slaves; ++slave_id) {
+    fprintf(file, "jsd_slave_emcy_total{slave=\"%d\"} %lu\n", slave_id,
+            (unsigned long)jsd_get_slave_metrics(self, slave_id).emcy_count);
+  }
+  jsd_metrics_write_family(file, "jsd_slave_wkc_misses_total", "counter",
+                           "Bad working counters attributed to the slave");
+  for (slave_id = 1; slave_id <= num_slaves; ++slave_id) {
+    fprintf(file, "jsd_slave_wkc_misses_total{slave=\"%d\"} %lu\n", slave_id,
+            (unsigned long)jsd_get_slave_metrics(self, slave_id).wkc_misses);
+  }
+  jsd_metrics_write_family(file, "jsd_slave_dc_sync_violations_total",
+                           "counter", "DC samples above the sync threshold");
+  for (slave_id = 1; slave_id <= num_slaves; ++slave_id) {
+    jsd_slave_metrics_t slave = jsd_get_slave_metrics(self, slave_id);
+    fprintf(file, "jsd_slave_dc_sync_violations_total{slave=\"%d\"} %lu\n",
+            slave_id, (unsigned long)slave.dc_sync_violations);
+  }
+  jsd_metrics_write_family(file, "jsd_slave_sdo_requests_total", "counter",
+                           "SDO transfers by slave");
+  for (slave_id = 1; slave_id <= num_slaves; ++slave_id) {
+    fprintf(file, "jsd_slave_sdo_requests_total{slave=\"%d\"} %lu\n", slave_id,
+            (unsigned long)jsd_get_slave_metrics(self, slave_id).sdo_requests);
+  }
+  jsd_metrics_write_family(file, "jsd_slave_sdo_failures_total", "counter",
+                           "SDO transfers without an answer by slave");
+  for (slave_id = 1; slave_id <= num_slaves; ++slave_id) {
+    fprintf(file, "jsd_slave_sdo_failures_total{slave=\"%d\"} %lu\n", slave_id,
+            (unsigned long)jsd_get_slave_metrics(self, slave_id).sdo_failures);
+  }
+  jsd_metrics_write_family(file, "jsd_slave_sdo_latency_seconds", "histogram",
+                           "Duration of SDO transfers by slave");
+  for (slave_id = 1; slave_id <= num_slaves; ++slave_id) {
+    jsd_slave_metrics_t slave = jsd_get_slave_metrics(self, slave_id);
+    snprintf(labels, sizeof(labels), "slave=\"%d\"", slave_id);
+    jsd_metrics_write_histogram(file, "jsd_slave_sdo_latency_seconds", labels,
+                                &slave.sdo_latency);
+  }
+
+  // ESC error counters and DC registers are only read by the diagnostic thread
+  if (!self->diag.running) {
+    return;
+  }
+  jsd_metrics_write_family(file, "jsd_slave_dc_sync_error_nanoseconds", "gauge",
+                           "Last DC System Time Difference by slave");
+  for (slave_id = 1; slave_id <= num_slaves; ++slave_id) {
+    if (self->ecx_context.slavelist[slave_id].hasdc) {
+      fprintf(file, "jsd_slave_dc_sync_error_nanoseconds{slave=\"%d\"} %d\n",
+              slave_id,
+              jsd_diag_get_dc_quality(self, slave_id).sync_error_nsec);
+    }
+  }
+  jsd_metrics_write_family(file, "jsd_slave_dc_sync_error_max_nanoseconds",
+                           "gauge", "Largest DC sync error magnitude by slave");
+  for (slave_id = 1; slave_id <= num_slaves; ++slave_id) {
+    if (self->ecx_context.slavelist[slave_id].hasdc) {
+      fprintf(file,
+              "jsd_slave_dc_sync_error_max_nanoseconds{slave=\"%d\"} %u\n",
+              slave_id,
+              jsd_diag_get_dc_quality(self, slave_id).max_sync_error_nsec);
+    }
+  }
+  jsd_metrics_write_family(file, "jsd_slave_dc_sync_error_stddev_nanoseconds",
+                           "gauge", "Standard deviation of the DC sync error");
+  for (slave_id = 1; slave_id <= num_slaves; ++slave_id) {
+    if (self->ecx_context.slavelist[slave_id].hasdc) {
+      fprintf(file,
+              "jsd_slave_dc_sync_error_stddev_nanoseconds{slave=\"%d\"} %g\n",
+              slave_id,
+              jsd_diag_get_dc_quality(self, slave_id).stddev_sync_error_nsec);
+    }
+  }
+  jsd_metrics_write_family(file, "jsd_slave_dc_propagation_delay_nanoseconds",
+                           "gauge", "DC propagation delay from the reference");
+  for (slave_id = 1; slave_id <= num_slaves; ++slave_id) {
+    if (self->ecx_context.slavelist[slave_id].hasdc) {
+      fprintf(
+          file,
+          "jsd_slave_dc_propagation_delay_nanoseconds{slave=\"%d\"} %u\n",
+          slave_id,
+          jsd_diag_get_dc_quality(self, slave_id).propagation_delay_nsec);
+    }
+  }
+  int port;
+  jsd_metrics_write_family(file, "jsd_slave_link_errors_total", "counter",
+                           "Invalid frames and RX errors by slave and port");
+  for (slave_id = 1; slave_id <= num_slaves; ++slave_id) {
+    jsd_esc_errors_t errors = jsd_diag_get_esc_errors(self, slave_id);
+    for (port = 0; port < JSD_ESC_NUM_PORTS; ++port) {
+      fprintf(file,
+              "jsd_slave_link_errors_total{slave=\"%d\",port=\"%d\"} %lu\n",
+              slave_id, port,
+              (unsigned long)(errors.invalid_frames[port] +
+                              errors.rx_errors[port]));
+    }
+  }
+  jsd_metrics_write_family(file, "jsd_slave_lost_links_total", "counter",
+                           "Lost links by slave and port");
+  for (slave_id = 1; slave_id <= num_slaves; ++slave_id) {
+    jsd_esc_errors_t errors = jsd_diag_get_esc_errors(self, slave_id);
+    for (port = 0; port < JSD_ESC_NUM_PORTS; ++port) {
+      fprintf(file,
+              "jsd_slave_lost_links_total{slave=\"%d\",port=\"%d\"} %lu\n",
+              slave_id, port, (unsigned long)errors.lost_links[port]);
+    }
+  }
+}
+
+/****************************************************
+ * Exporter
+ ****************************************************/
+
+static void jsd_metrics_send_all(int fd, const char* data, size_t bytes) {
+  while (bytes > 0) {
+    ssize_t sent = send(fd, data, bytes, MSG_NOSIGNAL);
+    if (sent <= 0) {
+      return;
+    }
+    data += sent;
+    bytes -= sent;
+  }
+}
+
+static void jsd_metrics_serve(jsd_t* self, int fd) {
+  char          request[1024];
+  ssize_t       request_bytes = 0;
+  struct pollfd pfd           = {fd, POLLIN, 0};
+  if (poll(&pfd, 1, JSD_METRICS_REQUEST_TIMEOUT_MS) > 0) {
+    request_bytes = recv(fd, request, sizeof(request) - 1, MSG_DONTWAIT);
+  }
+  bool http = request_bytes >= 4 && memcmp(request, "GET ", 4) == 0;
+
+  char*  body       = NULL;
+  size_t body_bytes = 0;
+  FILE*  stream     = open_memstream(&body, &body_bytes);
+  if (!stream) {
+    return;
+  }
+  jsd_metrics_write_prometheus(self, stream);
+  fclose(stream);
+
+  if (http) {
+    char header[160];
+    int  header_bytes =
+        snprintf(header, sizeof(header),
+                 "HTTP/1.0 200 OK\r\n"
+                 "Content-Type: text/plain; version=0.0.4\r\n"
+                 "Content-Length: %zu\r\n\r\n",
+                 body_bytes);
+    jsd_metrics_send_all(fd, header, header_bytes);
+  }
+  jsd_metrics_send_all(fd, body, body_bytes);
+  free(body);
+}
+
+static void* jsd_metrics_thread_loop(void* void_data) {
+  jsd_t*                  self     = (jsd_t*)void_data;
+  jsd_metrics_exporter_t* exporter = &self->metrics_exporter;
+
+  while (!__atomic_load_n(&exporter->join_flag, __ATOMIC_ACQUIRE)) {
+    struct pollfd pfd = {exporter->fd, POLLIN, 0};
+    if (poll(&pfd, 1, JSD_METRICS_POLL_TIMEOUT_MS) <= 0) {
+      continue;
+    }
+    int client = accept(exporter->fd, NULL, NULL);
+    if (client < 0) {
+      continue;
+    }
+    jsd_metrics_serve(self, client);
+    close(client);
+  }
+  return NULL;
+}
+
+bool jsd_metrics_export_start(jsd_t* self, const char* socket_path) {
+  assert(self);
+  assert(socket_path);
+  jsd_metrics_exporter_t* exporter = &self->metrics_exporter;
+
+  if (exporter->running) {
+    ERROR("Metrics already exported on %s", exporter->path);
+    return false;
+  }
+  if (strlen(socket_path) >= sizeof(exporter->path)) {
+    ERROR("Metrics socket path is too long: %s", socket_path);
+    return false;
+  }
+
+  struct sockaddr_un addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  strcpy(addr.sun_path, socket_path);
+
+  exporter->fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (exporter->fd < 0) {
+    ERROR("Failed to create the metrics socket");
+    return false;
+  }
+  // Replace a stale socket of a previous run, never any other file
+  struct stat st;
+  if (lstat(socket_path, &st) == 0) {
+    if (!S_ISSOCK(st.st_mode)) {
+      ERROR("Metrics socket path %s exists and is not a socket", socket_path);
+      close(exporter->fd);
+      return false;
+    }
+    unlink(socket_path);
+  }
+  if (bind(exporter->fd, (struct sockaddr*)&addr, sizeof(addr)) != 0 ||
+      listen(exporter->fd, 4) != 0) {
+    ERROR("Failed to listen on metrics socket %s", socket_path);
+    close(exporter->fd);
+    return false;
+  }
+
+  strcpy(exporter->path, socket_path);
+  exporter->join_flag = false;
+  if (0 != jsd_memory_thread_create(&exporter->thread,
+                                    self->arena.base != NULL,
+                                    jsd_metrics_thread_loop, (void*)self)) {
+    ERROR("Failed to create metrics exporter thread");
+    close(exporter->fd);
+    unlink(socket_path);
+    return false;
+  }
+  exporter->running = true;
+
+  MSG("Exporting metrics on %s", socket_path);
+  return true;
+}
+
+void jsd_metrics_export_stop(jsd_t* self) {
+  assert(self);
+  jsd_metrics_exporter_t* exporter = &self->metrics_exporter;
+  if (!exporter->running) {
+    return;
+  }
+
+  __atomic_store_n(&exporter->join_flag, true, __ATOMIC_RELEASE);
+  pthread_join(exporter->thread, NULL);
+  close(exporter->fd);
+  unlink(exporter->path);
+  exporter->running = false;
+}
@@ -0,0 +1,92 @@
+#ifndef JSD_METRICS_H
+#define JSD_METRICS_H
+
+#include "jsd/jsd_metrics_pub.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Increments a counter, safe from any thread
+ *
+ * @param counter counter of the metrics block
+ */
+static inline void jsd_metrics_increment(uint64_t* counter) {
+  __atomic_fetch_add(counter, 1, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Raises a high-water mark, safe from any thread
+ *
+ * @param mark high-water mark of the metrics block
+ * @param value current level
+ */
+static inline void jsd_metrics_high_water(uint32_t* mark, uint32_t value) {
+  uint32_t current = __atomic_load_n(mark, __ATOMIC_RELAXED);
+  while (value > current &&
+         !__atomic_compare_exchange_n(mark, &current, value, true,
+                                      __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+  }
+}
+
+/**
+ * @brief Gets the JSD context owning a SOEM context
+ *
+ * @param ecx_context SOEM context, possibly not embedded in a JSD context
+ * @return JSD context, or NULL if the SOEM context is not part of one
+ */
+jsd_t* jsd_metrics_get_context(ecx_contextt* ecx_context);
+
+/**
+ * @brief Counts an SDO transfer and its latency
+ *
+ * @param self pointer to JSD context
+ * @param slave_id slave addressed by the transfer
+ * @param success true if the slave answered
+ * @param latency_nsec duration of the transfer
+ */
+void jsd_metrics_record_sdo(jsd_t* self, uint16_t slave_id, bool success,
+                            int64_t latency_nsec);
+
+/**
+ * @brief Counts a recovery action of jsd_ecatcheck(...)
+ *
+ * @param self pointer to JSD context
+ * @param slave_id recovered slave
+ * @param event recovery action
+ */
+void jsd_metrics_record_recovery(jsd_t* self, uint16_t slave_id,
+                                 jsd_recovery_event_t event);
+
+/**
+ * @brief Records the duration of a slave reconfiguration by jsd_ecatcheck(...)
+ *
+ * @param self pointer to JSD context
+ * @param duration_nsec duration of ecx_reconfig_slave(...)
+ */
+void jsd_metrics_record_reconfig(jsd_t* self, int64_t duration_nsec);
+
+/**
+ * @brief Counts an emergency message received from a slave
+ *
+ * @param self pointer to JSD context
+ * @param slave_id slave that sent the message
+ */
+void jsd_metrics_record_emcy(jsd_t* self, uint16_t slave_id);
+
+/**
+ * @brief Counts the AL state changes since the previous call
+ *
+ * Called whenever the master refreshes the AL states of the slavelist.
+ *
+ * @param self pointer to JSD context
+ * @param count_changes false to only take the states as the reference
+ */
+void jsd_metrics_update_states(jsd_t* self, bool count_changes);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
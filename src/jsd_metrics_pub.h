@@ -0,0 +1,67 @@
+#ifndef JSD_METRICS_PUB_H
+#define JSD_METRICS_PUB_H
+
+#include <stdio.h>
+
+#include "jsd/jsd_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Gets the health counters of the bus
+ *
+ * The counters are maintained with relaxed atomics by the cyclic loop, the SDO
+ * thread and the recovery logic; each counter is exact but a copy is not a
+ * snapshot of a single instant.
+ *
+ * @param self pointer to JSD context
+ * @return counters since jsd_alloc(...)
+ */
+jsd_bus_metrics_t jsd_get_bus_metrics(jsd_t* self);
+
+/**
+ * @brief Gets the health counters of a slave
+ *
+ * @param self pointer to JSD context
+ * @param slave_id index of the slave
+ * @return counters since jsd_alloc(...)
+ */
+jsd_slave_metrics_t jsd_get_slave_metrics(jsd_t* self, uint16_t slave_id);
+
+/**
+ * @brief Writes the metrics in the Prometheus text exposition format
+ *
+ * @param self pointer to JSD context
+ * @param file output stream
+ */
+void jsd_metrics_write_prometheus(jsd_t* self, FILE* file);
+
+/**
+ * @brief Serves the metrics on a local Unix stream socket
+ *
+ * A background thread answers every connection with the output of
+ * jsd_metrics_write_prometheus(...), as an HTTP response if the client sends
+ * a GET request, e.g. curl --unix-socket, as plain text otherwise. Stopped by
+ * jsd_metrics_export_stop(...) or jsd_free(...).
+ *
+ * @param self pointer to JSD context
+ * @param socket_path path of the socket, a stale socket there is replaced,
+ *                    any other file makes this fail
+ * @return true if the socket is listening
+ */
+bool jsd_metrics_export_start(jsd_t* self, const char* socket_path);
+
+/**
+ * @brief Stops serving the metrics and removes the socket
+ *
+ * @param self pointer to JSD context
+ */
+void jsd_metrics_export_stop(jsd_t* self);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
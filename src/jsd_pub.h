@@ -23,6 +23,20 @@ extern "C" {
  */
 jsd_t* jsd_alloc();
 
+/**
+ * @brief Allocates JSD context in real-time memory mode
+ *
+ * The context and every SOEM buffer are carved from a single prefaulted and
+ * locked arena, optionally on huge pages. JSD threads get fixed, prefaulted
+ * stacks and jsd_init(...) prefaults the caller's stack. After jsd_init(...)
+ * the calling thread must not allocate; builds with ENABLE_RT_MALLOC_CHECK
+ * abort when it does.
+ *
+ * @param config real-time memory options
+ * @return Pointer to new JSD context, NULL if the arena could not be mapped
+ */
+jsd_t* jsd_alloc_rt(jsd_memory_config_t config);
+
 /**
  * @brief Sets user provided configuration
  *
@@ -84,6 +98,60 @@ void jsd_free(jsd_t* self);
  */
 ec_state jsd_get_device_state(jsd_t* self, uint16_t slave_id);
 
+/**
+ * @brief Resolves a device handle for hot-path access
+ *
+ * Validates the slave once so that handle-based accessors can skip per-call
+ * checks. Must be called after jsd_init(...). Handles stay valid until
+ * jsd_free(...).
+ *
+ * @param self pointer to JSD context
+ * @param slave_id index of slave on the bus
+ * @param product_code expected product code of the slave
+ * @param device output handle
+ * @return true if the slave is configured and matches product_code
+ */
+bool jsd_get_device(jsd_t* self, uint16_t slave_id, uint32_t product_code,
+                    jsd_device_t* device);
+
+/**
+ * @brief Get the timestamps captured by the last jsd_read(...)
+ *
+ * Real-time safe. Prefer this over querying the clocks when timestamping data
+ * of the current cycle.
+ *
+ * @param self pointer to JSD context
+ * @return monotonic, realtime and DC stamps of the last frame reception
+ */
+jsd_cycle_time_t jsd_get_cycle_time(jsd_t* self);
+
+/**
+ * @brief Map a DC system time of this bus onto CLOCK_MONOTONIC
+ *
+ * Real-time safe. The correlation is refined every jsd_read(...), so DC stamps
+ * of several buses can be aligned on the host clock.
+ *
+ * @param self pointer to JSD context
+ * @param dc_nsec DC system time, ns since 2000-01-01
+ * @param mono_nsec output monotonic time, ns
+ * @return true if the bus has DC and a correlation is established
+ */
+bool jsd_dc_time_to_mono_time_nsec(jsd_t* self, int64_t dc_nsec,
+                                   int64_t* mono_nsec);
+
+/**
+ * @brief Map a DC system time of this bus onto CLOCK_REALTIME
+ *
+ * Real-time safe
+ *
+ * @param self pointer to JSD context
+ * @param dc_nsec DC system time, ns since 2000-01-01
+ * @param real_nsec output realtime, ns since Unix Epoch
+ * @return true if the bus has DC and a correlation is established
+ */
+bool jsd_dc_time_to_real_time_nsec(jsd_t* self, int64_t dc_nsec,
+                                   int64_t* real_nsec);
+
 /**
  * @brief Attempt one-time manual bus recovery.
  * May be useful for expected hot-swaps or bus topology changes
@@ -0,0 +1,289 @@
+#include "jsd/jsd_reconfig.h"
+
+#include <assert.h>
+#include <string.h>
+
+#include "jsd/jsd_metrics.h"
+#include "jsd/jsd_print.h"
+#include "jsd/jsd_sdo.h"
+#include "jsd/jsd_time.h"
+
+// A Complete Access read returns the whole object, entries not written
+// included
+#define JSD_RECONFIG_READ_BYTES (512)
+
+// Store and restore parameters are commands, they never read back what was
+// written and restoring the defaults would reset every other object again
+#define JSD_RECONFIG_STORE_SDO (0x1010)
+#define JSD_RECONFIG_RESTORE_SDO (0x1011)
+
+static const char* jsd_reconfig_path_names[JSD_NUM_RECONFIG_PATHS] = {
+    "none", "verified", "reapplied", "full", "failed"};
+
+/****************************************************
+ * Remembered writes
+ ****************************************************/
+
+void jsd_reconfig_begin(jsd_t* self) {
+  assert(self);
+  jsd_reconfig_t* reconfig = &self->reconfig;
+
+  reconfig->num_writes = 0;
+  memset(reconfig->incomplete, 0, sizeof(reconfig->incomplete));
+  memset(reconfig->full_hooks, 0, sizeof(reconfig->full_hooks));
+  memset(reconfig->paths, 0, sizeof(reconfig->paths));
+  pthread_mutex_lock(&reconfig->stats_mutex);
+  memset(reconfig->stats, 0, sizeof(reconfig->stats));
+  pthread_mutex_unlock(&reconfig->stats_mutex);
+  reconfig->recording = true;
+}
+
+void jsd_reconfig_record_write(jsd_t* self, uint16_t slave_id, uint16_t index,
+                               uint8_t subindex, bool complete_access,
+                               jsd_sdo_data_type_t data_type, int size,
+                               const void* data) {
+  assert(self);
+  jsd_reconfig_t* reconfig = &self->reconfig;
+  if (!reconfig->recording || slave_id >= EC_MAXSLAVE ||
+      index == JSD_RECONFIG_STORE_SDO || index == JSD_RECONFIG_RESTORE_SDO) {
+    return;
+  }
+  if (size <= 0 || size > JSD_RECONFIG_MAX_WRITE_BYTES ||
+      reconfig->num_writes >= JSD_RECONFIG_MAX_WRITES) {
+    if (!reconfig->incomplete[slave_id]) {
+      MSG_DEBUG("Slave[%u] 0x%X:%d not remembered, recovery runs the full hook",
+                slave_id, index, subindex);
+    }
+    reconfig->incomplete[slave_id] = true;
+    return;
+  }
+
+  jsd_reconfig_write_t* write = &reconfig->writes[reconfig->num_writes++];
+  write->slave_id             = slave_id;
+  write->index                = index;
+  write->subindex             = subindex;
+  write->complete_access      = complete_access;
+  write->data_type            = data_type;
+  write->size                 = size;
+  memcpy(write->data, data, size);
+}
+
+static uint16_t jsd_reconfig_find_writes(jsd_t* self, uint16_t slave_id,
+                                         uint16_t* writes) {
+  uint16_t num_writes = 0;
+  uint16_t i;
+  for (i = 0; i < self->reconfig.num_writes; ++i) {
+    if (self->reconfig.writes[i].slave_id == slave_id) {
+      writes[num_writes++] = i;
+    }
+  }
+  return num_writes;
+}
+
+void jsd_reconfig_end(jsd_t* self) {
+  assert(self);
+  jsd_reconfig_t* reconfig = &self->reconfig;
+  uint16_t        writes[JSD_RECONFIG_MAX_WRITES];
+  uint16_t        slave_id;
+
+  reconfig->recording = false;
+  if (reconfig->disabled) {
+    return;
+  }
+  for (slave_id = 1; slave_id <= *self->ecx_context.slavecount; ++slave_id) {
+    ec_slavet*          slave  = &self->ecx_context.slavelist[slave_id];
+    jsd_slave_config_t* config = &self->slave_configs[slave_id];
+    if (!config->configuration_active || !config->PO2SO_success ||
+        reconfig->incomplete[slave_id] || slave->PO2SOconfigx == NULL ||
+        slave->PO2SOconfigx == jsd_reconfig_PO2SO ||
+        jsd_reconfig_find_writes(self, slave_id, writes) == 0) {
+      continue;
+    }
+    reconfig->full_hooks[slave_id] = slave->PO2SOconfigx;
+    slave->PO2SOconfigx            = jsd_reconfig_PO2SO;
+  }
+}
+
+/****************************************************
+ * Fast reconfiguration
+ ****************************************************/
+
+// Compares an object with the last value written to it
+static bool jsd_reconfig_read_back(jsd_t* self, jsd_reconfig_write_t* write) {
+  uint8_t data[JSD_RECONFIG_READ_BYTES];
+
+  if (write->complete_access) {
+    int size = sizeof(data);
+    return jsd_sdo_get_ca_param_blocking(&self->ecx_context, write->slave_id,
+                                         write->index, write->subindex, &size,
+                                         data) &&
+           size >= write->size && memcmp(data, write->data, write->size) == 0;
+  }
+  return jsd_sdo_get_param_blocking(&self->ecx_context, write->slave_id,
+                                    write->index, write->subindex,
+                                    write->data_type, data) &&
+         memcmp(data, write->data, write->size) == 0;
+}
+
+static bool jsd_reconfig_rewrite(jsd_t* self, jsd_reconfig_write_t* write) {
+  if (write->complete_access) {
+    return jsd_sdo_set_ca_param_blocking(&self->ecx_context, write->slave_id,
+                                         write->index, write->subindex,
+                                         write->size, write->data);
+  }
+  return jsd_sdo_set_param_blocking(&self->ecx_context, write->slave_id,
+                                    write->index, write->subindex,
+                                    write->data_type, write->data);
+}
+
+// Earlier writes to the same object only matter while it is written again
+static bool jsd_reconfig_is_last(jsd_t* self, const uint16_t* writes,
+                                 uint16_t num_writes, uint16_t i) {
+  const jsd_reconfig_write_t* write = &self->reconfig.writes[writes[i]];
+  uint16_t                    j;
+  for (j = i + 1; j < num_writes; ++j) {
+    const jsd_reconfig_write_t* later = &self->reconfig.writes[writes[j]];
+    if (later->index == write->index && later->subindex == write->subindex &&
+        later->complete_access == write->complete_access) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static bool jsd_reconfig_is_dirty(const uint16_t* dirty, uint16_t num_dirty,
+                                  uint16_t index) {
+  uint16_t i;
+  for (i = 0; i < num_dirty; ++i) {
+    if (dirty[i] == index) {
+      return true;
+    }
+  }
+  return false;
+}
+
+int jsd_reconfig_PO2SO(ecx_contextt* ecx_context, uint16_t slave_id) {
+  jsd_t* self = jsd_metrics_get_context(ecx_context);
+  assert(self);
+  jsd_reconfig_t* reconfig = &self->reconfig;
+  uint16_t        writes[JSD_RECONFIG_MAX_WRITES];
+  uint16_t        dirty[JSD_RECONFIG_MAX_WRITES];
+  uint16_t        num_dirty  = 0;
+  uint16_t        num_writes = jsd_reconfig_find_writes(self, slave_id, writes);
+  uint16_t        i;
+
+  reconfig->reads[slave_id]    = 0;
+  reconfig->rewrites[slave_id] = 0;
+
+  // An index is written again as a whole, PDO mappings are written in steps
+  for (i = 0; i < num_writes; ++i) {
+    jsd_reconfig_write_t* write = &reconfig->writes[writes[i]];
+    if (jsd_reconfig_is_dirty(dirty, num_dirty, write->index) ||
+        !jsd_reconfig_is_last(self, writes, num_writes, i)) {
+      continue;
+    }
+    ++reconfig->reads[slave_id];
+    if (!jsd_reconfig_read_back(self, write)) {
+      dirty[num_dirty++] = write->index;
+    }
+  }
+  if (num_dirty == 0) {
+    reconfig->paths[slave_id] = JSD_RECONFIG_PATH_VERIFIED;
+    return 1;
+  }
+
+  for (i = 0; i < num_writes; ++i) {
+    jsd_reconfig_write_t* write = &reconfig->writes[writes[i]];
+    if (!jsd_reconfig_is_dirty(dirty, num_dirty, write->index)) {
+      continue;
+    }
+    ++reconfig->rewrites[slave_id];
+    if (!jsd_reconfig_rewrite(self, write)) {
+      goto full;
+    }
+  }
+
+  // A write may have reset objects that read back unchanged before
+  for (i = 0; i < num_writes; ++i) {
+    jsd_reconfig_write_t* write = &reconfig->writes[writes[i]];
+    if (jsd_reconfig_is_dirty(dirty, num_dirty, write->index) ||
+        !jsd_reconfig_is_last(self, writes, num_writes, i)) {
+      continue;
+    }
+    ++reconfig->reads[slave_id];
+    if (!jsd_reconfig_read_back(self, write)) {
+      goto full;
+    }
+  }
+  reconfig->paths[slave_id] = JSD_RECONFIG_PATH_REAPPLIED;
+  return 1;
+
+full:
+  WARNING("Slave[%u] fast reconfiguration failed, running its PO2SO hook",
+          slave_id);
+  reconfig->paths[slave_id] = JSD_RECONFIG_PATH_FULL;
+  return reconfig->full_hooks[slave_id](ecx_context, slave_id);
+}
+
+int jsd_reconfig_slave(jsd_t* self, uint16_t slave_id, int timeout) {
+  assert(self);
+  assert(slave_id < EC_MAXSLAVE);
+  jsd_reconfig_t* reconfig = &self->reconfig;
+
+  reconfig->paths[slave_id]    = JSD_RECONFIG_PATH_NONE;
+  reconfig->reads[slave_id]    = 0;
+  reconfig->rewrites[slave_id] = 0;
+
+  int64_t start_nsec    = jsd_time_get_mono_time_nsec();
+  int     state         = ecx_reconfig_slave(&self->ecx_context, slave_id,
+                                             timeout);
+  int64_t duration_nsec = jsd_time_get_mono_time_nsec() - start_nsec;
+
+  // Slaves without remembered writes ran the hook of their device
+  jsd_reconfig_path_t path = reconfig->paths[slave_id];
+  if (!state) {
+    path = JSD_RECONFIG_PATH_FAILED;
+  } else if (path == JSD_RECONFIG_PATH_NONE) {
+    path = JSD_RECONFIG_PATH_FULL;
+  }
+
+  pthread_mutex_lock(&reconfig->stats_mutex);
+  jsd_reconfig_stats_t* stats = &reconfig->stats[slave_id];
+  ++stats->reconfigs[path];
+  stats->last_path          = path;
+  stats->last_reads         = reconfig->reads[slave_id];
+  stats->last_writes        = reconfig->rewrites[slave_id];
+  stats->last_duration_nsec = duration_nsec;
+  if (duration_nsec > stats->max_duration_nsec) {
+    stats->max_duration_nsec = duration_nsec;
+  }
+  pthread_mutex_unlock(&reconfig->stats_mutex);
+  jsd_metrics_record_reconfig(self, duration_nsec);
+  return state;
+}
+
+/****************************************************
+ * Public functions
+ ****************************************************/
+
+void jsd_reconfig_enable(jsd_t* self, bool enable) {
+  assert(self);
+  assert(!self->init_complete);
+  self->reconfig.disabled = !enable;
+}
+
+jsd_reconfig_stats_t jsd_reconfig_get_stats(jsd_t* self, uint16_t slave_id) {
+  assert(self);
+  assert(slave_id < EC_MAXSLAVE);
+  pthread_mutex_lock(&self->reconfig.stats_mutex);
+  jsd_reconfig_stats_t stats = self->reconfig.stats[slave_id];
+  pthread_mutex_unlock(&self->reconfig.stats_mutex);
+  return stats;
+}
+
+const char* jsd_reconfig_path_to_string(jsd_reconfig_path_t path) {
+  if (path >= JSD_NUM_RECONFIG_PATHS) {
+    return "unknown";
+  }
+  return jsd_reconfig_path_names[path];
+}
@@ -0,0 +1,70 @@
+#ifndef JSD_RECONFIG_H
+#define JSD_RECONFIG_H
+
+#include "jsd/jsd_reconfig_pub.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Forgets the remembered writes and starts remembering the blocking
+ * SDO writes of the PO2SO hooks
+ *
+ * @param self pointer to JSD context
+ */
+void jsd_reconfig_begin(jsd_t* self);
+
+/**
+ * @brief Stops remembering writes and replaces the PO2SO hook of every
+ * configured slave with remembered writes by the fast reconfiguration
+ *
+ * @param self pointer to JSD context
+ */
+void jsd_reconfig_end(jsd_t* self);
+
+/**
+ * @brief Remembers a successful blocking SDO write while jsd_init(...) runs
+ * the PO2SO hooks
+ *
+ * Writes to the store and restore parameters commands are not remembered.
+ *
+ * @param self pointer to JSD context
+ * @param slave_id slave_id of the device
+ * @param index CoE object index
+ * @param subindex CoE object subindex
+ * @param complete_access true if the object was written by Complete Access
+ * @param data_type type of the object, unused with complete_access
+ * @param size bytes written
+ * @param data bytes written
+ */
+void jsd_reconfig_record_write(jsd_t* self, uint16_t slave_id, uint16_t index,
+                               uint8_t subindex, bool complete_access,
+                               jsd_sdo_data_type_t data_type, int size,
+                               const void* data);
+
+/**
+ * @brief Fast PO2SO hook installed by jsd_reconfig_end(...)
+ *
+ * @param ecx_context SOEM context of a JSD context
+ * @param slave_id slave_id of the device
+ * @return 1 if the slave is configured, like the PO2SO hooks
+ */
+int jsd_reconfig_PO2SO(ecx_contextt* ecx_context, uint16_t slave_id);
+
+/**
+ * @brief Reconfigures a slave with ecx_reconfig_slave(...) and records the
+ * path it took and its duration
+ *
+ * @param self pointer to JSD context
+ * @param slave_id slave_id of the device
+ * @param timeout SOEM timeout of the state changes in us
+ * @return state returned by ecx_reconfig_slave(...)
+ */
+int jsd_reconfig_slave(jsd_t* self, uint16_t slave_id, int timeout);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
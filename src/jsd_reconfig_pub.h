@@ -0,0 +1,50 @@
+#ifndef JSD_RECONFIG_PUB_H
+#define JSD_RECONFIG_PUB_H
+
+#include "jsd/jsd_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Enables the fast reconfiguration of recovered slaves, on by default
+ *
+ * jsd_init(...) remembers the blocking SDO writes of every PO2SO hook. When
+ * jsd_ecatcheck(...) reconfigures a slave, the remembered objects are read
+ * back first, objects written with Complete Access by a Complete Access read.
+ * Only the objects that differ are written again, in their original order and
+ * with every other write to the same index. The slave runs its full PO2SO
+ * hook if it wrote more than JSD_RECONFIG_MAX_WRITE_BYTES at once, if the
+ * writes did not fit JSD_RECONFIG_MAX_WRITES, if a write fails or if an object
+ * still differs afterwards.
+ *
+ * Call before jsd_init(...).
+ *
+ * @param self pointer to JSD context
+ * @param enable false to always run the full PO2SO hook
+ */
+void jsd_reconfig_enable(jsd_t* self, bool enable);
+
+/**
+ * @brief Gets the reconfigurations of a slave by jsd_ecatcheck(...)
+ *
+ * @param self pointer to JSD context
+ * @param slave_id slave_id of the device
+ * @return counters and duration of the reconfigurations since jsd_init(...)
+ */
+jsd_reconfig_stats_t jsd_reconfig_get_stats(jsd_t* self, uint16_t slave_id);
+
+/**
+ * @brief Converts a reconfiguration path to a string
+ *
+ * @param path reconfiguration path
+ * @return name of the path
+ */
+const char* jsd_reconfig_path_to_string(jsd_reconfig_path_t path);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,471 @@
+#include "jsd/jsd_recorder.h"
+
+#include <assert.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "jsd/jsd.h"
+#include "jsd/jsd_print.h"
+
+#define JSD_RECORDER_MAGIC "JSDREC01"
+#define JSD_RECORDER_MAGIC_BYTES (8)
+#define JSD_RECORDER_HEADER_ALIGN (64)
+#define JSD_RECORDER_RECORD_ALIGN (8)
+
+/*
+ * File layout, all fields in host byte order:
+ *   jsd_recorder_header_t
+ *   jsd_recorder_slave_t[num_slaves + 1]  (index 0 is the master)
+ *   jsd_slave_config_t[num_slaves + 1]
+ *   padding up to header_bytes
+ *   capacity records of record_bytes: jsd_recorder_cycle_t + IOmap image
+ */
+typedef struct {
+  char     magic[JSD_RECORDER_MAGIC_BYTES];
+  uint32_t header_bytes;  ///< offset of the first record
+  uint32_t record_bytes;
+  uint32_t capacity;
+  uint32_t image_bytes;
+  uint32_t config_bytes;  ///< sizeof(jsd_slave_config_t) of the recorder
+  uint16_t num_slaves;
+  uint16_t reserved;
+  int32_t  expected_wkc;
+  uint64_t cycle_count;  ///< published after every record, atomic
+} jsd_recorder_header_t;
+
+typedef struct {
+  uint32_t eep_man;
+  uint32_t eep_id;
+  int32_t  output_offset;  ///< into the image, -1 without outputs
+  int32_t  input_offset;   ///< into the image, -1 without inputs
+  uint32_t Obytes;
+  uint32_t Ibytes;
+  uint16_t Obits;
+  uint16_t Ibits;
+  uint8_t  Ostartbit;
+  uint8_t  Istartbit;
+  uint8_t  reserved[2];
+} jsd_recorder_slave_t;
+
+typedef struct {
+  uint64_t cycle;
+  int64_t  mono_nsec;
+  int64_t  real_nsec;
+  int64_t  dc_nsec;
+  int32_t  wkc;
+  uint8_t  dc_valid;
+  uint8_t  reserved[3];
+} jsd_recorder_cycle_t;
+
+static size_t jsd_recorder_align(size_t bytes, size_t alignment) {
+  return (bytes + alignment - 1) / alignment * alignment;
+}
+
+static jsd_recorder_header_t* jsd_recorder_header(jsd_t* self) {
+  return (jsd_recorder_header_t*)self->recorder.map;
+}
+
+static jsd_recorder_slave_t* jsd_recorder_slaves(jsd_t* self) {
+  return (jsd_recorder_slave_t*)(self->recorder.map +
+                                 sizeof(jsd_recorder_header_t));
+}
+
+static jsd_slave_config_t* jsd_recorder_configs(jsd_t* self) {
+  uint16_t num_slaves = jsd_recorder_header(self)->num_slaves;
+  return (jsd_slave_config_t*)(jsd_recorder_slaves(self) + num_slaves + 1);
+}
+
+static uint8_t* jsd_recorder_slot(jsd_t* self, uint64_t cycle) {
+  jsd_recorder_t* rec = &self->recorder;
+  return rec->map + jsd_recorder_header(self)->header_bytes +
+         (size_t)(cycle % rec->capacity) * rec->record_bytes;
+}
+
+static int32_t jsd_recorder_offset(jsd_t* self, uint8_t* image,
+                                   uint32_t bytes) {
+  if (image == NULL || bytes == 0) {
+    return -1;
+  }
+  return image - (uint8_t*)self->IOmap;
+}
+
+static size_t jsd_recorder_headers_bytes(uint16_t num_slaves) {
+  return jsd_recorder_align(
+      sizeof(jsd_recorder_header_t) +
+          (num_slaves + 1) *
+              (sizeof(jsd_recorder_slave_t) + sizeof(jsd_slave_config_t)),
+      JSD_RECORDER_HEADER_ALIGN);
+}
+
+/****************************************************
+ * Recording
+ ****************************************************/
+
+bool jsd_recorder_start(jsd_t* self, const char* path, uint32_t capacity) {
+  assert(self);
+  assert(path);
+
+  if (!self->init_complete) {
+    ERROR("jsd_recorder_start(...) must be called after jsd_init(...)");
+    return false;
+  }
+  if (self->recorder.map) {
+    ERROR("A recording or replay is already open");
+    return false;
+  }
+  if (capacity == 0) {
+    ERROR("Recorder capacity must hold at least one cycle");
+    return false;
+  }
+
+  uint16_t   num_slaves = *self->ecx_context.slavecount;
+  ec_slavet* slaves     = self->ecx_context.slavelist;
+  uint32_t   image_bytes = 0;
+  uint16_t   slave_id;
+
+  // Store the IOmap up to the end of the last slave image
+  for (slave_id = 1; slave_id <= num_slaves; ++slave_id) {
+    ec_slavet* slave = &slaves[slave_id];
+    int32_t    offset;
+    offset = jsd_recorder_offset(self, slave->outputs, slave->Obytes);
+    if (offset >= 0 && offset + slave->Obytes > image_bytes) {
+      image_bytes = offset + slave->Obytes;
+    }
+    offset = jsd_recorder_offset(self, slave->inputs, slave->Ibytes);
+    if (offset >= 0 && offset + slave->Ibytes > image_bytes) {
+      image_bytes = offset + slave->Ibytes;
+    }
+  }
+
+  size_t header_bytes = jsd_recorder_headers_bytes(num_slaves);
+  size_t record_bytes =
+      jsd_recorder_align(sizeof(jsd_recorder_cycle_t) + image_bytes,
+                         JSD_RECORDER_RECORD_ALIGN);
+  size_t map_bytes = header_bytes + (size_t)capacity * record_bytes;
+
+  int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    ERROR("Could not create recording %s", path);
+    return false;
+  }
+  // Allocate the blocks up front so a full disk fails here, not in a cycle
+  if (posix_fallocate(fd, 0, map_bytes) != 0) {
+    ERROR("Could not allocate %zu bytes for recording %s", map_bytes, path);
+    close(fd);
+    return false;
+  }
+  uint8_t* map = mmap(NULL, map_bytes, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, fd, 0);
+  if (map == MAP_FAILED) {
+    ERROR("Could not map recording %s", path);
+    close(fd);
+    return false;
+  }
+  // Populate and lock the pages so a record never waits for a read from disk.
+  // This does not make recording fault free: once the kernel writes a page
+  // back, the next record into it takes a minor fault to dirty it again.
+  memset(map, 0, map_bytes);
+  if (mlock(map, map_bytes) != 0) {
+    WARNING("Could not lock recording %s in memory, it may be paged out", path);
+  }
+
+  self->recorder.fd           = fd;
+  self->recorder.map          = map;
+  self->recorder.map_bytes    = map_bytes;
+  self->recorder.replaying    = false;
+  self->recorder.capacity     = capacity;
+  self->recorder.image_bytes  = image_bytes;
+  self->recorder.record_bytes = record_bytes;
+  self->recorder.next         = 0;
+  self->recorder.end          = 0;
+
+  jsd_recorder_header_t* header = jsd_recorder_header(self);
+  memcpy(header->magic, JSD_RECORDER_MAGIC, JSD_RECORDER_MAGIC_BYTES);
+  header->header_bytes = header_bytes;
+  header->record_bytes = record_bytes;
+  header->capacity     = capacity;
+  header->image_bytes  = image_bytes;
+  header->config_bytes = sizeof(jsd_slave_config_t);
+  header->num_slaves   = num_slaves;
+  header->expected_wkc = self->expected_wkc;
+
+  jsd_recorder_slave_t* layout  = jsd_recorder_slaves(self);
+  jsd_slave_config_t*   configs = jsd_recorder_configs(self);
+  for (slave_id = 0; slave_id <= num_slaves; ++slave_id) {
+    ec_slavet* slave = &slaves[slave_id];
+    layout[slave_id].eep_man = slave->eep_man;
+    layout[slave_id].eep_id  = slave->eep_id;
+    layout[slave_id].output_offset =
+        jsd_recorder_offset(self, slave->outputs, slave->Obytes);
+    layout[slave_id].input_offset =
+        jsd_recorder_offset(self, slave->inputs, slave->Ibytes);
+    layout[slave_id].Obytes    = slave->Obytes;
+    layout[slave_id].Ibytes    = slave->Ibytes;
+    layout[slave_id].Obits     = slave->Obits;
+    layout[slave_id].Ibits     = slave->Ibits;
+    layout[slave_id].Ostartbit = slave->Ostartbit;
+    layout[slave_id].Istartbit = slave->Istartbit;
+    configs[slave_id]          = self->slave_configs[slave_id];
+  }
+
+  MSG("Recording %u cycles of %u IOmap bytes to %s", capacity, image_bytes,
+      path);
+  return true;
+}
+
+void jsd_recorder_record(jsd_t* self) {
+  assert(self);
+  jsd_recorder_t* rec = &self->recorder;
+
+  uint8_t*              slot  = jsd_recorder_slot(self, rec->next);
+  jsd_recorder_cycle_t* cycle = (jsd_recorder_cycle_t*)slot;
+
+  cycle->cycle     = rec->next;
+  cycle->mono_nsec = self->cycle_time.mono_nsec;
+  cycle->real_nsec = self->cycle_time.real_nsec;
+  cycle->dc_nsec   = self->cycle_time.dc_nsec;
+  cycle->wkc       = self->wkc;
+  cycle->dc_valid  = self->cycle_time.dc_valid;
+  memcpy(slot + sizeof(*cycle), self->IOmap, rec->image_bytes);
+
+  // Readers of the file only trust records below the published count
+  ++rec->next;
+  __atomic_store_n(&jsd_recorder_header(self)->cycle_count, rec->next,
+                   __ATOMIC_RELEASE);
+}
+
+void jsd_recorder_stop(jsd_t* self) {
+  assert(self);
+  jsd_recorder_t* rec = &self->recorder;
+  if (!rec->map) {
+    return;
+  }
+
+  if (!rec->replaying) {
+    msync(rec->map, rec->map_bytes, MS_ASYNC);
+    MSG("Recorded %lu cycles", (unsigned long)rec->next);
+  }
+  munmap(rec->map, rec->map_bytes);
+  close(rec->fd);
+  memset(rec, 0, sizeof(*rec));
+}
+
+uint64_t jsd_recorder_get_cycle_count(jsd_t* self) {
+  assert(self);
+  if (!self->recorder.map || self->recorder.replaying) {
+    return 0;
+  }
+  return self->recorder.next;
+}
+
+/****************************************************
+ * Replay
+ ****************************************************/
+
+static bool jsd_replay_validate_image(int32_t offset, uint32_t bytes,
+                                      uint32_t image_bytes) {
+  if (offset < 0) {
+    return offset == -1;
+  }
+  return (uint64_t)offset + bytes <= image_bytes;
+}
+
+static bool jsd_replay_validate(const jsd_recorder_header_t* header,
+                                size_t map_bytes) {
+  if (memcmp(header->magic, JSD_RECORDER_MAGIC, JSD_RECORDER_MAGIC_BYTES)) {
+    ERROR("Not a JSD recording");
+    return false;
+  }
+  if (header->config_bytes != sizeof(jsd_slave_config_t)) {
+    ERROR("Recording was made by an incompatible JSD build");
+    return false;
+  }
+  if (header->num_slaves >= EC_MAXSLAVE ||
+      header->image_bytes > JSD_IOMAP_BYTES || header->capacity == 0 ||
+      header->header_bytes < jsd_recorder_headers_bytes(header->num_slaves) ||
+      header->record_bytes <
+          sizeof(jsd_recorder_cycle_t) + header->image_bytes ||
+      header->header_bytes + (size_t)header->capacity * header->record_bytes >
+          map_bytes) {
+    ERROR("Recording is corrupted or truncated");
+    return false;
+  }
+
+  // Replay points the slaves into the IOmap at these offsets
+  const jsd_recorder_slave_t* layout =
+      (const jsd_recorder_slave_t*)((const uint8_t*)header +
+                                    sizeof(jsd_recorder_header_t));
+  uint16_t slave_id;
+  for (slave_id = 0; slave_id <= header->num_slaves; ++slave_id) {
+    if (!jsd_replay_validate_image(layout[slave_id].output_offset,
+                                   layout[slave_id].Obytes,
+                                   header->image_bytes) ||
+        !jsd_replay_validate_image(layout[slave_id].input_offset,
+                                   layout[slave_id].Ibytes,
+                                   header->image_bytes)) {
+      ERROR("Recording has a corrupted image layout for slave %u", slave_id);
+      return false;
+    }
+  }
+  return true;
+}
+
+bool jsd_replay_open(jsd_t* self, const char* path) {
+  assert(self);
+  assert(path);
+
+  if (self->init_complete || self->recorder.map) {
+    ERROR("jsd_replay_open(...) needs a context that is not initialized");
+    return false;
+  }
+
+  int fd = open(path, O_RDONLY);
+  if (fd < 0) {
+    ERROR("Could not open recording %s", path);
+    return false;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 ||
+      (size_t)st.st_size < sizeof(jsd_recorder_header_t)) {
+    ERROR("Recording %s is truncated", path);
+    close(fd);
+    return false;
+  }
+  size_t   map_bytes = st.st_size;
+  uint8_t* map = mmap(NULL, map_bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (map == MAP_FAILED) {
+    ERROR("Could not map recording %s", path);
+    close(fd);
+    return false;
+  }
+
+  jsd_recorder_header_t* header = (jsd_recorder_header_t*)map;
+  if (!jsd_replay_validate(header, map_bytes)) {
+    munmap(map, map_bytes);
+    close(fd);
+    return false;
+  }
+
+  uint64_t cycle_count =
+      __atomic_load_n(&header->cycle_count, __ATOMIC_ACQUIRE);
+
+  self->recorder.fd           = fd;
+  self->recorder.map          = map;
+  self->recorder.map_bytes    = map_bytes;
+  self->recorder.replaying    = true;
+  self->recorder.capacity     = header->capacity;
+  self->recorder.image_bytes  = header->image_bytes;
+  self->recorder.record_bytes = header->record_bytes;
+  self->recorder.next =
+      cycle_count > header->capacity ? cycle_count - header->capacity : 0;
+  self->recorder.end = cycle_count;
+
+  // Restore the bus as jsd_init(...) left it, pointing into our IOmap
+  uint16_t              num_slaves = header->num_slaves;
+  ec_slavet*            slaves     = self->ecx_context.slavelist;
+  jsd_recorder_slave_t* layout     = jsd_recorder_slaves(self);
+  jsd_slave_config_t*   configs    = jsd_recorder_configs(self);
+  uint8_t*              iomap      = (uint8_t*)self->IOmap;
+  uint16_t              slave_id;
+
+  memset(iomap, 0, sizeof(self->IOmap));
+  *self->ecx_context.slavecount = num_slaves;
+  for (slave_id = 0; slave_id <= num_slaves; ++slave_id) {
+    ec_slavet*            slave  = &slaves[slave_id];
+    jsd_recorder_slave_t* record = &layout[slave_id];
+    slave->eep_man   = record->eep_man;
+    slave->eep_id    = record->eep_id;
+    slave->Obytes    = record->Obytes;
+    slave->Ibytes    = record->Ibytes;
+    slave->Obits     = record->Obits;
+    slave->Ibits     = record->Ibits;
+    slave->Ostartbit = record->Ostartbit;
+    slave->Istartbit = record->Istartbit;
+    slave->outputs =
+        record->output_offset >= 0 ? iomap + record->output_offset : NULL;
+    slave->inputs =
+        record->input_offset >= 0 ? iomap + record->input_offset : NULL;
+    slave->state                  = EC_STATE_OPERATIONAL;
+    self->slave_configs[slave_id] = configs[slave_id];
+  }
+  self->expected_wkc = header->expected_wkc;
+
+  for (slave_id = 1; slave_id <= num_slaves; ++slave_id) {
+    if (self->slave_configs[slave_id].configuration_active &&
+        !jsd_init_single_device(self, slave_id)) {
+      ERROR("Could not init slave %u for replay", slave_id);
+      jsd_recorder_stop(self);
+      return false;
+    }
+  }
+
+  MSG("Replaying %u cycles of %u slaves from %s",
+      jsd_replay_get_num_cycles(self), num_slaves, path);
+  return true;
+}
+
+uint32_t jsd_replay_get_num_cycles(jsd_t* self) {
+  assert(self);
+  if (!self->recorder.replaying) {
+    return 0;
+  }
+  uint64_t count = jsd_recorder_header(self)->cycle_count;
+  return count < self->recorder.capacity ? count : self->recorder.capacity;
+}
+
+bool jsd_replay_step(jsd_t* self) {
+  assert(self);
+  jsd_recorder_t* rec = &self->recorder;
+  assert(rec->replaying);
+
+  if (rec->next >= rec->end) {
+    return false;
+  }
+
+  uint8_t*              slot  = jsd_recorder_slot(self, rec->next);
+  jsd_recorder_cycle_t* cycle = (jsd_recorder_cycle_t*)slot;
+  uint8_t*              image = slot + sizeof(*cycle);
+
+  // Outputs stay as the process functions of the previous cycle left them
+  jsd_recorder_slave_t* layout     = jsd_recorder_slaves(self);
+  uint16_t              num_slaves = jsd_recorder_header(self)->num_slaves;
+  uint16_t              slave_id;
+  for (slave_id = 1; slave_id <= num_slaves; ++slave_id) {
+    if (layout[slave_id].input_offset >= 0) {
+      memcpy(self->ecx_context.slavelist[slave_id].inputs,
+             image + layout[slave_id].input_offset, layout[slave_id].Ibytes);
+    }
+  }
+
+  self->last_wkc             = self->wkc;
+  self->wkc                  = cycle->wkc;
+  self->cycle_time.mono_nsec = cycle->mono_nsec;
+  self->cycle_time.real_nsec = cycle->real_nsec;
+  self->cycle_time.dc_nsec   = cycle->dc_nsec;
+  self->cycle_time.dc_valid  = cycle->dc_valid;
+
+  ++rec->next;
+  return true;
+}
+
+const uint8_t* jsd_replay_get_recorded_outputs(jsd_t* self,
+                                               uint16_t slave_id) {
+  assert(self);
+  jsd_recorder_t* rec = &self->recorder;
+  assert(rec->replaying);
+
+  // Nothing was stepped yet
+  uint64_t first = rec->end > rec->capacity ? rec->end - rec->capacity : 0;
+  if (slave_id > jsd_recorder_header(self)->num_slaves || rec->next == first) {
+    return NULL;
+  }
+  int32_t offset = jsd_recorder_slaves(self)[slave_id].output_offset;
+  if (offset < 0) {
+    return NULL;
+  }
+  return jsd_recorder_slot(self, rec->next - 1) +
+         sizeof(jsd_recorder_cycle_t) + offset;
+}
@@ -0,0 +1,21 @@
+#ifndef JSD_RECORDER_H
+#define JSD_RECORDER_H
+
+#include "jsd/jsd_recorder_pub.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Appends the current cycle to the recording, called by jsd_write(...)
+ *
+ * @param self pointer to JSD context with an active recording
+ */
+void jsd_recorder_record(jsd_t* self);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,98 @@
+#ifndef JSD_RECORDER_PUB_H
+#define JSD_RECORDER_PUB_H
+
+#include "jsd/jsd_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Starts recording every cycle's process image to a ring file
+ *
+ * Each jsd_write(...) appends the IOmap, i.e. the inputs of the preceding
+ * jsd_read(...) and the outputs just sent, with the working counter and the
+ * cycle time. The file is preallocated, memory-mapped and locked so recording
+ * costs a copy of the IOmap without a system call; the kernel writes it back,
+ * also when the process crashes. Once full, the oldest cycles are overwritten.
+ *
+ * The first write to a page after the kernel wrote it back takes a minor page
+ * fault, which may also wait for that writeback on filesystems that need
+ * stable pages. Record to a tmpfs such as /dev/shm when the cycle period
+ * cannot absorb that, and copy the file once recording stopped.
+ *
+ * The file also holds the bus layout and slave configurations, so it can be
+ * replayed without the bus, see jsd_replay_open(...). Must be called after
+ * jsd_init(...), stopped by jsd_recorder_stop(...) or jsd_free(...).
+ *
+ * @param self pointer to JSD context
+ * @param path recording file, created or truncated
+ * @param capacity number of most recent cycles kept
+ * @return true if recording started
+ */
+bool jsd_recorder_start(jsd_t* self, const char* path, uint32_t capacity);
+
+/**
+ * @brief Stops recording or replaying and closes the file
+ *
+ * @param self pointer to JSD context
+ */
+void jsd_recorder_stop(jsd_t* self);
+
+/**
+ * @brief Gets the number of cycles recorded since jsd_recorder_start(...)
+ *
+ * @param self pointer to JSD context
+ * @return recorded cycles, including those overwritten in the ring
+ */
+uint64_t jsd_recorder_get_cycle_count(jsd_t* self);
+
+/**
+ * @brief Sets up a JSD context from a recording instead of jsd_init(...)
+ *
+ * The slaves, their IOmap layout and configurations are restored and the
+ * configured devices are initialized offline, so their read and process
+ * functions run unchanged on the recorded inputs. No frame is ever sent.
+ *
+ * @param self pointer to a JSD context that is not initialized
+ * @param path recording file of the same JSD build
+ * @return true on success
+ */
+bool jsd_replay_open(jsd_t* self, const char* path);
+
+/**
+ * @brief Gets the number of cycles a replay holds
+ *
+ * @param self pointer to JSD context set up by jsd_replay_open(...)
+ * @return oldest to newest cycles still in the ring
+ */
+uint32_t jsd_replay_get_num_cycles(jsd_t* self);
+
+/**
+ * @brief Loads the next recorded cycle, in place of jsd_read(...)
+ *
+ * The recorded inputs, working counter and cycle time become current, the
+ * outputs are left to the device process functions.
+ *
+ * @param self pointer to JSD context set up by jsd_replay_open(...)
+ * @return false once all cycles were replayed
+ */
+bool jsd_replay_step(jsd_t* self);
+
+/**
+ * @brief Gets the outputs recorded for a slave in the current cycle
+ *
+ * Comparing them to the outputs produced during the replay shows where the
+ * replayed commands diverge from the recorded ones.
+ *
+ * @param self pointer to JSD context set up by jsd_replay_open(...)
+ * @param slave_id index of slave on the bus
+ * @return RxPDO image of the slave, NULL if it has no outputs
+ */
+const uint8_t* jsd_replay_get_recorded_outputs(jsd_t* self, uint16_t slave_id);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
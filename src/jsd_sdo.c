@@ -4,7 +4,11 @@
 #include <string.h>
 #include <unistd.h>
 
+#include "jsd/jsd_metrics.h"
 #include "jsd/jsd_print.h"
+#include "jsd/jsd_reconfig.h"
+#include "jsd/jsd_startup.h"
+#include "jsd/jsd_time.h"
 
 ///////////////////  ASYNC SDO /////////////////////////////
 
@@ -75,6 +79,37 @@ static bool queue_is_empty(jsd_sdo_req_cirq_t* self) {
   return self->r == self->w;
 }
 
+static uint32_t queue_depth(jsd_sdo_req_cirq_t* self) {
+  pthread_mutex_lock(&self->mutex);
+  uint32_t depth = (uint16_t)(self->w - self->r);
+  pthread_mutex_unlock(&self->mutex);
+  return depth;
+}
+
+// Counts a blocking transfer of a JSD context, if the SOEM context is one
+static void record_blocking_sdo(ecx_contextt* ecx_context, uint16_t slave_id,
+                                int wkc, int64_t start_nsec) {
+  jsd_t* jsd = jsd_metrics_get_context(ecx_context);
+  if (jsd) {
+    int64_t latency_nsec = jsd_time_get_mono_time_nsec() - start_nsec;
+    jsd_metrics_record_sdo(jsd, slave_id, wkc > 0, latency_nsec);
+    jsd_startup_record_sdo(jsd, slave_id, wkc > 0, latency_nsec);
+  }
+}
+
+// Remembers a write of a PO2SO hook for the fast reconfiguration
+static void record_config_write(ecx_contextt* ecx_context, uint16_t slave_id,
+                                uint16_t index, uint8_t subindex,
+                                bool complete_access,
+                                jsd_sdo_data_type_t data_type, int size,
+                                const void* data) {
+  jsd_t* jsd = jsd_metrics_get_context(ecx_context);
+  if (jsd && jsd->reconfig.recording) {
+    jsd_reconfig_record_write(jsd, slave_id, index, subindex, complete_access,
+                              data_type, size, data);
+  }
+}
+
 bool jsd_sdo_req_cirq_is_empty(jsd_sdo_req_cirq_t* self) {
   assert(self);
   bool val;
@@ -152,6 +187,10 @@ void* sdo_thread_loop(void* void_data) {
   unsigned int handled_errors = 0;
   struct timespec ts;
 
+  if (self->arena.base) {
+    jsd_memory_prefault_stack(JSD_MEMORY_THREAD_STACK_PREFAULT_BYTES);
+  }
+
   while (true) {
     pthread_mutex_lock(&self->jsd_sdo_req_cirq.mutex);
 
@@ -167,6 +206,8 @@ void* sdo_thread_loop(void* void_data) {
         return NULL;
       }
 
+      // Not while the hot-plug thread configures a slave
+      pthread_mutex_lock(&self->hotplug.config_mutex);
       ec_mbxbuft MbxIn;
       int sid;
       for (sid = 1; sid <= *self->ecx_context.slavecount; sid++) {
@@ -196,17 +237,29 @@ void* sdo_thread_loop(void* void_data) {
         // push it so it can be handled from main thread safety
         // TODO consider handling the other error types too
         if(err.Etype == EC_ERR_TYPE_EMERGENCY){
-          jsd_error_cirq_push(&self->slave_errors[err.Slave], err);
+          jsd_error_cirq_t* errors = &self->slave_errors[err.Slave];
+          jsd_error_cirq_push(errors, err);
+          jsd_metrics_record_emcy(self, err.Slave);
+
+          pthread_mutex_lock(&errors->mutex);
+          uint32_t depth = (uint16_t)(errors->w - errors->r);
+          pthread_mutex_unlock(&errors->mutex);
+          jsd_metrics_high_water(&self->metrics.bus.error_queue_high_water,
+                                 depth);
         }
       }
+      pthread_mutex_unlock(&self->hotplug.config_mutex);
       pthread_mutex_lock(&self->jsd_sdo_req_cirq.mutex);
     }
 
     // pop off the request for application handling
     jsd_sdo_req_t req = queue_pop(&self->jsd_sdo_req_cirq);
+    __atomic_store_n(&self->sdo_busy, true, __ATOMIC_RELAXED);
     pthread_mutex_unlock(&self->jsd_sdo_req_cirq.mutex);
 
     int param_size = jsd_sdo_data_type_size(req.data_type);
+    pthread_mutex_lock(&self->hotplug.config_mutex);
+    int64_t start_nsec = jsd_time_get_mono_time_nsec();
 
     switch(req.request_type){
         case JSD_SDO_REQ_TYPE_WRITE:
@@ -215,6 +268,8 @@ void* sdo_thread_loop(void* void_data) {
                              false,  // CA not used
                              param_size, (void*)&req.data, JSD_SDO_TIMEOUT);
              req.success = (req.wkc == 1);
+             jsd_metrics_record_sdo(self, req.slave_id, req.success,
+                 jsd_time_get_mono_time_nsec() - start_nsec);
 
              if(req.success){
                print_sdo_param(req.data_type, req.slave_id, req.sdo_index,
@@ -232,6 +287,8 @@ void* sdo_thread_loop(void* void_data) {
                             false,  // CA not used
                             &param_size, (void*)&req.data, JSD_SDO_TIMEOUT);
             req.success = (req.wkc == 1);
+            jsd_metrics_record_sdo(self, req.slave_id, req.success,
+                jsd_time_get_mono_time_nsec() - start_nsec);
 
             if(req.success){
               print_sdo_param(req.data_type, req.slave_id, req.sdo_index,
@@ -250,10 +307,14 @@ void* sdo_thread_loop(void* void_data) {
             break;
 
     }
+    pthread_mutex_unlock(&self->hotplug.config_mutex);
 
 
     // push to the response queue for application handling
     jsd_sdo_req_cirq_push(&self->jsd_sdo_res_cirq, req);
+    jsd_metrics_high_water(&self->metrics.bus.sdo_response_queue_high_water,
+                           queue_depth(&self->jsd_sdo_res_cirq));
+    __atomic_store_n(&self->sdo_busy, false, __ATOMIC_RELAXED);
   }
 }
 //////////////////////////
@@ -337,6 +398,8 @@ bool jsd_sdo_push_async_request(jsd_t* self, jsd_sdo_req_t* request)
     retval = false;
   }else{
     jsd_sdo_req_cirq_push(&self->jsd_sdo_req_cirq, *request);
+    jsd_metrics_high_water(&self->metrics.bus.sdo_request_queue_high_water,
+                           queue_depth(&self->jsd_sdo_req_cirq));
 
     pthread_cond_signal(&self->sdo_thread_cond);
 
@@ -375,14 +438,18 @@ bool jsd_sdo_set_param_blocking(ecx_contextt* ecx_context, uint16_t slave_id,
                                 jsd_sdo_data_type_t data_type, void* param_in) {
   assert(ecx_context);
 
-  int param_size = jsd_sdo_data_type_size(data_type);
+  int     param_size = jsd_sdo_data_type_size(data_type);
+  int64_t start_nsec = jsd_time_get_mono_time_nsec();
 
   int wkc = ecx_SDOwrite(ecx_context, slave_id, index, subindex, false,
                          param_size, param_in, JSD_SDO_TIMEOUT);
+  record_blocking_sdo(ecx_context, slave_id, wkc, start_nsec);
   if (wkc == 0) {
     WARNING("Slave[%d] Failed to write SDO: 0x%X:%d", slave_id, index, subindex);
     return false;
   }
+  record_config_write(ecx_context, slave_id, index, subindex, false, data_type,
+                      param_size, param_in);
 
   print_sdo_param(data_type, slave_id, index, subindex, param_in, "Wrote");
 
@@ -395,10 +462,12 @@ bool jsd_sdo_get_param_blocking(ecx_contextt* ecx_context, uint16_t slave_id,
                                 void*               param_out) {
   assert(ecx_context);
 
-  int param_size = jsd_sdo_data_type_size(data_type);
+  int     param_size = jsd_sdo_data_type_size(data_type);
+  int64_t start_nsec = jsd_time_get_mono_time_nsec();
 
   int wkc = ecx_SDOread(ecx_context, slave_id, index, subindex, false,
                         &param_size, param_out, JSD_SDO_TIMEOUT);
+  record_blocking_sdo(ecx_context, slave_id, wkc, start_nsec);
   if (wkc == 0) {
     WARNING("Slave[%d] Failed to read SDO: 0x%X:%d", slave_id, index, subindex);
     return false;
@@ -414,12 +483,16 @@ bool jsd_sdo_set_ca_param_blocking(ecx_contextt* ecx_context, uint16_t slave_id,
                                    int param_size, void* param_in) {
   assert(ecx_context);
 
+  int64_t start_nsec = jsd_time_get_mono_time_nsec();
   int wkc = ecx_SDOwrite(ecx_context, slave_id, index, subindex, true,
                          param_size, param_in, JSD_SDO_TIMEOUT);
+  record_blocking_sdo(ecx_context, slave_id, wkc, start_nsec);
   if (wkc == 0) {
     MSG_DEBUG("Slave[%d] Failed to write SDO: 0x%X:%d", slave_id, index, subindex);
     return false;
   }
+  record_config_write(ecx_context, slave_id, index, subindex, true,
+                      JSD_SDO_DATA_UNSPECIFIED, param_size, param_in);
   MSG_DEBUG("Slave[%d] Wrote 0x%X:%d register by Complete Access", slave_id, index,
       subindex);
   return true;
@@ -430,8 +503,10 @@ bool jsd_sdo_get_ca_param_blocking(ecx_contextt* ecx_context, uint16_t slave_id,
                                    int* param_size_in_out, void* param_out) {
   assert(ecx_context);
 
+  int64_t start_nsec = jsd_time_get_mono_time_nsec();
   int wkc = ecx_SDOread(ecx_context, slave_id, index, subindex, true,
                         param_size_in_out, param_out, JSD_SDO_TIMEOUT);
+  record_blocking_sdo(ecx_context, slave_id, wkc, start_nsec);
   if (wkc == 0) {
     WARNING("Slave[%d] Failed to read SDO: 0x%X:%d", slave_id, index, subindex);
     return false;
@@ -0,0 +1,195 @@
+#include "jsd/jsd_shm.h"
+
+#include <assert.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "jsd/jsd_print.h"
+
+// Attempts of a reader before giving up on a writer overwriting its slot
+#define JSD_SHM_READ_ATTEMPTS (16)
+
+/****************************************************
+ * Writer
+ ****************************************************/
+
+void jsd_shm_publish(jsd_t* self) {
+  assert(self);
+  jsd_shm_segment_t* segment = self->shm.segment;
+  uint64_t           gen     = segment->generation;  // single writer
+  jsd_shm_slot_t*    slot    = &segment->slots[(gen + 1) % 2];
+  ec_slavet*         slaves  = self->ecx_context.slavelist;
+
+  uint16_t num_slaves = (uint16_t)*self->ecx_context.slavecount;
+  if (num_slaves > EC_MAXSLAVE - 1) {
+    num_slaves = EC_MAXSLAVE - 1;
+  }
+
+  __atomic_store_n(&slot->seq, slot->seq + 1, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+
+  jsd_shm_snapshot_t* snapshot = &slot->snapshot;
+  snapshot->cycle              = self->shm.cycle++;
+  snapshot->cycle_time         = self->cycle_time;
+  snapshot->wkc                = self->wkc;
+  snapshot->expected_wkc       = self->expected_wkc;
+  snapshot->bus_state          = slaves[0].state;
+  snapshot->num_slaves         = num_slaves;
+  snapshot->init_complete      = self->init_complete;
+
+  uint16_t slave_id;
+  for (slave_id = 1; slave_id <= num_slaves; ++slave_id) {
+    jsd_shm_slave_t* slave = &snapshot->slaves[slave_id];
+    slave->product_code    = slaves[slave_id].eep_id;
+    slave->al_state        = slaves[slave_id].state;
+    slave->al_status_code  = slaves[slave_id].ALstatuscode;
+    memcpy(&slave->state, &self->slave_states[slave_id],
+           sizeof(jsd_slave_state_t));
+  }
+
+  __atomic_store_n(&slot->seq, slot->seq + 1, __ATOMIC_RELEASE);
+  __atomic_store_n(&segment->generation, gen + 1, __ATOMIC_RELEASE);
+}
+
+bool jsd_shm_start(jsd_t* self, const char* name) {
+  assert(self);
+  assert(name);
+  if (self->shm.segment) {
+    ERROR("Already publishing to shared memory %s", self->shm.name);
+    return false;
+  }
+
+  int fd = shm_open(name, O_CREAT | O_RDWR | O_TRUNC, 0644);
+  if (fd < 0) {
+    ERROR("Failed to create shared memory %s", name);
+    return false;
+  }
+  if (ftruncate(fd, sizeof(jsd_shm_segment_t)) != 0) {
+    ERROR("Failed to size shared memory %s", name);
+    close(fd);
+    shm_unlink(name);
+    return false;
+  }
+  void* map = mmap(NULL, sizeof(jsd_shm_segment_t), PROT_READ | PROT_WRITE,
+                   MAP_SHARED, fd, 0);
+  close(fd);
+  if (map == MAP_FAILED) {
+    ERROR("Failed to map shared memory %s", name);
+    shm_unlink(name);
+    return false;
+  }
+
+  // Touch every page now rather than in the cyclic loop
+  jsd_shm_segment_t* segment = (jsd_shm_segment_t*)map;
+  memset(segment, 0, sizeof(jsd_shm_segment_t));
+  segment->version        = JSD_SHM_VERSION;
+  segment->snapshot_bytes = sizeof(jsd_shm_snapshot_t);
+  segment->writer_pid     = getpid();
+  __atomic_store_n(&segment->magic, JSD_SHM_MAGIC, __ATOMIC_RELEASE);
+
+  snprintf(self->shm.name, JSD_NAME_LEN, "%s", name);
+  self->shm.cycle   = 0;
+  self->shm.segment = segment;
+
+  MSG("Publishing bus data to shared memory %s, %zu bytes", name,
+      sizeof(jsd_shm_segment_t));
+  return true;
+}
+
+void jsd_shm_stop(jsd_t* self) {
+  assert(self);
+  if (!self->shm.segment) {
+    return;
+  }
+  munmap(self->shm.segment, sizeof(jsd_shm_segment_t));
+  shm_unlink(self->shm.name);
+  self->shm.segment = NULL;
+}
+
+/****************************************************
+ * Reader
+ ****************************************************/
+
+bool jsd_shm_open(jsd_shm_reader_t* reader, const char* name) {
+  assert(reader);
+  assert(name);
+  reader->segment = NULL;
+
+  int fd = shm_open(name, O_RDONLY, 0);
+  if (fd < 0) {
+    ERROR("Failed to open shared memory %s", name);
+    return false;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(jsd_shm_segment_t)) {
+    ERROR("Shared memory %s is not a JSD segment", name);
+    close(fd);
+    return false;
+  }
+  void* map =
+      mmap(NULL, sizeof(jsd_shm_segment_t), PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (map == MAP_FAILED) {
+    ERROR("Failed to map shared memory %s", name);
+    return false;
+  }
+
+  const jsd_shm_segment_t* segment = (const jsd_shm_segment_t*)map;
+  if (__atomic_load_n(&segment->magic, __ATOMIC_ACQUIRE) != JSD_SHM_MAGIC ||
+      segment->version != JSD_SHM_VERSION ||
+      segment->snapshot_bytes != sizeof(jsd_shm_snapshot_t)) {
+    ERROR("Shared memory %s was published by an incompatible JSD", name);
+    munmap(map, sizeof(jsd_shm_segment_t));
+    return false;
+  }
+  reader->segment = segment;
+  return true;
+}
+
+bool jsd_shm_read(const jsd_shm_reader_t* reader,
+                  jsd_shm_snapshot_t*     snapshot) {
+  assert(reader);
+  assert(reader->segment);
+  assert(snapshot);
+  const jsd_shm_segment_t* segment = reader->segment;
+  int                      attempt;
+
+  for (attempt = 0; attempt < JSD_SHM_READ_ATTEMPTS; ++attempt) {
+    uint64_t gen = __atomic_load_n(&segment->generation, __ATOMIC_ACQUIRE);
+    if (gen == 0) {
+      return false;
+    }
+    const jsd_shm_slot_t* slot = &segment->slots[gen % 2];
+    uint64_t seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+    if (seq % 2) {
+      continue;
+    }
+
+    // The slave count is only trusted once the sequence validates the copy
+    memcpy(snapshot, &slot->snapshot, offsetof(jsd_shm_snapshot_t, slaves));
+    uint16_t num_slaves = snapshot->num_slaves;
+    if (num_slaves > EC_MAXSLAVE - 1) {
+      num_slaves = EC_MAXSLAVE - 1;
+    }
+    memcpy(&snapshot->slaves[1], &slot->snapshot.slaves[1],
+           num_slaves * sizeof(jsd_shm_slave_t));
+
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    if (__atomic_load_n(&slot->seq, __ATOMIC_RELAXED) == seq) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void jsd_shm_close(jsd_shm_reader_t* reader) {
+  assert(reader);
+  if (!reader->segment) {
+    return;
+  }
+  munmap((void*)reader->segment, sizeof(jsd_shm_segment_t));
+  reader->segment = NULL;
+}
@@ -0,0 +1,21 @@
+#ifndef JSD_SHM_H
+#define JSD_SHM_H
+
+#include "jsd/jsd_shm_pub.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Publishes the cycle to the segment, called by jsd_write(...)
+ *
+ * @param self pointer to JSD context publishing to a segment
+ */
+void jsd_shm_publish(jsd_t* self);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
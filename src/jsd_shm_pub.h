@@ -0,0 +1,67 @@
+#ifndef JSD_SHM_PUB_H
+#define JSD_SHM_PUB_H
+
+#include "jsd/jsd_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Starts publishing the bus data to a POSIX shared-memory segment
+ *
+ * Every jsd_write(...) copies the device states, the working counter, the AL
+ * states and the cycle stamps of the bus into the segment, without locks or
+ * system calls. Any number of processes open it with jsd_shm_open(...) and
+ * read consistent snapshots with jsd_shm_read(...), without perturbing the
+ * cyclic loop. The segment is removed by jsd_shm_stop(...) or jsd_free(...),
+ * open readers keep their mapping.
+ *
+ * @param self pointer to JSD context
+ * @param name segment name, e.g. "/jsd_robot"
+ * @return true if the segment was created
+ */
+bool jsd_shm_start(jsd_t* self, const char* name);
+
+/**
+ * @brief Stops publishing and removes the segment
+ *
+ * @param self pointer to JSD context
+ */
+void jsd_shm_stop(jsd_t* self);
+
+/**
+ * @brief Maps a segment published by jsd_shm_start(...), read-only
+ *
+ * @param reader reader to open
+ * @param name segment name
+ * @return false if the segment does not exist or was published by an
+ *         incompatible build of JSD
+ */
+bool jsd_shm_open(jsd_shm_reader_t* reader, const char* name);
+
+/**
+ * @brief Copies the latest snapshot of the segment
+ *
+ * Lock-free; only slaves 1 to snapshot->num_slaves are copied.
+ *
+ * @param reader open reader
+ * @param snapshot copy of the latest snapshot
+ * @return false if nothing was published yet or the writer kept overwriting
+ *         the snapshot during the copy
+ */
+bool jsd_shm_read(const jsd_shm_reader_t* reader,
+                  jsd_shm_snapshot_t*     snapshot);
+
+/**
+ * @brief Unmaps the segment
+ *
+ * @param reader open reader
+ */
+void jsd_shm_close(jsd_shm_reader_t* reader);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
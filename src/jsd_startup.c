@@ -0,0 +1,181 @@
+#include "jsd/jsd_startup.h"
+
+#include <assert.h>
+#include <string.h>
+
+#include "jsd/jsd_metrics.h"
+#include "jsd/jsd_print.h"
+#include "jsd/jsd_time.h"
+
+static const char* jsd_init_phase_names[JSD_NUM_INIT_PHASES] = {
+    "open",    "config_init", "devices",     "map",
+    "safe_op", "config_dc",   "operational", "threads"};
+
+/****************************************************
+ * Phases
+ ****************************************************/
+
+void jsd_startup_begin(jsd_t* self) {
+  assert(self);
+  jsd_startup_t* startup = &self->startup;
+
+  memset(&startup->report, 0, sizeof(startup->report));
+  memset(startup->hooks, 0, sizeof(startup->hooks));
+  startup->report.start_mono_nsec = jsd_time_get_mono_time_nsec();
+  startup->mark_nsec              = startup->report.start_mono_nsec;
+  startup->recording              = true;
+}
+
+void jsd_startup_end_phase(jsd_t* self, jsd_init_phase_t phase) {
+  assert(self);
+  assert(phase < JSD_NUM_INIT_PHASES);
+  jsd_startup_t*     startup = &self->startup;
+  jsd_init_report_t* report  = &startup->report;
+  int64_t            now     = jsd_time_get_mono_time_nsec();
+
+  report->phase_nsec[phase] = now - startup->mark_nsec;
+  report->num_phases        = phase + 1;
+  report->total_nsec        = now - report->start_mono_nsec;
+  startup->mark_nsec        = now;
+  if (phase == JSD_INIT_PHASE_CONFIG_INIT) {
+    report->num_slaves = *self->ecx_context.slavecount;
+  }
+}
+
+void jsd_startup_end(jsd_t* self, bool success) {
+  assert(self);
+  jsd_startup_t*           startup = &self->startup;
+  const jsd_init_report_t* report  = &startup->report;
+  uint16_t                 slowest = 0;
+  uint16_t                 slave_id;
+
+  startup->recording      = false;
+  startup->report.success = success;
+  if (!success) {
+    return;
+  }
+  for (slave_id = 1; slave_id <= report->num_slaves; ++slave_id) {
+    if (report->slaves[slave_id].po2so_nsec >
+        report->slaves[slowest].po2so_nsec) {
+      slowest = slave_id;
+    }
+  }
+  if (slowest > 0) {
+    MSG("jsd_init took %.1f ms, slowest PO2SO hook slave[%u] %.1f ms",
+        (double)report->total_nsec / 1e6, slowest,
+        (double)report->slaves[slowest].po2so_nsec / 1e6);
+  } else {
+    MSG("jsd_init took %.1f ms", (double)report->total_nsec / 1e6);
+  }
+}
+
+/****************************************************
+ * Slaves
+ ****************************************************/
+
+static int jsd_startup_PO2SO(ecx_contextt* ecx_context, uint16_t slave_id) {
+  jsd_t* self = jsd_metrics_get_context(ecx_context);
+  assert(self);
+  jsd_startup_t* startup = &self->startup;
+
+  int64_t start_nsec = jsd_time_get_mono_time_nsec();
+  int     result     = startup->hooks[slave_id](ecx_context, slave_id);
+  startup->report.slaves[slave_id].po2so_nsec =
+      jsd_time_get_mono_time_nsec() - start_nsec;
+  return result;
+}
+
+void jsd_startup_wrap_hooks(jsd_t* self) {
+  assert(self);
+  uint16_t slave_id;
+  for (slave_id = 1; slave_id <= *self->ecx_context.slavecount; ++slave_id) {
+    ec_slavet* slave = &self->ecx_context.slavelist[slave_id];
+    if (slave->PO2SOconfigx && slave->PO2SOconfigx != jsd_startup_PO2SO) {
+      self->startup.hooks[slave_id] = slave->PO2SOconfigx;
+      slave->PO2SOconfigx           = jsd_startup_PO2SO;
+    }
+  }
+}
+
+void jsd_startup_unwrap_hooks(jsd_t* self) {
+  assert(self);
+  uint16_t slave_id;
+  for (slave_id = 1; slave_id <= *self->ecx_context.slavecount; ++slave_id) {
+    ec_slavet* slave = &self->ecx_context.slavelist[slave_id];
+    if (slave->PO2SOconfigx == jsd_startup_PO2SO) {
+      slave->PO2SOconfigx = self->startup.hooks[slave_id];
+    }
+  }
+}
+
+void jsd_startup_record_sdo(jsd_t* self, uint16_t slave_id, bool success,
+                            int64_t latency_nsec) {
+  assert(self);
+  if (!self->startup.recording || slave_id >= EC_MAXSLAVE) {
+    return;
+  }
+  jsd_init_slave_report_t* slave = &self->startup.report.slaves[slave_id];
+  ++slave->sdo_requests;
+  if (!success) {
+    ++slave->sdo_failures;
+  }
+  slave->sdo_nsec += latency_nsec;
+}
+
+void jsd_startup_record_op_attempt(jsd_t* self, uint32_t attempt, bool all) {
+  assert(self);
+  jsd_init_report_t* report = &self->startup.report;
+  uint16_t           slave_id;
+
+  report->op_attempts = attempt;
+  // The bus state check does not update the state of each slave
+  if (!all) {
+    ecx_readstate(&self->ecx_context);
+  }
+  for (slave_id = 1; slave_id <= *self->ecx_context.slavecount; ++slave_id) {
+    jsd_init_slave_report_t* slave = &report->slaves[slave_id];
+    if (slave->op_attempts == 0 &&
+        (all || self->ecx_context.slavelist[slave_id].state ==
+                    EC_STATE_OPERATIONAL)) {
+      slave->op_attempts = attempt;
+    }
+  }
+}
+
+/****************************************************
+ * Public functions
+ ****************************************************/
+
+const jsd_init_report_t* jsd_startup_get_report(jsd_t* self) {
+  assert(self);
+  return &self->startup.report;
+}
+
+void jsd_startup_print_report(jsd_t* self) {
+  assert(self);
+  const jsd_init_report_t* report = &self->startup.report;
+  uint16_t                 phase;
+  uint16_t                 slave_id;
+
+  MSG("jsd_init %s after %.1f ms, %u OP attempts",
+      report->success ? "succeeded" : "failed",
+      (double)report->total_nsec / 1e6, report->op_attempts);
+  for (phase = 0; phase < report->num_phases; ++phase) {
+    MSG("\t%-12s %10.1f ms", jsd_init_phase_to_string(phase),
+        (double)report->phase_nsec[phase] / 1e6);
+  }
+  for (slave_id = 1; slave_id <= report->num_slaves; ++slave_id) {
+    const jsd_init_slave_report_t* slave = &report->slaves[slave_id];
+    MSG("\tslave[%u] PO2SO %.1f ms, SDO %u (%u failed) %.1f ms, OP at %u",
+        slave_id, (double)slave->po2so_nsec / 1e6, slave->sdo_requests,
+        slave->sdo_failures, (double)slave->sdo_nsec / 1e6,
+        slave->op_attempts);
+  }
+}
+
+const char* jsd_init_phase_to_string(jsd_init_phase_t phase) {
+  if (phase >= JSD_NUM_INIT_PHASES) {
+    return "unknown";
+  }
+  return jsd_init_phase_names[phase];
+}
@@ -0,0 +1,71 @@
+#ifndef JSD_STARTUP_H
+#define JSD_STARTUP_H
+
+#include "jsd/jsd_startup_pub.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Clears the report and starts the first phase of jsd_init(...)
+ *
+ * @param self pointer to JSD context
+ */
+void jsd_startup_begin(jsd_t* self);
+
+/**
+ * @brief Ends a phase of jsd_init(...), the next one starts
+ *
+ * @param self pointer to JSD context
+ * @param phase phase that ended
+ */
+void jsd_startup_end_phase(jsd_t* self, jsd_init_phase_t phase);
+
+/**
+ * @brief Stops recording, called on every return of jsd_init(...)
+ *
+ * @param self pointer to JSD context
+ * @param success return value of jsd_init(...)
+ */
+void jsd_startup_end(jsd_t* self, bool success);
+
+/**
+ * @brief Wraps the PO2SO hooks of the slaves to time them
+ *
+ * @param self pointer to JSD context
+ */
+void jsd_startup_wrap_hooks(jsd_t* self);
+
+/**
+ * @brief Restores the PO2SO hooks wrapped by jsd_startup_wrap_hooks(...)
+ *
+ * @param self pointer to JSD context
+ */
+void jsd_startup_unwrap_hooks(jsd_t* self);
+
+/**
+ * @brief Counts a blocking SDO transfer while jsd_init(...) runs
+ *
+ * @param self pointer to JSD context
+ * @param slave_id slave addressed by the transfer
+ * @param success true if the slave answered
+ * @param latency_nsec duration of the transfer
+ */
+void jsd_startup_record_sdo(jsd_t* self, uint16_t slave_id, bool success,
+                            int64_t latency_nsec);
+
+/**
+ * @brief Records which slaves reached OP after an OP attempt
+ *
+ * @param self pointer to JSD context
+ * @param attempt number of the attempt, from 1
+ * @param all true if the whole bus reached OP
+ */
+void jsd_startup_record_op_attempt(jsd_t* self, uint32_t attempt, bool all);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,43 @@
+#ifndef JSD_STARTUP_PUB_H
+#define JSD_STARTUP_PUB_H
+
+#include "jsd/jsd_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Gets the timeline of the last jsd_init(...)
+ *
+ * The report holds the duration of every phase of jsd_init(...) and, per
+ * slave, the duration of its PO2SO hook, the blocking SDO transfers and
+ * failures of the whole initialization and the OP attempt that found it in
+ * OP. It is kept after a failed jsd_init(...), the phases after
+ * num_phases were not reached.
+ *
+ * @param self pointer to JSD context
+ * @return report, valid until the next jsd_init(...) or jsd_free(...)
+ */
+const jsd_init_report_t* jsd_startup_get_report(jsd_t* self);
+
+/**
+ * @brief Prints the timeline of the last jsd_init(...)
+ *
+ * @param self pointer to JSD context
+ */
+void jsd_startup_print_report(jsd_t* self);
+
+/**
+ * @brief Converts an initialization phase to a string
+ *
+ * @param phase initialization phase
+ * @return name of the phase
+ */
+const char* jsd_init_phase_to_string(jsd_init_phase_t phase);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
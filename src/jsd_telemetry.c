@@ -0,0 +1,703 @@
+#include "jsd/jsd_telemetry_pub.h"
+
+#include <assert.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "jsd/jsd_fields_pub.h"
+#include "jsd/jsd_memory.h"
+#include "jsd/jsd_print.h"
+#include "jsd/jsd_time.h"
+
+#define JSD_TELEMETRY_MAGIC "JSDTLM01"
+#define JSD_TELEMETRY_FLAG_COMPRESSED (0x1)
+
+// The writer polls the ring and flushes partial blocks after a second
+#define JSD_TELEMETRY_POLL_USEC (1000)
+#define JSD_TELEMETRY_FLUSH_NSEC (JSD_TIME_NSEC_PER_SEC)
+
+typedef struct {
+  char     magic[8];
+  uint32_t flags;
+  uint32_t num_columns;
+  uint32_t record_bytes;
+  uint32_t reserved;
+} jsd_telemetry_file_header_t;
+
+typedef struct {
+  char     name[JSD_TELEMETRY_NAME_LEN];
+  uint32_t type;
+  uint32_t offset;
+} jsd_telemetry_file_column_t;
+
+typedef struct {
+  uint32_t num_records;
+  uint32_t encoded_bytes;
+} jsd_telemetry_block_header_t;
+
+/****************************************************
+ * Block encoding
+ ****************************************************/
+
+// Transposes the records to columns. Compressed blocks store every value
+// XORed with the previous record, then replace zero runs with a zero byte and
+// the run length: slowly changing signals shrink to a few bytes per record.
+static uint32_t jsd_telemetry_encode_block(const jsd_telemetry_t* self,
+                                           uint32_t num_records) {
+  uint8_t* out = self->encoded;
+  uint8_t  zeros = 0;
+  uint32_t c, r, b;
+
+  for (c = 0; c < self->num_columns; ++c) {
+    const jsd_telemetry_column_t* column = &self->columns[c];
+    for (r = 0; r < num_records; ++r) {
+      const uint8_t* value =
+          &self->block[(size_t)r * self->record_bytes + column->offset];
+      if (!self->config.compress) {
+        memcpy(out, value, column->bytes);
+        out += column->bytes;
+        continue;
+      }
+      for (b = 0; b < column->bytes; ++b) {
+        uint8_t delta = value[b];
+        if (r > 0) {
+          delta ^= (value - self->record_bytes)[b];
+        }
+        if (delta == 0 && zeros < UINT8_MAX) {
+          ++zeros;
+          continue;
+        }
+        if (zeros > 0) {
+          *out++ = 0;
+          *out++ = zeros;
+          zeros  = 0;
+        }
+        if (delta == 0) {
+          zeros = 1;
+        } else {
+          *out++ = delta;
+        }
+      }
+    }
+  }
+  if (zeros > 0) {
+    *out++ = 0;
+    *out++ = zeros;
+  }
+  return (uint32_t)(out - self->encoded);
+}
+
+static bool jsd_telemetry_decode_block(const uint8_t* encoded,
+                                       uint32_t encoded_bytes, bool compressed,
+                                       const jsd_telemetry_file_column_t* cols,
+                                       const uint32_t* col_bytes,
+                                       uint32_t num_columns,
+                                       uint32_t record_bytes,
+                                       uint32_t num_records, uint8_t* records) {
+  size_t   block_bytes = (size_t)num_records * record_bytes;
+  uint8_t* columnar    = records + block_bytes;
+  size_t   in          = 0;
+  size_t   out         = 0;
+  uint32_t c, r, b;
+
+  if (!compressed) {
+    if (encoded_bytes != block_bytes) {
+      return false;
+    }
+    memcpy(columnar, encoded, block_bytes);
+  } else {
+    while (in < encoded_bytes) {
+      if (encoded[in] != 0) {
+        if (out >= block_bytes) {
+          return false;
+        }
+        columnar[out++] = encoded[in++];
+        continue;
+      }
+      if (in + 1 >= encoded_bytes || out + encoded[in + 1] > block_bytes) {
+        return false;
+      }
+      memset(&columnar[out], 0, encoded[in + 1]);
+      out += encoded[in + 1];
+      in += 2;
+    }
+    if (out != block_bytes) {
+      return false;
+    }
+  }
+
+  out = 0;
+  for (c = 0; c < num_columns; ++c) {
+    for (r = 0; r < num_records; ++r) {
+      uint8_t* value = &records[(size_t)r * record_bytes + cols[c].offset];
+      for (b = 0; b < col_bytes[c]; ++b) {
+        value[b] = columnar[out++];
+        if (compressed && r > 0) {
+          value[b] ^= (value - record_bytes)[b];
+        }
+      }
+    }
+  }
+  return true;
+}
+
+/****************************************************
+ * Writer thread
+ ****************************************************/
+
+static void jsd_telemetry_write_block(jsd_telemetry_t* self,
+                                      uint32_t         num_records) {
+  jsd_telemetry_block_header_t header;
+  header.num_records   = num_records;
+  header.encoded_bytes = jsd_telemetry_encode_block(self, num_records);
+
+  if (fwrite(&header, sizeof(header), 1, self->file) != 1 ||
+      fwrite(self->encoded, header.encoded_bytes, 1, self->file) != 1 ||
+      fflush(self->file) != 0) {
+    ERROR("Failed to write telemetry block");
+    return;
+  }
+  __atomic_store_n(&self->records_written,
+                   self->records_written + num_records, __ATOMIC_RELAXED);
+  __atomic_store_n(&self->bytes_written,
+                   self->bytes_written + sizeof(header) + header.encoded_bytes,
+                   __ATOMIC_RELAXED);
+}
+
+static void jsd_telemetry_free_buffers(jsd_telemetry_t* self) {
+  if (self->ring_arena.base) {
+    jsd_memory_arena_destroy(&self->ring_arena);
+    memset(&self->ring_arena, 0, sizeof(self->ring_arena));
+  } else {
+    free(self->ring);
+    free(self->block);
+    free(self->encoded);
+  }
+  self->ring    = NULL;
+  self->block   = NULL;
+  self->encoded = NULL;
+}
+
+// Opened by the writer thread, stdio allocates its buffers on the heap
+static bool jsd_telemetry_open_file(jsd_telemetry_t* self, const char* path) {
+  self->file = fopen(path, "wb");
+  if (!self->file) {
+    ERROR("Failed to open telemetry file %s", path);
+    return false;
+  }
+
+  jsd_telemetry_file_header_t header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, JSD_TELEMETRY_MAGIC, sizeof(header.magic));
+  header.num_columns  = self->num_columns;
+  header.record_bytes = self->record_bytes;
+  if (self->config.compress) {
+    header.flags = JSD_TELEMETRY_FLAG_COMPRESSED;
+  }
+
+  bool     success = fwrite(&header, sizeof(header), 1, self->file) == 1;
+  uint32_t c;
+  for (c = 0; success && c < self->num_columns; ++c) {
+    jsd_telemetry_file_column_t column;
+    memset(&column, 0, sizeof(column));
+    memcpy(column.name, self->columns[c].name, JSD_TELEMETRY_NAME_LEN);
+    column.type   = self->columns[c].type;
+    column.offset = self->columns[c].offset;
+    success       = fwrite(&column, sizeof(column), 1, self->file) == 1;
+  }
+  if (!success) {
+    ERROR("Failed to write telemetry header");
+    fclose(self->file);
+    self->file = NULL;
+  }
+  return success;
+}
+
+static void* jsd_telemetry_thread_loop(void* void_data) {
+  jsd_telemetry_t* self        = (jsd_telemetry_t*)void_data;
+  uint32_t         num_records = 0;
+  int64_t          block_nsec  = 0;
+
+  if (self->rt_memory) {
+    jsd_memory_prefault_stack(JSD_MEMORY_THREAD_STACK_PREFAULT_BYTES);
+  }
+  bool opened = jsd_telemetry_open_file(self, self->path);
+  __atomic_store_n(&self->ready, opened ? 1 : -1, __ATOMIC_RELEASE);
+  if (!opened) {
+    return NULL;
+  }
+
+  while (true) {
+    bool     stopping = __atomic_load_n(&self->join_flag, __ATOMIC_ACQUIRE);
+    uint64_t head     = __atomic_load_n(&self->head, __ATOMIC_ACQUIRE);
+    uint64_t tail     = self->tail;
+    bool     idle     = tail == head;
+
+    while (tail != head && num_records < self->config.block_records) {
+      if (num_records == 0) {
+        block_nsec = jsd_time_get_mono_time_nsec();
+      }
+      memcpy(&self->block[(size_t)num_records * self->record_bytes],
+             &self->ring[(tail % self->ring_records) * self->record_bytes],
+             self->record_bytes);
+      ++num_records;
+      ++tail;
+    }
+    __atomic_store_n(&self->tail, tail, __ATOMIC_RELEASE);
+
+    if (num_records == self->config.block_records ||
+        (num_records > 0 &&
+         (stopping || jsd_time_get_mono_time_nsec() - block_nsec >=
+                          JSD_TELEMETRY_FLUSH_NSEC))) {
+      jsd_telemetry_write_block(self, num_records);
+      num_records = 0;
+    }
+
+    if (stopping && tail == head && num_records == 0) {
+      break;
+    }
+    if (idle) {
+      usleep(JSD_TELEMETRY_POLL_USEC);
+    }
+  }
+  fclose(self->file);
+  self->file = NULL;
+  return NULL;
+}
+
+/****************************************************
+ * Public functions
+ ****************************************************/
+
+jsd_telemetry_t* jsd_telemetry_alloc() {
+  jsd_telemetry_t* self = (jsd_telemetry_t*)calloc(1, sizeof(jsd_telemetry_t));
+  assert(self);
+
+  jsd_telemetry_column_t* time = &self->columns[0];
+  snprintf(time->name, JSD_TELEMETRY_NAME_LEN, "time");
+  time->type          = JSD_FIELD_I64;
+  time->bytes         = sizeof(int64_t);
+  self->num_columns   = 1;
+  self->record_bytes  = time->bytes;
+  return self;
+}
+
+void jsd_telemetry_free(jsd_telemetry_t* self) {
+  if (self == NULL) {
+    return;
+  }
+  jsd_telemetry_stop(self);
+  free(self);
+}
+
+bool jsd_telemetry_add_columns(jsd_telemetry_t* self, const char* prefix,
+                               const void* source,
+                               const jsd_telemetry_field_t* fields,
+                               size_t num_fields) {
+  assert(self);
+  assert(source);
+  assert(!self->running);
+  size_t f, i;
+
+  for (f = 0; f < num_fields; ++f) {
+    size_t bytes = jsd_field_type_bytes(fields[f].type);
+    assert(fields[f].size >= bytes && fields[f].size % bytes == 0);
+    size_t count = fields[f].size / bytes;
+
+    for (i = 0; i < count; ++i) {
+      if (self->num_columns == JSD_TELEMETRY_MAX_COLUMNS) {
+        ERROR("Telemetry is limited to %d columns", JSD_TELEMETRY_MAX_COLUMNS);
+        return false;
+      }
+      jsd_telemetry_column_t* column = &self->columns[self->num_columns++];
+      if (count == 1) {
+        snprintf(column->name, JSD_TELEMETRY_NAME_LEN, "%s%s", prefix,
+                 fields[f].name);
+      } else {
+        snprintf(column->name, JSD_TELEMETRY_NAME_LEN, "%s%s_%zu", prefix,
+                 fields[f].name, i);
+      }
+      column->type   = fields[f].type;
+      column->source = (const uint8_t*)source + fields[f].offset + i * bytes;
+      column->offset = self->record_bytes;
+      column->bytes  = bytes;
+      self->record_bytes += bytes;
+    }
+  }
+  return true;
+}
+
+bool jsd_telemetry_add_state(jsd_telemetry_t* self, jsd_t* jsd,
+                             uint16_t slave_id, const char* prefix) {
+  assert(self);
+  assert(jsd);
+  const jsd_struct_desc_t* desc =
+      jsd_fields_get_state_desc(jsd->slave_configs[slave_id].product_code);
+  if (desc == NULL) {
+    ERROR("Slave %u (0x%08x) has no state descriptors", slave_id,
+          jsd->slave_configs[slave_id].product_code);
+    return false;
+  }
+
+  // The cyclic loop of a real-time context must not fault on the ring
+  self->rt_memory = self->rt_memory || jsd->arena.base != NULL;
+
+  // States are stable from jsd_alloc(...), they may be added before jsd_init
+  const uint8_t* state =
+      (const uint8_t*)&jsd->slave_states[slave_id] + desc->container_offset;
+  size_t f;
+  for (f = 0; f < desc->num_fields; ++f) {
+    jsd_telemetry_field_t field;
+    field.name   = desc->fields[f].name;
+    field.type   = desc->fields[f].type;
+    field.offset = desc->fields[f].offset;
+    field.size =
+        desc->fields[f].count * jsd_field_type_bytes(desc->fields[f].type);
+    if (!jsd_telemetry_add_columns(self, prefix, state, &field, 1)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool jsd_telemetry_start(jsd_telemetry_t* self, const char* path,
+                         jsd_telemetry_config_t config) {
+  assert(self);
+  assert(path);
+  if (self->running) {
+    ERROR("Telemetry already started");
+    return false;
+  }
+
+  if (config.ring_records == 0) {
+    config.ring_records = JSD_TELEMETRY_DEFAULT_RING_RECORDS;
+  }
+  if (config.block_records == 0) {
+    config.block_records = JSD_TELEMETRY_DEFAULT_BLOCK_RECORDS;
+  }
+  self->config       = config;
+  self->ring_records = config.ring_records;
+  self->head         = 0;
+  self->tail         = 0;
+  self->join_flag    = false;
+
+  self->records_dropped = 0;
+  self->records_written = 0;
+  self->bytes_written   = 0;
+
+  // Adjacent fields of a state are copied together by jsd_telemetry_push
+  uint32_t c;
+  self->num_spans = 0;
+  for (c = 1; c < self->num_columns; ++c) {
+    const jsd_telemetry_column_t* column = &self->columns[c];
+    if (self->num_spans > 0) {
+      jsd_telemetry_span_t* last = &self->spans[self->num_spans - 1];
+      if (column->source == last->source + last->bytes &&
+          column->offset == last->offset + last->bytes) {
+        last->bytes += column->bytes;
+        continue;
+      }
+    }
+    jsd_telemetry_span_t* span = &self->spans[self->num_spans++];
+    span->source = column->source;
+    span->offset = column->offset;
+    span->bytes  = column->bytes;
+  }
+
+  // jsd_telemetry_push(...) writes the ring from the cyclic loop, so its pages
+  // are made resident here rather than on the first lap. Worst case of the
+  // zero-run encoding: every other byte is a lone zero.
+  size_t ring_bytes    = (size_t)config.ring_records * self->record_bytes;
+  size_t block_bytes   = (size_t)config.block_records * self->record_bytes;
+  size_t encoded_bytes = 2 * block_bytes + 2;
+  if (self->rt_memory) {
+    // The context may already forbid heap allocations on this thread
+    if (jsd_memory_arena_create(&self->ring_arena,
+                                jsd_memory_arena_align(ring_bytes) +
+                                    jsd_memory_arena_align(block_bytes) +
+                                    jsd_memory_arena_align(encoded_bytes),
+                                false)) {
+      self->ring  = jsd_memory_arena_alloc(&self->ring_arena, ring_bytes);
+      self->block = jsd_memory_arena_alloc(&self->ring_arena, block_bytes);
+      self->encoded =
+          jsd_memory_arena_alloc(&self->ring_arena, encoded_bytes);
+    }
+  } else {
+    bool forbidden = jsd_memory_allow_malloc();
+    self->ring     = malloc(ring_bytes);
+    if (self->ring) {
+      memset(self->ring, 0, ring_bytes);
+    }
+    self->block   = malloc(block_bytes);
+    self->encoded = malloc(encoded_bytes);
+    jsd_memory_forbid_malloc(forbidden);
+  }
+  if (!self->ring || !self->block || !self->encoded) {
+    ERROR("Failed to allocate telemetry buffers for %s", path);
+    jsd_telemetry_free_buffers(self);
+    return false;
+  }
+
+  self->path  = path;
+  self->ready = 0;
+  if (0 != jsd_memory_thread_create(&self->thread, self->rt_memory,
+                                    jsd_telemetry_thread_loop, (void*)self)) {
+    ERROR("Failed to create telemetry writer thread");
+    jsd_telemetry_free_buffers(self);
+    return false;
+  }
+  while (__atomic_load_n(&self->ready, __ATOMIC_ACQUIRE) == 0) {
+    usleep(JSD_TELEMETRY_POLL_USEC);
+  }
+  self->path = NULL;
+  if (self->ready < 0) {
+    pthread_join(self->thread, NULL);
+    jsd_telemetry_free_buffers(self);
+    return false;
+  }
+  self->running = true;
+
+  MSG("Logging %u telemetry columns in %u copies, %u bytes per record, to %s",
+      self->num_columns, self->num_spans, self->record_bytes, path);
+  return true;
+}
+
+bool jsd_telemetry_push(jsd_telemetry_t* self) {
+  assert(self);
+  assert(self->running);
+
+  // Single producer: head is only written here
+  uint64_t head = self->head;
+  if (head - __atomic_load_n(&self->tail, __ATOMIC_ACQUIRE) >=
+      self->ring_records) {
+    __atomic_store_n(&self->records_dropped, self->records_dropped + 1,
+                     __ATOMIC_RELAXED);
+    return false;
+  }
+
+  uint8_t* record =
+      &self->ring[(head % self->ring_records) * self->record_bytes];
+  int64_t now_nsec = jsd_time_get_mono_time_nsec();
+  memcpy(record, &now_nsec, sizeof(now_nsec));
+
+  uint32_t s;
+  for (s = 0; s < self->num_spans; ++s) {
+    const jsd_telemetry_span_t* span = &self->spans[s];
+    memcpy(&record[span->offset], span->source, span->bytes);
+  }
+  __atomic_store_n(&self->head, head + 1, __ATOMIC_RELEASE);
+  return true;
+}
+
+void jsd_telemetry_stop(jsd_telemetry_t* self) {
+  assert(self);
+  if (!self->running) {
+    return;
+  }
+
+  __atomic_store_n(&self->join_flag, true, __ATOMIC_RELEASE);
+  pthread_join(self->thread, NULL);
+  self->running = false;
+  jsd_telemetry_free_buffers(self);
+
+  if (self->records_dropped > 0) {
+    WARNING("Telemetry dropped %" PRIu64 " records, the writer fell behind",
+            self->records_dropped);
+  }
+}
+
+jsd_telemetry_stats_t jsd_telemetry_get_stats(jsd_telemetry_t* self) {
+  assert(self);
+  jsd_telemetry_stats_t stats;
+  stats.records_pushed = __atomic_load_n(&self->head, __ATOMIC_ACQUIRE);
+  stats.records_dropped =
+      __atomic_load_n(&self->records_dropped, __ATOMIC_RELAXED);
+  stats.records_written =
+      __atomic_load_n(&self->records_written, __ATOMIC_RELAXED);
+  stats.bytes_written = __atomic_load_n(&self->bytes_written, __ATOMIC_RELAXED);
+  return stats;
+}
+
+/****************************************************
+ * CSV conversion
+ ****************************************************/
+
+static void jsd_telemetry_print_value(FILE* csv, jsd_field_type_t type,
+                                      const uint8_t* value) {
+  union {
+    uint8_t  u8;
+    uint16_t u16;
+    uint32_t u32;
+    uint64_t u64;
+    int8_t   i8;
+    int16_t  i16;
+    int32_t  i32;
+    int64_t  i64;
+    float    f32;
+    double   f64;
+    bool     b;
+  } v;
+  memcpy(&v, value, jsd_field_type_bytes(type));
+
+  switch (type) {
+    case JSD_FIELD_U8:
+      fprintf(csv, "%u", v.u8);
+      break;
+    case JSD_FIELD_U16:
+      fprintf(csv, "%u", v.u16);
+      break;
+    case JSD_FIELD_U32:
+      fprintf(csv, "%" PRIu32, v.u32);
+      break;
+    case JSD_FIELD_U64:
+      fprintf(csv, "%" PRIu64, v.u64);
+      break;
+    case JSD_FIELD_I8:
+      fprintf(csv, "%d", v.i8);
+      break;
+    case JSD_FIELD_I16:
+      fprintf(csv, "%d", v.i16);
+      break;
+    case JSD_FIELD_I32:
+      fprintf(csv, "%" PRId32, v.i32);
+      break;
+    case JSD_FIELD_I64:
+      fprintf(csv, "%" PRId64, v.i64);
+      break;
+    case JSD_FIELD_F32:
+      fprintf(csv, "%.9g", v.f32);
+      break;
+    case JSD_FIELD_F64:
+      fprintf(csv, "%.17g", v.f64);
+      break;
+    case JSD_FIELD_BOOL:
+      fprintf(csv, "%u", v.b ? 1 : 0);
+      break;
+    default:
+      break;
+  }
+}
+
+bool jsd_telemetry_to_csv(const char* path, FILE* csv) {
+  assert(path);
+  assert(csv);
+  FILE* file = fopen(path, "rb");
+  if (!file) {
+    ERROR("Failed to open telemetry file %s", path);
+    return false;
+  }
+
+  jsd_telemetry_file_header_t  header;
+  jsd_telemetry_file_column_t* columns   = NULL;
+  uint32_t*                    col_bytes = NULL;
+  uint8_t*                     encoded   = NULL;
+  uint8_t*                     records   = NULL;
+  bool                         complete  = false;
+  uint32_t                     c, r;
+
+  if (fread(&header, sizeof(header), 1, file) != 1 ||
+      memcmp(header.magic, JSD_TELEMETRY_MAGIC, sizeof(header.magic)) != 0 ||
+      header.num_columns == 0 ||
+      header.num_columns > JSD_TELEMETRY_MAX_COLUMNS) {
+    ERROR("%s is not a telemetry file", path);
+    goto done;
+  }
+
+  columns   = calloc(header.num_columns, sizeof(*columns));
+  col_bytes = calloc(header.num_columns, sizeof(*col_bytes));
+  assert(columns && col_bytes);
+  if (fread(columns, sizeof(*columns), header.num_columns, file) !=
+      header.num_columns) {
+    ERROR("Truncated telemetry header in %s", path);
+    goto done;
+  }
+  for (c = 0; c < header.num_columns; ++c) {
+    columns[c].name[JSD_TELEMETRY_NAME_LEN - 1] = '\0';
+    if (columns[c].type >= JSD_FIELD_NUM_TYPES ||
+        columns[c].offset + jsd_field_type_bytes(columns[c].type) >
+            header.record_bytes) {
+      ERROR("Invalid telemetry column %u in %s", c, path);
+      goto done;
+    }
+    col_bytes[c] = jsd_field_type_bytes(columns[c].type);
+  }
+  if (columns[0].type != JSD_FIELD_I64) {
+    ERROR("Invalid telemetry time column in %s", path);
+    goto done;
+  }
+
+  fprintf(csv, "rel_time_s, cycle_period_s");
+  for (c = 1; c < header.num_columns; ++c) {
+    fprintf(csv, ", %s", columns[c].name);
+  }
+  fprintf(csv, "\n");
+
+  bool    compressed = header.flags & JSD_TELEMETRY_FLAG_COMPRESSED;
+  bool    first      = true;
+  int64_t first_nsec = 0;
+  int64_t last_nsec  = 0;
+  size_t  capacity   = 0;
+
+  while (true) {
+    jsd_telemetry_block_header_t block;
+    if (fread(&block, sizeof(block), 1, file) != 1) {
+      complete = feof(file);
+      break;
+    }
+    size_t block_bytes = (size_t)block.num_records * header.record_bytes;
+    if (block.encoded_bytes > 2 * block_bytes + 2) {
+      ERROR("Corrupted telemetry block in %s", path);
+      break;
+    }
+    if (block_bytes > capacity) {
+      free(encoded);
+      free(records);
+      capacity = block_bytes;
+      encoded  = malloc(2 * capacity + 2);
+      records  = malloc(2 * capacity);  // rows, then the decoded columns
+      assert(encoded && records);
+    }
+    if (fread(encoded, 1, block.encoded_bytes, file) != block.encoded_bytes) {
+      WARNING("Truncated telemetry block at the end of %s", path);
+      break;
+    }
+    if (!jsd_telemetry_decode_block(encoded, block.encoded_bytes, compressed,
+                                    columns, col_bytes, header.num_columns,
+                                    header.record_bytes, block.num_records,
+                                    records)) {
+      ERROR("Corrupted telemetry block in %s", path);
+      break;
+    }
+
+    for (r = 0; r < block.num_records; ++r) {
+      const uint8_t* record = &records[(size_t)r * header.record_bytes];
+      int64_t        t_nsec;
+      memcpy(&t_nsec, &record[columns[0].offset], sizeof(t_nsec));
+      if (first) {
+        first_nsec = t_nsec;
+        last_nsec  = t_nsec;
+        first      = false;
+      }
+      fprintf(csv, "%.9f, %.9f",
+              (double)(t_nsec - first_nsec) / JSD_TIME_NSEC_PER_SEC,
+              (double)(t_nsec - last_nsec) / JSD_TIME_NSEC_PER_SEC);
+      last_nsec = t_nsec;
+      for (c = 1; c < header.num_columns; ++c) {
+        fprintf(csv, ", ");
+        jsd_telemetry_print_value(csv, columns[c].type,
+                                  &record[columns[c].offset]);
+      }
+      fprintf(csv, "\n");
+    }
+  }
+
+done:
+  free(columns);
+  free(col_bytes);
+  free(encoded);
+  free(records);
+  fclose(file);
+  return complete;
+}
@@ -0,0 +1,119 @@
+#ifndef JSD_TELEMETRY_PUB_H
+#define JSD_TELEMETRY_PUB_H
+
+#include "jsd/jsd_telemetry_types.h"
+#include "jsd/jsd_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Allocates a telemetry logger without columns
+ *
+ * The cyclic loop copies the registered columns into fixed-size binary
+ * records with jsd_telemetry_push(...), a ring hands them to a writer thread
+ * and the writer stores them in blocks of a columnar file. Nothing is
+ * formatted, flushed or allocated in the cyclic loop; the file is converted to
+ * CSV offline with jsd_telemetry_to_csv(...).
+ *
+ * @return pointer to the logger
+ */
+jsd_telemetry_t* jsd_telemetry_alloc();
+
+/**
+ * @brief Stops the logger if started and frees it
+ *
+ * @param self pointer to the logger
+ */
+void jsd_telemetry_free(jsd_telemetry_t* self);
+
+/**
+ * @brief Registers the fields of a struct as columns
+ *
+ * The struct must stay at the same address while the logger runs, like the
+ * states returned by jsd_*_get_state(...).
+ *
+ * @param self pointer to the logger, not started
+ * @param prefix prepended to the field names
+ * @param source struct holding the fields
+ * @param fields field descriptors
+ * @param num_fields number of descriptors
+ * @return true if all the columns were added
+ */
+bool jsd_telemetry_add_columns(jsd_telemetry_t* self, const char* prefix,
+                               const void* source,
+                               const jsd_telemetry_field_t* fields,
+                               size_t num_fields);
+
+/**
+ * @brief Registers the state of a configured slave as columns
+ *
+ * @param self pointer to the logger, not started
+ * @param jsd pointer to JSD context
+ * @param slave_id index of the slave
+ * @param prefix prepended to the field names
+ * @return false if the device has no telemetry descriptors
+ */
+bool jsd_telemetry_add_state(jsd_telemetry_t* self, jsd_t* jsd,
+                             uint16_t slave_id, const char* prefix);
+
+/**
+ * @brief Creates the file and starts the writer thread
+ *
+ * The ring is prefaulted here. Once a state of a jsd_alloc_rt(...) context was
+ * added, the ring and the writer buffers are one locked mapping and the writer
+ * thread gets a prefaulted stack, as the other JSD threads of that context.
+ * The file is opened by the writer thread, which returns only once it is.
+ *
+ * @param self pointer to the logger
+ * @param path telemetry file, created or truncated
+ * @param config ring and block sizes, compression
+ * @return true if the logger started
+ */
+bool jsd_telemetry_start(jsd_telemetry_t* self, const char* path,
+                         jsd_telemetry_config_t config);
+
+/**
+ * @brief Copies the columns into a record, called from the cyclic loop
+ *
+ * Lock-free and wait-free. The record is dropped and counted if the writer
+ * thread fell behind by the whole ring.
+ *
+ * @param self pointer to a started logger
+ * @return false if the record was dropped
+ */
+bool jsd_telemetry_push(jsd_telemetry_t* self);
+
+/**
+ * @brief Writes the pending records, stops the writer and closes the file
+ *
+ * @param self pointer to the logger
+ */
+void jsd_telemetry_stop(jsd_telemetry_t* self);
+
+/**
+ * @brief Gets the logger statistics
+ *
+ * @param self pointer to the logger
+ * @return statistics since jsd_telemetry_start(...)
+ */
+jsd_telemetry_stats_t jsd_telemetry_get_stats(jsd_telemetry_t* self);
+
+/**
+ * @brief Converts a telemetry file to CSV
+ *
+ * The first columns are rel_time_s, from the first record, and
+ * cycle_period_s, from the previous record.
+ *
+ * @param path telemetry file
+ * @param csv output stream
+ * @return true if the whole file was converted
+ */
+bool jsd_telemetry_to_csv(const char* path, FILE* csv);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
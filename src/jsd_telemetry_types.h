@@ -0,0 +1,111 @@
+#ifndef JSD_TELEMETRY_TYPES_H
+#define JSD_TELEMETRY_TYPES_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "jsd/jsd_fields_types.h"
+#include "jsd/jsd_memory.h"
+
+#define JSD_TELEMETRY_MAX_COLUMNS (512)
+#define JSD_TELEMETRY_NAME_LEN (64)
+
+/// Default records held between the cyclic loop and the writer thread
+#define JSD_TELEMETRY_DEFAULT_RING_RECORDS (8192)
+
+/// Default records per block of the file
+#define JSD_TELEMETRY_DEFAULT_BLOCK_RECORDS (1024)
+
+/**
+ * @brief Describes a field of a state struct, arrays included
+ *
+ * Arrays are logged as one column per element, suffixed with the index.
+ */
+typedef struct {
+  const char*      name;
+  jsd_field_type_t type;
+  size_t           offset;  ///< from the start of the struct
+  size_t           size;    ///< of the whole field
+} jsd_telemetry_field_t;
+
+/// Field descriptor of a member of a state struct
+#define JSD_TELEMETRY_FIELD(state_type, member, value_type)       \
+  {                                                               \
+    #member, JSD_FIELD_##value_type, offsetof(state_type, member), \
+        sizeof(((state_type*)0)->member)                          \
+  }
+
+typedef struct {
+  uint32_t ring_records;   ///< 0 for JSD_TELEMETRY_DEFAULT_RING_RECORDS
+  uint32_t block_records;  ///< 0 for JSD_TELEMETRY_DEFAULT_BLOCK_RECORDS
+  bool     compress;  ///< delta and zero-run encoding of the blocks
+} jsd_telemetry_config_t;
+
+typedef struct {
+  uint64_t records_pushed;
+  uint64_t records_dropped;  ///< the ring was full
+  uint64_t records_written;
+  uint64_t bytes_written;
+} jsd_telemetry_stats_t;
+
+typedef struct {
+  char             name[JSD_TELEMETRY_NAME_LEN];
+  jsd_field_type_t type;
+  const uint8_t*   source;  ///< value copied by jsd_telemetry_push(...)
+  uint32_t         offset;  ///< in the record
+  uint32_t         bytes;
+} jsd_telemetry_column_t;
+
+/// Columns whose sources are adjacent, copied by a single memcpy
+typedef struct {
+  const uint8_t* source;
+  uint32_t       offset;
+  uint32_t       bytes;
+} jsd_telemetry_span_t;
+
+/**
+ * @brief Binary telemetry logger
+ *
+ * Column 0 is the CLOCK_MONOTONIC time of the record.
+ */
+typedef struct {
+  jsd_telemetry_column_t columns[JSD_TELEMETRY_MAX_COLUMNS];
+  uint32_t               num_columns;
+  uint32_t               record_bytes;
+  jsd_telemetry_span_t   spans[JSD_TELEMETRY_MAX_COLUMNS];
+  uint32_t               num_spans;  ///< built by jsd_telemetry_start(...)
+
+  jsd_telemetry_config_t config;
+  uint8_t*               ring;
+  uint32_t               ring_records;
+  jsd_memory_arena_t     ring_arena;  ///< backs the ring in real-time mode
+  bool rt_memory;  ///< a state of a jsd_alloc_rt(...) context was added
+  uint64_t               head;  ///< records pushed, written by the cyclic loop
+  uint64_t               tail;  ///< records taken by the writer thread
+
+  FILE*       file;     ///< opened and closed by the writer thread
+  const char* path;     ///< read by the writer thread until it is ready
+  int         ready;    ///< atomic, 1 once the file is open, -1 on failure
+  uint8_t*    block;    ///< records being gathered by the writer
+  uint8_t*    encoded;  ///< columnar block written to the file
+  pthread_t   thread;
+  bool      running;
+  bool      join_flag;
+
+  uint64_t records_dropped;  ///< written by the cyclic loop
+  uint64_t records_written;  ///< written by the writer thread
+  uint64_t bytes_written;    ///< written by the writer thread
+} jsd_telemetry_t;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
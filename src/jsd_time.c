@@ -0,0 +1,223 @@
+#include "jsd/jsd_time.h"
+
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "jsd/jsd_print.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#include <x86intrin.h>
+#define JSD_TIME_HAS_TSC (1)
+#else
+#define JSD_TIME_HAS_TSC (0)
+#endif
+
+// ns per TSC tick is stored as a 32.32 fixed point multiplier
+#define JSD_TIME_TSC_SHIFT (32)
+
+// DC correlation loop gains. Host stamps lag the frame by a jittery latency, so
+// early samples pull the estimate harder than late ones.
+#define JSD_TIME_DC_GAIN_EARLY (0.5)
+#define JSD_TIME_DC_GAIN_LATE (1.0 / 1024.0)
+#define JSD_TIME_DC_GAIN_RATE (1.0 / 4096.0)  // relative to the offset gain
+
+// Bounds on the rate estimate. One early sample only nudges the rate, and
+// crystal oscillators stay well within a few hundred ppm of nominal.
+#define JSD_TIME_DC_MAX_RATE_STEP (1e-6)
+#define JSD_TIME_DC_MAX_RATE_ERROR (500e-6)
+
+// Resynchronize when the prediction error exceeds this, e.g. DC time jumped
+#define JSD_TIME_DC_RESYNC_NSEC (1000000LL)
+
+// The TSC rate error and NTP adjustments move CLOCK_REALTIME away from the fast
+// clock, SOEM stamps emergency messages from CLOCK_REALTIME
+#define JSD_TIME_REAL_RELATCH_NSEC (1000000000LL)
+
+typedef struct {
+  bool     enabled;
+  uint64_t tsc_base;
+  int64_t  mono_base_nsec;
+  int64_t  real_offset_nsec;  ///< CLOCK_REALTIME - fast clock, atomic
+  int64_t  real_latch_nsec;   ///< fast clock at the last latch, atomic
+  uint64_t mult;
+} jsd_time_fast_clock_t;
+
+static jsd_time_fast_clock_t jsd_time_fast_clock = {0};
+
+#if JSD_TIME_HAS_TSC
+static bool jsd_time_tsc_is_invariant() {
+  unsigned int eax, ebx, ecx, edx;
+  if (!__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx)) {
+    return false;
+  }
+  return (edx >> 8) & 0x01;
+}
+
+// Another core may read a TSC slightly before tsc_base, the delta is signed
+static inline int64_t jsd_time_tsc_to_mono_nsec(uint64_t tsc) {
+  int64_t  ticks = (int64_t)(tsc - jsd_time_fast_clock.tsc_base);
+  __int128 delta = (__int128)ticks * (__int128)jsd_time_fast_clock.mult;
+  return jsd_time_fast_clock.mono_base_nsec +
+         (int64_t)(delta >> JSD_TIME_TSC_SHIFT);
+}
+
+static void jsd_time_latch_real_offset(int64_t mono_nsec) {
+  int64_t offset = jsd_time_get_time_nsec() - mono_nsec;
+  __atomic_store_n(&jsd_time_fast_clock.real_offset_nsec, offset,
+                   __ATOMIC_RELAXED);
+  __atomic_store_n(&jsd_time_fast_clock.real_latch_nsec, mono_nsec,
+                   __ATOMIC_RELAXED);
+}
+#endif
+
+bool jsd_time_fast_clock_calibrate(uint32_t calibration_usec) {
+  jsd_time_fast_clock.enabled = false;
+
+#if JSD_TIME_HAS_TSC
+  if (!jsd_time_tsc_is_invariant()) {
+    WARNING("TSC is not invariant, fast clock falls back to clock_gettime");
+    return false;
+  }
+
+  // Bracket each clock_gettime call with TSC reads and use the midpoint
+  uint64_t tsc_a     = __rdtsc();
+  int64_t  mono_0    = jsd_time_get_mono_time_nsec();
+  uint64_t tsc_b     = __rdtsc();
+  uint64_t tsc_0     = tsc_a + (tsc_b - tsc_a) / 2;
+
+  usleep(calibration_usec);
+
+  tsc_a          = __rdtsc();
+  int64_t mono_1 = jsd_time_get_mono_time_nsec();
+  tsc_b          = __rdtsc();
+  uint64_t tsc_1 = tsc_a + (tsc_b - tsc_a) / 2;
+
+  if (tsc_1 <= tsc_0 || mono_1 <= mono_0) {
+    WARNING("TSC calibration failed, fast clock falls back to clock_gettime");
+    return false;
+  }
+
+  jsd_time_fast_clock.mult =
+      (uint64_t)(((unsigned __int128)(mono_1 - mono_0) << JSD_TIME_TSC_SHIFT) /
+                 (tsc_1 - tsc_0));
+  jsd_time_fast_clock.tsc_base       = tsc_1;
+  jsd_time_fast_clock.mono_base_nsec = mono_1;
+  jsd_time_latch_real_offset(jsd_time_tsc_to_mono_nsec(__rdtsc()));
+  jsd_time_fast_clock.enabled = true;
+
+  MSG("Fast clock calibrated: %.4lf ns per TSC tick",
+      (double)jsd_time_fast_clock.mult / (double)(1ULL << JSD_TIME_TSC_SHIFT));
+  return true;
+#else
+  (void)calibration_usec;
+  WARNING("No TSC on this platform, fast clock falls back to clock_gettime");
+  return false;
+#endif
+}
+
+void jsd_time_fast_clock_disable() { jsd_time_fast_clock.enabled = false; }
+
+bool jsd_time_fast_clock_enabled() { return jsd_time_fast_clock.enabled; }
+
+int64_t jsd_time_get_fast_mono_time_nsec() {
+#if JSD_TIME_HAS_TSC
+  if (jsd_time_fast_clock.enabled) {
+    return jsd_time_tsc_to_mono_nsec(__rdtsc());
+  }
+#endif
+  return jsd_time_get_mono_time_nsec();
+}
+
+void jsd_time_get_cycle_time(jsd_cycle_time_t* stamp) {
+#if JSD_TIME_HAS_TSC
+  if (jsd_time_fast_clock.enabled) {
+    stamp->mono_nsec = jsd_time_tsc_to_mono_nsec(__rdtsc());
+    int64_t latch_nsec =
+        __atomic_load_n(&jsd_time_fast_clock.real_latch_nsec, __ATOMIC_RELAXED);
+    if (stamp->mono_nsec - latch_nsec > JSD_TIME_REAL_RELATCH_NSEC) {
+      jsd_time_latch_real_offset(stamp->mono_nsec);
+    }
+    int64_t offset_nsec = __atomic_load_n(
+        &jsd_time_fast_clock.real_offset_nsec, __ATOMIC_RELAXED);
+    stamp->real_nsec = stamp->mono_nsec + offset_nsec;
+    return;
+  }
+#endif
+  stamp->mono_nsec = jsd_time_get_mono_time_nsec();
+  stamp->real_nsec = jsd_time_get_time_nsec();
+}
+
+static void jsd_time_dc_correlation_resync(jsd_time_dc_correlation_t* self,
+                                           const jsd_cycle_time_t*    stamp) {
+  self->valid          = true;
+  self->num_samples    = 1;
+  self->dc_base_nsec   = stamp->dc_nsec;
+  self->mono_base_nsec = stamp->mono_nsec;
+  self->rate           = 1.0;
+}
+
+void jsd_time_dc_correlation_reset(jsd_time_dc_correlation_t* self) {
+  assert(self);
+  *self = (jsd_time_dc_correlation_t){0};
+}
+
+void jsd_time_dc_correlation_update(jsd_time_dc_correlation_t* self,
+                                    const jsd_cycle_time_t*    stamp) {
+  assert(self);
+  assert(stamp);
+
+  if (!stamp->dc_valid) {
+    return;
+  }
+  self->real_offset_nsec = stamp->real_nsec - stamp->mono_nsec;
+
+  int64_t dt = stamp->dc_nsec - self->dc_base_nsec;
+  if (!self->valid || dt <= 0) {
+    jsd_time_dc_correlation_resync(self, stamp);
+    return;
+  }
+
+  int64_t predicted = self->mono_base_nsec + (int64_t)(self->rate * (double)dt);
+  int64_t err       = stamp->mono_nsec - predicted;
+  if (llabs(err) > JSD_TIME_DC_RESYNC_NSEC) {
+    jsd_time_dc_correlation_resync(self, stamp);
+    return;
+  }
+
+  double gain = err < 0 ? JSD_TIME_DC_GAIN_EARLY : JSD_TIME_DC_GAIN_LATE;
+  self->mono_base_nsec = predicted + (int64_t)(gain * (double)err);
+  double step = JSD_TIME_DC_GAIN_RATE * gain * (double)err / (double)dt;
+  step = fmin(fmax(step, -JSD_TIME_DC_MAX_RATE_STEP), JSD_TIME_DC_MAX_RATE_STEP);
+  self->rate = fmin(fmax(self->rate + step, 1.0 - JSD_TIME_DC_MAX_RATE_ERROR),
+                    1.0 + JSD_TIME_DC_MAX_RATE_ERROR);
+  self->dc_base_nsec = stamp->dc_nsec;
+  self->num_samples++;
+}
+
+bool jsd_time_dc_to_mono_nsec(const jsd_time_dc_correlation_t* self,
+                              int64_t dc_nsec, int64_t* mono_nsec) {
+  assert(self);
+  assert(mono_nsec);
+
+  if (!self->valid) {
+    return false;
+  }
+  *mono_nsec = self->mono_base_nsec +
+               (int64_t)(self->rate * (double)(dc_nsec - self->dc_base_nsec));
+  return true;
+}
+
+bool jsd_time_dc_to_real_nsec(const jsd_time_dc_correlation_t* self,
+                              int64_t dc_nsec, int64_t* real_nsec) {
+  assert(real_nsec);
+
+  int64_t mono_nsec;
+  if (!jsd_time_dc_to_mono_nsec(self, dc_nsec, &mono_nsec)) {
+    return false;
+  }
+  *real_nsec = mono_nsec + self->real_offset_nsec;
+  return true;
+}
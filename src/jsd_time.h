@@ -5,11 +5,52 @@
 extern "C" {
 #endif
 
+#include <stdbool.h>
+#include <stdint.h>
 #include <sys/time.h>
 #include <time.h>
 
 #include "ethercattype.h"
 
+#define JSD_TIME_NSEC_PER_SEC (1000000000LL)
+#define JSD_TIME_NSEC_PER_USEC (1000LL)
+
+/// EtherCAT DC system time counts from 2000-01-01, this is that epoch in Unix
+/// time
+#define JSD_TIME_DC_EPOCH_UNIX_NSEC (946684800LL * JSD_TIME_NSEC_PER_SEC)
+
+/**
+ * @brief Timestamps captured once per cycle by jsd_read(...)
+ *
+ * All drivers processing a cycle use this stamp instead of querying the clocks
+ * themselves, so a cycle costs a single clock read regardless of bus size.
+ */
+typedef struct {
+  int64_t mono_nsec;  ///< CLOCK_MONOTONIC time of frame reception, ns
+  int64_t real_nsec;  ///< CLOCK_REALTIME time of frame reception, ns since
+                      ///< Unix Epoch. Comparable against SOEM error stamps.
+  int64_t dc_nsec;    ///< DC system time of the reference clock latched by the
+                      ///< frame, ns since 2000-01-01. Only set if dc_valid
+  bool dc_valid;      ///< true if the bus has DC and the frame returned
+} jsd_cycle_time_t;
+
+/**
+ * @brief Maps DC system time onto the host clocks
+ *
+ * Tracks offset and rate between the DC reference clock and CLOCK_MONOTONIC
+ * from the per-cycle stamps. Host receive stamps only lag the frame, so
+ * corrections toward earlier host time are trusted more than later ones; the
+ * estimate converges to the minimum frame latency rather than the mean.
+ */
+typedef struct {
+  bool     valid;             ///< true once a DC sample has been consumed
+  uint32_t num_samples;       ///< samples since the last (re)synchronization
+  int64_t  dc_base_nsec;      ///< DC time of the last sample
+  int64_t  mono_base_nsec;    ///< estimated CLOCK_MONOTONIC at dc_base_nsec
+  double   rate;              ///< estimated d(mono)/d(dc)
+  int64_t  real_offset_nsec;  ///< CLOCK_REALTIME - CLOCK_MONOTONIC
+} jsd_time_dc_correlation_t;
+
 /**
  * @brief Get the system's clock time since the Unix Epoch.
  * @return Number of seconds since Unix Epoch.
@@ -31,6 +72,26 @@ static inline double jsd_time_get_mono_time_sec() {
   return (double)ts.tv_sec + (double)ts.tv_nsec / 1000000000;
 }
 
+/**
+ * @brief Get the system's clock time since the Unix Epoch.
+ * @return Number of nanoseconds since Unix Epoch.
+ */
+static inline int64_t jsd_time_get_time_nsec() {
+  struct timespec ts;
+  clock_gettime(CLOCK_REALTIME, &ts);
+  return (int64_t)ts.tv_sec * JSD_TIME_NSEC_PER_SEC + ts.tv_nsec;
+}
+
+/**
+ * @brief Get monotonic time since unspecified fixed point.
+ * @return Number of nanoseconds since fixed point.
+ */
+static inline int64_t jsd_time_get_mono_time_nsec() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (int64_t)ts.tv_sec * JSD_TIME_NSEC_PER_SEC + ts.tv_nsec;
+}
+
 /**
  * @brief Convert SOEM's time type to seconds.
  * @return Seconds representation of SOEM's time type object.
@@ -39,6 +100,109 @@ static inline double ectime_to_sec(ec_timet t) {
   return (double)t.sec + (double)(t.usec) * 1.0e-6;
 }
 
+/**
+ * @brief Convert SOEM's time type to nanoseconds.
+ * @return Nanoseconds representation of SOEM's time type object.
+ */
+static inline int64_t ectime_to_nsec(ec_timet t) {
+  return (int64_t)t.sec * JSD_TIME_NSEC_PER_SEC +
+         (int64_t)t.usec * JSD_TIME_NSEC_PER_USEC;
+}
+
+/**
+ * @brief Calibrates the fast clock against CLOCK_MONOTONIC
+ *
+ * On x86 processors with an invariant TSC, the fast clock reads the time stamp
+ * counter instead of calling clock_gettime(...). On any other platform, or if
+ * calibration fails, the fast clock falls back to clock_gettime(...).
+ *
+ * Not real-time safe, call once before entering the control loop. The
+ * CLOCK_REALTIME offset is latched at calibration and again once per second by
+ * jsd_time_get_cycle_time(...), so a step of the system clock shows in the
+ * realtime stamps within a second.
+ *
+ * @param calibration_usec duration of the calibration window, in microseconds
+ * @return true if the TSC is used by the fast clock
+ */
+bool jsd_time_fast_clock_calibrate(uint32_t calibration_usec);
+
+/**
+ * @brief Disables the fast clock, reverting to clock_gettime(...)
+ */
+void jsd_time_fast_clock_disable();
+
+/**
+ * @brief Checks whether the fast clock currently reads the TSC
+ * @return true if calibrated and enabled
+ */
+bool jsd_time_fast_clock_enabled();
+
+/**
+ * @brief Get monotonic time using the fast clock when available
+ *
+ * Real-time safe
+ *
+ * @return Number of nanoseconds since an unspecified fixed point, on the same
+ * time base as CLOCK_MONOTONIC
+ */
+int64_t jsd_time_get_fast_mono_time_nsec();
+
+/**
+ * @brief Captures monotonic and realtime stamps using the fast clock when
+ * available
+ *
+ * Real-time safe. With the fast clock, the realtime stamp follows
+ * CLOCK_REALTIME through an offset read from it once per second, so it stays
+ * ordered with the emergency message stamps of SOEM.
+ *
+ * @param stamp output timestamps
+ */
+void jsd_time_get_cycle_time(jsd_cycle_time_t* stamp);
+
+/**
+ * @brief Clears the DC correlation, the next sample resynchronizes it
+ *
+ * @param self DC correlation
+ */
+void jsd_time_dc_correlation_reset(jsd_time_dc_correlation_t* self);
+
+/**
+ * @brief Updates the DC correlation with the stamps of one cycle
+ *
+ * Real-time safe. Stamps without a valid DC time are ignored.
+ *
+ * @param self DC correlation
+ * @param stamp stamps captured at frame reception
+ */
+void jsd_time_dc_correlation_update(jsd_time_dc_correlation_t* self,
+                                    const jsd_cycle_time_t*    stamp);
+
+/**
+ * @brief Converts DC system time to CLOCK_MONOTONIC
+ *
+ * Real-time safe
+ *
+ * @param self DC correlation
+ * @param dc_nsec DC system time, ns since 2000-01-01
+ * @param mono_nsec output monotonic time, ns
+ * @return true if the correlation is valid
+ */
+bool jsd_time_dc_to_mono_nsec(const jsd_time_dc_correlation_t* self,
+                              int64_t dc_nsec, int64_t* mono_nsec);
+
+/**
+ * @brief Converts DC system time to CLOCK_REALTIME
+ *
+ * Real-time safe
+ *
+ * @param self DC correlation
+ * @param dc_nsec DC system time, ns since 2000-01-01
+ * @param real_nsec output realtime, ns since Unix Epoch
+ * @return true if the correlation is valid
+ */
+bool jsd_time_dc_to_real_nsec(const jsd_time_dc_correlation_t* self,
+                              int64_t dc_nsec, int64_t* real_nsec);
+
 #ifdef __cplusplus
 }
 #endif
@@ -31,6 +31,8 @@
 // Local headers
 #include "jsd_timer.h"
 
+#include "jsd/jsd_time.h"
+
 // Timer helper macros
 /// Number of nanoseconds in a second
 #define JSD_NSEC_PER_SEC (1000000000L)
@@ -187,35 +189,19 @@ static struct timespec jsd_timer_timespec_add(struct timespec time1,
 }
 
 double jsd_timer_get_time_sec() {
-  struct timespec sys_time;
-
-  clock_gettime(CLOCK_MONOTONIC, &sys_time);
-
-  return (double)sys_time.tv_sec + (double)sys_time.tv_nsec / 1.0e9;
+  return (double)jsd_time_get_mono_time_nsec() / 1.0e9;
 }
 
 double jsd_timer_get_time_msec() {
-  struct timespec sys_time;
-
-  clock_gettime(CLOCK_MONOTONIC, &sys_time);
-
-  return (double)sys_time.tv_sec * 1.0e3 + (double)sys_time.tv_nsec / 1.0e6;
+  return (double)jsd_time_get_mono_time_nsec() / 1.0e6;
 }
 
 double jsd_timer_get_time_usec() {
-  struct timespec sys_time;
-
-  clock_gettime(CLOCK_MONOTONIC, &sys_time);
-
-  return (double)sys_time.tv_sec * 1.0e6 + (double)sys_time.tv_nsec / 1.0e3;
+  return (double)jsd_time_get_mono_time_nsec() / 1.0e3;
 }
 
 double jsd_timer_get_time_nsec() {
-  struct timespec sys_time;
-
-  clock_gettime(CLOCK_MONOTONIC, &sys_time);
-
-  return (double)sys_time.tv_sec * 1.0e9 + (double)sys_time.tv_nsec;
+  return (double)jsd_time_get_mono_time_nsec();
 }
 
 void jsd_timer_free(jsd_timer_t* self) { free(self); }
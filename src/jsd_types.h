@@ -7,6 +7,7 @@ extern "C" {
 
 #include <pthread.h>
 #include <stdbool.h>
+#include <stdio.h>
 
 #include "ethercat.h"
 #include "jsd/jsd_ati_fts_types.h"
@@ -26,6 +27,9 @@ extern "C" {
 #include "jsd/jsd_jed0200_types.h"
 
 #include "jsd/jsd_error_cirq.h"
+#include "jsd/jsd_memory.h"
+#include "jsd/jsd_time.h"
+#include "jsd/jsd_vbus_types.h"
 
 typedef struct {
   bool     configuration_active;
@@ -132,6 +136,665 @@ typedef struct {
   pthread_mutex_t mutex;
 } jsd_sdo_req_cirq_t;
 
+typedef struct {
+  uint32_t timeout_us;  ///< max gap between jsd_write(...) calls before a stall
+  bool send_safe_outputs;  ///< transmit safe outputs while the cycle is stalled
+} jsd_watchdog_config_t;
+
+typedef struct {
+  bool     stalled;           ///< true while a stall is ongoing
+  uint32_t stall_count;       ///< number of detected stalls
+  uint32_t safe_frame_count;  ///< frames transmitted by the watchdog
+  int64_t  last_stall_start_nsec;  ///< monotonic time of the last heartbeat
+                                   ///< before the latest stall
+  int64_t last_stall_duration_nsec;  ///< heartbeat gap of the latest completed
+                                     ///< stall
+  int64_t max_stall_duration_nsec;   ///< longest completed stall
+} jsd_watchdog_stats_t;
+
+typedef struct {
+  jsd_watchdog_config_t config;
+  bool                  running;
+  bool                  join_flag;
+  pthread_t             thread;
+  pthread_mutex_t       frame_mutex;  ///< serializes processdata exchanges
+  pthread_mutex_t       stats_mutex;
+  int64_t               heartbeat_nsec;  ///< set by jsd_write(...), atomic
+  jsd_watchdog_stats_t  stats;
+
+  // Guarded by frame_mutex while running, frame_pending is atomic
+  bool frame_pending;   ///< sent by jsd_write(...), not yet received
+  bool frame_received;  ///< the pending frame was received by the watchdog
+  int  frame_wkc;       ///< working counter of the pending frame
+
+  bool    safe_outputs_set[EC_MAXSLAVE];
+  uint8_t safe_outputs[JSD_IOMAP_BYTES];   ///< laid out like the IOmap
+  uint8_t saved_outputs[JSD_IOMAP_BYTES];  ///< outputs during a safe frame
+} jsd_watchdog_t;
+
+typedef struct {
+  int      fd;
+  uint8_t* map;  ///< memory-mapped recording, NULL when inactive
+  size_t   map_bytes;
+  bool     replaying;
+  uint32_t capacity;      ///< cycles held by the ring
+  uint32_t image_bytes;   ///< IOmap bytes stored per cycle
+  uint32_t record_bytes;  ///< stride of the ring
+  uint64_t next;          ///< next cycle to record or replay
+  uint64_t end;           ///< one past the last cycle to replay
+} jsd_recorder_t;
+
+#define JSD_CAPTURE_CYCLE_MARKS (1024)
+
+typedef enum {
+  JSD_CAPTURE_FILTER_ALL = 0,  ///< every EtherCAT frame on the interface
+  JSD_CAPTURE_FILTER_CYCLIC,   ///< process data frames only
+  JSD_CAPTURE_FILTER_MAILBOX,  ///< mailbox data and status frames only
+} jsd_capture_filter_t;
+
+typedef struct {
+  jsd_capture_filter_t filter;
+  const uint16_t*      slave_ids;  ///< slave subset to keep, NULL for all
+  uint16_t             num_slave_ids;
+  bool     hardware_timestamps;  ///< NIC receive stamps, if supported
+  uint32_t ring_bytes;           ///< kernel capture ring, 0 for the default
+} jsd_capture_config_t;
+
+typedef struct {
+  uint64_t frames_written;
+  uint64_t frames_filtered;
+  uint64_t frames_dropped;    ///< lost by the kernel, the writer fell behind
+  uint64_t hardware_stamped;  ///< frames written with a NIC timestamp
+  uint64_t unmarked_cycles;   ///< cycles sent while the mark ring was full
+} jsd_capture_stats_t;
+
+typedef struct {
+  uint64_t cycle;
+  uint8_t  idx;  ///< datagram index of a frame sent in the cycle
+} jsd_capture_mark_t;
+
+typedef struct {
+  bool      running;
+  bool      join_flag;
+  pthread_t thread;
+  int       fd;
+  uint8_t*  ring;  ///< TPACKET_V3 ring shared with the kernel
+  size_t    ring_bytes;
+  uint32_t  block_bytes;
+  uint32_t  num_blocks;
+  FILE*     file;
+
+  jsd_capture_filter_t filter;
+  bool                 slave_filter;
+  bool                 slave_selected[EC_MAXSLAVE];
+
+  // Written by jsd_write(...), read by the writer thread to number frames
+  uint64_t           cycle;
+  jsd_capture_mark_t marks[JSD_CAPTURE_CYCLE_MARKS];
+  uint32_t           marks_head;       ///< atomic
+  uint32_t           marks_tail;       ///< atomic
+  uint64_t           unmarked_cycles;  ///< atomic
+
+  bool     cycle_known;  ///< writer thread state
+  uint64_t current_cycle;
+
+  pthread_mutex_t     stats_mutex;
+  jsd_capture_stats_t stats;
+} jsd_capture_t;
+
+/// SDO latency buckets, bounded from 250 us to 500 ms, the last one is +Inf
+#define JSD_METRICS_LATENCY_BUCKETS (12)
+
+/**
+ * @brief Recovery actions of jsd_ecatcheck(...)
+ */
+typedef enum {
+  JSD_RECOVERY_EVENT_ACK_ERROR = 0,  ///< SAFE-OP + ERROR acknowledged
+  JSD_RECOVERY_EVENT_REQUEST_OP,     ///< SAFE-OP slave requested to OP
+  JSD_RECOVERY_EVENT_RECONFIG,       ///< slave reconfigured
+  JSD_RECOVERY_EVENT_LOST,           ///< slave stopped responding
+  JSD_RECOVERY_EVENT_RECOVERED,      ///< lost slave recovered
+  JSD_RECOVERY_EVENT_FOUND,          ///< lost slave responding again
+  JSD_NUM_RECOVERY_EVENTS,
+} jsd_recovery_event_t;
+
+typedef struct {
+  uint64_t count;
+  uint64_t sum_usec;
+  uint64_t buckets[JSD_METRICS_LATENCY_BUCKETS];  ///< not cumulative
+} jsd_latency_histogram_t;
+
+/**
+ * @brief Counters of a slave, all monotonic except al_state
+ */
+typedef struct {
+  uint64_t recovery_events[JSD_NUM_RECOVERY_EVENTS];
+  uint64_t state_transitions;  ///< AL state changes seen by the master
+  uint64_t emcy_count;
+  uint64_t sdo_requests;  ///< blocking and asynchronous
+  uint64_t sdo_failures;
+  uint64_t wkc_misses;  ///< bad working counters attributed to the slave
+  uint64_t dc_sync_violations;  ///< DC samples above the sync threshold
+  uint16_t al_state;            ///< last AL state seen by the master
+  jsd_latency_histogram_t sdo_latency;
+} jsd_slave_metrics_t;
+
+/**
+ * @brief Counters of the bus, all monotonic except the high-water marks
+ */
+typedef struct {
+  uint64_t cycles;             ///< jsd_read(...) calls
+  uint64_t bad_wkc_cycles;     ///< wkc != expected_wkc, lost frames included
+  uint64_t lost_frames;        ///< no frame returned before the timeout
+  uint64_t transmit_failures;  ///< jsd_write(...) could not send
+  uint64_t recovery_events[JSD_NUM_RECOVERY_EVENTS];
+  uint64_t state_transitions;
+  uint64_t emcy_count;
+  uint64_t sdo_requests;
+  uint64_t sdo_failures;
+  uint64_t wkc_scans;   ///< bad working counters attributed by jsd_diag
+  uint64_t dc_samples;  ///< DC register samples of all slaves by jsd_diag
+  jsd_latency_histogram_t sdo_latency;
+  jsd_latency_histogram_t reconfig_latency;  ///< ecx_reconfig_slave(...) calls
+
+  uint32_t sdo_request_queue_high_water;
+  uint32_t sdo_response_queue_high_water;
+  uint32_t error_queue_high_water;  ///< deepest per-slave EMCY queue
+} jsd_bus_metrics_t;
+
+typedef struct {
+  jsd_bus_metrics_t   bus;
+  jsd_slave_metrics_t slaves[EC_MAXSLAVE];
+} jsd_metrics_t;
+
+typedef struct {
+  char      path[108];  ///< sizeof(sockaddr_un.sun_path)
+  int       fd;
+  pthread_t thread;
+  bool      running;
+  bool      join_flag;
+} jsd_metrics_exporter_t;
+
+#define JSD_SHM_MAGIC (0x31304d485344534aULL)  ///< "JSDSHM01"
+#define JSD_SHM_VERSION (1)
+
+/**
+ * @brief Slave entry of a shared-memory snapshot
+ */
+typedef struct {
+  uint32_t          product_code;
+  uint16_t          al_state;        ///< from the last state check of SOEM
+  uint16_t          al_status_code;  ///< from the last state check of SOEM
+  jsd_slave_state_t state;  ///< use the member of the product, e.g. epd.pub
+} jsd_shm_slave_t;
+
+/**
+ * @brief Bus data published once per jsd_write(...)
+ */
+typedef struct {
+  uint64_t         cycle;  ///< jsd_write(...) calls since jsd_shm_start(...)
+  jsd_cycle_time_t cycle_time;
+  int32_t          wkc;
+  int32_t          expected_wkc;
+  uint16_t         bus_state;  ///< lowest AL state of all slaves
+  uint16_t         num_slaves;
+  bool             init_complete;
+  jsd_shm_slave_t  slaves[EC_MAXSLAVE];  ///< 1-indexed like SOEM
+} jsd_shm_snapshot_t;
+
+/**
+ * @brief Seqlock-protected snapshot, the sequence is odd while written
+ */
+typedef struct {
+  uint64_t           seq __attribute__((aligned(64)));
+  jsd_shm_snapshot_t snapshot __attribute__((aligned(64)));
+} jsd_shm_slot_t;
+
+/**
+ * @brief Layout of the shared-memory segment
+ *
+ * The writer alternates between the two slots, so readers copying the latest
+ * snapshot only retry if the writer laps them twice.
+ */
+typedef struct {
+  uint64_t       magic;  ///< set last, once the segment is ready
+  uint32_t       version;
+  uint32_t       snapshot_bytes;  ///< sizeof(jsd_shm_snapshot_t) of the writer
+  int32_t        writer_pid;
+  uint64_t       generation;  ///< slots[generation % 2] is the latest snapshot
+  jsd_shm_slot_t slots[2];
+} jsd_shm_segment_t;
+
+typedef struct {
+  char               name[JSD_NAME_LEN];
+  jsd_shm_segment_t* segment;  ///< NULL when not publishing
+  uint64_t           cycle;
+} jsd_shm_t;
+
+/**
+ * @brief Read-only mapping of a segment published by another process
+ */
+typedef struct {
+  const jsd_shm_segment_t* segment;  ///< NULL when not open
+} jsd_shm_reader_t;
+
+#define JSD_FLIGHT_MAGIC (0x3130544c4644534aULL)  ///< "JSDFLT01"
+#define JSD_FLIGHT_VERSION (1)
+#define JSD_FLIGHT_PATH_LEN (256)
+
+/**
+ * @brief Conditions freezing the history of a slave into a dump
+ */
+typedef enum {
+  JSD_FLIGHT_TRIGGER_FAULT   = (1 << 0),  ///< drive state machine faults
+  JSD_FLIGHT_TRIGGER_EMCY    = (1 << 1),  ///< emergency message received
+  JSD_FLIGHT_TRIGGER_STO     = (1 << 2),  ///< drive Safe Torque Off engages
+  JSD_FLIGHT_TRIGGER_BAD_WKC = (1 << 3),  ///< working counter turns bad
+  JSD_FLIGHT_TRIGGER_MANUAL  = (1 << 4),  ///< jsd_flight_trigger(...)
+} jsd_flight_trigger_t;
+
+#define JSD_FLIGHT_TRIGGER_ALL (0x1F)
+
+typedef struct {
+  uint32_t pre_cycles;   ///< cycles kept before the triggering cycle
+  uint32_t post_cycles;  ///< cycles recorded after the triggering cycle
+  uint32_t triggers;     ///< mask of jsd_flight_trigger_t, 0 for all
+  const uint16_t* slave_ids;  ///< slaves to record, NULL for all configured
+  uint16_t        num_slave_ids;
+} jsd_flight_config_t;
+
+typedef struct {
+  uint64_t triggers;        ///< windows opened by a trigger
+  uint64_t dumps_written;
+  uint64_t dumps_dropped;   ///< the previous dump of the slave was pending
+  uint64_t write_failures;
+} jsd_flight_stats_t;
+
+/**
+ * @brief History entry of a slave, followed by its TxPDO and RxPDO images
+ */
+typedef struct {
+  uint64_t          cycle;      ///< jsd_write(...) calls since the start
+  int64_t           mono_nsec;  ///< cycle stamp of jsd_read(...)
+  int32_t           wkc;
+  uint16_t          al_state;  ///< from the last state check of SOEM
+  uint16_t          triggers;  ///< raised in this cycle
+  jsd_slave_state_t state;     ///< use the member of the product, e.g. epd.pub
+} jsd_flight_record_t;
+
+/**
+ * @brief Header of a dump file, followed by num_records records
+ */
+typedef struct {
+  uint64_t magic;
+  uint32_t version;
+  uint32_t record_bytes;  ///< stride of the records
+  uint32_t state_bytes;   ///< sizeof(jsd_slave_state_t) of the writer
+  uint32_t product_code;
+  uint16_t slave_id;
+  uint16_t input_bytes;
+  uint16_t output_bytes;
+  uint16_t triggers;  ///< all triggers raised during the window
+  uint32_t num_records;
+  uint32_t trigger_record;  ///< index of the triggering cycle
+} jsd_flight_header_t;
+
+/**
+ * @brief Dump file loaded by jsd_flight_load_dump(...)
+ */
+typedef struct {
+  jsd_flight_header_t header;
+  uint8_t*            records;  ///< header.num_records * header.record_bytes
+} jsd_flight_dump_t;
+
+typedef struct {
+  uint8_t* rings[2];  ///< recording ring and ring owned by a pending dump
+  uint32_t active;    ///< index of the recording ring
+  uint64_t count;     ///< records written to the recording ring
+  uint16_t input_bytes;
+  uint16_t output_bytes;
+
+  bool     window_open;     ///< a trigger fired, recording the post window
+  uint32_t post_remaining;  ///< cycles left in the post window
+  uint64_t trigger_count;   ///< count of the triggering record
+  uint16_t triggers;
+
+  uint8_t  last_state_machine_state;  ///< edge detection of the triggers
+  uint8_t  last_sto_engaged;
+  uint64_t last_emcy_count;
+  uint16_t manual_triggers;  ///< atomic, raised by jsd_flight_trigger(...)
+
+  bool                pending;  ///< atomic, the writer owns the other ring
+  jsd_flight_header_t dump;
+  uint32_t            dump_first;  ///< ring index of the first dump record
+} jsd_flight_slave_t;
+
+typedef struct {
+  bool      running;
+  bool      join_flag;
+  pthread_t thread;
+  char      directory[JSD_FLIGHT_PATH_LEN];
+
+  uint32_t capacity;  ///< records per ring, pre and post windows included
+  uint32_t record_bytes;
+  uint32_t post_cycles;
+  uint32_t triggers;
+  uint64_t cycle;
+  bool     last_wkc_good;
+  uint32_t dump_sequence;  ///< writer thread state
+
+  jsd_flight_stats_t stats;  ///< updated with relaxed atomics
+  jsd_flight_slave_t slaves[EC_MAXSLAVE];
+  jsd_memory_arena_t ring_arena;  ///< backs the rings in real-time mode
+} jsd_flight_t;
+
+/// Period of the diagnostic thread
+#define JSD_DIAG_DEFAULT_POLL_USEC (1000)
+
+/// Period of the scans of the ESC error counters of all slaves
+#define JSD_DIAG_DEFAULT_ESC_SCAN_PERIOD_MS (1000)
+
+/// Period of the samples of the DC registers of all DC slaves
+#define JSD_DIAG_DEFAULT_DC_SAMPLE_PERIOD_MS (10)
+
+/// Sync error above which a DC slave is flagged
+#define JSD_DIAG_DEFAULT_DC_SYNC_THRESHOLD_NSEC (1000)
+
+#define JSD_ESC_NUM_PORTS (4)
+
+/// Register image of the ESC error counters, 0x0300 to 0x0313
+#define JSD_ESC_ERROR_REGS_BYTES (20)
+
+/// Neighbor of a port that is open or not known from the topology
+#define JSD_LINK_NO_NEIGHBOR (0xFFFF)
+
+/**
+ * @brief Why a slave is missing from the working counter
+ */
+typedef enum {
+  JSD_WKC_CAUSE_NONE = 0,     ///< contributes as configured
+  JSD_WKC_CAUSE_NO_RESPONSE,  ///< its station address does not answer
+  JSD_WKC_CAUSE_AL_STATE,     ///< below OP, its process data is not exchanged
+  JSD_WKC_CAUSE_SM,           ///< a process data SyncManager is disabled
+  JSD_WKC_CAUSE_FMMU,         ///< a process data FMMU is disabled
+  JSD_NUM_WKC_CAUSES,
+} jsd_wkc_cause_t;
+
+typedef struct {
+  jsd_wkc_cause_t cause;
+  uint8_t         expected_wkc;  ///< 2 with outputs plus 1 with inputs
+  uint8_t         missing_wkc;   ///< estimated from the cause
+  uint16_t        al_status;     ///< AL status register, 0 without answer
+  uint16_t        al_status_code;
+} jsd_wkc_slave_t;
+
+/**
+ * @brief Attribution of a bad working counter to slaves
+ */
+typedef struct {
+  uint64_t        cycle;  ///< jsd_read(...) count of the bad working counter
+  int32_t         wkc;
+  int32_t         expected_wkc;
+  int32_t         attributed_wkc;  ///< sum of missing_wkc of the slaves
+  int64_t         latency_nsec;    ///< from jsd_read(...) to the attribution
+  uint16_t        num_slaves;
+  uint16_t        num_suspects;  ///< slaves with a cause
+  jsd_wkc_slave_t slaves[EC_MAXSLAVE];  ///< 1-indexed like SOEM
+} jsd_wkc_report_t;
+
+/**
+ * @brief ESC error counters of a slave, accumulated since jsd_diag_start(...)
+ *
+ * Local errors were detected on the link at the port, forwarded errors were
+ * detected and marked by a slave before.
+ */
+typedef struct {
+  uint64_t invalid_frames[JSD_ESC_NUM_PORTS];
+  uint64_t rx_errors[JSD_ESC_NUM_PORTS];  ///< physical layer errors
+  uint64_t forwarded_rx_errors[JSD_ESC_NUM_PORTS];
+  uint64_t lost_links[JSD_ESC_NUM_PORTS];
+  uint64_t processing_unit_errors;
+  double   local_error_rate[JSD_ESC_NUM_PORTS];  ///< per second, last scan
+  double   lost_link_rate[JSD_ESC_NUM_PORTS];    ///< per second, last scan
+  uint64_t scans;
+  uint64_t failed_scans;  ///< the slave did not answer
+} jsd_esc_errors_t;
+
+/**
+ * @brief Link between the port of a slave and its neighbor
+ */
+typedef struct {
+  uint16_t slave_id;
+  uint8_t  port;
+  uint16_t neighbor_id;  ///< 0 for the master, or JSD_LINK_NO_NEIGHBOR
+  double   error_rate;   ///< local and lost link errors per second
+} jsd_link_segment_t;
+
+/**
+ * @brief Distributed clock sync of a slave, since jsd_diag_start(...)
+ *
+ * The sync error is the System Time Difference register 0x092C, the local
+ * copy of the system time minus the reference clock.
+ */
+typedef struct {
+  uint64_t samples;
+  uint64_t failed_samples;        ///< the slave did not answer
+  uint64_t violations;            ///< samples above the sync threshold
+  int32_t  sync_error_nsec;       ///< last sample
+  uint32_t max_sync_error_nsec;   ///< largest magnitude
+  double   mean_sync_error_nsec;  ///< signed, an offset the loop cannot remove
+  double   stddev_sync_error_nsec;
+  uint32_t propagation_delay_nsec;  ///< from the reference clock, 0x0928
+  bool     out_of_sync;             ///< last sample above the sync threshold
+} jsd_dc_quality_t;
+
+typedef struct {
+  uint32_t poll_usec;           ///< 0 for JSD_DIAG_DEFAULT_POLL_USEC
+  uint32_t esc_scan_period_ms;  ///< 0 for JSD_DIAG_DEFAULT_ESC_SCAN_PERIOD_MS
+  /// 0 for JSD_DIAG_DEFAULT_DC_SAMPLE_PERIOD_MS
+  uint32_t dc_sample_period_ms;
+  /// 0 for JSD_DIAG_DEFAULT_DC_SYNC_THRESHOLD_NSEC
+  uint32_t dc_sync_threshold_nsec;
+} jsd_diag_config_t;
+
+typedef struct {
+  bool              running;
+  bool              join_flag;
+  pthread_t         thread;
+  jsd_diag_config_t config;
+
+  uint64_t bad_wkc_cycle;  ///< atomic, published last by jsd_read(...)
+  int32_t  bad_wkc;
+  int64_t  bad_wkc_mono_nsec;
+
+  uint64_t scanned_cycle;  ///< diagnostic thread state
+  int32_t  scanned_wkc;
+  int64_t  scanned_mono_nsec;
+
+  int64_t            esc_pass_mono_nsec;  ///< start of the current pass
+  uint16_t           esc_next_slave;      ///< 0 between passes
+  jsd_link_segment_t esc_pass_worst;
+  uint8_t esc_regs[EC_MAXSLAVE][JSD_ESC_ERROR_REGS_BYTES];  ///< last read
+  int64_t esc_scan_mono_nsec[EC_MAXSLAVE];  ///< 0 before the first scan
+
+  int64_t dc_sample_mono_nsec;  ///< last samples of all DC slaves
+  double  dc_m2[EC_MAXSLAVE];   ///< sum of squared deviations
+
+  pthread_mutex_t    report_mutex;  ///< guards everything below
+  bool               has_wkc_report;
+  jsd_wkc_report_t   wkc_report;
+  jsd_esc_errors_t   esc_errors[EC_MAXSLAVE];
+  bool               has_degraded_link;
+  jsd_link_segment_t degraded_link;  ///< worst segment of the last pass
+  jsd_dc_quality_t   dc_quality[EC_MAXSLAVE];
+} jsd_diag_t;
+
+/// Period of the slave count checks of the hot-plug thread
+#define JSD_HOTPLUG_DEFAULT_CHECK_PERIOD_MS (500)
+
+/**
+ * @brief Topology changes seen by the hot-plug thread
+ */
+typedef enum {
+  JSD_HOTPLUG_EVENT_ADDED = 0,       ///< new slave at the end of the line
+  JSD_HOTPLUG_EVENT_OPERATIONAL,     ///< new slave configured and in OP
+  JSD_HOTPLUG_EVENT_NOT_CONFIGURED,  ///< new slave without active config
+  JSD_HOTPLUG_EVENT_FAILED,          ///< new slave did not reach OP
+  JSD_HOTPLUG_EVENT_REMOVED,         ///< fewer slaves answer
+  JSD_HOTPLUG_EVENT_MISMATCH,        ///< lost slave back as another device
+  JSD_HOTPLUG_EVENT_INSERTED,        ///< new slave moved others, see jsd_init
+  JSD_NUM_HOTPLUG_EVENTS,
+} jsd_hotplug_event_type_t;
+
+typedef struct {
+  jsd_hotplug_event_type_t type;
+  uint16_t                 slave_id;    ///< 0 for REMOVED
+  uint16_t                 num_slaves;  ///< slaves answering the check
+  uint32_t                 eep_man;     ///< identity found on the bus
+  uint32_t                 eep_id;
+  int64_t                  mono_nsec;
+  int64_t                  duration_nsec;  ///< since ADDED, for OPERATIONAL
+} jsd_hotplug_event_t;
+
+typedef struct {
+  uint64_t checks;
+  uint64_t failed_checks;  ///< no answer to the broadcast read
+  uint64_t events[JSD_NUM_HOTPLUG_EVENTS];
+} jsd_hotplug_stats_t;
+
+typedef struct {
+  uint32_t check_period_ms;  ///< 0 for JSD_HOTPLUG_DEFAULT_CHECK_PERIOD_MS
+} jsd_hotplug_config_t;
+
+typedef struct {
+  bool                 running;
+  bool                 join_flag;
+  pthread_t            thread;
+  jsd_hotplug_config_t config;
+
+  uint32_t reserved_obytes;  ///< output headroom set before jsd_init(...)
+  uint32_t mapped_bytes;     ///< logical end of the slaves in the image
+
+  uint16_t seen_slaves;            ///< hot-plug thread state
+  bool     reported[EC_MAXSLAVE];  ///< position handled until count changes
+
+  /// Bus configuration lock. Held while the hot-plug thread reads a SII or
+  /// configures a slave, and by the other users of the SII, mailbox and PDO
+  /// mapping state of the context: jsd_ecatcheck(...) tries it, the SDO and
+  /// diagnostic threads wait for it.
+  pthread_mutex_t config_mutex;
+
+  bool     pending;          ///< atomic, extension waiting for jsd_read(...)
+  bool     pending_applied;  ///< result of the image extension
+  uint16_t pending_slave_id;
+  uint32_t pending_obytes;
+  uint32_t pending_ibytes;
+
+  pthread_mutex_t     report_mutex;  ///< guards everything below
+  jsd_hotplug_stats_t stats;
+  bool                has_event;
+  jsd_hotplug_event_t last_event;
+} jsd_hotplug_t;
+
+/// Blocking SDO writes of the PO2SO hooks remembered by jsd_init(...)
+#define JSD_RECONFIG_MAX_WRITES (1024)
+/// Larger writes are not remembered, their slave needs its full PO2SO hook
+#define JSD_RECONFIG_MAX_WRITE_BYTES (64)
+
+/**
+ * @brief How jsd_ecatcheck(...) reconfigured a slave
+ */
+typedef enum {
+  JSD_RECONFIG_PATH_NONE = 0,   ///< not reconfigured since jsd_init(...)
+  JSD_RECONFIG_PATH_VERIFIED,   ///< remembered objects read back unchanged
+  JSD_RECONFIG_PATH_REAPPLIED,  ///< differing objects written again
+  JSD_RECONFIG_PATH_FULL,       ///< full PO2SO hook of the device
+  JSD_RECONFIG_PATH_FAILED,     ///< slave did not reach SAFE-OP
+  JSD_NUM_RECONFIG_PATHS,
+} jsd_reconfig_path_t;
+
+typedef struct {
+  uint16_t            slave_id;
+  uint16_t            index;
+  uint8_t             subindex;
+  bool                complete_access;
+  jsd_sdo_data_type_t data_type;  ///< unused with complete_access
+  uint16_t            size;
+  uint8_t             data[JSD_RECONFIG_MAX_WRITE_BYTES];
+} jsd_reconfig_write_t;
+
+typedef struct {
+  uint64_t            reconfigs[JSD_NUM_RECONFIG_PATHS];
+  jsd_reconfig_path_t last_path;
+  uint32_t            last_reads;          ///< objects read back
+  uint32_t            last_writes;         ///< remembered writes repeated
+  int64_t             last_duration_nsec;  ///< ecx_reconfig_slave(...) call
+  int64_t             max_duration_nsec;
+} jsd_reconfig_stats_t;
+
+/// PO2SO hook of a slave, see ec_slavet.PO2SOconfigx
+typedef int (*jsd_po2so_hook_t)(ecx_contextt* context, uint16 slave);
+
+typedef struct {
+  bool disabled;   ///< full PO2SO hooks only, see jsd_reconfig_enable
+  bool recording;  ///< PO2SO hooks of jsd_init(...) are running
+
+  uint16_t             num_writes;
+  jsd_reconfig_write_t writes[JSD_RECONFIG_MAX_WRITES];
+  bool                 incomplete[EC_MAXSLAVE];  ///< some writes not remembered
+  jsd_po2so_hook_t     full_hooks[EC_MAXSLAVE];
+  jsd_reconfig_path_t  paths[EC_MAXSLAVE];  ///< set by the fast hook
+  uint32_t             reads[EC_MAXSLAVE];
+  uint32_t             rewrites[EC_MAXSLAVE];
+
+  pthread_mutex_t      stats_mutex;  ///< guards stats
+  jsd_reconfig_stats_t stats[EC_MAXSLAVE];
+} jsd_reconfig_t;
+
+/**
+ * @brief Phases of jsd_init(...), in order
+ */
+typedef enum {
+  JSD_INIT_PHASE_OPEN = 0,     ///< ecx_init(...) or the virtual bus
+  JSD_INIT_PHASE_CONFIG_INIT,  ///< ecx_config_init(...), SII reads included
+  JSD_INIT_PHASE_DEVICES,      ///< driver init of every configured slave
+  JSD_INIT_PHASE_MAP,          ///< PDO mapping, PO2SO hooks included
+  JSD_INIT_PHASE_SAFE_OP,      ///< SAFE-OP state check
+  JSD_INIT_PHASE_CONFIG_DC,    ///< ecx_configdc(...)
+  JSD_INIT_PHASE_OPERATIONAL,  ///< SAFE-OP to OP attempts
+  JSD_INIT_PHASE_THREADS,      ///< queues and SDO thread
+  JSD_NUM_INIT_PHASES,
+} jsd_init_phase_t;
+
+typedef struct {
+  int64_t  po2so_nsec;    ///< PO2SO hook, 0 without hook
+  uint32_t sdo_requests;  ///< blocking SDO transfers during jsd_init(...)
+  uint32_t sdo_failures;  ///< transfers without an answer
+  int64_t  sdo_nsec;      ///< summed duration of the transfers
+  uint32_t op_attempts;   ///< OP attempt that found the slave in OP, 0 if none
+} jsd_init_slave_report_t;
+
+/**
+ * @brief Timeline of the last jsd_init(...), phases not reached are 0
+ */
+typedef struct {
+  bool     success;              ///< jsd_init(...) returned true
+  uint16_t num_phases;           ///< phases completed
+  uint16_t num_slaves;           ///< slaves found by ecx_config_init(...)
+  int64_t  start_mono_nsec;      ///< start of jsd_init(...)
+  int64_t  total_nsec;           ///< until the end of the last phase
+  uint32_t op_attempts;          ///< SAFE-OP to OP attempts of the bus
+  int64_t  phase_nsec[JSD_NUM_INIT_PHASES];
+  jsd_init_slave_report_t slaves[EC_MAXSLAVE];
+} jsd_init_report_t;
+
+typedef struct {
+  bool              recording;  ///< jsd_init(...) is running
+  int64_t           mark_nsec;  ///< end of the previous phase
+  jsd_po2so_hook_t  hooks[EC_MAXSLAVE];
+  jsd_init_report_t report;
+} jsd_startup_t;
+
 /** * @brief main JSD context
  *
  * Contains list of slave configurations provided by user and internally updated
@@ -148,19 +811,57 @@ typedef struct {
   int          expected_wkc;             ///< Expected Working Counter
   int          wkc;                      ///< processdata Working Counter
   int          last_wkc;                 ///< the previous processdata wkc
+  int          last_transmitted;         ///< the previous processdata send
   bool         init_complete;            ///< true after jsd_init(...)
   uint8_t      enable_autorecovery;      ///< enables autorecovery feature
   uint8_t      attempt_manual_recovery;  ///< one-time manual recovery attempt
 
+  jsd_cycle_time_t          cycle_time;  ///< stamped once per jsd_read(...)
+  jsd_time_dc_correlation_t dc_correlation;  ///< DC to host clock mapping
+
   jsd_sdo_req_cirq_t jsd_sdo_req_cirq;
   jsd_sdo_req_cirq_t jsd_sdo_res_cirq;
   pthread_t          sdo_thread;
   pthread_cond_t     sdo_thread_cond;
   bool               sdo_join_flag;
   bool               raise_sdo_thread_cond;
+  bool               sdo_busy;  ///< atomic, an SDO transfer is in progress
+
+  jsd_watchdog_t watchdog;
+  jsd_recorder_t recorder;
+  jsd_capture_t  capture;
+  jsd_shm_t      shm;
+  jsd_flight_t   flight;
+  jsd_diag_t     diag;
+  jsd_hotplug_t  hotplug;
+  jsd_reconfig_t reconfig;
+  jsd_startup_t  startup;
+
+  jsd_metrics_t          metrics;  ///< updated with relaxed atomics
+  jsd_metrics_exporter_t metrics_exporter;
+
+  jsd_memory_config_t memory_config;
+  jsd_memory_arena_t  arena;  ///< backs the context in real-time memory mode
+
+  jsd_vbus_t* vbus;  ///< simulated bus replacing the NIC, NULL for hardware
 
 } jsd_t;
 
+/**
+ * @brief Device handle resolved once after jsd_init(...)
+ *
+ * Caches everything the per-device accessors otherwise look up from
+ * (jsd_t*, slave_id) on every call. Device drivers wrap it in typed handles.
+ */
+typedef struct {
+  jsd_t*              jsd;
+  uint16_t            slave_id;
+  uint8_t*            inputs;   ///< TxPDO image of the slave in the IOmap
+  uint8_t*            outputs;  ///< RxPDO image of the slave in the IOmap
+  jsd_slave_config_t* config;
+  jsd_slave_state_t*  state;
+} jsd_device_t;
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,1847 @@
+#include "jsd/jsd_vbus.h"
+
+#include <assert.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include "ethercat.h"
+#include "jsd/jsd_ati_fts.h"
+#include "jsd/jsd_egd.h"
+#include "jsd/jsd_el2124.h"
+#include "jsd/jsd_el3104.h"
+#include "jsd/jsd_el3162.h"
+#include "jsd/jsd_el3202.h"
+#include "jsd/jsd_el3208.h"
+#include "jsd/jsd_el3318.h"
+#include "jsd/jsd_el3356.h"
+#include "jsd/jsd_el3602.h"
+#include "jsd/jsd_el4102.h"
+#include "jsd/jsd_epd.h"
+#include "jsd/jsd_ild1900.h"
+#include "jsd/jsd_jed0101.h"
+#include "jsd/jsd_jed0200.h"
+#include "jsd/jsd_print.h"
+#include "jsd/jsd_time.h"
+
+// Datagram: cmd, idx, address (4), length/flags (2), irq (2), data, wkc (2)
+#define JSD_VBUS_DATAGRAM_HEADER_BYTES (10)
+#define JSD_VBUS_DATAGRAM_LENGTH_MASK (0x07FF)
+#define JSD_VBUS_DATAGRAM_MORE (0x8000)
+
+#define JSD_VBUS_NUM_FMMU (8)
+#define JSD_VBUS_FMMU_BYTES (16)
+#define JSD_VBUS_NUM_SM (8)
+#define JSD_VBUS_SM_BYTES (8)
+#define JSD_VBUS_SM_STATUS (5)
+#define JSD_VBUS_SM_STATUS_MBX_FULL (0x08)
+
+// Process RAM layout advertised in the SII
+#define JSD_VBUS_MBX_OUT_START (0x1000)
+#define JSD_VBUS_MBX_IN_START (0x1200)
+#define JSD_VBUS_RXPDO_START (0x1400)
+#define JSD_VBUS_TXPDO_START (0x1800)
+#define JSD_VBUS_DIGITAL_OUT_START (0x0F00)
+
+#define JSD_VBUS_AL_INVALID_STATE_CHANGE (0x0011)
+#define JSD_VBUS_AL_UNKNOWN_STATE (0x0012)
+#define JSD_VBUS_AL_INVALID_MBX_CONFIG (0x0016)
+#define JSD_VBUS_AL_SM_WATCHDOG (0x001B)
+
+#define JSD_VBUS_EEPROM_CMD_MASK (0x0700)
+#define JSD_VBUS_EEPROM_CMD_READ (0x0100)
+#define JSD_VBUS_EEPROM_CMD_WRITE (0x0200)
+#define JSD_VBUS_EEPROM_CMD_RELOAD (0x0400)
+#define JSD_VBUS_EEPROM_CMD_RELOAD_SOEM (0x0300)  ///< EC_ECMD_RELOAD
+#define JSD_VBUS_EEPROM_WRITE_ENABLE (0x0001)
+#define JSD_VBUS_EEPROM_ERROR_CMD (0x2000)
+#define JSD_VBUS_EEPROM_ERROR_WRITE_ENABLE (0x4000)
+
+// Mailbox: header (6), CoE header (2), SDO command (1), index (2), sub (1)
+#define JSD_VBUS_MBX_HEADER_BYTES (6)
+#define JSD_VBUS_SDO_CMD (8)
+#define JSD_VBUS_SDO_INDEX (9)
+#define JSD_VBUS_SDO_SUBINDEX (11)
+#define JSD_VBUS_SDO_DATA (12)
+#define JSD_VBUS_SDO_BYTES (10)  ///< CoE header to the end of the SDO header
+#define JSD_VBUS_SDO_CCS_DOWNLOAD (1)
+#define JSD_VBUS_SDO_CCS_UPLOAD (2)
+#define JSD_VBUS_SDO_CA (0x10)
+#define JSD_VBUS_SDO_DOWNLOAD_RESPONSE (0x60)
+#define JSD_VBUS_SDO_UPLOAD_RESPONSE (0x41)
+#define JSD_VBUS_SDO_UPLOAD_EXPEDITED (0x43)
+
+// Store and restore parameters, commands that read back their capabilities
+#define JSD_VBUS_SDO_STORE_PARAMETERS (0x1010)
+#define JSD_VBUS_SDO_RESTORE_PARAMETERS (0x1011)
+
+#define JSD_VBUS_ABORT_UNSUPPORTED (0x05040001)
+#define JSD_VBUS_ABORT_OUT_OF_MEMORY (0x05040005)
+#define JSD_VBUS_ABORT_UNSUPPORTED_ACCESS (0x06010000)
+#define JSD_VBUS_ABORT_NO_OBJECT (0x06020000)
+#define JSD_VBUS_ABORT_LENGTH (0x06070010)
+#define JSD_VBUS_ABORT_NO_SUBINDEX (0x06090011)
+
+typedef struct {
+  uint32_t    product_code;
+  uint32_t    vendor_id;
+  const char* name;
+  uint16_t    rxpdo_bits;
+  uint16_t    txpdo_bits;
+  bool        has_mailbox;
+} jsd_vbus_product_t;
+
+#define JSD_VBUS_BITS(type) (sizeof(type) * 8)
+
+static const jsd_vbus_product_t jsd_vbus_products[] = {
+    {JSD_EL3602_PRODUCT_CODE, JSD_BECKHOFF_VENDOR_ID, "EL3602", 0,
+     JSD_VBUS_BITS(jsd_el3602_txpdo_t), true},
+    {JSD_EL3208_PRODUCT_CODE, JSD_BECKHOFF_VENDOR_ID, "EL3208", 0,
+     JSD_VBUS_BITS(jsd_el3208_txpdo_t), true},
+    {JSD_EL2124_PRODUCT_CODE, JSD_BECKHOFF_VENDOR_ID, "EL2124", 4, 0, false},
+    {JSD_EGD_PRODUCT_CODE, JSD_ELMO_VENDOR_ID, "EGD",
+     JSD_VBUS_BITS(jsd_egd_rxpdo_data_cs_mode_t),
+     JSD_VBUS_BITS(jsd_egd_txpdo_data_t), true},
+    {JSD_EL3356_PRODUCT_CODE, JSD_BECKHOFF_VENDOR_ID, "EL3356",
+     JSD_VBUS_BITS(jsd_el3356_rxpdo_t),
+     JSD_VBUS_BITS(jsd_el3356_txpdo_t), true},
+    {JSD_JED0101_PRODUCT_CODE, JSD_JPL_VENDOR_ID, "JED0101",
+     JSD_VBUS_BITS(jsd_jed0101_rxpdo_t),
+     JSD_VBUS_BITS(jsd_jed0101_txpdo_t), true},
+    {JSD_JED0200_PRODUCT_CODE, JSD_JPL_VENDOR_ID, "JED0200",
+     JSD_VBUS_BITS(jsd_jed0200_rxpdo_t),
+     JSD_VBUS_BITS(jsd_jed0200_txpdo_t), true},
+    {JSD_ATI_FTS_PRODUCT_CODE, JSD_ATI_VENDOR_ID, "ATI FTS",
+     JSD_VBUS_BITS(jsd_ati_fts_rxpdo_t),
+     JSD_VBUS_BITS(jsd_ati_fts_txpdo_t), true},
+    {JSD_EL3104_PRODUCT_CODE, JSD_BECKHOFF_VENDOR_ID, "EL3104", 0,
+     JSD_VBUS_BITS(jsd_el3104_txpdo_t), true},
+    {JSD_EL3202_PRODUCT_CODE, JSD_BECKHOFF_VENDOR_ID, "EL3202", 0,
+     JSD_VBUS_BITS(jsd_el3202_txpdo_t), true},
+    {JSD_EL3318_PRODUCT_CODE, JSD_BECKHOFF_VENDOR_ID, "EL3318", 0,
+     JSD_VBUS_BITS(jsd_el3318_txpdo_t), true},
+    {JSD_EL3162_PRODUCT_CODE, JSD_BECKHOFF_VENDOR_ID, "EL3162", 0,
+     JSD_VBUS_BITS(jsd_el3162_txpdo_t), true},
+    {JSD_EL4102_PRODUCT_CODE, JSD_BECKHOFF_VENDOR_ID, "EL4102",
+     JSD_VBUS_BITS(jsd_el4102_rxpdo_t), 0, true},
+    {JSD_ILD1900_PRODUCT_CODE, JSD_MICROEPSILON_VENDOR_ID, "ILD1900", 0,
+     JSD_VBUS_BITS(jsd_ild1900_txpdo_t), true},
+    {JSD_EPD_PRODUCT_CODE, JSD_ELMO_VENDOR_ID, "EPD",
+     JSD_VBUS_BITS(jsd_epd_rxpdo_data_t),
+     JSD_VBUS_BITS(jsd_epd_txpdo_data_t), true},
+};
+
+/****************************************************
+ * Little-endian field access
+ ****************************************************/
+
+static uint16_t jsd_vbus_get16(const uint8_t* p) {
+  return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t jsd_vbus_get32(const uint8_t* p) {
+  return (uint32_t)jsd_vbus_get16(p) | ((uint32_t)jsd_vbus_get16(p + 2) << 16);
+}
+
+static uint64_t jsd_vbus_get64(const uint8_t* p) {
+  return (uint64_t)jsd_vbus_get32(p) | ((uint64_t)jsd_vbus_get32(p + 4) << 32);
+}
+
+static void jsd_vbus_set16(uint8_t* p, uint16_t value) {
+  p[0] = value & 0xFF;
+  p[1] = value >> 8;
+}
+
+static void jsd_vbus_set32(uint8_t* p, uint32_t value) {
+  jsd_vbus_set16(p, value & 0xFFFF);
+  jsd_vbus_set16(p + 2, value >> 16);
+}
+
+static void jsd_vbus_set64(uint8_t* p, uint64_t value) {
+  jsd_vbus_set32(p, value & 0xFFFFFFFF);
+  jsd_vbus_set32(p + 4, value >> 32);
+}
+
+static bool jsd_vbus_overlaps(uint16_t ado, uint16_t len, uint16_t start,
+                              uint16_t bytes) {
+  return len > 0 && bytes > 0 && ado < start + bytes && start < ado + len;
+}
+
+static bool jsd_vbus_covers(uint16_t ado, uint16_t len, uint16_t address) {
+  return address >= ado && address < ado + len;
+}
+
+static int64_t jsd_vbus_local_time(jsd_vbus_t* self) {
+  return jsd_time_get_mono_time_nsec() - self->epoch_nsec;
+}
+
+static jsd_vbus_slave_t* jsd_vbus_get_slave(jsd_vbus_t* self,
+                                            uint16_t    slave_id) {
+  assert(slave_id >= 1 && slave_id <= self->num_slaves);
+  return &self->slaves[slave_id];
+}
+
+static uint8_t jsd_vbus_al_state(const jsd_vbus_slave_t* slave) {
+  return slave->esc[ECT_REG_ALSTAT] & 0x0F;
+}
+
+/****************************************************
+ * CoE object dictionary
+ ****************************************************/
+
+static jsd_vbus_od_entry_t* jsd_vbus_od_find(jsd_vbus_slave_t* slave,
+                                             uint16_t index, uint8_t subindex) {
+  uint16_t i;
+  for (i = 0; i < slave->od_count; ++i) {
+    if (slave->od[i].index == index && slave->od[i].subindex == subindex) {
+      return &slave->od[i];
+    }
+  }
+  return NULL;
+}
+
+static bool jsd_vbus_od_has_index(jsd_vbus_slave_t* slave, uint16_t index) {
+  uint16_t i;
+  for (i = 0; i < slave->od_count; ++i) {
+    if (slave->od[i].index == index) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static bool jsd_vbus_od_set(jsd_vbus_slave_t* slave, uint16_t index,
+                            uint8_t subindex, const void* data, uint16_t size) {
+  jsd_vbus_od_entry_t* entry = jsd_vbus_od_find(slave, index, subindex);
+
+  // Growing objects are moved to the end of the pool, the old bytes are lost
+  if (entry == NULL || entry->size < size) {
+    if (slave->od_data_used + size > JSD_VBUS_OD_DATA_BYTES) {
+      return false;
+    }
+    if (entry == NULL) {
+      if (slave->od_count >= JSD_VBUS_OD_MAX_ENTRIES) {
+        return false;
+      }
+      entry           = &slave->od[slave->od_count++];
+      entry->index    = index;
+      entry->subindex = subindex;
+    }
+    entry->offset = slave->od_data_used;
+    slave->od_data_used += size;
+  }
+  entry->size = size;
+  memcpy(&slave->od_data[entry->offset], data, size);
+  return true;
+}
+
+static void jsd_vbus_od_set_u8(jsd_vbus_slave_t* slave, uint16_t index,
+                               uint8_t subindex, uint8_t value) {
+  jsd_vbus_od_set(slave, index, subindex, &value, sizeof(value));
+}
+
+static void jsd_vbus_od_set_u16(jsd_vbus_slave_t* slave, uint16_t index,
+                                uint8_t subindex, uint16_t value) {
+  jsd_vbus_od_set(slave, index, subindex, &value, sizeof(value));
+}
+
+static void jsd_vbus_od_set_u32(jsd_vbus_slave_t* slave, uint16_t index,
+                                uint8_t subindex, uint32_t value) {
+  jsd_vbus_od_set(slave, index, subindex, &value, sizeof(value));
+}
+
+/**
+ * @brief Size of the subindices of a complete access when not yet in the OD
+ */
+static uint16_t jsd_vbus_od_ca_entry_size(uint16_t index) {
+  if ((index >= 0x1600 && index < 0x1800) ||
+      (index >= 0x1A00 && index < 0x1C00)) {
+    return sizeof(uint32_t);  // PDO mapping entry
+  }
+  if (index >= 0x1C10 && index < 0x1C30) {
+    return sizeof(uint16_t);  // PDO assignment entry
+  }
+  return 0;
+}
+
+static uint32_t jsd_vbus_od_read(jsd_vbus_slave_t* slave, uint16_t index,
+                                 uint8_t subindex, uint8_t* data,
+                                 uint16_t max_size, uint16_t* size) {
+  jsd_vbus_od_entry_t* entry = jsd_vbus_od_find(slave, index, subindex);
+  if (entry == NULL) {
+    return jsd_vbus_od_has_index(slave, index) ? JSD_VBUS_ABORT_NO_SUBINDEX
+                                               : JSD_VBUS_ABORT_NO_OBJECT;
+  }
+  if (entry->size > max_size) {
+    return JSD_VBUS_ABORT_OUT_OF_MEMORY;
+  }
+  memcpy(data, &slave->od_data[entry->offset], entry->size);
+  *size = entry->size;
+  return 0;
+}
+
+/**
+ * @brief Complete access upload, subindex 0 is padded to 16 bits
+ *
+ * Objects without a subindex 0 are returned whole, which is how JSD reads
+ * record blobs like the ATI calibration.
+ */
+static uint32_t jsd_vbus_od_read_ca(jsd_vbus_slave_t* slave, uint16_t index,
+                                    uint8_t subindex, uint8_t* data,
+                                    uint16_t max_size, uint16_t* size) {
+  jsd_vbus_od_entry_t* count_entry = jsd_vbus_od_find(slave, index, 0);
+  uint16_t             pos         = 0;
+  uint8_t              count;
+  uint8_t              sub;
+
+  if (count_entry == NULL) {
+    return jsd_vbus_od_read(slave, index, subindex, data, max_size, size);
+  }
+  if (subindex > 1) {
+    return JSD_VBUS_ABORT_UNSUPPORTED_ACCESS;
+  }
+
+  count = slave->od_data[count_entry->offset];
+  if (subindex == 0) {
+    if (max_size < 2) {
+      return JSD_VBUS_ABORT_OUT_OF_MEMORY;
+    }
+    data[pos++] = count;
+    data[pos++] = 0;
+  }
+  for (sub = 1; sub <= count; ++sub) {
+    jsd_vbus_od_entry_t* entry = jsd_vbus_od_find(slave, index, sub);
+    if (entry == NULL) {
+      continue;
+    }
+    if (pos + entry->size > max_size) {
+      return JSD_VBUS_ABORT_OUT_OF_MEMORY;
+    }
+    memcpy(&data[pos], &slave->od_data[entry->offset], entry->size);
+    pos += entry->size;
+  }
+  *size = pos;
+  return 0;
+}
+
+static uint32_t jsd_vbus_od_write(jsd_vbus_slave_t* slave, uint16_t index,
+                                  uint8_t subindex, const uint8_t* data,
+                                  uint16_t size) {
+  // The command is executed, the object keeps reading 1
+  if ((index == JSD_VBUS_SDO_STORE_PARAMETERS ||
+       index == JSD_VBUS_SDO_RESTORE_PARAMETERS) &&
+      subindex > 0) {
+    return jsd_vbus_od_find(slave, index, subindex) ? 0
+                                                     : JSD_VBUS_ABORT_NO_OBJECT;
+  }
+  if (!jsd_vbus_od_set(slave, index, subindex, data, size)) {
+    return JSD_VBUS_ABORT_OUT_OF_MEMORY;
+  }
+  return 0;
+}
+
+/**
+ * @brief Complete access download, subindex 0 is padded to 16 bits
+ */
+static uint32_t jsd_vbus_od_write_ca(jsd_vbus_slave_t* slave, uint16_t index,
+                                     uint8_t subindex, const uint8_t* data,
+                                     uint16_t size) {
+  uint16_t pos = 0;
+  uint8_t  count;
+  uint8_t  sub;
+
+  if (subindex == 0) {
+    if (size < 2) {
+      return JSD_VBUS_ABORT_LENGTH;
+    }
+    count = data[0];
+    pos   = 2;
+  } else if (subindex == 1) {
+    jsd_vbus_od_entry_t* count_entry = jsd_vbus_od_find(slave, index, 0);
+    if (count_entry == NULL) {
+      return jsd_vbus_od_write(slave, index, subindex, data, size);
+    }
+    count = slave->od_data[count_entry->offset];
+  } else {
+    return JSD_VBUS_ABORT_UNSUPPORTED_ACCESS;
+  }
+
+  for (sub = 1; sub <= count; ++sub) {
+    jsd_vbus_od_entry_t* entry = jsd_vbus_od_find(slave, index, sub);
+    uint16_t entry_size =
+        entry ? entry->size : jsd_vbus_od_ca_entry_size(index);
+    if (entry_size == 0 || pos + entry_size > size) {
+      return JSD_VBUS_ABORT_LENGTH;
+    }
+    if (!jsd_vbus_od_set(slave, index, sub, &data[pos], entry_size)) {
+      return JSD_VBUS_ABORT_OUT_OF_MEMORY;
+    }
+    pos += entry_size;
+  }
+  if (subindex == 0) {
+    jsd_vbus_od_set_u8(slave, index, 0, count);
+  }
+  return 0;
+}
+
+/**
+ * @brief Assigns one PDO of at most 32-bit entries to a SyncManager
+ */
+static void jsd_vbus_od_add_pdo(jsd_vbus_slave_t* slave, uint16_t assign_index,
+                                uint16_t pdo_index, uint16_t object_index,
+                                uint16_t bits) {
+  uint16_t remaining = bits;
+  uint8_t  sub       = 0;
+
+  while (remaining > 0) {
+    uint8_t length = remaining > 32 ? 32 : remaining;
+    ++sub;
+    jsd_vbus_od_set_u32(
+        slave, pdo_index, sub,
+        ((uint32_t)object_index << 16) | ((uint32_t)sub << 8) | length);
+    remaining -= length;
+  }
+  jsd_vbus_od_set_u8(slave, pdo_index, 0, sub);
+
+  jsd_vbus_od_set_u8(slave, assign_index, 0, bits > 0 ? 1 : 0);
+  jsd_vbus_od_set_u16(slave, assign_index, 1, pdo_index);
+}
+
+static void jsd_vbus_od_add_defaults(jsd_vbus_slave_t*         slave,
+                                     const jsd_vbus_product_t* product,
+                                     uint16_t                  slave_id) {
+  // Identity
+  jsd_vbus_od_set_u8(slave, 0x1018, 0, 4);
+  jsd_vbus_od_set_u32(slave, 0x1018, 1, slave->vendor_id);
+  jsd_vbus_od_set_u32(slave, 0x1018, 2, slave->product_code);
+  jsd_vbus_od_set_u32(slave, 0x1018, 3, 0);
+  jsd_vbus_od_set_u32(slave, 0x1018, 4, slave_id);
+
+  // Parameters are stored and restored on command
+  jsd_vbus_od_set_u8(slave, JSD_VBUS_SDO_STORE_PARAMETERS, 0, 1);
+  jsd_vbus_od_set_u32(slave, JSD_VBUS_SDO_STORE_PARAMETERS, 1, 1);
+  jsd_vbus_od_set_u8(slave, JSD_VBUS_SDO_RESTORE_PARAMETERS, 0, 1);
+  jsd_vbus_od_set_u32(slave, JSD_VBUS_SDO_RESTORE_PARAMETERS, 1, 1);
+
+  // SyncManager communication types
+  jsd_vbus_od_set_u8(slave, ECT_SDO_SMCOMMTYPE, 0, 4);
+  jsd_vbus_od_set_u8(slave, ECT_SDO_SMCOMMTYPE, 1, 1);
+  jsd_vbus_od_set_u8(slave, ECT_SDO_SMCOMMTYPE, 2, 2);
+  jsd_vbus_od_set_u8(slave, ECT_SDO_SMCOMMTYPE, 3, 3);
+  jsd_vbus_od_set_u8(slave, ECT_SDO_SMCOMMTYPE, 4, 4);
+
+  jsd_vbus_od_add_pdo(slave, ECT_SDO_PDOASSIGN + 2, 0x1600, 0x7000,
+                      product->rxpdo_bits);
+  jsd_vbus_od_add_pdo(slave, ECT_SDO_PDOASSIGN + 3, 0x1A00, 0x6000,
+                      product->txpdo_bits);
+
+  // Objects read back by the drivers during configuration
+  switch (slave->product_code) {
+    case JSD_ATI_FTS_PRODUCT_CODE: {
+      jsd_ati_fts_calibration_do_t calibration;
+      memset(&calibration, 0, sizeof(calibration));
+      calibration.counts_per_force  = 1000000;
+      calibration.counts_per_torque = 1000000;
+      jsd_vbus_od_set(slave, 0x2040, 0x01, &calibration, sizeof(calibration));
+      jsd_vbus_od_set_u16(slave, 0x2090, 0x01, 0);
+      jsd_vbus_od_set_u16(slave, 0x2090, 0x02, 0);
+      jsd_vbus_od_set_u16(slave, 0x2090, 0x03, 0);
+      jsd_vbus_od_set_u32(slave, 0x6010, 0x00, 0);
+      break;
+    }
+    case JSD_EPD_PRODUCT_CODE: {
+      int64_t  encoder_counts = 4096;
+      uint64_t clear_faults   = 0;
+      float    max_current    = 20.0f;
+      int16_t  unit_mode      = 5;
+      jsd_vbus_od_set(slave, jsd_epd_lc_to_do("CA"), 18, &encoder_counts,
+                      sizeof(encoder_counts));
+      jsd_vbus_od_set(slave, jsd_epd_lc_to_do("CZ"), 1, &clear_faults,
+                      sizeof(clear_faults));
+      jsd_vbus_od_set(slave, jsd_epd_lc_to_do("MC"), 1, &max_current,
+                      sizeof(max_current));
+      jsd_vbus_od_set(slave, jsd_epd_lc_to_do("UM"), 1, &unit_mode,
+                      sizeof(unit_mode));
+      break;
+    }
+    case JSD_EGD_PRODUCT_CODE: {
+      uint32_t encoder_counts = 4096;
+      int32_t  over_voltage   = 0;
+      float    max_current    = 20.0f;
+      uint32_t unit_mode      = 5;
+      jsd_vbus_od_set_u32(slave, 0x6502, 0, 0x38D);  // supported modes
+
+      // Fixed PDOs the driver assigns next to its own mappings
+      jsd_vbus_od_set_u8(slave, 0x1600, 0, 3);
+      jsd_vbus_od_set_u32(slave, 0x1600, 1, 0x607A0020);
+      jsd_vbus_od_set_u32(slave, 0x1600, 2, 0x60FE0020);
+      jsd_vbus_od_set_u32(slave, 0x1600, 3, 0x60400010);
+      jsd_vbus_od_set_u8(slave, 0x1604, 0, 4);
+      jsd_vbus_od_set_u32(slave, 0x1604, 1, 0x607A0020);
+      jsd_vbus_od_set_u32(slave, 0x1604, 2, 0x60FF0020);
+      jsd_vbus_od_set_u32(slave, 0x1604, 3, 0x60720010);
+      jsd_vbus_od_set_u32(slave, 0x1604, 4, 0x60400010);
+      jsd_vbus_od_set_u8(slave, 0x1A00, 0, 3);
+      jsd_vbus_od_set_u32(slave, 0x1A00, 1, 0x60640020);
+      jsd_vbus_od_set_u32(slave, 0x1A00, 2, 0x60FD0020);
+      jsd_vbus_od_set_u32(slave, 0x1A00, 3, 0x60410010);
+      jsd_vbus_od_set(slave, jsd_egd_tlc_to_do("CA"), 18, &encoder_counts,
+                      sizeof(encoder_counts));
+      jsd_vbus_od_set(slave, jsd_egd_tlc_to_do("OV"), 52, &over_voltage,
+                      sizeof(over_voltage));
+      jsd_vbus_od_set(slave, jsd_egd_tlc_to_do("MC"), 1, &max_current,
+                      sizeof(max_current));
+      jsd_vbus_od_set(slave, jsd_egd_tlc_to_do("UM"), 1, &unit_mode,
+                      sizeof(unit_mode));
+      break;
+    }
+    default:
+      break;
+  }
+}
+
+/****************************************************
+ * SII EEPROM
+ ****************************************************/
+
+static uint16_t jsd_vbus_sii_add_category(uint8_t* sii, uint16_t pos,
+                                          uint16_t type, const uint8_t* data,
+                                          uint16_t bytes) {
+  uint16_t words = (bytes + 1) / 2;
+  jsd_vbus_set16(&sii[pos], type);
+  jsd_vbus_set16(&sii[pos + 2], words);
+  memset(&sii[pos + 4], 0, words * 2);
+  memcpy(&sii[pos + 4], data, bytes);
+  return pos + 4 + words * 2;
+}
+
+static void jsd_vbus_sii_set_sm(uint8_t* sm, uint16_t start, uint16_t bytes,
+                                uint8_t control, uint8_t type) {
+  jsd_vbus_set16(&sm[0], start);
+  jsd_vbus_set16(&sm[2], bytes);
+  sm[4] = control;
+  sm[5] = 0;
+  sm[6] = bytes > 0 ? 0x01 : 0x00;  // enable
+  sm[7] = type;
+}
+
+/**
+ * @brief Single PDO whose entries are at most 32 bits long, like the OD
+ */
+static uint16_t jsd_vbus_sii_add_pdo(uint8_t* sii, uint16_t pos, uint16_t type,
+                                     uint16_t pdo_index, uint16_t object_index,
+                                     uint8_t sm, uint16_t bits) {
+  uint8_t pdo[8 + 255 * 8];
+  uint8_t entries = 0;
+
+  memset(pdo, 0, sizeof(pdo));
+  while (bits > 0 && entries < 255) {
+    uint8_t* entry  = &pdo[8 + entries * 8];
+    uint8_t  length = bits > 32 ? 32 : bits;
+    ++entries;
+    jsd_vbus_set16(&entry[0], object_index);
+    entry[2] = entries;
+    entry[5] = length;
+    bits -= length;
+  }
+  jsd_vbus_set16(&pdo[0], pdo_index);
+  pdo[2] = entries;
+  pdo[3] = sm;
+  return jsd_vbus_sii_add_category(sii, pos, type, pdo, 8 + entries * 8);
+}
+
+static void jsd_vbus_build_sii(jsd_vbus_slave_t*         slave,
+                               const jsd_vbus_product_t* product,
+                               uint16_t                  slave_id) {
+  uint8_t* sii = slave->sii;
+  uint8_t  strings[2 + 255];
+  uint8_t  general[32];
+  uint8_t  fmmu[4]   = {0x01, 0x02, 0x03, 0x00};
+  uint8_t  sm[4 * 8] = {0};
+  uint16_t name_len  = strlen(product->name);
+  uint16_t sm_bytes;
+  uint16_t pos;
+
+  memset(sii, 0xFF, JSD_VBUS_SII_BYTES);
+  memset(sii, 0, 0x80);
+
+  // Identity, in words 0x08-0x0F
+  jsd_vbus_set32(&sii[0x10], slave->vendor_id);
+  jsd_vbus_set32(&sii[0x14], slave->product_code);
+  jsd_vbus_set32(&sii[0x18], 0);
+  jsd_vbus_set32(&sii[0x1C], slave_id);
+
+  // Standard mailbox, in words 0x18-0x1C
+  if (slave->has_mailbox) {
+    jsd_vbus_set16(&sii[0x30], JSD_VBUS_MBX_OUT_START);
+    jsd_vbus_set16(&sii[0x32], JSD_VBUS_MBX_BYTES);
+    jsd_vbus_set16(&sii[0x34], JSD_VBUS_MBX_IN_START);
+    jsd_vbus_set16(&sii[0x36], JSD_VBUS_MBX_BYTES);
+    jsd_vbus_set16(&sii[0x38], ECT_MBXPROT_COE);
+  }
+  jsd_vbus_set16(&sii[0x7C], JSD_VBUS_SII_BYTES * 8 / 1024 - 1);
+  jsd_vbus_set16(&sii[0x7E], 1);
+
+  pos = 0x80;
+
+  strings[0] = 1;
+  strings[1] = name_len;
+  memcpy(&strings[2], product->name, name_len);
+  pos = jsd_vbus_sii_add_category(sii, pos, ECT_SII_STRING, strings,
+                                  2 + name_len);
+
+  memset(general, 0, sizeof(general));
+  general[3] = 1;  // name string index
+  if (slave->has_mailbox) {
+    general[5] = ECT_COEDET_SDO | ECT_COEDET_SDOINFO | ECT_COEDET_PDOASSIGN |
+                 ECT_COEDET_PDOCONFIG;
+  }
+  pos = jsd_vbus_sii_add_category(sii, pos, ECT_SII_GENERAL, general,
+                                  sizeof(general));
+
+  pos = jsd_vbus_sii_add_category(sii, pos, ECT_SII_FMMU, fmmu, sizeof(fmmu));
+
+  if (slave->has_mailbox) {
+    jsd_vbus_sii_set_sm(&sm[0], JSD_VBUS_MBX_OUT_START, JSD_VBUS_MBX_BYTES,
+                        0x26, 1);
+    jsd_vbus_sii_set_sm(&sm[8], JSD_VBUS_MBX_IN_START, JSD_VBUS_MBX_BYTES,
+                        0x22, 2);
+    jsd_vbus_sii_set_sm(&sm[16], slave->rxpdo_start, slave->rxpdo_bytes, 0x64,
+                        3);
+    jsd_vbus_sii_set_sm(&sm[24], slave->txpdo_start, slave->txpdo_bytes, 0x20,
+                        4);
+    sm_bytes = sizeof(sm);
+  } else {
+    jsd_vbus_sii_set_sm(&sm[0], slave->rxpdo_start, slave->rxpdo_bytes, 0x44,
+                        3);
+    sm_bytes = 8;
+  }
+  pos = jsd_vbus_sii_add_category(sii, pos, ECT_SII_SM, sm, sm_bytes);
+
+  if (product->txpdo_bits > 0) {
+    pos = jsd_vbus_sii_add_pdo(sii, pos, ECT_SII_PDO, 0x1A00, 0x6000,
+                               slave->txpdo_sm, product->txpdo_bits);
+  }
+  if (product->rxpdo_bits > 0) {
+    pos = jsd_vbus_sii_add_pdo(sii, pos, ECT_SII_PDO + 1, 0x1600, 0x7000,
+                               slave->rxpdo_sm, product->rxpdo_bits);
+  }
+  jsd_vbus_set16(&sii[pos], 0xFFFF);
+}
+
+/****************************************************
+ * ESC registers
+ ****************************************************/
+
+static void jsd_vbus_reset_esc(jsd_vbus_slave_t* slave) {
+  memset(slave->esc, 0, sizeof(slave->esc));
+  slave->esc[ECT_REG_TYPE]     = 0x11;
+  slave->esc[0x0001]           = 0x01;  // revision
+  slave->esc[0x0004]           = JSD_VBUS_NUM_FMMU;
+  slave->esc[0x0005]           = JSD_VBUS_NUM_SM;
+  slave->esc[0x0006]           = JSD_VBUS_ESC_BYTES / 1024;
+  slave->esc[ECT_REG_PORTDES]  = 0x0F;
+  slave->esc[ECT_REG_ALSTAT]   = EC_STATE_INIT;
+  jsd_vbus_set16(&slave->esc[ECT_REG_ESCSUP], 0x000C);  // DC, 64-bit DC
+}
+
+/**
+ * @brief Line topology: port 0 faces the master, port 1 the next slave
+ */
+static void jsd_vbus_update_topology(jsd_vbus_t* self) {
+  uint16_t slave_id;
+  for (slave_id = 1; slave_id <= self->num_slaves; ++slave_id) {
+    uint16_t status = 0x0010 | 0x0200 | 0x1000 | 0x4000;
+    if (slave_id < self->num_slaves) {
+      status |= 0x0020 | 0x0800;
+    } else {
+      status |= 0x0400;
+    }
+    jsd_vbus_set16(&self->slaves[slave_id].esc[ECT_REG_DLSTAT], status);
+  }
+}
+
+static bool jsd_vbus_is_read_only(uint16_t address) {
+  return address < ECT_REG_STADR ||
+         (address >= ECT_REG_DLSTAT && address < ECT_REG_DLSTAT + 0x10) ||
+         (address >= ECT_REG_ALSTAT && address < ECT_REG_ALSTAT + 0x10) ||
+         (address >= ECT_REG_DCTIME0 && address < ECT_REG_DCSYSOFFSET) ||
+         (address >= ECT_REG_SM0 &&
+          address < ECT_REG_SM0 + JSD_VBUS_NUM_SM * JSD_VBUS_SM_BYTES &&
+          (address - ECT_REG_SM0) % JSD_VBUS_SM_BYTES == JSD_VBUS_SM_STATUS);
+}
+
+static void jsd_vbus_sm_area(const jsd_vbus_slave_t* slave, uint8_t sm,
+                             uint16_t* start, uint16_t* bytes) {
+  const uint8_t* reg = &slave->esc[ECT_REG_SM0 + sm * JSD_VBUS_SM_BYTES];
+  *start             = jsd_vbus_get16(&reg[0]);
+  *bytes             = jsd_vbus_get16(&reg[2]);
+}
+
+static bool jsd_vbus_mailbox_active(const jsd_vbus_slave_t* slave) {
+  uint8_t state = jsd_vbus_al_state(slave);
+  return slave->has_mailbox && state != EC_STATE_INIT &&
+         state != EC_STATE_NONE;
+}
+
+static bool jsd_vbus_mailbox_configured(const jsd_vbus_slave_t* slave) {
+  uint16_t out_start, out_bytes, in_start, in_bytes;
+  jsd_vbus_sm_area(slave, 0, &out_start, &out_bytes);
+  jsd_vbus_sm_area(slave, 1, &in_start, &in_bytes);
+  return out_start == JSD_VBUS_MBX_OUT_START &&
+         out_bytes == JSD_VBUS_MBX_BYTES &&
+         in_start == JSD_VBUS_MBX_IN_START && in_bytes == JSD_VBUS_MBX_BYTES;
+}
+
+static uint16_t jsd_vbus_al_check(const jsd_vbus_slave_t* slave, uint8_t from,
+                                  uint8_t to) {
+  switch (to) {
+    case EC_STATE_INIT:
+      return 0;
+    case EC_STATE_PRE_OP:
+      if (from == EC_STATE_BOOT) {
+        return JSD_VBUS_AL_INVALID_STATE_CHANGE;
+      }
+      if (from == EC_STATE_INIT && slave->has_mailbox &&
+          !jsd_vbus_mailbox_configured(slave)) {
+        return JSD_VBUS_AL_INVALID_MBX_CONFIG;
+      }
+      return 0;
+    case EC_STATE_BOOT:
+      return (from == EC_STATE_INIT || from == EC_STATE_BOOT)
+                 ? 0
+                 : JSD_VBUS_AL_INVALID_STATE_CHANGE;
+    case EC_STATE_SAFE_OP:
+      return (from == EC_STATE_PRE_OP || from == EC_STATE_SAFE_OP ||
+              from == EC_STATE_OPERATIONAL)
+                 ? 0
+                 : JSD_VBUS_AL_INVALID_STATE_CHANGE;
+    case EC_STATE_OPERATIONAL:
+      return (from == EC_STATE_SAFE_OP || from == EC_STATE_OPERATIONAL)
+                 ? 0
+                 : JSD_VBUS_AL_INVALID_STATE_CHANGE;
+    default:
+      return JSD_VBUS_AL_UNKNOWN_STATE;
+  }
+}
+
+static void jsd_vbus_al_control(jsd_vbus_slave_t* slave) {
+  uint8_t  control = slave->esc[ECT_REG_ALCTL];
+  uint8_t  state   = jsd_vbus_al_state(slave);
+  bool     error   = slave->esc[ECT_REG_ALSTAT] & EC_STATE_ERROR;
+  uint16_t code    = jsd_vbus_get16(&slave->esc[ECT_REG_ALSTATCODE]);
+  uint16_t new_code;
+
+  if (control & EC_STATE_ACK) {
+    error = false;
+    code  = 0;
+  } else if (error) {
+    return;  // errors must be acknowledged before changing state
+  }
+
+  new_code = jsd_vbus_al_check(slave, state, control & 0x0F);
+  if (new_code == 0 && slave->safe_op_locked &&
+      (control & 0x0F) == EC_STATE_OPERATIONAL) {
+    new_code = JSD_VBUS_AL_SM_WATCHDOG;
+  }
+  if (new_code != 0) {
+    error = true;
+    code  = new_code;
+  } else {
+    state = control & 0x0F;
+  }
+
+  if (state == EC_STATE_INIT) {
+    slave->esc[ECT_REG_SM0STAT] &= ~JSD_VBUS_SM_STATUS_MBX_FULL;
+    slave->esc[ECT_REG_SM1STAT] &= ~JSD_VBUS_SM_STATUS_MBX_FULL;
+    slave->mbx_response_pending = false;
+    slave->emcy_count           = 0;
+  }
+  slave->esc[ECT_REG_ALSTAT] = state | (error ? EC_STATE_ERROR : 0);
+  jsd_vbus_set16(&slave->esc[ECT_REG_ALSTATCODE], code);
+}
+
+static void jsd_vbus_eeprom(jsd_vbus_slave_t* slave) {
+  uint16_t control = jsd_vbus_get16(&slave->esc[ECT_REG_EEPCTL]);
+  uint32_t byte    = jsd_vbus_get32(&slave->esc[ECT_REG_EEPADR]) * 2;
+  uint16_t status  = 0;
+  int      i;
+
+  switch (control & JSD_VBUS_EEPROM_CMD_MASK) {
+    case 0:
+      break;
+    case JSD_VBUS_EEPROM_CMD_READ:
+      for (i = 0; i < 4; ++i) {
+        slave->esc[ECT_REG_EEPDAT + i] =
+            byte + i < JSD_VBUS_SII_BYTES ? slave->sii[byte + i] : 0xFF;
+      }
+      break;
+    case JSD_VBUS_EEPROM_CMD_WRITE:
+      if (!(control & JSD_VBUS_EEPROM_WRITE_ENABLE)) {
+        status |= JSD_VBUS_EEPROM_ERROR_WRITE_ENABLE;
+      } else if (byte + 2 <= JSD_VBUS_SII_BYTES) {
+        memcpy(&slave->sii[byte], &slave->esc[ECT_REG_EEPDAT], 2);
+      }
+      break;
+    case JSD_VBUS_EEPROM_CMD_RELOAD:
+    case JSD_VBUS_EEPROM_CMD_RELOAD_SOEM:
+      break;  // the SII never changes behind the ESC
+    default:
+      status |= JSD_VBUS_EEPROM_ERROR_CMD;
+      break;
+  }
+  jsd_vbus_set16(&slave->esc[ECT_REG_EEPSTAT], status);
+}
+
+static void jsd_vbus_dc_latch(jsd_vbus_t* self, jsd_vbus_slave_t* slave) {
+  int64_t local = jsd_vbus_local_time(self);
+  jsd_vbus_set32(&slave->esc[ECT_REG_DCTIME0], local);
+  jsd_vbus_set32(&slave->esc[ECT_REG_DCTIME1], local);
+  jsd_vbus_set32(&slave->esc[ECT_REG_DCTIME2], local);
+  jsd_vbus_set32(&slave->esc[ECT_REG_DCTIME3], local);
+  jsd_vbus_set64(&slave->esc[ECT_REG_DCSOF], local);
+}
+
+/****************************************************
+ * CoE mailbox
+ ****************************************************/
+
+static uint16_t jsd_vbus_sdo_abort(uint8_t* response, uint16_t index,
+                                   uint8_t subindex, uint32_t code) {
+  response[JSD_VBUS_SDO_CMD] = ECT_SDO_ABORT;
+  jsd_vbus_set16(&response[JSD_VBUS_SDO_INDEX], index);
+  response[JSD_VBUS_SDO_SUBINDEX] = subindex;
+  jsd_vbus_set32(&response[JSD_VBUS_SDO_DATA], code);
+  return JSD_VBUS_SDO_BYTES;
+}
+
+/**
+ * @brief Serves an SDO request, returns the length of the response payload
+ *
+ * Segmented transfers are not supported: the mailboxes are sized so JSD never
+ * needs them.
+ */
+static uint16_t jsd_vbus_sdo(jsd_vbus_slave_t* slave, const uint8_t* request,
+                             uint8_t* response, uint16_t response_bytes) {
+  uint16_t length   = jsd_vbus_get16(&request[0]);
+  uint8_t  command  = request[JSD_VBUS_SDO_CMD];
+  uint16_t index    = jsd_vbus_get16(&request[JSD_VBUS_SDO_INDEX]);
+  uint8_t  subindex = request[JSD_VBUS_SDO_SUBINDEX];
+  bool     ca       = command & JSD_VBUS_SDO_CA;
+  uint32_t abort;
+
+  jsd_vbus_set16(&response[6], ECT_COES_SDORES << 12);
+
+  if (length < JSD_VBUS_SDO_BYTES) {
+    return jsd_vbus_sdo_abort(response, index, subindex,
+                              JSD_VBUS_ABORT_UNSUPPORTED);
+  }
+
+  switch (command >> 5) {
+    case JSD_VBUS_SDO_CCS_DOWNLOAD: {
+      const uint8_t* data;
+      uint32_t       size;
+      if (command & 0x02) {
+        size = (command & 0x01) ? 4 - ((command >> 2) & 0x03) : 4;
+        data = &request[JSD_VBUS_SDO_DATA];
+      } else {
+        size = jsd_vbus_get32(&request[JSD_VBUS_SDO_DATA]);
+        data = &request[JSD_VBUS_SDO_DATA + 4];
+        if (length < JSD_VBUS_SDO_BYTES + 4 ||
+            size > length - JSD_VBUS_SDO_BYTES - 4u) {
+          return jsd_vbus_sdo_abort(response, index, subindex,
+                                    JSD_VBUS_ABORT_UNSUPPORTED);
+        }
+      }
+      abort = ca ? jsd_vbus_od_write_ca(slave, index, subindex, data, size)
+                 : jsd_vbus_od_write(slave, index, subindex, data, size);
+      if (abort != 0) {
+        return jsd_vbus_sdo_abort(response, index, subindex, abort);
+      }
+      ++slave->sdo_downloads;
+      response[JSD_VBUS_SDO_CMD] = JSD_VBUS_SDO_DOWNLOAD_RESPONSE;
+      jsd_vbus_set16(&response[JSD_VBUS_SDO_INDEX], index);
+      response[JSD_VBUS_SDO_SUBINDEX] = subindex;
+      return JSD_VBUS_SDO_BYTES;
+    }
+    case JSD_VBUS_SDO_CCS_UPLOAD: {
+      uint8_t* data      = &response[JSD_VBUS_SDO_DATA + 4];
+      uint16_t max_size  = response_bytes - JSD_VBUS_SDO_DATA - 4;
+      uint16_t size      = 0;
+      abort = ca ? jsd_vbus_od_read_ca(slave, index, subindex, data, max_size,
+                                       &size)
+                 : jsd_vbus_od_read(slave, index, subindex, data, max_size,
+                                    &size);
+      if (abort != 0) {
+        return jsd_vbus_sdo_abort(response, index, subindex, abort);
+      }
+      jsd_vbus_set16(&response[JSD_VBUS_SDO_INDEX], index);
+      response[JSD_VBUS_SDO_SUBINDEX] = subindex;
+      if (!ca && size <= 4) {
+        response[JSD_VBUS_SDO_CMD] =
+            JSD_VBUS_SDO_UPLOAD_EXPEDITED | ((4 - size) << 2);
+        memmove(&response[JSD_VBUS_SDO_DATA], data, size);
+        memset(&response[JSD_VBUS_SDO_DATA + size], 0, 4 - size);
+        return JSD_VBUS_SDO_BYTES;
+      }
+      response[JSD_VBUS_SDO_CMD] = JSD_VBUS_SDO_UPLOAD_RESPONSE;
+      jsd_vbus_set32(&response[JSD_VBUS_SDO_DATA], size);
+      return JSD_VBUS_SDO_BYTES + 4 + size;
+    }
+    default:
+      return jsd_vbus_sdo_abort(response, index, subindex,
+                                JSD_VBUS_ABORT_UNSUPPORTED);
+  }
+}
+
+/**
+ * @brief Fills an empty input mailbox, SDO responses before emergencies
+ */
+static void jsd_vbus_mailbox_flush(jsd_vbus_slave_t* slave) {
+  uint8_t  emcy[JSD_VBUS_MBX_HEADER_BYTES + 10];
+  uint16_t in_start, in_bytes;
+
+  jsd_vbus_sm_area(slave, 1, &in_start, &in_bytes);
+  if ((slave->esc[ECT_REG_SM1STAT] & JSD_VBUS_SM_STATUS_MBX_FULL) ||
+      in_bytes < sizeof(emcy) || in_start + in_bytes > JSD_VBUS_ESC_BYTES) {
+    return;
+  }
+  if (in_bytes > JSD_VBUS_MBX_BYTES) {
+    in_bytes = JSD_VBUS_MBX_BYTES;
+  }
+
+  if (slave->mbx_response_pending) {
+    memcpy(&slave->esc[in_start], slave->mbx_response, in_bytes);
+    slave->mbx_response_pending = false;
+  } else if (slave->emcy_count > 0 && !slave->emcy_held) {
+    memset(emcy, 0, sizeof(emcy));
+    jsd_vbus_set16(&emcy[0], 10);
+    emcy[5] = ECT_MBXT_COE;
+    jsd_vbus_set16(&emcy[6], ECT_COES_EMERGENCY << 12);
+    jsd_vbus_set16(&emcy[8], slave->emcy[0].error_code);
+    emcy[10] = slave->emcy[0].error_register;
+    memcpy(&slave->esc[in_start], emcy, sizeof(emcy));
+    --slave->emcy_count;
+    memmove(&slave->emcy[0], &slave->emcy[1],
+            slave->emcy_count * sizeof(slave->emcy[0]));
+  } else {
+    return;
+  }
+  slave->esc[ECT_REG_SM1STAT] |= JSD_VBUS_SM_STATUS_MBX_FULL;
+}
+
+/**
+ * @brief Serves the request in the output mailbox into the input mailbox
+ */
+static void jsd_vbus_mailbox(jsd_vbus_slave_t* slave) {
+  uint8_t* response = slave->mbx_response;
+  uint16_t out_start, out_bytes, in_start, in_bytes;
+  const uint8_t* request;
+  uint8_t        type;
+  uint16_t       length;
+
+  jsd_vbus_sm_area(slave, 0, &out_start, &out_bytes);
+  jsd_vbus_sm_area(slave, 1, &in_start, &in_bytes);
+  if (out_bytes < JSD_VBUS_MBX_HEADER_BYTES + 2 ||
+      in_bytes < JSD_VBUS_MBX_HEADER_BYTES + JSD_VBUS_SDO_BYTES + 4 ||
+      out_start + out_bytes > JSD_VBUS_ESC_BYTES ||
+      in_start + in_bytes > JSD_VBUS_ESC_BYTES) {
+    return;
+  }
+  request = &slave->esc[out_start];
+  type    = request[5] & 0x0F;
+
+  memset(response, 0, JSD_VBUS_MBX_BYTES);
+  if (type == ECT_MBXT_COE &&
+      (jsd_vbus_get16(&request[6]) >> 12) == ECT_COES_SDOREQ) {
+    uint16_t response_bytes =
+        in_bytes < JSD_VBUS_MBX_BYTES ? in_bytes : JSD_VBUS_MBX_BYTES;
+    length = jsd_vbus_sdo(slave, request, response, response_bytes);
+  } else {
+    type = ECT_MBXT_ERR;
+    jsd_vbus_set16(&response[6], 0x0001);  // command
+    jsd_vbus_set16(&response[8], EC_MBXERR_UNSUPPORTEDPROTOCOL);
+    length = 4;
+  }
+  jsd_vbus_set16(&response[0], length);
+  response[5] = (request[5] & 0x70) | type;  // echo the counter
+
+  slave->mbx_response_pending = true;
+  jsd_vbus_mailbox_flush(slave);
+}
+
+/****************************************************
+ * Datagram access
+ ****************************************************/
+
+static bool jsd_vbus_esc_read(jsd_vbus_t* self, jsd_vbus_slave_t* slave,
+                              uint16_t ado, uint8_t* data, uint16_t len,
+                              bool merge) {
+  bool     empty_mailbox = false;
+  uint16_t in_start, in_bytes;
+  uint16_t valid;
+  uint16_t i;
+
+  if (ado >= JSD_VBUS_ESC_BYTES) {
+    return true;
+  }
+  valid = len;
+  if (ado + len > JSD_VBUS_ESC_BYTES) {
+    valid = JSD_VBUS_ESC_BYTES - ado;
+  }
+
+  if (jsd_vbus_mailbox_active(slave)) {
+    jsd_vbus_sm_area(slave, 1, &in_start, &in_bytes);
+    if (jsd_vbus_overlaps(ado, valid, in_start, in_bytes)) {
+      if (!(slave->esc[ECT_REG_SM1STAT] & JSD_VBUS_SM_STATUS_MBX_FULL)) {
+        return false;
+      }
+      empty_mailbox = jsd_vbus_covers(ado, valid, in_start + in_bytes - 1);
+    }
+  }
+
+  if (jsd_vbus_overlaps(ado, valid, ECT_REG_DCSYSTIME, 8)) {
+    jsd_vbus_set64(&slave->esc[ECT_REG_DCSYSTIME],
+                   jsd_vbus_local_time(self) +
+                       jsd_vbus_get64(&slave->esc[ECT_REG_DCSYSOFFSET]));
+  }
+
+  if (merge) {
+    for (i = 0; i < valid; ++i) {
+      data[i] |= slave->esc[ado + i];
+    }
+  } else {
+    memcpy(data, &slave->esc[ado], valid);
+  }
+
+  if (empty_mailbox) {
+    slave->esc[ECT_REG_SM1STAT] &= ~JSD_VBUS_SM_STATUS_MBX_FULL;
+    jsd_vbus_mailbox_flush(slave);
+  }
+  return true;
+}
+
+static bool jsd_vbus_esc_write(jsd_vbus_t* self, jsd_vbus_slave_t* slave,
+                               uint16_t ado, const uint8_t* data,
+                               uint16_t len) {
+  bool     mailbox = false;
+  uint16_t out_start, out_bytes;
+  uint16_t valid;
+  uint16_t i;
+
+  if (ado >= JSD_VBUS_ESC_BYTES) {
+    return true;
+  }
+  valid = len;
+  if (ado + len > JSD_VBUS_ESC_BYTES) {
+    valid = JSD_VBUS_ESC_BYTES - ado;
+  }
+
+  if (jsd_vbus_mailbox_active(slave)) {
+    jsd_vbus_sm_area(slave, 0, &out_start, &out_bytes);
+    mailbox = jsd_vbus_covers(ado, valid, out_start + out_bytes - 1) &&
+              out_bytes > 0;
+  }
+
+  for (i = 0; i < valid; ++i) {
+    if (!jsd_vbus_is_read_only(ado + i)) {
+      slave->esc[ado + i] = data[i];
+    }
+  }
+
+  if (jsd_vbus_covers(ado, valid, ECT_REG_ALCTL)) {
+    jsd_vbus_al_control(slave);
+    if (jsd_vbus_mailbox_active(slave)) {
+      jsd_vbus_mailbox_flush(slave);  // emergencies queued before PRE-OP
+    }
+  }
+  if (jsd_vbus_covers(ado, valid, ECT_REG_EEPCTL) ||
+      jsd_vbus_covers(ado, valid, ECT_REG_EEPCTL + 1)) {
+    jsd_vbus_eeprom(slave);
+  }
+  if (jsd_vbus_covers(ado, valid, ECT_REG_DCTIME0)) {
+    jsd_vbus_dc_latch(self, slave);
+  }
+  if (mailbox && !slave->mailbox_muted) {
+    jsd_vbus_mailbox(slave);
+  }
+  return true;
+}
+
+/**
+ * @brief Physical read/write of one slave, returns its working counter share
+ */
+static uint16_t jsd_vbus_physical(jsd_vbus_t* self, jsd_vbus_slave_t* slave,
+                                  uint8_t cmd, uint16_t ado, uint8_t* data,
+                                  uint16_t len) {
+  uint8_t  written[EC_BUFSIZE];
+  uint16_t wkc = 0;
+
+  switch (cmd) {
+    case EC_CMD_APRD:
+    case EC_CMD_FPRD:
+    case EC_CMD_ARMW:
+    case EC_CMD_FRMW:
+      return jsd_vbus_esc_read(self, slave, ado, data, len, false) ? 1 : 0;
+    case EC_CMD_BRD:
+      return jsd_vbus_esc_read(self, slave, ado, data, len, true) ? 1 : 0;
+    case EC_CMD_APWR:
+    case EC_CMD_FPWR:
+    case EC_CMD_BWR:
+      return jsd_vbus_esc_write(self, slave, ado, data, len) ? 1 : 0;
+    case EC_CMD_APRW:
+    case EC_CMD_FPRW:
+    case EC_CMD_BRW:
+      if (len > sizeof(written)) {
+        return 0;
+      }
+      memcpy(written, data, len);
+      if (jsd_vbus_esc_read(self, slave, ado, data, len, cmd == EC_CMD_BRW)) {
+        wkc += 1;
+      }
+      if (jsd_vbus_esc_write(self, slave, ado, written, len)) {
+        wkc += 2;
+      }
+      return wkc;
+    default:
+      return 0;
+  }
+}
+
+/**
+ * @brief Copies the bits of one FMMU between the datagram and ESC memory
+ *
+ * @return true if the FMMU overlaps the datagram
+ */
+static bool jsd_vbus_fmmu_copy(jsd_vbus_slave_t* slave, const uint8_t* fmmu,
+                               uint32_t address, uint8_t* data, uint16_t len,
+                               bool write) {
+  uint32_t logical   = jsd_vbus_get32(&fmmu[0]);
+  uint16_t log_bytes = jsd_vbus_get16(&fmmu[4]);
+  uint16_t physical  = jsd_vbus_get16(&fmmu[8]);
+  uint8_t  phys_bit  = fmmu[10] & 0x07;
+  uint64_t first     = (uint64_t)logical * 8 + (fmmu[6] & 0x07);
+  uint64_t last = ((uint64_t)logical + log_bytes - 1) * 8 + (fmmu[7] & 0x07);
+  uint64_t frame_first = (uint64_t)address * 8;
+  uint64_t frame_last  = ((uint64_t)address + len) * 8 - 1;
+  uint64_t lo, hi, bit;
+
+  if (log_bytes == 0 || len == 0) {
+    return false;
+  }
+  lo = first > frame_first ? first : frame_first;
+  hi = last < frame_last ? last : frame_last;
+  if (lo > hi) {
+    return false;
+  }
+
+  // Byte aligned mappings, which is all of JSD's devices but the EL2124
+  if (first % 8 == 0 && phys_bit == 0 && lo % 8 == 0 && hi % 8 == 7) {
+    uint64_t esc_offset   = physical + (lo - first) / 8;
+    uint64_t frame_offset = (lo - frame_first) / 8;
+    uint64_t bytes        = (hi - lo + 1) / 8;
+    if (esc_offset >= JSD_VBUS_ESC_BYTES) {
+      return true;
+    }
+    if (esc_offset + bytes > JSD_VBUS_ESC_BYTES) {
+      bytes = JSD_VBUS_ESC_BYTES - esc_offset;
+    }
+    if (write) {
+      memcpy(&slave->esc[esc_offset], &data[frame_offset], bytes);
+    } else {
+      memcpy(&data[frame_offset], &slave->esc[esc_offset], bytes);
+    }
+    return true;
+  }
+
+  for (bit = lo; bit <= hi; ++bit) {
+    uint64_t phys        = (uint64_t)physical * 8 + phys_bit + (bit - first);
+    uint8_t* frame_byte  = &data[(bit - frame_first) / 8];
+    uint8_t  frame_mask  = 1 << (bit % 8);
+    uint8_t* esc_byte;
+    uint8_t  esc_mask;
+    if (phys / 8 >= JSD_VBUS_ESC_BYTES) {
+      break;
+    }
+    esc_byte = &slave->esc[phys / 8];
+    esc_mask = 1 << (phys % 8);
+    if (write) {
+      *esc_byte = (*frame_byte & frame_mask) ? (*esc_byte | esc_mask)
+                                             : (*esc_byte & ~esc_mask);
+    } else {
+      *frame_byte = (*esc_byte & esc_mask) ? (*frame_byte | frame_mask)
+                                           : (*frame_byte & ~frame_mask);
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief Logical read/write of one slave, returns its working counter share
+ */
+static uint16_t jsd_vbus_logical(jsd_vbus_slave_t* slave, uint8_t cmd,
+                                 uint32_t address, uint8_t* data,
+                                 uint16_t len) {
+  uint8_t state = jsd_vbus_al_state(slave);
+  bool    wrote = false;
+  bool    read  = false;
+  int     i;
+
+  if (state != EC_STATE_SAFE_OP && state != EC_STATE_OPERATIONAL) {
+    return 0;
+  }
+
+  // Outputs leave the frame before inputs replace them, which is what lets
+  // SOEM overlap the inputs and outputs of a slave in the IOmap
+  for (i = 0; i < JSD_VBUS_NUM_FMMU && cmd != EC_CMD_LRD; ++i) {
+    const uint8_t* fmmu = &slave->esc[ECT_REG_FMMU0 + i * JSD_VBUS_FMMU_BYTES];
+    if ((fmmu[11] & 0x02) && (fmmu[12] & 0x01)) {
+      wrote |= jsd_vbus_fmmu_copy(slave, fmmu, address, data, len, true);
+    }
+  }
+  for (i = 0; i < JSD_VBUS_NUM_FMMU && cmd != EC_CMD_LWR; ++i) {
+    const uint8_t* fmmu = &slave->esc[ECT_REG_FMMU0 + i * JSD_VBUS_FMMU_BYTES];
+    if ((fmmu[11] & 0x01) && (fmmu[12] & 0x01)) {
+      read |= jsd_vbus_fmmu_copy(slave, fmmu, address, data, len, false);
+    }
+  }
+
+  if (wrote || read) {
+    slave->pdo_exchanged = true;
+  }
+  return (read ? 1 : 0) + (wrote ? (cmd == EC_CMD_LRW ? 2 : 1) : 0);
+}
+
+static void jsd_vbus_process_datagram(jsd_vbus_t* self, uint8_t* datagram) {
+  uint8_t  cmd  = datagram[0];
+  uint16_t adp  = jsd_vbus_get16(&datagram[2]);
+  uint16_t ado  = jsd_vbus_get16(&datagram[4]);
+  uint32_t address = jsd_vbus_get32(&datagram[2]);
+  uint16_t len  = jsd_vbus_get16(&datagram[6]) & JSD_VBUS_DATAGRAM_LENGTH_MASK;
+  uint8_t* data = &datagram[JSD_VBUS_DATAGRAM_HEADER_BYTES];
+  uint16_t wkc  = jsd_vbus_get16(&data[len]);
+  uint16_t share;
+  uint16_t slave_id;
+
+  for (slave_id = 1; slave_id <= self->num_slaves; ++slave_id) {
+    jsd_vbus_slave_t* slave = &self->slaves[slave_id];
+    if (slave->lost) {
+      continue;  // the frame bypasses it, positions shift
+    }
+    switch (cmd) {
+      case EC_CMD_APRD:
+      case EC_CMD_APWR:
+      case EC_CMD_APRW:
+      case EC_CMD_ARMW:
+        // Each slave increments the position, the one at zero is addressed
+        if (adp == 0) {
+          wkc += jsd_vbus_physical(self, slave, cmd, ado, data, len);
+        } else if (cmd == EC_CMD_ARMW) {
+          wkc += jsd_vbus_esc_write(self, slave, ado, data, len) ? 1 : 0;
+        }
+        ++adp;
+        break;
+      case EC_CMD_FPRD:
+      case EC_CMD_FPWR:
+      case EC_CMD_FPRW:
+      case EC_CMD_FRMW:
+        if (jsd_vbus_get16(&slave->esc[ECT_REG_STADR]) == adp) {
+          wkc += jsd_vbus_physical(self, slave, cmd, ado, data, len);
+        } else if (cmd == EC_CMD_FRMW) {
+          wkc += jsd_vbus_esc_write(self, slave, ado, data, len) ? 1 : 0;
+        }
+        break;
+      case EC_CMD_BRD:
+      case EC_CMD_BWR:
+      case EC_CMD_BRW:
+        wkc += jsd_vbus_physical(self, slave, cmd, ado, data, len);
+        ++adp;
+        break;
+      case EC_CMD_LRD:
+      case EC_CMD_LWR:
+      case EC_CMD_LRW:
+        share = jsd_vbus_logical(slave, cmd, address, data, len);
+        wkc += slave->wkc_corrupted ? 0 : share;
+        break;
+      default:
+        break;
+    }
+  }
+
+  if (cmd != EC_CMD_LRD && cmd != EC_CMD_LWR && cmd != EC_CMD_LRW) {
+    jsd_vbus_set16(&datagram[2], adp);
+  }
+  jsd_vbus_set16(&data[len], wkc);
+}
+
+static void jsd_vbus_pdo_area(const jsd_vbus_slave_t* slave, uint8_t sm,
+                              uint16_t default_start, uint16_t default_bytes,
+                              uint16_t* start, uint16_t* bytes) {
+  jsd_vbus_sm_area(slave, sm, start, bytes);
+  if (*bytes == 0) {
+    *start = default_start;
+    *bytes = default_bytes;
+  }
+  if (*start >= JSD_VBUS_ESC_BYTES) {
+    *start = 0;
+    *bytes = 0;
+  } else if (*start + *bytes > JSD_VBUS_ESC_BYTES) {
+    *bytes = JSD_VBUS_ESC_BYTES - *start;
+  }
+}
+
+static void jsd_vbus_rxpdo_area(const jsd_vbus_slave_t* slave,
+                                uint16_t* start, uint16_t* bytes) {
+  jsd_vbus_pdo_area(slave, slave->rxpdo_sm, slave->rxpdo_start,
+                    slave->rxpdo_bytes, start, bytes);
+}
+
+static void jsd_vbus_txpdo_area(const jsd_vbus_slave_t* slave,
+                                uint16_t* start, uint16_t* bytes) {
+  jsd_vbus_pdo_area(slave, slave->txpdo_sm, slave->txpdo_start,
+                    slave->txpdo_bytes, start, bytes);
+}
+
+static void jsd_vbus_run_models(jsd_vbus_t* self) {
+  uint16_t slave_id;
+  for (slave_id = 1; slave_id <= self->num_slaves; ++slave_id) {
+    jsd_vbus_slave_t* slave = &self->slaves[slave_id];
+    uint16_t          rx_start, rx_bytes, tx_start, tx_bytes;
+
+    if (!slave->pdo_exchanged) {
+      continue;
+    }
+    slave->pdo_exchanged = false;
+    if (slave->model == NULL) {
+      continue;
+    }
+    jsd_vbus_rxpdo_area(slave, &rx_start, &rx_bytes);
+    jsd_vbus_txpdo_area(slave, &tx_start, &tx_bytes);
+    slave->model(self, slave_id, &slave->esc[rx_start], rx_bytes,
+                 &slave->esc[tx_start], tx_bytes, jsd_vbus_local_time(self),
+                 slave->model_user);
+  }
+}
+
+/****************************************************
+ * Fault injection
+ ****************************************************/
+
+static const char* jsd_vbus_fault_type_strings[] = {
+    [JSD_VBUS_FAULT_DROP_FRAME]      = "drop frame",
+    [JSD_VBUS_FAULT_CORRUPT_WKC]     = "corrupt WKC",
+    [JSD_VBUS_FAULT_SAFE_OP_ERROR]   = "SAFE-OP + ERROR",
+    [JSD_VBUS_FAULT_SLAVE_LOST]      = "slave lost",
+    [JSD_VBUS_FAULT_MAILBOX_TIMEOUT] = "mailbox timeout",
+    [JSD_VBUS_FAULT_DELAY_EMCY]      = "delay EMCY",
+};
+
+static bool jsd_vbus_fault_is_active(const jsd_vbus_injected_fault_t* injected,
+                                     uint64_t frame) {
+  return frame >= injected->start_frame &&
+         (injected->end_frame == 0 || frame < injected->end_frame);
+}
+
+static void jsd_vbus_fault_set_flags(jsd_vbus_t*             self,
+                                     const jsd_vbus_fault_t* fault) {
+  uint16_t first = fault->slave_id ? fault->slave_id : 1;
+  uint16_t last  = fault->slave_id ? fault->slave_id : self->num_slaves;
+  uint16_t slave_id;
+
+  if (fault->type == JSD_VBUS_FAULT_DROP_FRAME) {
+    self->dropping_frames = true;
+    return;
+  }
+  for (slave_id = first; slave_id <= last; ++slave_id) {
+    jsd_vbus_slave_t* slave = &self->slaves[slave_id];
+    switch (fault->type) {
+      case JSD_VBUS_FAULT_CORRUPT_WKC:
+        slave->wkc_corrupted = true;
+        break;
+      case JSD_VBUS_FAULT_SAFE_OP_ERROR:
+        slave->safe_op_locked = true;
+        break;
+      case JSD_VBUS_FAULT_SLAVE_LOST:
+        slave->lost = true;
+        break;
+      case JSD_VBUS_FAULT_MAILBOX_TIMEOUT:
+        slave->mailbox_muted = true;
+        break;
+      case JSD_VBUS_FAULT_DELAY_EMCY:
+        slave->emcy_held = true;
+        break;
+      default:
+        break;
+    }
+  }
+}
+
+/**
+ * @brief Applies the state changes at the start or end of a fault, after the
+ *        flags of the current frame are set
+ */
+static void jsd_vbus_fault_transition(jsd_vbus_t*             self,
+                                      const jsd_vbus_fault_t* fault,
+                                      bool                    begin) {
+  uint16_t first = fault->slave_id ? fault->slave_id : 1;
+  uint16_t last  = fault->slave_id ? fault->slave_id : self->num_slaves;
+  uint16_t slave_id;
+
+  for (slave_id = first; slave_id <= last; ++slave_id) {
+    jsd_vbus_slave_t* slave = &self->slaves[slave_id];
+    uint8_t           state = jsd_vbus_al_state(slave);
+
+    if (begin && fault->type == JSD_VBUS_FAULT_SAFE_OP_ERROR &&
+        (state == EC_STATE_SAFE_OP || state == EC_STATE_OPERATIONAL)) {
+      slave->esc[ECT_REG_ALSTAT] = EC_STATE_SAFE_OP | EC_STATE_ERROR;
+      jsd_vbus_set16(&slave->esc[ECT_REG_ALSTATCODE], JSD_VBUS_AL_SM_WATCHDOG);
+    } else if (!begin && fault->type == JSD_VBUS_FAULT_SLAVE_LOST &&
+               !slave->lost) {
+      // Reconnected slaves power up like after a cable or supply loss
+      jsd_vbus_reset_esc(slave);
+      slave->mbx_response_pending = false;
+      slave->emcy_count           = 0;
+      slave->pdo_exchanged        = false;
+      jsd_vbus_update_topology(self);
+    } else if (!begin && fault->type == JSD_VBUS_FAULT_DELAY_EMCY &&
+               !slave->emcy_held && jsd_vbus_mailbox_active(slave)) {
+      jsd_vbus_mailbox_flush(slave);
+    }
+  }
+}
+
+static void jsd_vbus_evaluate_faults(jsd_vbus_t* self) {
+  uint16_t kept = 0;
+  uint16_t slave_id;
+  uint16_t i;
+
+  self->dropping_frames = false;
+  for (slave_id = 1; slave_id <= self->num_slaves; ++slave_id) {
+    jsd_vbus_slave_t* slave = &self->slaves[slave_id];
+    slave->lost             = false;
+    slave->wkc_corrupted    = false;
+    slave->safe_op_locked   = false;
+    slave->mailbox_muted    = false;
+    slave->emcy_held        = false;
+  }
+  for (i = 0; i < self->num_faults; ++i) {
+    if (jsd_vbus_fault_is_active(&self->faults[i], self->frame_count)) {
+      jsd_vbus_fault_set_flags(self, &self->faults[i].fault);
+    }
+  }
+
+  for (i = 0; i < self->num_faults; ++i) {
+    jsd_vbus_injected_fault_t injected = self->faults[i];
+    bool active = jsd_vbus_fault_is_active(&injected, self->frame_count);
+    if (active != injected.active) {
+      jsd_vbus_fault_transition(self, &injected.fault, active);
+      injected.active = active;
+    }
+    if (active || self->frame_count < injected.start_frame) {
+      self->faults[kept++] = injected;
+    }
+  }
+  self->num_faults = kept;
+}
+
+/****************************************************
+ * Socket transport
+ ****************************************************/
+
+/**
+ * @brief Mirrors ecx_setupnic(...) with a socket pair instead of a raw socket
+ */
+static void jsd_vbus_setup_port(ecx_portt* port, int socket) {
+  pthread_mutexattr_t mutexattr;
+  int                 i;
+
+  pthread_mutexattr_init(&mutexattr);
+  pthread_mutexattr_setprotocol(&mutexattr, PTHREAD_PRIO_INHERIT);
+  pthread_mutex_init(&port->getindex_mutex, &mutexattr);
+  pthread_mutex_init(&port->tx_mutex, &mutexattr);
+  pthread_mutex_init(&port->rx_mutex, &mutexattr);
+  pthread_mutexattr_destroy(&mutexattr);
+
+  port->sockhandle        = socket;
+  port->lastidx           = 0;
+  port->redstate          = ECT_RED_NONE;
+  port->redport           = NULL;
+  port->stack.sock        = &port->sockhandle;
+  port->stack.txbuf       = &port->txbuf;
+  port->stack.txbuflength = &port->txbuflength;
+  port->stack.tempbuf     = &port->tempinbuf;
+  port->stack.rxbuf       = &port->rxbuf;
+  port->stack.rxbufstat   = &port->rxbufstat;
+  port->stack.rxsa        = &port->rxsa;
+
+  for (i = 0; i < EC_MAXBUF; i++) {
+    ec_setupheader(&port->txbuf[i]);
+    port->rxbufstat[i] = EC_BUF_EMPTY;
+  }
+  ec_setupheader(&port->txbuf2);
+}
+
+static void* jsd_vbus_thread_loop(void* void_data) {
+  jsd_vbus_t* self = (jsd_vbus_t*)void_data;
+  uint8_t     frame[EC_BUFSIZE];
+
+  while (true) {
+    ssize_t bytes = recv(self->socket, frame, sizeof(frame), 0);
+    size_t  reply;
+    if (bytes == 0) {
+      break;  // port closed
+    }
+    if (bytes < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      ERROR("Virtual bus receive failed: %s", strerror(errno));
+      break;
+    }
+    reply = jsd_vbus_process_frame(self, frame, bytes);
+    if (reply > 0 && send(self->socket, frame, reply, MSG_NOSIGNAL) < 0) {
+      break;
+    }
+  }
+  return NULL;
+}
+
+/****************************************************
+ * Public functions
+ ****************************************************/
+
+jsd_vbus_t* jsd_vbus_alloc() {
+  jsd_vbus_t*         self = (jsd_vbus_t*)calloc(1, sizeof(jsd_vbus_t));
+  pthread_mutexattr_t mutexattr;
+  assert(self);
+
+  // Recursive so models may use the public API from their callback
+  pthread_mutexattr_init(&mutexattr);
+  pthread_mutexattr_settype(&mutexattr, PTHREAD_MUTEX_RECURSIVE);
+  pthread_mutex_init(&self->mutex, &mutexattr);
+  pthread_mutexattr_destroy(&mutexattr);
+
+  self->socket     = -1;
+  self->epoch_nsec = jsd_time_get_mono_time_nsec();
+  return self;
+}
+
+void jsd_vbus_free(jsd_vbus_t* self) {
+  if (self == NULL) {
+    return;
+  }
+  if (self->thread_running) {
+    shutdown(self->socket, SHUT_RDWR);
+    pthread_join(self->thread, NULL);
+  }
+  if (self->socket >= 0) {
+    close(self->socket);
+  }
+  pthread_mutex_destroy(&self->mutex);
+  free(self);
+}
+
+uint16_t jsd_vbus_add_slave(jsd_vbus_t* self, uint32_t product_code) {
+  assert(self);
+  const jsd_vbus_product_t* product = NULL;
+  jsd_vbus_slave_t*         slave;
+  uint16_t                  slave_id;
+  size_t                    i;
+
+  for (i = 0; i < sizeof(jsd_vbus_products) / sizeof(jsd_vbus_products[0]);
+       ++i) {
+    if (jsd_vbus_products[i].product_code == product_code) {
+      product = &jsd_vbus_products[i];
+      break;
+    }
+  }
+  if (product == NULL) {
+    ERROR("Virtual bus has no model of product code 0x%08X", product_code);
+    return 0;
+  }
+  if (self->num_slaves >= JSD_VBUS_MAX_SLAVES) {
+    ERROR("Virtual bus is full, it supports %d slaves", JSD_VBUS_MAX_SLAVES);
+    return 0;
+  }
+
+  pthread_mutex_lock(&self->mutex);
+  slave_id = ++self->num_slaves;
+  slave    = &self->slaves[slave_id];
+  memset(slave, 0, sizeof(*slave));
+
+  slave->vendor_id    = product->vendor_id;
+  slave->product_code = product->product_code;
+  slave->has_mailbox  = product->has_mailbox;
+  slave->rxpdo_bytes  = (product->rxpdo_bits + 7) / 8;
+  slave->txpdo_bytes  = (product->txpdo_bits + 7) / 8;
+  if (slave->has_mailbox) {
+    slave->rxpdo_sm    = 2;
+    slave->txpdo_sm    = 3;
+    slave->rxpdo_start = JSD_VBUS_RXPDO_START;
+  } else {
+    slave->rxpdo_sm    = 0;
+    slave->txpdo_sm    = 1;
+    slave->rxpdo_start = JSD_VBUS_DIGITAL_OUT_START;
+  }
+  slave->txpdo_start = JSD_VBUS_TXPDO_START;
+
+  jsd_vbus_reset_esc(slave);
+  jsd_vbus_build_sii(slave, product, slave_id);
+  if (slave->has_mailbox) {
+    jsd_vbus_od_add_defaults(slave, product, slave_id);
+  }
+  jsd_vbus_update_topology(self);
+  pthread_mutex_unlock(&self->mutex);
+
+  MSG_DEBUG("Virtual bus slave[%u] is a simulated %s", slave_id,
+            product->name);
+  return slave_id;
+}
+
+void jsd_vbus_attach(jsd_vbus_t* self, jsd_t* jsd) {
+  assert(self);
+  assert(jsd);
+  assert(!jsd->init_complete);
+  jsd->vbus = self;
+}
+
+void jsd_vbus_set_slave_model(jsd_vbus_t* self, uint16_t slave_id,
+                              jsd_vbus_model_t model, void* user) {
+  assert(self);
+  pthread_mutex_lock(&self->mutex);
+  jsd_vbus_slave_t* slave = jsd_vbus_get_slave(self, slave_id);
+  slave->model            = model;
+  slave->model_user       = user;
+  pthread_mutex_unlock(&self->mutex);
+}
+
+bool jsd_vbus_set_sdo(jsd_vbus_t* self, uint16_t slave_id, uint16_t index,
+                      uint8_t subindex, const void* data, uint16_t size) {
+  assert(self);
+  bool success;
+  pthread_mutex_lock(&self->mutex);
+  success = jsd_vbus_od_set(jsd_vbus_get_slave(self, slave_id), index,
+                            subindex, data, size);
+  pthread_mutex_unlock(&self->mutex);
+  if (!success) {
+    ERROR("Virtual bus slave[%u] object dictionary is full", slave_id);
+  }
+  return success;
+}
+
+bool jsd_vbus_get_sdo(jsd_vbus_t* self, uint16_t slave_id, uint16_t index,
+                      uint8_t subindex, void* data, uint16_t size) {
+  assert(self);
+  jsd_vbus_od_entry_t* entry;
+  bool                 success = false;
+
+  pthread_mutex_lock(&self->mutex);
+  jsd_vbus_slave_t* slave = jsd_vbus_get_slave(self, slave_id);
+  entry                   = jsd_vbus_od_find(slave, index, subindex);
+  if (entry != NULL && entry->size <= size) {
+    memcpy(data, &slave->od_data[entry->offset], entry->size);
+    success = true;
+  }
+  pthread_mutex_unlock(&self->mutex);
+  return success;
+}
+
+void jsd_vbus_write_txpdo(jsd_vbus_t* self, uint16_t slave_id,
+                          const void* data, uint16_t size) {
+  assert(self);
+  uint16_t start, bytes;
+  pthread_mutex_lock(&self->mutex);
+  jsd_vbus_slave_t* slave = jsd_vbus_get_slave(self, slave_id);
+  jsd_vbus_txpdo_area(slave, &start, &bytes);
+  memcpy(&slave->esc[start], data, size < bytes ? size : bytes);
+  pthread_mutex_unlock(&self->mutex);
+}
+
+void jsd_vbus_read_rxpdo(jsd_vbus_t* self, uint16_t slave_id, void* data,
+                         uint16_t size) {
+  assert(self);
+  uint16_t start, bytes;
+  pthread_mutex_lock(&self->mutex);
+  jsd_vbus_slave_t* slave = jsd_vbus_get_slave(self, slave_id);
+  jsd_vbus_rxpdo_area(slave, &start, &bytes);
+  memcpy(data, &slave->esc[start], size < bytes ? size : bytes);
+  pthread_mutex_unlock(&self->mutex);
+}
+
+bool jsd_vbus_post_emcy(jsd_vbus_t* self, uint16_t slave_id,
+                        uint16_t error_code, uint8_t error_register) {
+  assert(self);
+  bool success = false;
+
+  pthread_mutex_lock(&self->mutex);
+  jsd_vbus_slave_t* slave = jsd_vbus_get_slave(self, slave_id);
+  if (slave->has_mailbox && slave->emcy_count < JSD_VBUS_EMCY_QUEUE_SIZE) {
+    slave->emcy[slave->emcy_count].error_code     = error_code;
+    slave->emcy[slave->emcy_count].error_register = error_register;
+    ++slave->emcy_count;
+    if (jsd_vbus_mailbox_active(slave)) {
+      jsd_vbus_mailbox_flush(slave);
+    }
+    success = true;
+  }
+  pthread_mutex_unlock(&self->mutex);
+  return success;
+}
+
+ec_state jsd_vbus_get_slave_state(jsd_vbus_t* self, uint16_t slave_id) {
+  assert(self);
+  ec_state state;
+  pthread_mutex_lock(&self->mutex);
+  state = (ec_state)jsd_vbus_get_slave(self, slave_id)->esc[ECT_REG_ALSTAT];
+  pthread_mutex_unlock(&self->mutex);
+  return state;
+}
+
+size_t jsd_vbus_process_frame(jsd_vbus_t* self, uint8_t* frame, size_t size) {
+  assert(self);
+  assert(frame);
+  size_t   pos = ETH_HEADERSIZE + EC_ELENGTHSIZE;
+  size_t   end;
+  uint16_t flags = JSD_VBUS_DATAGRAM_MORE;
+
+  if (size < pos || ((frame[12] << 8) | frame[13]) != ETH_P_ECAT) {
+    return 0;
+  }
+  end = pos + (jsd_vbus_get16(&frame[ETH_HEADERSIZE]) & 0x07FF);
+  if (end > size) {
+    return 0;
+  }
+
+  pthread_mutex_lock(&self->mutex);
+  ++self->frame_count;
+  jsd_vbus_evaluate_faults(self);
+  if (self->dropping_frames) {
+    pthread_mutex_unlock(&self->mutex);
+    return 0;
+  }
+  while ((flags & JSD_VBUS_DATAGRAM_MORE) &&
+         pos + JSD_VBUS_DATAGRAM_HEADER_BYTES + EC_WKCSIZE <= end) {
+    uint8_t* datagram = &frame[pos];
+    uint16_t len;
+    flags = jsd_vbus_get16(&datagram[6]);
+    len   = flags & JSD_VBUS_DATAGRAM_LENGTH_MASK;
+    if (pos + JSD_VBUS_DATAGRAM_HEADER_BYTES + len + EC_WKCSIZE > end) {
+      break;
+    }
+    jsd_vbus_process_datagram(self, datagram);
+    pos += JSD_VBUS_DATAGRAM_HEADER_BYTES + len + EC_WKCSIZE;
+  }
+  jsd_vbus_run_models(self);
+  pthread_mutex_unlock(&self->mutex);
+  return size;
+}
+
+bool jsd_vbus_inject_fault(jsd_vbus_t* self, jsd_vbus_fault_t fault) {
+  assert(self);
+  bool success = false;
+
+  pthread_mutex_lock(&self->mutex);
+  if (fault.type >= JSD_VBUS_NUM_FAULT_TYPES ||
+      fault.slave_id > self->num_slaves) {
+    ERROR("Virtual bus cannot inject fault %d on slave[%u]", fault.type,
+          fault.slave_id);
+  } else if (self->num_faults >= JSD_VBUS_MAX_FAULTS) {
+    ERROR("Virtual bus already has %d faults", JSD_VBUS_MAX_FAULTS);
+  } else {
+    jsd_vbus_injected_fault_t* injected = &self->faults[self->num_faults++];
+    injected->fault       = fault;
+    injected->start_frame = self->frame_count + 1 + fault.delay_frames;
+    injected->end_frame =
+        fault.frames > 0 ? injected->start_frame + fault.frames : 0;
+    injected->active = false;
+    success          = true;
+  }
+  pthread_mutex_unlock(&self->mutex);
+  return success;
+}
+
+void jsd_vbus_clear_faults(jsd_vbus_t* self) {
+  assert(self);
+  uint16_t i;
+
+  pthread_mutex_lock(&self->mutex);
+  for (i = 0; i < self->num_faults; ++i) {
+    self->faults[i].end_frame = self->frame_count;
+    if (self->faults[i].start_frame > self->frame_count) {
+      self->faults[i].start_frame = self->frame_count;
+    }
+  }
+  jsd_vbus_evaluate_faults(self);
+  pthread_mutex_unlock(&self->mutex);
+}
+
+uint16_t jsd_vbus_get_num_faults(jsd_vbus_t* self) {
+  assert(self);
+  uint16_t num_faults;
+  pthread_mutex_lock(&self->mutex);
+  num_faults = self->num_faults;
+  pthread_mutex_unlock(&self->mutex);
+  return num_faults;
+}
+
+uint64_t jsd_vbus_get_sdo_downloads(jsd_vbus_t* self, uint16_t slave_id) {
+  assert(self);
+  uint64_t sdo_downloads;
+  pthread_mutex_lock(&self->mutex);
+  sdo_downloads = jsd_vbus_get_slave(self, slave_id)->sdo_downloads;
+  pthread_mutex_unlock(&self->mutex);
+  return sdo_downloads;
+}
+
+uint64_t jsd_vbus_get_frame_count(jsd_vbus_t* self) {
+  assert(self);
+  uint64_t frame_count;
+  pthread_mutex_lock(&self->mutex);
+  frame_count = self->frame_count;
+  pthread_mutex_unlock(&self->mutex);
+  return frame_count;
+}
+
+const char* jsd_vbus_fault_type_to_string(jsd_vbus_fault_type_t type) {
+  if (type >= JSD_VBUS_NUM_FAULT_TYPES) {
+    return "unknown fault";
+  }
+  return jsd_vbus_fault_type_strings[type];
+}
+
+bool jsd_vbus_open(jsd_vbus_t* self, ecx_portt* port) {
+  assert(self);
+  assert(port);
+  struct timeval timeout = {.tv_sec = 0, .tv_usec = 1};
+  int            sockets[2];
+
+  if (self->thread_running) {
+    ERROR("Virtual bus is already open");
+    return false;
+  }
+  if (socketpair(AF_UNIX, SOCK_SEQPACKET, 0, sockets) != 0) {
+    ERROR("Failed to create the virtual bus sockets: %s", strerror(errno));
+    return false;
+  }
+
+  // SOEM polls its socket, like the raw socket of ecx_setupnic(...)
+  setsockopt(sockets[0], SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+  jsd_vbus_setup_port(port, sockets[0]);
+  self->socket = sockets[1];
+
+  if (0 != pthread_create(&self->thread, NULL, jsd_vbus_thread_loop, self)) {
+    ERROR("Failed to create the virtual bus thread");
+    close(sockets[0]);
+    close(sockets[1]);
+    port->sockhandle = -1;
+    self->socket     = -1;
+    return false;
+  }
+  self->thread_running = true;
+
+  MSG("Virtual bus open with %u slaves", self->num_slaves);
+  return true;
+}
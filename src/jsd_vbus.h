@@ -0,0 +1,26 @@
+#ifndef JSD_VBUS_H
+#define JSD_VBUS_H
+
+#include "jsd/jsd_vbus_pub.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Connects a SOEM port to the virtual bus, replaces ecx_init(...)
+ *
+ * The port gets one end of a socket pair, the bus thread serves the other.
+ * Closing the port with ecx_close(...) stops the bus thread.
+ *
+ * @param self pointer to the virtual bus
+ * @param port SOEM port of the JSD context
+ * @return true on success
+ */
+bool jsd_vbus_open(jsd_vbus_t* self, ecx_portt* port);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,582 @@
+#include "jsd/jsd_vbus_drive_pub.h"
+
+#include <assert.h>
+#include <string.h>
+
+#include "jsd/jsd_egd_types.h"
+#include "jsd/jsd_epd_types.h"
+#include "jsd/jsd_time.h"
+
+#define JSD_VBUS_DRIVE_CONTROLWORD_FAULT_RESET_BIT (0x0080)
+#define JSD_VBUS_DRIVE_CONTROLWORD_NEW_SETPOINT_BIT (0x0010)
+#define JSD_VBUS_DRIVE_CONTROLWORD_RELATIVE_BIT (0x0040)
+
+#define JSD_VBUS_DRIVE_STATUSWORD_VOLTAGE_ENABLED (0x0010)
+#define JSD_VBUS_DRIVE_STATUSWORD_REMOTE (0x0200)
+#define JSD_VBUS_DRIVE_STATUSWORD_TARGET_REACHED (0x0400)
+#define JSD_VBUS_DRIVE_STATUSWORD_SETPOINT_ACK (0x1000)
+
+#define JSD_VBUS_DRIVE_GENERIC_ERROR_REGISTER (0x01)
+
+/**
+ * @brief Commands common to all layouts, decoded from the RxPDO
+ */
+typedef struct {
+  int32_t  target_position;
+  int32_t  target_velocity;
+  int16_t  target_torque;
+  int32_t  position_offset;
+  int32_t  velocity_offset;
+  int16_t  torque_offset;
+  int8_t   mode_of_operation;
+  uint32_t digital_outputs;
+  uint16_t controlword;
+  uint32_t profile_velocity;
+  uint32_t profile_accel;
+  uint32_t profile_decel;
+} jsd_vbus_drive_cmd_t;
+
+static double jsd_vbus_drive_abs(double value) {
+  return value < 0.0 ? -value : value;
+}
+
+static int32_t jsd_vbus_drive_round(double value, double min, double max) {
+  if (value < min) {
+    value = min;
+  } else if (value > max) {
+    value = max;
+  }
+  return (int32_t)(value < 0.0 ? value - 0.5 : value + 0.5);
+}
+
+static void jsd_vbus_drive_decode(const jsd_vbus_drive_t* self,
+                                  const uint8_t*          rxpdo,
+                                  jsd_vbus_drive_cmd_t*   cmd) {
+  memset(cmd, 0, sizeof(*cmd));
+
+  switch (self->config.layout) {
+    case JSD_VBUS_DRIVE_LAYOUT_EPD: {
+      jsd_epd_rxpdo_data_t pdo;
+      memcpy(&pdo, rxpdo, sizeof(pdo));
+      cmd->target_position   = pdo.target_position;
+      cmd->target_velocity   = pdo.target_velocity;
+      cmd->target_torque     = pdo.target_torque;
+      cmd->position_offset   = pdo.position_offset;
+      cmd->velocity_offset   = pdo.velocity_offset;
+      cmd->torque_offset     = pdo.torque_offset;
+      cmd->mode_of_operation = pdo.mode_of_operation;
+      cmd->digital_outputs   = pdo.digital_outputs;
+      cmd->controlword       = pdo.controlword;
+      cmd->profile_velocity  = pdo.profile_velocity;
+      cmd->profile_accel     = pdo.profile_accel;
+      cmd->profile_decel     = pdo.profile_decel;
+      break;
+    }
+    case JSD_VBUS_DRIVE_LAYOUT_EGD_CS: {
+      jsd_egd_rxpdo_data_cs_mode_t pdo;
+      memcpy(&pdo, rxpdo, sizeof(pdo));
+      cmd->target_position   = pdo.target_position;
+      cmd->target_velocity   = pdo.target_velocity;
+      cmd->target_torque     = pdo.target_torque;
+      cmd->position_offset   = pdo.position_offset;
+      cmd->velocity_offset   = pdo.velocity_offset;
+      cmd->torque_offset     = pdo.torque_offset;
+      cmd->mode_of_operation = pdo.mode_of_operation;
+      cmd->digital_outputs   = pdo.digital_outputs;
+      cmd->controlword       = pdo.controlword;
+      break;
+    }
+    case JSD_VBUS_DRIVE_LAYOUT_EGD_PROFILED: {
+      jsd_egd_rxpdo_data_profiled_mode_t pdo;
+      memcpy(&pdo, rxpdo, sizeof(pdo));
+      cmd->target_position   = pdo.target_position;
+      cmd->target_velocity   = pdo.target_velocity;
+      cmd->target_torque     = pdo.target_torque;
+      cmd->mode_of_operation = pdo.mode_of_operation;
+      cmd->digital_outputs   = self->digital_outputs;
+      cmd->controlword       = pdo.controlword;
+      cmd->profile_velocity  = pdo.profile_velocity;
+      cmd->profile_accel     = pdo.profile_accel;
+      cmd->profile_decel     = pdo.profile_decel;
+      break;
+    }
+    default:
+      assert(0);
+  }
+}
+
+static uint16_t jsd_vbus_drive_statusword(const jsd_vbus_drive_t* self) {
+  uint16_t statusword = self->state | JSD_VBUS_DRIVE_STATUSWORD_REMOTE;
+  if (self->state != JSD_ELMO_STATE_MACHINE_STATE_NOT_READY_TO_SWITCH_ON &&
+      self->state != JSD_ELMO_STATE_MACHINE_STATE_SWITCH_ON_DISABLED &&
+      self->state != JSD_ELMO_STATE_MACHINE_STATE_FAULT) {
+    statusword |= JSD_VBUS_DRIVE_STATUSWORD_VOLTAGE_ENABLED;
+  }
+  if (self->target_reached) {
+    statusword |= JSD_VBUS_DRIVE_STATUSWORD_TARGET_REACHED;
+  }
+  if (self->setpoint_ack) {
+    statusword |= JSD_VBUS_DRIVE_STATUSWORD_SETPOINT_ACK;
+  }
+  return statusword;
+}
+
+static bool jsd_vbus_drive_motor_on(const jsd_vbus_drive_t* self) {
+  return self->state == JSD_ELMO_STATE_MACHINE_STATE_OPERATION_ENABLED ||
+         self->state == JSD_ELMO_STATE_MACHINE_STATE_QUICK_STOP_ACTIVE ||
+         self->state == JSD_ELMO_STATE_MACHINE_STATE_FAULT_REACTION_ACTIVE;
+}
+
+/**
+ * @brief Bits of the Elmo status register shared by Platinum and Gold drives
+ */
+static uint32_t jsd_vbus_drive_status_register(const jsd_vbus_drive_t* self) {
+  uint32_t status_register = 0;
+  bool     servo_enabled =
+      self->state == JSD_ELMO_STATE_MACHINE_STATE_OPERATION_ENABLED &&
+      self->time_nsec - self->state_entry_nsec >=
+          self->config.brake_release_nsec;
+  bool faulted =
+      self->state == JSD_ELMO_STATE_MACHINE_STATE_FAULT ||
+      self->state == JSD_ELMO_STATE_MACHINE_STATE_FAULT_REACTION_ACTIVE;
+
+  status_register |= (uint32_t)servo_enabled << 4;
+  status_register |= (uint32_t)faulted << 6;
+  status_register |= (uint32_t)jsd_vbus_drive_motor_on(self) << 22;
+  status_register |= (uint32_t)(self->velocity != 0.0) << 23;
+  return status_register;
+}
+
+static void jsd_vbus_drive_encode(const jsd_vbus_drive_t* self,
+                                  uint8_t*                txpdo) {
+  int32_t position =
+      jsd_vbus_drive_round(self->position, INT32_MIN, INT32_MAX);
+  int32_t velocity =
+      jsd_vbus_drive_round(self->velocity, INT32_MIN, INT32_MAX);
+  int16_t current = jsd_vbus_drive_round(self->current, INT16_MIN, INT16_MAX);
+  uint32_t status_register = jsd_vbus_drive_status_register(self);
+
+  if (self->config.layout == JSD_VBUS_DRIVE_LAYOUT_EPD) {
+    jsd_epd_txpdo_data_t pdo;
+    memset(&pdo, 0, sizeof(pdo));
+    pdo.actual_position           = position;
+    pdo.velocity_actual_value     = velocity;
+    pdo.current_actual_value      = current;
+    pdo.mode_of_operation_display = self->mode_of_operation;
+    pdo.dc_link_circuit_voltage   = self->config.bus_voltage_mv;
+    pdo.drive_temperature_deg_c   = self->config.temperature_deg_c;
+    pdo.digital_inputs            = self->digital_inputs;
+    // STO is released when both STO inputs are high
+    pdo.status_register_1 =
+        status_register | (self->sto_engaged ? 0 : (0x03u << 25));
+    pdo.statusword = jsd_vbus_drive_statusword(self);
+    memcpy(txpdo, &pdo, sizeof(pdo));
+  } else {
+    jsd_egd_txpdo_data_t pdo;
+    memset(&pdo, 0, sizeof(pdo));
+    pdo.actual_position           = position;
+    pdo.digital_inputs            = self->digital_inputs;
+    pdo.statusword                = jsd_vbus_drive_statusword(self);
+    pdo.velocity_actual_value     = velocity;
+    pdo.current_actual_value      = current;
+    pdo.status_register =
+        status_register | (self->sto_engaged ? 0 : (0x01u << 14));
+    pdo.mode_of_operation_display = self->mode_of_operation;
+    pdo.dc_link_circuit_voltage   = self->config.bus_voltage_mv;
+    pdo.drive_temperature_deg_c   = (uint32_t)self->config.temperature_deg_c;
+    memcpy(txpdo, &pdo, sizeof(pdo));
+  }
+}
+
+static void jsd_vbus_drive_set_state(jsd_vbus_drive_t*              self,
+                                     jsd_elmo_state_machine_state_t state) {
+  if (self->state == state) {
+    return;
+  }
+  self->state            = state;
+  self->state_entry_nsec = self->time_nsec;
+
+  if (state == JSD_ELMO_STATE_MACHINE_STATE_OPERATION_ENABLED) {
+    // Hold the current position until the first profiled set-point
+    self->prof_target    = self->position;
+    self->setpoint_ack   = false;
+    self->target_reached = true;
+  }
+}
+
+static void jsd_vbus_drive_fault(jsd_vbus_drive_t* self, uint16_t emcy_code) {
+  if (self->state == JSD_ELMO_STATE_MACHINE_STATE_FAULT ||
+      self->state == JSD_ELMO_STATE_MACHINE_STATE_FAULT_REACTION_ACTIVE) {
+    return;
+  }
+  jsd_vbus_drive_set_state(self,
+                           JSD_ELMO_STATE_MACHINE_STATE_FAULT_REACTION_ACTIVE);
+  self->emcy_code  = emcy_code;
+  self->fault_nsec = self->time_nsec;
+  self->emcy_sent  = false;
+}
+
+/**
+ * @brief CiA-402 device control: transitions commanded by the controlword
+ */
+static void jsd_vbus_drive_state_machine(jsd_vbus_drive_t* self,
+                                         uint16_t          controlword) {
+  bool disable_voltage = (controlword & 0x0082) == 0x0000;
+  bool quick_stop      = (controlword & 0x0086) == 0x0002;
+  bool shutdown        = (controlword & 0x0087) == 0x0006;
+  bool switch_on       = (controlword & 0x008F) == 0x0007;
+  bool enable          = (controlword & 0x008F) == 0x000F;
+  bool fault_reset =
+      (controlword & JSD_VBUS_DRIVE_CONTROLWORD_FAULT_RESET_BIT) &&
+      !(self->last_controlword & JSD_VBUS_DRIVE_CONTROLWORD_FAULT_RESET_BIT);
+
+  switch (self->state) {
+    case JSD_ELMO_STATE_MACHINE_STATE_NOT_READY_TO_SWITCH_ON:
+      jsd_vbus_drive_set_state(self,
+                               JSD_ELMO_STATE_MACHINE_STATE_SWITCH_ON_DISABLED);
+      break;
+    case JSD_ELMO_STATE_MACHINE_STATE_SWITCH_ON_DISABLED:
+      if (shutdown) {
+        jsd_vbus_drive_set_state(
+            self, JSD_ELMO_STATE_MACHINE_STATE_READY_TO_SWITCH_ON);
+      }
+      break;
+    case JSD_ELMO_STATE_MACHINE_STATE_READY_TO_SWITCH_ON:
+      if (disable_voltage || quick_stop) {
+        jsd_vbus_drive_set_state(
+            self, JSD_ELMO_STATE_MACHINE_STATE_SWITCH_ON_DISABLED);
+      } else if (switch_on || enable) {
+        jsd_vbus_drive_set_state(self,
+                                 JSD_ELMO_STATE_MACHINE_STATE_SWITCHED_ON);
+      }
+      break;
+    case JSD_ELMO_STATE_MACHINE_STATE_SWITCHED_ON:
+      if (disable_voltage || quick_stop) {
+        jsd_vbus_drive_set_state(
+            self, JSD_ELMO_STATE_MACHINE_STATE_SWITCH_ON_DISABLED);
+      } else if (shutdown) {
+        jsd_vbus_drive_set_state(
+            self, JSD_ELMO_STATE_MACHINE_STATE_READY_TO_SWITCH_ON);
+      } else if (enable) {
+        jsd_vbus_drive_set_state(
+            self, JSD_ELMO_STATE_MACHINE_STATE_OPERATION_ENABLED);
+      }
+      break;
+    case JSD_ELMO_STATE_MACHINE_STATE_OPERATION_ENABLED:
+      if (disable_voltage) {
+        jsd_vbus_drive_set_state(
+            self, JSD_ELMO_STATE_MACHINE_STATE_SWITCH_ON_DISABLED);
+      } else if (quick_stop) {
+        jsd_vbus_drive_set_state(
+            self, JSD_ELMO_STATE_MACHINE_STATE_QUICK_STOP_ACTIVE);
+      } else if (shutdown) {
+        jsd_vbus_drive_set_state(
+            self, JSD_ELMO_STATE_MACHINE_STATE_READY_TO_SWITCH_ON);
+      } else if (switch_on) {
+        jsd_vbus_drive_set_state(self,
+                                 JSD_ELMO_STATE_MACHINE_STATE_SWITCHED_ON);
+      }
+      break;
+    case JSD_ELMO_STATE_MACHINE_STATE_QUICK_STOP_ACTIVE:
+      // Quick Stop Option Code 2: SWITCH ON DISABLED once stopped
+      if (disable_voltage || self->velocity == 0.0) {
+        jsd_vbus_drive_set_state(
+            self, JSD_ELMO_STATE_MACHINE_STATE_SWITCH_ON_DISABLED);
+      }
+      break;
+    case JSD_ELMO_STATE_MACHINE_STATE_FAULT_REACTION_ACTIVE:
+      if (self->velocity == 0.0 &&
+          self->time_nsec - self->state_entry_nsec >=
+              self->config.fault_reaction_nsec) {
+        jsd_vbus_drive_set_state(self, JSD_ELMO_STATE_MACHINE_STATE_FAULT);
+      }
+      break;
+    case JSD_ELMO_STATE_MACHINE_STATE_FAULT:
+      if (fault_reset) {
+        jsd_vbus_drive_set_state(
+            self, JSD_ELMO_STATE_MACHINE_STATE_SWITCH_ON_DISABLED);
+      }
+      break;
+    default:
+      assert(0);
+  }
+}
+
+static void jsd_vbus_drive_stop(jsd_vbus_drive_t* self, double decel,
+                                double dt) {
+  double dv = decel * dt;
+  if (jsd_vbus_drive_abs(self->velocity) <= dv) {
+    self->velocity = 0.0;
+  } else {
+    self->velocity -= self->velocity > 0.0 ? dv : -dv;
+  }
+  self->position += self->velocity * dt;
+}
+
+static void jsd_vbus_drive_ramp(jsd_vbus_drive_t* self, double target,
+                                double dt) {
+  bool speeding_up =
+      jsd_vbus_drive_abs(target) > jsd_vbus_drive_abs(self->velocity) &&
+      target * self->velocity >= 0.0;
+  double dv = (speeding_up ? self->prof_accel : self->prof_decel) * dt;
+  if (jsd_vbus_drive_abs(target - self->velocity) <= dv) {
+    self->velocity = target;
+  } else {
+    self->velocity += target > self->velocity ? dv : -dv;
+  }
+  self->position += self->velocity * dt;
+}
+
+/**
+ * @brief Trapezoidal move to prof_target that stops on the target
+ */
+static void jsd_vbus_drive_move(jsd_vbus_drive_t* self, double dt) {
+  double remaining = self->prof_target - self->position;
+  double distance  = jsd_vbus_drive_abs(remaining);
+  double direction = remaining < 0.0 ? -1.0 : 1.0;
+  double speed     = self->velocity * direction;
+
+  if (speed * speed >= 2.0 * self->prof_decel * distance) {
+    speed -= self->prof_decel * dt;
+    if (speed < self->prof_decel * dt) {
+      // Creep onto the target rather than stalling short of it
+      speed = self->prof_decel * dt;
+    }
+  } else {
+    speed += self->prof_accel * dt;
+    if (speed > self->prof_velocity) {
+      speed = self->prof_velocity;
+    }
+  }
+
+  if (speed * dt >= distance || distance < 0.5) {
+    self->position       = self->prof_target;
+    self->velocity       = 0.0;
+    self->target_reached = true;
+  } else {
+    self->position += direction * speed * dt;
+    self->velocity       = direction * speed;
+    self->target_reached = false;
+  }
+}
+
+static void jsd_vbus_drive_motion(jsd_vbus_drive_t*           self,
+                                  const jsd_vbus_drive_cmd_t* cmd, double dt) {
+  double velocity = self->velocity;
+
+  switch (self->state) {
+    case JSD_ELMO_STATE_MACHINE_STATE_OPERATION_ENABLED:
+      break;
+    case JSD_ELMO_STATE_MACHINE_STATE_QUICK_STOP_ACTIVE:
+    case JSD_ELMO_STATE_MACHINE_STATE_FAULT_REACTION_ACTIVE:
+      jsd_vbus_drive_stop(self, self->config.quick_stop_decel, dt);
+      self->current = dt > 0.0 ? (self->velocity - velocity) / dt /
+                                     self->config.accel_per_permille
+                               : 0.0;
+      return;
+    default:
+      self->velocity = 0.0;
+      self->current  = 0.0;
+      return;
+  }
+
+  bool new_setpoint =
+      (cmd->controlword & JSD_VBUS_DRIVE_CONTROLWORD_NEW_SETPOINT_BIT) &&
+      !(self->last_controlword & JSD_VBUS_DRIVE_CONTROLWORD_NEW_SETPOINT_BIT);
+  if (!(cmd->controlword & JSD_VBUS_DRIVE_CONTROLWORD_NEW_SETPOINT_BIT)) {
+    self->setpoint_ack = false;
+  }
+
+  switch (self->mode_of_operation) {
+    case JSD_EPD_MODE_OF_OPERATION_PROF_POS:
+      if (new_setpoint) {
+        // Change set immediately: the new set-point replaces the current one
+        if (cmd->controlword & JSD_VBUS_DRIVE_CONTROLWORD_RELATIVE_BIT) {
+          self->prof_target = self->position + cmd->target_position;
+        } else {
+          self->prof_target = cmd->target_position;
+        }
+        self->prof_velocity = cmd->profile_velocity;
+        self->prof_accel    = cmd->profile_accel;
+        self->prof_decel    = cmd->profile_decel;
+        self->setpoint_ack  = true;
+      }
+      jsd_vbus_drive_move(self, dt);
+      break;
+    case JSD_EPD_MODE_OF_OPERATION_PROF_VEL:
+      self->prof_accel = cmd->profile_accel;
+      self->prof_decel = cmd->profile_decel;
+      jsd_vbus_drive_ramp(self, cmd->target_velocity, dt);
+      self->target_reached = self->velocity == cmd->target_velocity;
+      break;
+    case JSD_EPD_MODE_OF_OPERATION_CSP: {
+      double position = (double)cmd->target_position + cmd->position_offset;
+      self->velocity  = dt > 0.0 ? (position - self->position) / dt : 0.0;
+      self->position  = position;
+      self->target_reached = true;
+      break;
+    }
+    case JSD_EPD_MODE_OF_OPERATION_CSV:
+      self->velocity = (double)cmd->target_velocity + cmd->velocity_offset;
+      self->position += self->velocity * dt;
+      self->target_reached = true;
+      break;
+    case JSD_EPD_MODE_OF_OPERATION_PROF_TORQUE:
+    case JSD_EPD_MODE_OF_OPERATION_CST: {
+      double current = cmd->target_torque;
+      if (self->mode_of_operation == JSD_EPD_MODE_OF_OPERATION_CST) {
+        current += cmd->torque_offset;
+      }
+      self->current = current;
+      self->velocity += current * self->config.accel_per_permille * dt;
+      self->position += self->velocity * dt;
+      self->target_reached = true;
+      return;
+    }
+    default:
+      // Unsupported modes hold the load
+      self->velocity = 0.0;
+      break;
+  }
+
+  self->current = dt > 0.0 ? (self->velocity - velocity) / dt /
+                                 self->config.accel_per_permille
+                           : 0.0;
+}
+
+static void jsd_vbus_drive_model(jsd_vbus_t* vbus, uint16_t slave_id,
+                                 const uint8_t* rxpdo, uint16_t rxpdo_bytes,
+                                 uint8_t* txpdo, uint16_t txpdo_bytes,
+                                 int64_t time_nsec, void* user) {
+  (void)vbus;
+  (void)slave_id;
+  jsd_vbus_drive_t* self = (jsd_vbus_drive_t*)user;
+
+  size_t rx_bytes = sizeof(jsd_epd_rxpdo_data_t);
+  size_t tx_bytes = sizeof(jsd_epd_txpdo_data_t);
+  if (self->config.layout == JSD_VBUS_DRIVE_LAYOUT_EGD_CS) {
+    rx_bytes = sizeof(jsd_egd_rxpdo_data_cs_mode_t);
+    tx_bytes = sizeof(jsd_egd_txpdo_data_t);
+  } else if (self->config.layout == JSD_VBUS_DRIVE_LAYOUT_EGD_PROFILED) {
+    rx_bytes = sizeof(jsd_egd_rxpdo_data_profiled_mode_t);
+    tx_bytes = sizeof(jsd_egd_txpdo_data_t);
+  }
+  // A mapping that does not match the layout leaves the inputs untouched
+  if (rxpdo_bytes < rx_bytes || txpdo_bytes < tx_bytes) {
+    return;
+  }
+  jsd_vbus_drive_step(self, rxpdo, txpdo, time_nsec);
+}
+
+void jsd_vbus_drive_init(jsd_vbus_drive_t*       self,
+                         jsd_vbus_drive_layout_t layout) {
+  assert(self);
+  memset(self, 0, sizeof(*self));
+
+  self->config.layout              = layout;
+  self->config.cycle_nsec          = 0;
+  self->config.quick_stop_decel    = 1e6;
+  self->config.accel_per_permille  = 1e3;
+  self->config.brake_release_nsec  = 0;
+  self->config.fault_reaction_nsec = 0;
+  self->config.emcy_delay_nsec     = 0;
+  self->config.bus_voltage_mv      = 48000;
+  self->config.temperature_deg_c   = 35.0f;
+
+  self->state          = JSD_ELMO_STATE_MACHINE_STATE_NOT_READY_TO_SWITCH_ON;
+  self->target_reached = true;
+}
+
+void jsd_vbus_drive_attach(jsd_vbus_drive_t* self, jsd_vbus_t* vbus,
+                           uint16_t slave_id) {
+  assert(self);
+  assert(vbus);
+  self->vbus     = vbus;
+  self->slave_id = slave_id;
+  jsd_vbus_set_slave_model(vbus, slave_id, jsd_vbus_drive_model, self);
+}
+
+void jsd_vbus_drive_step(jsd_vbus_drive_t* self, const uint8_t* rxpdo,
+                         uint8_t* txpdo, int64_t time_nsec) {
+  assert(self);
+  assert(rxpdo);
+  assert(txpdo);
+
+  int64_t dt_nsec;
+  if (self->config.cycle_nsec > 0) {
+    dt_nsec = self->cycles > 0 ? self->config.cycle_nsec : 0;
+    self->time_nsec += dt_nsec;
+  } else {
+    dt_nsec         = self->cycles > 0 ? time_nsec - self->time_nsec : 0;
+    dt_nsec         = dt_nsec > 0 ? dt_nsec : 0;
+    self->time_nsec = time_nsec;
+  }
+  double dt = (double)dt_nsec / JSD_TIME_NSEC_PER_SEC;
+
+  jsd_vbus_drive_cmd_t cmd;
+  jsd_vbus_drive_decode(self, rxpdo, &cmd);
+  self->mode_of_operation = cmd.mode_of_operation;
+  self->digital_outputs   = cmd.digital_outputs;
+
+  if (self->fault_requested) {
+    self->fault_requested = false;
+    jsd_vbus_drive_fault(self, self->fault_emcy_code);
+  }
+  if (self->sto_engaged && jsd_vbus_drive_motor_on(self)) {
+    jsd_vbus_drive_fault(self, JSD_VBUS_DRIVE_STO_EMCY_CODE);
+  }
+
+  jsd_vbus_drive_state_machine(self, cmd.controlword);
+
+  if (!self->emcy_sent && self->config.emcy_delay_nsec >= 0 &&
+      (self->state == JSD_ELMO_STATE_MACHINE_STATE_FAULT_REACTION_ACTIVE ||
+       self->state == JSD_ELMO_STATE_MACHINE_STATE_FAULT) &&
+      self->time_nsec - self->fault_nsec >= self->config.emcy_delay_nsec) {
+    if (self->vbus) {
+      jsd_vbus_post_emcy(self->vbus, self->slave_id, self->emcy_code,
+                         JSD_VBUS_DRIVE_GENERIC_ERROR_REGISTER);
+    }
+    self->emcy_sent = true;
+  }
+
+  jsd_vbus_drive_motion(self, &cmd, dt);
+  self->last_controlword = cmd.controlword;
+  ++self->cycles;
+
+  jsd_vbus_drive_encode(self, txpdo);
+}
+
+void jsd_vbus_drive_inject_fault(jsd_vbus_drive_t* self, uint16_t emcy_code) {
+  assert(self);
+  if (self->vbus) {
+    pthread_mutex_lock(&self->vbus->mutex);
+  }
+  self->fault_requested = true;
+  self->fault_emcy_code = emcy_code;
+  if (self->vbus) {
+    pthread_mutex_unlock(&self->vbus->mutex);
+  }
+}
+
+void jsd_vbus_drive_set_sto(jsd_vbus_drive_t* self, bool engaged) {
+  assert(self);
+  if (self->vbus) {
+    pthread_mutex_lock(&self->vbus->mutex);
+  }
+  self->sto_engaged = engaged;
+  if (self->vbus) {
+    pthread_mutex_unlock(&self->vbus->mutex);
+  }
+}
+
+void jsd_vbus_drive_set_digital_inputs(jsd_vbus_drive_t* self,
+                                       uint32_t          digital_inputs) {
+  assert(self);
+  if (self->vbus) {
+    pthread_mutex_lock(&self->vbus->mutex);
+  }
+  self->digital_inputs = digital_inputs;
+  if (self->vbus) {
+    pthread_mutex_unlock(&self->vbus->mutex);
+  }
+}
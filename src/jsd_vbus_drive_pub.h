@@ -0,0 +1,83 @@
+#ifndef JSD_VBUS_DRIVE_PUB_H
+#define JSD_VBUS_DRIVE_PUB_H
+
+#include "jsd/jsd_vbus_drive_types.h"
+#include "jsd/jsd_vbus_pub.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// EMCY sent when STO engages while the drive is enabled (external inhibit)
+#define JSD_VBUS_DRIVE_STO_EMCY_CODE (0x5441)
+
+/**
+ * @brief Resets the drive to NOT READY TO SWITCH ON with default parameters
+ *
+ * The parameters in self->config may be changed before the first step.
+ *
+ * @param self pointer to the simulated drive
+ * @param layout process data layout matching the driver's configuration
+ */
+void jsd_vbus_drive_init(jsd_vbus_drive_t*       self,
+                         jsd_vbus_drive_layout_t layout);
+
+/**
+ * @brief Installs the drive as the model of an EPD or EGD virtual bus slave
+ *
+ * EMCY messages are then posted to the slave's mailbox.
+ *
+ * @param self pointer to the simulated drive, must outlive the bus
+ * @param vbus pointer to the virtual bus
+ * @param slave_id position of the EPD or EGD slave on the bus
+ */
+void jsd_vbus_drive_attach(jsd_vbus_drive_t* self, jsd_vbus_t* vbus,
+                           uint16_t slave_id);
+
+/**
+ * @brief Advances the drive by one cycle
+ *
+ * This is the jsd_vbus_model_t of attached drives. Detached drives may be
+ * stepped directly against an IOmap to exercise a driver without a bus.
+ *
+ * @param self pointer to the simulated drive
+ * @param rxpdo outputs of the master, in the layout of the drive
+ * @param txpdo inputs of the master, in the layout of the drive
+ * @param time_nsec bus clock, ignored when config.cycle_nsec is set
+ */
+void jsd_vbus_drive_step(jsd_vbus_drive_t* self, const uint8_t* rxpdo,
+                         uint8_t* txpdo, int64_t time_nsec);
+
+/**
+ * @brief Raises a fault on the next step: FAULT REACTION ACTIVE, then FAULT
+ *
+ * @param self pointer to the simulated drive
+ * @param emcy_code EMCY error code sent after config.emcy_delay_nsec
+ */
+void jsd_vbus_drive_inject_fault(jsd_vbus_drive_t* self, uint16_t emcy_code);
+
+/**
+ * @brief Engages or releases Safe Torque Off
+ *
+ * Engaging STO while the drive is enabled faults it with
+ * JSD_VBUS_DRIVE_STO_EMCY_CODE.
+ *
+ * @param self pointer to the simulated drive
+ * @param engaged true to remove motor power
+ */
+void jsd_vbus_drive_set_sto(jsd_vbus_drive_t* self, bool engaged);
+
+/**
+ * @brief Sets the digital inputs reported in 0x60FD
+ *
+ * @param self pointer to the simulated drive
+ * @param digital_inputs raw 0x60FD value
+ */
+void jsd_vbus_drive_set_digital_inputs(jsd_vbus_drive_t* self,
+                                       uint32_t          digital_inputs);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,80 @@
+#ifndef JSD_VBUS_DRIVE_TYPES_H
+#define JSD_VBUS_DRIVE_TYPES_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "jsd/jsd_elmo_common_types.h"
+#include "jsd/jsd_vbus_types.h"
+
+/**
+ * @brief Process data layout the simulated drive decodes and encodes
+ */
+typedef enum {
+  JSD_VBUS_DRIVE_LAYOUT_EPD = 0,       ///< jsd_epd_{rx,tx}pdo_data_t
+  JSD_VBUS_DRIVE_LAYOUT_EGD_CS,        ///< JSD_EGD_DRIVE_CMD_MODE_CS
+  JSD_VBUS_DRIVE_LAYOUT_EGD_PROFILED,  ///< JSD_EGD_DRIVE_CMD_MODE_PROFILED
+} jsd_vbus_drive_layout_t;
+
+typedef struct {
+  jsd_vbus_drive_layout_t layout;
+
+  int64_t cycle_nsec;  ///< model time step, 0 to follow the bus clock
+  double  quick_stop_decel;    ///< counts/s^2, quick stop and fault reaction
+  double  accel_per_permille;  ///< counts/s^2 per 1/1000 of rated current
+  int64_t brake_release_nsec;  ///< OPERATION ENABLED until servo_enabled
+  int64_t fault_reaction_nsec;  ///< minimum time in FAULT REACTION ACTIVE
+  int64_t emcy_delay_nsec;      ///< fault to EMCY, negative to never send it
+
+  uint32_t bus_voltage_mv;
+  float    temperature_deg_c;
+} jsd_vbus_drive_config_t;
+
+/**
+ * @brief Simulated Elmo drive: CiA-402 state machine, profile generators and
+ *        a rigid load
+ *
+ * Deterministic when config.cycle_nsec is set: the model advances by one step
+ * per process data exchange regardless of wall-clock time.
+ */
+typedef struct {
+  jsd_vbus_drive_config_t config;
+
+  jsd_vbus_t* vbus;      ///< receives the EMCY messages, NULL if stepped alone
+  uint16_t    slave_id;  ///< position on vbus
+
+  jsd_elmo_state_machine_state_t state;
+  int64_t  time_nsec;         ///< model clock
+  int64_t  state_entry_nsec;  ///< model time the current state was entered
+  uint64_t cycles;            ///< number of steps
+  uint16_t last_controlword;
+  int8_t   mode_of_operation;
+
+  double position;  ///< counts
+  double velocity;  ///< counts/s
+  double current;   ///< 1/1000 of the rated current
+
+  bool   setpoint_ack;    ///< profiled position handshake, statusword bit 12
+  bool   target_reached;  ///< statusword bit 10
+  double prof_target;     ///< latched profiled position set-point, counts
+  double prof_velocity;   ///< counts/s
+  double prof_accel;      ///< counts/s^2
+  double prof_decel;      ///< counts/s^2
+
+  bool     fault_requested;  ///< set by jsd_vbus_drive_inject_fault(...)
+  uint16_t fault_emcy_code;  ///< EMCY code of the requested fault
+  uint16_t emcy_code;        ///< EMCY code of the active fault
+  int64_t  fault_nsec;       ///< model time of the active fault
+  bool     emcy_sent;
+
+  bool     sto_engaged;
+  uint32_t digital_inputs;   ///< reported in 0x60FD
+  uint32_t digital_outputs;  ///< last 0x60FE written by the master
+} jsd_vbus_drive_t;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,208 @@
+#ifndef JSD_VBUS_PUB_H
+#define JSD_VBUS_PUB_H
+
+#include "jsd/jsd_types.h"
+#include "jsd/jsd_vbus_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Allocates an empty virtual EtherCAT bus
+ *
+ * The virtual bus emulates the ESC registers, SII EEPROM, CoE mailbox and
+ * process data of JSD's supported devices, so jsd_init(...) and the cyclic
+ * read/process/write loop run without a NIC, slaves or root privileges.
+ *
+ * @return pointer to the virtual bus
+ */
+jsd_vbus_t* jsd_vbus_alloc();
+
+/**
+ * @brief Frees the virtual bus, call after jsd_free(...) of attached contexts
+ *
+ * @param self pointer to the virtual bus
+ */
+void jsd_vbus_free(jsd_vbus_t* self);
+
+/**
+ * @brief Appends a simulated slave to the end of the line
+ *
+ * Slaves added after jsd_init(...) are plugged into the running line, they
+ * answer from the next frame on with an unassigned station address.
+ *
+ * @param self pointer to the virtual bus
+ * @param product_code one of the JSD_*_PRODUCT_CODE of a supported device
+ * @return slave_id of the new slave, 0 on failure
+ */
+uint16_t jsd_vbus_add_slave(jsd_vbus_t* self, uint32_t product_code);
+
+/**
+ * @brief Makes jsd_init(...) use the virtual bus instead of a NIC
+ *
+ * The ifname passed to jsd_init(...) is then only used for printing.
+ *
+ * @param self pointer to the virtual bus
+ * @param jsd pointer to a JSD context before jsd_init(...)
+ */
+void jsd_vbus_attach(jsd_vbus_t* self, jsd_t* jsd);
+
+/**
+ * @brief Installs the application of a simulated slave, see jsd_vbus_model_t
+ *
+ * @param self pointer to the virtual bus
+ * @param slave_id position of the slave on the bus
+ * @param model callback, NULL to keep the inputs constant
+ * @param user pointer forwarded to the callback
+ */
+void jsd_vbus_set_slave_model(jsd_vbus_t* self, uint16_t slave_id,
+                              jsd_vbus_model_t model, void* user);
+
+/**
+ * @brief Sets an object of a slave's CoE object dictionary
+ *
+ * @param self pointer to the virtual bus
+ * @param slave_id position of the slave on the bus
+ * @param index object index
+ * @param subindex object subindex
+ * @param data value
+ * @param size size of the value in bytes
+ * @return false if the object dictionary is full
+ */
+bool jsd_vbus_set_sdo(jsd_vbus_t* self, uint16_t slave_id, uint16_t index,
+                      uint8_t subindex, const void* data, uint16_t size);
+
+/**
+ * @brief Gets an object of a slave's CoE object dictionary
+ *
+ * @param self pointer to the virtual bus
+ * @param slave_id position of the slave on the bus
+ * @param index object index
+ * @param subindex object subindex
+ * @param data output value
+ * @param size size of data in bytes
+ * @return false if the object does not exist or does not fit in data
+ */
+bool jsd_vbus_get_sdo(jsd_vbus_t* self, uint16_t slave_id, uint16_t index,
+                      uint8_t subindex, void* data, uint16_t size);
+
+/**
+ * @brief Sets the inputs a slave returns to the master
+ *
+ * @param self pointer to the virtual bus
+ * @param slave_id position of the slave on the bus
+ * @param data TxPDO image
+ * @param size size of data in bytes, truncated to the slave's TxPDO size
+ */
+void jsd_vbus_write_txpdo(jsd_vbus_t* self, uint16_t slave_id,
+                          const void* data, uint16_t size);
+
+/**
+ * @brief Gets the outputs a slave last received from the master
+ *
+ * @param self pointer to the virtual bus
+ * @param slave_id position of the slave on the bus
+ * @param data output RxPDO image
+ * @param size size of data in bytes, truncated to the slave's RxPDO size
+ */
+void jsd_vbus_read_rxpdo(jsd_vbus_t* self, uint16_t slave_id, void* data,
+                         uint16_t size);
+
+/**
+ * @brief Queues a CoE emergency message from a slave
+ *
+ * The message is placed in the input mailbox as soon as it is empty, where
+ * SOEM picks it up on the next mailbox poll and pushes it to its error list.
+ *
+ * @param self pointer to the virtual bus
+ * @param slave_id position of the slave on the bus
+ * @param error_code EMCY error code
+ * @param error_register CANopen error register, 0x1001
+ * @return false if the slave has no mailbox or its queue is full
+ */
+bool jsd_vbus_post_emcy(jsd_vbus_t* self, uint16_t slave_id,
+                        uint16_t error_code, uint8_t error_register);
+
+/**
+ * @brief Gets the AL state of a slave
+ *
+ * @param self pointer to the virtual bus
+ * @param slave_id position of the slave on the bus
+ * @return AL status, including the EC_STATE_ERROR flag
+ */
+ec_state jsd_vbus_get_slave_state(jsd_vbus_t* self, uint16_t slave_id);
+
+/**
+ * @brief Passes an Ethernet frame through all slaves, in place
+ *
+ * This is what the bus thread does with each frame SOEM sends. Exposed to test
+ * and benchmark the slave emulation without a socket.
+ *
+ * @param self pointer to the virtual bus
+ * @param frame Ethernet frame carrying EtherCAT datagrams
+ * @param size size of the frame in bytes
+ * @return size of the returned frame, 0 if the frame is dropped
+ */
+size_t jsd_vbus_process_frame(jsd_vbus_t* self, uint8_t* frame, size_t size);
+
+/**
+ * @brief Schedules a fault, timed in frames received by the bus
+ *
+ * Faults of the same type may overlap. Each frame the bus receives advances
+ * the schedule, so at one frame per cycle the delay and duration are cycles.
+ *
+ * @param self pointer to the virtual bus
+ * @param fault type, slave, delay from now and duration of the fault
+ * @return false if the fault is invalid or JSD_VBUS_MAX_FAULTS are pending
+ */
+bool jsd_vbus_inject_fault(jsd_vbus_t* self, jsd_vbus_fault_t fault);
+
+/**
+ * @brief Ends active faults and cancels scheduled ones
+ *
+ * Lost slaves reconnect in INIT and held EMCY messages are released.
+ *
+ * @param self pointer to the virtual bus
+ */
+void jsd_vbus_clear_faults(jsd_vbus_t* self);
+
+/**
+ * @brief Gets the number of scheduled or active faults
+ *
+ * @param self pointer to the virtual bus
+ * @return 0 once every injected fault has ended
+ */
+uint16_t jsd_vbus_get_num_faults(jsd_vbus_t* self);
+
+/**
+ * @brief Gets the number of SDO writes a slave has accepted
+ *
+ * @param self pointer to the virtual bus
+ * @param slave_id position of the slave on the bus
+ * @return SDO downloads answered without abort
+ */
+uint64_t jsd_vbus_get_sdo_downloads(jsd_vbus_t* self, uint16_t slave_id);
+
+/**
+ * @brief Gets the number of frames the bus has received, including dropped
+ *        ones
+ *
+ * @param self pointer to the virtual bus
+ * @return frame count
+ */
+uint64_t jsd_vbus_get_frame_count(jsd_vbus_t* self);
+
+/**
+ * @brief Converts a fault type to a string for printing
+ *
+ * @param type fault type
+ * @return name of the fault
+ */
+const char* jsd_vbus_fault_type_to_string(jsd_vbus_fault_type_t type);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
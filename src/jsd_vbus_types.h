@@ -0,0 +1,164 @@
+#ifndef JSD_VBUS_TYPES_H
+#define JSD_VBUS_TYPES_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#define JSD_VBUS_MAX_SLAVES (64)
+
+/// Emulated ESC address space: registers and 4 KiB of process RAM
+#define JSD_VBUS_ESC_BYTES (0x2000)
+
+/// Emulated SII EEPROM size
+#define JSD_VBUS_SII_BYTES (2048)
+
+/// Size of each mailbox, large enough for all non-segmented JSD transfers
+#define JSD_VBUS_MBX_BYTES (512)
+
+/// Emergency messages a slave holds until the master reads its mailbox
+#define JSD_VBUS_EMCY_QUEUE_SIZE (8)
+
+#define JSD_VBUS_OD_MAX_ENTRIES (256)
+#define JSD_VBUS_OD_DATA_BYTES (4096)
+
+/// Faults scheduled or active at once
+#define JSD_VBUS_MAX_FAULTS (16)
+
+struct jsd_vbus_s;
+
+/**
+ * @brief Per-slave application behind the emulated ESC
+ *
+ * Called by the bus after every frame that exchanged the slave's process data
+ * while the slave is in SAFE-OP or OP. The callback consumes the outputs the
+ * master just wrote and produces the inputs returned by the next frame, like
+ * the firmware of a real slave.
+ *
+ * @param vbus virtual bus, locked for the duration of the call
+ * @param slave_id position of the slave on the bus
+ * @param rxpdo outputs written by the master
+ * @param rxpdo_bytes size of rxpdo
+ * @param txpdo inputs read by the master on the next frame
+ * @param txpdo_bytes size of txpdo
+ * @param time_nsec local clock of the bus
+ * @param user pointer registered with the callback
+ */
+typedef void (*jsd_vbus_model_t)(struct jsd_vbus_s* vbus, uint16_t slave_id,
+                                 const uint8_t* rxpdo, uint16_t rxpdo_bytes,
+                                 uint8_t* txpdo, uint16_t txpdo_bytes,
+                                 int64_t time_nsec, void* user);
+
+typedef struct {
+  uint16_t error_code;
+  uint8_t  error_register;
+} jsd_vbus_emcy_t;
+
+/**
+ * @brief Failures the virtual bus can inject, see jsd_vbus_inject_fault(...)
+ */
+typedef enum {
+  JSD_VBUS_FAULT_DROP_FRAME = 0,   ///< frames are lost, slave_id is ignored
+  JSD_VBUS_FAULT_CORRUPT_WKC,      ///< process data is exchanged uncounted
+  JSD_VBUS_FAULT_SAFE_OP_ERROR,    ///< SAFE-OP + ERROR, refuses OP while active
+  JSD_VBUS_FAULT_SLAVE_LOST,       ///< cut from the line, powers up in INIT
+  JSD_VBUS_FAULT_MAILBOX_TIMEOUT,  ///< mailbox requests are never answered
+  JSD_VBUS_FAULT_DELAY_EMCY,       ///< EMCY messages are held back
+  JSD_VBUS_NUM_FAULT_TYPES,
+} jsd_vbus_fault_type_t;
+
+/**
+ * @brief Fault scheduled in frames received by the bus
+ */
+typedef struct {
+  jsd_vbus_fault_type_t type;
+  uint16_t              slave_id;      ///< faulty slave, 0 for all slaves
+  uint32_t              delay_frames;  ///< from injection to the fault
+  uint32_t              frames;        ///< duration, 0 until cleared
+} jsd_vbus_fault_t;
+
+typedef struct {
+  jsd_vbus_fault_t fault;
+  uint64_t         start_frame;  ///< first faulty frame
+  uint64_t         end_frame;    ///< first healthy frame, 0 for never
+  bool             active;
+} jsd_vbus_injected_fault_t;
+
+typedef struct {
+  uint16_t index;
+  uint8_t  subindex;
+  uint16_t size;
+  uint16_t offset;  ///< into jsd_vbus_slave_t::od_data
+} jsd_vbus_od_entry_t;
+
+/**
+ * @brief Emulated slave: ESC memory, SII EEPROM and CoE object dictionary
+ */
+typedef struct {
+  uint32_t vendor_id;
+  uint32_t product_code;
+  bool     has_mailbox;
+  uint8_t  rxpdo_sm;     ///< SyncManager of the outputs
+  uint8_t  txpdo_sm;     ///< SyncManager of the inputs
+  uint16_t rxpdo_start;  ///< default ESC address of the outputs
+  uint16_t txpdo_start;  ///< default ESC address of the inputs
+  uint16_t rxpdo_bytes;  ///< default size of the outputs
+  uint16_t txpdo_bytes;  ///< default size of the inputs
+
+  uint8_t esc[JSD_VBUS_ESC_BYTES];
+  uint8_t sii[JSD_VBUS_SII_BYTES];
+
+  jsd_vbus_od_entry_t od[JSD_VBUS_OD_MAX_ENTRIES];
+  uint16_t            od_count;
+  uint8_t             od_data[JSD_VBUS_OD_DATA_BYTES];
+  uint16_t            od_data_used;
+
+  uint64_t sdo_downloads;  ///< SDO writes answered without abort
+
+  uint8_t mbx_response[JSD_VBUS_MBX_BYTES];  ///< held while SM1 is full
+  bool    mbx_response_pending;
+  jsd_vbus_emcy_t emcy[JSD_VBUS_EMCY_QUEUE_SIZE];
+  uint8_t         emcy_count;
+
+  bool             pdo_exchanged;  ///< set while a frame touches process data
+  jsd_vbus_model_t model;
+  void*            model_user;
+
+  // Set from the active faults before each frame
+  bool lost;
+  bool wkc_corrupted;
+  bool safe_op_locked;
+  bool mailbox_muted;
+  bool emcy_held;
+} jsd_vbus_slave_t;
+
+/**
+ * @brief Software EtherCAT segment replacing the NIC
+ *
+ * Slaves are connected in a line in the order they are added.
+ */
+typedef struct jsd_vbus_s {
+  jsd_vbus_slave_t slaves[JSD_VBUS_MAX_SLAVES + 1];  ///< 1-indexed like SOEM
+  uint16_t         num_slaves;
+
+  pthread_mutex_t mutex;  ///< guards slaves against the bus thread
+  pthread_t       thread;
+  bool            thread_running;
+  int             socket;  ///< bus end of the socket pair, -1 if closed
+  int64_t         epoch_nsec;  ///< CLOCK_MONOTONIC origin of the local clock
+
+  jsd_vbus_injected_fault_t faults[JSD_VBUS_MAX_FAULTS];
+  uint16_t                  num_faults;
+  uint64_t                  frame_count;  ///< frames received, dropped or not
+  bool                      dropping_frames;
+} jsd_vbus_t;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,258 @@
+#include "jsd/jsd_watchdog.h"
+
+#include <assert.h>
+#include <string.h>
+#include <time.h>
+
+#include "ethercat.h"
+#include "jsd/jsd_egd.h"
+#include "jsd/jsd_epd.h"
+#include "jsd/jsd_print.h"
+
+// The heartbeat is sampled several times per timeout to bound detection latency,
+// and at least every 10 ms so jsd_watchdog_stop(...) returns promptly
+#define JSD_WATCHDOG_CHECKS_PER_TIMEOUT (4)
+#define JSD_WATCHDOG_MIN_CHECK_PERIOD_NSEC (100000LL)
+#define JSD_WATCHDOG_MAX_CHECK_PERIOD_NSEC (10000000LL)
+
+static void jsd_watchdog_apply_safe_outputs(jsd_t* self) {
+  uint16_t   num_slaves = *self->ecx_context.slavecount;
+  ec_slavet* slaves     = self->ecx_context.slavelist;
+  uint16_t   slave_id;
+
+  for (slave_id = 1; slave_id <= num_slaves; ++slave_id) {
+    ec_slavet* slave = &slaves[slave_id];
+    if (slave->Obytes == 0 || slave->outputs == NULL) {
+      continue;
+    }
+
+    // Kept aside for jsd_watchdog_restore_outputs(...)
+    size_t offset = slave->outputs - (uint8_t*)self->IOmap;
+    memcpy(&self->watchdog.saved_outputs[offset], slave->outputs,
+           slave->Obytes);
+
+    if (self->watchdog.safe_outputs_set[slave_id]) {
+      memcpy(slave->outputs, &self->watchdog.safe_outputs[offset],
+             slave->Obytes);
+      continue;
+    }
+
+    if (!self->slave_configs[slave_id].configuration_active) {
+      continue;
+    }
+    switch (slave->eep_id) {
+      case JSD_EPD_PRODUCT_CODE:
+        jsd_epd_write_safe_outputs(self, slave_id, slave->outputs);
+        break;
+      case JSD_EGD_PRODUCT_CODE:
+        jsd_egd_write_safe_outputs(self, slave_id, slave->outputs);
+        break;
+      default:
+        // Keep last outputs
+        break;
+    }
+  }
+}
+
+// The application owns the IOmap outputs, a resumed cycle sends its own values
+static void jsd_watchdog_restore_outputs(jsd_t* self) {
+  uint16_t   num_slaves = *self->ecx_context.slavecount;
+  ec_slavet* slaves     = self->ecx_context.slavelist;
+  uint16_t   slave_id;
+
+  for (slave_id = 1; slave_id <= num_slaves; ++slave_id) {
+    ec_slavet* slave = &slaves[slave_id];
+    if (slave->Obytes == 0 || slave->outputs == NULL) {
+      continue;
+    }
+    size_t offset = slave->outputs - (uint8_t*)self->IOmap;
+    memcpy(slave->outputs, &self->watchdog.saved_outputs[offset],
+           slave->Obytes);
+  }
+}
+
+static void jsd_watchdog_send_safe_frame(jsd_t* self) {
+  pthread_mutex_lock(&self->watchdog.frame_mutex);
+  // SOEM receives every pending frame at once and sums their working counters,
+  // so the frame of the stalled cycle is received first and its result kept
+  // for the next jsd_read(...)
+  if (__atomic_load_n(&self->watchdog.frame_pending, __ATOMIC_ACQUIRE)) {
+    self->watchdog.frame_wkc =
+        ecx_receive_processdata(&self->ecx_context, EC_TIMEOUTRET);
+    __atomic_store_n(&self->watchdog.frame_pending, false, __ATOMIC_RELEASE);
+    self->watchdog.frame_received = true;
+  }
+  jsd_watchdog_apply_safe_outputs(self);
+  ecx_send_overlap_processdata(&self->ecx_context);
+  // Keep SOEM's frame index stack balanced
+  ecx_receive_processdata(&self->ecx_context, EC_TIMEOUTRET);
+  jsd_watchdog_restore_outputs(self);
+  pthread_mutex_unlock(&self->watchdog.frame_mutex);
+
+  pthread_mutex_lock(&self->watchdog.stats_mutex);
+  self->watchdog.stats.safe_frame_count++;
+  pthread_mutex_unlock(&self->watchdog.stats_mutex);
+}
+
+void jsd_watchdog_check(jsd_t* self, int64_t now_nsec) {
+  jsd_watchdog_t* wd = &self->watchdog;
+
+  int64_t timeout_nsec =
+      (int64_t)wd->config.timeout_us * JSD_TIME_NSEC_PER_USEC;
+  int64_t heartbeat = __atomic_load_n(&wd->heartbeat_nsec, __ATOMIC_ACQUIRE);
+
+  if (now_nsec - heartbeat > timeout_nsec) {
+    if (!wd->stats.stalled) {
+      pthread_mutex_lock(&wd->stats_mutex);
+      wd->stats.stalled               = true;
+      wd->stats.last_stall_start_nsec = heartbeat;
+      wd->stats.stall_count++;
+      pthread_mutex_unlock(&wd->stats_mutex);
+
+      WARNING("Cycle stalled, no jsd_write(...) for %.3lf ms",
+              (double)(now_nsec - heartbeat) / 1.0e6);
+    }
+    if (wd->config.send_safe_outputs) {
+      jsd_watchdog_send_safe_frame(self);
+    }
+
+  } else if (wd->stats.stalled) {
+    pthread_mutex_lock(&wd->stats_mutex);
+    int64_t duration = heartbeat - wd->stats.last_stall_start_nsec;
+    wd->stats.stalled                  = false;
+    wd->stats.last_stall_duration_nsec = duration;
+    if (duration > wd->stats.max_stall_duration_nsec) {
+      wd->stats.max_stall_duration_nsec = duration;
+    }
+    pthread_mutex_unlock(&wd->stats_mutex);
+
+    MSG("Cycle resumed after %.3lf ms", (double)duration / 1.0e6);
+  }
+}
+
+void* jsd_watchdog_thread_loop(void* void_data) {
+  jsd_t*          self = (jsd_t*)void_data;
+  jsd_watchdog_t* wd   = &self->watchdog;
+
+  if (self->arena.base) {
+    jsd_memory_prefault_stack(JSD_MEMORY_THREAD_STACK_PREFAULT_BYTES);
+  }
+
+  int64_t period_nsec = (int64_t)wd->config.timeout_us *
+                        JSD_TIME_NSEC_PER_USEC /
+                        JSD_WATCHDOG_CHECKS_PER_TIMEOUT;
+  if (period_nsec < JSD_WATCHDOG_MIN_CHECK_PERIOD_NSEC) {
+    period_nsec = JSD_WATCHDOG_MIN_CHECK_PERIOD_NSEC;
+  }
+  if (period_nsec > JSD_WATCHDOG_MAX_CHECK_PERIOD_NSEC) {
+    period_nsec = JSD_WATCHDOG_MAX_CHECK_PERIOD_NSEC;
+  }
+
+  struct timespec wakeup;
+  clock_gettime(CLOCK_MONOTONIC, &wakeup);
+
+  while (!__atomic_load_n(&wd->join_flag, __ATOMIC_ACQUIRE)) {
+    wakeup.tv_nsec += period_nsec;
+    while (wakeup.tv_nsec >= JSD_TIME_NSEC_PER_SEC) {
+      wakeup.tv_nsec -= JSD_TIME_NSEC_PER_SEC;
+      wakeup.tv_sec++;
+    }
+    clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wakeup, NULL);
+
+    jsd_watchdog_check(self, jsd_time_get_fast_mono_time_nsec());
+  }
+
+  return NULL;
+}
+
+bool jsd_watchdog_start(jsd_t* self, jsd_watchdog_config_t config) {
+  assert(self);
+
+  if (!self->init_complete) {
+    ERROR("Watchdog must be started after jsd_init()");
+    return false;
+  }
+  if (__atomic_load_n(&self->watchdog.running, __ATOMIC_ACQUIRE)) {
+    WARNING("Watchdog is already running");
+    return false;
+  }
+  if (config.timeout_us == 0) {
+    ERROR("Watchdog timeout must be positive");
+    return false;
+  }
+
+  self->watchdog.config    = config;
+  __atomic_store_n(&self->watchdog.join_flag, false, __ATOMIC_RELAXED);
+  memset(&self->watchdog.stats, 0, sizeof(self->watchdog.stats));
+  jsd_watchdog_heartbeat(self);
+
+  // Running must be visible before the thread can send frames, so jsd_read(...)
+  // and jsd_write(...) take the frame mutex from now on
+  __atomic_store_n(&self->watchdog.running, true, __ATOMIC_SEQ_CST);
+
+  if (0 != jsd_memory_thread_create(&self->watchdog.thread,
+                                    self->arena.base != NULL,
+                                    jsd_watchdog_thread_loop, (void*)self)) {
+    ERROR("Failed to create watchdog thread");
+    __atomic_store_n(&self->watchdog.running, false, __ATOMIC_SEQ_CST);
+    return false;
+  }
+
+  MSG("Watchdog started, timeout: %u us, safe outputs: %s",
+      config.timeout_us, config.send_safe_outputs ? "on" : "off");
+  return true;
+}
+
+void jsd_watchdog_stop(jsd_t* self) {
+  assert(self);
+
+  if (!__atomic_load_n(&self->watchdog.running, __ATOMIC_ACQUIRE)) {
+    return;
+  }
+
+  __atomic_store_n(&self->watchdog.join_flag, true, __ATOMIC_RELEASE);
+  pthread_join(self->watchdog.thread, NULL);
+  __atomic_store_n(&self->watchdog.running, false, __ATOMIC_SEQ_CST);
+  MSG("Watchdog stopped");
+}
+
+bool jsd_watchdog_set_safe_outputs(jsd_t* self, uint16_t slave_id,
+                                   const void* outputs, size_t size) {
+  assert(self);
+  assert(outputs);
+
+  if (!self->init_complete) {
+    ERROR("Safe outputs must be set after jsd_init()");
+    return false;
+  }
+  if (slave_id == 0 || slave_id > *self->ecx_context.slavecount) {
+    ERROR("Bad slave_id: %u", slave_id);
+    return false;
+  }
+
+  ec_slavet* slave = &self->ecx_context.slavelist[slave_id];
+  if (size != slave->Obytes || slave->outputs == NULL) {
+    ERROR("Safe outputs of slave[%u] must be %u bytes, got %zu", slave_id,
+          slave->Obytes, size);
+    return false;
+  }
+
+  size_t offset = slave->outputs - (uint8_t*)self->IOmap;
+  pthread_mutex_lock(&self->watchdog.frame_mutex);
+  memcpy(&self->watchdog.safe_outputs[offset], outputs, size);
+  self->watchdog.safe_outputs_set[slave_id] = true;
+  pthread_mutex_unlock(&self->watchdog.frame_mutex);
+
+  return true;
+}
+
+jsd_watchdog_stats_t jsd_watchdog_get_stats(jsd_t* self) {
+  assert(self);
+
+  jsd_watchdog_stats_t stats;
+  pthread_mutex_lock(&self->watchdog.stats_mutex);
+  stats = self->watchdog.stats;
+  pthread_mutex_unlock(&self->watchdog.stats_mutex);
+
+  return stats;
+}
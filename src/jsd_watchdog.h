@@ -0,0 +1,37 @@
+#ifndef JSD_WATCHDOG_H
+#define JSD_WATCHDOG_H
+
+#include "jsd/jsd_watchdog_pub.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Publishes the heartbeat of the current cycle, called by jsd_write(...)
+ *
+ * @param self pointer to JSD context
+ */
+static inline void jsd_watchdog_heartbeat(jsd_t* self) {
+  __atomic_store_n(&self->watchdog.heartbeat_nsec,
+                   jsd_time_get_fast_mono_time_nsec(), __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Compares the heartbeat against the timeout, called by the thread
+ *
+ * Records the start and end of stalls and, while stalled, transmits a frame of
+ * safe outputs if enabled. Only the watchdog thread calls this while running.
+ *
+ * @param self pointer to JSD context
+ * @param now_nsec monotonic time of the check
+ */
+void jsd_watchdog_check(jsd_t* self, int64_t now_nsec);
+
+void* jsd_watchdog_thread_loop(void* self);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
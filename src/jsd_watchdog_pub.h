@@ -0,0 +1,64 @@
+#ifndef JSD_WATCHDOG_PUB_H
+#define JSD_WATCHDOG_PUB_H
+
+#include "jsd/jsd_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Starts the supervisory cycle watchdog thread
+ *
+ * The watchdog monitors the heartbeat published by every jsd_write(...). When
+ * no frame has been written for longer than config.timeout_us, a stall is
+ * recorded and, if config.send_safe_outputs is set, the watchdog transmits
+ * safe outputs until the application resumes: Elmo drives are commanded to
+ * Quick Stop and slaves with configured safe outputs receive those. Other
+ * slaves keep their last outputs.
+ *
+ * Once started, jsd_read(...) and jsd_write(...) serialize with the watchdog
+ * through an uncontended mutex. Must be called after jsd_init(...), stopped by
+ * jsd_watchdog_stop(...) or jsd_free(...).
+ *
+ * @param self pointer to JSD context
+ * @param config watchdog configuration
+ * @return true if the thread was started
+ */
+bool jsd_watchdog_start(jsd_t* self, jsd_watchdog_config_t config);
+
+/**
+ * @brief Stops the watchdog thread, no-op if it is not running
+ *
+ * @param self pointer to JSD context
+ */
+void jsd_watchdog_stop(jsd_t* self);
+
+/**
+ * @brief Sets the outputs the watchdog transmits to a slave while stalled
+ *
+ * Must be called after jsd_init(...). Overrides the default safe outputs of
+ * the slave's driver, if any.
+ *
+ * @param self pointer to JSD context
+ * @param slave_id index of slave on the bus
+ * @param outputs raw RxPDO image of the slave
+ * @param size size of outputs, must match the slave's output size
+ * @return true on success
+ */
+bool jsd_watchdog_set_safe_outputs(jsd_t* self, uint16_t slave_id,
+                                   const void* outputs, size_t size);
+
+/**
+ * @brief Get a snapshot of the watchdog stall statistics
+ *
+ * @param self pointer to JSD context
+ * @return stall statistics
+ */
+jsd_watchdog_stats_t jsd_watchdog_get_stats(jsd_t* self);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -9,137 +9,15 @@
 #include "jsd_test_utils.h"
 
 extern bool  quit;
-extern FILE* file;
 uint8_t      epd_slave_id;
 uint8_t      el3602_slave_id;
 uint8_t      el2124_slave_id;
-double       server_startup_s;
 double       amplitude;
 double       sine_freq;
 uint8_t      el2124_cmd_output[JSD_EL2124_NUM_CHANNELS] = {1, 0, 1, 0};
 
 int16_t BRAKE_TIME_MSEC = 100;
 
-void telemetry_header() {
-  if (!file) {
-    return;
-  }
-
-  fprintf(file, "rel_time_s, ");
-  fprintf(file, "cycle_period_s, ");
-
-  // EPD headers
-  fprintf(file, "EPD_actual_position, ");
-  fprintf(file, "EPD_actual_velocity, ");
-  fprintf(file, "EPD_actual_current, ");
-  fprintf(file, "EPD_cmd_position, ");
-  fprintf(file, "EPD_cmd_velocity, ");
-  fprintf(file, "EPD_cmd_current, ");
-  fprintf(file, "EPD_cmd_max_current, ");
-  fprintf(file, "EPD_cmd_ff_position, ");
-  fprintf(file, "EPD_cmd_ff_velocity, ");
-  fprintf(file, "EPD_cmd_ff_current, ");
-  fprintf(file, "EPD_actual_state_machine_state, ");
-  fprintf(file, "EPD_actual_mode_of_operation, ");
-  fprintf(file, "EPD_sto_engaged, ");
-  fprintf(file, "EPD_hall_state, ");
-  fprintf(file, "EPD_motor_on, ");
-  fprintf(file, "EPD_in_motion, ");
-  fprintf(file, "EPD_servo_enabled, ");
-  fprintf(file, "EPD_warning, ");
-  fprintf(file, "EPD_target_reached, ");
-  fprintf(file, "EPD_bus_voltage, ");
-  fprintf(file, "EPD_analog_input_voltage, ");
-  // Omitted digital inputs and digital output commands.
-  fprintf(file, "EPD_drive_temperature, ");
-
-  // EL3602 headers
-  for (int i = 0; i < JSD_EL3602_NUM_CHANNELS; ++i) {
-    fprintf(file, "EL3602_ch%d_raw_value, EL3602_ch%d_volts, ", i, i);
-    fprintf(file, "EL3602_limit1_ch%d, EL3602_limit2_ch%d, ", i, i);
-    fprintf(file, "EL3602_txPDO_state_ch%d, EL3602_txPDO_toggle_ch%d, ", i, i);
-    fprintf(
-        file,
-        "EL3602_error_ch%d, EL3602_underrange_ch%d, EL3602_overrange_ch%d, ", i,
-        i, i);
-  }
-
-  // EL2124 headers
-  for (int i = 0; i < JSD_EL2124_NUM_CHANNELS; ++i) {
-    fprintf(file, "EL2124_output_ch%d, ", i);
-  }
-
-  fprintf(file, "\n");
-}
-
-void telemetry_data(void* self) {
-  static double last_rel_time_s = 0.0;
-  assert(self);
-  if (!file) {
-    return;
-  }
-
-  double now_s          = jsd_time_get_mono_time_sec();
-  double rel_time_s     = now_s - server_startup_s;
-  double cycle_period_s = rel_time_s - last_rel_time_s;
-  last_rel_time_s       = rel_time_s;
-
-  fprintf(file, "%lf, ", rel_time_s);
-  fprintf(file, "%lf, ", cycle_period_s);
-
-  single_device_server_t* sds = (single_device_server_t*)self;
-
-  // EPD data
-  const jsd_epd_state_t* epd_state = jsd_epd_get_state(sds->jsd, epd_slave_id);
-  fprintf(file, "%i, ", epd_state->actual_position);
-  fprintf(file, "%i, ", epd_state->actual_velocity);
-  fprintf(file, "%lf, ", epd_state->actual_current);
-  fprintf(file, "%i, ", epd_state->cmd_position);
-  fprintf(file, "%i, ", epd_state->cmd_velocity);
-  fprintf(file, "%lf, ", epd_state->cmd_current);
-  fprintf(file, "%lf, ", epd_state->cmd_max_current);
-  fprintf(file, "%i, ", epd_state->cmd_ff_position);
-  fprintf(file, "%i, ", epd_state->cmd_ff_velocity);
-  fprintf(file, "%lf, ", epd_state->cmd_ff_current);
-  fprintf(file, "%u, ", epd_state->actual_state_machine_state);
-  fprintf(file, "%u, ", epd_state->actual_mode_of_operation);
-  fprintf(file, "%u, ", epd_state->sto_engaged);
-  fprintf(file, "%u, ", epd_state->hall_state);
-  fprintf(file, "%u, ", epd_state->motor_on);
-  fprintf(file, "%u, ", epd_state->in_motion);
-  fprintf(file, "%u, ", epd_state->servo_enabled);
-  fprintf(file, "%u, ", epd_state->warning);
-  fprintf(file, "%u, ", epd_state->target_reached);
-  fprintf(file, "%lf, ", epd_state->bus_voltage);
-  fprintf(file, "%lf, ", epd_state->analog_input_voltage);
-  // Omitted digital inputs and digital output commands.
-  fprintf(file, "%f, ", epd_state->drive_temperature);
-
-  // EL3602 data
-  const jsd_el3602_state_t* el3602_state =
-      jsd_el3602_get_state(sds->jsd, el3602_slave_id);
-  for (int i = 0; i < JSD_EL3602_NUM_CHANNELS; ++i) {
-    fprintf(file, "%u, %lf, ", el3602_state->adc_value[i],
-            el3602_state->voltage[i]);
-    fprintf(file, "%u, %u, ", el3602_state->limit1[i], el3602_state->limit2[i]);
-    fprintf(file, "%u, %u, ", el3602_state->txPDO_state[i],
-            el3602_state->txPDO_toggle[i]);
-    fprintf(file, "%u, %u, ", el3602_state->error[i],
-            el3602_state->underrange[i]);
-    fprintf(file, "%u, ", el3602_state->overrange[i]);
-  }
-
-  // EL2124 data
-  const jsd_el2124_state_t* el2124_state =
-      jsd_el2124_get_state(sds->jsd, el2124_slave_id);
-  for (int i = 0; i < JSD_EL2124_NUM_CHANNELS; ++i) {
-    fprintf(file, "%u, ", el2124_state->output[i]);
-  }
-
-  fprintf(file, "\n");
-  fflush(file);
-}
-
 void print_info(void* self) {
   assert(self);
 
@@ -173,12 +51,16 @@ void extract_data(void* self) {
 void command(void* self) {
   static int32_t iter             = 0;
   static int32_t pos_offset       = 0;
+  static double  command_start_s  = 0.0;
   static double  motion_startup_s = 0.0;
   static bool    first_motion_cmd = true;
 
   single_device_server_t* sds = (single_device_server_t*)self;
 
   double now_s = jsd_time_get_mono_time_sec();
+  if (iter == 0) {
+    command_start_s = now_s;
+  }
 
   // Command EL2124
   // Toggle digital output every 10 seconds.
@@ -195,8 +77,8 @@ void command(void* self) {
   jsd_epd_read(sds->jsd, epd_slave_id);
   const jsd_epd_state_t* state = jsd_epd_get_state(sds->jsd, epd_slave_id);
 
-  // Wait 2 seconds after server starts to issue first reset.
-  if ((now_s - server_startup_s) < 2.0) {
+  // Wait 2 seconds after the first command to issue first reset.
+  if ((now_s - command_start_s) < 2.0) {
     return;
   }
 
@@ -261,8 +143,6 @@ int main(int argc, char* argv[]) {
 
   single_device_server_t sds;
 
-  sds_set_telemetry_header_callback(&sds, telemetry_header);
-  sds_set_telemetry_data_callback(&sds, telemetry_data);
   sds_set_print_info_callback(&sds, print_info);
   sds_set_extract_data_callback(&sds, extract_data);
   sds_set_command_callback(&sds, command);
@@ -324,9 +204,12 @@ int main(int argc, char* argv[]) {
 
   jsd_set_slave_config(sds.jsd, el2124_slave_id, el2124_config);
 
-  server_startup_s = jsd_time_get_mono_time_sec();
+  // Telemetry columns, logged from the states of the configured devices
+  jsd_telemetry_add_state(sds.telemetry, sds.jsd, epd_slave_id, "EPD_");
+  jsd_telemetry_add_state(sds.telemetry, sds.jsd, el3602_slave_id, "EL3602_");
+  jsd_telemetry_add_state(sds.telemetry, sds.jsd, el2124_slave_id, "EL2124_");
 
-  sds_run(&sds, ifname, "/tmp/jsd_epd_network_test.csv");
+  sds_run(&sds, ifname, "/tmp/jsd_epd_network_test.tlm");
 
   return 0;
 }
\ No newline at end of file
@@ -81,30 +81,47 @@ void sds_setup(single_device_server_t* self, uint16_t loop_rate_hz) {
   self->jsd = jsd_alloc();
   MSG("jsd address: %p", self->jsd);
 
+  self->telemetry = jsd_telemetry_alloc();
+
   MSG_DEBUG("SDS_SETUP End");
 }
 
 void sds_run(single_device_server_t* self, char* device_name, char* filename) {
   assert(self);
-  assert(self->telemetry_header);
-  assert(self->telemetry_data);
   assert(self->print_info);
   assert(self->extract_data);
   assert(self->command);
 
   MSG_DEBUG("SDS_RUN Begin");
 
-  file = fopen(filename, "w");
-  if (!file) {
-    ERROR("Could not open file for writing: %s", filename);
-  }
+  // Binary telemetry when columns were added, the CSV callbacks otherwise
+  bool use_telemetry = self->telemetry->num_columns > 1;
+  if (use_telemetry) {
+    jsd_telemetry_config_t config = {0};
+    config.compress               = true;
+    if (!jsd_telemetry_start(self->telemetry, filename, config)) {
+      ERROR("Could not start telemetry: %s", filename);
+      use_telemetry = false;
+    } else {
+      MSG("Convert the telemetry with: jsd_telemetry_to_csv %s", filename);
+    }
+  } else {
+    assert(self->telemetry_header);
+    assert(self->telemetry_data);
+
+    file = fopen(filename, "w");
+    if (!file) {
+      ERROR("Could not open file for writing: %s", filename);
+    }
 
-  self->telemetry_header();
+    self->telemetry_header();
+  }
 
   uint32_t sds_iter = 0;
 
   if (!jsd_init(self->jsd, device_name, 1)) {
     ERROR("Could not init jsd");
+    jsd_telemetry_stop(self->telemetry);
     return;
   }
 
@@ -124,14 +141,21 @@ void sds_run(single_device_server_t* self, char* device_name, char* filename) {
 
     jsd_write(self->jsd);
 
-    self->telemetry_data(self);
+    if (use_telemetry) {
+      jsd_telemetry_push(self->telemetry);
+    } else {
+      self->telemetry_data(self);
+    }
 
     jsd_timer_process(self->jsd_timer);
     sds_iter++;
   }
 
   MSG_DEBUG("Closing now");
-  fclose(file);
+  if (file) {
+    fclose(file);
+  }
+  jsd_telemetry_free(self->telemetry);
   jsd_free(self->jsd);
   MSG_DEBUG("jsd freed");
   MSG_DEBUG("SDS_RUN End");
@@ -2,6 +2,7 @@
 #define JSD_TEST_UTILS_H_
 
 #include "jsd/jsd_pub.h"
+#include "jsd/jsd_telemetry_pub.h"
 #include "jsd/jsd_timer.h"
 
 void on_sigint(int signal);
@@ -18,6 +19,9 @@ typedef struct {
 
   jsd_t* jsd;
 
+  // Replaces the telemetry callbacks once columns are added to it
+  jsd_telemetry_t* telemetry;
+
 } single_device_server_t;
 
 void sds_set_telemetry_header_callback(single_device_server_t* self,
@@ -0,0 +1,178 @@
+#include <assert.h>
+#include <string.h>
+
+#include "jsd/jsd_capture.h"
+#include "jsd/jsd_pub.h"
+
+#define TEST_STATION_1 (0x1001)
+#define TEST_STATION_2 (0x1002)
+
+static uint8_t frame[EC_BUFSIZE];
+
+// Ethernet frame holding a single datagram
+static size_t build_frame(uint8_t cmd, uint8_t idx, uint16_t adp, uint16_t ado,
+                          uint16_t len) {
+  uint16_t elength = 10 + len + EC_WKCSIZE;
+
+  memset(frame, 0, sizeof(frame));
+  frame[12]                 = ETH_P_ECAT >> 8;
+  frame[13]                 = ETH_P_ECAT & 0xFF;
+  frame[ETH_HEADERSIZE]     = elength & 0xFF;
+  frame[ETH_HEADERSIZE + 1] = (elength >> 8) | 0x10;
+  uint8_t* datagram         = &frame[ETH_HEADERSIZE + EC_ELENGTHSIZE];
+  datagram[0]               = cmd;
+  datagram[1]               = idx;
+  memcpy(&datagram[2], &adp, sizeof(adp));
+  memcpy(&datagram[4], &ado, sizeof(ado));
+  memcpy(&datagram[6], &len, sizeof(len));
+  return ETH_HEADERSIZE + EC_ELENGTHSIZE + elength;
+}
+
+static bool selected(jsd_t* jsd, uint8_t cmd, uint16_t adp, uint16_t ado) {
+  size_t bytes = build_frame(cmd, 0, adp, ado, 2);
+  return jsd_capture_select_frame(jsd, frame, bytes);
+}
+
+static void process(jsd_t* jsd, uint8_t cmd, uint8_t idx, uint16_t adp,
+                    uint16_t ado, bool outbound) {
+  jsd_capture_frame_t captured = {0};
+  captured.data       = frame;
+  captured.bytes      = build_frame(cmd, idx, adp, ado, 8);
+  captured.wire_bytes = captured.bytes;
+  captured.stamp_nsec = 1000000000LL + idx;
+  captured.outbound   = outbound;
+  jsd_capture_process_frame(jsd, &captured);
+}
+
+static void mark_cycle(jsd_t* jsd, uint8_t idx) {
+  jsd->ecx_context.idxstack->pushed = 1;
+  jsd->ecx_context.idxstack->idx[0] = idx;
+  jsd_capture_mark_cycle(jsd);
+}
+
+static uint32_t read_u32(FILE* file) {
+  uint32_t value;
+  assert(fread(&value, sizeof(value), 1, file) == 1);
+  return value;
+}
+
+int main() {
+  jsd_t* jsd = jsd_alloc();
+
+  MSG("Capture needs a network interface");
+  jsd_capture_config_t config = {0};
+  assert(!jsd_capture_start(jsd, "jsd_missing0", "/dev/null", config));
+
+  *jsd->ecx_context.slavecount = 2;
+  ec_slavet* slaves            = jsd->ecx_context.slavelist;
+  slaves[1].configadr          = TEST_STATION_1;
+  slaves[1].mbx_wo             = 0x1000;
+  slaves[1].mbx_l              = 128;
+  slaves[1].mbx_ro             = 0x1080;
+  slaves[1].mbx_rl             = 128;
+  slaves[2].configadr          = TEST_STATION_2;
+
+  MSG("Filtering process data and mailbox frames");
+  assert(selected(jsd, EC_CMD_LRW, 0, 0));
+  assert(selected(jsd, EC_CMD_FPWR, TEST_STATION_1, 0x1000));
+  assert(selected(jsd, EC_CMD_BRD, 0, ECT_REG_ALSTAT));
+
+  jsd->capture.filter = JSD_CAPTURE_FILTER_CYCLIC;
+  assert(selected(jsd, EC_CMD_LRW, 0, 0));
+  assert(!selected(jsd, EC_CMD_FPWR, TEST_STATION_1, 0x1000));
+
+  jsd->capture.filter = JSD_CAPTURE_FILTER_MAILBOX;
+  assert(selected(jsd, EC_CMD_FPWR, TEST_STATION_1, 0x1000));
+  assert(selected(jsd, EC_CMD_FPRD, TEST_STATION_1, 0x10FF));
+  assert(selected(jsd, EC_CMD_FPRD, TEST_STATION_1, ECT_REG_SM1STAT));
+  assert(!selected(jsd, EC_CMD_FPRD, TEST_STATION_1, 0x1100));
+  assert(!selected(jsd, EC_CMD_FPRD, TEST_STATION_2, ECT_REG_SM1STAT));
+  assert(!selected(jsd, EC_CMD_LRW, 0, 0));
+
+  MSG("Keeping the frames that reach a slave subset");
+  jsd->capture.filter            = JSD_CAPTURE_FILTER_ALL;
+  jsd->capture.slave_filter      = true;
+  jsd->capture.slave_selected[2] = true;
+  assert(!selected(jsd, EC_CMD_FPRD, TEST_STATION_1, ECT_REG_ALSTAT));
+  assert(selected(jsd, EC_CMD_FPRD, TEST_STATION_2, ECT_REG_ALSTAT));
+  assert(!selected(jsd, EC_CMD_APRD, 0, ECT_REG_ALSTAT));
+  assert(selected(jsd, EC_CMD_APRD, 0xFFFF, ECT_REG_ALSTAT));
+  assert(selected(jsd, EC_CMD_LRW, 0, 0));
+  assert(selected(jsd, EC_CMD_BRD, 0, ECT_REG_ALSTAT));
+  jsd->capture.slave_filter = false;
+
+  size_t bytes = build_frame(EC_CMD_LRW, 0, 0, 0, 2);
+  frame[12]    = 0x08;
+  assert(!jsd_capture_select_frame(jsd, frame, bytes));
+
+  MSG("Numbering frames with the cycle that sent them");
+  FILE* file        = tmpfile();
+  jsd->capture.file = file;
+  assert(jsd_capture_write_header(file, "eth0"));
+  mark_cycle(jsd, 5);
+  mark_cycle(jsd, 6);
+  process(jsd, EC_CMD_LRW, 6, 0, 0, true);
+  process(jsd, EC_CMD_LRW, 6, 0, 0, false);
+  process(jsd, EC_CMD_FPRD, 7, TEST_STATION_1, ECT_REG_SM1STAT, true);
+  jsd->capture.filter = JSD_CAPTURE_FILTER_CYCLIC;
+  process(jsd, EC_CMD_FPRD, 8, TEST_STATION_1, ECT_REG_SM1STAT, true);
+
+  jsd_capture_stats_t stats = jsd_capture_get_stats(jsd);
+  assert(stats.frames_written == 3);
+  assert(stats.frames_filtered == 1);
+  assert(stats.unmarked_cycles == 0);
+
+  MSG("Reading the pcapng file back");
+  rewind(file);
+  assert(read_u32(file) == 0x0A0D0D0A);
+  uint32_t length = read_u32(file);
+  assert(read_u32(file) == 0x1A2B3C4D);
+  assert(fseek(file, length - 12, SEEK_CUR) == 0);
+  assert(read_u32(file) == 1);
+  length = read_u32(file);
+  assert((read_u32(file) & 0xFFFF) == 1);  // LINKTYPE_ETHERNET
+  assert(fseek(file, length - 12, SEEK_CUR) == 0);
+
+  const uint32_t flags[3] = {2, 1, 2};
+  int            i;
+  for (i = 0; i < 3; ++i) {
+    uint8_t block[512];
+    assert(read_u32(file) == 6);
+    length = read_u32(file);
+    assert(length <= sizeof(block) + 8);
+    assert(fread(block, length - 8, 1, file) == 1);
+
+    uint32_t captured;
+    memcpy(&captured, &block[12], sizeof(captured));
+    size_t offset = 20 + ((captured + 3) & ~3U);
+
+    bool has_comment = false;
+    bool has_flags   = false;
+    while (offset + 4 <= length - 12) {
+      uint16_t code, size;
+      memcpy(&code, &block[offset], 2);
+      memcpy(&size, &block[offset + 2], 2);
+      if (code == 1) {
+        has_comment = size == strlen("cycle 1") &&
+                      memcmp(&block[offset + 4], "cycle 1", size) == 0;
+      } else if (code == 2) {
+        uint32_t value;
+        memcpy(&value, &block[offset + 4], sizeof(value));
+        has_flags = value == flags[i];
+      } else if (code == 0) {
+        break;
+      }
+      offset += 4 + ((size + 3) & ~3U);
+    }
+    assert(has_comment);
+    assert(has_flags);
+  }
+  assert(fgetc(file) == EOF);
+
+  fclose(file);
+  jsd->capture.file = NULL;
+  jsd_free(jsd);
+
+  SUCCESS("jsd_capture checks passed");
+  return 0;
+}
@@ -0,0 +1,46 @@
+#include <assert.h>
+
+#include "jsd/jsd_el2124_pub.h"
+#include "jsd/jsd_el3602_pub.h"
+
+int main() {
+  jsd_t* jsd = jsd_alloc();
+
+  MSG("Handles must not resolve before jsd_init()");
+  jsd_el2124_handle_t el2124;
+  assert(!jsd_el2124_get_handle(jsd, 1, &el2124));
+
+  // Pretend slave 1 is a configured EL2124 mapped at the start of the IOmap
+  jsd->init_complete                         = true;
+  *jsd->ecx_context.slavecount               = 2;
+  jsd->ecx_context.slavelist[1].eep_id       = JSD_EL2124_PRODUCT_CODE;
+  jsd->ecx_context.slavelist[1].outputs      = (uint8_t*)jsd->IOmap;
+  jsd->ecx_context.slavelist[1].Obytes       = 1;
+  jsd->slave_configs[1].configuration_active = true;
+  jsd->slave_configs[1].product_code         = JSD_EL2124_PRODUCT_CODE;
+  jsd->ecx_context.slavelist[2].eep_id       = JSD_EL2124_PRODUCT_CODE;
+
+  MSG("Checking handle validation");
+  jsd_el3602_handle_t el3602;
+  assert(!jsd_el3602_get_handle(jsd, 1, &el3602));  // wrong product code
+  assert(!jsd_el2124_get_handle(jsd, 2, &el2124));  // not configured
+  assert(!jsd_el2124_get_handle(jsd, 3, &el2124));  // not on the bus
+  assert(jsd_el2124_get_handle(jsd, 1, &el2124));
+
+  MSG("Checking handle accessors match the slave_id API");
+  jsd_el2124_handle_write_single_channel(&el2124, 0, 1);
+  jsd_el2124_handle_write_single_channel(&el2124, 2, 1);
+  jsd_el2124_handle_process(&el2124);
+  assert((uint8_t)jsd->IOmap[0] == 0x05);
+  assert(jsd_el2124_handle_get_state(&el2124) == jsd_el2124_get_state(jsd, 1));
+
+  jsd_el2124_write_single_channel(jsd, 1, 0, 0);
+  jsd_el2124_process(jsd, 1);
+  assert((uint8_t)jsd->IOmap[0] == 0x04);
+
+  jsd->init_complete = false;
+  jsd_free(jsd);
+
+  SUCCESS("jsd device handle checks passed");
+  return 0;
+}
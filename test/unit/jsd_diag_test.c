@@ -0,0 +1,298 @@
+#include <assert.h>
+#include <math.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "jsd/jsd_diag.h"
+#include "jsd/jsd_metrics_pub.h"
+#include "jsd/jsd_pub.h"
+#include "jsd/jsd_vbus.h"
+
+// An output SyncManager and FMMU at index 0, inputs at index 1
+static void setup_slave(ec_slavet* slave, bool outputs, bool inputs) {
+  memset(slave, 0, sizeof(*slave));
+  if (outputs) {
+    slave->Obytes            = 4;
+    slave->SM[2].SMlength    = 4;
+    slave->SMtype[2]         = 3;
+    slave->FMMU[0].LogLength = 4;
+    slave->FMMU[0].FMMUtype  = 2;
+  }
+  if (inputs) {
+    slave->Ibytes            = 8;
+    slave->SM[3].SMlength    = 8;
+    slave->SMtype[3]         = 4;
+    slave->FMMU[1].LogLength = 8;
+    slave->FMMU[1].FMMUtype  = 1;
+  }
+}
+
+static void healthy_regs(jsd_diag_pd_regs_t* regs) {
+  int i;
+  memset(regs, 0, sizeof(*regs));
+  regs->al_answered   = true;
+  regs->al_status     = EC_STATE_OPERATIONAL;
+  regs->sm_answered   = true;
+  regs->fmmu_answered = true;
+  for (i = 0; i < EC_MAXSM; ++i) {
+    regs->sm[8 * i + 6] = 0x01;
+  }
+  for (i = 0; i < EC_MAXFMMU; ++i) {
+    regs->fmmu[16 * i + 12] = 0x01;
+  }
+}
+
+static void check_cause(const ec_slavet* slave, const jsd_diag_pd_regs_t* regs,
+                        jsd_wkc_cause_t cause, uint8_t missing_wkc) {
+  uint8_t missing = 0xFF;
+  assert(jsd_diag_wkc_cause(slave, regs, &missing) == cause);
+  assert(missing == missing_wkc);
+}
+
+static bool wait_report(jsd_t* jsd, uint64_t scans, jsd_wkc_report_t* report) {
+  int wait;
+  for (wait = 0; wait < 1000; ++wait) {
+    if (jsd_get_bus_metrics(jsd).wkc_scans >= scans) {
+      return jsd_diag_get_wkc_report(jsd, report);
+    }
+    usleep(1000);
+  }
+  return false;
+}
+
+static void check_esc(jsd_t* jsd) {
+  jsd_esc_errors_t errors;
+  uint8_t          last[JSD_ESC_ERROR_REGS_BYTES];
+  uint8_t          regs[JSD_ESC_ERROR_REGS_BYTES];
+
+  MSG("Accumulating ESC error counters");
+  memset(&errors, 0, sizeof(errors));
+  memset(last, 0, sizeof(last));
+  memset(regs, 0, sizeof(regs));
+  regs[0x02] = 5;  // port 1 invalid frames
+  regs[0x03] = 2;  // port 1 RX errors
+  regs[0x09] = 4;  // port 1 forwarded RX errors
+  regs[0x0C] = 1;
+  regs[0x13] = 3;  // port 3 lost links
+  jsd_diag_accumulate_esc_errors(&errors, last, regs, 0.5);
+  assert(errors.invalid_frames[1] == 5);
+  assert(errors.rx_errors[1] == 2);
+  assert(errors.forwarded_rx_errors[1] == 4);
+  assert(errors.processing_unit_errors == 1);
+  assert(errors.lost_links[3] == 3);
+  assert(errors.local_error_rate[0] == 0);
+  assert(errors.local_error_rate[1] == (5 - 4 + 2) / 0.5);
+  assert(errors.lost_link_rate[3] == 3 / 0.5);
+
+  // Counters cleared in between restart from zero
+  memcpy(last, regs, sizeof(last));
+  regs[0x02] = 1;
+  regs[0x09] = 1;
+  jsd_diag_accumulate_esc_errors(&errors, last, regs, 1.0);
+  assert(errors.invalid_frames[1] == 6);
+  assert(errors.forwarded_rx_errors[1] == 5);
+  assert(errors.local_error_rate[1] == 0);
+  assert(errors.lost_link_rate[3] == 0);
+
+  MSG("Finding the neighbors of ports");
+  // Master - 1 - 2, with 3 on port 3 of slave 1
+  ec_slavet* slaves            = jsd->ecx_context.slavelist;
+  *jsd->ecx_context.slavecount = 3;
+  slaves[1].parent             = 0;
+  slaves[1].entryport          = 0;
+  slaves[2].parent             = 1;
+  slaves[2].parentport         = 1;
+  slaves[3].parent             = 1;
+  slaves[3].parentport         = 3;
+  assert(jsd_diag_port_neighbor(jsd, 1, 0) == 0);
+  assert(jsd_diag_port_neighbor(jsd, 1, 1) == 2);
+  assert(jsd_diag_port_neighbor(jsd, 1, 2) == JSD_LINK_NO_NEIGHBOR);
+  assert(jsd_diag_port_neighbor(jsd, 1, 3) == 3);
+  assert(jsd_diag_port_neighbor(jsd, 2, 0) == 1);
+  assert(jsd_diag_port_neighbor(jsd, 2, 1) == JSD_LINK_NO_NEIGHBOR);
+}
+
+static void check_dc(void) {
+  jsd_dc_quality_t quality;
+  double           m2 = 0;
+
+  MSG("Decoding the System Time Difference");
+  assert(jsd_diag_dc_sync_error(0x00000064) == 100);
+  assert(jsd_diag_dc_sync_error(0x80000064) == -100);
+  assert(jsd_diag_dc_sync_error(0) == 0);
+
+  MSG("Accumulating DC sync statistics");
+  memset(&quality, 0, sizeof(quality));
+  assert(!jsd_diag_update_dc_quality(&quality, &m2, 100, 350, 1000));
+  assert(quality.stddev_sync_error_nsec == 0);
+  assert(!jsd_diag_update_dc_quality(&quality, &m2, -300, 350, 1000));
+  assert(jsd_diag_update_dc_quality(&quality, &m2, 1400, 360, 1000));
+  assert(quality.samples == 3);
+  assert(quality.violations == 1);
+  assert(quality.out_of_sync);
+  assert(quality.sync_error_nsec == 1400);
+  assert(quality.max_sync_error_nsec == 1400);
+  assert(quality.propagation_delay_nsec == 360);
+  assert(fabs(quality.mean_sync_error_nsec - 400) < 1e-9);
+  // Sample deviation of 100, -300 and 1400
+  assert(fabs(quality.stddev_sync_error_nsec - sqrt(790000)) < 1e-6);
+
+  assert(!jsd_diag_update_dc_quality(&quality, &m2, -1000, 360, 1000));
+  assert(!quality.out_of_sync);
+  assert(quality.max_sync_error_nsec == 1400);
+}
+
+int main() {
+  ec_slavet          slave;
+  jsd_diag_pd_regs_t regs;
+
+  MSG("Estimating the working counter contributions");
+  setup_slave(&slave, true, true);
+  assert(jsd_diag_expected_wkc(&slave) == 3);
+  setup_slave(&slave, false, true);
+  assert(jsd_diag_expected_wkc(&slave) == 1);
+  setup_slave(&slave, false, false);
+  slave.Obits = 4;
+  assert(jsd_diag_expected_wkc(&slave) == 2);
+
+  MSG("Attributing losses from the registers");
+  setup_slave(&slave, true, true);
+  healthy_regs(&regs);
+  check_cause(&slave, &regs, JSD_WKC_CAUSE_NONE, 0);
+
+  regs.al_answered = false;
+  check_cause(&slave, &regs, JSD_WKC_CAUSE_NO_RESPONSE, 3);
+
+  healthy_regs(&regs);
+  regs.al_status = EC_STATE_PRE_OP;
+  check_cause(&slave, &regs, JSD_WKC_CAUSE_AL_STATE, 3);
+  regs.al_status = EC_STATE_SAFE_OP + EC_STATE_ERROR;
+  check_cause(&slave, &regs, JSD_WKC_CAUSE_AL_STATE, 2);
+
+  // An input-only slave in SAFE-OP still exchanges all its process data
+  setup_slave(&slave, false, true);
+  regs.al_status = EC_STATE_SAFE_OP;
+  regs.sm_answered = false;
+  check_cause(&slave, &regs, JSD_WKC_CAUSE_NO_RESPONSE, 1);
+
+  setup_slave(&slave, true, true);
+  healthy_regs(&regs);
+  regs.sm[8 * 2 + 6] = 0x00;
+  check_cause(&slave, &regs, JSD_WKC_CAUSE_SM, 2);
+  healthy_regs(&regs);
+  regs.sm[8 * 3 + 7] = 0x01;  // deactivated by the PDI
+  check_cause(&slave, &regs, JSD_WKC_CAUSE_SM, 1);
+
+  healthy_regs(&regs);
+  regs.fmmu[16 * 1 + 12] = 0x00;
+  check_cause(&slave, &regs, JSD_WKC_CAUSE_FMMU, 1);
+  regs.fmmu[16 * 0 + 12] = 0x00;
+  check_cause(&slave, &regs, JSD_WKC_CAUSE_FMMU, 3);
+
+  // Unused SyncManagers and FMMUs are ignored
+  healthy_regs(&regs);
+  regs.sm[8 * 5 + 6]      = 0x00;
+  regs.fmmu[16 * 3 + 12] = 0x00;
+  check_cause(&slave, &regs, JSD_WKC_CAUSE_NONE, 0);
+
+  check_dc();
+  jsd_t* jsd = jsd_alloc();
+  check_esc(jsd);
+
+  // The port talks to a virtual bus that loses every frame, so process data
+  // returns no frame and no register read is answered
+  jsd_vbus_t*      vbus = jsd_vbus_alloc();
+  jsd_vbus_fault_t drop = {0};
+  drop.type             = JSD_VBUS_FAULT_DROP_FRAME;
+  assert(jsd_vbus_inject_fault(vbus, drop));
+  assert(jsd_vbus_open(vbus, jsd->ecx_context.port));
+
+  MSG("Attributing a bad working counter of jsd_read");
+  *jsd->ecx_context.slavecount = 3;
+  setup_slave(&jsd->ecx_context.slavelist[1], true, true);
+  setup_slave(&jsd->ecx_context.slavelist[2], false, false);
+  setup_slave(&jsd->ecx_context.slavelist[3], true, false);
+  jsd->expected_wkc = 5;
+
+  jsd_wkc_report_t  report;
+  jsd_diag_config_t config  = {0};
+  config.esc_scan_period_ms = 10;
+  assert(jsd_diag_start(jsd, config));
+  assert(!jsd_diag_start(jsd, config));
+  assert(!jsd_diag_get_wkc_report(jsd, &report));
+
+  jsd_read(jsd, 0);
+  assert(wait_report(jsd, 1, &report));
+  assert(report.cycle == 1);
+  assert(report.wkc == EC_NOFRAME);
+  assert(report.expected_wkc == 5);
+  assert(report.num_slaves == 3);
+  assert(report.num_suspects == 2);
+  assert(report.attributed_wkc == 5);
+  assert(report.latency_nsec >= 0);
+  assert(report.slaves[1].cause == JSD_WKC_CAUSE_NO_RESPONSE);
+  assert(report.slaves[1].missing_wkc == 3);
+  assert(report.slaves[2].cause == JSD_WKC_CAUSE_NONE);
+  assert(report.slaves[2].expected_wkc == 0);
+  assert(report.slaves[3].missing_wkc == 2);
+  assert(jsd_get_slave_metrics(jsd, 1).wkc_misses == 1);
+  assert(jsd_get_slave_metrics(jsd, 2).wkc_misses == 0);
+
+  MSG("Rescanning a persistent loss only when it changes");
+  jsd_read(jsd, 0);
+  jsd_read(jsd, 0);
+  usleep(20000);
+  assert(jsd_get_bus_metrics(jsd).wkc_scans == 1);
+
+  jsd->ecx_context.slavelist[1].Obytes = 0;
+  jsd->ecx_context.slavelist[1].Ibytes = 0;
+  jsd->wkc                             = 3;
+  jsd_diag_check_wkc(jsd);
+  assert(wait_report(jsd, 2, &report));
+  assert(report.wkc == 3);
+  assert(report.num_suspects == 1);
+  assert(report.attributed_wkc == 2);
+  assert(strcmp(jsd_wkc_cause_to_string(report.slaves[3].cause),
+                "no response") == 0);
+
+  MSG("Scanning ESC error counters while the mailbox is idle");
+  jsd_link_segment_t segment;
+  int                wait;
+  for (wait = 0; wait < 1000; ++wait) {
+    if (jsd_diag_get_esc_errors(jsd, 3).failed_scans >= 2) {
+      break;
+    }
+    usleep(1000);
+  }
+  assert(jsd_diag_get_esc_errors(jsd, 1).failed_scans >= 2);
+  assert(jsd_diag_get_esc_errors(jsd, 3).failed_scans >= 2);
+  assert(jsd_diag_get_esc_errors(jsd, 3).scans == 0);
+  assert(!jsd_diag_get_degraded_link(jsd, &segment));
+
+  __atomic_store_n(&jsd->sdo_busy, true, __ATOMIC_RELAXED);
+  usleep(20000);
+  uint64_t failed_scans = jsd_diag_get_esc_errors(jsd, 2).failed_scans;
+  usleep(30000);
+  assert(jsd_diag_get_esc_errors(jsd, 2).failed_scans == failed_scans);
+  __atomic_store_n(&jsd->sdo_busy, false, __ATOMIC_RELAXED);
+
+  MSG("Sampling DC slaves only");
+  jsd->ecx_context.slavelist[3].hasdc = true;
+  uint64_t dc_samples                 = jsd_get_bus_metrics(jsd).dc_samples;
+  for (wait = 0; wait < 1000; ++wait) {
+    if (jsd_get_bus_metrics(jsd).dc_samples >= dc_samples + 2) {
+      break;
+    }
+    usleep(1000);
+  }
+  assert(jsd_diag_get_dc_quality(jsd, 3).failed_samples >= 1);
+  assert(jsd_diag_get_dc_quality(jsd, 3).samples == 0);
+  assert(jsd_diag_get_dc_quality(jsd, 1).failed_samples == 0);
+
+  MSG("Stopping the diagnostic thread with the context");
+  jsd_free(jsd);
+  jsd_vbus_free(vbus);
+
+  SUCCESS("jsd_diag checks passed");
+  return 0;
+}
@@ -0,0 +1,108 @@
+#include <assert.h>
+#include <string.h>
+
+#include "jsd/jsd_fields.h"
+#include "jsd/jsd_pub.h"
+
+static const jsd_field_t* find_field(const jsd_struct_desc_t* desc,
+                                     const char*              name) {
+  size_t f;
+  for (f = 0; f < desc->num_fields; ++f) {
+    if (strcmp(desc->fields[f].name, name) == 0) {
+      return &desc->fields[f];
+    }
+  }
+  return NULL;
+}
+
+static void check_layout(const jsd_struct_desc_t* desc,
+                         size_t                   container_size) {
+  assert(desc->container_offset + desc->size <= container_size);
+  assert((desc->fields == NULL) == (desc->num_fields == 0));
+
+  size_t end = 0;
+  size_t f;
+  for (f = 0; f < desc->num_fields; ++f) {
+    const jsd_field_t* field = &desc->fields[f];
+    assert(field->type < JSD_FIELD_NUM_TYPES);
+    assert(field->count > 0);
+    assert(field->units);
+
+    // Fields are in declaration order, no member was skipped but padding
+    assert(field->offset >= end);
+    assert(field->offset - end < 8);
+    end = field->offset + field->count * jsd_field_type_bytes(field->type);
+    assert(end <= desc->size);
+  }
+  if (desc->num_fields > 0) {
+    assert(desc->size - end < 8);
+  }
+}
+
+int main() {
+  size_t i;
+
+  MSG("Checking the layout of %zu state and %zu config descriptors",
+      jsd_fields_num_state_descs, jsd_fields_num_config_descs);
+  assert(jsd_fields_num_state_descs > 0);
+  for (i = 0; i < jsd_fields_num_state_descs; ++i) {
+    check_layout(&jsd_fields_state_descs[i], sizeof(jsd_slave_state_t));
+  }
+  for (i = 0; i < jsd_fields_num_config_descs; ++i) {
+    check_layout(&jsd_fields_config_descs[i], sizeof(jsd_slave_config_t));
+  }
+
+  MSG("Looking up descriptors by product code");
+  const jsd_struct_desc_t* epd =
+      jsd_fields_get_state_desc(JSD_EPD_PRODUCT_CODE);
+  assert(epd);
+  assert(strcmp(epd->name, "jsd_epd_state_t") == 0);
+  assert(epd->size == sizeof(jsd_epd_state_t));
+  assert(epd->container_offset == offsetof(jsd_slave_state_t, epd.pub));
+  assert(jsd_fields_get_state_desc(0x12345678) == NULL);
+  assert(jsd_fields_get_config_desc(0x12345678) == NULL);
+
+  const jsd_field_t* position = find_field(epd, "actual_position");
+  assert(position);
+  assert(position->type == JSD_FIELD_I32);
+  assert(position->offset == offsetof(jsd_epd_state_t, actual_position));
+  assert(position->count == 1);
+  assert(strcmp(position->units, "cnt") == 0);
+  assert(strcmp(find_field(epd, "actual_current")->units, "A") == 0);
+  assert(find_field(epd, "actual_state_machine_state")->type == JSD_FIELD_I32);
+
+  const jsd_struct_desc_t* epd_config =
+      jsd_fields_get_config_desc(JSD_EPD_PRODUCT_CODE);
+  assert(epd_config);
+  assert(epd_config->container_offset == offsetof(jsd_slave_config_t, epd));
+  assert(find_field(epd_config, "torque_slope"));
+
+  // The EL2124 has no configuration
+  const jsd_struct_desc_t* el2124_config =
+      jsd_fields_get_config_desc(JSD_EL2124_PRODUCT_CODE);
+  assert(el2124_config);
+  assert(el2124_config->num_fields == 0);
+
+  MSG("Reading values through the registry");
+  jsd_slave_state_t state;
+  memset(&state, 0, sizeof(state));
+  state.el3602.voltage[1]   = 4.5;
+  state.el3602.adc_value[0] = -1234;
+
+  const jsd_struct_desc_t* el3602 =
+      jsd_fields_get_state_desc(JSD_EL3602_PRODUCT_CODE);
+  assert(el3602);
+  const uint8_t* base = (const uint8_t*)&state + el3602->container_offset;
+  const jsd_field_t* voltage = find_field(el3602, "voltage");
+  assert(voltage->count == JSD_EL3602_NUM_CHANNELS);
+  assert(jsd_field_get_value(voltage, base, 0) == 0.0);
+  assert(jsd_field_get_value(voltage, base, 1) == 4.5);
+  assert(jsd_field_get_value(find_field(el3602, "adc_value"), base, 0) ==
+         -1234.0);
+
+  assert(jsd_field_type_bytes(JSD_FIELD_U16) == 2);
+  assert(jsd_field_type_bytes(JSD_FIELD_F64) == 8);
+
+  SUCCESS("jsd_fields checks passed");
+  return 0;
+}
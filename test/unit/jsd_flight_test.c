@@ -0,0 +1,209 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "jsd/jsd_flight.h"
+#include "jsd/jsd_memory.h"
+#include "jsd/jsd_metrics.h"
+#include "jsd/jsd_pub.h"
+
+#define PRE_CYCLES (10)
+#define POST_CYCLES (5)
+#define WINDOW (PRE_CYCLES + 1 + POST_CYCLES)
+
+static char directory[64];
+
+static void run_cycle(jsd_t* jsd, uint64_t cycle) {
+  memset(jsd->IOmap, (uint8_t)cycle, 16);
+  jsd->cycle_time.mono_nsec = 1000000 * (int64_t)cycle;
+  jsd_flight_record(jsd);
+}
+
+static void load(uint16_t slave_id, int sequence, jsd_flight_dump_t* dump) {
+  char path[128];
+  snprintf(path, sizeof(path), "%s/jsd_flight_%d_%d.bin", directory, slave_id,
+           sequence);
+  assert(jsd_flight_load_dump(path, dump));
+  assert(dump->header.slave_id == slave_id);
+  remove(path);
+}
+
+static void check_window(const jsd_flight_dump_t* dump, uint64_t trigger_cycle,
+                         uint16_t triggers) {
+  assert(dump->header.num_records == WINDOW);
+  assert(dump->header.trigger_record == PRE_CYCLES);
+  assert(dump->header.triggers == triggers);
+
+  uint32_t i;
+  for (i = 0; i < dump->header.num_records; ++i) {
+    const jsd_flight_record_t* record = jsd_flight_dump_get_record(dump, i);
+    uint64_t cycle = trigger_cycle - PRE_CYCLES + i;
+    assert(record->cycle == cycle);
+    assert(record->mono_nsec == 1000000 * (int64_t)cycle);
+    assert(record->al_state == EC_STATE_OPERATIONAL);
+    assert((record->triggers != 0) == (i == PRE_CYCLES));
+    if (dump->header.input_bytes > 0) {
+      assert(jsd_flight_dump_get_inputs(dump, i)[0] == (uint8_t)cycle);
+    }
+    assert(jsd_flight_dump_get_outputs(dump, i)[0] == (uint8_t)cycle);
+  }
+}
+
+static void add_slaves(jsd_t* jsd) {
+  // An EPD with 8 input and 4 output bytes, an EL2124 with 4 output bits
+  ec_slavet* slaves            = jsd->ecx_context.slavelist;
+  *jsd->ecx_context.slavecount = 2;
+  slaves[1].inputs             = (uint8_t*)&jsd->IOmap[0];
+  slaves[1].Ibytes             = 8;
+  slaves[1].outputs            = (uint8_t*)&jsd->IOmap[8];
+  slaves[1].Obytes             = 4;
+  slaves[2].outputs            = (uint8_t*)&jsd->IOmap[12];
+  slaves[2].Obits              = 4;
+  slaves[1].state              = EC_STATE_OPERATIONAL;
+  slaves[2].state              = EC_STATE_OPERATIONAL;
+  jsd->slave_configs[1].configuration_active = true;
+  jsd->slave_configs[1].product_code         = JSD_EPD_PRODUCT_CODE;
+  jsd->slave_configs[2].configuration_active = true;
+  jsd->slave_configs[2].product_code         = JSD_EL2124_PRODUCT_CODE;
+  jsd->expected_wkc                          = 3;
+  jsd->wkc                                   = 3;
+}
+
+int main() {
+  jsd_t* jsd = jsd_alloc();
+
+  snprintf(directory, sizeof(directory), "/tmp/jsd_flight_test_XXXXXX");
+  assert(mkdtemp(directory));
+
+  add_slaves(jsd);
+
+  jsd_epd_state_t* epd = &jsd->slave_states[1].epd.pub;
+  epd->actual_state_machine_state =
+      JSD_ELMO_STATE_MACHINE_STATE_OPERATION_ENABLED;
+
+  MSG("Rejecting a missing directory");
+  jsd_flight_config_t config = {0};
+  config.pre_cycles          = PRE_CYCLES;
+  config.post_cycles         = POST_CYCLES;
+  assert(!jsd_flight_start(jsd, "/tmp/jsd_flight_missing/dir", config));
+
+  assert(jsd_flight_start(jsd, directory, config));
+  assert(!jsd_flight_start(jsd, directory, config));
+
+  MSG("Dumping the windows around triggers");
+  uint64_t cycle;
+  for (cycle = 0; cycle < 100; ++cycle) {
+    if (cycle == 50) {
+      epd->actual_state_machine_state = JSD_ELMO_STATE_MACHINE_STATE_FAULT;
+    }
+    jsd->wkc = cycle == 70 ? 2 : 3;
+    if (cycle == 85) {
+      jsd_metrics_record_emcy(jsd, 1);
+    }
+    run_cycle(jsd, cycle);
+    usleep(1000);
+  }
+
+  // Gives the writer time to pick up the last window
+  jsd_flight_stats_t stats = jsd_flight_get_stats(jsd);
+  int                wait;
+  for (wait = 0; wait < 1000 && stats.dumps_written < 4; ++wait) {
+    usleep(1000);
+    stats = jsd_flight_get_stats(jsd);
+  }
+  assert(stats.triggers == 4);
+  assert(stats.dumps_written == 4);
+  assert(stats.dumps_dropped == 0);
+
+  MSG("Dropping a dump while the previous one is pending");
+  jsd_flight_trigger(jsd, 2);
+  for (; cycle < 100 + POST_CYCLES + 1; ++cycle) {
+    run_cycle(jsd, cycle);
+  }
+  jsd_flight_trigger(jsd, 2);
+  for (; cycle < 100 + 2 * (POST_CYCLES + 1); ++cycle) {
+    run_cycle(jsd, cycle);
+  }
+  jsd_flight_stop(jsd);
+
+  stats = jsd_flight_get_stats(jsd);
+  assert(stats.triggers == 6);
+  assert(stats.dumps_written + stats.dumps_dropped == 6);
+  assert(stats.write_failures == 0);
+  MSG("%lu dumps written, %lu dropped", (unsigned long)stats.dumps_written,
+      (unsigned long)stats.dumps_dropped);
+
+  MSG("Loading the dumps");
+  jsd_flight_dump_t dump;
+  load(1, 0, &dump);
+  assert(dump.header.product_code == JSD_EPD_PRODUCT_CODE);
+  assert(dump.header.input_bytes == 8);
+  assert(dump.header.output_bytes == 4);
+  check_window(&dump, 50, JSD_FLIGHT_TRIGGER_FAULT);
+  assert(jsd_flight_dump_get_record(&dump, PRE_CYCLES - 1)
+             ->state.epd.pub.actual_state_machine_state ==
+         JSD_ELMO_STATE_MACHINE_STATE_OPERATION_ENABLED);
+  assert(jsd_flight_dump_get_record(&dump, PRE_CYCLES)
+             ->state.epd.pub.actual_state_machine_state ==
+         JSD_ELMO_STATE_MACHINE_STATE_FAULT);
+  jsd_flight_free_dump(&dump);
+
+  load(1, 1, &dump);
+  check_window(&dump, 70, JSD_FLIGHT_TRIGGER_BAD_WKC);
+  assert(jsd_flight_dump_get_record(&dump, PRE_CYCLES)->wkc == 2);
+  jsd_flight_free_dump(&dump);
+
+  load(2, 2, &dump);
+  assert(dump.header.input_bytes == 0);
+  assert(dump.header.output_bytes == 1);
+  check_window(&dump, 70, JSD_FLIGHT_TRIGGER_BAD_WKC);
+  jsd_flight_free_dump(&dump);
+
+  // The history restarts empty after the bad WKC window
+  load(1, 3, &dump);
+  assert(dump.header.num_records == 90 - 75);
+  assert(dump.header.trigger_record == 85 - 76);
+  assert(dump.header.triggers == JSD_FLIGHT_TRIGGER_EMCY);
+  jsd_flight_free_dump(&dump);
+
+  load(2, 4, &dump);
+  assert(dump.header.triggers == JSD_FLIGHT_TRIGGER_MANUAL);
+  assert(jsd_flight_dump_get_record(&dump, dump.header.trigger_record)->cycle ==
+         100);
+  jsd_flight_free_dump(&dump);
+
+  MSG("Rejecting other files");
+  assert(!jsd_flight_load_dump("/dev/null", &dump));
+
+  MSG("Stopping the flight recorder with the context");
+  config.triggers = JSD_FLIGHT_TRIGGER_MANUAL;
+  assert(jsd_flight_start(jsd, directory, config));
+  jsd_free(jsd);
+
+  MSG("Recording a real-time context without the heap");
+  jsd = jsd_alloc_rt((jsd_memory_config_t){0});
+  assert(jsd);
+  add_slaves(jsd);
+  config.triggers = 0;
+  jsd_memory_forbid_malloc(true);
+  assert(jsd_flight_start(jsd, directory, config));
+  assert(jsd->flight.ring_arena.base);
+  for (cycle = 0; cycle < 2 * WINDOW; ++cycle) {
+    run_cycle(jsd, cycle);
+  }
+  jsd_flight_stop(jsd);
+  jsd_memory_forbid_malloc(false);
+  assert(jsd_flight_get_stats(jsd).dumps_written == 0);
+  assert(!jsd->flight.ring_arena.base);
+  jsd_free(jsd);
+
+  char path[128];
+  snprintf(path, sizeof(path), "%s/jsd_flight_2_5.bin", directory);
+  remove(path);
+  assert(rmdir(directory) == 0);
+
+  SUCCESS("jsd_flight checks passed");
+  return 0;
+}
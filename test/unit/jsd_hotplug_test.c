@@ -0,0 +1,162 @@
+#include <assert.h>
+#include <stdio.h>
+#include <unistd.h>
+
+#include "jsd/jsd_el3602.h"
+#include "jsd/jsd_el4102_pub.h"
+#include "jsd/jsd_hotplug_pub.h"
+#include "jsd/jsd_pub.h"
+#include "jsd/jsd_sdo_pub.h"
+#include "jsd/jsd_vbus_pub.h"
+
+// Room for the 4 output bytes of an EL4102 and some left over
+#define TEST_RESERVED_OBYTES (8)
+#define TEST_MAX_CYCLES (10000)
+
+static uint32_t sdo_requests  = 0;
+static uint32_t sdo_responses = 0;
+
+static void cycle(jsd_t* jsd) {
+  jsd_write(jsd);
+  jsd_read(jsd, EC_TIMEOUTRET);
+}
+
+// The SDO thread shares the mailbox state the hot-plug thread configures with
+static void check_sdo_responses(jsd_t* jsd) {
+  jsd_sdo_req_t response;
+  while (jsd_sdo_pop_response_queue(jsd, &response)) {
+    assert(response.success);
+    assert(response.data.as_u16 == JSD_EL3602_RANGE_10V);
+    ++sdo_responses;
+  }
+}
+
+// Cycles the bus like an application until the hot-plug thread reports, with
+// SDO reads of the first slave in flight
+static bool cycle_until_event(jsd_t* jsd, jsd_hotplug_event_type_t type,
+                              uint16_t slave_id, jsd_hotplug_event_t* event) {
+  int i;
+  for (i = 0; i < TEST_MAX_CYCLES; ++i) {
+    if (sdo_requests == sdo_responses &&
+        jsd_sdo_get_param_async(jsd, 1, 0x8000, 0x19, JSD_SDO_DATA_U16, 0)) {
+      ++sdo_requests;
+    }
+    cycle(jsd);
+    check_sdo_responses(jsd);
+    if (jsd_hotplug_get_last_event(jsd, event) && event->type == type &&
+        event->slave_id == slave_id) {
+      return true;
+    }
+    usleep(1000);
+  }
+  return false;
+}
+
+static jsd_slave_config_t el3602_config(const char* name) {
+  jsd_slave_config_t config = {0};
+  snprintf(config.name, JSD_NAME_LEN, "%s", name);
+  config.configuration_active = true;
+  config.product_code         = JSD_EL3602_PRODUCT_CODE;
+  for (int ch = 0; ch < JSD_EL3602_NUM_CHANNELS; ++ch) {
+    config.el3602.range[ch]  = JSD_EL3602_RANGE_10V;
+    config.el3602.filter[ch] = JSD_BECKHOFF_FILTER_30000HZ;
+  }
+  return config;
+}
+
+int main() {
+  jsd_vbus_t* vbus = jsd_vbus_alloc();
+  assert(jsd_vbus_add_slave(vbus, JSD_EL3602_PRODUCT_CODE) == 1);
+
+  jsd_t* jsd = jsd_alloc();
+  jsd_vbus_attach(vbus, jsd);
+  jsd_set_slave_config(jsd, 1, el3602_config("analog"));
+
+  // Expected at the end of the line once the bus runs
+  jsd_slave_config_t spare = {0};
+  snprintf(spare.name, JSD_NAME_LEN, "spare");
+  spare.configuration_active = true;
+  spare.product_code         = JSD_EL4102_PRODUCT_CODE;
+  jsd_set_slave_config(jsd, 2, spare);
+  jsd_set_slave_config(jsd, 3, el3602_config("late analog"));
+
+  jsd_hotplug_reserve_outputs(jsd, TEST_RESERVED_OBYTES);
+  assert(jsd_init(jsd, "jsd_hotplug_test", 0));
+  assert(jsd->expected_wkc == 1);
+
+  jsd_el3602_handle_t analog;
+  assert(jsd_el3602_get_handle(jsd, 1, &analog));
+  uint8_t* analog_inputs = analog.dev.inputs;
+  assert(analog_inputs == jsd->ecx_context.slavelist[1].inputs);
+
+  jsd_el3602_txpdo_t txpdo = {0};
+  txpdo.channel[0].value   = 0x100000;
+  jsd_vbus_write_txpdo(vbus, 1, &txpdo, sizeof(txpdo));
+  cycle(jsd);
+  assert(jsd->wkc == jsd->expected_wkc);
+  jsd_el3602_handle_read(&analog);
+  assert(jsd_el3602_handle_get_state(&analog)->adc_value[0] == 0x100000);
+
+  jsd_hotplug_config_t config = {.check_period_ms = 10};
+  assert(jsd_hotplug_start(jsd, config));
+
+  MSG("Plugging an EL4102 into the cycling bus");
+  assert(jsd_vbus_add_slave(vbus, JSD_EL4102_PRODUCT_CODE) == 2);
+  jsd_hotplug_event_t event;
+  assert(cycle_until_event(jsd, JSD_HOTPLUG_EVENT_OPERATIONAL, 2, &event));
+  assert(event.eep_id == JSD_EL4102_PRODUCT_CODE);
+  assert(*jsd->ecx_context.slavecount == 2);
+  assert(jsd_vbus_get_slave_state(vbus, 2) == EC_STATE_OPERATIONAL);
+
+  // Outputs and working counter of the new slave are part of the frame
+  assert(jsd->expected_wkc == 1 + 2);
+  jsd_el4102_write_single_channel(jsd, 2, 0, 5.0);
+  jsd_el4102_process(jsd, 2);
+  cycle(jsd);
+  assert(jsd->wkc == jsd->expected_wkc);
+  int16_t outputs[JSD_EL4102_NUM_CHANNELS] = {0};
+  jsd_vbus_read_rxpdo(vbus, 2, outputs, sizeof(outputs));
+  assert(outputs[0] == 0x3FFF);
+
+  // The inputs of the first slave did not move under its handle
+  assert(jsd->ecx_context.slavelist[1].inputs == analog_inputs);
+  txpdo.channel[0].value = 0x200000;
+  jsd_vbus_write_txpdo(vbus, 1, &txpdo, sizeof(txpdo));
+  cycle(jsd);
+  jsd_el3602_handle_read(&analog);
+  assert(jsd_el3602_handle_get_state(&analog)->adc_value[0] == 0x200000);
+
+  MSG("Plugging an EL3602 behind it, inputs follow the image");
+  assert(jsd_vbus_add_slave(vbus, JSD_EL3602_PRODUCT_CODE) == 3);
+  assert(cycle_until_event(jsd, JSD_HOTPLUG_EVENT_OPERATIONAL, 3, &event));
+  assert(jsd->expected_wkc == 1 + 2 + 1);
+  assert(jsd->ecx_context.slavelist[1].inputs == analog_inputs);
+
+  txpdo.channel[1].value = 0x300000;
+  jsd_vbus_write_txpdo(vbus, 3, &txpdo, sizeof(txpdo));
+  cycle(jsd);
+  assert(jsd->wkc == jsd->expected_wkc);
+  jsd_el3602_read(jsd, 3);
+  assert(jsd_el3602_get_state(jsd, 3)->adc_value[1] == 0x300000);
+  jsd_el3602_handle_read(&analog);
+  assert(jsd_el3602_handle_get_state(&analog)->adc_value[0] == 0x200000);
+
+  for (int i = 0; i < TEST_MAX_CYCLES && sdo_responses < sdo_requests; ++i) {
+    cycle(jsd);
+    check_sdo_responses(jsd);
+    usleep(1000);
+  }
+  assert(sdo_requests > 0);
+  assert(sdo_responses == sdo_requests);
+
+  jsd_hotplug_stats_t stats = jsd_hotplug_get_stats(jsd);
+  assert(stats.events[JSD_HOTPLUG_EVENT_ADDED] == 2);
+  assert(stats.events[JSD_HOTPLUG_EVENT_OPERATIONAL] == 2);
+  assert(stats.events[JSD_HOTPLUG_EVENT_FAILED] == 0);
+
+  jsd_free(jsd);
+  jsd_vbus_free(vbus);
+
+  SUCCESS("jsd_hotplug checks passed");
+  return 0;
+}
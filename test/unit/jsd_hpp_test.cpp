@@ -0,0 +1,103 @@
+#include <assert.h>
+
+#include <utility>
+
+#include "jsd/jsd.hpp"
+#include "jsd/jsd_ati_fts.h"
+#include "jsd/jsd_el3104.h"
+#include "jsd/jsd_el3162.h"
+#include "jsd/jsd_el3202.h"
+#include "jsd/jsd_el3208.h"
+#include "jsd/jsd_el3318.h"
+#include "jsd/jsd_el3356.h"
+#include "jsd/jsd_el3602.h"
+#include "jsd/jsd_el4102.h"
+#include "jsd/jsd_ild1900.h"
+#include "jsd/jsd_jed0101.h"
+#include "jsd/jsd_jed0200.h"
+
+// jsd.hpp spells out the PDO sizes of drivers with private PDO structs
+#define CHECK_PDO_BYTES(CODE, RX_BYTES, TX_BYTES)                   \
+  static_assert(jsd::DeviceTraits<CODE>::rx_bytes == (RX_BYTES) &&  \
+                    jsd::DeviceTraits<CODE>::tx_bytes == (TX_BYTES), \
+                #CODE " PDO sizes")
+
+CHECK_PDO_BYTES(JSD_EL3602_PRODUCT_CODE, 0, sizeof(jsd_el3602_txpdo_t));
+CHECK_PDO_BYTES(JSD_EL3208_PRODUCT_CODE, 0, sizeof(jsd_el3208_txpdo_t));
+CHECK_PDO_BYTES(JSD_EL2124_PRODUCT_CODE, 0, 0);
+CHECK_PDO_BYTES(JSD_EGD_PRODUCT_CODE, 0, sizeof(jsd_egd_txpdo_data_t));
+CHECK_PDO_BYTES(JSD_EL3356_PRODUCT_CODE, sizeof(jsd_el3356_rxpdo_t),
+                sizeof(jsd_el3356_txpdo_t));
+CHECK_PDO_BYTES(JSD_JED0101_PRODUCT_CODE, sizeof(jsd_jed0101_rxpdo_t),
+                sizeof(jsd_jed0101_txpdo_t));
+CHECK_PDO_BYTES(JSD_JED0200_PRODUCT_CODE, sizeof(jsd_jed0200_rxpdo_t),
+                sizeof(jsd_jed0200_txpdo_t));
+CHECK_PDO_BYTES(JSD_ATI_FTS_PRODUCT_CODE, sizeof(jsd_ati_fts_rxpdo_t),
+                sizeof(jsd_ati_fts_txpdo_t));
+CHECK_PDO_BYTES(JSD_EL3104_PRODUCT_CODE, 0, sizeof(jsd_el3104_txpdo_t));
+CHECK_PDO_BYTES(JSD_EL3202_PRODUCT_CODE, 0, sizeof(jsd_el3202_txpdo_t));
+CHECK_PDO_BYTES(JSD_EL3318_PRODUCT_CODE, 0, sizeof(jsd_el3318_txpdo_t));
+CHECK_PDO_BYTES(JSD_EL3162_PRODUCT_CODE, 0, sizeof(jsd_el3162_txpdo_t));
+CHECK_PDO_BYTES(JSD_EL4102_PRODUCT_CODE, sizeof(jsd_el4102_rxpdo_t), 0);
+CHECK_PDO_BYTES(JSD_ILD1900_PRODUCT_CODE, 0, sizeof(jsd_ild1900_txpdo_t));
+CHECK_PDO_BYTES(JSD_EPD_PRODUCT_CODE, sizeof(jsd_epd_rxpdo_data_t),
+                sizeof(jsd_epd_txpdo_data_t));
+static_assert(!jsd::DeviceTraits<0x12345678>::supported,
+              "unknown product codes are rejected");
+
+constexpr jsd_elmo_motion_command_csp_t kCsp = jsd::elmo::csp(1000, 5);
+static_assert(kCsp.target_position == 1000 && kCsp.position_offset == 5 &&
+                  kCsp.velocity_offset == 0,
+              "constexpr command");
+
+int main() {
+  jsd::Bus bus;
+  assert(bus);
+
+  MSG("Devices must not bind before jsd_init()");
+  jsd::El2124Outputs el2124;
+  assert(!el2124.bind(bus, 1));
+  assert(!el2124.bound());
+
+  // Pretend slave 1 is a configured EL2124 and slave 2 an EL3602 with a
+  // truncated input image
+  jsd_t* jsd                                 = bus.get();
+  jsd->init_complete                         = true;
+  *jsd->ecx_context.slavecount               = 2;
+  jsd->ecx_context.slavelist[1].eep_id       = JSD_EL2124_PRODUCT_CODE;
+  jsd->ecx_context.slavelist[1].outputs      = (uint8_t*)jsd->IOmap;
+  jsd->ecx_context.slavelist[1].Obytes       = 1;
+  jsd->slave_configs[1].configuration_active = true;
+  jsd->slave_configs[1].product_code         = JSD_EL2124_PRODUCT_CODE;
+  jsd->ecx_context.slavelist[2].eep_id       = JSD_EL3602_PRODUCT_CODE;
+  jsd->ecx_context.slavelist[2].inputs       = (uint8_t*)jsd->IOmap + 8;
+  jsd->ecx_context.slavelist[2].Ibytes       = 2;
+  jsd->slave_configs[2].configuration_active = true;
+  jsd->slave_configs[2].product_code         = JSD_EL3602_PRODUCT_CODE;
+
+  MSG("Checking bind validation");
+  jsd::El3602 el3602;
+  assert(!el3602.bind(bus, 1));  // wrong product code
+  assert(!el3602.bind(bus, 2));  // PDO image too small
+  jsd->ecx_context.slavelist[2].Ibytes = sizeof(jsd_el3602_txpdo_t);
+  assert(el3602.bind(bus, 2));
+  assert(el2124.bind(bus, 1));
+
+  MSG("Checking typed access");
+  el2124.write(0, true);
+  el2124.write(2, true);
+  el2124.process();
+  assert((uint8_t)jsd->IOmap[0] == 0x05);
+  assert(&el2124.state() == jsd_el2124_get_state(jsd, 1));
+  assert(&el3602.state() == jsd_el3602_get_state(jsd, 2));
+
+  MSG("Checking Bus ownership moves");
+  jsd::Bus moved(std::move(bus));
+  assert(!bus);
+  assert(moved.get() == jsd);
+
+  jsd->init_complete = false;
+
+  SUCCESS("jsd C++ wrapper checks passed");
+  return 0;
+}
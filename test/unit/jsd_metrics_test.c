@@ -0,0 +1,174 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "jsd/jsd_memory.h"
+#include "jsd/jsd_metrics.h"
+#include "jsd/jsd_pub.h"
+
+static char* write_prometheus(jsd_t* jsd) {
+  static char text[1 << 16];
+  FILE*       file = tmpfile();
+  assert(file);
+  jsd_metrics_write_prometheus(jsd, file);
+  rewind(file);
+  size_t bytes = fread(text, 1, sizeof(text) - 1, file);
+  text[bytes]  = '\0';
+  fclose(file);
+  return text;
+}
+
+static char* scrape(const char* path, const char* request) {
+  static char response[1 << 16];
+  int         fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  assert(fd >= 0);
+
+  struct sockaddr_un addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  strcpy(addr.sun_path, path);
+  assert(connect(fd, (struct sockaddr*)&addr, sizeof(addr)) == 0);
+  if (request) {
+    assert(send(fd, request, strlen(request), 0) == (ssize_t)strlen(request));
+  }
+
+  size_t  bytes = 0;
+  ssize_t received;
+  while ((received = recv(fd, response + bytes, sizeof(response) - 1 - bytes,
+                          0)) > 0) {
+    bytes += received;
+  }
+  response[bytes] = '\0';
+  close(fd);
+  return response;
+}
+
+int main() {
+  jsd_t* jsd = jsd_alloc();
+
+  *jsd->ecx_context.slavecount        = 2;
+  jsd->ecx_context.slavelist[1].state = EC_STATE_OPERATIONAL;
+  jsd->ecx_context.slavelist[2].state = EC_STATE_OPERATIONAL;
+  jsd->wkc                            = 3;
+  jsd->expected_wkc                   = 3;
+
+  MSG("Finding the JSD context of a SOEM context");
+  assert(jsd_metrics_get_context(&jsd->ecx_context) == jsd);
+  ecx_contextt foreign;
+  memset(&foreign, 0, sizeof(foreign));
+  assert(jsd_metrics_get_context(&foreign) == NULL);
+  foreign.userdata = &jsd->slave_configs;
+  assert(jsd_metrics_get_context(&foreign) == NULL);
+
+  MSG("Recording SDO transfers");
+  jsd_metrics_record_sdo(jsd, 1, true, 100000);     // 100 us
+  jsd_metrics_record_sdo(jsd, 1, true, 3000000);    // 3 ms
+  jsd_metrics_record_sdo(jsd, 2, false, 900000000);  // 900 ms
+
+  jsd_bus_metrics_t bus = jsd_get_bus_metrics(jsd);
+  assert(bus.sdo_requests == 3);
+  assert(bus.sdo_failures == 1);
+  assert(bus.sdo_latency.count == 3);
+  assert(bus.sdo_latency.sum_usec == 100 + 3000 + 900000);
+  assert(bus.sdo_latency.buckets[0] == 1);
+  assert(bus.sdo_latency.buckets[4] == 1);
+  assert(bus.sdo_latency.buckets[JSD_METRICS_LATENCY_BUCKETS - 1] == 1);
+
+  jsd_slave_metrics_t slave = jsd_get_slave_metrics(jsd, 2);
+  assert(slave.sdo_requests == 1);
+  assert(slave.sdo_failures == 1);
+  assert(slave.sdo_latency.count == 1);
+
+  MSG("Recording recovery events and emergencies");
+  jsd_metrics_record_recovery(jsd, 2, JSD_RECOVERY_EVENT_LOST);
+  jsd_metrics_record_recovery(jsd, 2, JSD_RECOVERY_EVENT_RECOVERED);
+  jsd_metrics_record_recovery(jsd, 1, JSD_RECOVERY_EVENT_REQUEST_OP);
+  jsd_metrics_record_emcy(jsd, 1);
+  jsd_metrics_record_emcy(jsd, EC_MAXSLAVE);  // ignored
+
+  bus = jsd_get_bus_metrics(jsd);
+  assert(bus.recovery_events[JSD_RECOVERY_EVENT_LOST] == 1);
+  assert(bus.recovery_events[JSD_RECOVERY_EVENT_RECOVERED] == 1);
+  assert(bus.recovery_events[JSD_RECOVERY_EVENT_REQUEST_OP] == 1);
+  assert(bus.emcy_count == 1);
+  slave = jsd_get_slave_metrics(jsd, 2);
+  assert(slave.recovery_events[JSD_RECOVERY_EVENT_LOST] == 1);
+  assert(slave.recovery_events[JSD_RECOVERY_EVENT_REQUEST_OP] == 0);
+  assert(jsd_get_slave_metrics(jsd, 1).emcy_count == 1);
+
+  MSG("Counting AL state changes");
+  jsd_metrics_update_states(jsd, false);
+  assert(jsd_get_bus_metrics(jsd).state_transitions == 0);
+  assert(jsd_get_slave_metrics(jsd, 1).al_state == EC_STATE_OPERATIONAL);
+
+  jsd->ecx_context.slavelist[2].state = EC_STATE_SAFE_OP + EC_STATE_ERROR;
+  jsd_metrics_update_states(jsd, true);
+  jsd_metrics_update_states(jsd, true);
+  jsd->ecx_context.slavelist[2].state = EC_STATE_OPERATIONAL;
+  jsd_metrics_update_states(jsd, true);
+  assert(jsd_get_bus_metrics(jsd).state_transitions == 2);
+  assert(jsd_get_slave_metrics(jsd, 1).state_transitions == 0);
+  assert(jsd_get_slave_metrics(jsd, 2).state_transitions == 2);
+
+  MSG("Tracking queue high water marks");
+  jsd_metrics_high_water(&jsd->metrics.bus.sdo_request_queue_high_water, 5);
+  jsd_metrics_high_water(&jsd->metrics.bus.sdo_request_queue_high_water, 2);
+  assert(jsd_get_bus_metrics(jsd).sdo_request_queue_high_water == 5);
+
+  MSG("Writing the Prometheus text format");
+  char* text = write_prometheus(jsd);
+  assert(strstr(text, "# TYPE jsd_cycles_total counter\n"));
+  assert(strstr(text, "\njsd_wkc 3\n"));
+  assert(strstr(text, "\njsd_sdo_requests_total 3\n"));
+  assert(strstr(text, "\njsd_sdo_latency_seconds_bucket{le=\"0.00025\"} 1\n"));
+  assert(strstr(text, "\njsd_sdo_latency_seconds_bucket{le=\"0.005\"} 2\n"));
+  assert(strstr(text, "\njsd_sdo_latency_seconds_bucket{le=\"+Inf\"} 3\n"));
+  assert(strstr(text, "\njsd_sdo_latency_seconds_count 3\n"));
+  assert(strstr(text, "\njsd_recovery_events_total{event=\"lost\"} 1\n"));
+  assert(strstr(text, "\njsd_queue_high_water{queue=\"sdo_request\"} 5\n"));
+  assert(strstr(text, "\njsd_slave_al_state{slave=\"2\"} 8\n"));
+  assert(strstr(text, "\njsd_slave_state_transitions_total{slave=\"2\"} 2\n"));
+  assert(strstr(text,
+                "\njsd_slave_sdo_latency_seconds_count{slave=\"1\"} 2\n"));
+  assert(!strstr(text, "slave=\"3\""));
+
+  MSG("Serving the metrics on a Unix socket");
+  char path[64];
+  snprintf(path, sizeof(path), "/tmp/jsd_metrics_test_%d.sock", (int)getpid());
+  // A setup call that may follow jsd_init(...) of a real-time context
+  jsd_memory_forbid_malloc(true);
+  assert(jsd_metrics_export_start(jsd, path));
+  jsd_memory_forbid_malloc(false);
+  assert(!jsd_metrics_export_start(jsd, path));
+
+  char* plain = scrape(path, NULL);
+  assert(strncmp(plain, "# HELP jsd_cycles_total ", 24) == 0);
+  assert(strstr(plain, "\njsd_sdo_requests_total 3\n"));
+
+  char* http = scrape(path, "GET /metrics HTTP/1.0\r\n\r\n");
+  assert(strncmp(http, "HTTP/1.0 200 OK\r\n", 17) == 0);
+  assert(strstr(http, "\r\n\r\n# HELP jsd_cycles_total "));
+
+  jsd_metrics_export_stop(jsd);
+  assert(access(path, F_OK) != 0);
+
+  MSG("Refusing to replace a file that is not a socket");
+  FILE* file = fopen(path, "w");
+  assert(file);
+  fclose(file);
+  assert(!jsd_metrics_export_start(jsd, path));
+  assert(access(path, F_OK) == 0);
+  unlink(path);
+
+  MSG("Stopping the exporter with the context");
+  assert(jsd_metrics_export_start(jsd, path));
+  jsd_free(jsd);
+  assert(access(path, F_OK) != 0);
+
+  SUCCESS("jsd_metrics checks passed");
+  return 0;
+}
@@ -0,0 +1,187 @@
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "jsd/jsd_el3602_pub.h"
+#include "jsd/jsd_metrics_pub.h"
+#include "jsd/jsd_pub.h"
+#include "jsd/jsd_reconfig.h"
+#include "jsd/jsd_sdo.h"
+#include "jsd/jsd_vbus.h"
+
+static int hook_calls = 0;
+
+static int count_hook(ecx_contextt* ecx_context, uint16_t slave_id) {
+  (void)ecx_context;
+  (void)slave_id;
+  ++hook_calls;
+  return 1;
+}
+
+// Ranges of the EL3602 channels
+#define TEST_EL3602_RANGE_CH1 (0x8000)
+#define TEST_EL3602_RANGE_CH2 (0x8010)
+#define TEST_EL3602_RANGE_SUBINDEX (0x19)
+
+static void check_paths_over_vbus() {
+  jsd_vbus_t* vbus = jsd_vbus_alloc();
+  assert(jsd_vbus_add_slave(vbus, JSD_EL3602_PRODUCT_CODE) == 1);
+
+  jsd_t* jsd = jsd_alloc();
+  jsd_vbus_attach(vbus, jsd);
+
+  jsd_slave_config_t config = {0};
+  snprintf(config.name, JSD_NAME_LEN, "analog");
+  config.configuration_active = true;
+  config.product_code         = JSD_EL3602_PRODUCT_CODE;
+  for (int ch = 0; ch < JSD_EL3602_NUM_CHANNELS; ++ch) {
+    config.el3602.range[ch]  = JSD_EL3602_RANGE_10V;
+    config.el3602.filter[ch] = JSD_BECKHOFF_FILTER_30000HZ;
+  }
+  jsd_set_slave_config(jsd, 1, config);
+  assert(jsd_init(jsd, "jsd_reconfig_test", 0));
+  assert(jsd->ecx_context.slavelist[1].PO2SOconfigx == jsd_reconfig_PO2SO);
+
+  // The factory reset never reads back what was written
+  uint16_t i;
+  for (i = 0; i < jsd->reconfig.num_writes; ++i) {
+    assert(jsd->reconfig.writes[i].index != JSD_BECKHOFF_RESET_SDO);
+  }
+
+  MSG("Verifying a slave whose objects kept their values");
+  uint64_t downloads = jsd_vbus_get_sdo_downloads(vbus, 1);
+  assert(jsd_reconfig_slave(jsd, 1, EC_TIMEOUTRET3) == EC_STATE_SAFE_OP);
+  jsd_reconfig_stats_t stats = jsd_reconfig_get_stats(jsd, 1);
+  assert(stats.last_path == JSD_RECONFIG_PATH_VERIFIED);
+  assert(stats.last_reads == jsd->reconfig.num_writes);
+  assert(stats.last_writes == 0);
+  assert(jsd_vbus_get_sdo_downloads(vbus, 1) == downloads);
+
+  MSG("Writing only the index that lost its value");
+  uint16_t range, lost_range = 0xFFFF;
+  assert(jsd_vbus_get_sdo(vbus, 1, TEST_EL3602_RANGE_CH2,
+                          TEST_EL3602_RANGE_SUBINDEX, &range, sizeof(range)));
+  assert(jsd_vbus_set_sdo(vbus, 1, TEST_EL3602_RANGE_CH2,
+                          TEST_EL3602_RANGE_SUBINDEX, &lost_range,
+                          sizeof(lost_range)));
+  uint16_t num_writes = 0;
+  for (i = 0; i < jsd->reconfig.num_writes; ++i) {
+    num_writes += jsd->reconfig.writes[i].index == TEST_EL3602_RANGE_CH2;
+  }
+  assert(num_writes > 0 && num_writes < jsd->reconfig.num_writes);
+
+  assert(jsd_reconfig_slave(jsd, 1, EC_TIMEOUTRET3) == EC_STATE_SAFE_OP);
+  stats = jsd_reconfig_get_stats(jsd, 1);
+  assert(stats.last_path == JSD_RECONFIG_PATH_REAPPLIED);
+  assert(stats.last_writes == num_writes);
+  assert(jsd_vbus_get_sdo_downloads(vbus, 1) == downloads + num_writes);
+  uint16_t restored = 0;
+  assert(jsd_vbus_get_sdo(vbus, 1, TEST_EL3602_RANGE_CH2,
+                          TEST_EL3602_RANGE_SUBINDEX, &restored,
+                          sizeof(restored)));
+  assert(restored == range);
+  assert(jsd_vbus_get_sdo(vbus, 1, TEST_EL3602_RANGE_CH1,
+                          TEST_EL3602_RANGE_SUBINDEX, &restored,
+                          sizeof(restored)));
+  assert(restored == range);
+
+  jsd_free(jsd);
+  jsd_vbus_free(vbus);
+}
+
+int main() {
+  jsd_t*     jsd    = jsd_alloc();
+  ec_slavet* slaves = jsd->ecx_context.slavelist;
+
+  // The port talks to a virtual bus that loses every frame, no SDO is answered
+  jsd_vbus_t*      vbus = jsd_vbus_alloc();
+  jsd_vbus_fault_t drop = {0};
+  drop.type             = JSD_VBUS_FAULT_DROP_FRAME;
+  assert(jsd_vbus_inject_fault(vbus, drop));
+  assert(jsd_vbus_open(vbus, jsd->ecx_context.port));
+
+  *jsd->ecx_context.slavecount = 3;
+  uint16_t slave_id;
+  for (slave_id = 1; slave_id <= 3; ++slave_id) {
+    slaves[slave_id].PO2SOconfigx                     = count_hook;
+    slaves[slave_id].mbx_l                            = 128;
+    jsd->slave_configs[slave_id].configuration_active = true;
+    jsd->slave_configs[slave_id].PO2SO_success        = true;
+  }
+
+  MSG("Remembering the writes of the PO2SO hooks");
+  uint16_t assign[]   = {0x0002, 0x1602, 0x1603};
+  uint8_t  mode       = 8;
+  uint8_t  disable    = 0;
+  uint8_t  large[128] = {0};
+  jsd_reconfig_record_write(jsd, 1, 0x6060, 0, false, JSD_SDO_DATA_U8, 1,
+                            &mode);
+  assert(jsd->reconfig.num_writes == 0);
+
+  jsd_reconfig_begin(jsd);
+  jsd_reconfig_record_write(jsd, 1, 0x1C12, 0, true, JSD_SDO_DATA_UNSPECIFIED,
+                            sizeof(assign), assign);
+  jsd_reconfig_record_write(jsd, 1, 0x6060, 0, false, JSD_SDO_DATA_U8, 1,
+                            &disable);
+  jsd_reconfig_record_write(jsd, 1, 0x6060, 0, false, JSD_SDO_DATA_U8, 1,
+                            &mode);
+  jsd_reconfig_record_write(jsd, 2, 0x1C13, 0, true, JSD_SDO_DATA_UNSPECIFIED,
+                            sizeof(large), large);
+  assert(jsd->reconfig.num_writes == 3);
+  assert(jsd->reconfig.incomplete[2]);
+  assert(memcmp(jsd->reconfig.writes[0].data, assign, sizeof(assign)) == 0);
+
+  // Failed writes are not remembered
+  assert(!jsd_sdo_set_param_blocking(&jsd->ecx_context, 3, 0x6060, 0,
+                                     JSD_SDO_DATA_U8, &mode));
+  assert(jsd->reconfig.num_writes == 3);
+
+  MSG("Installing the fast hook on slaves with remembered writes");
+  jsd_reconfig_end(jsd);
+  assert(!jsd->reconfig.recording);
+  assert(slaves[1].PO2SOconfigx == jsd_reconfig_PO2SO);
+  assert(jsd->reconfig.full_hooks[1] == count_hook);
+  assert(slaves[2].PO2SOconfigx == count_hook);
+  assert(slaves[3].PO2SOconfigx == count_hook);
+
+  MSG("Running the full hook when objects cannot be written again");
+  assert(jsd_reconfig_PO2SO(&jsd->ecx_context, 1) == 1);
+  assert(hook_calls == 1);
+  assert(jsd->reconfig.paths[1] == JSD_RECONFIG_PATH_FULL);
+  assert(jsd->reconfig.reads[1] == 2);  // 0x6060 is read back once
+  assert(jsd->reconfig.rewrites[1] == 1);
+
+  MSG("Timing the reconfiguration of a slave");
+  assert(!jsd_reconfig_slave(jsd, 1, EC_TIMEOUTRET));
+  jsd_reconfig_stats_t stats = jsd_reconfig_get_stats(jsd, 1);
+  assert(stats.reconfigs[JSD_RECONFIG_PATH_FAILED] == 1);
+  assert(stats.last_path == JSD_RECONFIG_PATH_FAILED);
+  assert(stats.last_duration_nsec >= 0);
+  assert(stats.max_duration_nsec == stats.last_duration_nsec);
+  assert(jsd_get_bus_metrics(jsd).reconfig_latency.count == 1);
+  assert(jsd_reconfig_get_stats(jsd, 2).last_path == JSD_RECONFIG_PATH_NONE);
+
+  MSG("Keeping the hooks of the devices when disabled");
+  slaves[1].PO2SOconfigx = count_hook;
+  jsd_reconfig_enable(jsd, false);
+  jsd_reconfig_begin(jsd);
+  jsd_reconfig_record_write(jsd, 1, 0x6060, 0, false, JSD_SDO_DATA_U8, 1,
+                            &mode);
+  jsd_reconfig_end(jsd);
+  assert(slaves[1].PO2SOconfigx == count_hook);
+  assert(jsd_reconfig_get_stats(jsd, 1).reconfigs[JSD_RECONFIG_PATH_FAILED] ==
+         0);
+
+  assert(!strcmp(jsd_reconfig_path_to_string(JSD_RECONFIG_PATH_REAPPLIED),
+                 "reapplied"));
+  assert(!strcmp(jsd_reconfig_path_to_string(JSD_NUM_RECONFIG_PATHS),
+                 "unknown"));
+
+  jsd_free(jsd);
+  jsd_vbus_free(vbus);
+
+  check_paths_over_vbus();
+
+  SUCCESS("jsd_reconfig checks passed");
+  return 0;
+}
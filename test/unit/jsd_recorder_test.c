@@ -0,0 +1,138 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "jsd/jsd_el2124.h"
+#include "jsd/jsd_el3602.h"
+#include "jsd/jsd_memory.h"
+#include "jsd/jsd_pub.h"
+#include "jsd/jsd_recorder.h"
+
+#define TEST_CAPACITY (4)
+#define TEST_CYCLES (6)
+
+// EL2124 outputs at the start of the IOmap, EL3602 inputs behind them
+static void add_slave(jsd_t* jsd, uint16_t slave_id, uint32_t product_code,
+                      uint8_t* outputs, uint32_t Obytes, uint8_t* inputs,
+                      uint32_t Ibytes) {
+  ec_slavet* slave = &jsd->ecx_context.slavelist[slave_id];
+  slave->eep_man   = JSD_BECKHOFF_VENDOR_ID;
+  slave->eep_id    = product_code;
+  slave->outputs   = outputs;
+  slave->Obytes    = Obytes;
+  slave->inputs    = inputs;
+  slave->Ibytes    = Ibytes;
+
+  jsd->slave_configs[slave_id].configuration_active = true;
+  jsd->slave_configs[slave_id].product_code         = product_code;
+}
+
+int main() {
+  char  path[] = "/tmp/jsd_recorder_test_XXXXXX";
+  int   fd     = mkstemp(path);
+  int   i;
+  assert(fd >= 0);
+  close(fd);
+
+  jsd_t*   jsd   = jsd_alloc();
+  uint8_t* iomap = (uint8_t*)jsd->IOmap;
+
+  MSG("Recording must not start before jsd_init()");
+  assert(!jsd_recorder_start(jsd, path, TEST_CAPACITY));
+
+  // Pretend the bus is up, cycles are recorded without sending frames
+  *jsd->ecx_context.slavecount = 2;
+  add_slave(jsd, 1, JSD_EL2124_PRODUCT_CODE, &iomap[0], 1, NULL, 0);
+  add_slave(jsd, 2, JSD_EL3602_PRODUCT_CODE, NULL, 0, &iomap[1],
+            sizeof(jsd_el3602_txpdo_t));
+  jsd->expected_wkc  = 3;
+  jsd->init_complete = true;
+  // A setup call that may follow jsd_init(...) of a real-time context
+  jsd_memory_forbid_malloc(true);
+  assert(jsd_recorder_start(jsd, path, TEST_CAPACITY));
+  jsd_memory_forbid_malloc(false);
+  assert(!jsd_recorder_start(jsd, path, TEST_CAPACITY));
+
+  MSG("Recording %d cycles into a ring of %d", TEST_CYCLES, TEST_CAPACITY);
+  for (i = 0; i < TEST_CYCLES; ++i) {
+    jsd_el3602_txpdo_t* txpdo = (jsd_el3602_txpdo_t*)&iomap[1];
+    txpdo->channel[0].value   = 1000 * i;
+    txpdo->channel[1].value   = -1000 * i;
+    iomap[0]                  = i;
+    jsd->wkc                  = i == 3 ? 0 : 3;
+    jsd->cycle_time.mono_nsec = 1000000LL * i;
+    jsd_recorder_record(jsd);
+  }
+  assert(jsd_recorder_get_cycle_count(jsd) == TEST_CYCLES);
+  jsd_recorder_stop(jsd);
+  assert(jsd_recorder_get_cycle_count(jsd) == 0);
+  jsd->init_complete = false;
+  jsd_free(jsd);
+
+  MSG("Replaying the most recent cycles offline");
+  jsd_t* replay = jsd_alloc();
+  assert(jsd_replay_open(replay, path));
+  assert(!jsd_replay_open(replay, path));
+  assert(*replay->ecx_context.slavecount == 2);
+  assert(replay->expected_wkc == 3);
+  assert(replay->slave_configs[2].product_code == JSD_EL3602_PRODUCT_CODE);
+  assert(jsd_replay_get_num_cycles(replay) == TEST_CAPACITY);
+  assert(jsd_replay_get_recorded_outputs(replay, 1) == NULL);
+
+  uint8_t* outputs = replay->ecx_context.slavelist[1].outputs;
+  for (i = TEST_CYCLES - TEST_CAPACITY; i < TEST_CYCLES; ++i) {
+    // Outputs of the previous cycle must survive the step
+    *outputs = 0xAA;
+    assert(jsd_replay_step(replay));
+    assert(*outputs == 0xAA);
+
+    jsd_el3602_read(replay, 2);
+    const jsd_el3602_state_t* state = jsd_el3602_get_state(replay, 2);
+    assert(state->adc_value[0] == 1000 * i);
+    assert(state->adc_value[1] == -1000 * i);
+    assert(replay->wkc == (i == 3 ? 0 : 3));
+    assert(replay->cycle_time.mono_nsec == 1000000LL * i);
+
+    const uint8_t* recorded = jsd_replay_get_recorded_outputs(replay, 1);
+    assert(recorded && *recorded == i);
+    assert(jsd_replay_get_recorded_outputs(replay, 2) == NULL);
+  }
+  assert(!jsd_replay_step(replay));
+  jsd_free(replay);
+
+  MSG("Rejecting a slave image outside the recorded IOmap");
+  FILE* file = fopen(path, "r+");
+  assert(file);
+  // eep_man, eep_id, output_offset and input_offset of the EL3602
+  int32_t layout[4] = {JSD_BECKHOFF_VENDOR_ID, JSD_EL3602_PRODUCT_CODE, -1, 1};
+  int32_t window[4] = {0};
+  long    position  = 0;
+  while (fread(window, sizeof(window), 1, file) == 1 &&
+         memcmp(window, layout, sizeof(layout)) != 0) {
+    fseek(file, ++position, SEEK_SET);
+  }
+  assert(memcmp(window, layout, sizeof(layout)) == 0);
+  int32_t input_offset = JSD_IOMAP_BYTES;
+  fseek(file, position + 3 * sizeof(int32_t), SEEK_SET);
+  assert(fwrite(&input_offset, sizeof(input_offset), 1, file) == 1);
+  fclose(file);
+  replay = jsd_alloc();
+  assert(!jsd_replay_open(replay, path));
+  jsd_free(replay);
+
+  MSG("Rejecting files that are not recordings");
+  file = fopen(path, "w");
+  assert(file);
+  fprintf(file, "not a JSD recording, just some text");
+  fclose(file);
+  replay = jsd_alloc();
+  assert(!jsd_replay_open(replay, path));
+  jsd_free(replay);
+
+  unlink(path);
+
+  SUCCESS("jsd_recorder checks passed");
+  return 0;
+}
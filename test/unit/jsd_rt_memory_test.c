@@ -0,0 +1,36 @@
+#include <assert.h>
+#include <string.h>
+
+#include "jsd/jsd.h"
+
+static bool in_arena(jsd_t* jsd, void* ptr) {
+  return (uint8_t*)ptr >= jsd->arena.base &&
+         (uint8_t*)ptr < jsd->arena.base + jsd->arena.used;
+}
+
+int main() {
+  jsd_memory_config_t config = {.use_huge_pages = true, .lock_memory = false};
+
+  MSG("Allocating jsd_t in real-time memory mode");
+  jsd_t* jsd = jsd_alloc_rt(config);
+  assert(jsd);
+  assert(in_arena(jsd, jsd));
+  assert(in_arena(jsd, jsd->ecx_context.port));
+  assert(in_arena(jsd, jsd->ecx_context.slavelist));
+  assert(in_arena(jsd, jsd->ecx_context.eepFMMU));
+  assert(*jsd->ecx_context.slavecount == 0);
+
+  // Carved buffers must not overlap the context
+  assert((uint8_t*)jsd->ecx_context.port >= (uint8_t*)(jsd + 1));
+
+  MSG("Converting an unknown state without allocation");
+  jsd_memory_forbid_malloc(true);
+  assert(strcmp(jsd_ec_state_to_string(0x77), "Bad EC_STATE: 0x77") == 0);
+  jsd_memory_forbid_malloc(false);
+
+  MSG("Deallocating jsd_t");
+  jsd_free(jsd);
+
+  SUCCESS("jsd real-time memory checks passed");
+  return 0;
+}
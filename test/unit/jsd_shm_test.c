@@ -0,0 +1,108 @@
+#include <assert.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "jsd/jsd_memory.h"
+#include "jsd/jsd_pub.h"
+#include "jsd/jsd_shm.h"
+
+#define TEST_CYCLES (200000)
+
+static jsd_shm_snapshot_t snapshot;
+static char               name[64];
+static bool               writer_done = false;
+
+static void* reader_loop(void* arg) {
+  (void)arg;
+  jsd_shm_reader_t reader;
+  uint64_t         reads = 0;
+  uint64_t         last  = 0;
+  assert(jsd_shm_open(&reader, name));
+
+  while (!__atomic_load_n(&writer_done, __ATOMIC_ACQUIRE)) {
+    if (!jsd_shm_read(&reader, &snapshot) || snapshot.cycle == 0) {
+      continue;
+    }
+    // Every field of a cycle carries its number, a torn copy mixes two
+    const jsd_el3602_state_t* el3602 = &snapshot.slaves[2].state.el3602;
+    assert(snapshot.wkc == (int32_t)snapshot.cycle);
+    assert(el3602->adc_value[0] == (int32_t)snapshot.cycle);
+    assert(el3602->adc_value[1] == (int32_t)snapshot.cycle);
+    assert(snapshot.slaves[1].state.epd.pub.actual_position ==
+           (int32_t)snapshot.cycle);
+    assert(snapshot.cycle >= last);
+    last = snapshot.cycle;
+    ++reads;
+  }
+  jsd_shm_close(&reader);
+  MSG("Reader took %lu consistent snapshots", (unsigned long)reads);
+  return NULL;
+}
+
+int main() {
+  jsd_t* jsd = jsd_alloc();
+  snprintf(name, sizeof(name), "/jsd_shm_test_%d", (int)getpid());
+
+  MSG("Nothing to open before publishing");
+  jsd_shm_reader_t reader;
+  assert(!jsd_shm_open(&reader, name));
+
+  *jsd->ecx_context.slavecount         = 2;
+  jsd->ecx_context.slavelist[0].state  = EC_STATE_OPERATIONAL;
+  jsd->ecx_context.slavelist[1].eep_id = JSD_EPD_PRODUCT_CODE;
+  jsd->ecx_context.slavelist[1].state  = EC_STATE_OPERATIONAL;
+  jsd->ecx_context.slavelist[2].eep_id = JSD_EL3602_PRODUCT_CODE;
+  jsd->ecx_context.slavelist[2].state  = EC_STATE_SAFE_OP + EC_STATE_ERROR;
+  jsd->ecx_context.slavelist[2].ALstatuscode = 0x001B;
+  jsd->expected_wkc                          = 3;
+
+  // A setup call that may follow jsd_init(...) of a real-time context
+  jsd_memory_forbid_malloc(true);
+  assert(jsd_shm_start(jsd, name));
+  jsd_memory_forbid_malloc(false);
+  assert(!jsd_shm_start(jsd, name));
+
+  MSG("Reading a published cycle");
+  assert(jsd_shm_open(&reader, name));
+  assert(!jsd_shm_read(&reader, &snapshot));
+  jsd->wkc                                     = 3;
+  jsd->cycle_time.mono_nsec                    = 123456789;
+  jsd->slave_states[1].epd.pub.actual_position = -42;
+  jsd->slave_states[2].el3602.voltage[1]       = 2.5;
+  jsd_shm_publish(jsd);
+  assert(jsd_shm_read(&reader, &snapshot));
+  assert(snapshot.cycle == 0);
+  assert(snapshot.wkc == 3 && snapshot.expected_wkc == 3);
+  assert(snapshot.cycle_time.mono_nsec == 123456789);
+  assert(snapshot.bus_state == EC_STATE_OPERATIONAL);
+  assert(snapshot.num_slaves == 2);
+  assert(snapshot.slaves[1].product_code == JSD_EPD_PRODUCT_CODE);
+  assert(snapshot.slaves[1].state.epd.pub.actual_position == -42);
+  assert(snapshot.slaves[2].al_state == EC_STATE_SAFE_OP + EC_STATE_ERROR);
+  assert(snapshot.slaves[2].al_status_code == 0x001B);
+  assert(snapshot.slaves[2].state.el3602.voltage[1] == 2.5);
+  jsd_shm_close(&reader);
+
+  MSG("Reading concurrently with the cyclic loop");
+  pthread_t thread;
+  assert(pthread_create(&thread, NULL, reader_loop, NULL) == 0);
+  uint32_t cycle;
+  for (cycle = 1; cycle <= TEST_CYCLES; ++cycle) {
+    jsd->wkc                                     = cycle;
+    jsd->slave_states[1].epd.pub.actual_position = cycle;
+    jsd->slave_states[2].el3602.adc_value[0]     = cycle;
+    jsd->slave_states[2].el3602.adc_value[1]     = cycle;
+    jsd_shm_publish(jsd);
+  }
+  __atomic_store_n(&writer_done, true, __ATOMIC_RELEASE);
+  pthread_join(thread, NULL);
+
+  MSG("Removing the segment");
+  jsd_free(jsd);
+  assert(!jsd_shm_open(&reader, name));
+
+  SUCCESS("jsd_shm checks passed");
+  return 0;
+}
@@ -0,0 +1,84 @@
+#include <assert.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "jsd/jsd_pub.h"
+#include "jsd/jsd_startup.h"
+
+static int hook_calls = 0;
+
+static int slow_hook(ecx_contextt* ecx_context, uint16_t slave_id) {
+  (void)ecx_context;
+  (void)slave_id;
+  ++hook_calls;
+  usleep(2000);
+  return 1;
+}
+
+int main() {
+  jsd_t*     jsd    = jsd_alloc();
+  ec_slavet* slaves = jsd->ecx_context.slavelist;
+
+  MSG("Keeping the report of a failed jsd_init");
+  assert(!jsd_init(jsd, "jsd_startup_test_missing_nic", 0));
+  const jsd_init_report_t* report = jsd_startup_get_report(jsd);
+  assert(!report->success);
+  assert(report->num_phases == 0);
+  assert(report->start_mono_nsec > 0);
+  assert(!jsd->startup.recording);
+
+  MSG("Timing the phases");
+  jsd_startup_begin(jsd);
+  assert(report->start_mono_nsec > 0 && report->total_nsec == 0);
+  *jsd->ecx_context.slavecount = 2;
+  jsd_startup_end_phase(jsd, JSD_INIT_PHASE_OPEN);
+  usleep(1000);
+  jsd_startup_end_phase(jsd, JSD_INIT_PHASE_CONFIG_INIT);
+  assert(report->num_phases == 2);
+  assert(report->num_slaves == 2);
+  assert(report->phase_nsec[JSD_INIT_PHASE_CONFIG_INIT] >= 1000000);
+  assert(report->total_nsec ==
+         report->phase_nsec[JSD_INIT_PHASE_OPEN] +
+             report->phase_nsec[JSD_INIT_PHASE_CONFIG_INIT]);
+
+  MSG("Timing the PO2SO hooks");
+  slaves[1].PO2SOconfigx = slow_hook;
+  jsd_startup_wrap_hooks(jsd);
+  assert(slaves[1].PO2SOconfigx != slow_hook);
+  assert(slaves[2].PO2SOconfigx == NULL);
+  assert(slaves[1].PO2SOconfigx(&jsd->ecx_context, 1) == 1);
+  assert(hook_calls == 1);
+  assert(report->slaves[1].po2so_nsec >= 2000000);
+  assert(report->slaves[2].po2so_nsec == 0);
+  jsd_startup_unwrap_hooks(jsd);
+  assert(slaves[1].PO2SOconfigx == slow_hook);
+
+  MSG("Counting SDO transfers and OP attempts");
+  jsd_startup_record_sdo(jsd, 1, true, 1000);
+  jsd_startup_record_sdo(jsd, 1, false, 3000);
+  assert(report->slaves[1].sdo_requests == 2);
+  assert(report->slaves[1].sdo_failures == 1);
+  assert(report->slaves[1].sdo_nsec == 4000);
+
+  slaves[1].state = EC_STATE_OPERATIONAL;
+  jsd_startup_record_op_attempt(jsd, 1, false);
+  jsd_startup_record_op_attempt(jsd, 2, true);
+  assert(report->op_attempts == 2);
+  assert(report->slaves[2].op_attempts == 2);
+
+  jsd_startup_end(jsd, true);
+  assert(report->success);
+  jsd_startup_record_sdo(jsd, 1, true, 1000);
+  assert(report->slaves[1].sdo_requests == 2);
+  jsd_startup_print_report(jsd);
+
+  assert(!strcmp(jsd_init_phase_to_string(JSD_INIT_PHASE_CONFIG_DC),
+                 "config_dc"));
+  assert(!strcmp(jsd_init_phase_to_string(JSD_NUM_INIT_PHASES), "unknown"));
+
+  *jsd->ecx_context.slavecount = 0;
+  jsd_free(jsd);
+
+  SUCCESS("jsd_startup checks passed");
+  return 0;
+}
@@ -0,0 +1,188 @@
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "jsd/jsd_memory.h"
+#include "jsd/jsd_pub.h"
+#include "jsd/jsd_telemetry_pub.h"
+
+#define TEST_RECORDS (3000)
+
+typedef struct {
+  int8_t   small;
+  uint16_t counter;
+  int64_t  big;
+  float    ratio;
+  double   value[2];
+  bool     flag;
+} test_state_t;
+
+static const jsd_telemetry_field_t test_fields[] = {
+    JSD_TELEMETRY_FIELD(test_state_t, small, I8),
+    JSD_TELEMETRY_FIELD(test_state_t, counter, U16),
+    JSD_TELEMETRY_FIELD(test_state_t, big, I64),
+    JSD_TELEMETRY_FIELD(test_state_t, ratio, F32),
+    JSD_TELEMETRY_FIELD(test_state_t, value, F64),
+    JSD_TELEMETRY_FIELD(test_state_t, flag, BOOL),
+};
+
+static void set_state(test_state_t* state, int i) {
+  state->small    = (int8_t)(-i % 100);
+  state->counter  = (uint16_t)i;
+  state->big      = 1000000000000LL * (i / 500);
+  state->ratio    = 0.5f * i;
+  state->value[0] = 0.25 * i;
+  state->value[1] = -1.0 / (1 + i % 7);
+  state->flag     = (i / 100) % 2;
+}
+
+static char* read_line(FILE* csv) {
+  static char line[4096];
+  return fgets(line, sizeof(line), csv);
+}
+
+// With forbid_malloc, start, push and stop run as after jsd_init(...) of an
+// rt context
+static uint64_t log_and_convert(jsd_t* jsd, bool compress,
+                                uint32_t ring_records, bool forbid_malloc,
+                                uint64_t* dropped) {
+  const char*  path = "/tmp/jsd_telemetry_test.bin";
+  test_state_t state;
+  memset(&state, 0, sizeof(state));
+
+  jsd_telemetry_t* tel = jsd_telemetry_alloc();
+  assert(jsd_telemetry_add_state(tel, jsd, 1, "EPD_"));
+  assert(jsd_telemetry_add_state(tel, jsd, 2, "EL2124_"));
+  assert(!jsd_telemetry_add_state(tel, jsd, 3, "none_"));
+  assert(jsd_telemetry_add_columns(
+      tel, "test_", &state, test_fields,
+      sizeof(test_fields) / sizeof(test_fields[0])));
+
+  jsd_telemetry_config_t config = {0};
+  config.ring_records           = ring_records;
+  config.block_records          = 256;
+  config.compress               = compress;
+  jsd_memory_forbid_malloc(forbid_malloc);
+  assert(jsd_telemetry_start(tel, path, config));
+
+  jsd_epd_state_t* epd = &jsd->slave_states[1].epd.pub;
+  int              i;
+  for (i = 0; i < TEST_RECORDS; ++i) {
+    set_state(&state, i);
+    epd->actual_position                  = 10 * i;
+    jsd->slave_states[2].el2124.output[3] = i % 2;
+    if (!jsd_telemetry_push(tel)) {
+      // The record is lost, log the same values again
+      --i;
+      ++*dropped;
+    }
+  }
+  jsd_telemetry_stop(tel);
+  jsd_memory_forbid_malloc(false);
+
+  jsd_telemetry_stats_t stats = jsd_telemetry_get_stats(tel);
+  assert(stats.records_pushed == TEST_RECORDS);
+  assert(stats.records_written == TEST_RECORDS);
+  assert(stats.records_dropped == *dropped);
+  jsd_telemetry_free(tel);
+
+  MSG("Converting the log back to CSV");
+  FILE* csv = tmpfile();
+  assert(jsd_telemetry_to_csv(path, csv));
+  rewind(csv);
+
+  char* line = read_line(csv);
+  assert(line);
+  assert(strncmp(line, "rel_time_s, cycle_period_s, EPD_actual_position, ",
+                 strlen("rel_time_s, cycle_period_s, EPD_actual_position, ")) ==
+         0);
+  assert(strstr(line, ", EPD_digital_inputs_0, "));
+  assert(strstr(line, ", EL2124_output_3, test_small, test_counter, "));
+  assert(strstr(line, ", test_value_0, test_value_1, test_flag\n"));
+
+  for (i = 0; i < TEST_RECORDS; ++i) {
+    line = read_line(csv);
+    assert(line);
+    test_state_t expected;
+    set_state(&expected, i);
+
+    // rel_time_s, cycle_period_s, then 52 EPD columns and 4 EL2124 columns
+    double values[2 + 52 + 4 + 7];
+    int    n = 0;
+    char*  token;
+    for (token = strtok(line, ","); token; token = strtok(NULL, ",")) {
+      assert(n < (int)(sizeof(values) / sizeof(values[0])));
+      values[n++] = strtod(token, NULL);
+    }
+    assert(n == (int)(sizeof(values) / sizeof(values[0])));
+    assert(values[0] >= 0 && values[1] >= 0);
+    assert(values[2] == 10 * i);
+    assert(values[2 + 52 + 3] == i % 2);
+
+    double* test = &values[2 + 52 + 4];
+    assert(test[0] == expected.small);
+    assert(test[1] == expected.counter);
+    assert(test[2] == expected.big);
+    assert(test[3] == expected.ratio);
+    assert(test[4] == expected.value[0]);
+    assert(test[5] == expected.value[1]);
+    assert(test[6] == expected.flag);
+  }
+  assert(read_line(csv) == NULL);
+  fclose(csv);
+
+  FILE*    file  = fopen(path, "rb");
+  uint64_t bytes = 0;
+  assert(file);
+  assert(fseek(file, 0, SEEK_END) == 0);
+  bytes = ftell(file);
+  fclose(file);
+  remove(path);
+  return bytes;
+}
+
+int main() {
+  jsd_t* jsd = jsd_alloc();
+
+  jsd->slave_configs[1].product_code = JSD_EPD_PRODUCT_CODE;
+  jsd->slave_configs[2].product_code = JSD_EL2124_PRODUCT_CODE;
+  jsd->slave_configs[3].product_code = 0x12345678;
+
+  MSG("Logging raw blocks");
+  uint64_t dropped   = 0;
+  uint64_t raw_bytes = log_and_convert(jsd, false, 0, true, &dropped);
+  assert(dropped == 0);
+
+  MSG("Logging compressed blocks");
+  uint64_t compressed_bytes = log_and_convert(jsd, true, 0, false, &dropped);
+  assert(dropped == 0);
+  MSG("%lu bytes raw, %lu bytes compressed", (unsigned long)raw_bytes,
+      (unsigned long)compressed_bytes);
+  assert(compressed_bytes * 4 < raw_bytes);
+
+  MSG("Dropping records when the writer falls behind");
+  log_and_convert(jsd, true, 16, false, &dropped);
+  MSG("%lu records dropped", (unsigned long)dropped);
+
+  MSG("Logging a real-time context from a locked ring");
+  jsd_t* rt_jsd = jsd_alloc_rt((jsd_memory_config_t){0});
+  assert(rt_jsd);
+  rt_jsd->slave_configs[1].product_code = JSD_EPD_PRODUCT_CODE;
+  rt_jsd->slave_configs[2].product_code = JSD_EL2124_PRODUCT_CODE;
+  rt_jsd->slave_configs[3].product_code = 0x12345678;
+  dropped = 0;
+  log_and_convert(rt_jsd, true, 0, true, &dropped);
+  assert(dropped == 0);
+  jsd_free(rt_jsd);
+
+  MSG("Rejecting other files");
+  FILE* csv = tmpfile();
+  assert(!jsd_telemetry_to_csv("/dev/null", csv));
+  assert(!jsd_telemetry_to_csv("/tmp/jsd_telemetry_missing.bin", csv));
+  fclose(csv);
+
+  jsd_free(jsd);
+
+  SUCCESS("jsd_telemetry checks passed");
+  return 0;
+}
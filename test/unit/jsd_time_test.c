@@ -0,0 +1,104 @@
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+
+#include "jsd/jsd_print.h"
+#include "jsd/jsd_time.h"
+
+// Allowed disagreement between the fast clock and clock_gettime(...)
+#define JSD_TIME_TEST_TOLERANCE_NSEC (1000000LL)
+
+// Feeds a DC clock running 50 ppm fast with a 1 kHz cycle and host stamps
+// lagging by 20-120 us, then checks the mapping recovers the true sample time
+static void check_dc_correlation() {
+  jsd_time_dc_correlation_t corr;
+  jsd_cycle_time_t          stamp = {0};
+
+  MSG("Checking DC correlation");
+  jsd_time_dc_correlation_reset(&corr);
+
+  int64_t dc_nsec;
+  assert(!jsd_time_dc_to_mono_nsec(&corr, 0, &dc_nsec));
+
+  const int64_t mono_0   = 5 * JSD_TIME_NSEC_PER_SEC;
+  const int64_t dc_0     = 700 * JSD_TIME_NSEC_PER_SEC;
+  const int64_t period   = 1000000;
+  const double  dc_rate  = 1.0 + 50e-6;
+  const int64_t real_ofs = 1600000000LL * JSD_TIME_NSEC_PER_SEC;
+
+  srand(42);
+  int i;
+  for (i = 0; i < 20000; ++i) {
+    int64_t mono_true = mono_0 + i * period;
+    stamp.dc_nsec     = dc_0 + (int64_t)((double)(i * period) * dc_rate);
+    stamp.mono_nsec   = mono_true + 20000 + rand() % 100000;
+    stamp.real_nsec   = stamp.mono_nsec + real_ofs;
+    stamp.dc_valid    = true;
+    jsd_time_dc_correlation_update(&corr, &stamp);
+  }
+
+  int64_t mono_nsec, real_nsec;
+  assert(jsd_time_dc_to_mono_nsec(&corr, stamp.dc_nsec, &mono_nsec));
+  assert(jsd_time_dc_to_real_nsec(&corr, stamp.dc_nsec, &real_nsec));
+  int64_t mono_true = mono_0 + (i - 1) * period;
+  MSG("DC mapping error: %lld ns (min latency 20000 ns)",
+      (long long)(mono_nsec - mono_true));
+  assert(llabs(mono_nsec - mono_true - 20000) < 10000);
+  assert(real_nsec - mono_nsec == real_ofs);
+
+  // Invalid stamps are ignored
+  stamp.dc_valid = false;
+  stamp.dc_nsec  = 0;
+  jsd_time_dc_correlation_update(&corr, &stamp);
+  assert(corr.num_samples == 20000);
+
+  // A single early sample corrects the offset but barely moves the rate
+  double rate     = corr.rate;
+  stamp.dc_nsec   = dc_0 + (int64_t)((double)(i * period) * dc_rate);
+  stamp.mono_nsec = mono_0 + i * period;
+  stamp.dc_valid  = true;
+  jsd_time_dc_correlation_update(&corr, &stamp);
+  assert(fabs(corr.rate - rate) < 1.1e-6);
+  assert(fabs(corr.rate * dc_rate - 1.0) < 5e-6);
+}
+
+int main() {
+  jsd_cycle_time_t a, b;
+
+  check_dc_correlation();
+
+  MSG("Checking clock_gettime based cycle time");
+  jsd_time_fast_clock_disable();
+  assert(!jsd_time_fast_clock_enabled());
+
+  jsd_time_get_cycle_time(&a);
+  jsd_time_get_cycle_time(&b);
+  assert(b.mono_nsec >= a.mono_nsec);
+  assert(llabs(a.real_nsec - jsd_time_get_time_nsec()) <
+         JSD_TIME_TEST_TOLERANCE_NSEC);
+
+  MSG("Checking fast clock");
+  if (!jsd_time_fast_clock_calibrate(10000)) {
+    WARNING("Fast clock unavailable, checked fallback only");
+    return 0;
+  }
+  assert(jsd_time_fast_clock_enabled());
+
+  int i;
+  for (i = 0; i < 1000; ++i) {
+    jsd_time_get_cycle_time(&a);
+    int64_t mono = jsd_time_get_mono_time_nsec();
+    int64_t real = jsd_time_get_time_nsec();
+    assert(llabs(mono - a.mono_nsec) < JSD_TIME_TEST_TOLERANCE_NSEC);
+    assert(llabs(real - a.real_nsec) < JSD_TIME_TEST_TOLERANCE_NSEC);
+
+    jsd_time_get_cycle_time(&b);
+    assert(b.mono_nsec >= a.mono_nsec);
+  }
+
+  jsd_time_fast_clock_disable();
+  assert(!jsd_time_fast_clock_enabled());
+
+  SUCCESS("jsd_time checks passed");
+  return 0;
+}
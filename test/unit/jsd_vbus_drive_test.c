@@ -0,0 +1,189 @@
+#include <assert.h>
+#include <string.h>
+
+#include "jsd/jsd_epd.h"
+#include "jsd/jsd_pub.h"
+#include "jsd/jsd_time.h"
+#include "jsd/jsd_vbus.h"
+#include "jsd/jsd_vbus_drive_pub.h"
+
+#define TEST_CYCLE_NSEC (1000000)
+#define TEST_FAULT_EMCY_CODE (0x7121)
+
+static jsd_t*           jsd;
+static jsd_vbus_drive_t drive;
+static uint8_t          outputs[sizeof(jsd_epd_rxpdo_data_t)];
+static uint8_t          inputs[sizeof(jsd_epd_txpdo_data_t)];
+static bool             emcy_delivered;
+
+// One jsd_read(...)/jsd_write(...) round with the drive in place of the bus,
+// the EMCY is queued the way the SDO thread would after receiving it
+static void cycle() {
+  jsd->cycle_time.mono_nsec += TEST_CYCLE_NSEC;
+  jsd->cycle_time.real_nsec += TEST_CYCLE_NSEC;
+
+  jsd_epd_read(jsd, 1);
+  jsd_epd_process(jsd, 1);
+  jsd_vbus_drive_step(&drive, outputs, inputs, jsd->cycle_time.mono_nsec);
+
+  if (drive.emcy_sent && !emcy_delivered) {
+    ec_errort error = {0};
+    error.Time.sec  = jsd->cycle_time.real_nsec / JSD_TIME_NSEC_PER_SEC;
+    error.Time.usec = jsd->cycle_time.real_nsec % JSD_TIME_NSEC_PER_SEC /
+                      JSD_TIME_NSEC_PER_USEC;
+    error.Slave     = 1;
+    error.Etype     = EC_ERR_TYPE_EMERGENCY;
+    error.ErrorCode = drive.emcy_code;
+    jsd_error_cirq_push(&jsd->slave_errors[1], error);
+    emcy_delivered = true;
+  }
+}
+
+static void cycle_until(jsd_elmo_state_machine_state_t state, int max_cycles) {
+  int i;
+  for (i = 0; i < max_cycles; ++i) {
+    cycle();
+    if (jsd_epd_get_state(jsd, 1)->actual_state_machine_state == state) {
+      return;
+    }
+  }
+  ERROR("State 0x%x not reached in %d cycles", state, max_cycles);
+  assert(0);
+}
+
+static void enable() {
+  cycle_until(JSD_ELMO_STATE_MACHINE_STATE_SWITCHED_ON, 10);
+  jsd_epd_reset(jsd, 1);
+  cycle_until(JSD_ELMO_STATE_MACHINE_STATE_OPERATION_ENABLED, 10);
+}
+
+int main() {
+  jsd = jsd_alloc();
+
+  ec_slavet* slave = &jsd->ecx_context.slavelist[1];
+  slave->eep_id    = JSD_EPD_PRODUCT_CODE;
+  slave->eep_man   = JSD_ELMO_VENDOR_ID;
+  slave->outputs   = outputs;
+  slave->Obytes    = sizeof(outputs);
+  slave->inputs    = inputs;
+  slave->Ibytes    = sizeof(inputs);
+  jsd->slave_configs[1].epd.continuous_current_limit = 1.0;
+  jsd->slave_configs[1].epd.peak_current_limit       = 2.0;
+  assert(jsd_epd_init(jsd, 1));
+
+  // Past the reset derate of the first jsd_epd_reset(...)
+  jsd->cycle_time.mono_nsec = 10 * JSD_TIME_NSEC_PER_SEC;
+  jsd->cycle_time.real_nsec = 10 * JSD_TIME_NSEC_PER_SEC;
+
+  jsd_vbus_drive_init(&drive, JSD_VBUS_DRIVE_LAYOUT_EPD);
+  drive.config.cycle_nsec         = TEST_CYCLE_NSEC;
+  drive.config.brake_release_nsec = 5 * TEST_CYCLE_NSEC;
+  drive.config.emcy_delay_nsec    = -1;
+
+  MSG("Enabling the drive through the EPD state machine");
+  enable();
+  const jsd_epd_state_t* state = jsd_epd_get_state(jsd, 1);
+  assert(!state->servo_enabled);
+  assert(!state->sto_engaged);
+  assert(state->bus_voltage == 48.0);
+  int i;
+  for (i = 0; i < 5; ++i) {
+    cycle();
+  }
+  assert(state->servo_enabled);
+  assert(state->motor_on);
+
+  MSG("Following a CSP command");
+  jsd_elmo_motion_command_csp_t csp = {0};
+  csp.target_position               = 1000;
+  jsd_epd_set_motion_command_csp(jsd, 1, csp);
+  cycle();
+  cycle();
+  assert(state->actual_mode_of_operation == JSD_EPD_MODE_OF_OPERATION_CSP);
+  assert(state->actual_position == 1000);
+
+  MSG("Completing a profiled move after the set-point handshake");
+  jsd_elmo_motion_command_prof_pos_t prof_pos = {0};
+  prof_pos.target_position                    = 3000;
+  prof_pos.profile_velocity                   = 100000;
+  prof_pos.profile_accel                      = 1000000;
+  prof_pos.profile_decel                      = 1000000;
+  jsd_epd_set_motion_command_prof_pos(jsd, 1, prof_pos);
+  bool acknowledged = false;
+  for (i = 0; i < 200 && !(acknowledged && state->target_reached); ++i) {
+    cycle();
+    acknowledged |= state->setpoint_ack_rise;
+    if (state->actual_position != 3000) {
+      assert(state->actual_position >= 1000 && state->actual_position < 3000);
+    }
+  }
+  assert(acknowledged);
+  assert(state->actual_position == 3000);
+  assert(state->actual_velocity == 0);
+
+  MSG("Halting through QUICK STOP ACTIVE");
+  jsd_elmo_motion_command_csv_t csv = {0};
+  csv.target_velocity               = 50000;
+  jsd_epd_set_motion_command_csv(jsd, 1, csv);
+  cycle();
+  cycle();
+  assert(state->actual_velocity == 50000);
+  jsd_epd_halt(jsd, 1);
+  cycle_until(JSD_ELMO_STATE_MACHINE_STATE_QUICK_STOP_ACTIVE, 5);
+  cycle_until(JSD_ELMO_STATE_MACHINE_STATE_SWITCH_ON_DISABLED, 100);
+  assert(state->actual_velocity == 0);
+
+  MSG("Recovering from a fault whose EMCY never arrives");
+  jsd->cycle_time.mono_nsec += JSD_TIME_NSEC_PER_SEC;  // reset derate
+  enable();
+  jsd_vbus_drive_inject_fault(&drive, TEST_FAULT_EMCY_CODE);
+  cycle_until(JSD_ELMO_STATE_MACHINE_STATE_FAULT, 10);
+  for (i = 0; i < 900; ++i) {
+    cycle();
+  }
+  assert(state->actual_state_machine_state ==
+         JSD_ELMO_STATE_MACHINE_STATE_FAULT);
+  cycle_until(JSD_ELMO_STATE_MACHINE_STATE_SWITCH_ON_DISABLED, 200);
+  assert(state->emcy_error_code == 0xFFFF);
+  assert(!emcy_delivered);
+
+  MSG("Reporting the EMCY code of a fault");
+  drive.config.fault_reaction_nsec = 10 * TEST_CYCLE_NSEC;
+  drive.config.emcy_delay_nsec     = 20 * TEST_CYCLE_NSEC;
+  jsd->cycle_time.mono_nsec += JSD_TIME_NSEC_PER_SEC;
+  enable();
+  jsd_vbus_drive_inject_fault(&drive, TEST_FAULT_EMCY_CODE);
+  cycle_until(JSD_ELMO_STATE_MACHINE_STATE_FAULT_REACTION_ACTIVE, 5);
+  cycle_until(JSD_ELMO_STATE_MACHINE_STATE_FAULT, 20);
+  cycle_until(JSD_ELMO_STATE_MACHINE_STATE_SWITCH_ON_DISABLED, 50);
+  assert(emcy_delivered);
+  assert(state->emcy_error_code == TEST_FAULT_EMCY_CODE);
+
+  MSG("Faulting when STO engages while enabled");
+  emcy_delivered               = false;
+  drive.config.emcy_delay_nsec = 0;
+  jsd->cycle_time.mono_nsec += JSD_TIME_NSEC_PER_SEC;
+  enable();
+  jsd_vbus_drive_set_sto(&drive, true);
+  cycle_until(JSD_ELMO_STATE_MACHINE_STATE_FAULT, 20);
+  assert(state->sto_engaged);
+  assert(drive.emcy_code == JSD_VBUS_DRIVE_STO_EMCY_CODE);
+
+  jsd_free(jsd);
+
+  MSG("Delivering the EMCY through the virtual bus mailbox");
+  jsd_vbus_t* vbus = jsd_vbus_alloc();
+  assert(jsd_vbus_add_slave(vbus, JSD_EPD_PRODUCT_CODE) == 1);
+  jsd_vbus_drive_init(&drive, JSD_VBUS_DRIVE_LAYOUT_EPD);
+  jsd_vbus_drive_attach(&drive, vbus, 1);
+  memset(outputs, 0, sizeof(outputs));
+  jsd_vbus_drive_inject_fault(&drive, TEST_FAULT_EMCY_CODE);
+  jsd_vbus_drive_step(&drive, outputs, inputs, 0);
+  assert(drive.emcy_sent);
+  assert(vbus->slaves[1].emcy_count == 1);
+  assert(vbus->slaves[1].emcy[0].error_code == TEST_FAULT_EMCY_CODE);
+  jsd_vbus_free(vbus);
+
+  SUCCESS("jsd_vbus_drive checks passed");
+  return 0;
+}
@@ -0,0 +1,190 @@
+#include <assert.h>
+#include <string.h>
+
+#include "jsd/jsd_el2124.h"
+#include "jsd/jsd_el3602.h"
+#include "jsd/jsd_pub.h"
+#include "jsd/jsd_vbus.h"
+
+#define TEST_STATION (0x1001)
+
+static uint8_t frame[EC_BUFSIZE];
+
+// Single datagram frame, -1 if the bus dropped it
+static int transfer(jsd_vbus_t* vbus, uint8_t cmd, uint16_t adp, uint16_t ado,
+                    void* data, uint16_t len) {
+  uint16_t elength = 10 + len + EC_WKCSIZE;
+  uint32_t address = adp | ((uint32_t)ado << 16);
+  uint8_t* datagram;
+  uint16_t wkc;
+  size_t   size = ETH_HEADERSIZE + EC_ELENGTHSIZE + elength;
+
+  memset(frame, 0, sizeof(frame));
+  frame[12]                 = ETH_P_ECAT >> 8;
+  frame[13]                 = ETH_P_ECAT & 0xFF;
+  frame[ETH_HEADERSIZE]     = elength & 0xFF;
+  frame[ETH_HEADERSIZE + 1] = (elength >> 8) | 0x10;
+  datagram                  = &frame[ETH_HEADERSIZE + EC_ELENGTHSIZE];
+  datagram[0]               = cmd;
+  memcpy(&datagram[2], &address, sizeof(address));
+  memcpy(&datagram[6], &len, sizeof(len));
+  memcpy(&datagram[10], data, len);
+
+  if (jsd_vbus_process_frame(vbus, frame, size) == 0) {
+    return -1;
+  }
+  memcpy(data, &datagram[10], len);
+  memcpy(&wkc, &datagram[10 + len], sizeof(wkc));
+  return wkc;
+}
+
+static int count_slaves(jsd_vbus_t* vbus) {
+  uint16_t type = 0;
+  return transfer(vbus, EC_CMD_BRD, 0, ECT_REG_TYPE, &type, sizeof(type));
+}
+
+static void request_state(jsd_vbus_t* vbus, uint16_t state) {
+  assert(transfer(vbus, EC_CMD_FPWR, TEST_STATION, ECT_REG_ALCTL, &state,
+                  sizeof(state)) == 1);
+}
+
+// EL3602 in PRE-OP with its mailbox and inputs mapped at logical 0
+static void bring_up(jsd_vbus_t* vbus) {
+  uint16_t station = TEST_STATION;
+  assert(transfer(vbus, EC_CMD_APWR, 0, ECT_REG_STADR, &station, 2) == 1);
+
+  uint8_t sms[16] = {0x00, 0x10, 0x00, 0x02, 0x26, 0, 0x01, 0,
+                     0x00, 0x12, 0x00, 0x02, 0x22, 0, 0x01, 0};
+  assert(transfer(vbus, EC_CMD_FPWR, TEST_STATION, ECT_REG_SM0, sms,
+                  sizeof(sms)) == 1);
+
+  uint16_t bytes    = sizeof(jsd_el3602_txpdo_t);
+  uint16_t physical = 0x1800;
+  uint8_t  fmmu[16] = {0};
+  memcpy(&fmmu[4], &bytes, 2);
+  fmmu[7] = 7;
+  memcpy(&fmmu[8], &physical, 2);
+  fmmu[11] = 1;
+  fmmu[12] = 1;
+  assert(transfer(vbus, EC_CMD_FPWR, TEST_STATION, ECT_REG_FMMU0, fmmu,
+                  sizeof(fmmu)) == 1);
+  request_state(vbus, EC_STATE_PRE_OP);
+}
+
+static bool mailbox_full(jsd_vbus_t* vbus) {
+  uint8_t mbx[512];
+  return transfer(vbus, EC_CMD_FPRD, TEST_STATION, 0x1200, mbx,
+                  sizeof(mbx)) == 1;
+}
+
+static void inject(jsd_vbus_t* vbus, jsd_vbus_fault_type_t type,
+                   uint16_t slave_id, uint32_t delay_frames, uint32_t frames) {
+  jsd_vbus_fault_t fault = {type, slave_id, delay_frames, frames};
+  assert(jsd_vbus_inject_fault(vbus, fault));
+}
+
+int main() {
+  jsd_vbus_t* vbus = jsd_vbus_alloc();
+  uint8_t     iomap[sizeof(jsd_el3602_txpdo_t)];
+  int         i;
+
+  assert(jsd_vbus_add_slave(vbus, JSD_EL3602_PRODUCT_CODE) == 1);
+  assert(jsd_vbus_add_slave(vbus, JSD_EL2124_PRODUCT_CODE) == 2);
+  bring_up(vbus);
+
+  MSG("Rejecting invalid faults");
+  jsd_vbus_fault_t invalid = {JSD_VBUS_FAULT_SLAVE_LOST, 3, 0, 1};
+  assert(!jsd_vbus_inject_fault(vbus, invalid));
+  invalid.slave_id = 1;
+  invalid.type     = JSD_VBUS_NUM_FAULT_TYPES;
+  assert(!jsd_vbus_inject_fault(vbus, invalid));
+  assert(strcmp(jsd_vbus_fault_type_to_string(JSD_VBUS_FAULT_SLAVE_LOST),
+                "slave lost") == 0);
+
+  MSG("Dropping frames after a delay");
+  uint64_t frames = jsd_vbus_get_frame_count(vbus);
+  inject(vbus, JSD_VBUS_FAULT_DROP_FRAME, 0, 1, 2);
+  assert(count_slaves(vbus) == 2);
+  assert(count_slaves(vbus) == -1);
+  assert(count_slaves(vbus) == -1);
+  assert(count_slaves(vbus) == 2);
+  assert(jsd_vbus_get_frame_count(vbus) == frames + 4);
+  assert(jsd_vbus_get_num_faults(vbus) == 0);
+
+  MSG("Leaving process data out of the working counter");
+  request_state(vbus, EC_STATE_SAFE_OP);
+  request_state(vbus, EC_STATE_OPERATIONAL);
+  assert(transfer(vbus, EC_CMD_LRD, 0, 0, iomap, sizeof(iomap)) == 1);
+  inject(vbus, JSD_VBUS_FAULT_CORRUPT_WKC, 1, 0, 1);
+  assert(transfer(vbus, EC_CMD_LRD, 0, 0, iomap, sizeof(iomap)) == 0);
+  assert(transfer(vbus, EC_CMD_LRD, 0, 0, iomap, sizeof(iomap)) == 1);
+
+  MSG("Falling to SAFE-OP + ERROR until the fault ends");
+  inject(vbus, JSD_VBUS_FAULT_SAFE_OP_ERROR, 1, 0, 3);
+  assert(count_slaves(vbus) == 2);
+  assert(jsd_vbus_get_slave_state(vbus, 1) ==
+         (EC_STATE_SAFE_OP | EC_STATE_ERROR));
+  request_state(vbus, EC_STATE_SAFE_OP | EC_STATE_ACK);
+  assert(jsd_vbus_get_slave_state(vbus, 1) == EC_STATE_SAFE_OP);
+  request_state(vbus, EC_STATE_OPERATIONAL);
+  assert(jsd_vbus_get_slave_state(vbus, 1) ==
+         (EC_STATE_SAFE_OP | EC_STATE_ERROR));
+  request_state(vbus, EC_STATE_SAFE_OP | EC_STATE_ACK);
+  request_state(vbus, EC_STATE_OPERATIONAL);
+  assert(jsd_vbus_get_slave_state(vbus, 1) == EC_STATE_OPERATIONAL);
+
+  MSG("Losing a slave and reconnecting it in INIT");
+  inject(vbus, JSD_VBUS_FAULT_SLAVE_LOST, 1, 0, 3);
+  assert(count_slaves(vbus) == 1);
+  uint16_t unused = 0;
+  assert(transfer(vbus, EC_CMD_APRD, 0, ECT_REG_STADR, &unused, 2) == 1);
+  assert(transfer(vbus, EC_CMD_LRD, 0, 0, iomap, sizeof(iomap)) == 0);
+  assert(count_slaves(vbus) == 2);
+  assert(jsd_vbus_get_slave_state(vbus, 1) == EC_STATE_INIT);
+  uint16_t station = 0xFFFF;
+  assert(transfer(vbus, EC_CMD_APRD, 0, ECT_REG_STADR, &station, 2) == 1);
+  assert(station == 0);
+  bring_up(vbus);
+  assert(jsd_vbus_get_slave_state(vbus, 1) == EC_STATE_PRE_OP);
+
+  MSG("Ignoring mailbox requests");
+  inject(vbus, JSD_VBUS_FAULT_MAILBOX_TIMEOUT, 1, 0, 0);
+  uint8_t mbx[512] = {0};
+  mbx[0]           = 10;
+  mbx[5]           = (1 << 4) | ECT_MBXT_COE;
+  mbx[7]           = ECT_COES_SDOREQ << 4;
+  mbx[8]           = ECT_SDO_UP_REQ;
+  mbx[9]           = 0x18;
+  mbx[10]          = 0x10;
+  mbx[11]          = 0x02;
+  assert(transfer(vbus, EC_CMD_FPWR, TEST_STATION, 0x1000, mbx,
+                  sizeof(mbx)) == 1);
+  assert(!mailbox_full(vbus));
+  jsd_vbus_clear_faults(vbus);
+  assert(jsd_vbus_get_num_faults(vbus) == 0);
+  assert(transfer(vbus, EC_CMD_FPWR, TEST_STATION, 0x1000, mbx,
+                  sizeof(mbx)) == 1);
+  assert(mailbox_full(vbus));
+
+  MSG("Holding EMCY messages back");
+  inject(vbus, JSD_VBUS_FAULT_DELAY_EMCY, 0, 0, 10);
+  assert(count_slaves(vbus) == 2);
+  assert(jsd_vbus_post_emcy(vbus, 1, 0x8110, 0x11));
+  for (i = 0; i < 9; ++i) {
+    assert(!mailbox_full(vbus));
+  }
+  assert(mailbox_full(vbus));
+  assert(!mailbox_full(vbus));
+
+  MSG("Cancelling scheduled faults");
+  inject(vbus, JSD_VBUS_FAULT_SLAVE_LOST, 0, 5, 1);
+  jsd_vbus_clear_faults(vbus);
+  for (i = 0; i < 10; ++i) {
+    assert(count_slaves(vbus) == 2);
+  }
+
+  jsd_vbus_free(vbus);
+
+  SUCCESS("jsd_vbus fault injection checks passed");
+  return 0;
+}
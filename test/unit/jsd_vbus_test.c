@@ -0,0 +1,364 @@
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "jsd/jsd_el2124.h"
+#include "jsd/jsd_el3602.h"
+#include "jsd/jsd_epd_pub.h"
+#include "jsd/jsd_pub.h"
+#include "jsd/jsd_vbus.h"
+
+#define TEST_SII_PRODUCT_CODE_WORD (0x000A)
+
+static uint8_t frame[EC_BUFSIZE];
+
+// Single datagram frame, as ecx_setupdatagram(...) builds it
+static size_t build_frame(uint8_t cmd, uint32_t address, const void* data,
+                          uint16_t len) {
+  uint16_t elength = 10 + len + EC_WKCSIZE;
+  uint8_t* datagram;
+
+  memset(frame, 0, sizeof(frame));
+  frame[12]                     = ETH_P_ECAT >> 8;
+  frame[13]                     = ETH_P_ECAT & 0xFF;
+  frame[ETH_HEADERSIZE]         = elength & 0xFF;
+  frame[ETH_HEADERSIZE + 1]     = (elength >> 8) | 0x10;
+  datagram                      = &frame[ETH_HEADERSIZE + EC_ELENGTHSIZE];
+  datagram[0]                   = cmd;
+  memcpy(&datagram[2], &address, sizeof(address));
+  memcpy(&datagram[6], &len, sizeof(len));
+  if (data) {
+    memcpy(&datagram[10], data, len);
+  }
+  return ETH_HEADERSIZE + EC_ELENGTHSIZE + elength;
+}
+
+static uint16_t frame_result(void* data, uint16_t len) {
+  uint8_t* datagram = &frame[ETH_HEADERSIZE + EC_ELENGTHSIZE];
+  uint16_t wkc;
+  if (data) {
+    memcpy(data, &datagram[10], len);
+  }
+  memcpy(&wkc, &datagram[10 + len], sizeof(wkc));
+  return wkc;
+}
+
+static uint16_t transfer(jsd_vbus_t* vbus, uint8_t cmd, uint16_t adp,
+                         uint16_t ado, void* data, uint16_t len) {
+  size_t size = build_frame(cmd, adp | ((uint32_t)ado << 16), data, len);
+  assert(jsd_vbus_process_frame(vbus, frame, size) == size);
+  return frame_result(data, len);
+}
+
+static uint16_t fpwr_u16(jsd_vbus_t* vbus, uint16_t station, uint16_t ado,
+                         uint16_t value) {
+  return transfer(vbus, EC_CMD_FPWR, station, ado, &value, sizeof(value));
+}
+
+static uint16_t fprd_u16(jsd_vbus_t* vbus, uint16_t station, uint16_t ado) {
+  uint16_t value = 0;
+  assert(transfer(vbus, EC_CMD_FPRD, station, ado, &value, sizeof(value)) ==
+         1);
+  return value;
+}
+
+static void set_fmmu(jsd_vbus_t* vbus, uint16_t station, uint32_t logical,
+                     uint16_t bytes, uint8_t start_bit, uint8_t end_bit,
+                     uint16_t physical, uint8_t type) {
+  uint8_t fmmu[16] = {0};
+  memcpy(&fmmu[0], &logical, 4);
+  memcpy(&fmmu[4], &bytes, 2);
+  fmmu[6] = start_bit;
+  fmmu[7] = end_bit;
+  memcpy(&fmmu[8], &physical, 2);
+  fmmu[11] = type;
+  fmmu[12] = 1;
+  assert(transfer(vbus, EC_CMD_FPWR, station, ECT_REG_FMMU0, fmmu,
+                  sizeof(fmmu)) == 1);
+}
+
+static void set_mailbox_sms(jsd_vbus_t* vbus, uint16_t station) {
+  uint8_t sms[16] = {0};
+  sms[0]          = 0x00;
+  sms[1]          = 0x10;  // 0x1000
+  sms[3]          = 0x02;  // 512
+  sms[4]          = 0x26;
+  sms[6]          = 0x01;
+  sms[8]          = 0x00;
+  sms[9]          = 0x12;  // 0x1200
+  sms[11]         = 0x02;  // 512
+  sms[12]         = 0x22;
+  sms[14]         = 0x01;
+  assert(transfer(vbus, EC_CMD_FPWR, station, ECT_REG_SM0, sms,
+                  sizeof(sms)) == 1);
+}
+
+static uint8_t sdo_upload(jsd_vbus_t* vbus, uint16_t station, uint16_t index,
+                          uint8_t subindex, uint32_t* value) {
+  uint8_t mbx[512] = {0};
+  mbx[0]           = 10;                  // length
+  mbx[5]           = (1 << 4) | ECT_MBXT_COE;
+  mbx[7]           = ECT_COES_SDOREQ << 4;
+  mbx[8]           = ECT_SDO_UP_REQ;
+  memcpy(&mbx[9], &index, 2);
+  mbx[11] = subindex;
+  assert(transfer(vbus, EC_CMD_FPWR, station, 0x1000, mbx, sizeof(mbx)) == 1);
+
+  memset(mbx, 0, sizeof(mbx));
+  assert(transfer(vbus, EC_CMD_FPRD, station, 0x1200, mbx, sizeof(mbx)) == 1);
+  assert((mbx[5] & 0x0F) == ECT_MBXT_COE);
+  assert((mbx[7] >> 4) == ECT_COES_SDORES);
+  memcpy(value, &mbx[12], sizeof(*value));
+  return mbx[8];
+}
+
+static void request_state(jsd_vbus_t* vbus, uint16_t station, uint16_t state) {
+  assert(fpwr_u16(vbus, station, ECT_REG_ALCTL, state) == 1);
+}
+
+static void count_model(jsd_vbus_t* vbus, uint16_t slave_id,
+                        const uint8_t* rxpdo, uint16_t rxpdo_bytes,
+                        uint8_t* txpdo, uint16_t txpdo_bytes,
+                        int64_t time_nsec, void* user) {
+  (void)vbus;
+  (void)slave_id;
+  (void)rxpdo;
+  (void)rxpdo_bytes;
+  (void)time_nsec;
+  int* calls = (int*)user;
+  ++(*calls);
+  assert(txpdo_bytes >= 1);
+  txpdo[0] = *calls;
+}
+
+// jsd_init(...) through jsd_free(...) against the virtual bus, which the
+// SOEM port exchanges frames with over a socketpair
+static void check_jsd_over_vbus() {
+  jsd_vbus_t* vbus = jsd_vbus_alloc();
+  assert(jsd_vbus_add_slave(vbus, JSD_EL3602_PRODUCT_CODE) == 1);
+  assert(jsd_vbus_add_slave(vbus, JSD_EPD_PRODUCT_CODE) == 2);
+
+  jsd_t* jsd = jsd_alloc();
+  jsd_vbus_attach(vbus, jsd);
+
+  jsd_slave_config_t el3602_config = {0};
+  snprintf(el3602_config.name, JSD_NAME_LEN, "analog");
+  el3602_config.configuration_active = true;
+  el3602_config.product_code         = JSD_EL3602_PRODUCT_CODE;
+  for (int ch = 0; ch < JSD_EL3602_NUM_CHANNELS; ++ch) {
+    el3602_config.el3602.range[ch]  = JSD_EL3602_RANGE_10V;
+    el3602_config.el3602.filter[ch] = JSD_BECKHOFF_FILTER_30000HZ;
+  }
+  jsd_set_slave_config(jsd, 1, el3602_config);
+
+  jsd_slave_config_t epd_config = {0};
+  snprintf(epd_config.name, JSD_NAME_LEN, "drive");
+  epd_config.configuration_active         = true;
+  epd_config.product_code                 = JSD_EPD_PRODUCT_CODE;
+  epd_config.epd.max_motor_speed          = 1e9;
+  epd_config.epd.loop_period_ms           = 1;
+  epd_config.epd.torque_slope             = 1e7;
+  epd_config.epd.max_profile_accel        = 1e6;
+  epd_config.epd.max_profile_decel        = 1e7;
+  epd_config.epd.velocity_tracking_error  = 1e8;
+  epd_config.epd.position_tracking_error  = 1e9;
+  epd_config.epd.peak_current_limit       = 5;
+  epd_config.epd.peak_current_time        = 3;
+  epd_config.epd.continuous_current_limit = 2;
+  epd_config.epd.brake_engage_msec        = 10;
+  epd_config.epd.brake_disengage_msec     = 10;
+  epd_config.epd.ctrl_gain_scheduling_mode =
+      JSD_ELMO_GAIN_SCHEDULING_MODE_PRELOADED;
+  jsd_set_slave_config(jsd, 2, epd_config);
+
+  MSG("Bringing an EL3602 and EPD line to OPERATIONAL with jsd_init");
+  assert(jsd_init(jsd, "jsd_vbus_test", 0));
+  assert(jsd_vbus_get_slave_state(vbus, 1) == EC_STATE_OPERATIONAL);
+  assert(jsd_vbus_get_slave_state(vbus, 2) == EC_STATE_OPERATIONAL);
+  assert(jsd->expected_wkc == 4);
+
+  MSG("Cycling process data with jsd_read and jsd_write");
+  jsd_el3602_txpdo_t analog = {0};
+  analog.channel[1].value   = 0x400000;
+  jsd_vbus_write_txpdo(vbus, 1, &analog, sizeof(analog));
+  jsd_epd_txpdo_data_t drive = {0};
+  drive.actual_position      = 4321;
+  jsd_vbus_write_txpdo(vbus, 2, &drive, sizeof(drive));
+
+  jsd_epd_set_digital_output(jsd, 2, 1, 1);
+  jsd_epd_process(jsd, 2);
+  jsd_write(jsd);
+  jsd_read(jsd, EC_TIMEOUTRET);
+  assert(jsd->wkc == jsd->expected_wkc);
+
+  jsd_el3602_read(jsd, 1);
+  assert(jsd_el3602_get_state(jsd, 1)->adc_value[1] == 0x400000);
+  assert(jsd_el3602_get_state(jsd, 1)->voltage[1] > 0.0);
+  jsd_epd_read(jsd, 2);
+  assert(jsd_epd_get_state(jsd, 2)->actual_position == 4321);
+
+  jsd_epd_rxpdo_data_t command = {0};
+  jsd_vbus_read_rxpdo(vbus, 2, &command, sizeof(command));
+  assert(command.digital_outputs == (0x01 << 17));
+
+  jsd_free(jsd);
+  jsd_vbus_free(vbus);
+}
+
+int main() {
+  jsd_vbus_t* vbus = jsd_vbus_alloc();
+  uint16_t    i;
+
+  MSG("Building an EL3602, EL2124 and EPD line");
+  assert(jsd_vbus_add_slave(vbus, 0xDEADBEEF) == 0);
+  assert(jsd_vbus_add_slave(vbus, JSD_EL3602_PRODUCT_CODE) == 1);
+  assert(jsd_vbus_add_slave(vbus, JSD_EL2124_PRODUCT_CODE) == 2);
+  assert(jsd_vbus_add_slave(vbus, JSD_EPD_PRODUCT_CODE) == 3);
+
+  MSG("Counting slaves with a broadcast read");
+  uint16_t type = 0;
+  assert(transfer(vbus, EC_CMD_BRD, 0, ECT_REG_TYPE, &type, 2) == 3);
+  assert((type & 0xFF) == 0x11);
+
+  MSG("Assigning station addresses by position");
+  for (i = 0; i < 3; ++i) {
+    uint16_t station = 0x1001 + i;
+    assert(transfer(vbus, EC_CMD_APWR, (uint16_t)(0 - i), ECT_REG_STADR,
+                    &station, 2) == 1);
+  }
+  assert(fprd_u16(vbus, 0x1002, ECT_REG_STADR) == 0x1002);
+  uint16_t unused = 0;
+  assert(transfer(vbus, EC_CMD_FPRD, 0x1004, ECT_REG_TYPE, &unused, 2) == 0);
+  assert((fprd_u16(vbus, 0x1003, ECT_REG_DLSTAT) & 0x0300) == 0x0200);
+  assert((fprd_u16(vbus, 0x1003, ECT_REG_DLSTAT) & 0x0C00) == 0x0400);
+
+  MSG("Reading the product code from the SII");
+  uint8_t eeprom[6] = {0x00, 0x01, TEST_SII_PRODUCT_CODE_WORD, 0, 0, 0};
+  assert(transfer(vbus, EC_CMD_FPWR, 0x1001, ECT_REG_EEPCTL, eeprom,
+                  sizeof(eeprom)) == 1);
+  uint32_t product_code = 0;
+  assert(transfer(vbus, EC_CMD_FPRD, 0x1001, ECT_REG_EEPDAT, &product_code,
+                  4) == 1);
+  assert(product_code == JSD_EL3602_PRODUCT_CODE);
+
+  MSG("Rejecting invalid AL state transitions");
+  request_state(vbus, 0x1001, EC_STATE_OPERATIONAL);
+  assert(jsd_vbus_get_slave_state(vbus, 1) ==
+         (EC_STATE_INIT | EC_STATE_ERROR));
+  assert(fprd_u16(vbus, 0x1001, ECT_REG_ALSTATCODE) == 0x0011);
+  request_state(vbus, 0x1001, EC_STATE_PRE_OP | EC_STATE_ACK);
+  assert(jsd_vbus_get_slave_state(vbus, 1) ==
+         (EC_STATE_INIT | EC_STATE_ERROR));
+  assert(fprd_u16(vbus, 0x1001, ECT_REG_ALSTATCODE) == 0x0016);
+
+  set_mailbox_sms(vbus, 0x1001);
+  request_state(vbus, 0x1001, EC_STATE_PRE_OP | EC_STATE_ACK);
+  assert(jsd_vbus_get_slave_state(vbus, 1) == EC_STATE_PRE_OP);
+  assert(fprd_u16(vbus, 0x1001, ECT_REG_ALSTATCODE) == 0);
+
+  MSG("Uploading SDOs over the CoE mailbox");
+  uint32_t value = 0;
+  assert(sdo_upload(vbus, 0x1001, 0x1018, 0x02, &value) == 0x43);
+  assert(value == JSD_EL3602_PRODUCT_CODE);
+  uint8_t mbx[512];
+  assert(transfer(vbus, EC_CMD_FPRD, 0x1001, 0x1200, mbx, sizeof(mbx)) == 0);
+  assert(sdo_upload(vbus, 0x1001, 0x1234, 0x00, &value) == ECT_SDO_ABORT);
+  assert(value == 0x06020000);
+
+  MSG("Delivering EMCY messages through the mailbox");
+  assert(jsd_vbus_post_emcy(vbus, 1, 0x8110, 0x11));
+  assert(transfer(vbus, EC_CMD_FPRD, 0x1001, 0x1200, mbx, sizeof(mbx)) == 1);
+  assert((mbx[5] & 0x0F) == ECT_MBXT_COE);
+  assert((mbx[7] >> 4) == ECT_COES_EMERGENCY);
+  uint16_t error_code = 0;
+  memcpy(&error_code, &mbx[8], sizeof(error_code));
+  assert(error_code == 0x8110);
+  assert(mbx[10] == 0x11);
+  assert(transfer(vbus, EC_CMD_FPRD, 0x1001, 0x1200, mbx, sizeof(mbx)) == 0);
+  assert(!jsd_vbus_post_emcy(vbus, 2, 0x8110, 0x11));
+
+  uint8_t sm_type = 0;
+  assert(jsd_vbus_get_sdo(vbus, 1, ECT_SDO_SMCOMMTYPE, 3, &sm_type, 1));
+  assert(sm_type == 3);
+  uint16_t offset = 1234;
+  assert(jsd_vbus_set_sdo(vbus, 3, 0x6064, 0, &offset, sizeof(offset)));
+  offset = 0;
+  assert(jsd_vbus_get_sdo(vbus, 3, 0x6064, 0, &offset, sizeof(offset)));
+  assert(offset == 1234);
+
+  MSG("Exchanging process data through the FMMUs");
+  const uint16_t txpdo_bytes = sizeof(jsd_el3602_txpdo_t);
+  uint8_t        inputs[sizeof(jsd_el3602_txpdo_t)];
+  for (i = 0; i < txpdo_bytes; ++i) {
+    inputs[i] = 0x40 + i;
+  }
+  jsd_vbus_write_txpdo(vbus, 1, inputs, sizeof(inputs));
+
+  // EL3602 inputs are byte aligned, EL2124 outputs are the upper nibble of
+  // the next byte to exercise the bit mapping
+  set_fmmu(vbus, 0x1001, 0, txpdo_bytes, 0, 7, 0x1800, 1);
+  set_fmmu(vbus, 0x1002, txpdo_bytes, 1, 4, 7, 0x0F00, 2);
+  request_state(vbus, 0x1001, EC_STATE_SAFE_OP);
+  request_state(vbus, 0x1002, EC_STATE_PRE_OP);
+  request_state(vbus, 0x1002, EC_STATE_SAFE_OP);
+  request_state(vbus, 0x1002, EC_STATE_OPERATIONAL);
+  assert(jsd_vbus_get_slave_state(vbus, 1) == EC_STATE_SAFE_OP);
+  assert(jsd_vbus_get_slave_state(vbus, 2) == EC_STATE_OPERATIONAL);
+
+  uint8_t iomap[sizeof(jsd_el3602_txpdo_t) + 1] = {0};
+  iomap[txpdo_bytes]                            = 0xA5;
+  assert(transfer(vbus, EC_CMD_LRW, 0, 0, iomap, sizeof(iomap)) == 3);
+  assert(memcmp(iomap, inputs, txpdo_bytes) == 0);
+  assert(iomap[txpdo_bytes] == 0xA5);
+  uint8_t outputs = 0;
+  jsd_vbus_read_rxpdo(vbus, 2, &outputs, 1);
+  assert((outputs & 0x0F) == 0x0A);
+
+  MSG("Running a slave model after each exchange");
+  int calls = 0;
+  jsd_vbus_set_slave_model(vbus, 1, count_model, &calls);
+  assert(transfer(vbus, EC_CMD_LRD, 0, 0, iomap, sizeof(iomap)) == 1);
+  assert(calls == 1);
+  assert(transfer(vbus, EC_CMD_LRD, 0, 0, iomap, sizeof(iomap)) == 1);
+  assert(calls == 2);
+  assert(iomap[0] == 1);
+  assert(transfer(vbus, EC_CMD_FPRD, 0x1001, ECT_REG_TYPE, &unused, 2) == 1);
+  assert(calls == 2);
+
+  MSG("Appending a slave while the bus runs");
+  assert(jsd_vbus_add_slave(vbus, JSD_EL2124_PRODUCT_CODE) == 4);
+  assert(transfer(vbus, EC_CMD_BRD, 0, ECT_REG_TYPE, &type, 2) == 4);
+  assert(fprd_u16(vbus, 0x1003, ECT_REG_STADR) == 0x1003);
+  assert(transfer(vbus, EC_CMD_APRD, (uint16_t)(0 - 3), ECT_REG_STADR,
+                  &unused, 2) == 1);
+  assert(unused == 0);
+  assert(jsd_vbus_get_slave_state(vbus, 2) == EC_STATE_OPERATIONAL);
+
+  MSG("Serving frames over the port socket");
+  ecx_portt port;
+  memset(&port, 0, sizeof(port));
+  assert(jsd_vbus_open(vbus, &port));
+  size_t  size = build_frame(EC_CMD_BRD, 0, &type, 2);
+  assert(send(port.sockhandle, frame, size, 0) == (ssize_t)size);
+  ssize_t received = -1;
+  for (i = 0; i < 10000 && received < 0; ++i) {
+    received = recv(port.sockhandle, frame, sizeof(frame), 0);
+  }
+  assert(received == (ssize_t)size);
+  assert(frame_result(NULL, 2) == 4);
+  close(port.sockhandle);
+
+  jsd_t* jsd = jsd_alloc();
+  jsd_vbus_attach(vbus, jsd);
+  assert(jsd->vbus == vbus);
+  jsd_free(jsd);
+
+  jsd_vbus_free(vbus);
+
+  check_jsd_over_vbus();
+
+  SUCCESS("jsd_vbus checks passed");
+  return 0;
+}
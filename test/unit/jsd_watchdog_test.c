@@ -0,0 +1,115 @@
+#include <assert.h>
+#include <stdio.h>
+
+#include "jsd/jsd_el4102_pub.h"
+#include "jsd/jsd_metrics_pub.h"
+#include "jsd/jsd_pub.h"
+#include "jsd/jsd_vbus_pub.h"
+#include "jsd/jsd_watchdog.h"
+
+// Long enough that the thread never sees a stall, checks are driven by the test
+#define TEST_TIMEOUT_US (60000000)
+#define TEST_TIMEOUT_NSEC ((int64_t)TEST_TIMEOUT_US * JSD_TIME_NSEC_PER_USEC)
+
+static void cycle(jsd_t* jsd) {
+  jsd_el4102_process(jsd, 1);
+  jsd_write(jsd);
+  jsd_read(jsd, EC_TIMEOUTRET);
+  assert(jsd->wkc == jsd->expected_wkc);
+}
+
+static int16_t bus_output(jsd_vbus_t* vbus) {
+  int16_t outputs[JSD_EL4102_NUM_CHANNELS] = {0};
+  jsd_vbus_read_rxpdo(vbus, 1, outputs, sizeof(outputs));
+  return outputs[0];
+}
+
+int main() {
+  jsd_vbus_t* vbus = jsd_vbus_alloc();
+  assert(jsd_vbus_add_slave(vbus, JSD_EL4102_PRODUCT_CODE) == 1);
+
+  jsd_t* jsd = jsd_alloc();
+  jsd_vbus_attach(vbus, jsd);
+
+  jsd_watchdog_config_t config = {.timeout_us        = TEST_TIMEOUT_US,
+                                  .send_safe_outputs = true};
+
+  MSG("Watchdog must not start before jsd_init()");
+  assert(!jsd_watchdog_start(jsd, config));
+
+  jsd_slave_config_t slave_config = {0};
+  snprintf(slave_config.name, JSD_NAME_LEN, "outputs");
+  slave_config.configuration_active = true;
+  slave_config.product_code         = JSD_EL4102_PRODUCT_CODE;
+  jsd_set_slave_config(jsd, 1, slave_config);
+  assert(jsd_init(jsd, "jsd_watchdog_test", 0));
+
+  MSG("Starting and stopping the watchdog thread");
+  assert(jsd_watchdog_start(jsd, config));
+  assert(!jsd_watchdog_start(jsd, config));
+  jsd_watchdog_stop(jsd);
+  jsd_watchdog_stop(jsd);
+
+  int16_t safe_outputs[JSD_EL4102_NUM_CHANNELS] = {0};
+  assert(!jsd_watchdog_set_safe_outputs(jsd, 1, safe_outputs, 1));
+  assert(jsd_watchdog_set_safe_outputs(jsd, 1, safe_outputs,
+                                       sizeof(safe_outputs)));
+
+  jsd_el4102_write_single_channel(jsd, 1, 0, 5.0);
+  int16_t command = 0x3FFF;
+  cycle(jsd);
+  cycle(jsd);
+  assert(bus_output(vbus) == command);
+
+  MSG("Stalling between jsd_write and jsd_read");
+  jsd_el4102_process(jsd, 1);
+  jsd_write(jsd);
+  int64_t heartbeat = jsd->watchdog.heartbeat_nsec;
+  jsd_watchdog_check(jsd, heartbeat + TEST_TIMEOUT_NSEC);
+  jsd_watchdog_stats_t stats = jsd_watchdog_get_stats(jsd);
+  assert(!stats.stalled);
+
+  jsd_watchdog_check(jsd, heartbeat + TEST_TIMEOUT_NSEC + 1);
+  jsd_watchdog_check(jsd, heartbeat + TEST_TIMEOUT_NSEC + 2);
+  stats = jsd_watchdog_get_stats(jsd);
+  assert(stats.stalled);
+  assert(stats.stall_count == 1);
+  assert(stats.safe_frame_count == 2);
+  assert(stats.last_stall_start_nsec == heartbeat);
+  assert(bus_output(vbus) == 0);
+
+  MSG("Resuming the cycle without losing its frame");
+  jsd_bus_metrics_t metrics = jsd_get_bus_metrics(jsd);
+  jsd_read(jsd, EC_TIMEOUTRET);
+  assert(jsd->wkc == jsd->expected_wkc);
+  cycle(jsd);
+  assert(bus_output(vbus) == command);
+  assert(jsd_get_bus_metrics(jsd).lost_frames == metrics.lost_frames);
+  assert(jsd_get_bus_metrics(jsd).bad_wkc_cycles == metrics.bad_wkc_cycles);
+
+  int64_t resumed = jsd->watchdog.heartbeat_nsec;
+  jsd_watchdog_check(jsd, resumed);
+  stats = jsd_watchdog_get_stats(jsd);
+  assert(!stats.stalled);
+  assert(stats.stall_count == 1);
+  assert(stats.safe_frame_count == 2);
+  assert(stats.last_stall_duration_nsec == resumed - heartbeat);
+  assert(stats.max_stall_duration_nsec == stats.last_stall_duration_nsec);
+
+  MSG("Stalling between jsd_read and jsd_write");
+  jsd_watchdog_check(jsd, resumed + TEST_TIMEOUT_NSEC + 1);
+  assert(jsd_watchdog_get_stats(jsd).safe_frame_count == 3);
+  assert(bus_output(vbus) == 0);
+
+  // The safe values only went out in the watchdog frame
+  jsd_write(jsd);
+  jsd_read(jsd, EC_TIMEOUTRET);
+  assert(bus_output(vbus) == command);
+  assert(jsd_get_bus_metrics(jsd).lost_frames == metrics.lost_frames);
+
+  jsd_free(jsd);
+  jsd_vbus_free(vbus);
+
+  SUCCESS("jsd_watchdog checks passed");
+  return 0;
+}
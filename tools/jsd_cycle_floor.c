@@ -0,0 +1,347 @@
+/**
+ * @file jsd_cycle_floor.c
+ * @brief Characterizes the bus round-trip time and the shortest stable cycle
+ *
+ * Usage: jsd_cycle_floor <ifname> [-n samples] [-p period_us] [-m margin]
+ *                        [-c cpu] [-r] [-o baseline.csv]
+ *
+ * The bus is brought up with no device configured, so every slave runs its
+ * default mapping with zero outputs. The tool then measures:
+ *   1. the round-trip time of broadcast read datagrams of increasing size,
+ *      fitted to a fixed cost plus a cost per byte,
+ *   2. the round-trip time of the process data frame(s) of the mapped IOmap,
+ *      ecx_send_overlap_processdata(...) to ecx_receive_processdata(...),
+ *   3. how late jsd_timer_process(...) wakes the loop up at the given period.
+ *
+ * The cycle floor is the worst process data round-trip plus the worst wakeup
+ * latency, scaled by the margin. Below it the frame sent in one cycle may not
+ * be back by the next jsd_read(...). The results can be written as CSV and
+ * kept as the performance baseline of the installation.
+ */
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "jsd/jsd.h"
+#include "jsd/jsd_time.h"
+#include "jsd/jsd_timer.h"
+
+#define FLOOR_DEFAULT_SAMPLES (10000)
+#define FLOOR_DEFAULT_PERIOD_USEC (1000)
+#define FLOOR_DEFAULT_MARGIN (1.25)
+#define FLOOR_MAX_DATAGRAM_BYTES (1486)  ///< largest single datagram payload
+
+static const uint16_t floor_datagram_bytes[] = {
+    16, 64, 128, 256, 512, 1024, FLOOR_MAX_DATAGRAM_BYTES};
+#define FLOOR_NUM_DATAGRAMS \
+  (sizeof(floor_datagram_bytes) / sizeof(floor_datagram_bytes[0]))
+
+typedef struct {
+  double   min_usec;
+  double   p50_usec;
+  double   p99_usec;
+  double   p999_usec;
+  double   max_usec;
+  uint32_t errors;  ///< samples lost or with an unexpected working counter
+} floor_stats_t;
+
+static int floor_compare(const void* a, const void* b) {
+  int64_t ia = *(const int64_t*)a;
+  int64_t ib = *(const int64_t*)b;
+  return (ia > ib) - (ia < ib);
+}
+
+static void floor_summarize(int64_t* nsec, uint32_t count,
+                            floor_stats_t* stats) {
+  if (count == 0) {
+    return;
+  }
+  qsort(nsec, count, sizeof(int64_t), floor_compare);
+  stats->min_usec  = nsec[0] / 1e3;
+  stats->p50_usec  = nsec[(count - 1) / 2] / 1e3;
+  stats->p99_usec  = nsec[(uint64_t)(count - 1) * 99 / 100] / 1e3;
+  stats->p999_usec = nsec[(uint64_t)(count - 1) * 999 / 1000] / 1e3;
+  stats->max_usec  = nsec[count - 1] / 1e3;
+}
+
+static void floor_print(const char* name, const floor_stats_t* stats) {
+  MSG("  %-24s min %8.1f  p50 %8.1f  p99 %8.1f  p99.9 %8.1f  max %8.1f us"
+      "  (%u errors)",
+      name, stats->min_usec, stats->p50_usec, stats->p99_usec,
+      stats->p999_usec, stats->max_usec, stats->errors);
+}
+
+static void floor_write(FILE* file, const char* metric, double value,
+                        const char* unit) {
+  if (file) {
+    fprintf(file, "%s,%.3f,%s\n", metric, value, unit);
+  }
+}
+
+static void floor_write_stats(FILE* file, const char* name,
+                              const floor_stats_t* stats) {
+  char metric[64];
+  snprintf(metric, sizeof(metric), "%s_p50", name);
+  floor_write(file, metric, stats->p50_usec, "us");
+  snprintf(metric, sizeof(metric), "%s_p99", name);
+  floor_write(file, metric, stats->p99_usec, "us");
+  snprintf(metric, sizeof(metric), "%s_p999", name);
+  floor_write(file, metric, stats->p999_usec, "us");
+  snprintf(metric, sizeof(metric), "%s_max", name);
+  floor_write(file, metric, stats->max_usec, "us");
+  snprintf(metric, sizeof(metric), "%s_errors", name);
+  floor_write(file, metric, stats->errors, "count");
+}
+
+/**
+ * @brief Times back to back broadcast reads of the ESC registers, every slave
+ *        increments the working counter
+ */
+static void floor_measure_datagram(jsd_t* jsd, uint16_t bytes, int64_t* nsec,
+                                   uint32_t samples, floor_stats_t* stats) {
+  static uint8_t data[FLOOR_MAX_DATAGRAM_BYTES];
+  uint32_t       count = 0;
+  uint32_t       i;
+
+  memset(stats, 0, sizeof(*stats));
+  for (i = 0; i < samples; ++i) {
+    int64_t start = jsd_time_get_mono_time_nsec();
+    int     wkc = ecx_BRD(jsd->ecx_context.port, 0x0000, ECT_REG_TYPE, bytes,
+                          data, EC_TIMEOUTRET);
+    int64_t end = jsd_time_get_mono_time_nsec();
+    if (wkc != *jsd->ecx_context.slavecount) {
+      ++stats->errors;
+      continue;
+    }
+    nsec[count++] = end - start;
+  }
+  floor_summarize(nsec, count, stats);
+}
+
+static void floor_measure_processdata(jsd_t* jsd, int64_t* nsec,
+                                      uint32_t samples, floor_stats_t* stats) {
+  uint32_t count = 0;
+  uint32_t i;
+
+  memset(stats, 0, sizeof(*stats));
+  for (i = 0; i < samples; ++i) {
+    int64_t start = jsd_time_get_mono_time_nsec();
+    ecx_send_overlap_processdata(&jsd->ecx_context);
+    int     wkc = ecx_receive_processdata(&jsd->ecx_context, EC_TIMEOUTRET);
+    int64_t end = jsd_time_get_mono_time_nsec();
+    if (wkc != jsd->expected_wkc) {
+      ++stats->errors;
+      continue;
+    }
+    nsec[count++] = end - start;
+  }
+  floor_summarize(nsec, count, stats);
+}
+
+/**
+ * @brief Runs the bus at the given period and records how long after the
+ *        scheduled time each cycle starts
+ */
+static bool floor_measure_wakeup(jsd_t* jsd, uint32_t period_usec, int16_t cpu,
+                                 bool use_rt, int64_t* nsec, uint32_t samples,
+                                 floor_stats_t* stats) {
+  uint32_t i;
+
+  memset(stats, 0, sizeof(*stats));
+  jsd_timer_t* timer = jsd_timer_alloc();
+  if (jsd_timer_init_ex(timer, period_usec * 1000, cpu, use_rt, use_rt) != 0) {
+    ERROR("Could not start a %u us loop timer", period_usec);
+    jsd_timer_free(timer);
+    return false;
+  }
+
+  for (i = 0; i < samples; ++i) {
+    jsd_read(jsd, EC_TIMEOUTRET);
+    if (jsd->wkc != jsd->expected_wkc) {
+      ++stats->errors;
+    }
+    jsd_write(jsd);
+    if (jsd_timer_process(timer) != 0) {
+      ++stats->errors;
+    }
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    nsec[i] = (now.tv_sec - timer->last_loop_time.tv_sec) *
+                  JSD_TIME_NSEC_PER_SEC +
+              (now.tv_nsec - timer->last_loop_time.tv_nsec);
+  }
+  jsd_timer_free(timer);
+
+  floor_summarize(nsec, samples, stats);
+  return true;
+}
+
+static void floor_usage(const char* name) {
+  MSG("Usage: %s <ifname> [-n samples] [-p period_us] [-m margin] [-c cpu] "
+      "[-r] [-o baseline.csv]",
+      name);
+  MSG("Example: $ %s eth0 -n 100000 -p 500 -c 2 -r -o baseline.csv", name);
+}
+
+int main(int argc, char* argv[]) {
+  uint32_t    samples     = FLOOR_DEFAULT_SAMPLES;
+  uint32_t    period_usec = FLOOR_DEFAULT_PERIOD_USEC;
+  double      margin      = FLOOR_DEFAULT_MARGIN;
+  int16_t     cpu         = JSD_TIMER_ANY_CPU;
+  bool        use_rt      = false;
+  const char* filename    = NULL;
+  FILE*       file        = NULL;
+  int         opt;
+  uint32_t    i;
+
+  while ((opt = getopt(argc, argv, "n:p:m:c:ro:h")) != -1) {
+    switch (opt) {
+      case 'n':
+        samples = strtoul(optarg, NULL, 0);
+        break;
+      case 'p':
+        period_usec = strtoul(optarg, NULL, 0);
+        break;
+      case 'm':
+        margin = strtod(optarg, NULL);
+        break;
+      case 'c':
+        cpu = atoi(optarg);
+        break;
+      case 'r':
+        use_rt = true;
+        break;
+      case 'o':
+        filename = optarg;
+        break;
+      default:
+        floor_usage(argv[0]);
+        return opt == 'h' ? 0 : 1;
+    }
+  }
+  if (argc - optind != 1) {
+    ERROR("Expecting exactly 1 positional argument");
+    floor_usage(argv[0]);
+    return 1;
+  }
+  if (samples == 0 || period_usec == 0 || margin < 1.0) {
+    ERROR("Samples and period must be positive, margin at least 1.0");
+    return 1;
+  }
+
+  if (filename) {
+    file = fopen(filename, "w");
+    if (!file) {
+      ERROR("Could not open %s", filename);
+      return 1;
+    }
+    fprintf(file, "metric,value,unit\n");
+  }
+
+  // No slave is configured: default mappings, zero outputs
+  jsd_t* jsd = jsd_alloc();
+  if (!jsd_init(jsd, argv[optind], 0)) {
+    ERROR("Could not init jsd on %s", argv[optind]);
+    jsd_free(jsd);
+    if (file) {
+      fclose(file);
+    }
+    return 1;
+  }
+
+  int64_t*   nsec       = (int64_t*)calloc(samples, sizeof(int64_t));
+  ec_groupt* group      = &jsd->ecx_context.grouplist[0];
+  int        num_slaves = *jsd->ecx_context.slavecount;
+  ec_slavet* last       = &jsd->ecx_context.slavelist[num_slaves];
+
+  MSG("Bus: %d slaves, IOmap %u output bytes, %u input bytes in %u frame(s)",
+      num_slaves, group->Obytes, group->Ibytes, group->nsegments);
+  if (group->hasdc) {
+    MSG("  propagation delay to the last slave: %.3f us", last->pdelay / 1e3);
+  }
+  floor_write(file, "slaves", num_slaves, "count");
+  floor_write(file, "iomap_output_bytes", group->Obytes, "bytes");
+  floor_write(file, "iomap_input_bytes", group->Ibytes, "bytes");
+  floor_write(file, "iomap_frames", group->nsegments, "count");
+  floor_write(file, "propagation_delay", group->hasdc ? last->pdelay / 1e3 : 0,
+              "us");
+
+  // Least squares fit of the median round-trip against the datagram size,
+  // over the sizes that returned at least one sample
+  MSG("Broadcast read round-trip vs datagram size:");
+  double   sum_x = 0, sum_y = 0, sum_xx = 0, sum_xy = 0;
+  uint32_t num_points = 0;
+  for (i = 0; i < FLOOR_NUM_DATAGRAMS; ++i) {
+    floor_stats_t stats;
+    char          name[32];
+    snprintf(name, sizeof(name), "brd_%u_bytes", floor_datagram_bytes[i]);
+    floor_measure_datagram(jsd, floor_datagram_bytes[i], nsec, samples,
+                           &stats);
+    floor_print(name, &stats);
+    floor_write_stats(file, name, &stats);
+    if (stats.errors == samples) {
+      continue;
+    }
+
+    ++num_points;
+    sum_x += floor_datagram_bytes[i];
+    sum_y += stats.p50_usec;
+    sum_xx += (double)floor_datagram_bytes[i] * floor_datagram_bytes[i];
+    sum_xy += floor_datagram_bytes[i] * stats.p50_usec;
+  }
+  if (num_points >= 2) {
+    double n = num_points;
+    double per_byte =
+        (n * sum_xy - sum_x * sum_y) / (n * sum_xx - sum_x * sum_x);
+    double fixed = (sum_y - per_byte * sum_x) / n;
+    MSG("  fit: %.2f us + %.2f ns/byte over %u sizes", fixed, per_byte * 1e3,
+        num_points);
+    floor_write(file, "brd_fixed", fixed, "us");
+    floor_write(file, "brd_per_byte", per_byte * 1e3, "ns");
+  } else {
+    WARNING("Too few datagram sizes returned samples to fit (%u)",
+            num_points);
+  }
+
+  floor_stats_t pd_stats;
+  floor_measure_processdata(jsd, nsec, samples, &pd_stats);
+  MSG("Process data round-trip:");
+  floor_print("processdata", &pd_stats);
+  floor_write_stats(file, "processdata", &pd_stats);
+
+  floor_stats_t wakeup_stats;
+  MSG("Wakeup latency at a %u us period:", period_usec);
+  if (!floor_measure_wakeup(jsd, period_usec, cpu, use_rt, nsec, samples,
+                            &wakeup_stats)) {
+    free(nsec);
+    jsd_free(jsd);
+    if (file) {
+      fclose(file);
+    }
+    return 1;
+  }
+  floor_print("wakeup", &wakeup_stats);
+  floor_write_stats(file, "wakeup", &wakeup_stats);
+
+  double floor_usec = (pd_stats.max_usec + wakeup_stats.max_usec) * margin;
+  floor_write(file, "period", period_usec, "us");
+  floor_write(file, "margin", margin, "ratio");
+  floor_write(file, "cycle_floor", floor_usec, "us");
+  SUCCESS("Minimum stable cycle period: %.1f us (%.0f Hz) with a %.2f margin",
+          floor_usec, 1e6 / floor_usec, margin);
+  if (floor_usec > period_usec) {
+    WARNING("The %u us test period is below the cycle floor", period_usec);
+  }
+  if (pd_stats.errors > 0 || wakeup_stats.errors > 0) {
+    WARNING("Frames were lost or cycles overran, the floor is optimistic");
+  }
+
+  free(nsec);
+  jsd_free(jsd);
+  if (file) {
+    fclose(file);
+  }
+  return 0;
+}
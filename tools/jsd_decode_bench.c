@@ -0,0 +1,321 @@
+/**
+ * @file jsd_decode_bench.c
+ * @brief Measures the read/process cost of each device driver on synthetic
+ *        IOmaps, no NIC or slaves required
+ *
+ * Usage: jsd_decode_bench [-c cycles] [-d device] [-o results.csv]
+ *
+ * For every driver and bus size, the IOmap is laid out like SOEM's (outputs
+ * of all slaves, then inputs) and filled with a synthetic TxPDO. The results
+ * are written as CSV, one row per device, instance count and path:
+ *
+ *   device,instances,path,cycles,ns_per_slave_cycle,misses_per_slave_cycle
+ *
+ * Cache misses come from the PERF_COUNT_HW_CACHE_MISSES hardware counter and
+ * are reported as -1 when perf events are not available (e.g. in containers
+ * or with kernel.perf_event_paranoid > 2).
+ */
+
+#include <assert.h>
+#include <getopt.h>
+#include <linux/perf_event.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "jsd/jsd.h"
+#include "jsd/jsd_ati_fts.h"
+#include "jsd/jsd_ati_fts_pub.h"
+#include "jsd/jsd_egd.h"
+#include "jsd/jsd_el2124.h"
+#include "jsd/jsd_el3104.h"
+#include "jsd/jsd_el3104_pub.h"
+#include "jsd/jsd_el3162.h"
+#include "jsd/jsd_el3162_pub.h"
+#include "jsd/jsd_el3202.h"
+#include "jsd/jsd_el3208.h"
+#include "jsd/jsd_el3318.h"
+#include "jsd/jsd_el3356.h"
+#include "jsd/jsd_el3602.h"
+#include "jsd/jsd_el4102.h"
+#include "jsd/jsd_epd.h"
+#include "jsd/jsd_ild1900.h"
+#include "jsd/jsd_ild1900_pub.h"
+#include "jsd/jsd_jed0101.h"
+#include "jsd/jsd_jed0200.h"
+#include "jsd/jsd_time.h"
+
+#define BENCH_DEFAULT_CYCLES (10000)
+#define BENCH_WARMUP_CYCLES (100)
+
+typedef void (*bench_cyclic_t)(jsd_t* self, uint16_t slave_id);
+
+typedef struct {
+  const char*    name;
+  uint32_t       vendor_id;
+  uint32_t       product_code;
+  uint16_t       ibytes;
+  uint16_t       obytes;
+  bool           (*init)(jsd_t* self, uint16_t slave_id);
+  bench_cyclic_t read;
+  bench_cyclic_t process;
+} bench_device_t;
+
+static const bench_device_t bench_devices[] = {
+    {"el2124", JSD_BECKHOFF_VENDOR_ID, JSD_EL2124_PRODUCT_CODE, 0, 1,
+     jsd_el2124_init, NULL, jsd_el2124_process},
+    {"el3104", JSD_BECKHOFF_VENDOR_ID, JSD_EL3104_PRODUCT_CODE,
+     sizeof(jsd_el3104_txpdo_t), 0, jsd_el3104_init, jsd_el3104_read, NULL},
+    {"el3162", JSD_BECKHOFF_VENDOR_ID, JSD_EL3162_PRODUCT_CODE,
+     sizeof(jsd_el3162_txpdo_t), 0, jsd_el3162_init, jsd_el3162_read, NULL},
+    {"el3202", JSD_BECKHOFF_VENDOR_ID, JSD_EL3202_PRODUCT_CODE,
+     sizeof(jsd_el3202_txpdo_t), 0, jsd_el3202_init, jsd_el3202_read, NULL},
+    {"el3208", JSD_BECKHOFF_VENDOR_ID, JSD_EL3208_PRODUCT_CODE,
+     sizeof(jsd_el3208_txpdo_t), 0, jsd_el3208_init, jsd_el3208_read, NULL},
+    {"el3318", JSD_BECKHOFF_VENDOR_ID, JSD_EL3318_PRODUCT_CODE,
+     sizeof(jsd_el3318_txpdo_t), 0, jsd_el3318_init, jsd_el3318_read, NULL},
+    {"el3356", JSD_BECKHOFF_VENDOR_ID, JSD_EL3356_PRODUCT_CODE,
+     sizeof(jsd_el3356_txpdo_t), sizeof(jsd_el3356_rxpdo_t), jsd_el3356_init,
+     jsd_el3356_read, jsd_el3356_process},
+    {"el3602", JSD_BECKHOFF_VENDOR_ID, JSD_EL3602_PRODUCT_CODE,
+     sizeof(jsd_el3602_txpdo_t), 0, jsd_el3602_init, jsd_el3602_read, NULL},
+    {"el4102", JSD_BECKHOFF_VENDOR_ID, JSD_EL4102_PRODUCT_CODE, 0,
+     sizeof(jsd_el4102_rxpdo_t), jsd_el4102_init, NULL, jsd_el4102_process},
+    {"ati_fts", JSD_ATI_VENDOR_ID, JSD_ATI_FTS_PRODUCT_CODE,
+     sizeof(jsd_ati_fts_txpdo_t), sizeof(jsd_ati_fts_rxpdo_t),
+     jsd_ati_fts_init, jsd_ati_fts_read, jsd_ati_fts_process},
+    {"ild1900", JSD_MICROEPSILON_VENDOR_ID, JSD_ILD1900_PRODUCT_CODE,
+     sizeof(jsd_ild1900_txpdo_t), 0, jsd_ild1900_init, jsd_ild1900_read, NULL},
+    {"jed0101", JSD_JPL_VENDOR_ID, JSD_JED0101_PRODUCT_CODE,
+     sizeof(jsd_jed0101_txpdo_t), sizeof(jsd_jed0101_rxpdo_t),
+     jsd_jed0101_init, jsd_jed0101_read, jsd_jed0101_process},
+    {"jed0200", JSD_JPL_VENDOR_ID, JSD_JED0200_PRODUCT_CODE,
+     sizeof(jsd_jed0200_txpdo_t), sizeof(jsd_jed0200_rxpdo_t),
+     jsd_jed0200_init, jsd_jed0200_read, jsd_jed0200_process},
+    {"epd", JSD_ELMO_VENDOR_ID, JSD_EPD_PRODUCT_CODE,
+     sizeof(jsd_epd_txpdo_data_t), sizeof(jsd_epd_rxpdo_data_t), jsd_epd_init,
+     jsd_epd_read, jsd_epd_process},
+    {"egd", JSD_ELMO_VENDOR_ID, JSD_EGD_PRODUCT_CODE,
+     sizeof(jsd_egd_txpdo_data_t), sizeof(jsd_egd_rxpdo_data_cs_mode_t),
+     jsd_egd_init, jsd_egd_read, jsd_egd_process},
+};
+
+static const uint16_t bench_instances[] = {1, 10, 100};
+
+/**
+ * @brief Configuration the drivers read in their cyclic paths, normally
+ *        provided by the application or read from the slave during init
+ */
+static void bench_configure(jsd_t* jsd, uint16_t slave_id,
+                            const bench_device_t* device) {
+  jsd_slave_config_t* config = &jsd->slave_configs[slave_id];
+  config->product_code       = device->product_code;
+
+  switch (device->product_code) {
+    case JSD_ATI_FTS_PRODUCT_CODE:
+      config->ati_fts.counts_per_force  = 1000000;
+      config->ati_fts.counts_per_torque = 1000000;
+      break;
+    case JSD_EL3356_PRODUCT_CODE:
+      config->el3356.scale_factor = 1.0;
+      break;
+    case JSD_EPD_PRODUCT_CODE:
+      config->epd.continuous_current_limit = 1.0;
+      config->epd.peak_current_limit       = 2.0;
+      break;
+    case JSD_EGD_PRODUCT_CODE:
+      config->egd.drive_cmd_mode           = JSD_EGD_DRIVE_CMD_MODE_CS;
+      config->egd.continuous_current_limit = 1.0;
+      config->egd.peak_current_limit       = 2.0;
+      break;
+    default:
+      break;
+  }
+}
+
+/**
+ * @brief Synthetic TxPDO: a per-slave byte pattern, with Elmo drives held in
+ *        OPERATION ENABLED so the steady-state path is measured
+ */
+static void bench_fill_inputs(uint8_t* inputs, uint16_t slave_id,
+                              const bench_device_t* device) {
+  uint16_t i;
+  for (i = 0; i < device->ibytes; ++i) {
+    inputs[i] = (uint8_t)(slave_id * 31 + i * 7);
+  }
+
+  // Servo enabled, motor on and STO released
+  uint16_t statusword = JSD_ELMO_STATE_MACHINE_STATE_OPERATION_ENABLED;
+  uint32_t status_register;
+  if (device->product_code == JSD_EPD_PRODUCT_CODE) {
+    status_register = (0x01 << 4) | (0x01 << 22) | (0x03 << 25);
+    memcpy(inputs + offsetof(jsd_epd_txpdo_data_t, status_register_1),
+           &status_register, sizeof(status_register));
+    memcpy(inputs + offsetof(jsd_epd_txpdo_data_t, statusword), &statusword,
+           sizeof(statusword));
+  } else if (device->product_code == JSD_EGD_PRODUCT_CODE) {
+    status_register = (0x01 << 4) | (0x01 << 14) | (0x01 << 22);
+    memcpy(inputs + offsetof(jsd_egd_txpdo_data_t, status_register),
+           &status_register, sizeof(status_register));
+    memcpy(inputs + offsetof(jsd_egd_txpdo_data_t, statusword), &statusword,
+           sizeof(statusword));
+  }
+}
+
+static int bench_counter_open() {
+  struct perf_event_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.type           = PERF_TYPE_HARDWARE;
+  attr.size           = sizeof(attr);
+  attr.config         = PERF_COUNT_HW_CACHE_MISSES;
+  attr.disabled       = 1;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv     = 1;
+  return (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+static void bench_run(jsd_t* jsd, bench_cyclic_t fcn, uint16_t instances,
+                      uint32_t cycles) {
+  uint32_t c;
+  uint16_t slave_id;
+  for (c = 0; c < cycles; ++c) {
+    for (slave_id = 1; slave_id <= instances; ++slave_id) {
+      fcn(jsd, slave_id);
+    }
+  }
+}
+
+static void bench_measure(FILE* out, int counter, jsd_t* jsd,
+                          const bench_device_t* device, const char* path,
+                          bench_cyclic_t fcn, uint16_t instances,
+                          uint32_t cycles) {
+  if (!fcn) {
+    return;
+  }
+  bench_run(jsd, fcn, instances, BENCH_WARMUP_CYCLES);
+
+  if (counter >= 0) {
+    ioctl(counter, PERF_EVENT_IOC_RESET, 0);
+    ioctl(counter, PERF_EVENT_IOC_ENABLE, 0);
+  }
+  int64_t start = jsd_time_get_mono_time_nsec();
+  bench_run(jsd, fcn, instances, cycles);
+  int64_t elapsed = jsd_time_get_mono_time_nsec() - start;
+
+  double   per_slave_cycle = (double)instances * cycles;
+  double   misses          = -1.0;
+  uint64_t count;
+  if (counter >= 0) {
+    ioctl(counter, PERF_EVENT_IOC_DISABLE, 0);
+    if (read(counter, &count, sizeof(count)) == sizeof(count)) {
+      misses = count / per_slave_cycle;
+    }
+  }
+
+  fprintf(out, "%s,%u,%s,%u,%.2f,%.4f\n", device->name, instances, path,
+          cycles, elapsed / per_slave_cycle, misses);
+}
+
+static void bench_device(FILE* out, int counter, const bench_device_t* device,
+                         uint16_t instances, uint32_t cycles) {
+  jsd_t*   jsd = jsd_alloc();
+  uint8_t* iomap =
+      (uint8_t*)calloc(instances, device->ibytes + device->obytes);
+  uint8_t* outputs = iomap;
+  uint8_t* inputs  = iomap + (size_t)instances * device->obytes;
+  uint16_t slave_id;
+
+  for (slave_id = 1; slave_id <= instances; ++slave_id) {
+    ec_slavet* slave = &jsd->ecx_context.slavelist[slave_id];
+    slave->eep_man   = device->vendor_id;
+    slave->eep_id    = device->product_code;
+    slave->Obytes    = device->obytes;
+    slave->Ibytes    = device->ibytes;
+    slave->outputs   = outputs + (size_t)(slave_id - 1) * device->obytes;
+    slave->inputs    = inputs + (size_t)(slave_id - 1) * device->ibytes;
+    bench_fill_inputs(slave->inputs, slave_id, device);
+    bench_configure(jsd, slave_id, device);
+    if (!device->init(jsd, slave_id)) {
+      ERROR("Could not initialize %s[%u]", device->name, slave_id);
+      assert(0);
+    }
+  }
+
+  bench_measure(out, counter, jsd, device, "read", device->read, instances,
+                cycles);
+  bench_measure(out, counter, jsd, device, "process", device->process,
+                instances, cycles);
+
+  free(iomap);
+  jsd_free(jsd);
+}
+
+int main(int argc, char* argv[]) {
+  uint32_t    cycles = BENCH_DEFAULT_CYCLES;
+  const char* filter = NULL;
+  const char* output = NULL;
+  int         opt;
+
+  while ((opt = getopt(argc, argv, "c:d:o:h")) != -1) {
+    switch (opt) {
+      case 'c':
+        cycles = strtoul(optarg, NULL, 0);
+        break;
+      case 'd':
+        filter = optarg;
+        break;
+      case 'o':
+        output = optarg;
+        break;
+      default:
+        printf("Usage: %s [-c cycles] [-d device] [-o results.csv]\n",
+               argv[0]);
+        return opt == 'h' ? 0 : 1;
+    }
+  }
+  if (cycles == 0) {
+    ERROR("Number of cycles must be positive");
+    return 1;
+  }
+
+  FILE* out = stdout;
+  if (output && !(out = fopen(output, "w"))) {
+    ERROR("Could not open %s", output);
+    return 1;
+  }
+
+  int counter = bench_counter_open();
+  if (counter < 0) {
+    WARNING("Hardware cache miss counter unavailable, reporting -1");
+  }
+
+  fprintf(out,
+          "device,instances,path,cycles,ns_per_slave_cycle,"
+          "misses_per_slave_cycle\n");
+
+  size_t d, n;
+  for (d = 0; d < sizeof(bench_devices) / sizeof(bench_devices[0]); ++d) {
+    const bench_device_t* device = &bench_devices[d];
+    if (filter && strcmp(filter, device->name) != 0) {
+      continue;
+    }
+    for (n = 0; n < sizeof(bench_instances) / sizeof(bench_instances[0]);
+         ++n) {
+      assert(bench_instances[n] < EC_MAXSLAVE);
+      bench_device(out, counter, device, bench_instances[n], cycles);
+      fflush(out);
+    }
+  }
+
+  if (counter >= 0) {
+    close(counter);
+  }
+  if (out != stdout) {
+    fclose(out);
+    SUCCESS("Results written to %s", output);
+  }
+  return 0;
+}
@@ -0,0 +1,365 @@
+/**
+ * @file jsd_fault_bench.c
+ * @brief Measures autorecovery time and cycle disturbance on a virtual bus
+ *
+ * Usage: jsd_fault_bench [-s scenario] [-p period_us] [-t timeout_ms]
+ *                        [-o results.csv]
+ *
+ * Runs the cyclic loop with autorecovery against a virtual EL3602, EL2124 and
+ * simulated EPD, injects each scripted fault scenario and reports:
+ *   - the recovery time, from the injection to the first of
+ *     FAULT_BENCH_NOMINAL_CYCLES cycles with the expected working counter,
+ *     every slave in OP and the EPD out of FAULT,
+ *   - the cycles with a bad working counter and the overrunning cycles,
+ *   - the longest jsd_read(...) to jsd_write(...) time against the baseline
+ *     measured before the injection, most of which is spent in
+ *     jsd_ecatcheck(...) reacquiring, acknowledging or reconfiguring slaves.
+ *
+ * No NIC, slaves or root privileges are needed.
+ */
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "jsd/jsd.h"
+#include "jsd/jsd_el2124_pub.h"
+#include "jsd/jsd_el3602_pub.h"
+#include "jsd/jsd_epd_pub.h"
+#include "jsd/jsd_time.h"
+#include "jsd/jsd_timer.h"
+#include "jsd/jsd_vbus_drive_pub.h"
+#include "jsd/jsd_vbus_pub.h"
+
+#define FAULT_BENCH_DEFAULT_PERIOD_USEC (1000)
+#define FAULT_BENCH_DEFAULT_TIMEOUT_MSEC (10000)
+#define FAULT_BENCH_BASELINE_CYCLES (1000)
+#define FAULT_BENCH_NOMINAL_CYCLES (10)
+#define FAULT_BENCH_MAX_SCRIPT_FAULTS (4)
+
+#define FAULT_BENCH_EL3602_ID (1)
+#define FAULT_BENCH_EL2124_ID (2)
+#define FAULT_BENCH_EPD_ID (3)
+#define FAULT_BENCH_NUM_SLAVES (3)
+
+typedef struct {
+  const char*      name;
+  jsd_vbus_fault_t faults[FAULT_BENCH_MAX_SCRIPT_FAULTS];
+  uint8_t          num_faults;
+  uint16_t         drive_emcy_code;  ///< drive fault at injection, 0 for none
+} fault_scenario_t;
+
+static const fault_scenario_t fault_scenarios[] = {
+    {"drop-1", {{JSD_VBUS_FAULT_DROP_FRAME, 0, 0, 1}}, 1, 0},
+    {"drop-burst", {{JSD_VBUS_FAULT_DROP_FRAME, 0, 0, 20}}, 1, 0},
+    {"corrupt-wkc",
+     {{JSD_VBUS_FAULT_CORRUPT_WKC, FAULT_BENCH_EL3602_ID, 0, 5}},
+     1,
+     0},
+    {"safe-op-error",
+     {{JSD_VBUS_FAULT_SAFE_OP_ERROR, FAULT_BENCH_EL3602_ID, 0, 1}},
+     1,
+     0},
+    {"slave-lost",
+     {{JSD_VBUS_FAULT_SLAVE_LOST, FAULT_BENCH_EL2124_ID, 0, 200}},
+     1,
+     0},
+    {"drive-lost-mailbox-timeout",
+     {{JSD_VBUS_FAULT_SLAVE_LOST, FAULT_BENCH_EPD_ID, 0, 200},
+      {JSD_VBUS_FAULT_MAILBOX_TIMEOUT, FAULT_BENCH_EPD_ID, 200, 1000}},
+     2,
+     0},
+    {"delayed-emcy",
+     {{JSD_VBUS_FAULT_DELAY_EMCY, FAULT_BENCH_EPD_ID, 0, 500}},
+     1,
+     0x7121},
+};
+#define FAULT_BENCH_NUM_SCENARIOS \
+  (sizeof(fault_scenarios) / sizeof(fault_scenarios[0]))
+
+typedef struct {
+  bool     recovered;
+  uint32_t recovery_cycles;
+  double   recovery_msec;
+  uint32_t bad_wkc_cycles;
+  uint32_t overruns;
+  double   baseline_p50_usec;
+  double   baseline_max_usec;
+  double   max_cycle_usec;  ///< longest read to write time after injection
+} fault_result_t;
+
+typedef struct {
+  jsd_t*           jsd;
+  jsd_vbus_t*      vbus;
+  jsd_vbus_drive_t drive;
+  jsd_timer_t*     timer;
+  uint32_t         period_usec;
+  uint32_t         timeout_cycles;
+} fault_bench_t;
+
+static int fault_compare(const void* a, const void* b) {
+  int64_t ia = *(const int64_t*)a;
+  int64_t ib = *(const int64_t*)b;
+  return (ia > ib) - (ia < ib);
+}
+
+/**
+ * @brief One control cycle, returns the time from jsd_read(...) to the end of
+ *        jsd_write(...)
+ */
+static int64_t fault_cycle(fault_bench_t* self) {
+  int64_t start = jsd_time_get_mono_time_nsec();
+
+  jsd_read(self->jsd, EC_TIMEOUTRET);
+  jsd_el3602_read(self->jsd, FAULT_BENCH_EL3602_ID);
+  jsd_epd_read(self->jsd, FAULT_BENCH_EPD_ID);
+
+  jsd_el2124_process(self->jsd, FAULT_BENCH_EL2124_ID);
+  jsd_epd_process(self->jsd, FAULT_BENCH_EPD_ID);
+  jsd_write(self->jsd);
+
+  int64_t work = jsd_time_get_mono_time_nsec() - start;
+  jsd_timer_process(self->timer);
+  return work;
+}
+
+static bool fault_nominal(fault_bench_t* self) {
+  uint16_t slave_id;
+
+  if (self->jsd->wkc != self->jsd->expected_wkc ||
+      jsd_vbus_get_num_faults(self->vbus) > 0) {
+    return false;
+  }
+  for (slave_id = 1; slave_id <= FAULT_BENCH_NUM_SLAVES; ++slave_id) {
+    if (jsd_vbus_get_slave_state(self->vbus, slave_id) !=
+        EC_STATE_OPERATIONAL) {
+      return false;
+    }
+  }
+  jsd_elmo_state_machine_state_t state =
+      jsd_epd_get_state(self->jsd, FAULT_BENCH_EPD_ID)
+          ->actual_state_machine_state;
+  return state != JSD_ELMO_STATE_MACHINE_STATE_FAULT &&
+         state != JSD_ELMO_STATE_MACHINE_STATE_FAULT_REACTION_ACTIVE;
+}
+
+/**
+ * @brief Cycles until FAULT_BENCH_NOMINAL_CYCLES nominal cycles in a row
+ *
+ * @return cycles run until the first of them, -1 on timeout
+ */
+static int64_t fault_settle(fault_bench_t* self, fault_result_t* result) {
+  int64_t  period_nsec = (int64_t)self->period_usec * JSD_TIME_NSEC_PER_USEC;
+  uint32_t nominal     = 0;
+  uint32_t cycle;
+
+  for (cycle = 0; cycle < self->timeout_cycles; ++cycle) {
+    int64_t work = fault_cycle(self);
+    if (result) {
+      if (self->jsd->wkc != self->jsd->expected_wkc) {
+        ++result->bad_wkc_cycles;
+      }
+      if (work > period_nsec) {
+        ++result->overruns;
+      }
+      if (work / 1e3 > result->max_cycle_usec) {
+        result->max_cycle_usec = work / 1e3;
+      }
+    }
+    nominal = fault_nominal(self) ? nominal + 1 : 0;
+    if (nominal == FAULT_BENCH_NOMINAL_CYCLES) {
+      return cycle + 1 - FAULT_BENCH_NOMINAL_CYCLES;
+    }
+  }
+  return -1;
+}
+
+static void fault_run(fault_bench_t* self, const fault_scenario_t* scenario,
+                      fault_result_t* result) {
+  static int64_t baseline[FAULT_BENCH_BASELINE_CYCLES];
+  uint32_t       i;
+
+  memset(result, 0, sizeof(*result));
+  for (i = 0; i < FAULT_BENCH_BASELINE_CYCLES; ++i) {
+    baseline[i] = fault_cycle(self);
+  }
+  qsort(baseline, FAULT_BENCH_BASELINE_CYCLES, sizeof(int64_t), fault_compare);
+  result->baseline_p50_usec = baseline[FAULT_BENCH_BASELINE_CYCLES / 2] / 1e3;
+  result->baseline_max_usec = baseline[FAULT_BENCH_BASELINE_CYCLES - 1] / 1e3;
+
+  int64_t start = jsd_time_get_mono_time_nsec();
+  if (scenario->drive_emcy_code != 0) {
+    jsd_vbus_drive_inject_fault(&self->drive, scenario->drive_emcy_code);
+  }
+  for (i = 0; i < scenario->num_faults; ++i) {
+    jsd_vbus_inject_fault(self->vbus, scenario->faults[i]);
+  }
+
+  int64_t cycles = fault_settle(self, result);
+  if (cycles < 0) {
+    jsd_vbus_clear_faults(self->vbus);
+    return;
+  }
+  result->recovered       = true;
+  result->recovery_cycles = cycles;
+  result->recovery_msec =
+      (jsd_time_get_mono_time_nsec() - start) / 1e6 -
+      FAULT_BENCH_NOMINAL_CYCLES * self->period_usec / 1e3;
+}
+
+static void fault_configure(jsd_t* jsd) {
+  jsd_slave_config_t config = {0};
+
+  config.configuration_active = true;
+  config.product_code         = JSD_EL3602_PRODUCT_CODE;
+  jsd_set_slave_config(jsd, FAULT_BENCH_EL3602_ID, config);
+
+  memset(&config, 0, sizeof(config));
+  config.configuration_active = true;
+  config.product_code         = JSD_EL2124_PRODUCT_CODE;
+  jsd_set_slave_config(jsd, FAULT_BENCH_EL2124_ID, config);
+
+  memset(&config, 0, sizeof(config));
+  config.configuration_active          = true;
+  config.product_code                  = JSD_EPD_PRODUCT_CODE;
+  config.epd.loop_period_ms            = 1;
+  config.epd.torque_slope              = 1e7;
+  config.epd.max_profile_accel         = 1e6;
+  config.epd.max_profile_decel         = 1e7;
+  config.epd.velocity_tracking_error   = 1e8;
+  config.epd.position_tracking_error   = 1e9;
+  config.epd.peak_current_limit        = 2.0;
+  config.epd.peak_current_time         = 1.0f;
+  config.epd.continuous_current_limit  = 1.0;
+  config.epd.ctrl_gain_scheduling_mode =
+      JSD_ELMO_GAIN_SCHEDULING_MODE_PRELOADED;
+  jsd_set_slave_config(jsd, FAULT_BENCH_EPD_ID, config);
+}
+
+static void fault_usage(const char* name) {
+  uint32_t i;
+  MSG("Usage: %s [-s scenario] [-p period_us] [-t timeout_ms] "
+      "[-o results.csv]",
+      name);
+  for (i = 0; i < FAULT_BENCH_NUM_SCENARIOS; ++i) {
+    MSG("  scenario: %s", fault_scenarios[i].name);
+  }
+}
+
+int main(int argc, char* argv[]) {
+  fault_bench_t self       = {0};
+  const char*   only       = NULL;
+  const char*   filename   = NULL;
+  FILE*         file       = NULL;
+  uint32_t      timeout_ms = FAULT_BENCH_DEFAULT_TIMEOUT_MSEC;
+  int           status     = 0;
+  int           opt;
+  uint32_t      i;
+
+  self.period_usec = FAULT_BENCH_DEFAULT_PERIOD_USEC;
+  while ((opt = getopt(argc, argv, "s:p:t:o:h")) != -1) {
+    switch (opt) {
+      case 's':
+        only = optarg;
+        break;
+      case 'p':
+        self.period_usec = strtoul(optarg, NULL, 0);
+        break;
+      case 't':
+        timeout_ms = strtoul(optarg, NULL, 0);
+        break;
+      case 'o':
+        filename = optarg;
+        break;
+      default:
+        fault_usage(argv[0]);
+        return opt == 'h' ? 0 : 1;
+    }
+  }
+  if (self.period_usec == 0 || timeout_ms == 0) {
+    ERROR("Period and timeout must be positive");
+    return 1;
+  }
+  self.timeout_cycles = (uint64_t)timeout_ms * 1000 / self.period_usec;
+
+  if (filename) {
+    file = fopen(filename, "w");
+    if (!file) {
+      ERROR("Could not open %s", filename);
+      return 1;
+    }
+    fprintf(file,
+            "scenario,recovered,recovery_cycles,recovery_ms,bad_wkc_cycles,"
+            "overruns,baseline_p50_us,baseline_max_us,max_cycle_us\n");
+  }
+
+  self.vbus = jsd_vbus_alloc();
+  jsd_vbus_add_slave(self.vbus, JSD_EL3602_PRODUCT_CODE);
+  jsd_vbus_add_slave(self.vbus, JSD_EL2124_PRODUCT_CODE);
+  jsd_vbus_add_slave(self.vbus, JSD_EPD_PRODUCT_CODE);
+  jsd_vbus_drive_init(&self.drive, JSD_VBUS_DRIVE_LAYOUT_EPD);
+  self.drive.config.emcy_delay_nsec = 0;
+  jsd_vbus_drive_attach(&self.drive, self.vbus, FAULT_BENCH_EPD_ID);
+
+  self.jsd = jsd_alloc();
+  jsd_vbus_attach(self.vbus, self.jsd);
+  fault_configure(self.jsd);
+  if (!jsd_init(self.jsd, "vbus", 1)) {
+    ERROR("Could not init jsd on the virtual bus");
+    jsd_free(self.jsd);
+    jsd_vbus_free(self.vbus);
+    if (file) {
+      fclose(file);
+    }
+    return 1;
+  }
+
+  self.timer = jsd_timer_alloc();
+  jsd_timer_init_ex(self.timer, self.period_usec * 1000, JSD_TIMER_ANY_CPU,
+                    false, false);
+
+  if (fault_settle(&self, NULL) < 0) {
+    ERROR("The virtual bus did not reach a nominal cycle");
+    status = 1;
+  }
+
+  MSG("scenario, recovered, cycles, ms, bad wkc, overruns, "
+      "baseline p50/max us, max cycle us");
+  for (i = 0; i < FAULT_BENCH_NUM_SCENARIOS && status == 0; ++i) {
+    const fault_scenario_t* scenario = &fault_scenarios[i];
+    fault_result_t          result;
+
+    if (only && strcmp(only, scenario->name) != 0) {
+      continue;
+    }
+    fault_run(&self, scenario, &result);
+    MSG("%s, %s, %u, %.1f, %u, %u, %.1f/%.1f, %.1f", scenario->name,
+        result.recovered ? "yes" : "NO", result.recovery_cycles,
+        result.recovery_msec, result.bad_wkc_cycles, result.overruns,
+        result.baseline_p50_usec, result.baseline_max_usec,
+        result.max_cycle_usec);
+    if (file) {
+      fprintf(file, "%s,%d,%u,%.3f,%u,%u,%.3f,%.3f,%.3f\n", scenario->name,
+              result.recovered, result.recovery_cycles, result.recovery_msec,
+              result.bad_wkc_cycles, result.overruns,
+              result.baseline_p50_usec, result.baseline_max_usec,
+              result.max_cycle_usec);
+    }
+    if (!result.recovered) {
+      WARNING("%s did not recover within %u ms", scenario->name, timeout_ms);
+      if (fault_settle(&self, NULL) < 0) {
+        ERROR("The virtual bus did not return to a nominal cycle");
+        status = 1;
+      }
+    }
+  }
+
+  jsd_timer_free(self.timer);
+  jsd_free(self.jsd);
+  jsd_vbus_free(self.vbus);
+  if (file) {
+    fclose(file);
+  }
+  return status;
+}
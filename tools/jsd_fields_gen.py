@@ -0,0 +1,285 @@
+#!/usr/bin/env python3
+"""Generates the field registry of the device state and config structs.
+
+Usage: jsd_fields_gen.py [--check] output.c
+
+The devices are the members of the jsd_slave_config_t and jsd_slave_state_t
+unions of src/jsd_types.h. Every field of their public structs is described by
+name, value type, offset, array length and the units found in its doc comment.
+With --check, the output file is compared to the headers instead of written and
+the script fails if it is out of date.
+"""
+
+import argparse
+import os
+import re
+import sys
+
+SRC_DIR = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "src")
+
+C_TYPES = {
+    "uint8_t": "U8",
+    "uint16_t": "U16",
+    "uint32_t": "U32",
+    "uint64_t": "U64",
+    "int8_t": "I8",
+    "int16_t": "I16",
+    "int32_t": "I32",
+    "int64_t": "I64",
+    "float": "F32",
+    "double": "F64",
+    "bool": "BOOL",
+}
+
+# Unit spellings of the doc comments, the leftmost match names the unit
+UNITS = [
+    (r"cnts?/s/s", "cnt/s^2"),
+    (r"cnts?/s(?:ec)?|counts/sec", "cnt/s"),
+    (r"cnts?|counts", "cnt"),
+    (r"A/s|amps/sec", "A/s"),
+    (r"A|[Aa]mps", "A"),
+    (r"V|[Vv]olts", "V"),
+    (r"deg C", "degC"),
+    (r"ms|msec", "ms"),
+    (r"s|sec", "s"),
+    (r"microseconds", "us"),
+    (r"Ohms", "Ohm"),
+    (r"Hz", "Hz"),
+    (r"m", "m"),
+    (r"pct|percentage", "%"),
+]
+UNITS_RE = re.compile(
+    r"(?<![\w/])(?:"
+    + "|".join("(%s)" % pattern for pattern, _ in UNITS)
+    + r")(?![\w/])"
+)
+
+DECL_RE = re.compile(r"^(?:const\s+)?(\w+)\s+(\w+)\s*(?:\[\s*([^\]]+?)\s*\])?$")
+
+
+def fail(message):
+    sys.stderr.write("jsd_fields_gen.py: %s\n" % message)
+    sys.exit(1)
+
+
+def read(name):
+    with open(os.path.join(SRC_DIR, name)) as f:
+        return f.read()
+
+
+def find_enums():
+    enums = set()
+    for name in sorted(os.listdir(SRC_DIR)):
+        if name.endswith(".h"):
+            enums.update(re.findall(r"typedef\s+enum\s*\{[^}]*\}\s*(\w+)\s*;",
+                                    read(name)))
+    return enums
+
+
+def find_struct(text, name):
+    match = re.search(r"\}\s*%s\s*;" % name, text)
+    if not match:
+        fail("struct %s not found" % name)
+    # Walks back to the opening brace, unions may be nested
+    end = match.start()
+    depth = 0
+    for start in range(end, -1, -1):
+        if text[start] == "}":
+            depth += 1
+        elif text[start] == "{":
+            depth -= 1
+            if depth == 0:
+                return text[start + 1:end]
+    fail("struct %s is not balanced" % name)
+
+
+def union_members(text, struct_name):
+    body = find_struct(text, struct_name)
+    union = re.search(r"union\s*\{(.*?)\}\s*;", body, re.S)
+    if not union:
+        fail("%s has no union" % struct_name)
+    return re.findall(r"(\w+)\s+(\w+)\s*;", union.group(1))
+
+
+def units_of(comment):
+    match = UNITS_RE.search(comment)
+    if not match:
+        return ""
+    for group, (_, unit) in enumerate(UNITS, start=1):
+        if match.group(group):
+            return unit
+    return ""
+
+
+def parse_fields(body, struct_name, enums):
+    """Splits a struct body into (c_type, name, count, units) declarations."""
+    fields = []
+    code = ""
+    comment = ""
+    for line in body.split("\n"):
+        stripped = line.strip()
+        if stripped.startswith("///") and not code and fields:
+            # Continuation of the doc comment of the previous field
+            fields[-1][3] += " " + stripped.lstrip("/<").strip()
+            continue
+        if "//" in line:
+            line, text = line.split("//", 1)
+            if text.startswith("/"):
+                comment += " " + text.lstrip("/<").strip()
+        code += " " + line.strip()
+        if ";" not in code:
+            continue
+        decl = code.strip().rstrip(";").strip()
+        match = DECL_RE.match(decl)
+        if not match:
+            fail("cannot parse '%s' in %s" % (decl, struct_name))
+        c_type, name, count = match.groups()
+        if c_type not in C_TYPES and c_type not in enums:
+            fail("%s.%s has unsupported type %s" % (struct_name, name, c_type))
+        fields.append([c_type, name, count or "1", comment.strip()])
+        code = ""
+        comment = ""
+    return [(c_type, name, count, units_of(comment))
+            for c_type, name, count, comment in fields]
+
+
+def value_type(c_type):
+    # Enumerations are ints, the registry checks their size
+    return C_TYPES.get(c_type, "I32")
+
+
+def check_c_type(c_type):
+    return c_type if c_type in C_TYPES else "int32_t"
+
+
+def wrap(prefix, items, suffix, indent):
+    """Joins items after prefix, wrapping lines at 80 columns."""
+    lines = []
+    line = prefix
+    for i, item in enumerate(items):
+        text = item + (", " if i + 1 < len(items) else suffix)
+        if len(line) + len(text.rstrip()) > 80 and line.strip():
+            lines.append(line.rstrip())
+            line = " " * indent
+        line += text
+    lines.append(line.rstrip())
+    return lines
+
+
+def describe(devices, enums):
+    out = []
+    tables = {"state": [], "config": []}
+    for kind, member, struct_name, container, path in devices:
+        text = read("jsd_%s_types.h" % member)
+        fields = parse_fields(find_struct(text, struct_name), struct_name,
+                              enums)
+        product_code = "JSD_%s_PRODUCT_CODE" % member.upper()
+        if not re.search(r"#define\s+%s\b" % product_code, text):
+            fail("%s is not defined" % product_code)
+
+        table = "jsd_fields_%s_%s" % (member, kind)
+        out.append("")
+        out.append("/" + "*" * 52)
+        out.append(" * " + struct_name)
+        out.append(" " + "*" * 52 + "/")
+        out.append("")
+        for c_type, name, count, _ in fields:
+            out += wrap("JSD_FIELD_CHECK(",
+                        [struct_name, name, check_c_type(c_type), count], ");",
+                        16)
+        if fields:
+            out.append("")
+            out.append("static const jsd_field_t %s[] = {" % table)
+            for c_type, name, count, units in fields:
+                out += wrap("    {", [
+                    '"%s"' % name,
+                    "JSD_FIELD_%s" % value_type(c_type),
+                    "offsetof(%s, %s)" % (struct_name, name),
+                    count,
+                    '"%s"' % units,
+                ], "},", 5)
+            out.append("};")
+        tables[kind].append((struct_name, product_code, container, path,
+                             table if fields else None))
+
+    for kind in ("state", "config"):
+        out.append("")
+        out.append("const jsd_struct_desc_t jsd_fields_%s_descs[] = {" % kind)
+        for struct_name, product_code, container, path, table in tables[kind]:
+            items = [
+                '"%s"' % struct_name,
+                product_code,
+                "sizeof(%s)" % struct_name,
+                "offsetof(%s, %s)" % (container, path),
+                table or "NULL",
+                "sizeof(%s) / sizeof(jsd_field_t)" % table if table else "0",
+            ]
+            out += wrap("    {", items, "},", 5)
+        out.append("};")
+        out.append("const size_t jsd_fields_num_%s_descs =" % kind)
+        out.append("    sizeof(jsd_fields_%s_descs) / sizeof(jsd_struct_desc_t);"
+                   % kind)
+    return out
+
+
+def generate():
+    types_h = read("jsd_types.h")
+    enums = find_enums()
+    devices = []
+    for c_type, member in union_members(types_h, "jsd_slave_state_t"):
+        if c_type == "jsd_%s_private_state_t" % member:
+            devices.append(("state", member, "jsd_%s_state_t" % member,
+                            "jsd_slave_state_t", member + ".pub"))
+        elif c_type == "jsd_%s_state_t" % member:
+            devices.append(("state", member, c_type, "jsd_slave_state_t",
+                            member))
+        else:
+            fail("unexpected state member %s %s" % (c_type, member))
+    for c_type, member in union_members(types_h, "jsd_slave_config_t"):
+        if c_type != "jsd_%s_config_t" % member:
+            fail("unexpected config member %s %s" % (c_type, member))
+        devices.append(("config", member, c_type, "jsd_slave_config_t",
+                        member))
+
+    lines = [
+        "// Generated by tools/jsd_fields_gen.py from the device type headers,",
+        "// do not edit. The build fails when it is out of date, regenerate it",
+        "// with: python3 tools/jsd_fields_gen.py src/jsd_fields_gen.c",
+        "",
+        '#include "jsd/jsd_fields.h"',
+        "",
+        "#include <stddef.h>",
+        "",
+        "#define JSD_FIELD_CHECK(type, member, c_type, count)          \\",
+        "  _Static_assert(                                             \\",
+        "      sizeof(((type*)0)->member) == sizeof(c_type) * (count), \\",
+        '      #type "." #member " changed, regenerate the registry")',
+    ]
+    lines += describe(devices, enums)
+    return "\n".join(lines) + "\n"
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("--check", action="store_true",
+                        help="fail if the output is out of date")
+    parser.add_argument("output")
+    args = parser.parse_args()
+
+    text = generate()
+    if args.check:
+        try:
+            with open(args.output) as f:
+                current = f.read()
+        except IOError:
+            current = None
+        if current != text:
+            fail("%s is out of date with the device headers, run "
+                 "tools/jsd_fields_gen.py %s" % (args.output, args.output))
+        return
+    with open(args.output, "w") as f:
+        f.write(text)
+
+
+if __name__ == "__main__":
+    main()
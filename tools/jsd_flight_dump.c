@@ -0,0 +1,71 @@
+/**
+ * @file jsd_flight_dump.c
+ * @brief Prints a dump of the flight recorder, see jsd_flight_start(...)
+ *
+ * Usage: jsd_flight_dump dump_file
+ *
+ * One line per recorded cycle, numbered from the triggering cycle, with the
+ * working counter, the AL state, the raised triggers, the drive state of Elmo
+ * drives and the raw TxPDO and RxPDO images.
+ */
+
+#include <stdio.h>
+
+#include "jsd/jsd_flight_pub.h"
+#include "jsd/jsd_print.h"
+
+static void print_hex(const char* label, const uint8_t* data, uint16_t bytes) {
+  uint16_t i;
+  printf(" %s", label);
+  for (i = 0; i < bytes; ++i) {
+    printf("%02x", data[i]);
+  }
+}
+
+int main(int argc, char* argv[]) {
+  if (argc != 2) {
+    printf("Usage: %s dump_file\n", argv[0]);
+    return 1;
+  }
+
+  jsd_flight_dump_t dump;
+  if (!jsd_flight_load_dump(argv[1], &dump)) {
+    return 1;
+  }
+
+  const jsd_flight_header_t* header = &dump.header;
+  const jsd_flight_record_t* trigger =
+      jsd_flight_dump_get_record(&dump, header->trigger_record);
+  MSG("Slave %u, product code 0x%08x, %u cycles, triggers 0x%02x",
+      header->slave_id, header->product_code, header->num_records,
+      header->triggers);
+
+  uint32_t i;
+  for (i = 0; i < header->num_records; ++i) {
+    const jsd_flight_record_t* record = jsd_flight_dump_get_record(&dump, i);
+    printf("%+5d %10.3f ms wkc %3d al 0x%02x trg 0x%02x",
+           (int)i - (int)header->trigger_record,
+           (record->mono_nsec - trigger->mono_nsec) * 1e-6, record->wkc,
+           record->al_state, record->triggers);
+
+    if (header->product_code == JSD_EPD_PRODUCT_CODE) {
+      const jsd_epd_state_t* epd = &record->state.epd.pub;
+      printf(" sm 0x%02x sto %u emcy 0x%04x pos %d",
+             epd->actual_state_machine_state, epd->sto_engaged,
+             epd->emcy_error_code, epd->actual_position);
+    } else if (header->product_code == JSD_EGD_PRODUCT_CODE) {
+      const jsd_egd_state_t* egd = &record->state.egd.pub;
+      printf(" sm 0x%02x sto %u emcy 0x%04x pos %d",
+             egd->actual_state_machine_state, egd->sto_engaged,
+             egd->emcy_error_code, egd->actual_position);
+    }
+    print_hex("in ", jsd_flight_dump_get_inputs(&dump, i),
+              header->input_bytes);
+    print_hex("out ", jsd_flight_dump_get_outputs(&dump, i),
+              header->output_bytes);
+    printf("\n");
+  }
+
+  jsd_flight_free_dump(&dump);
+  return 0;
+}
@@ -0,0 +1,447 @@
+/**
+ * @file jsd_latency_bench.c
+ * @brief Measures the output-to-input latency of a looped-back signal
+ *
+ * Usage: jsd_latency_bench <ifname> <loop> <output_slave> <input_slave>
+ *                          [-f hz | -s hz,hz,...] [-n edges] [-p cycles]
+ *                          [-c channel] [-r] [-o edges.csv]
+ *
+ * Supported loops, wired output channel to input channel:
+ *   el2124-el3602  EL2124 digital output into an EL3602 analog input (5V range)
+ *   el4102-el3104  EL4102 analog output into an EL3104 analog input
+ *   epd            EPD digital output into a digital input of the same drive
+ *
+ * The output toggles every <cycles> cycles (default 100). The latency of each
+ * edge is the number of cycles between the jsd_write(...) that commands it and
+ * the jsd_read(...) that first sees it, and the time between those frames from
+ * their DC stamps, or from CLOCK_MONOTONIC on buses without DC. A histogram in
+ * cycles and microsecond percentiles are reported for each loop frequency; a
+ * sweep (-s) additionally reports the lowest latency reached, i.e. the latency
+ * floor of the wiring.
+ *
+ * Drives are configured with conservative current limits and never enabled.
+ */
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "jsd/jsd_el2124_pub.h"
+#include "jsd/jsd_el3104_pub.h"
+#include "jsd/jsd_el3602_pub.h"
+#include "jsd/jsd_el4102_pub.h"
+#include "jsd/jsd_epd_pub.h"
+#include "jsd/jsd_pub.h"
+#include "jsd/jsd_timer.h"
+
+#define LATENCY_DEFAULT_FREQ_HZ (1000)
+#define LATENCY_DEFAULT_EDGES (100)
+#define LATENCY_DEFAULT_PERIOD_CYCLES (100)
+#define LATENCY_MAX_SWEEP (16)
+#define LATENCY_HISTOGRAM_BINS (16)  ///< last bin collects longer latencies
+#define LATENCY_ANALOG_HIGH_V (5.0)
+#define LATENCY_ANALOG_THRESHOLD_V (2.5)
+
+typedef enum {
+  LATENCY_LOOP_EL2124_EL3602 = 0,
+  LATENCY_LOOP_EL4102_EL3104,
+  LATENCY_LOOP_EPD,
+} latency_loop_t;
+
+typedef struct {
+  jsd_t*         jsd;
+  latency_loop_t loop;
+  uint16_t       output_slave;
+  uint16_t       input_slave;
+  uint8_t        channel;
+  uint32_t       edges;
+  uint32_t       period_cycles;
+  bool           use_rt;
+  FILE*          file;
+} latency_bench_t;
+
+typedef struct {
+  uint32_t freq_hz;
+  uint32_t detected;
+  uint32_t missed;
+  uint32_t histogram[LATENCY_HISTOGRAM_BINS];
+  uint32_t min_cycles;
+  uint32_t max_cycles;
+  double   p50_usec;
+  double   p99_usec;
+  double   min_usec;
+  double   max_usec;
+  double   mean_usec;
+} latency_stats_t;
+
+static const char* latency_loop_names[] = {"el2124-el3602", "el4102-el3104",
+                                           "epd"};
+
+static void latency_set_output(latency_bench_t* self, bool level) {
+  switch (self->loop) {
+    case LATENCY_LOOP_EL2124_EL3602:
+      jsd_el2124_write_single_channel(self->jsd, self->output_slave,
+                                      self->channel, level);
+      break;
+    case LATENCY_LOOP_EL4102_EL3104:
+      jsd_el4102_write_single_channel(self->jsd, self->output_slave,
+                                      self->channel,
+                                      level ? LATENCY_ANALOG_HIGH_V : 0.0);
+      break;
+    case LATENCY_LOOP_EPD:
+      jsd_epd_set_digital_output(self->jsd, self->output_slave, self->channel,
+                                 level);
+      break;
+  }
+}
+
+static bool latency_read_input(latency_bench_t* self) {
+  switch (self->loop) {
+    case LATENCY_LOOP_EL2124_EL3602:
+      jsd_el3602_read(self->jsd, self->input_slave);
+      return jsd_el3602_get_state(self->jsd, self->input_slave)
+                 ->voltage[self->channel] > LATENCY_ANALOG_THRESHOLD_V;
+    case LATENCY_LOOP_EL4102_EL3104:
+      jsd_el3104_read(self->jsd, self->input_slave);
+      return jsd_el3104_get_state(self->jsd, self->input_slave)
+                 ->voltage[self->channel] > LATENCY_ANALOG_THRESHOLD_V;
+    case LATENCY_LOOP_EPD:
+      jsd_epd_read(self->jsd, self->input_slave);
+      return jsd_epd_get_state(self->jsd, self->input_slave)
+          ->digital_inputs[self->channel];
+  }
+  return false;
+}
+
+static void latency_process_output(latency_bench_t* self) {
+  switch (self->loop) {
+    case LATENCY_LOOP_EL2124_EL3602:
+      jsd_el2124_process(self->jsd, self->output_slave);
+      break;
+    case LATENCY_LOOP_EL4102_EL3104:
+      jsd_el4102_process(self->jsd, self->output_slave);
+      break;
+    case LATENCY_LOOP_EPD:
+      jsd_epd_process(self->jsd, self->output_slave);
+      break;
+  }
+}
+
+static void latency_configure(latency_bench_t* self) {
+  jsd_slave_config_t config = {0};
+
+  config.configuration_active = true;
+  switch (self->loop) {
+    case LATENCY_LOOP_EL2124_EL3602:
+      config.product_code = JSD_EL2124_PRODUCT_CODE;
+      jsd_set_slave_config(self->jsd, self->output_slave, config);
+
+      memset(&config, 0, sizeof(config));
+      config.configuration_active = true;
+      config.product_code         = JSD_EL3602_PRODUCT_CODE;
+      config.el3602.range[self->channel]  = JSD_EL3602_RANGE_5V;
+      config.el3602.filter[self->channel] = JSD_BECKHOFF_FILTER_30000HZ;
+      jsd_set_slave_config(self->jsd, self->input_slave, config);
+      break;
+    case LATENCY_LOOP_EL4102_EL3104:
+      config.product_code = JSD_EL4102_PRODUCT_CODE;
+      jsd_set_slave_config(self->jsd, self->output_slave, config);
+
+      memset(&config, 0, sizeof(config));
+      config.configuration_active = true;
+      config.product_code         = JSD_EL3104_PRODUCT_CODE;
+      jsd_set_slave_config(self->jsd, self->input_slave, config);
+      break;
+    case LATENCY_LOOP_EPD:
+      config.product_code                 = JSD_EPD_PRODUCT_CODE;
+      config.epd.loop_period_ms           = 1;
+      config.epd.torque_slope             = 1e7;
+      config.epd.max_profile_accel        = 1e6;
+      config.epd.max_profile_decel        = 1e7;
+      config.epd.velocity_tracking_error  = 1e8;
+      config.epd.position_tracking_error  = 1e9;
+      config.epd.peak_current_limit       = 0.5;
+      config.epd.peak_current_time        = 1.0f;
+      config.epd.continuous_current_limit = 0.5;
+      config.epd.brake_engage_msec        = 100;
+      config.epd.brake_disengage_msec     = 100;
+      config.epd.ctrl_gain_scheduling_mode =
+          JSD_ELMO_GAIN_SCHEDULING_MODE_PRELOADED;
+      jsd_set_slave_config(self->jsd, self->output_slave, config);
+      break;
+  }
+}
+
+static int latency_compare(const void* a, const void* b) {
+  double da = *(const double*)a;
+  double db = *(const double*)b;
+  return (da > db) - (da < db);
+}
+
+static double latency_stamp_diff_usec(jsd_cycle_time_t from,
+                                      jsd_cycle_time_t to) {
+  if (from.dc_valid && to.dc_valid) {
+    return (to.dc_nsec - from.dc_nsec) / 1e3;
+  }
+  return (to.mono_nsec - from.mono_nsec) / 1e3;
+}
+
+/**
+ * @brief Toggles the output until the requested number of edges has been
+ *        detected or missed at the given loop frequency
+ */
+static void latency_run(latency_bench_t* self, uint32_t freq_hz,
+                        latency_stats_t* stats) {
+  memset(stats, 0, sizeof(*stats));
+  stats->freq_hz = freq_hz;
+
+  jsd_timer_t* timer = jsd_timer_alloc();
+  if (jsd_timer_init_ex(timer, 1e9 / freq_hz, JSD_TIMER_ANY_CPU, self->use_rt,
+                        self->use_rt) != 0) {
+    ERROR("Could not start a %u Hz loop timer", freq_hz);
+    jsd_timer_free(timer);
+    return;
+  }
+
+  double*          usec  = (double*)calloc(self->edges, sizeof(double));
+  uint64_t         cycle = 0;
+  uint64_t         edge_cycle   = 0;
+  jsd_cycle_time_t edge_stamp   = {0};
+  bool             level        = false;
+  bool             waiting      = false;
+  double           usec_sum     = 0.0;
+
+  // Start from a settled low output
+  latency_set_output(self, false);
+
+  while (stats->detected + stats->missed < self->edges) {
+    jsd_read(self->jsd, EC_TIMEOUTRET);
+    jsd_cycle_time_t stamp = jsd_get_cycle_time(self->jsd);
+    bool             input = latency_read_input(self);
+
+    if (waiting && input == level) {
+      uint32_t cycles = cycle - edge_cycle;
+      double   lat    = latency_stamp_diff_usec(edge_stamp, stamp);
+
+      usec[stats->detected++] = lat;
+      usec_sum += lat;
+      ++stats->histogram[cycles < LATENCY_HISTOGRAM_BINS
+                             ? cycles
+                             : LATENCY_HISTOGRAM_BINS - 1];
+      stats->min_cycles = stats->detected == 1 || cycles < stats->min_cycles
+                              ? cycles
+                              : stats->min_cycles;
+      stats->max_cycles = cycles > stats->max_cycles ? cycles
+                                                     : stats->max_cycles;
+      if (self->file) {
+        fprintf(self->file, "%u,%u,%u,%.3f\n", freq_hz,
+                stats->detected + stats->missed, cycles, lat);
+      }
+      waiting = false;
+    } else if (waiting && cycle - edge_cycle >= self->period_cycles) {
+      ++stats->missed;
+      waiting = false;
+    }
+
+    // Edges are commanded on the cycle boundary, after the input has settled
+    if (!waiting && cycle >= self->period_cycles &&
+        cycle % self->period_cycles == 0) {
+      level = !level;
+      latency_set_output(self, level);
+      edge_cycle = cycle;
+      edge_stamp = stamp;
+      waiting    = true;
+    }
+
+    latency_process_output(self);
+    jsd_write(self->jsd);
+    jsd_timer_process(timer);
+    ++cycle;
+  }
+
+  latency_set_output(self, false);
+  latency_process_output(self);
+  jsd_write(self->jsd);
+
+  if (stats->detected > 0) {
+    qsort(usec, stats->detected, sizeof(double), latency_compare);
+    stats->min_usec  = usec[0];
+    stats->max_usec  = usec[stats->detected - 1];
+    stats->p50_usec  = usec[(stats->detected - 1) / 2];
+    stats->p99_usec  = usec[(stats->detected - 1) * 99 / 100];
+    stats->mean_usec = usec_sum / stats->detected;
+  }
+  free(usec);
+  jsd_timer_free(timer);
+}
+
+static void latency_print(const latency_stats_t* stats) {
+  uint32_t i;
+  MSG("%u Hz: %u edges detected, %u missed", stats->freq_hz, stats->detected,
+      stats->missed);
+  if (stats->detected == 0) {
+    WARNING("No edge detected, check the wiring and the channel");
+    return;
+  }
+  MSG("  latency [us]: min %.1f, mean %.1f, p50 %.1f, p99 %.1f, max %.1f",
+      stats->min_usec, stats->mean_usec, stats->p50_usec, stats->p99_usec,
+      stats->max_usec);
+  MSG("  latency [cycles]: min %u, max %u", stats->min_cycles,
+      stats->max_cycles);
+  for (i = 0; i < LATENCY_HISTOGRAM_BINS; ++i) {
+    if (stats->histogram[i] > 0) {
+      MSG("  %s%2u cycles: %u", i == LATENCY_HISTOGRAM_BINS - 1 ? ">=" : "  ",
+          i, stats->histogram[i]);
+    }
+  }
+}
+
+static uint32_t latency_parse_sweep(char* arg, uint32_t* freqs) {
+  uint32_t n     = 0;
+  char*    token = strtok(arg, ",");
+  while (token && n < LATENCY_MAX_SWEEP) {
+    freqs[n++] = strtoul(token, NULL, 0);
+    token      = strtok(NULL, ",");
+  }
+  return n;
+}
+
+static void latency_usage(const char* name) {
+  MSG("Usage: %s <ifname> <el2124-el3602|el4102-el3104|epd> <output_slave> "
+      "<input_slave> [-f hz | -s hz,hz,...] [-n edges] [-p cycles] "
+      "[-c channel] [-r] [-o edges.csv]",
+      name);
+  MSG("Example: $ %s eth0 el2124-el3602 5 2 -s 250,500,1000,2000", name);
+}
+
+int main(int argc, char* argv[]) {
+  latency_bench_t self = {0};
+  uint32_t        freqs[LATENCY_MAX_SWEEP] = {LATENCY_DEFAULT_FREQ_HZ};
+  uint32_t        num_freqs                = 1;
+  const char*     filename                 = NULL;
+  int             opt;
+
+  self.edges         = LATENCY_DEFAULT_EDGES;
+  self.period_cycles = LATENCY_DEFAULT_PERIOD_CYCLES;
+
+  while ((opt = getopt(argc, argv, "f:s:n:p:c:ro:h")) != -1) {
+    switch (opt) {
+      case 'f':
+        freqs[0]  = strtoul(optarg, NULL, 0);
+        num_freqs = 1;
+        break;
+      case 's':
+        num_freqs = latency_parse_sweep(optarg, freqs);
+        break;
+      case 'n':
+        self.edges = strtoul(optarg, NULL, 0);
+        break;
+      case 'p':
+        self.period_cycles = strtoul(optarg, NULL, 0);
+        break;
+      case 'c':
+        self.channel = strtoul(optarg, NULL, 0);
+        break;
+      case 'r':
+        self.use_rt = true;
+        break;
+      case 'o':
+        filename = optarg;
+        break;
+      default:
+        latency_usage(argv[0]);
+        return opt == 'h' ? 0 : 1;
+    }
+  }
+  if (argc - optind != 4) {
+    ERROR("Expecting exactly 4 positional arguments");
+    latency_usage(argv[0]);
+    return 1;
+  }
+
+  char*    ifname = argv[optind];
+  uint32_t i;
+  for (i = 0; i < sizeof(latency_loop_names) / sizeof(latency_loop_names[0]);
+       ++i) {
+    if (strcmp(argv[optind + 1], latency_loop_names[i]) == 0) {
+      break;
+    }
+  }
+  if (i == sizeof(latency_loop_names) / sizeof(latency_loop_names[0])) {
+    ERROR("Unknown loop: %s", argv[optind + 1]);
+    latency_usage(argv[0]);
+    return 1;
+  }
+  self.loop         = (latency_loop_t)i;
+  self.output_slave = atoi(argv[optind + 2]);
+  self.input_slave  = atoi(argv[optind + 3]);
+  if (self.loop == LATENCY_LOOP_EPD) {
+    self.input_slave = self.output_slave;
+  }
+
+  if (self.edges == 0 || self.period_cycles < 2 || num_freqs == 0) {
+    ERROR("Edges, period and loop frequencies must be positive");
+    return 1;
+  }
+  for (i = 0; i < num_freqs; ++i) {
+    if (freqs[i] == 0) {
+      ERROR("Loop frequencies must be positive");
+      return 1;
+    }
+  }
+
+  if (filename) {
+    self.file = fopen(filename, "w");
+    if (!self.file) {
+      ERROR("Could not open %s", filename);
+      return 1;
+    }
+    fprintf(self.file, "loop_freq_hz,edge,cycles,usec\n");
+  }
+
+  self.jsd = jsd_alloc();
+  latency_configure(&self);
+  if (!jsd_init(self.jsd, ifname, 1)) {
+    ERROR("Could not init jsd on %s", ifname);
+    jsd_free(self.jsd);
+    return 1;
+  }
+
+  MSG("Measuring %s latency, output slave %u, input slave %u, channel %u",
+      latency_loop_names[self.loop], self.output_slave, self.input_slave,
+      self.channel);
+
+  latency_stats_t stats[LATENCY_MAX_SWEEP];
+  for (i = 0; i < num_freqs; ++i) {
+    latency_run(&self, freqs[i], &stats[i]);
+    latency_print(&stats[i]);
+  }
+
+  if (num_freqs > 1) {
+    uint32_t floor = num_freqs;
+    MSG("freq_hz, detected, missed, min_us, p50_us, p99_us, max_us");
+    for (i = 0; i < num_freqs; ++i) {
+      MSG("%u, %u, %u, %.1f, %.1f, %.1f, %.1f", stats[i].freq_hz,
+          stats[i].detected, stats[i].missed, stats[i].min_usec,
+          stats[i].p50_usec, stats[i].p99_usec, stats[i].max_usec);
+      if (stats[i].detected > 0 && stats[i].missed == 0 &&
+          (floor == num_freqs || stats[i].p99_usec < stats[floor].p99_usec)) {
+        floor = i;
+      }
+    }
+    if (floor < num_freqs) {
+      SUCCESS("Latency floor: p99 %.1f us (min %.1f us) at %u Hz",
+              stats[floor].p99_usec, stats[floor].min_usec,
+              stats[floor].freq_hz);
+    } else {
+      WARNING("No loop frequency detected every edge");
+    }
+  }
+
+  if (self.file) {
+    fclose(self.file);
+  }
+  jsd_free(self.jsd);
+  return 0;
+}
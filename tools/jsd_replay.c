@@ -0,0 +1,240 @@
+/**
+ * @file jsd_replay.c
+ * @brief Replays a recording made with jsd_recorder_start(...) through the
+ *        device drivers, no NIC or slaves required
+ *
+ * Usage: jsd_replay [-q] recording
+ *
+ * Every recorded cycle is stepped into the IOmap and the read and process
+ * functions of the recorded devices run on it as fast as possible. Working
+ * counter drops and Elmo drive state machine transitions and faults are
+ * printed with the recorded cycle time (-q prints the summary only). The
+ * summary compares the outputs produced by the replay to the recorded ones;
+ * devices commanded by the application diverge unless it replays its
+ * commands as well.
+ */
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "jsd/jsd.h"
+#include "jsd/jsd_ati_fts.h"
+#include "jsd/jsd_ati_fts_pub.h"
+#include "jsd/jsd_egd.h"
+#include "jsd/jsd_el2124.h"
+#include "jsd/jsd_el3104.h"
+#include "jsd/jsd_el3104_pub.h"
+#include "jsd/jsd_el3162.h"
+#include "jsd/jsd_el3162_pub.h"
+#include "jsd/jsd_el3202.h"
+#include "jsd/jsd_el3208.h"
+#include "jsd/jsd_el3318.h"
+#include "jsd/jsd_el3356.h"
+#include "jsd/jsd_el3602.h"
+#include "jsd/jsd_el4102.h"
+#include "jsd/jsd_elmo_common.h"
+#include "jsd/jsd_epd.h"
+#include "jsd/jsd_ild1900.h"
+#include "jsd/jsd_ild1900_pub.h"
+#include "jsd/jsd_jed0101.h"
+#include "jsd/jsd_jed0200.h"
+#include "jsd/jsd_recorder_pub.h"
+#include "jsd/jsd_time.h"
+
+typedef void (*replay_cyclic_t)(jsd_t* self, uint16_t slave_id);
+
+typedef struct {
+  uint32_t        product_code;
+  replay_cyclic_t read;
+  replay_cyclic_t process;
+} replay_device_t;
+
+static const replay_device_t replay_devices[] = {
+    {JSD_EL2124_PRODUCT_CODE, NULL, jsd_el2124_process},
+    {JSD_EL3104_PRODUCT_CODE, jsd_el3104_read, NULL},
+    {JSD_EL3162_PRODUCT_CODE, jsd_el3162_read, NULL},
+    {JSD_EL3202_PRODUCT_CODE, jsd_el3202_read, NULL},
+    {JSD_EL3208_PRODUCT_CODE, jsd_el3208_read, NULL},
+    {JSD_EL3318_PRODUCT_CODE, jsd_el3318_read, NULL},
+    {JSD_EL3356_PRODUCT_CODE, jsd_el3356_read, jsd_el3356_process},
+    {JSD_EL3602_PRODUCT_CODE, jsd_el3602_read, NULL},
+    {JSD_EL4102_PRODUCT_CODE, NULL, jsd_el4102_process},
+    {JSD_ATI_FTS_PRODUCT_CODE, jsd_ati_fts_read, jsd_ati_fts_process},
+    {JSD_ILD1900_PRODUCT_CODE, jsd_ild1900_read, NULL},
+    {JSD_JED0101_PRODUCT_CODE, jsd_jed0101_read, jsd_jed0101_process},
+    {JSD_JED0200_PRODUCT_CODE, jsd_jed0200_read, jsd_jed0200_process},
+    {JSD_EPD_PRODUCT_CODE, jsd_epd_read, jsd_epd_process},
+    {JSD_EGD_PRODUCT_CODE, jsd_egd_read, jsd_egd_process},
+};
+
+typedef struct {
+  const replay_device_t*         device;
+  uint64_t                       diverged_cycles;
+  bool                           drive_seen;
+  jsd_elmo_state_machine_state_t last_state;
+  int                            last_fault;
+} replay_slave_t;
+
+static replay_slave_t replay_slaves[EC_MAXSLAVE];
+
+static const replay_device_t* replay_find_device(uint32_t product_code) {
+  size_t d;
+  for (d = 0; d < sizeof(replay_devices) / sizeof(replay_devices[0]); ++d) {
+    if (replay_devices[d].product_code == product_code) {
+      return &replay_devices[d];
+    }
+  }
+  return NULL;
+}
+
+static void replay_check_drive(jsd_t* jsd, uint16_t slave_id, int64_t t_nsec,
+                               bool verbose) {
+  replay_slave_t*                slave = &replay_slaves[slave_id];
+  jsd_elmo_state_machine_state_t state;
+  int                            fault;
+  const char*                    fault_string;
+
+  if (slave->device->product_code == JSD_EPD_PRODUCT_CODE) {
+    const jsd_epd_state_t* epd = jsd_epd_get_state(jsd, slave_id);
+    state        = epd->actual_state_machine_state;
+    fault        = epd->fault_code;
+    fault_string = jsd_epd_fault_code_to_string(epd->fault_code);
+  } else if (slave->device->product_code == JSD_EGD_PRODUCT_CODE) {
+    const jsd_egd_state_t* egd = jsd_egd_get_state(jsd, slave_id);
+    state        = egd->actual_state_machine_state;
+    fault        = egd->fault_code;
+    fault_string = jsd_egd_fault_code_to_string(egd->fault_code);
+  } else {
+    return;
+  }
+
+  // Report changes only, starting from the state of the first cycle
+  if (!slave->drive_seen) {
+    slave->drive_seen = true;
+    if (verbose) {
+      MSG("%.6f s: slave %u starts in %s, fault %s",
+          (double)t_nsec / JSD_TIME_NSEC_PER_SEC, slave_id,
+          jsd_elmo_state_machine_state_to_string(state), fault_string);
+    }
+  } else if (verbose) {
+    if (state != slave->last_state) {
+      MSG("%.6f s: slave %u %s -> %s",
+          (double)t_nsec / JSD_TIME_NSEC_PER_SEC, slave_id,
+          jsd_elmo_state_machine_state_to_string(slave->last_state),
+          jsd_elmo_state_machine_state_to_string(state));
+    }
+    if (fault != slave->last_fault) {
+      MSG("%.6f s: slave %u fault %s", (double)t_nsec / JSD_TIME_NSEC_PER_SEC,
+          slave_id, fault_string);
+    }
+  }
+  slave->last_state = state;
+  slave->last_fault = fault;
+}
+
+int main(int argc, char* argv[]) {
+  bool verbose = true;
+  int  opt;
+
+  while ((opt = getopt(argc, argv, "qh")) != -1) {
+    switch (opt) {
+      case 'q':
+        verbose = false;
+        break;
+      default:
+        printf("Usage: %s [-q] recording\n", argv[0]);
+        return opt == 'h' ? 0 : 1;
+    }
+  }
+  if (optind != argc - 1) {
+    printf("Usage: %s [-q] recording\n", argv[0]);
+    return 1;
+  }
+
+  jsd_t* jsd = jsd_alloc();
+  if (!jsd_replay_open(jsd, argv[optind])) {
+    jsd_free(jsd);
+    return 1;
+  }
+
+  uint16_t   num_slaves = *jsd->ecx_context.slavecount;
+  ec_slavet* slaves     = jsd->ecx_context.slavelist;
+  uint16_t   slave_id;
+  for (slave_id = 1; slave_id <= num_slaves; ++slave_id) {
+    if (!jsd->slave_configs[slave_id].configuration_active) {
+      continue;
+    }
+    const replay_device_t* device = replay_find_device(slaves[slave_id].eep_id);
+    if (!device) {
+      WARNING("Slave %u (0x%08x) has no driver to replay", slave_id,
+              slaves[slave_id].eep_id);
+    }
+    replay_slaves[slave_id].device = device;
+  }
+
+  uint64_t cycles     = 0;
+  uint64_t bad_wkc    = 0;
+  int64_t  first_nsec = 0;
+  int64_t  last_nsec  = 0;
+  int64_t  start_nsec = jsd_time_get_mono_time_nsec();
+
+  while (jsd_replay_step(jsd)) {
+    int64_t t_nsec = jsd->cycle_time.mono_nsec;
+    if (cycles++ == 0) {
+      first_nsec = t_nsec;
+    }
+    last_nsec = t_nsec;
+
+    if (jsd->wkc != jsd->expected_wkc) {
+      ++bad_wkc;
+      if (verbose && jsd->last_wkc == jsd->expected_wkc) {
+        MSG("%.6f s: wkc %d, expected %d",
+            (double)(t_nsec - first_nsec) / JSD_TIME_NSEC_PER_SEC, jsd->wkc,
+            jsd->expected_wkc);
+      }
+    }
+
+    for (slave_id = 1; slave_id <= num_slaves; ++slave_id) {
+      replay_slave_t* slave = &replay_slaves[slave_id];
+      if (!slave->device) {
+        continue;
+      }
+      if (slave->device->read) {
+        slave->device->read(jsd, slave_id);
+      }
+      if (slave->device->process) {
+        slave->device->process(jsd, slave_id);
+      }
+      replay_check_drive(jsd, slave_id, t_nsec - first_nsec, verbose);
+
+      const uint8_t* recorded =
+          jsd_replay_get_recorded_outputs(jsd, slave_id);
+      if (recorded && memcmp(recorded, slaves[slave_id].outputs,
+                             slaves[slave_id].Obytes)) {
+        ++slave->diverged_cycles;
+      }
+    }
+  }
+
+  double wall_sec = (double)(jsd_time_get_mono_time_nsec() - start_nsec) /
+                    JSD_TIME_NSEC_PER_SEC;
+  double recorded_sec =
+      (double)(last_nsec - first_nsec) / JSD_TIME_NSEC_PER_SEC;
+
+  MSG("Replayed %lu cycles spanning %.3f s in %.3f s (%.0fx real time)",
+      (unsigned long)cycles, recorded_sec, wall_sec,
+      wall_sec > 0 ? recorded_sec / wall_sec : 0.0);
+  MSG("Cycles with an unexpected working counter: %lu",
+      (unsigned long)bad_wkc);
+  for (slave_id = 1; slave_id <= num_slaves; ++slave_id) {
+    if (replay_slaves[slave_id].diverged_cycles > 0) {
+      MSG("Slave %u outputs differ from the recording in %lu cycles",
+          slave_id, (unsigned long)replay_slaves[slave_id].diverged_cycles);
+    }
+  }
+
+  jsd_free(jsd);
+  return 0;
+}
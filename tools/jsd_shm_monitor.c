@@ -0,0 +1,101 @@
+/**
+ * @file jsd_shm_monitor.c
+ * @brief Prints the bus data published by jsd_shm_start(...) in another
+ *        process
+ *
+ * Usage: jsd_shm_monitor [-r rate_hz] [-v] name
+ *
+ * Every period the cycle rate, the working counter and the AL state of every
+ * slave are read from a snapshot of the segment; the publishing loop is not
+ * disturbed. With -v, every field of the device states is printed from the
+ * field registry.
+ */
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "jsd/jsd_fields_pub.h"
+#include "jsd/jsd_print.h"
+#include "jsd/jsd_shm_pub.h"
+
+static jsd_shm_snapshot_t snapshot;
+
+static void print_state(const jsd_shm_slave_t* slave) {
+  const jsd_struct_desc_t* desc =
+      jsd_fields_get_state_desc(slave->product_code);
+  if (desc == NULL) {
+    return;
+  }
+  const uint8_t* state = (const uint8_t*)&slave->state + desc->container_offset;
+  size_t         f;
+  uint32_t       i;
+  for (f = 0; f < desc->num_fields; ++f) {
+    const jsd_field_t* field = &desc->fields[f];
+    printf("      %s:", field->name);
+    for (i = 0; i < field->count; ++i) {
+      printf(" %.9g", jsd_field_get_value(field, state, i));
+    }
+    printf(" %s\n", field->units);
+  }
+}
+
+int main(int argc, char* argv[]) {
+  double rate_hz = 1.0;
+  bool   verbose = false;
+  int    opt;
+
+  while ((opt = getopt(argc, argv, "r:vh")) != -1) {
+    switch (opt) {
+      case 'r':
+        rate_hz = atof(optarg);
+        break;
+      case 'v':
+        verbose = true;
+        break;
+      default:
+        printf("Usage: %s [-r rate_hz] [-v] name\n", argv[0]);
+        return opt == 'h' ? 0 : 1;
+    }
+  }
+  if (optind != argc - 1 || rate_hz <= 0) {
+    printf("Usage: %s [-r rate_hz] [-v] name\n", argv[0]);
+    return 1;
+  }
+
+  jsd_shm_reader_t reader;
+  if (!jsd_shm_open(&reader, argv[optind])) {
+    return 1;
+  }
+
+  uint64_t last_cycle = 0;
+  bool     first      = true;
+  while (true) {
+    if (!jsd_shm_read(&reader, &snapshot)) {
+      WARNING("No snapshot available");
+    } else {
+      double cycle_hz = first ? 0.0 : (snapshot.cycle - last_cycle) * rate_hz;
+      last_cycle      = snapshot.cycle;
+      first           = false;
+
+      MSG("cycle %lu (%.1f Hz), wkc %d/%d, bus state 0x%02x",
+          (unsigned long)snapshot.cycle, cycle_hz, snapshot.wkc,
+          snapshot.expected_wkc, snapshot.bus_state);
+      uint16_t slave_id;
+      for (slave_id = 1; slave_id <= snapshot.num_slaves; ++slave_id) {
+        const jsd_shm_slave_t* slave = &snapshot.slaves[slave_id];
+        MSG("  slave %u: 0x%08x, AL state 0x%02x, AL status 0x%04x",
+            slave_id, slave->product_code, slave->al_state,
+            slave->al_status_code);
+        if (verbose) {
+          print_state(slave);
+        }
+      }
+    }
+    usleep((useconds_t)(1e6 / rate_hz));
+  }
+
+  jsd_shm_close(&reader);
+  return 0;
+}
@@ -0,0 +1,36 @@
+/**
+ * @file jsd_telemetry_to_csv.c
+ * @brief Converts a log written by jsd_telemetry_start(...) to CSV
+ *
+ * Usage: jsd_telemetry_to_csv telemetry [csv]
+ *
+ * The CSV is written to stdout when no output file is given.
+ */
+
+#include <stdio.h>
+
+#include "jsd/jsd_print.h"
+#include "jsd/jsd_telemetry_pub.h"
+
+int main(int argc, char* argv[]) {
+  if (argc != 2 && argc != 3) {
+    printf("Usage: %s telemetry [csv]\n", argv[0]);
+    return 1;
+  }
+
+  FILE* csv = stdout;
+  if (argc == 3) {
+    csv = fopen(argv[2], "w");
+    if (!csv) {
+      ERROR("Could not open file for writing: %s", argv[2]);
+      return 1;
+    }
+  }
+
+  bool complete = jsd_telemetry_to_csv(argv[1], csv);
+
+  if (csv != stdout) {
+    fclose(csv);
+  }
+  return complete ? 0 : 1;
+}